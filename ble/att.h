@@ -189,6 +189,11 @@ enum class op_code: uint8_t
     handle_value_notification   = 0x1b,
     handle_value_indication     = 0x1d,
     handle_value_confirmation   = 0x1e,
+
+    /// @see Bluetooth Core Specification 5.2, Volume 3, Part F
+    /// 3.4.4.11 Read Multiple Variable Request
+    read_multiple_variable_request  = 0x20,
+    read_multiple_variable_response = 0x21,
 };
 
 /**
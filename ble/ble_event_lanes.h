@@ -0,0 +1,142 @@
+/**
+ * @file ble/ble_event_lanes.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The priority lanes in which BLE events are queued for deferred processing.
+ */
+
+#pragma once
+
+#include "spsc_slot_ring.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ble
+{
+
+/**
+ * @class event_lanes
+ * Two single producer, single consumer lanes of BLE events:
+ * - GAP lane:  Common and GAP events.
+ * - GATT lane: GATTC and GATTS events.
+ * Pending GAP lane events are always consumed before the next GATT lane event.
+ *
+ * Events which oblige the application to reply to the BLE stack, or which
+ * change the connection state, must never be lost. Each lane holds back
+ * reserved_slot_count slots which only these must_answer events may take.
+ *
+ * The producer applies back-pressure: it takes the next event from the BLE
+ * stack only while is_accepting(), leaving the events queued in the stack
+ * otherwise rather than discarding them.
+ *
+ * @tparam slot_size        The maximum size of an event in bytes.
+ * @tparam gap_slot_count   The number of GAP lane slots; a power of 2.
+ * @tparam gatt_slot_count  The number of GATT lane slots; a power of 2.
+ */
+template <std::size_t slot_size,
+          std::size_t gap_slot_count,
+          std::size_t gatt_slot_count>
+class event_lanes
+{
+public:
+    enum class lane: uint8_t
+    {
+        gap,
+        gatt
+    };
+
+    /// The slots in each lane which only must_answer events may take.
+    static constexpr std::size_t const reserved_slot_count = 1u;
+
+    static_assert(gap_slot_count  > reserved_slot_count, "GAP lane too small");
+    static_assert(gatt_slot_count > reserved_slot_count, "GATT lane too small");
+
+    using gap_ring  = spsc_slot_ring<slot_size, gap_slot_count>;
+    using gatt_ring = spsc_slot_ring<slot_size, gatt_slot_count>;
+
+    using slot = spsc_slot<slot_size>;
+
+    ~event_lanes()                              = default;
+    event_lanes()                               = default;
+    event_lanes(event_lanes const&)             = delete;
+    event_lanes(event_lanes&&)                  = delete;
+    event_lanes& operator=(event_lanes const&)  = delete;
+    event_lanes& operator=(event_lanes&&)       = delete;
+
+    /**
+     * Producer: copy an event into its lane.
+     *
+     * @param event_lane  The lane in which the event is queued.
+     * @param must_answer true if the event may take a reserved slot.
+     * @param data        The event.
+     * @param length      The event length in bytes.
+     * @param timestamp   The time at which the event was received.
+     *
+     * @return bool true if the event was queued; false if the lane was full.
+     */
+    bool push(lane          event_lane,
+              bool          must_answer,
+              void const*   data,
+              std::size_t   length,
+              uint32_t      timestamp)
+    {
+        std::size_t const keep_free = must_answer ? 0u : reserved_slot_count;
+        return (event_lane == lane::gap) ?
+            this->gap_ring_.push(data,  length, timestamp, keep_free) :
+            this->gatt_ring_.push(data, length, timestamp, keep_free);
+    }
+
+    /**
+     * Producer: whether the next event may be taken from the BLE stack.
+     * @return bool true if both lanes can queue an event of any kind.
+     */
+    bool is_accepting() const
+    {
+        return (this->gap_ring_.available()  > reserved_slot_count) &&
+               (this->gatt_ring_.available() > reserved_slot_count);
+    }
+
+    /**
+     * Consumer: the next event in priority order.
+     *
+     * @param [out] event_lane The lane holding the event; pass it to pop().
+     * @return slot const* The event or nullptr if both lanes are empty.
+     */
+    slot const* front(lane& event_lane) const
+    {
+        slot const* event_slot = this->gap_ring_.front();
+        if (event_slot)
+        {
+            event_lane = lane::gap;
+            return event_slot;
+        }
+
+        event_lane = lane::gatt;
+        return this->gatt_ring_.front();
+    }
+
+    /// Consumer: release the event returned by front().
+    void pop(lane event_lane)
+    {
+        if (event_lane == lane::gap)
+        {
+            this->gap_ring_.pop();
+        }
+        else
+        {
+            this->gatt_ring_.pop();
+        }
+    }
+
+    bool empty() const { return this->gap_ring_.empty() && this->gatt_ring_.empty(); }
+
+    gap_ring  const& gap()  const { return this->gap_ring_; }
+    gatt_ring const& gatt() const { return this->gatt_ring_; }
+
+private:
+    gap_ring    gap_ring_;
+    gatt_ring   gatt_ring_;
+};
+
+} // namespace ble
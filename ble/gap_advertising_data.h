@@ -12,6 +12,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <algorithm>
 #include <array>
 #include <iterator>
 
@@ -206,6 +207,17 @@ public:
     }
     /// @}
 
+    /**
+     * Replace the advertising data; typically with an advertising_layout.
+     * Data beyond the capacity is not copied.
+     */
+    void assign(void const* data, std::size_t length)
+    {
+        uint8_t const* const data_ptr = reinterpret_cast<uint8_t const*>(data);
+        length = std::min(length, this->capacity());
+        this->index_ = std::copy(data_ptr, data_ptr + length, this->data_.begin());
+    }
+
     /** @{
      * The size and capacity functions are used to determine how much space
      * remains available in the advertising data buffer.
@@ -0,0 +1,247 @@
+/**
+ * @file ble/gap_advertising_layout.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Advertising data with an LTV layout fixed at compile time.
+ */
+
+#pragma once
+
+#include "ble/gap_advertising_data.h"
+#include "ble/gap_types.h"
+#include "ble/ltv_encode.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace ble
+{
+namespace gap
+{
+
+/**
+ * @struct ltv_value
+ * The encoded length of an LTV value type and its little endian encoding.
+ * Integer and enum values, and std::array of these, are supported.
+ */
+template <typename value_type, typename enable = void>
+struct ltv_value;
+
+template <typename value_type>
+struct ltv_value<value_type,
+                 std::enable_if_t<std::is_integral<value_type>::value ||
+                                  std::is_enum<value_type>::value>>
+{
+    static_assert(not std::is_same<value_type, bool>::value);
+
+    static constexpr std::size_t const length = sizeof(value_type);
+
+    static constexpr void store(uint8_t* dest, value_type value)
+    {
+        using int_type  = typename std::conditional_t<std::is_enum<value_type>::value,
+                                                      std::underlying_type<value_type>,
+                                                      std::common_type<value_type>>::type;
+        using uint_type = std::make_unsigned_t<int_type>;
+
+        uint_type const bits = static_cast<uint_type>(value);
+        for (std::size_t index = 0u; index < length; ++index)
+        {
+            dest[index] = static_cast<uint8_t>(bits >> (index * 8u));
+        }
+    }
+};
+
+template <typename element_type, std::size_t element_count>
+struct ltv_value<std::array<element_type, element_count>>
+{
+    static constexpr std::size_t const length = element_count * ltv_value<element_type>::length;
+
+    static constexpr void store(uint8_t* dest, std::array<element_type, element_count> const& value)
+    {
+        for (element_type const& element : value)
+        {
+            ltv_value<element_type>::store(dest, element);
+            dest += ltv_value<element_type>::length;
+        }
+    }
+};
+
+/**
+ * @struct ltv_field
+ * An LTV field of an advertising_layout: the type and the value types
+ * which follow it in order.
+ *
+ * @example Manufacturer data with a company id and a sensor value:
+ * ltv_field<type::manufacturer_specific_data, uint16_t, int16_t>
+ */
+template <gap::type field_type, typename... value_types>
+struct ltv_field
+{
+    static_assert(sizeof...(value_types) > 0u);
+
+    static constexpr gap::type   const type        = field_type;
+    static constexpr std::size_t const value_count = sizeof...(value_types);
+
+    template <std::size_t value_index>
+    using value_type = std::tuple_element_t<value_index, std::tuple<value_types...>>;
+
+    /// The value lengths in octets.
+    static constexpr std::size_t const value_lengths[] = { ltv_value<value_types>::length... };
+
+    /// The length of the values; the payload of the LTV.
+    static constexpr std::size_t const length = (ltv_value<value_types>::length + ...);
+
+    /// The length of the LTV including the length and type octets.
+    static constexpr std::size_t const encoded_length = ltv_header_length + length;
+
+    /// The offset of a value from the beginning of the LTV.
+    template <std::size_t value_index>
+    static constexpr std::size_t value_offset()
+    {
+        std::size_t offset = ltv_data::offset_data;
+        for (std::size_t index = 0u; index < value_index; ++index)
+        {
+            offset += value_lengths[index];
+        }
+        return offset;
+    }
+};
+
+/**
+ * @class advertising_layout
+ * Advertising data whose LTV fields and their offsets are known at compile
+ * time.
+ *
+ * The LTV length and type octets are encoded into template_data at compile
+ * time. Field values are written in place with set<>() at an offset which
+ * is a compile time constant: updating a changing value, such as sensor
+ * manufacturer data or a battery level, is a store of the value rather than
+ * an encoding of the advertising data.
+ *
+ * @note The softdevice reads the advertising data buffer while advertising.
+ * A value written while advertising appears in the following advertising
+ * events; a multi-octet value may appear partially written in one event.
+ *
+ * @example
+ * using beacon = advertising_layout<
+ *     ltv_field<type::flags, uint8_t>,
+ *     ltv_field<type::manufacturer_specific_data, uint16_t, int16_t>>;
+ *
+ * beacon::assign(advertising.data);
+ * beacon::set<0>(advertising.data, le_general_discovery);
+ * beacon::set<1, 0>(advertising.data, company_id);
+ * ...
+ * beacon::set<1, 1>(advertising.data, temperature);    // Each interval.
+ */
+template <typename... field_types>
+class advertising_layout
+{
+public:
+    using container = std::array<uint8_t, (field_types::encoded_length + ...)>;
+
+    static constexpr std::size_t const field_count = sizeof...(field_types);
+    static constexpr std::size_t const length      = std::tuple_size<container>::value;
+
+    static_assert(length <= advertising_data::max_length,
+                  "advertising_layout exceeds the advertising data length");
+
+    template <std::size_t field_index>
+    using field = std::tuple_element_t<field_index, std::tuple<field_types...>>;
+
+    ~advertising_layout()                                       = delete;
+    advertising_layout()                                        = delete;
+    advertising_layout(advertising_layout const&)               = delete;
+    advertising_layout(advertising_layout&&)                    = delete;
+    advertising_layout& operator=(advertising_layout const&)    = delete;
+    advertising_layout& operator=(advertising_layout&&)         = delete;
+
+    /// The offset of an LTV field from the beginning of the advertising data.
+    template <std::size_t field_index>
+    static constexpr std::size_t field_offset()
+    {
+        constexpr std::size_t const encoded_lengths[] = { field_types::encoded_length... };
+
+        std::size_t offset = 0u;
+        for (std::size_t index = 0u; index < field_index; ++index)
+        {
+            offset += encoded_lengths[index];
+        }
+        return offset;
+    }
+
+    /// The offset of a field value from the beginning of the advertising data.
+    template <std::size_t field_index, std::size_t value_index = 0u>
+    static constexpr std::size_t value_offset()
+    {
+        return field_offset<field_index>() +
+               field<field_index>::template value_offset<value_index>();
+    }
+
+    /**
+     * Write a field value into advertising data of this layout.
+     * Usable at compile time to initialize a constexpr container.
+     *
+     * @tparam field_index The LTV field index within the layout.
+     * @tparam value_index The value index within the LTV field.
+     * @param payload The advertising data octets.
+     * @param value   The value to write.
+     */
+    template <std::size_t field_index, std::size_t value_index = 0u>
+    static constexpr void set(
+        uint8_t* payload,
+        typename field<field_index>::template value_type<value_index> const& value)
+    {
+        using value_type = typename field<field_index>::template value_type<value_index>;
+        ltv_value<value_type>::store(payload + value_offset<field_index, value_index>(), value);
+    }
+
+    template <std::size_t field_index, std::size_t value_index = 0u>
+    static constexpr void set(
+        container& payload,
+        typename field<field_index>::template value_type<value_index> const& value)
+    {
+        set<field_index, value_index>(payload.data(), value);
+    }
+
+    /// Write a field value into advertising data assigned from this layout.
+    template <std::size_t field_index, std::size_t value_index = 0u>
+    static void set(
+        advertising_data& data,
+        typename field<field_index>::template value_type<value_index> const& value)
+    {
+        set<field_index, value_index>(data.data(), value);
+    }
+
+    /**
+     * Replace the advertising data with this layout.
+     * @param payload The initial advertising data; by default the template
+     *                with zero values.
+     */
+    static void assign(advertising_data& data, container const& payload = template_data)
+    {
+        data.assign(payload.data(), payload.size());
+    }
+
+    /// The advertising data with the LTV length and type octets set and zero values.
+    static constexpr container const template_data = []() {
+        container       payload         = {};
+        gap::type const types[]         = { field_types::type... };
+        std::size_t const lengths[]     = { field_types::length... };
+
+        std::size_t offset = 0u;
+        for (std::size_t index = 0u; index < field_count; ++index)
+        {
+            payload[offset + ltv_data::offset_length] =
+                static_cast<uint8_t>(lengths[index] + sizeof(gap::type));
+            payload[offset + ltv_data::offset_type] = static_cast<uint8_t>(types[index]);
+            offset += ltv_header_length + lengths[index];
+        }
+        return payload;
+    }();
+};
+
+} // namespace gap
+} // namespace ble
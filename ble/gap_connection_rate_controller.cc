@@ -0,0 +1,306 @@
+/**
+ * @file ble/gap_connection_rate_controller.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "ble/gap_connection_rate_controller.h"
+#include "logger.h"
+
+namespace ble
+{
+namespace gap
+{
+
+connection_rate_controller::policy const connection_rate_controller::default_policy = {
+    .loaded_parameters = {
+        6u,                                     // 7.5 msec, the minimum.
+        connection_interval_msec(15u),
+        0u,
+        supervision_timeout_msec(4000u)
+    },
+    .idle_parameters = {
+        connection_interval_msec(400u),
+        connection_interval_msec(500u),
+        4u,
+        supervision_timeout_msec(6000u)
+    },
+    .load_bytes_per_sec         = 2000u,
+    .idle_bytes_per_sec         = 200u,
+    .load_queue_depth           = 4u,
+    .idle_hold_msec             = 5000u,
+    .request_interval_min_msec  = 2000u,
+    .data_length_max            = 251u,
+    .data_length_idle           = 27u
+};
+
+connection_rate_controller::connection_rate_controller(
+    ble::gap::operations&   operations,
+    policy const&           rate_policy)
+:   operations_(operations),
+    policy_(rate_policy),
+    connection_handle_(ble::gap::handle_invalid),
+    mode_(link_mode::idle),
+    connection_parameters_(),
+    phy_tx_(phy_layer_parameters::rate_1_Mbps),
+    data_length_(0u),
+    bytes_pending_(0u),
+    queue_depth_(0u),
+    bytes_per_sec_(0u),
+    sample_msec_(0u),
+    request_msec_(0u),
+    quiet_since_msec_(0u),
+    is_quiet_(false),
+    is_sample_started_(false),
+    request_made_(false),
+    request_count_(0u)
+{
+}
+
+void connection_rate_controller::connect(uint16_t connection_handle)
+{
+    this->connection_handle_ = connection_handle;
+    this->mode_              = link_mode::idle;
+    this->phy_tx_            = phy_layer_parameters::rate_1_Mbps;
+    this->data_length_       = 0u;
+    this->bytes_pending_     = 0u;
+    this->queue_depth_       = 0u;
+    this->bytes_per_sec_     = 0u;
+    this->is_quiet_          = false;
+    this->is_sample_started_ = false;
+    this->request_made_      = false;
+}
+
+void connection_rate_controller::disconnect()
+{
+    this->connection_handle_ = ble::gap::handle_invalid;
+}
+
+void connection_rate_controller::connection_parameter_update(
+    connection_parameters const& parameters)
+{
+    this->connection_parameters_ = parameters;
+}
+
+void connection_rate_controller::phy_update(phy_layer_parameters phy_tx,
+                                            phy_layer_parameters phy_rx)
+{
+    (void) phy_rx;
+    this->phy_tx_ = phy_tx;
+}
+
+void connection_rate_controller::link_layer_update(uint16_t tx_length_max,
+                                                   uint16_t rx_length_max)
+{
+    (void) rx_length_max;
+    this->data_length_ = tx_length_max;
+}
+
+void connection_rate_controller::record_notification(ble::att::length_t length)
+{
+    this->bytes_pending_ += length;
+}
+
+void connection_rate_controller::record_write(ble::att::length_t length)
+{
+    this->bytes_pending_ += length;
+}
+
+void connection_rate_controller::set_queue_depth(std::size_t queue_depth)
+{
+    this->queue_depth_ = queue_depth;
+}
+
+bool connection_rate_controller::is_request_allowed(uint32_t now_msec) const
+{
+    return (not this->request_made_) ||
+           (now_msec - this->request_msec_ >= this->policy_.request_interval_min_msec);
+}
+
+connection_rate_controller::link_mode
+    connection_rate_controller::update(uint32_t now_msec)
+{
+    if (not this->is_connected())
+    {
+        return this->mode_;
+    }
+
+    if (not this->is_sample_started_)
+    {
+        // Traffic recorded before the measurement started is not timed.
+        this->is_sample_started_ = true;
+        this->bytes_pending_     = 0u;
+        this->sample_msec_       = now_msec;
+    }
+
+    uint32_t const elapsed_msec = now_msec - this->sample_msec_;
+    if (elapsed_msec > 0u)
+    {
+        uint64_t const sample =
+            (static_cast<uint64_t>(this->bytes_pending_) * 1000u) / elapsed_msec;
+        int64_t const delta =
+            static_cast<int64_t>(sample) - static_cast<int64_t>(this->bytes_per_sec_);
+
+        this->bytes_per_sec_ = static_cast<uint32_t>(
+            static_cast<int64_t>(this->bytes_per_sec_) + delta / (1 << filter_shift));
+
+        this->bytes_pending_ = 0u;
+        this->sample_msec_   = now_msec;
+    }
+
+    bool const is_loaded =
+        (this->bytes_per_sec_ >= this->policy_.load_bytes_per_sec) ||
+        (this->queue_depth_   >= this->policy_.load_queue_depth);
+
+    bool const is_quiet =
+        (this->bytes_per_sec_ <= this->policy_.idle_bytes_per_sec) &&
+        (this->queue_depth_ == 0u);
+
+    if (is_quiet)
+    {
+        if (not this->is_quiet_)
+        {
+            this->is_quiet_         = true;
+            this->quiet_since_msec_ = now_msec;
+        }
+    }
+    else
+    {
+        this->is_quiet_ = false;
+    }
+
+    if ((this->mode_ == link_mode::idle) && is_loaded)
+    {
+        this->request_mode(link_mode::loaded, now_msec);
+    }
+    else if ((this->mode_ == link_mode::loaded) && this->is_quiet_ &&
+             (now_msec - this->quiet_since_msec_ >= this->policy_.idle_hold_msec))
+    {
+        this->request_mode(link_mode::idle, now_msec);
+    }
+
+    return this->mode_;
+}
+
+bool connection_rate_controller::request_mode(link_mode mode, uint32_t now_msec)
+{
+    if (not this->is_request_allowed(now_msec))
+    {
+        return false;
+    }
+
+    // Failed requests are also rate limited; a busy link layer is retried
+    // no sooner than request_interval_min_msec later.
+    this->request_made_ = true;
+    this->request_msec_ = now_msec;
+
+    connection_parameters const& parameters =
+        (mode == link_mode::loaded) ? this->policy_.loaded_parameters :
+                                      this->policy_.idle_parameters;
+
+    operations::status status =
+        this->operations_.connection_parameter_update_request(
+            this->connection_handle_, parameters);
+
+    logger::instance().debug(
+        "rate_controller: h: 0x%04x, mode: %u, rate: %u B/s, interval: (%u, %u), latency: %u, status: %u",
+        this->connection_handle_, mode, this->bytes_per_sec_,
+        parameters.interval_min, parameters.interval_max,
+        parameters.slave_latency, status);
+
+    if (status != operations::status::success)
+    {
+        return false;
+    }
+
+    this->mode_           = mode;
+    this->request_count_ += 1u;
+
+    bool const is_loaded = (mode == link_mode::loaded);
+
+    phy_layer_parameters const phy = is_loaded ? phy_layer_parameters::rate_2_Mbps :
+                                                 phy_layer_parameters::rate_1_Mbps;
+    if (this->phy_tx_ != phy)
+    {
+        status = this->operations_.phy_update_request(this->connection_handle_, phy, phy);
+        if (status == operations::status::success)
+        {
+            this->request_count_ += 1u;
+        }
+    }
+
+    // The idle data length is only restored once a longer length was set;
+    // zero means the link layer has not reported a data length update.
+    bool const is_data_length_update = is_loaded ?
+        (this->data_length_ < this->policy_.data_length_max) :
+        (this->data_length_ > this->policy_.data_length_idle);
+
+    if (is_data_length_update)
+    {
+        uint16_t const data_length = is_loaded ? this->policy_.data_length_max :
+                                                 this->policy_.data_length_idle;
+
+        // A zero time in microseconds lets the link layer choose the
+        // time which corresponds to the data length and PHY.
+        status = this->operations_.link_layer_length_update_request(
+            this->connection_handle_, data_length, 0u, data_length, 0u);
+        if (status == operations::status::success)
+        {
+            this->request_count_ += 1u;
+        }
+    }
+
+    return true;
+}
+
+void connection_rate_observer::connect(uint16_t                 connection_handle,
+                                       ble::gap::address const& peer_address,
+                                       uint8_t                  peer_address_id)
+{
+    this->controller_.connect(connection_handle);
+}
+
+void connection_rate_observer::disconnect(uint16_t              connection_handle,
+                                          ble::hci::error_code  error_code)
+{
+    if (connection_handle == this->controller_.get_connection_handle())
+    {
+        this->controller_.disconnect();
+    }
+}
+
+void connection_rate_observer::connection_parameter_update(
+    uint16_t                        connection_handle,
+    connection_parameters const&    parameters)
+{
+    if (connection_handle == this->controller_.get_connection_handle())
+    {
+        this->controller_.connection_parameter_update(parameters);
+    }
+}
+
+void connection_rate_observer::phy_update(uint16_t              connection_handle,
+                                          ble::hci::error_code  status,
+                                          phy_layer_parameters  phy_rx,
+                                          phy_layer_parameters  phy_tx)
+{
+    if ((connection_handle == this->controller_.get_connection_handle()) &&
+        (status == ble::hci::error_code::success))
+    {
+        this->controller_.phy_update(phy_tx, phy_rx);
+    }
+}
+
+void connection_rate_observer::link_layer_update(uint16_t connection_handle,
+                                                 uint16_t rx_length_max,
+                                                 uint16_t rx_interval_usec_max,
+                                                 uint16_t tx_length_max,
+                                                 uint16_t tx_interval_usec_max)
+{
+    if (connection_handle == this->controller_.get_connection_handle())
+    {
+        this->controller_.link_layer_update(tx_length_max, rx_length_max);
+    }
+}
+
+} // namespace gap
+} // namespace ble
@@ -0,0 +1,218 @@
+/**
+ * @file ble/gap_connection_rate_controller.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Adapt the GAP connection parameters, PHY and data length to the traffic
+ * carried by a connection.
+ */
+
+#pragma once
+
+#include "ble/att.h"
+#include "ble/gap_types.h"
+#include "ble/gap_connection_parameters.h"
+#include "ble/gap_event_observer.h"
+#include "ble/gap_operations.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ble
+{
+namespace gap
+{
+
+/**
+ * @class connection_rate_controller
+ * Measure per-link throughput (notifications sent and writes received) and
+ * the transmit queue depth. Under load request a short connection interval,
+ * the 2 Mbps PHY and the maximum data length. When idle fall back to a long
+ * connection interval with slave latency, the 1 Mbps PHY and the idle data
+ * length.
+ *
+ * - Hysteresis: the link enters the loaded mode when the throughput rises to
+ *   load_bytes_per_sec (or the queue depth reaches load_queue_depth).
+ *   It returns to idle only after the throughput has remained at or below
+ *   idle_bytes_per_sec, with an empty queue, for idle_hold_msec.
+ * - Rate limit: successive connection parameter requests are separated by
+ *   at least request_interval_min_msec.
+ *
+ * The controller does not own a timer; update() is called periodically with
+ * the current time. Time is expressed in milliseconds and may wrap.
+ * The link state events are forwarded from the GAP events by a
+ * connection_rate_observer.
+ */
+class connection_rate_controller
+{
+public:
+    enum class link_mode: uint8_t
+    {
+        idle,
+        loaded
+    };
+
+    /**
+     * @struct policy
+     * The connection settings for each link_mode and the thresholds which
+     * control the transitions between them.
+     */
+    struct policy
+    {
+        connection_parameters   loaded_parameters;
+        connection_parameters   idle_parameters;
+
+        uint32_t    load_bytes_per_sec;
+        uint32_t    idle_bytes_per_sec;
+        std::size_t load_queue_depth;
+        uint32_t    idle_hold_msec;
+        uint32_t    request_interval_min_msec;
+
+        /// The link layer data length requested under load.
+        uint16_t    data_length_max;
+
+        /// The link layer data length restored when idle.
+        uint16_t    data_length_idle;
+    };
+
+    /**
+     * A default policy:
+     * loaded: [7.5:15] msec interval, no latency.
+     * idle:   [400:500] msec interval, slave latency 4, 27 byte data length.
+     */
+    static policy const default_policy;
+
+    ~connection_rate_controller()                                       = default;
+
+    connection_rate_controller()                                        = delete;
+    connection_rate_controller(connection_rate_controller const&)       = delete;
+    connection_rate_controller(connection_rate_controller &&)           = delete;
+    connection_rate_controller& operator=(connection_rate_controller const&) = delete;
+    connection_rate_controller& operator=(connection_rate_controller&&) = delete;
+
+    /**
+     * @param operations  The GAP operations used to request link changes.
+     * @param rate_policy The policy is copied; a temporary may be passed.
+     */
+    connection_rate_controller(ble::gap::operations& operations,
+                               policy const&         rate_policy = default_policy);
+
+    /// @{ Connection lifetime and link state events.
+    /// The first update() after connect() starts the throughput measurement.
+    void connect(uint16_t connection_handle);
+    void disconnect();
+    void connection_parameter_update(connection_parameters const& parameters);
+    void phy_update(phy_layer_parameters phy_tx, phy_layer_parameters phy_rx);
+    void link_layer_update(uint16_t tx_length_max, uint16_t rx_length_max);
+    /// @}
+
+    /// @{ Traffic measurement.
+    void record_notification(ble::att::length_t length);
+    void record_write(ble::att::length_t length);
+    void set_queue_depth(std::size_t queue_depth);
+    /// @}
+
+    /**
+     * Evaluate the measured traffic and request link changes as needed.
+     *
+     * @param now_msec The current time in milliseconds.
+     * @return link_mode The mode of the link after evaluation.
+     */
+    link_mode update(uint32_t now_msec);
+
+    link_mode mode() const { return this->mode_; }
+
+    /// @return uint32_t The filtered throughput in bytes per second.
+    uint32_t bytes_per_sec() const { return this->bytes_per_sec_; }
+
+    /// @return uint32_t The number of link change requests made.
+    uint32_t request_count() const { return this->request_count_; }
+
+    connection_parameters const& get_connection_parameters() const {
+        return this->connection_parameters_;
+    }
+
+    uint16_t get_connection_handle() const { return this->connection_handle_; }
+
+    bool is_connected() const {
+        return this->connection_handle_ != ble::gap::handle_invalid;
+    }
+
+private:
+    /// The throughput filter weight: new = old + (sample - old) / 2^shift.
+    static constexpr uint8_t const filter_shift = 2u;
+
+    bool request_mode(link_mode mode, uint32_t now_msec);
+    bool is_request_allowed(uint32_t now_msec) const;
+
+    ble::gap::operations&   operations_;
+    policy const            policy_;
+
+    uint16_t                connection_handle_;
+    link_mode               mode_;
+    connection_parameters   connection_parameters_;
+    phy_layer_parameters    phy_tx_;
+    uint16_t                data_length_;
+
+    uint32_t                bytes_pending_;
+    std::size_t             queue_depth_;
+    uint32_t                bytes_per_sec_;
+
+    uint32_t                sample_msec_;
+    uint32_t                request_msec_;
+    uint32_t                quiet_since_msec_;
+    bool                    is_quiet_;
+    bool                    is_sample_started_;
+    bool                    request_made_;
+
+    uint32_t                request_count_;
+};
+
+/**
+ * @class connection_rate_observer
+ * Forward the GAP connection and link state events to a
+ * connection_rate_controller. Events for connections other than the one
+ * the controller is tracking are ignored.
+ */
+class connection_rate_observer: public ble::gap::event_observer
+{
+public:
+    virtual ~connection_rate_observer() override                    = default;
+
+    connection_rate_observer()                                      = delete;
+    connection_rate_observer(connection_rate_observer const&)       = delete;
+    connection_rate_observer(connection_rate_observer &&)           = delete;
+    connection_rate_observer& operator=(connection_rate_observer const&) = delete;
+    connection_rate_observer& operator=(connection_rate_observer&&) = delete;
+
+    explicit connection_rate_observer(connection_rate_controller& controller):
+        controller_(controller)
+    {}
+
+    void connect(uint16_t                   connection_handle,
+                 ble::gap::address const&   peer_address,
+                 uint8_t                    peer_address_id) override;
+
+    void disconnect(uint16_t                connection_handle,
+                    ble::hci::error_code    error_code) override;
+
+    void connection_parameter_update(
+        uint16_t                        connection_handle,
+        connection_parameters const&    parameters) override;
+
+    void phy_update(uint16_t                connection_handle,
+                    ble::hci::error_code    status,
+                    phy_layer_parameters    phy_rx,
+                    phy_layer_parameters    phy_tx) override;
+
+    void link_layer_update(uint16_t connection_handle,
+                           uint16_t rx_length_max,
+                           uint16_t rx_interval_usec_max,
+                           uint16_t tx_length_max,
+                           uint16_t tx_interval_usec_max) override;
+
+private:
+    connection_rate_controller& controller_;
+};
+
+} // namespace gap
+} // namespace ble
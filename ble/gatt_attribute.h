@@ -87,6 +87,17 @@ struct attribute
         return this->data_length() != this->data_length_max();
     }
 
+    /**
+     * Attributes which do not hold their value inline may have their value
+     * located in a ble::gatt::attribute_arena when the service is added to
+     * the GATT server. Until then data_pointer() returns nullptr and the
+     * value is held by the BLE stack.
+     *
+     * @param location The arena storage; data_length_max() bytes, zero filled.
+     * @return bool true if the attribute uses location as its value storage.
+     */
+    virtual bool value_relocate(void* location) { return false; }
+
     /**
      * All atributes, which include characterisitics and descriptors are
      * held within some other container:
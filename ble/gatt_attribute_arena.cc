@@ -0,0 +1,106 @@
+/**
+ * @file ble/gatt_attribute_arena.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "ble/gatt_attribute_arena.h"
+#include "logger.h"
+#include "project_assert.h"
+
+#include <cstring>
+
+namespace ble
+{
+namespace gatt
+{
+
+attribute_arena::attribute_arena(void* buffer, std::size_t size)
+:   buffer_(static_cast<uint8_t*>(buffer)),
+    capacity_(size),
+    size_(0u),
+    padding_(0u),
+    attribute_count_(0u)
+{
+    ASSERT((reinterpret_cast<uintptr_t>(buffer) % alignment) == 0u);
+}
+
+void* attribute_arena::allocate(ble::gatt::attribute& attribute)
+{
+    std::size_t const length = attribute.data_length_max();
+    if (length == 0u)
+    {
+        return nullptr;
+    }
+
+    std::size_t const offset  = (this->size_ + alignment - 1u) & ~(alignment - 1u);
+    if (offset + length > this->capacity_)
+    {
+        logger::instance().warn(
+            "attribute_arena: full: attribute type: 0x%04x, length: %u, %u / %u",
+            static_cast<uint16_t>(attribute.decl.attribute_type),
+            length, this->size_, this->capacity_);
+        return nullptr;
+    }
+
+    uint8_t* const location = this->buffer_ + offset;
+    std::memset(location, 0, length);
+
+    if (not attribute.value_relocate(location))
+    {
+        return nullptr;
+    }
+
+    this->padding_         += offset - this->size_;
+    this->size_             = offset + length;
+    this->attribute_count_ += 1u;
+
+    return location;
+}
+
+std::size_t attribute_arena::layout(ble::gatt::service& service)
+{
+    std::size_t count = 0u;
+    for (ble::gatt::attribute& attribute : service.characteristic_list)
+    {
+        if (this->allocate(attribute))
+        {
+            count += 1u;
+        }
+    }
+
+    return count;
+}
+
+void attribute_arena::clear()
+{
+    this->size_            = 0u;
+    this->padding_         = 0u;
+    this->attribute_count_ = 0u;
+}
+
+std::size_t attribute_arena::snapshot(void*       snapshot_data,
+                                      std::size_t snapshot_size) const
+{
+    if (snapshot_size < this->size_)
+    {
+        return 0u;
+    }
+
+    std::memcpy(snapshot_data, this->buffer_, this->size_);
+    return this->size_;
+}
+
+bool attribute_arena::restore(void const* snapshot_data,
+                              std::size_t snapshot_length)
+{
+    if (snapshot_length != this->size_)
+    {
+        return false;
+    }
+
+    std::memcpy(this->buffer_, snapshot_data, snapshot_length);
+    return true;
+}
+
+} // namespace gatt
+} // namespace ble
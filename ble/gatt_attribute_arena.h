@@ -0,0 +1,109 @@
+/**
+ * @file ble/gatt_attribute_arena.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A contiguous store for GATT server attribute values.
+ */
+
+#pragma once
+
+#include "ble/gatt_attribute.h"
+#include "ble/gatt_service.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ble
+{
+namespace gatt
+{
+
+/**
+ * @class attribute_arena
+ * Attribute values laid out contiguously, in the order they are allocated.
+ * Allocating when a service is added to the GATT server places the values
+ * in handle order.
+ *
+ * - Attribute values are user located: the BLE stack reads and writes the
+ *   arena directly, so value updates need no copies into the stack.
+ * - The attribute database is saved and restored with a single memcpy()
+ *   using snapshot() and restore().
+ *
+ * Only attributes which implement ble::gatt::attribute::value_relocate()
+ * are placed in the arena; others keep their inline storage.
+ * Each value is aligned to 4 bytes so that typed values are accessible in
+ * place.
+ */
+class attribute_arena
+{
+public:
+    static constexpr std::size_t const alignment = sizeof(uint32_t);
+
+    ~attribute_arena()                                  = default;
+
+    attribute_arena()                                   = delete;
+    attribute_arena(attribute_arena const&)             = delete;
+    attribute_arena(attribute_arena &&)                 = delete;
+    attribute_arena& operator=(attribute_arena const&)  = delete;
+    attribute_arena& operator=(attribute_arena&&)       = delete;
+
+    /**
+     * @param buffer The arena storage; must be aligned to 4 bytes.
+     * @param size   The size of buffer in bytes.
+     */
+    attribute_arena(void* buffer, std::size_t size);
+
+    /**
+     * Allocate the attribute value in the arena.
+     *
+     * @param attribute The attribute to relocate.
+     * @return void* The arena location of the value; nullptr if the attribute
+     *         value is not relocatable or the arena is full.
+     */
+    void* allocate(ble::gatt::attribute& attribute);
+
+    /**
+     * Allocate the values of the service characteristics, in handle order.
+     * @return std::size_t The number of values placed in the arena.
+     */
+    std::size_t layout(ble::gatt::service& service);
+
+    /** Release all values. The attributes must not be used afterwards. */
+    void clear();
+
+    /** @return std::size_t The number of bytes allocated, including padding. */
+    std::size_t size() const { return this->size_; }
+    std::size_t capacity() const { return this->capacity_; }
+
+    /** @return std::size_t The number of bytes of alignment padding. */
+    std::size_t padding() const { return this->padding_; }
+
+    std::size_t attribute_count() const { return this->attribute_count_; }
+
+    uint8_t const* data() const { return this->buffer_; }
+
+    /**
+     * Copy the attribute values out of the arena.
+     * @return std::size_t The number of bytes copied, size();
+     *         zero if snapshot_size is too small.
+     */
+    std::size_t snapshot(void* snapshot_data, std::size_t snapshot_size) const;
+
+    /**
+     * Copy the attribute values previously saved with snapshot() into the
+     * arena. The arena layout must be the same as when the snapshot was made.
+     *
+     * @return bool true if restored, false if the length is not size().
+     */
+    bool restore(void const* snapshot_data, std::size_t snapshot_length);
+
+private:
+    uint8_t* const      buffer_;
+    std::size_t const   capacity_;
+    std::size_t         size_;
+    std::size_t         padding_;
+    std::size_t         attribute_count_;
+};
+
+} // namespace gatt
+} // namespace ble
@@ -5,6 +5,7 @@
 
 #include "gatt_service_container.h"
 #include "logger.h"
+#include "profile.h"
 #include "project_assert.h"
 
 #include <algorithm>
@@ -92,6 +93,8 @@ ble::att::handle_range service_container::service_handle_range(
 ble::gatt::characteristic const*
     service_container::find_characteristic(uint16_t handle) const
 {
+    PROFILE_ZONE("find_characteristic");
+
     for (ble::gatt::service const& service : *this)
     {
         ble::gatt::attribute const* attribute = service.find_attribute(handle);
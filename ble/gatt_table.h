@@ -0,0 +1,408 @@
+/**
+ * @file ble/gatt_table.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A GATT server attribute table built at compile time from a schema.
+ */
+
+#pragma once
+
+#include "ble/att.h"
+#include "ble/uuid.h"
+#include "ble/gatt_declaration.h"
+#include "ble/gatt_enum_types.h"
+
+#include <boost/uuid/uuid.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ble
+{
+namespace gatt
+{
+
+/**
+ * @struct table_attribute
+ * An attribute of a GATT server table; one entry per attribute handle.
+ *
+ * The uuid of an attribute is either a Bluetooth SIG 16-bit uuid, when
+ * uuid_base is null, or a vendor specific 128-bit uuid: uuid_base with the
+ * 16-bit uuid value in bytes [2:3]. This is the form in which the Nordic
+ * softdevice holds vendor specific uuids.
+ */
+struct table_attribute
+{
+    static constexpr uint16_t const value_offset_none = UINT16_MAX;
+
+    uint16_t                    handle;
+
+    /**
+     * The attribute type of a service, characteristic or descriptor
+     * declaration. A characteristic value is attribute_type::undefined;
+     * its attribute type is the characteristic uuid.
+     */
+    attribute_type              type;
+
+    /**
+     * - Service declaration:        The service uuid.
+     * - Characteristic declaration: The characteristic uuid.
+     * - Characteristic value:       The characteristic uuid.
+     * - Descriptor:                 The descriptor type.
+     */
+    uint16_t                    uuid;
+    boost::uuids::uuid const*   uuid_base;
+
+    /// The characteristic properties; for declarations and values.
+    uint16_t                    properties;
+
+    /// The value lengths; a length less than length_max is variable length.
+    uint16_t                    length;
+    uint16_t                    length_max;
+
+    /// The characteristic value offset within the table value storage.
+    uint16_t                    value_offset;
+
+    /// The handle of the service which contains the attribute.
+    uint16_t                    service_handle;
+
+    constexpr bool is_service() const {
+        return (this->type == attribute_type::primary_service) ||
+               (this->type == attribute_type::secondary_service);
+    }
+
+    constexpr bool is_characteristic() const {
+        return this->type == attribute_type::characteristic;
+    }
+
+    constexpr bool is_value() const {
+        return this->type == attribute_type::undefined;
+    }
+
+    bool data_length_is_variable() const {
+        return this->length != this->length_max;
+    }
+
+    /// @return att::uuid The full 128-bit uuid of the attribute.
+    att::uuid uuid_value() const
+    {
+        if (this->uuid_base == nullptr)
+        {
+            return att::uuid(static_cast<uint32_t>(this->uuid));
+        }
+
+        att::uuid uuid_128(*this->uuid_base);
+        uuid_128.data[2u] = static_cast<uint8_t>(this->uuid >> 8u);
+        uuid_128.data[3u] = static_cast<uint8_t>(this->uuid >> 0u);
+        return uuid_128;
+    }
+};
+
+/**
+ * The schema types from which a table is built.
+ *
+ * @example The battery service, with notifications on the battery level:
+ * using battery_service = schema::service<
+ *     schema::uuid16<service_type::battery_service>,
+ *     schema::characteristic<
+ *         schema::uuid16<characteristic_type::battery_level>,
+ *         properties::read | properties::notify,
+ *         uint8_t,
+ *         schema::cccd>>;
+ */
+namespace schema
+{
+
+/// A Bluetooth SIG 16-bit uuid; an enum value or integer.
+template <auto uuid_16>
+struct uuid16
+{
+    static constexpr uint16_t                  const value = static_cast<uint16_t>(uuid_16);
+    static constexpr boost::uuids::uuid const* const base  = nullptr;
+};
+
+/**
+ * A vendor specific 128-bit uuid: uuid_base with uuid_16 in bytes [2:3].
+ * @note uuid_base must be a constexpr object with static storage.
+ */
+template <boost::uuids::uuid const& uuid_base, uint16_t uuid_16 = 0u>
+struct uuid128
+{
+    static constexpr uint16_t                  const value = uuid_16;
+    static constexpr boost::uuids::uuid const* const base  = &uuid_base;
+};
+
+/// A variable length value of length_max octets; initially empty.
+template <std::size_t length_max>
+struct variable_length;
+
+template <typename value_type>
+struct value_length
+{
+    static constexpr uint16_t const length     = sizeof(value_type);
+    static constexpr uint16_t const length_max = sizeof(value_type);
+};
+
+template <std::size_t value_length_max>
+struct value_length<variable_length<value_length_max>>
+{
+    static constexpr uint16_t const length     = 0u;
+    static constexpr uint16_t const length_max = value_length_max;
+};
+
+/**
+ * @struct descriptor
+ * The descriptors which the softdevice creates from the characteristic
+ * properties. Their values are held by the BLE stack.
+ */
+template <descriptor_type descriptor_uuid>
+struct descriptor
+{
+    static_assert((descriptor_uuid == descriptor_type::cccd) ||
+                  (descriptor_uuid == descriptor_type::sccd),
+                  "only the cccd and sccd descriptors are supported");
+
+    static constexpr descriptor_type const type     = descriptor_uuid;
+    static constexpr uint16_t        const length   = sizeof(uint16_t);
+};
+
+using cccd = descriptor<descriptor_type::cccd>;
+using sccd = descriptor<descriptor_type::sccd>;
+
+/**
+ * @struct characteristic
+ * A characteristic declaration, its value and its descriptors;
+ * assigned handles in that order.
+ *
+ * @tparam uuid_type       schema::uuid16 or schema::uuid128.
+ * @tparam property_bits   ble::gatt::properties bits.
+ * @tparam value_type      The value type, which determines the value length,
+ *                         or schema::variable_length.
+ * @tparam descriptor_types The descriptors in handle order.
+ */
+template <typename uuid_type, uint16_t property_bits, typename value_type,
+          typename... descriptor_types>
+struct characteristic
+{
+    static constexpr std::size_t const attribute_count = 2u + sizeof...(descriptor_types);
+
+    static constexpr uint16_t const length     = value_length<value_type>::length;
+    static constexpr uint16_t const length_max = value_length<value_type>::length_max;
+
+    static constexpr std::size_t const cccd_count =
+        (0u + ... + (descriptor_types::type == descriptor_type::cccd));
+    static constexpr std::size_t const sccd_count =
+        (0u + ... + (descriptor_types::type == descriptor_type::sccd));
+
+    // The softdevice adds a cccd for notify or indicate and a sccd for
+    // broadcast; the handles within the table must agree.
+    static_assert(cccd_count == ((property_bits & (properties::notify | properties::indicate)) ? 1u : 0u),
+                  "a cccd is required if and only if notify or indicate is set");
+    static_assert(sccd_count == ((property_bits & properties::broadcast) ? 1u : 0u),
+                  "a sccd is required if and only if broadcast is set");
+
+    static constexpr bool descriptors_in_handle_order()
+    {
+        descriptor_type const types[] = { descriptor_types::type..., descriptor_type::cccd };
+        return (sizeof...(descriptor_types) < 2u) || (types[0u] == descriptor_type::cccd);
+    }
+
+    static_assert(descriptors_in_handle_order(),
+                  "the softdevice assigns the cccd handle before the sccd handle");
+
+    template <std::size_t attribute_count_table>
+    static constexpr void emit(std::array<table_attribute, attribute_count_table>& attributes,
+                               std::size_t&     index,
+                               uint16_t         handle_first,
+                               uint16_t         service_handle,
+                               std::size_t&     value_offset)
+    {
+        uint16_t const handle = static_cast<uint16_t>(handle_first + index);
+        attributes[index++] = {
+            handle, attribute_type::characteristic,
+            uuid_type::value, uuid_type::base, property_bits,
+            0u, 0u, table_attribute::value_offset_none, service_handle
+        };
+
+        attributes[index++] = {
+            static_cast<uint16_t>(handle + 1u), attribute_type::undefined,
+            uuid_type::value, uuid_type::base, property_bits,
+            length, length_max, static_cast<uint16_t>(value_offset), service_handle
+        };
+
+        // Each value is aligned to 4 bytes so that typed values are
+        // accessible in place; as in ble::gatt::attribute_arena.
+        value_offset += (length_max + sizeof(uint32_t) - 1u) & ~(sizeof(uint32_t) - 1u);
+
+        // The trailing elements permit a characteristic without descriptors.
+        descriptor_type const types[]   = { descriptor_types::type..., descriptor_type::cccd };
+        uint16_t        const lengths[] = { descriptor_types::length..., 0u };
+        for (std::size_t desc_index = 0u; desc_index < sizeof...(descriptor_types); ++desc_index)
+        {
+            attributes[index] = {
+                static_cast<uint16_t>(handle_first + index),
+                static_cast<attribute_type>(types[desc_index]),
+                static_cast<uint16_t>(types[desc_index]), nullptr, 0u,
+                lengths[desc_index], lengths[desc_index],
+                table_attribute::value_offset_none, service_handle
+            };
+            ++index;
+        }
+    }
+};
+
+/**
+ * @struct service
+ * A service declaration followed by its characteristics.
+ *
+ * @note The GAP (0x1800) and GATT (0x1801) services are configured through
+ *       the softdevice by other means and are not part of a table.
+ */
+template <typename uuid_type, attribute_type service_attribute_type,
+          typename... characteristic_types>
+struct service_declaration
+{
+    static_assert((service_attribute_type == attribute_type::primary_service) ||
+                  (service_attribute_type == attribute_type::secondary_service));
+    static_assert((uuid_type::base != nullptr) ||
+                  ((uuid_type::value != static_cast<uint16_t>(service_type::generic_access)) &&
+                   (uuid_type::value != static_cast<uint16_t>(service_type::generic_attribute))),
+                  "the GAP and GATT services are not table services");
+
+    static constexpr std::size_t const attribute_count =
+        (1u + ... + characteristic_types::attribute_count);
+
+    template <std::size_t attribute_count_table>
+    static constexpr void emit(std::array<table_attribute, attribute_count_table>& attributes,
+                               std::size_t&     index,
+                               uint16_t         handle_first,
+                               std::size_t&     value_offset)
+    {
+        uint16_t const handle = static_cast<uint16_t>(handle_first + index);
+        attributes[index++] = {
+            handle, service_attribute_type,
+            uuid_type::value, uuid_type::base, 0u,
+            0u, 0u, table_attribute::value_offset_none, handle
+        };
+
+        (characteristic_types::emit(attributes, index, handle_first, handle, value_offset), ...);
+    }
+};
+
+template <typename uuid_type, typename... characteristic_types>
+using service = service_declaration<uuid_type,
+                                    attribute_type::primary_service,
+                                    characteristic_types...>;
+
+template <typename uuid_type, typename... characteristic_types>
+using secondary_service = service_declaration<uuid_type,
+                                              attribute_type::secondary_service,
+                                              characteristic_types...>;
+
+} // namespace schema
+
+/**
+ * @class table
+ * A GATT server attribute table, in handle order, built at compile time.
+ *
+ * The attributes are constexpr and are located in flash. Handles are
+ * assigned consecutively from handle_first in the order that the softdevice
+ * assigns them: the service declaration, then for each characteristic its
+ * declaration, value and descriptors. Finding an attribute by handle is an
+ * index into the table.
+ *
+ * Characteristic values are held in a value_storage buffer in RAM,
+ * laid out for the BLE stack to hold as user located values.
+ *
+ * @note No BLE stack registration is provided yet; the applications add
+ * their services at runtime with nordic::gatts_service_add(), whose
+ * characteristic objects also handle the GATTS read and write events.
+ *
+ * @tparam handle_first    The handle of the first service of the table.
+ *                         The softdevice GAP and GATT services precede it.
+ * @tparam service_types   The schema::service types in handle order.
+ *
+ * @example
+ * using gatt_table = ble::gatt::table<12u, battery_service, adc_service>;
+ * static gatt_table::value_storage gatt_values;
+ * uint8_t* level = static_cast<uint8_t*>(gatt_table::find_value(gatt_values, 14u));
+ */
+template <uint16_t handle_first, typename... service_types>
+class table
+{
+public:
+    static constexpr std::size_t const attribute_count =
+        (0u + ... + service_types::attribute_count);
+
+    static_assert(attribute_count > 0u);
+    static_assert(handle_first != att::handle_invalid);
+    static_assert(handle_first + attribute_count - 1u <= att::handle_maximum);
+
+    using attribute_container = std::array<table_attribute, attribute_count>;
+
+    ~table()                            = delete;
+    table()                             = delete;
+    table(table const&)                 = delete;
+    table(table&&)                      = delete;
+    table& operator=(table const&)      = delete;
+    table& operator=(table&&)           = delete;
+
+    /// The size of the characteristic value storage in bytes.
+    static constexpr std::size_t const value_storage_size = []() {
+        attribute_container attributes   = {};
+        std::size_t         index        = 0u;
+        std::size_t         value_offset = 0u;
+        (service_types::emit(attributes, index, handle_first, value_offset), ...);
+        return value_offset;
+    }();
+
+    static_assert(value_storage_size < table_attribute::value_offset_none);
+
+    /// The characteristic value storage; word aligned.
+    using value_storage = std::array<uint32_t, (value_storage_size + 3u) / 4u>;
+
+    static constexpr attribute_container const attributes = []() {
+        attribute_container attributes   = {};
+        std::size_t         index        = 0u;
+        std::size_t         value_offset = 0u;
+        (service_types::emit(attributes, index, handle_first, value_offset), ...);
+        return attributes;
+    }();
+
+    static constexpr uint16_t handle_begin() { return handle_first; }
+    static constexpr uint16_t handle_end()   {
+        return static_cast<uint16_t>(handle_first + attribute_count);
+    }
+
+    /**
+     * Find the attribute associated with the handle.
+     * @return table_attribute const* The attribute; nullptr if the handle is
+     *         not within the table.
+     */
+    static constexpr table_attribute const* find(uint16_t handle)
+    {
+        return ((handle >= handle_begin()) && (handle < handle_end())) ?
+            &attributes[handle - handle_first] : nullptr;
+    }
+
+    /**
+     * Find the characteristic value associated with the handle.
+     * @return void* The value within the storage; nullptr if the handle is
+     *         not a characteristic value handle.
+     */
+    static void* find_value(value_storage& storage, uint16_t handle)
+    {
+        table_attribute const* attribute = find(handle);
+        if ((attribute == nullptr) || (not attribute->is_value()))
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<uint8_t*>(storage.data()) + attribute->value_offset;
+    }
+};
+
+} // namespace gatt
+} // namespace ble
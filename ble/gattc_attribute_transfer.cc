@@ -0,0 +1,663 @@
+/**
+ * @file ble/gattc_attribute_transfer.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "ble/gattc_attribute_transfer.h"
+#include "ble/gap_types.h"
+#include "std_error.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace ble
+{
+namespace gattc
+{
+
+/// The Read Response value is at most (ATT_MTU - 1) bytes.
+static constexpr ble::att::length_t const read_overhead    = 1u;
+
+/// The Write Request value is at most (ATT_MTU - 3) bytes.
+static constexpr ble::att::length_t const write_overhead   = 3u;
+
+/// The Prepare Write Request value is at most (ATT_MTU - 5) bytes.
+static constexpr ble::att::length_t const prepare_overhead = 5u;
+
+attribute_transfer::attribute_transfer(ble::gattc::operations& operations,
+                                       ble::att::length_t      client_mtu)
+:   super(),
+    operations_(operations),
+    client_mtu_(client_mtu),
+    mtu_(ble::att::mtu_length_minimum),
+    transfer_(transfer::none),
+    request_(request::none),
+    notify_(nullptr),
+    connection_handle_(ble::gap::handle_invalid),
+    attribute_handle_(ble::att::handle_invalid),
+    read_data_(nullptr),
+    write_data_(nullptr),
+    size_(0u),
+    offset_(0u),
+    chunk_length_(0u),
+    error_code_(ble::att::error_code::success),
+    values_(nullptr),
+    value_count_(0u),
+    value_index_(0u),
+    batch_count_(0u),
+    variable_length_(false),
+    variable_supported_(true),
+    handles_{},
+    request_count_(0u)
+{
+}
+
+void attribute_transfer::set_mtu(ble::att::length_t mtu)
+{
+    this->mtu_ = std::clamp(mtu, ble::att::mtu_length_minimum,
+                                 ble::att::mtu_length_maximum);
+}
+
+std::errc attribute_transfer::read(uint16_t             connection_handle,
+                                   uint16_t             attribute_handle,
+                                   void*                buffer,
+                                   ble::att::length_t   size,
+                                   completion_notify*   notify)
+{
+    if (this->is_busy())
+    {
+        return std::errc::device_or_resource_busy;
+    }
+
+    if ((buffer == nullptr) || (size == 0u))
+    {
+        return std::errc::invalid_argument;
+    }
+
+    this->transfer_          = transfer::read;
+    this->notify_            = notify;
+    this->connection_handle_ = connection_handle;
+    this->attribute_handle_  = attribute_handle;
+    this->read_data_         = static_cast<uint8_t*>(buffer);
+    this->size_              = size;
+    this->offset_            = 0u;
+
+    std::errc const error = this->request_read();
+    if (is_failure(error))
+    {
+        this->transfer_ = transfer::none;
+    }
+    return error;
+}
+
+std::errc attribute_transfer::write(uint16_t            connection_handle,
+                                    uint16_t            attribute_handle,
+                                    void const*         data,
+                                    ble::att::length_t  length,
+                                    completion_notify*  notify)
+{
+    if (this->is_busy())
+    {
+        return std::errc::device_or_resource_busy;
+    }
+
+    if ((data == nullptr) && (length > 0u))
+    {
+        return std::errc::invalid_argument;
+    }
+
+    this->transfer_          = transfer::write;
+    this->notify_            = notify;
+    this->connection_handle_ = connection_handle;
+    this->attribute_handle_  = attribute_handle;
+    this->write_data_        = static_cast<uint8_t const*>(data);
+    this->size_              = length;
+    this->offset_            = 0u;
+    this->error_code_        = ble::att::error_code::success;
+
+    std::errc error = errc_success;
+    if (length <= this->mtu_ - write_overhead)
+    {
+        this->request_        = request::write;
+        this->request_count_ += 1u;
+        error = this->operations_.write_request(connection_handle,
+                                                attribute_handle,
+                                                data, 0u, length);
+    }
+    else
+    {
+        error = this->request_prepare();
+    }
+
+    if (is_failure(error))
+    {
+        this->request_  = request::none;
+        this->transfer_ = transfer::none;
+    }
+    return error;
+}
+
+std::errc attribute_transfer::read_multiple(uint16_t            connection_handle,
+                                            attribute_value*    values,
+                                            std::size_t         value_count,
+                                            bool                variable_length,
+                                            completion_notify*  notify)
+{
+    if (this->is_busy())
+    {
+        return std::errc::device_or_resource_busy;
+    }
+
+    if ((values == nullptr) || (value_count == 0u))
+    {
+        return std::errc::invalid_argument;
+    }
+
+    for (std::size_t index = 0u; index < value_count; ++index)
+    {
+        values[index].length = 0u;
+    }
+
+    this->transfer_          = transfer::read_multiple;
+    this->notify_            = notify;
+    this->connection_handle_ = connection_handle;
+    this->attribute_handle_  = ble::att::handle_invalid;
+    this->values_            = values;
+    this->value_count_       = value_count;
+    this->value_index_       = 0u;
+    this->variable_length_   = variable_length;
+
+    std::errc const error = this->request_next_value();
+    if (is_failure(error))
+    {
+        this->request_  = request::none;
+        this->transfer_ = transfer::none;
+    }
+    return error;
+}
+
+std::errc attribute_transfer::request_read()
+{
+    this->request_        = request::read;
+    this->request_count_ += 1u;
+
+    // An offset of zero issues the Read Request, otherwise Read Blob.
+    std::errc const error = this->operations_.read(this->connection_handle_,
+                                                   this->attribute_handle_,
+                                                   this->offset_);
+    if (is_failure(error))
+    {
+        this->request_ = request::none;
+    }
+    return error;
+}
+
+std::errc attribute_transfer::request_prepare()
+{
+    this->chunk_length_ = std::min<ble::att::length_t>(
+        this->mtu_ - prepare_overhead, this->size_ - this->offset_);
+
+    this->request_        = request::write_prepare;
+    this->request_count_ += 1u;
+
+    std::errc const error = this->operations_.write_prepare(
+        this->connection_handle_,
+        this->attribute_handle_,
+        this->write_data_ + this->offset_,
+        this->offset_,
+        this->chunk_length_);
+    if (is_failure(error))
+    {
+        this->request_ = request::none;
+    }
+    return error;
+}
+
+std::size_t attribute_transfer::read_multiple_batch(std::size_t handle_limit,
+                                                    std::size_t value_length_limit)
+{
+    std::size_t count        = 0u;
+    std::size_t value_length = 0u;
+    for (std::size_t index = this->value_index_;
+         (index < this->value_count_) && (count < handle_limit); ++index)
+    {
+        value_length += this->values_[index].size;
+        if (value_length > value_length_limit)
+        {
+            break;
+        }
+        this->handles_[count++] = this->values_[index].handle;
+    }
+
+    this->batch_count_ = count;
+    return count;
+}
+
+std::errc attribute_transfer::request_next_value()
+{
+    if (this->value_index_ >= this->value_count_)
+    {
+        this->complete(ble::att::error_code::success, ble::att::handle_invalid);
+        return errc_success;
+    }
+
+    std::size_t const handle_limit = std::min<std::size_t>(
+        handles_max, (this->mtu_ - read_overhead) / sizeof(uint16_t));
+
+    if (this->variable_length_ && this->variable_supported_)
+    {
+        // Values which do not fit are truncated by the server;
+        // request as many as the PDU can name.
+        std::size_t const batch_count = this->read_multiple_batch(
+            handle_limit, std::numeric_limits<std::size_t>::max());
+        if (batch_count > 1u)
+        {
+            this->request_        = request::read_multiple_variable;
+            this->request_count_ += 1u;
+            std::errc const error = this->operations_.read_multiple_variable(
+                this->connection_handle_, this->handles_, batch_count);
+
+            if (error != std::errc::function_not_supported)
+            {
+                if (is_failure(error))
+                {
+                    this->request_ = request::none;
+                }
+                return error;
+            }
+
+            logger::instance().debug(
+                "attribute_transfer: read multiple variable not supported");
+            this->request_        = request::none;
+            this->request_count_ -= 1u;
+            this->variable_supported_ = false;
+        }
+    }
+    else if (not this->variable_length_)
+    {
+        // Read Multiple Response values are concatenated without lengths;
+        // the batch must fit in the response PDU.
+        std::size_t const batch_count = this->read_multiple_batch(
+            handle_limit, this->mtu_ - read_overhead);
+        if (batch_count > 1u)
+        {
+            this->request_        = request::read_multiple;
+            this->request_count_ += 1u;
+            std::errc const error = this->operations_.read_multiple(
+                this->connection_handle_, this->handles_, batch_count);
+            if (is_failure(error))
+            {
+                this->request_ = request::none;
+            }
+            return error;
+        }
+    }
+
+    // A single value, a value longer than the PDU, or no stack support:
+    // read the value with the Read and Read Blob Requests.
+    attribute_value& value = this->values_[this->value_index_];
+    this->attribute_handle_ = value.handle;
+    this->read_data_        = static_cast<uint8_t*>(value.data);
+    this->size_             = value.size;
+    this->offset_           = 0u;
+
+    return this->request_read();
+}
+
+void attribute_transfer::read_value_complete()
+{
+    if (this->transfer_ == transfer::read)
+    {
+        this->complete(ble::att::error_code::success, ble::att::handle_invalid);
+        return;
+    }
+
+    this->values_[this->value_index_].length = this->offset_;
+    this->value_index_ += 1u;
+
+    if (is_failure(this->request_next_value()))
+    {
+        this->complete(ble::att::error_code::unlikely_error,
+                       this->values_[this->value_index_].handle);
+    }
+}
+
+void attribute_transfer::cancel(ble::att::error_code error_code)
+{
+    this->error_code_     = error_code;
+    this->request_        = request::write_cancel;
+    this->request_count_ += 1u;
+
+    std::errc const error = this->operations_.write_cancel(
+        this->connection_handle_, this->attribute_handle_, nullptr, 0u, 0u);
+    if (is_failure(error))
+    {
+        this->complete(error_code, this->attribute_handle_);
+    }
+}
+
+void attribute_transfer::complete(ble::att::error_code error_code,
+                                  uint16_t             error_handle)
+{
+    transfer const completed = this->transfer_;
+    completion_notify* const notify = this->notify_;
+
+    this->transfer_ = transfer::none;
+    this->request_  = request::none;
+    this->notify_   = nullptr;
+
+    if (error_code != ble::att::error_code::success)
+    {
+        logger::instance().debug(
+            "attribute_transfer: c: 0x%04x, h: 0x%04x, error: 0x%04x, error_handle: 0x%04x",
+            this->connection_handle_, this->attribute_handle_,
+            error_code, error_handle);
+    }
+
+    if (notify == nullptr)
+    {
+        return;
+    }
+
+    switch (completed)
+    {
+    case transfer::read:
+        notify->read_complete(this->connection_handle_,
+                              this->attribute_handle_,
+                              error_code,
+                              this->offset_);
+        break;
+
+    case transfer::write:
+        notify->write_complete(this->connection_handle_,
+                               this->attribute_handle_,
+                               error_code);
+        break;
+
+    case transfer::read_multiple:
+        notify->read_multiple_complete(this->connection_handle_,
+                                       error_code,
+                                       error_handle);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void attribute_transfer::read_response(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle,
+    uint16_t                    attribute_handle,
+    void const*                 data,
+    ble::att::length_t          offset,
+    ble::att::length_t          length)
+{
+    if ((this->request_ != request::read) ||
+        (this->connection_handle_ != connection_handle))
+    {
+        return;
+    }
+
+    this->request_ = request::none;
+
+    if (error_code != ble::att::error_code::success)
+    {
+        // A value whose length is a multiple of (ATT_MTU - 1) is terminated
+        // by an error on the Read Blob Request at the value length.
+        if ((this->offset_ > 0u) &&
+            ((error_code == ble::att::error_code::invalid_offset) ||
+             (error_code == ble::att::error_code::attribute_not_long)))
+        {
+            this->read_value_complete();
+        }
+        else
+        {
+            this->complete(error_code, error_handle);
+        }
+        return;
+    }
+
+    if ((attribute_handle != this->attribute_handle_) || (offset != this->offset_))
+    {
+        this->complete(ble::att::error_code::invalid_pdu, attribute_handle);
+        return;
+    }
+
+    ble::att::length_t const copy_length =
+        std::min<ble::att::length_t>(length, this->size_ - this->offset_);
+    std::memcpy(this->read_data_ + this->offset_, data, copy_length);
+    this->offset_ += copy_length;
+
+    // A short response marks the end of the value.
+    if ((length < this->mtu_ - read_overhead) || (this->offset_ >= this->size_))
+    {
+        this->read_value_complete();
+    }
+    else if (is_failure(this->request_read()))
+    {
+        this->complete(ble::att::error_code::unlikely_error, this->attribute_handle_);
+    }
+}
+
+void attribute_transfer::read_multi_response(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle,
+    void const*                 data,
+    ble::att::length_t          length)
+{
+    if ((this->request_ != request::read_multiple) ||
+        (this->connection_handle_ != connection_handle))
+    {
+        return;
+    }
+
+    this->request_ = request::none;
+
+    if (error_code != ble::att::error_code::success)
+    {
+        this->complete(error_code, error_handle);
+        return;
+    }
+
+    uint8_t const* value_data = static_cast<uint8_t const*>(data);
+    std::size_t const batch_end = this->value_index_ + this->batch_count_;
+    for ( ; this->value_index_ < batch_end; ++this->value_index_)
+    {
+        attribute_value& value = this->values_[this->value_index_];
+        ble::att::length_t const copy_length = std::min(value.size, length);
+        std::memcpy(value.data, value_data, copy_length);
+        value.length  = copy_length;
+        value_data   += copy_length;
+        length       -= copy_length;
+
+        if (copy_length < value.size)
+        {
+            this->complete(ble::att::error_code::invalid_attribute_value_length,
+                           value.handle);
+            return;
+        }
+    }
+
+    if (is_failure(this->request_next_value()))
+    {
+        this->complete(ble::att::error_code::unlikely_error,
+                       this->values_[this->value_index_].handle);
+    }
+}
+
+void attribute_transfer::read_multi_variable_response(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle,
+    void const*                 data,
+    ble::att::length_t          length)
+{
+    if ((this->request_ != request::read_multiple_variable) ||
+        (this->connection_handle_ != connection_handle))
+    {
+        return;
+    }
+
+    this->request_ = request::none;
+
+    if (error_code != ble::att::error_code::success)
+    {
+        this->complete(error_code, error_handle);
+        return;
+    }
+
+    uint8_t const* value_data = static_cast<uint8_t const*>(data);
+    std::size_t const batch_end   = this->value_index_ + this->batch_count_;
+    std::size_t const batch_begin = this->value_index_;
+
+    // Each value is a (16-bit little endian length, value) tuple.
+    while ((this->value_index_ < batch_end) && (length >= sizeof(uint16_t)))
+    {
+        ble::att::length_t const value_length = value_data[0] | (value_data[1] << 8u);
+        value_data += sizeof(uint16_t);
+        length     -= sizeof(uint16_t);
+
+        attribute_value& value = this->values_[this->value_index_];
+        ble::att::length_t const received    = std::min(value_length, length);
+        ble::att::length_t const copy_length = std::min(value.size, received);
+        std::memcpy(value.data, value_data, copy_length);
+        value.length  = copy_length;
+        value_data   += received;
+        length       -= received;
+
+        if ((received < value_length) && (copy_length < value.size))
+        {
+            // The server truncated the value to fit the PDU.
+            // Continue reading the value with Read Blob Requests.
+            this->attribute_handle_ = value.handle;
+            this->read_data_        = static_cast<uint8_t*>(value.data);
+            this->size_             = value.size;
+            this->offset_           = copy_length;
+            if (is_failure(this->request_read()))
+            {
+                this->complete(ble::att::error_code::unlikely_error, value.handle);
+            }
+            return;
+        }
+
+        this->value_index_ += 1u;
+    }
+
+    if (this->value_index_ == batch_begin)
+    {
+        this->complete(ble::att::error_code::invalid_pdu,
+                       this->values_[this->value_index_].handle);
+        return;
+    }
+
+    // Values not included in the response are requested again.
+    if (is_failure(this->request_next_value()))
+    {
+        this->complete(ble::att::error_code::unlikely_error,
+                       this->values_[this->value_index_].handle);
+    }
+}
+
+void attribute_transfer::write_response(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle,
+    ble::att::op_code           write_op_code,
+    uint16_t                    attribute_handle,
+    void const*                 data,
+    ble::att::length_t          offset,
+    ble::att::length_t          length)
+{
+    if (this->connection_handle_ != connection_handle)
+    {
+        return;
+    }
+
+    switch (this->request_)
+    {
+    case request::write:
+    case request::write_execute:
+        this->complete(error_code, error_handle);
+        break;
+
+    case request::write_cancel:
+        this->complete(this->error_code_, this->attribute_handle_);
+        break;
+
+    case request::write_prepare:
+        this->request_ = request::none;
+        if (error_code != ble::att::error_code::success)
+        {
+            // Values prepared prior to the failure remain queued.
+            this->cancel(error_code);
+        }
+        else if ((attribute_handle != this->attribute_handle_) ||
+                 (offset           != this->offset_)           ||
+                 (length           != this->chunk_length_)     ||
+                 (std::memcmp(data, this->write_data_ + this->offset_, length) != 0))
+        {
+            // The echoed value does not match what was sent.
+            this->cancel(ble::att::error_code::unlikely_error);
+        }
+        else
+        {
+            this->offset_ += this->chunk_length_;
+            std::errc error = errc_success;
+            if (this->offset_ < this->size_)
+            {
+                error = this->request_prepare();
+            }
+            else
+            {
+                this->request_        = request::write_execute;
+                this->request_count_ += 1u;
+                error = this->operations_.write_execute(
+                    this->connection_handle_, this->attribute_handle_,
+                    nullptr, 0u, 0u);
+            }
+
+            if (is_failure(error))
+            {
+                this->complete(ble::att::error_code::unlikely_error,
+                               this->attribute_handle_);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void attribute_transfer::exchange_mtu_response(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle,
+    uint16_t                    server_rx_mtu_size)
+{
+    if (error_code == ble::att::error_code::success)
+    {
+        this->set_mtu(std::min<ble::att::length_t>(server_rx_mtu_size,
+                                                   this->client_mtu_));
+    }
+}
+
+void attribute_transfer::timeout(
+    uint16_t                    connection_handle,
+    ble::att::error_code        error_code,
+    uint16_t                    error_handle)
+{
+    // No further ATT requests can be sent on the bearer.
+    if (this->is_busy() && (this->connection_handle_ == connection_handle))
+    {
+        this->complete(ble::att::error_code::unlikely_error, error_handle);
+    }
+}
+
+} // namespace gattc
+} // namespace ble
@@ -0,0 +1,300 @@
+/**
+ * @file ble/gattc_attribute_transfer.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * GATT client transfers of attribute values which do not fit in a single
+ * ATT PDU: long reads, long writes and reads of multiple attributes.
+ */
+
+#pragma once
+
+#include "ble/att.h"
+#include "ble/gattc_event_observer.h"
+#include "ble/gattc_operations.h"
+
+#include <system_error>
+#include <cstddef>
+#include <cstdint>
+
+namespace ble
+{
+namespace gattc
+{
+
+/**
+ * @class attribute_transfer
+ * A GATT client engine which:
+ * - Reads attribute values longer than (ATT_MTU - 1) using a Read Request
+ *   followed by Read Blob Requests, stitching the value into a client buffer.
+ * - Writes attribute values longer than (ATT_MTU - 3) using queued Prepare
+ *   Write Requests followed by an Execute Write Request. Each Prepare Write
+ *   Response echo is validated against the handle, offset and value sent;
+ *   a mismatch cancels the queued writes.
+ * - Reads many small attribute values per round trip using the Read Multiple
+ *   Variable Length Request when supported, or the Read Multiple Request when
+ *   the value lengths are known.
+ *
+ * ATT allows one outstanding request per bearer. The engine pipelines the
+ * transfer by issuing the next request directly from the response handler,
+ * without a round trip through the application, and avoids the terminating
+ * Read Blob when the value fills the client buffer.
+ *
+ * The engine is a ble::gattc::event_observer; attach it to the GATTC event
+ * observable to receive the read and write responses. One transfer is
+ * performed at a time.
+ */
+class attribute_transfer: public ble::gattc::event_observer
+{
+private:
+    using super = ble::gattc::event_observer;
+
+public:
+    /**
+     * @interface completion_notify
+     * Transfer completion notifications, called from the GATTC event context.
+     */
+    struct completion_notify
+    {
+        virtual ~completion_notify()                            = default;
+
+        completion_notify()                                     = default;
+        completion_notify(completion_notify const&)             = delete;
+        completion_notify(completion_notify &&)                 = delete;
+        completion_notify& operator=(completion_notify const&)  = delete;
+        completion_notify& operator=(completion_notify&&)       = delete;
+
+        /**
+         * A read() completed.
+         * @param length The number of bytes written into the client buffer.
+         */
+        virtual void read_complete(uint16_t             connection_handle,
+                                   uint16_t             attribute_handle,
+                                   ble::att::error_code error_code,
+                                   ble::att::length_t   length) = 0;
+
+        /** A write() completed. */
+        virtual void write_complete(uint16_t             connection_handle,
+                                    uint16_t             attribute_handle,
+                                    ble::att::error_code error_code) = 0;
+
+        /**
+         * A read_multiple() completed.
+         * @param error_handle The handle which caused a failure, if any.
+         */
+        virtual void read_multiple_complete(uint16_t             connection_handle,
+                                            ble::att::error_code error_code,
+                                            uint16_t             error_handle) = 0;
+    };
+
+    /**
+     * @struct attribute_value
+     * An element of the read_multiple() attribute set.
+     */
+    struct attribute_value
+    {
+        uint16_t            handle;
+
+        /// The client buffer into which the value is read.
+        void*               data;
+
+        /// The size of data in bytes. When using the Read Multiple Request
+        /// (fixed length values) this must be the attribute value length.
+        ble::att::length_t  size;
+
+        /// The number of bytes read into data.
+        ble::att::length_t  length;
+    };
+
+    virtual ~attribute_transfer() override                      = default;
+
+    attribute_transfer()                                        = delete;
+    attribute_transfer(attribute_transfer const&)               = delete;
+    attribute_transfer(attribute_transfer &&)                   = delete;
+    attribute_transfer& operator=(attribute_transfer const&)    = delete;
+    attribute_transfer& operator=(attribute_transfer&&)         = delete;
+
+    /**
+     * @param operations The GATTC operations used to issue requests.
+     * @param client_mtu The ATT_MTU the client requests in the MTU exchange.
+     *                   Until the exchange completes the minimum is used.
+     */
+    explicit attribute_transfer(
+        ble::gattc::operations& operations,
+        ble::att::length_t      client_mtu = ble::att::mtu_length_maximum);
+
+    /**
+     * Read an attribute value of any length.
+     *
+     * @param buffer The client buffer; must remain valid until completion.
+     * @param size   The buffer size. The read stops when the buffer is full;
+     *               when the value length is known, sizing the buffer to it
+     *               saves the terminating Read Blob round trip.
+     */
+    std::errc read(uint16_t             connection_handle,
+                   uint16_t             attribute_handle,
+                   void*                buffer,
+                   ble::att::length_t   size,
+                   completion_notify*   notify);
+
+    /**
+     * Write an attribute value of any length.
+     * Values which fit in a single PDU use the Write Request,
+     * longer values use Prepare Write and Execute Write Requests.
+     *
+     * @param data The value; must remain valid until completion.
+     */
+    std::errc write(uint16_t            connection_handle,
+                    uint16_t            attribute_handle,
+                    void const*         data,
+                    ble::att::length_t  length,
+                    completion_notify*  notify);
+
+    /**
+     * Read a set of attribute values, packing as many as possible into each
+     * round trip.
+     *
+     * @param values          The set of attributes to read. The length of each
+     *                        element is updated as the values are read.
+     * @param value_count     The number of elements in values.
+     * @param variable_length true:  use the Read Multiple Variable Length
+     *                               Request; falls back to individual reads if
+     *                               the stack does not support it.
+     *                        false: use the Read Multiple Request; each value
+     *                               size must be the exact value length.
+     */
+    std::errc read_multiple(uint16_t            connection_handle,
+                            attribute_value*    values,
+                            std::size_t         value_count,
+                            bool                variable_length,
+                            completion_notify*  notify);
+
+    bool is_busy() const { return this->transfer_ != transfer::none; }
+
+    /** @return ble::att::length_t The ATT_MTU in use. */
+    ble::att::length_t mtu() const { return this->mtu_; }
+
+    /** Set the ATT_MTU, for when the exchange was performed elsewhere. */
+    void set_mtu(ble::att::length_t mtu);
+
+    /** @return uint32_t The number of ATT requests issued. */
+    uint32_t request_count() const { return this->request_count_; }
+    void reset_request_count() { this->request_count_ = 0u; }
+
+    /// @{ ble::gattc::event_observer interface.
+    virtual void read_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        uint16_t                    attribute_handle,
+        void const*                 data,
+        ble::att::length_t          offset,
+        ble::att::length_t          length) override;
+
+    virtual void read_multi_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        void const*                 data,
+        ble::att::length_t          length) override;
+
+    virtual void read_multi_variable_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        void const*                 data,
+        ble::att::length_t          length) override;
+
+    virtual void write_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        ble::att::op_code           write_op_code,
+        uint16_t                    attribute_handle,
+        void const*                 data,
+        ble::att::length_t          offset,
+        ble::att::length_t          length) override;
+
+    virtual void exchange_mtu_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        uint16_t                    server_rx_mtu_size) override;
+
+    virtual void timeout(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle) override;
+    /// @}
+
+private:
+    /// The transfer requested by the client.
+    enum class transfer: uint8_t
+    {
+        none,
+        read,
+        write,
+        read_multiple
+    };
+
+    /// The ATT request outstanding.
+    enum class request: uint8_t
+    {
+        none,
+        read,                       ///< Read or Read Blob Request.
+        read_multiple,
+        read_multiple_variable,
+        write,
+        write_prepare,
+        write_execute,
+        write_cancel
+    };
+
+    /// The Read Multiple Request holds at most (ATT_MTU - 1) / 2 handles.
+    static constexpr std::size_t const handles_max =
+        (ble::att::mtu_length_maximum - 1u) / sizeof(uint16_t);
+
+    std::errc request_read();
+    std::errc request_prepare();
+    std::errc request_next_value();
+    std::size_t read_multiple_batch(std::size_t handle_limit,
+                                    std::size_t value_length_limit);
+    void read_value_complete();
+    void cancel(ble::att::error_code error_code);
+    void complete(ble::att::error_code error_code, uint16_t error_handle);
+
+    ble::gattc::operations&     operations_;
+    ble::att::length_t          client_mtu_;
+    ble::att::length_t          mtu_;
+
+    transfer                    transfer_;
+    request                     request_;
+    completion_notify*          notify_;
+    uint16_t                    connection_handle_;
+    uint16_t                    attribute_handle_;
+
+    /// @{ The value being read or written.
+    uint8_t*                    read_data_;
+    uint8_t const*              write_data_;
+    ble::att::length_t          size_;
+    ble::att::length_t          offset_;
+    ble::att::length_t          chunk_length_;
+    ble::att::error_code        error_code_;
+    /// @}
+
+    /// @{ The read_multiple() attribute set.
+    attribute_value*            values_;
+    std::size_t                 value_count_;
+    std::size_t                 value_index_;
+    std::size_t                 batch_count_;
+    bool                        variable_length_;
+
+    /// Cleared when the stack rejects the Read Multiple Variable Request.
+    bool                        variable_supported_;
+    uint16_t                    handles_[handles_max];
+    /// @}
+
+    uint32_t                    request_count_;
+};
+
+} // namespace gattc
+} // namespace ble
@@ -56,6 +56,18 @@ public:
         ble::att::length_t          length
         ) {}
 
+    /**
+     * The Read Multiple Variable Length Response. The data is a sequence of
+     * (16-bit length, value) tuples; the final value may be truncated.
+     */
+    virtual void read_multi_variable_response(
+        uint16_t                    connection_handle,
+        ble::att::error_code        error_code,
+        uint16_t                    error_handle,
+        void const*                 data,
+        ble::att::length_t          length
+        ) {}
+
     virtual void write_response(
         uint16_t                    connection_handle,
         ble::att::error_code        error_code,
@@ -14,6 +14,7 @@
 
 #include <system_error>
 #include <utility>
+#include <cstddef>
 #include <cstdint>
 
 namespace ble
@@ -93,8 +94,39 @@ public:
                            uint16_t                 attribute_handle,
                            att::length_t            offset) = 0;
 
-    /// @todo Implement read_multiple, (maybe)
-//    virtual std::errc read_multiple(uint16_t    connection_handle) = 0;
+    /**
+     * Read the values of a set of attributes with a single Read Multiple
+     * Request. The response is the concatenation of the values; the client
+     * must know the length of each value in order to separate them.
+     *
+     * @see Bluetooth Core Specification 5.0, Volume 3, Part F
+     * 3.4.4.7 Read Multiple Request
+     *
+     * @param connection_handle The connection handle.
+     * @param attribute_handles The set of 2 or more attribute handles.
+     * @param handle_count      The number of handles in attribute_handles.
+     */
+    virtual std::errc read_multiple(uint16_t        connection_handle,
+                                    uint16_t const* attribute_handles,
+                                    std::size_t     handle_count) = 0;
+
+    /**
+     * Read the values of a set of attributes with a single Read Multiple
+     * Variable Length Request. Each value in the response is preceded by its
+     * 16-bit length.
+     *
+     * @see Bluetooth Core Specification 5.2, Volume 3, Part F
+     * 3.4.4.11 Read Multiple Variable Request
+     *
+     * @return std::errc::function_not_supported if the stack does not
+     * support the request; which is the default.
+     */
+    virtual std::errc read_multiple_variable(uint16_t        connection_handle,
+                                             uint16_t const* attribute_handles,
+                                             std::size_t     handle_count)
+    {
+        return std::errc::function_not_supported;
+    }
 
     virtual std::errc write_request(uint16_t        connection_handle,
                                     uint16_t        attribute_handle,
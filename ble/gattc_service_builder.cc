@@ -14,10 +14,12 @@
 #include "logger.h"
 #include "project_assert.h"
 
+#include <new>
+
 /**
  * @todo @bug
- * + On gap::disconnect we need to free the service_container and move all
- *   entries to their free lists.
+ * + On gap::disconnect we need to free the service_container and return all
+ *   entries to their free list pools.
  * + When the GATT service changed 0x1801 indication (not notification) is
  *   received clear all handles within the range and repopulate.
  *   It appears that the indication value is [handle_start:handle_stop].
@@ -32,6 +34,27 @@ namespace ble
 namespace gattc
 {
 
+/**
+ * Construct a node in a block taken from a free list pool.
+ *
+ * @param pool      The pool; may be null if none was provided.
+ * @param watermark Records the free blocks remaining.
+ *
+ * @return node_type* The constructed node; nullptr if the pool is exhausted.
+ */
+template <typename node_type>
+static node_type* free_list_construct(block_pool* pool, memory_watermark& watermark)
+{
+    void* const block = pool ? pool->allocate(sizeof(node_type), alignof(node_type)) : nullptr;
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    watermark.record(pool->available());
+    return new (block) node_type();
+}
+
 std::errc service_builder::discover_services(
     uint16_t                            conenction_handle,
     ble::gatt::service_container&       svc_container,
@@ -93,7 +116,11 @@ void service_builder::service_discovered(
         logger.debug("service discovered: h: [0x%04x, 0x%04x]: %s",
                      gatt_handle_first, gatt_handle_last, uuid_char_buffer);
 
-        if (this->free_list.services.empty())
+        ble::gatt::service* const service =
+            free_list_construct<ble::gatt::service>(
+                this->free_list.services, this->free_list.services_watermark);
+
+        if (service == nullptr)
         {
             logger.debug(
                 "service discovered: h: [0x%04x, 0x%04x]: %s, free list empty",
@@ -101,13 +128,11 @@ void service_builder::service_discovered(
         }
         else
         {
-            ble::gatt::service& service = this->free_list.services.front();
-            this->free_list.services.pop_front();
-            service.uuid = uuid;
-            service.decl.attribute_type =
+            service->uuid = uuid;
+            service->decl.attribute_type =
                 ble::gatt::attribute_type::primary_service;
-            service.decl.handle = gatt_handle_first;
-            this->service_container->push_back(service);
+            service->decl.handle = gatt_handle_first;
+            this->service_container->push_back(*service);
         }
     }
     else if (gatt_error == ble::att::error_code::attribute_not_found)
@@ -216,7 +241,12 @@ void service_builder::characteristic_discovered(
 
         if (service)
         {
-            if (this->free_list.characteristics.empty())
+            ble::gatt::characteristic* const characteristic =
+                free_list_construct<ble::gatt::characteristic>(
+                    this->free_list.characteristics,
+                    this->free_list.characteristics_watermark);
+
+            if (characteristic == nullptr)
             {
                 logger.error("characteristic discovered: h: [0x%04x, 0x%04x]: "
                              "%s, free list empty",
@@ -225,21 +255,14 @@ void service_builder::characteristic_discovered(
             }
             else
             {
-                ble::gatt::attribute& list_node =
-                    this->free_list.characteristics.front();
-                this->free_list.characteristics.pop_front();
-
-                ble::gatt::characteristic& characteristic =
-                    static_cast<ble::gatt::characteristic&>(list_node);
-
                 // Note that the default ctor for ble::gatt::characteristic has
                 // set the attribute_type properly. Doing it here anyway.
-                characteristic.uuid         = uuid;
-                characteristic.value_handle = gatt_handle_value;
-                characteristic.decl.handle  = gatt_handle_declaration;
-                characteristic.decl.attribute_type =
+                characteristic->uuid         = uuid;
+                characteristic->value_handle = gatt_handle_value;
+                characteristic->decl.handle  = gatt_handle_declaration;
+                characteristic->decl.attribute_type =
                     ble::gatt::attribute_type::characteristic;
-                service->characteristic_add(characteristic);
+                service->characteristic_add(*characteristic);
             }
         }
         else
@@ -364,24 +387,23 @@ void service_builder::descriptor_discovered(
         logger.debug("descriptor discovered: 0x%04x: %s",
                      gatt_handle_desciptor, uuid_char_buffer);
 
-        if (this->free_list.descriptors.empty())
+        ble::gatt::descriptor_base* const descriptor =
+            free_list_construct<ble::gatt::descriptor_base>(
+                this->free_list.descriptors,
+                this->free_list.descriptors_watermark);
+
+        if (descriptor == nullptr)
         {
             logger.error("descriptor discovered: 0x%04x: %s, free list empty",
                          gatt_handle_desciptor, uuid_char_buffer);
         }
         else
         {
-            ble::gatt::attribute& list_node =
-                this->free_list.characteristics.front();
-            this->free_list.characteristics.pop_front();
-
-            ble::gatt::descriptor_base& descriptor =
-                static_cast<ble::gatt::descriptor_base&>(list_node);
-            descriptor.decl.handle = gatt_handle_desciptor;
+            descriptor->decl.handle = gatt_handle_desciptor;
 
             ble::gatt::service_container::discovery_iterator::iterator_node
                 const node = *this->discovery_iterator;
-            node.characteristic.descriptor_add(descriptor);
+            node.characteristic.descriptor_add(*descriptor);
         }
     }
     else if (gatt_error == ble::att::error_code::attribute_not_found)
@@ -471,7 +493,8 @@ void service_builder::attribute_discovered(
         /// @todo Need to add an attributes free list.
         /// For now use the characteristics list. Change later:
         /// this->free_list.characteristics => this->free_list.attributes
-        if (this->free_list.characteristics.empty())
+        if ((this->free_list.characteristics == nullptr) ||
+            (this->free_list.characteristics->available() == 0u))
         {
             logger.error("attribute discovered: 0x%04x: %s, free list empty",
                          gatt_handle_attribute, uuid_char_buffer);
@@ -479,9 +502,9 @@ void service_builder::attribute_discovered(
         else
         {
 #if 0
-            ble::gatt::attribute& attribute =
-                this->free_list.characteristics.front();
-            this->free_list.characteristics.pop_front();
+            ble::gatt::attribute& attribute = *free_list_construct<ble::gatt::attribute>(
+                this->free_list.characteristics,
+                this->free_list.characteristics_watermark);
 
             /// @todo Use the discovery_iterator to find the characteristic
             /// associated with this gatt_handle_attribute.
@@ -11,6 +11,8 @@
 #include "ble/gatt_descriptors.h"
 #include "ble/gattc_discovery_observer.h"
 #include "ble/gattc_operations.h"
+#include "block_pool.h"
+#include "memory_watermark.h"
 
 #include <iterator>
 #include <utility>
@@ -168,10 +170,21 @@ public:
         ble::att::uuid const&       uuid,
         bool                        response_end) override;
 
+    /**
+     * @struct gatt_free_list
+     * The pools in which discovered services, characteristics and
+     * descriptors are constructed; each block holds one of these types.
+     * The constructed nodes are owned by the service container.
+     */
     struct gatt_free_list {
-        ble::gatt::service_list_type    services;
-        ble::gatt::attribute::list_type characteristics;
-        ble::gatt::attribute::list_type descriptors;
+        block_pool* services        = nullptr;
+        block_pool* characteristics = nullptr;
+        block_pool* descriptors     = nullptr;
+
+        /// The free blocks remaining; level_min() is the low water mark.
+        memory_watermark services_watermark{"gatt_services"};
+        memory_watermark characteristics_watermark{"gatt_chars"};
+        memory_watermark descriptors_watermark{"gatt_descriptors"};
     };
 
     gatt_free_list free_list;
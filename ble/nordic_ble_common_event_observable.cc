@@ -16,8 +16,10 @@ void ble_event_observable<ble_common_event_observer>::notify(
     ble_common_event_observer::event_enum_t event_type,
     ble_common_event_observer::event_data_t const&  event_data)
 {
-    for (auto observer_iter  = this->observer_list_.begin();
-              observer_iter != this->observer_list_.end(); )
+    // Only the observers which registered for event_type are visited.
+    for (auto observer_iter  = this->dispatch_table_.dispatch_begin(
+                                   event_type - ble_common_event_observer::event_base);
+              observer_iter != this->dispatch_table_.end(); )
     {
         logger &logger = logger::instance();
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "nordic_ble_event_observer.h"
+#include "event_dispatch_table.h"
 #include "project_assert.h"
 #include <cstdint>
 
@@ -35,27 +36,61 @@ public:
     ble_event_observable& operator=(ble_event_observable const &) = delete;
     ble_event_observable& operator=(ble_event_observable&&)       = delete;
 
-    void attach(observer_type& observer)
+    using event_enum_t = typename observer_type::event_enum_t;
+    using event_mask_t = typename observer_type::event_mask_t;
+
+    /**
+     * Attach an observer to receive events.
+     *
+     * @param observer   The observer to attach.
+     * @param event_mask The events which the observer will be notified of.
+     *                   @see ble_event_observer::event_mask().
+     *                   By default all events are notified.
+     */
+    void attach(observer_type& observer,
+                event_mask_t event_mask = observer_type::all_events)
     {
         ASSERT(not observer.is_attached());
         observer.observable_ = this;
+        observer.event_mask_ = event_mask;
         this->observer_list_.push_back(observer);
+        this->dispatch_table_build();
     }
 
-    void attach_first(observer_type& observer)
+    void attach_first(observer_type& observer,
+                      event_mask_t event_mask = observer_type::all_events)
     {
         ASSERT(not observer.is_attached());
         observer.observable_ = this;
+        observer.event_mask_ = event_mask;
         this->observer_list_.push_front(observer);
+        this->dispatch_table_build();
     }
 
+    /**
+     * Detach an observer from receiving events.
+     * This is safe to call from within an observer notification.
+     */
     void detach(observer_type& observer)
     {
         ASSERT(observer.is_attached());
         observer.observable_ = nullptr;
         observer.hook_.unlink();
+        this->dispatch_table_.remove(observer);
     }
 
+    /**
+     * @return uint32_t The number of times the event has been dispatched
+     *                  to this observable.
+     */
+    uint32_t dispatch_count(event_enum_t event_type) const
+    {
+        return this->dispatch_table_.dispatch_count(
+            event_type - observer_type::event_base);
+    }
+
+    void dispatch_count_reset() { this->dispatch_table_.reset_counters(); }
+
     void notify(typename observer_type::event_enum_t         event_type,
                 typename observer_type::event_data_t const&  event_data);
 
@@ -73,7 +108,34 @@ private:
             &observer_type::hook_>
         >;
 
-    observer_list observer_list_;
+    /**
+     * The maximum number of observers which can be attached to a single
+     * Nordic BLE event observable.
+     */
+    static constexpr std::size_t const observer_max = 8u;
+
+    using dispatch_table =
+        event_dispatch_table<observer_type,
+                             observer_type::event_count,
+                             observer_max>;
+
+    /**
+     * Rebuild the dispatch table from the observer list.
+     * Attaching observers is done at initialization; since rebuilding the
+     * table reorders the observer slots an observer must not be attached
+     * from within an observer notification.
+     */
+    void dispatch_table_build()
+    {
+        this->dispatch_table_.clear();
+        for (observer_type& observer : this->observer_list_)
+        {
+            this->dispatch_table_.insert(observer, observer.event_mask_);
+        }
+    }
+
+    observer_list   observer_list_;
+    dispatch_table  dispatch_table_;
 };
 
 struct ble_observables
@@ -95,6 +157,15 @@ struct ble_observables
     ble_event_observable<ble_gatts_event_observer>      gatts_event_observable;
 };
 
+/**
+ * Dispatch a softdevice BLE event to the ble_observables.
+ * Called from the softdevice event handler or, when deferred event processing
+ * is enabled, from ble_event_queue::process().
+ *
+ * @param ble_event The softdevice BLE event.
+ */
+void ble_event_dispatch(ble_evt_t const& ble_event);
+
 /**
  * Specialized hack to aquire 128-bit UUIDs which have not been
  * pre-registered with the Nordic softdevice.
@@ -4,7 +4,9 @@
  */
 
 #include "nordic_ble_event_observable.h"
+#include "nordic_ble_event_queue.h"
 #include "section_macros.h"
+#include "profile.h"
 #include "project_assert.h"
 
 #include <nrf_sdh_ble.h>
@@ -18,31 +20,32 @@ nordic::ble_observables& nordic::ble_observables::instance()
     return ble_observables_instance;
 }
 
-static void nordic_ble_event_handler(ble_evt_t const *ble_event, void *context)
+void nordic::ble_event_dispatch(ble_evt_t const& ble_event)
 {
-    auto *ble_observables = reinterpret_cast<nordic::ble_observables*>(context);
-    ASSERT(ble_observables == &ble_observables_instance);
+    PROFILE_ZONE("ble_event_dispatch");
+
+    nordic::ble_observables* const ble_observables = &ble_observables_instance;
 
-    if ((ble_event->header.evt_id >= BLE_EVT_BASE) &&   // Common BLE events.
-        (ble_event->header.evt_id <= BLE_EVT_LAST))
+    if ((ble_event.header.evt_id >= BLE_EVT_BASE) &&   // Common BLE events.
+        (ble_event.header.evt_id <= BLE_EVT_LAST))
     {
         ble_observables->common_event_observable.notify(
-            static_cast<enum BLE_COMMON_EVTS>(ble_event->header.evt_id),
-            ble_event->evt.common_evt);
+            static_cast<enum BLE_COMMON_EVTS>(ble_event.header.evt_id),
+            ble_event.evt.common_evt);
 
     }
-    else if ((ble_event->header.evt_id >= BLE_GAP_EVT_BASE) &&
-             (ble_event->header.evt_id <= BLE_GAP_EVT_LAST))
+    else if ((ble_event.header.evt_id >= BLE_GAP_EVT_BASE) &&
+             (ble_event.header.evt_id <= BLE_GAP_EVT_LAST))
     {
         ble_observables->gap_event_observable.notify(
-            static_cast<enum BLE_GAP_EVTS>(ble_event->header.evt_id),
-            ble_event->evt.gap_evt);
+            static_cast<enum BLE_GAP_EVTS>(ble_event.header.evt_id),
+            ble_event.evt.gap_evt);
     }
-    else if ((ble_event->header.evt_id >= BLE_GATTC_EVT_BASE) &&
-             (ble_event->header.evt_id <= BLE_GATTC_EVT_LAST))
+    else if ((ble_event.header.evt_id >= BLE_GATTC_EVT_BASE) &&
+             (ble_event.header.evt_id <= BLE_GATTC_EVT_LAST))
     {
         enum BLE_GATTC_EVTS const gattc_event =
-            static_cast<enum BLE_GATTC_EVTS>(ble_event->header.evt_id);
+            static_cast<enum BLE_GATTC_EVTS>(ble_event.header.evt_id);
 
         // Note that GATTC events are broken up into 2 parts within this C++
         // framework: gattc responses and discovery responses.
@@ -52,20 +55,41 @@ static void nordic_ble_event_handler(ble_evt_t const *ble_event, void *context)
         if (gattc_event >= BLE_GATTC_EVT_CHAR_VAL_BY_UUID_READ_RSP)
         {
             ble_observables->gattc_event_observable.notify(
-                gattc_event, ble_event->evt.gattc_evt);
+                gattc_event, ble_event.evt.gattc_evt);
         }
         else
         {
             ble_observables->gattc_discovery_observable.notify(
-                gattc_event, ble_event->evt.gattc_evt);
+                gattc_event, ble_event.evt.gattc_evt);
         }
     }
-    else if ((ble_event->header.evt_id >= BLE_GATTS_EVT_BASE) &&
-             (ble_event->header.evt_id <= BLE_GATTS_EVT_LAST))
+    else if ((ble_event.header.evt_id >= BLE_GATTS_EVT_BASE) &&
+             (ble_event.header.evt_id <= BLE_GATTS_EVT_LAST))
     {
         ble_observables->gatts_event_observable.notify(
-            static_cast<enum BLE_GATTS_EVTS>(ble_event->header.evt_id),
-            ble_event->evt.gatts_evt);
+            static_cast<enum BLE_GATTS_EVTS>(ble_event.header.evt_id),
+            ble_event.evt.gatts_evt);
+    }
+}
+
+static void nordic_ble_event_handler(ble_evt_t const *ble_event, void *context)
+{
+    auto *ble_observables = reinterpret_cast<nordic::ble_observables*>(context);
+    ASSERT(ble_observables == &ble_observables_instance);
+
+    // When deferred processing is enabled the event is queued and dispatched
+    // from the main loop. Observers are then only ever called from the main
+    // loop. The stack event handler only takes an event from the softdevice
+    // while the queue is accepting, and each lane reserves a slot for the
+    // events which must be answered, so the push is not expected to fail.
+    nordic::ble_event_queue& ble_event_queue = nordic::ble_event_queue::instance();
+    if (ble_event_queue.is_enabled())
+    {
+        ble_event_queue.push(*ble_event);
+    }
+    else
+    {
+        nordic::ble_event_dispatch(*ble_event);
     }
 }
 
@@ -19,6 +19,9 @@
 #include <ble_gatts.h>
 
 #include <boost/intrusive/list.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 
 namespace nordic
 {
@@ -26,14 +29,43 @@ namespace nordic
 template <typename observer_type>
 class ble_event_observable;
 
+/**
+ * @tparam interface_type  The abstract BLE observer interface notified.
+ * @tparam event_enum_type The Nordic enum of BLE event ids.
+ * @tparam event_data_type The Nordic event data structure for the event group.
+ * @tparam event_id_base   The first Nordic event id in the event group;
+ *                         events are indexed relative to this base.
+ */
 template <typename interface_type,
           typename event_enum_type,
-          typename event_data_type>
+          typename event_data_type,
+          uint16_t event_id_base>
 class ble_event_observer
 {
 public:
     using event_enum_t = event_enum_type;
     using event_data_t = event_data_type;
+    using event_mask_t = uint32_t;
+
+    /// Each Nordic event group spans 32 event ids.
+    static constexpr uint16_t     const event_base  = event_id_base;
+    static constexpr std::size_t  const event_count = 32u;
+    static constexpr event_mask_t const all_events  = 0xFFFFFFFFu;
+
+    /**
+     * Create an event mask for use when attaching to the observable.
+     * @example ble_gap_event_observer::event_mask({BLE_GAP_EVT_CONNECTED,
+     *                                              BLE_GAP_EVT_DISCONNECTED})
+     */
+    static constexpr event_mask_t event_mask(std::initializer_list<event_enum_t> events)
+    {
+        event_mask_t mask = 0u;
+        for (event_enum_t event : events)
+        {
+            mask |= event_mask_t(1u) << (event - event_base);
+        }
+        return mask;
+    }
 
     virtual ~ble_event_observer()                               = default;
 
@@ -45,7 +77,8 @@ public:
 
     explicit ble_event_observer(interface_type &interface):
         interface_reference(interface),
-        observable_(nullptr) {}
+        observable_(nullptr),
+        event_mask_(all_events) {}
 
     bool is_attached() const { return bool(this->observable_); }
 
@@ -61,18 +94,20 @@ private:
     using observable_type =
         ble_event_observable<ble_event_observer<interface_type,
                                                 event_enum_type,
-                                                event_data_type> >;
+                                                event_data_type,
+                                                event_id_base> >;
 
     observable_type volatile *observable_;
+    event_mask_t              event_mask_;
 
     friend observable_type;
 };
 
-using ble_common_event_observer    = ble_event_observer<ble::common::event_observer,    enum BLE_COMMON_EVTS, ble_common_evt_t>;
-using ble_gap_event_observer       = ble_event_observer<ble::gap::event_observer,       enum BLE_GAP_EVTS,    ble_gap_evt_t>;
-using ble_gattc_event_observer     = ble_event_observer<ble::gattc::event_observer,     enum BLE_GATTC_EVTS,  ble_gattc_evt_t>;
-using ble_gattc_discovery_observer = ble_event_observer<ble::gattc::discovery_observer, enum BLE_GATTC_EVTS,  ble_gattc_evt_t>;
-using ble_gatts_event_observer     = ble_event_observer<ble::gatts::event_observer,     enum BLE_GATTS_EVTS,  ble_gatts_evt_t>;
+using ble_common_event_observer    = ble_event_observer<ble::common::event_observer,    enum BLE_COMMON_EVTS, ble_common_evt_t, BLE_EVT_BASE>;
+using ble_gap_event_observer       = ble_event_observer<ble::gap::event_observer,       enum BLE_GAP_EVTS,    ble_gap_evt_t,    BLE_GAP_EVT_BASE>;
+using ble_gattc_event_observer     = ble_event_observer<ble::gattc::event_observer,     enum BLE_GATTC_EVTS,  ble_gattc_evt_t,  BLE_GATTC_EVT_BASE>;
+using ble_gattc_discovery_observer = ble_event_observer<ble::gattc::discovery_observer, enum BLE_GATTC_EVTS,  ble_gattc_evt_t,  BLE_GATTC_EVT_BASE>;
+using ble_gatts_event_observer     = ble_event_observer<ble::gatts::event_observer,     enum BLE_GATTS_EVTS,  ble_gatts_evt_t,  BLE_GATTS_EVT_BASE>;
 // TBD using ble_l2cap_event_observer    = ble_event_observer<enum BLE_L2CAP_EVTS, >;
 
 } // namespace nordic
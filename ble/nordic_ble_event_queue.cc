@@ -0,0 +1,187 @@
+/**
+ * @file nordic_ble_event_queue.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "ble/nordic_ble_event_queue.h"
+#include "ble/nordic_ble_event_observable.h"
+#include "project_assert.h"
+
+#include <nrf_nvic.h>
+#include <nrf_soc.h>
+
+#include <limits>
+
+namespace nordic
+{
+
+static ble_event_queue ble_event_queue_instance;
+
+ble_event_queue& ble_event_queue::instance()
+{
+    return ble_event_queue_instance;
+}
+
+/// Run the softdevice stack event handler, which takes the held back events.
+static void stack_events_resume()
+{
+    sd_nvic_SetPendingIRQ(SD_EVT_IRQn);
+}
+
+ble_event_queue::ble_event_queue() :
+    enabled_(false),
+    throttled_(false),
+    rtc_(nullptr),
+    notify_(nullptr),
+    notify_context_(nullptr),
+    lanes_(),
+    latency_{0u, std::numeric_limits<uint32_t>::max(), 0u, 0u}
+{
+}
+
+void ble_event_queue::enable(rtc const& rtc, queued_notify notify, void* context)
+{
+    this->rtc_            = &rtc;
+    this->notify_         = notify;
+    this->notify_context_ = context;
+    this->enabled_        = true;
+}
+
+void ble_event_queue::disable()
+{
+    this->enabled_ = false;
+    if (this->throttled_)
+    {
+        this->throttled_ = false;
+        stack_events_resume();
+    }
+}
+
+uint32_t ble_event_queue::timestamp() const
+{
+    return this->rtc_ ? this->rtc_->get_count_extend_32() : 0u;
+}
+
+bool ble_event_queue::is_must_answer(uint16_t event_id)
+{
+    switch (event_id)
+    {
+    // Replies required: the procedure stalls until the peer times out.
+    case BLE_COMMON_EVT_USER_MEM_REQUEST:
+    case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+    case BLE_GAP_EVT_SEC_INFO_REQUEST:
+    case BLE_GAP_EVT_AUTH_KEY_REQUEST:
+    case BLE_GAP_EVT_LESC_DHKEY_REQUEST:
+    case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+    case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+    case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
+    case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+    case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+    // The connection state.
+    case BLE_GAP_EVT_CONNECTED:
+    case BLE_GAP_EVT_DISCONNECTED:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool ble_event_queue::is_accepting()
+{
+    if ((not this->enabled_) || this->lanes_.is_accepting())
+    {
+        return true;
+    }
+
+    // The stack event handler runs above thread priority: process() either
+    // has yet to make room and will see throttled_, or has made room and
+    // the lanes above were accepting.
+    this->throttled_ = true;
+    return false;
+}
+
+bool ble_event_queue::push(ble_evt_t const& ble_event)
+{
+    if (not this->enabled_)
+    {
+        return false;
+    }
+
+    uint16_t const event_id = ble_event.header.evt_id;
+    event_lanes::lane const event_lane = (event_id <= BLE_GAP_EVT_LAST) ?
+        event_lanes::lane::gap : event_lanes::lane::gatt;
+
+    bool const queued = this->lanes_.push(event_lane,
+                                          is_must_answer(event_id),
+                                          &ble_event,
+                                          ble_event.header.evt_len,
+                                          this->timestamp());
+
+    if (queued && this->notify_)
+    {
+        this->notify_(this->notify_context_);
+    }
+
+    return queued;
+}
+
+std::size_t ble_event_queue::process()
+{
+    std::size_t dispatch_count = 0u;
+    for (;;)
+    {
+        // GAP events take priority; the GAP lane is checked before every
+        // GATT event is dispatched.
+        event_lanes::lane event_lane;
+        event_lanes::slot const* const slot = this->lanes_.front(event_lane);
+        if (slot == nullptr)
+        {
+            break;
+        }
+
+        uint32_t const latency = this->timestamp() - slot->timestamp;
+        this->latency_.dispatch_count += 1u;
+        this->latency_.latency_sum    += latency;
+        if (latency < this->latency_.latency_min) { this->latency_.latency_min = latency; }
+        if (latency > this->latency_.latency_max) { this->latency_.latency_max = latency; }
+
+        ble_event_dispatch(*reinterpret_cast<ble_evt_t const*>(slot->data));
+        this->lanes_.pop(event_lane);
+        ++dispatch_count;
+    }
+
+    // The lanes are empty: take the events held back in the softdevice.
+    if (this->throttled_)
+    {
+        this->throttled_ = false;
+        stack_events_resume();
+    }
+
+    return dispatch_count;
+}
+
+bool ble_event_queue::empty() const
+{
+    return this->lanes_.empty();
+}
+
+ble_event_queue::lane_statistics ble_event_queue::gap_statistics() const
+{
+    return lane_statistics {
+        this->lanes_.gap().depth(),
+        this->lanes_.gap().depth_max(),
+        this->lanes_.gap().overflow_count()
+    };
+}
+
+ble_event_queue::lane_statistics ble_event_queue::gatt_statistics() const
+{
+    return lane_statistics {
+        this->lanes_.gatt().depth(),
+        this->lanes_.gatt().depth_max(),
+        this->lanes_.gatt().overflow_count()
+    };
+}
+
+} // namespace nordic
@@ -0,0 +1,156 @@
+/**
+ * @file nordic_ble_event_queue.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Optional deferred BLE event processing.
+ * When enabled, the softdevice BLE event handler copies each ble_evt_t into
+ * a lock-free ring and returns. The main loop calls process() to dispatch the
+ * queued events to the Nordic BLE observables at thread priority.
+ *
+ * Events are queued in two priority lanes; @see ble::event_lanes.
+ * - GAP lane:  Common and GAP events.
+ * - GATT lane: GATTC and GATTS events.
+ * Pending GAP lane events are always dispatched before the next GATT lane
+ * event.
+ *
+ * Events are not lost:
+ * - Back-pressure: the stack event handler takes the next event from the
+ *   softdevice only while is_accepting(). Otherwise the events stay queued
+ *   in the softdevice and process() re-triggers the stack event handler
+ *   once it has made room.
+ * - Events which the application must answer, or which change the
+ *   connection state, may take the slot reserved in each lane.
+ */
+
+#pragma once
+
+#include "ble/ble_event_lanes.h"
+#include "rtc.h"
+
+#include <ble.h>
+#include <nrf_sdh_ble.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nordic
+{
+
+class ble_event_queue
+{
+public:
+    static ble_event_queue& instance();
+
+    /// The number of queued events in each lane.
+    static constexpr std::size_t const gap_slot_count  = 4u;
+    static constexpr std::size_t const gatt_slot_count = 8u;
+
+    /**
+     * @struct lane_statistics
+     * Queue depth and overflow counts for a single priority lane.
+     */
+    struct lane_statistics
+    {
+        std::size_t depth;              ///< The current queue depth.
+        std::size_t depth_max;          ///< The maximum queue depth.
+        uint32_t    overflow_count;     ///< Events rejected; the lane was full.
+    };
+
+    /**
+     * @struct latency_statistics
+     * The time between the softdevice event handler queuing an event and the
+     * event being dispatched to observers; in RTC ticks.
+     */
+    struct latency_statistics
+    {
+        uint32_t dispatch_count;
+        uint32_t latency_min;
+        uint32_t latency_max;
+        uint64_t latency_sum;
+    };
+
+    ~ble_event_queue()                                  = default;
+    ble_event_queue(ble_event_queue const&)             = delete;
+    ble_event_queue(ble_event_queue&&)                  = delete;
+    ble_event_queue& operator=(ble_event_queue const&)  = delete;
+    ble_event_queue& operator=(ble_event_queue&&)       = delete;
+
+    ble_event_queue();
+
+    /// Called from the softdevice event handler after an event is queued.
+    using queued_notify = void (*)(void* context);
+
+    /**
+     * Enable deferred event processing.
+     * @param rtc     The RTC used to timestamp events for latency statistics.
+     * @param notify  Optional; called when an event is queued, such as to
+     *                post a run loop work item which calls process().
+     * @param context Passed to notify.
+     */
+    void enable(rtc const& rtc, queued_notify notify = nullptr, void* context = nullptr);
+
+    /**
+     * Disable deferred event processing. Events already queued are
+     * dispatched by subsequent calls to process().
+     */
+    void disable();
+
+    bool is_enabled() const { return this->enabled_; }
+
+    /**
+     * Stack event handler: whether the next event may be taken from the
+     * softdevice. When false the handler must stop taking events; it is
+     * re-triggered by process() once both lanes have room.
+     *
+     * @return bool true if queuing is disabled or both lanes have room.
+     */
+    bool is_accepting();
+
+    /**
+     * Softdevice event handler: copy the event into its priority lane.
+     *
+     * @param ble_event The event received from the softdevice.
+     * @return bool true if the event was queued.
+     *              false if queuing is disabled or the lane is full.
+     * @note With the back-pressure of is_accepting() a lane is never full.
+     * Were it so, an event is rejected and counted; it is never dispatched
+     * from the handler, which could re-enter observers while process() is
+     * dispatching.
+     */
+    bool push(ble_evt_t const& ble_event);
+
+    /**
+     * @return bool true if the event obliges the application to reply to the
+     * softdevice or changes the connection state; it may take a reserved slot.
+     */
+    static bool is_must_answer(uint16_t event_id);
+
+    /**
+     * Main loop: dispatch all queued events to the Nordic BLE observables.
+     * @return std::size_t The number of events dispatched.
+     */
+    std::size_t process();
+
+    bool empty() const;
+
+    lane_statistics    gap_statistics()  const;
+    lane_statistics    gatt_statistics() const;
+    latency_statistics const& latency()  const { return this->latency_; }
+
+private:
+    using event_lanes = ble::event_lanes<NRF_SDH_BLE_EVT_BUF_SIZE,
+                                         gap_slot_count,
+                                         gatt_slot_count>;
+
+    uint32_t timestamp() const;
+
+    bool volatile       enabled_;
+    bool volatile       throttled_;
+    rtc const*          rtc_;
+    queued_notify       notify_;
+    void*               notify_context_;
+    event_lanes         lanes_;
+    latency_statistics  latency_;
+};
+
+} // namespace nordic
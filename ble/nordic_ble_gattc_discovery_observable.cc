@@ -27,8 +27,10 @@ void ble_event_observable<ble_gattc_discovery_observer>::notify(
 {
     logger &logger = logger::instance();
 
-    for (auto observer_iter  = this->observer_list_.begin();
-              observer_iter != this->observer_list_.end(); )
+    // Only the observers which registered for event_type are visited.
+    for (auto observer_iter  = this->dispatch_table_.dispatch_begin(
+                                   event_type - ble_gattc_discovery_observer::event_base);
+              observer_iter != this->dispatch_table_.end(); )
     {
         // Increment the iterator prior to using it.
         // If the client removes itself during the completion callback
@@ -205,6 +205,29 @@ std::errc ble_gattc_operations::read(
     return nordic_to_system_error(error_code);
 }
 
+std::errc ble_gattc_operations::read_multiple(
+    uint16_t            connection_handle,
+    uint16_t const*     attribute_handles,
+    std::size_t         handle_count)
+{
+    logger& logger = logger::instance();
+
+    logger.info("gattc read_multiple(c: 0x%04x, count: %u)",
+                 connection_handle, handle_count);
+
+    uint32_t error_code = sd_ble_gattc_char_values_read(
+        connection_handle,
+        attribute_handles,
+        static_cast<uint16_t>(handle_count));
+    if (error_code != NRF_SUCCESS)
+    {
+        logger.error("sd_ble_gattc_char_values_read() failed: 0x%04x '%s'",
+                     error_code, nordic_error_string(error_code));
+    }
+
+    return nordic_to_system_error(error_code);
+}
+
 std::errc ble_gattc_operations::write_request(
     uint16_t            connection_handle,
     uint16_t            attribute_handle,
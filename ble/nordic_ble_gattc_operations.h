@@ -78,8 +78,9 @@ public:
                            uint16_t                 attribute_handle,
                            ble::att::length_t       offset) override;
 
-    /// @todo Implement read_multiple, (maybe)
-//    virtual std::errc read_multiple(uint16_t    connection_handle) override;
+    virtual std::errc read_multiple(uint16_t        connection_handle,
+                                    uint16_t const* attribute_handles,
+                                    std::size_t     handle_count) override;
 
     virtual std::errc write_request(uint16_t            connection_handle,
                                     uint16_t            attribute_handle,
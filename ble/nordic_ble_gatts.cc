@@ -407,7 +407,8 @@ static uint32_t nordic_add_gap_service(ble::gatt::service const& service)
     return error_return;
 }
 
-uint32_t gatts_service_add(ble::gatt::service& service)
+uint32_t gatts_service_add(ble::gatt::service&          service,
+                           ble::gatt::attribute_arena*  arena)
 {
     uint32_t           error     = NRF_SUCCESS;
     logger           &logger     = logger::instance();
@@ -458,6 +459,15 @@ uint32_t gatts_service_add(ble::gatt::service& service)
         {
             logger.debug("sd_ble_gatts_service_add(%s): OK", uuid_char_buffer);
 
+            // Characteristic value handles are assigned in list order;
+            // the arena values are therefore in handle order.
+            if (arena)
+            {
+                std::size_t const count = arena->layout(service);
+                logger.debug("attribute_arena: %u values, %u / %u bytes",
+                             count, arena->size(), arena->capacity());
+            }
+
             for (ble::gatt::attribute &attr_node : service.characteristic_list)
             {
                 ble::gatt::characteristic& node =
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "ble/gatt_attribute_arena.h"
 #include "ble/gatt_service.h"
 #include "ble/gatt_service_container.h"
 
@@ -21,12 +22,16 @@ namespace nordic
  * @param service A reference to the service to add.
  *                The service object life time is effectively forever.
  *                (As long as the BLE connect is in use and may be in use).
+ * @param arena   When not null, relocatable characteristic values are
+ *                placed in the arena and given to the softdevice as user
+ *                located (BLE_GATTS_VLOC_USER) values.
  * @note The service reference is not const; the handle of the GATTS
  *       characterisitics are updated with they are added.
  *
  * @return uint32_t The Nordic error code.
  * @retval NRF_SUCCESS if successful.
  */
-uint32_t gatts_service_add(ble::gatt::service& service);
+uint32_t gatts_service_add(ble::gatt::service&          service,
+                           ble::gatt::attribute_arena*  arena = nullptr);
 
 } // namespace nordic
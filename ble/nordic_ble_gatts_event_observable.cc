@@ -70,8 +70,10 @@ void ble_event_observable<ble_gatts_event_observer>::notify(
 {
     logger &logger = logger::instance();
 
-    for (auto observer_iter  = this->observer_list_.begin();
-              observer_iter != this->observer_list_.end(); )
+    // Only the observers which registered for event_type are visited.
+    for (auto observer_iter  = this->dispatch_table_.dispatch_begin(
+                                   event_type - ble_gatts_event_observer::event_base);
+              observer_iter != this->dispatch_table_.end(); )
     {
         // Increment the iterator prior to using it.
         // If the client removes itself during the completion callback
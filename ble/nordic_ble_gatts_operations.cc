@@ -157,7 +157,7 @@ std::errc ble_gatts_operations::exchange_mtu_reply(
 std::errc ble_gatts_operations::service_add(
     ble::gatt::service& service)
 {
-    uint32_t const error_code = gatts_service_add(service);
+    uint32_t const error_code = gatts_service_add(service, this->attribute_arena_);
     ASSERT(error_code == NRF_SUCCESS);
     return nordic_to_system_error(error_code);
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "ble/gatts_operations.h"
+#include "ble/gatt_attribute_arena.h"
 
 namespace nordic
 {
@@ -18,7 +19,7 @@ class ble_gatts_operations: public ble::gatts::operations
 public:
     virtual ~ble_gatts_operations()                                 = default;
 
-    ble_gatts_operations()                                          = default;
+    ble_gatts_operations(): attribute_arena_(nullptr) {}
     ble_gatts_operations(ble_gatts_operations const&)               = delete;
     ble_gatts_operations(ble_gatts_operations &&)                   = delete;
     ble_gatts_operations& operator=(ble_gatts_operations const&)    = delete;
@@ -67,6 +68,17 @@ public:
 
     virtual std::errc service_add(
         ble::gatt::service& service) override;
+
+    /**
+     * Place the relocatable characteristic values of services subsequently
+     * added into the arena.
+     */
+    void set_attribute_arena(ble::gatt::attribute_arena* arena) {
+        this->attribute_arena_ = arena;
+    }
+
+private:
+    ble::gatt::attribute_arena* attribute_arena_;
 };
 
 } // namespace nordic
@@ -7,6 +7,7 @@
 #include <nrf_sdh.h>
 #include <nrf_sdh_ble.h>
 
+#include "ble/nordic_ble_event_queue.h"
 #include "ble/nordic_ble_event_strings.h"
 #include "section_macros.h"
 #include "logger.h"
@@ -83,8 +84,18 @@ static void nordic_stack_event_handler(void* context)
     ble_evt_t const* ble_event_ptr = reinterpret_cast<ble_evt_t const*>(ble_event_buffer);
     uint16_t         ble_event_len = static_cast<uint16_t>(sizeof(ble_event_buffer));
 
+    nordic::ble_event_queue& ble_event_queue = nordic::ble_event_queue::instance();
+
     for (;;)
     {
+        // Back-pressure: while the deferred event queue is short of room the
+        // events are left in the softdevice. ble_event_queue::process()
+        // re-triggers this handler once the queue has been drained.
+        if (not ble_event_queue.is_accepting())
+        {
+            return;
+        }
+
         uint32_t const event_result = sd_ble_evt_get(
             reinterpret_cast<uint8_t *>(ble_event_buffer), &ble_event_len);
 
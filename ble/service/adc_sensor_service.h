@@ -101,6 +101,10 @@ private:
  * when notificaitons are made. The Nordic stack takes care of this.
  * This may be an issue for other stack implementations.
  *
+ * The sample value is not held inline. It is located in the
+ * ble::gatt::attribute_arena when the service is added; without an arena
+ * the value is held by the BLE stack.
+ *
  * @tparam sample_type   The data type into which ADC samples are converted.
  *                       These could be: uint8_t, int8_t, uint16_t, int16_t,
  *                       uint32_t, int32_t.
@@ -126,15 +130,20 @@ public:
                                 custom::characteristics::adc_samples),
             gatt::properties::read | gatt::properties::notify),
         cccd(*this),
-        adc_sensor_acq_(nullptr)
+        adc_sensor_acq_(nullptr),
+        data_(nullptr)
     {
         this->descriptor_add(cccd);
-        this->data_.fill(0);
     }
 
-    virtual void const*   data_pointer() const { return this->data_.data(); }
+    virtual void const*   data_pointer() const { return this->data_; }
     virtual att::length_t data_length()  const {
-        return this->data_.size() * sizeof(sample_type);
+        return channel_count * sizeof(sample_type);
+    }
+
+    virtual bool value_relocate(void* location) override {
+        this->data_ = static_cast<sample_type*>(location);
+        return true;
     }
 
     /**
@@ -200,7 +209,7 @@ public:
 
 private:
     adc_sensor_acquisition<sample_type>*    adc_sensor_acq_;
-    std::array<sample_type, channel_count>  data_;
+    sample_type*                            data_;
 };
 
 /**
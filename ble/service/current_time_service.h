@@ -12,6 +12,10 @@
 #include "ble/gatt_enum_types.h"
 
 #include "gregorian.h"
+#include "wall_clock.h"
+
+#include <cstddef>
+#include <cstdint>
 
 namespace ble
 {
@@ -136,6 +140,14 @@ struct exact_time_256: public gatt::characteristic
 /**
  * @struct current_time
  * https://www.bluetooth.com/specifications/gatt/viewer?attributeXmlFile=org.bluetooth.characteristic.current_time.xml
+ *
+ * The value is held in its 10 octet wire format:
+ * year (little endian), month, day, hours, minutes, seconds, day of week,
+ * fractions 256, adjust reason.
+ *
+ * When a utility::wall_clock is attached the value reflects the clock:
+ * refresh() copies the clock time into the value and a peer write
+ * synchronizes the clock to the time written.
  */
 struct current_time: public gatt::characteristic
 {
@@ -148,6 +160,8 @@ struct current_time: public gatt::characteristic
         dst         = (1u << 3u),
     };
 
+    static constexpr std::size_t const value_length = 10u;
+
     virtual ~current_time() override               = default;
 
     current_time(current_time const&)             = delete;
@@ -164,30 +178,92 @@ struct current_time: public gatt::characteristic
                              gatt::properties::write |
                              gatt::properties::notify),
         cccd(*this),
-        week_day(utility::gregorian::dow_invalid),
-        seconds_fraction_256(0u),
-        adjust_reason(adjust_reason::none)
+        clock_(nullptr),
+        value_{}
      {
          this->descriptor_add(this->cccd);
      }
 
-    virtual void const* data_pointer() const override {
-        return &this->greg_date;
-    }
+    virtual void const* data_pointer() const override { return this->value_; }
 
     virtual att::length_t data_length() const override {
-        return sizeof(this->greg_date) +
-               sizeof(this->week_day) +
-               sizeof(this->seconds_fraction_256) +
-               sizeof(this->adjust_reason);
+        return sizeof(this->value_);
+    }
+
+    /**
+     * A complete write of the value sets the attached wall clock.
+     * Writes which do not hold a valid date are stored but otherwise ignored.
+     */
+    virtual att::length_t write(att::op_code    write_type,
+                                att::length_t   offset,
+                                att::length_t   length,
+                                void const*     data) override
+    {
+        att::length_t const written =
+            gatt::characteristic::write(write_type, offset, length, data);
+
+        utility::gregorian const greg = this->date();
+        if (this->clock_ && (offset == 0u) && (written == value_length) &&
+            utility::gregorian::is_valid(greg))
+        {
+            this->clock_->synchronize(utility::gregorian::seconds_since_epoch(greg),
+                                      this->fraction_256());
+        }
+        return written;
+    }
+
+    void set_clock(utility::wall_clock& clock) { this->clock_ = &clock; }
+
+    /** Set the value from the attached wall clock. */
+    void refresh(adjust_reason reason = adjust_reason::none)
+    {
+        if (this->clock_)
+        {
+            utility::wall_clock::time_point const time = this->clock_->now();
+            this->set(utility::gregorian::to_calendar(time.seconds),
+                      time.fraction_256, reason);
+        }
+    }
+
+    void set(utility::gregorian const& greg,
+             uint8_t                   fraction_256,
+             adjust_reason             reason = adjust_reason::none)
+    {
+        this->value_[0u] = static_cast<uint8_t>(greg.year);
+        this->value_[1u] = static_cast<uint8_t>(greg.year >> 8u);
+        this->value_[2u] = greg.month;
+        this->value_[3u] = greg.day_of_month;
+        this->value_[4u] = greg.hours;
+        this->value_[5u] = greg.minutes;
+        this->value_[6u] = greg.seconds;
+        this->value_[7u] = utility::gregorian::calc_day_of_week(greg);
+        this->value_[8u] = fraction_256;
+        this->value_[9u] = static_cast<uint8_t>(reason);
+    }
+
+    utility::gregorian date() const
+    {
+        return utility::gregorian(
+            static_cast<uint16_t>(this->value_[0u] | (this->value_[1u] << 8u)),
+            this->value_[2u], this->value_[3u],
+            this->value_[4u], this->value_[5u], this->value_[6u]);
+    }
+
+    utility::gregorian::day_of_week week_day() const {
+        return static_cast<utility::gregorian::day_of_week>(this->value_[7u]);
+    }
+
+    uint8_t fraction_256() const { return this->value_[8u]; }
+
+    adjust_reason reason() const {
+        return static_cast<adjust_reason>(this->value_[9u]);
     }
 
     gatt::client_characteristic_configuration_descriptor cccd;
 
-    utility::gregorian              greg_date;
-    utility::gregorian::day_of_week week_day;
-    uint8_t                         seconds_fraction_256;
-    adjust_reason                   adjust_reason;
+private:
+    utility::wall_clock*    clock_;
+    uint8_t                 value_[value_length];
 };
 
 /**
@@ -12,27 +12,6 @@ namespace service
 namespace custom
 {
 
-/**
- * The Bluetooth LE Custom Base UUID
- * 0000-CCCC-SSSS-494C-86C6-052628E7D83F
- *
- * @note 16-bit uuid service value will be set in
- *       bytes [4:5] in big-endian order.
- * @note 16-bit uuid characteristic value will set set in
- *       bytes [2:3] in big-endian order.
- * @note Bytes [0:1] must remain zero in order for Nordic GATT clients to
- *       peform service discovery.
- */
-constexpr boost::uuids::uuid const uuid_base
-{{
-    0x00, 0x00,		// Must be set to zero for Nordic GATTC to work.
-    0x00, 0x00,		// Increment for characteristics within services.
-    0x00, 0x00,		// Increment for each service.
-    0x49, 0x4C,     // Fixed ...
-    0x86, 0xC6,
-    0x05, 0x26, 0x28, 0xE7, 0xD8, 0x3F
-}};
-
 static void uuid_set_service(ble::att::uuid& uuid, services service)
 {
     uint16_t const service_u16 = static_cast<uint16_t>(service);
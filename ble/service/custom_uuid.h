@@ -26,8 +26,44 @@ enum class characteristics: uint16_t
     adc_scaling     = 0x0003,
 };
 
-/// A read-only reference to the custom uuid.
-extern boost::uuids::uuid const uuid_base;
+/**
+ * The Bluetooth LE Custom Base UUID
+ * 0000-CCCC-SSSS-494C-86C6-052628E7D83F
+ *
+ * @note 16-bit uuid service value will be set in
+ *       bytes [4:5] in big-endian order.
+ * @note 16-bit uuid characteristic value will set set in
+ *       bytes [2:3] in big-endian order.
+ * @note Bytes [0:1] must remain zero in order for Nordic GATT clients to
+ *       peform service discovery.
+ */
+inline constexpr boost::uuids::uuid const uuid_base
+{{
+    0x00, 0x00,		// Must be set to zero for Nordic GATTC to work.
+    0x00, 0x00,		// Increment for characteristics within services.
+    0x00, 0x00,		// Increment for each service.
+    0x49, 0x4C,     // Fixed ...
+    0x86, 0xC6,
+    0x05, 0x26, 0x28, 0xE7, 0xD8, 0x3F
+}};
+
+/**
+ * The custom base uuid with a 16-bit service value set in bytes [4:5].
+ * A constexpr object, so that its address is usable as a template argument;
+ * @see ble/gatt_table.h schema::uuid128.
+ */
+template <services service>
+inline constexpr boost::uuids::uuid const service_uuid_base
+{{
+    uuid_base.data[0],  uuid_base.data[1],
+    uuid_base.data[2],  uuid_base.data[3],
+    static_cast<uint8_t>(static_cast<uint16_t>(service) >> 8u),
+    static_cast<uint8_t>(static_cast<uint16_t>(service) >> 0u),
+    uuid_base.data[6],  uuid_base.data[7],
+    uuid_base.data[8],  uuid_base.data[9],
+    uuid_base.data[10], uuid_base.data[11], uuid_base.data[12],
+    uuid_base.data[13], uuid_base.data[14], uuid_base.data[15]
+}};
 
 /**
  * Set an existing uuid to a custom service value.
@@ -8,10 +8,17 @@
 #include "buttons.h"
 #include "logger.h"
 #include "segger_rtt.h"
+#include "rtt_input_stream.h"
 #include "rtt_output_stream.h"
 #include "rtc_observer.h"
 #include "timer_observer.h"
+#include "run_loop.h"
+#include "nordic_run_loop_hooks.h"
+#include "nordic_work_timer.h"
+#include "profile.h"
+#include "isr_profile.h"
 #include "stack_usage.h"
+#include "block_pool.h"
 #include "version_info.h"
 #include "project_assert.h"
 
@@ -21,6 +28,7 @@
 #include "ble/gap_types.h"
 #include "ble/gatt_enum_types.h"
 #include "ble/gattc_service_builder.h"
+#include "ble/gattc_attribute_transfer.h"
 #include "ble/gatt_service.h"
 #include "ble/gatt_characteristic.h"
 #include "ble/gatt_descriptors.h"
@@ -28,6 +36,7 @@
 #include "ble/profile_central.h"
 
 #include "ble/nordic_ble_event_observable.h"
+#include "ble/nordic_ble_event_queue.h"
 #include "ble/nordic_ble_gap_operations.h"
 #include "ble/nordic_ble_gap_scanning.h"
 #include "ble/nordic_ble_gattc_operations.h"
@@ -42,32 +51,76 @@
 
 static char rtt_os_buffer[4096u];
 
-static std::array<ble::gatt::service,         16u>  services_list;
-static std::array<ble::gatt::characteristic,  32u>  characteristics_list;
-static std::array<ble::gatt::descriptor_base, 32u>  descriptors_list;
+#if defined ISR_PROFILE_ENABLED
+static char rtt_is_buffer[16u];
+#endif
+
+static fixed_block_pool<sizeof(ble::gatt::service), 16u,
+                        alignof(ble::gatt::service)>            services_pool;
+static fixed_block_pool<sizeof(ble::gatt::characteristic), 32u,
+                        alignof(ble::gatt::characteristic)>     characteristics_pool;
+static fixed_block_pool<sizeof(ble::gatt::descriptor_base), 32u,
+                        alignof(ble::gatt::descriptor_base)>    descriptors_pool;
+
+static void ble_event_process(void*)
+{
+    nordic::ble_event_queue::instance().process();
+}
+
+static void ble_event_queued(void* context)
+{
+    static_cast<work_item*>(context)->post();
+}
+
+static void memory_report_log(void* context)
+{
+    static memory_report_t report;
+    memory_report(report);
+    memory_report_write(report, *static_cast<logger*>(context));
+}
+
+#if defined PROFILE_ENABLED
+static void profile_dump(void* context)
+{
+    profile::dump(*static_cast<logger*>(context));
+}
+#endif
+
+#if defined ISR_PROFILE_ENABLED
+static void isr_profile_query(void* context)
+{
+    isr_profile_instance().query(*static_cast<io::input_stream*>(context),
+                                 logger::instance());
+}
+#endif
 
 static void free_lists_alloc(ble::gattc::service_builder &service_builder)
 {
-    for (auto& node : services_list)
-    {
-        service_builder.free_list.services.push_back(node);
-    }
-
-    for (auto& node : characteristics_list)
-    {
-        service_builder.free_list.characteristics.push_back(node);
-    }
-
-    for (auto& node : descriptors_list)
-    {
-        service_builder.free_list.descriptors.push_back(node);
-    }
+    service_builder.free_list.services        = &services_pool;
+    service_builder.free_list.characteristics = &characteristics_pool;
+    service_builder.free_list.descriptors     = &descriptors_pool;
+
+    service_builder.free_list.services_watermark.set_capacity(services_pool.block_count());
+    service_builder.free_list.characteristics_watermark.set_capacity(characteristics_pool.block_count());
+    service_builder.free_list.descriptors_watermark.set_capacity(descriptors_pool.block_count());
+    service_builder.free_list.services_watermark.record(services_pool.available());
+    service_builder.free_list.characteristics_watermark.record(characteristics_pool.available());
+    service_builder.free_list.descriptors_watermark.record(descriptors_pool.available());
 }
 
 int main(void)
 {
     lfclk_enable(LFCLK_SOURCE_XO);
 
+#if defined STACK_GUARD_ENABLED
+    // Count writes into the lowest 64 bytes of the stack.
+    stack_guard_enable(64u, 6u);
+#endif
+
+#if defined PROFILE_ENABLED || defined ISR_PROFILE_ENABLED
+    profile::cycle_counter_enable();
+#endif
+
     rtc_observable<> rtc_1(1u, 32u);
     rtc_1.start();
 
@@ -77,6 +130,42 @@ int main(void)
     logger.set_level(logger::level::info);
     logger.set_output_stream(rtt_os);
 
+    // The main loop runs work items, flushes the logger in batches and
+    // sleeps until the next RTC deadline: 1 tick or less spins, 10 msec or
+    // more sleeps in low power mode.
+    nordic::run_loop_hooks run_loop_hooks(rtc_1);
+    run_loop_hooks.sleep_thresholds_set(1u, rtc_1.ticks_per_second() / 100u);
+    run_loop main_loop(run_loop_hooks);
+    main_loop.logger_flush_set(logger, rtc_1.ticks_per_second() / 10u,
+                               sizeof(rtt_os_buffer) / 2u, 2u);
+
+    // Dispatch BLE events from the main loop rather than from within the
+    // softdevice event handler.
+    work_function ble_event_work(main_loop, 0u, ble_event_process);
+    nordic::ble_event_queue& ble_event_queue = nordic::ble_event_queue::instance();
+    ble_event_queue.enable(rtc_1, ble_event_queued, &ble_event_work);
+
+#if defined PROFILE_ENABLED
+    // Dump the profile zones once a minute.
+    work_function      profile_work(main_loop, 3u, profile_dump, &logger);
+    nordic::work_timer profile_timer(profile_work, rtc_1.ticks_per_second() * 60u);
+    rtc_1.attach(profile_timer);
+#endif
+
+    // Report the stack and memory pool watermarks once a minute.
+    work_function      memory_report_work(main_loop, 3u, memory_report_log, &logger);
+    nordic::work_timer memory_report_timer(memory_report_work, rtc_1.ticks_per_second() * 60u);
+    rtc_1.attach(memory_report_timer);
+
+#if defined ISR_PROFILE_ENABLED
+    // Answer ISR profile queries typed into RTT down channel 0:
+    // 'd' dump, 'w' worst ISRs, 'r' reset.
+    rtt_input_stream   rtt_is(rtt_is_buffer, sizeof(rtt_is_buffer));
+    work_function      isr_profile_work(main_loop, 3u, isr_profile_query, &rtt_is);
+    nordic::work_timer isr_profile_timer(isr_profile_work, rtc_1.ticks_per_second() / 4u);
+    rtc_1.attach(isr_profile_timer);
+#endif
+
     segger_rtt_enable();
 
     leds_board_init();
@@ -116,6 +205,7 @@ int main(void)
     nordic::ble_gattc_discovery_operations  gattc_service_discovery;
     ble::gattc::service_builder             gattc_service_builder(gattc_service_discovery);
     free_lists_alloc(gattc_service_builder);
+    ble::gattc::attribute_transfer          gattc_attribute_transfer(gattc_operations, mtu_size);
 
     ble::profile::central                   ble_central(ble_stack,
                                                         gap_connection,
@@ -130,11 +220,20 @@ int main(void)
     nordic::ble_gap_event_observer          nordic_gap_event_observer(gap_connection);
     nordic::ble_gattc_event_observer        nordic_gattc_event_observer(gattc_observer);
     nordic::ble_gattc_discovery_observer    nordic_gattc_discovery_observer(gattc_service_builder);
+    nordic::ble_gattc_event_observer        nordic_gattc_transfer_observer(gattc_attribute_transfer);
 
     nordic_observables.gap_event_observable.attach_first(nordic_gap_event_logger);
     nordic_observables.gap_event_observable.attach(nordic_gap_event_observer);
     nordic_observables.gattc_event_observable.attach(nordic_gattc_event_observer);
     nordic_observables.gattc_discovery_observable.attach(nordic_gattc_discovery_observer);
+    nordic_observables.gattc_event_observable.attach(
+        nordic_gattc_transfer_observer,
+        nordic::ble_gattc_event_observer::event_mask({
+            BLE_GATTC_EVT_READ_RSP,
+            BLE_GATTC_EVT_CHAR_VALS_READ_RSP,
+            BLE_GATTC_EVT_WRITE_RSP,
+            BLE_GATTC_EVT_EXCHANGE_MTU_RSP,
+            BLE_GATTC_EVT_TIMEOUT}));
 
     unsigned int const peripheral_count = 0u;
     unsigned int const central_count    = 1u;
@@ -165,22 +264,14 @@ int main(void)
 
     ble_peer_init();
 
-    logger.info("stack: free: %5u 0x%04x, size: %5u 0x%04x",
-                stack_free(), stack_free(), stack_size(), stack_size());
+    memory_report_log(&logger);
 
     logger.info("alloc: services: %u 0x%04x, characteristics: %u 0x%04x, descriptors: %u 0x%04x",
-                std::size(services_list),        sizeof(services_list),
-                std::size(characteristics_list), sizeof(characteristics_list),
-                std::size(descriptors_list),     sizeof(descriptors_list));
+                services_pool.block_count(),        sizeof(services_pool),
+                characteristics_pool.block_count(), sizeof(characteristics_pool),
+                descriptors_pool.block_count(),     sizeof(descriptors_pool));
 
     ble_central.scanning().start();
 
-    for (;;)
-    {
-        logger.flush();
-        if (rtt_os.write_pending() == 0)
-        {
-            __WFE();
-        }
-    }
+    main_loop.run();
 }
@@ -10,7 +10,7 @@ ble_gatts_observer::~ble_gatts_observer()
 {
 }
 
-ble_gatts_observer::ble_gatts_observer(): super()
+ble_gatts_observer::ble_gatts_observer(): super(), rate_controller_(nullptr)
 {
 }
 
@@ -22,6 +22,11 @@ void ble_gatts_observer::write(uint16_t             connection_handle,
                                ble::att::length_t   length,
                                void const*          data)
 {
+    if (this->rate_controller_)
+    {
+        this->rate_controller_->record_write(length);
+    }
+
     super::write(connection_handle,
                  attribute_handle,
                  write_type,
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "ble/gatts_event_observer.h"
+#include "ble/gap_connection_rate_controller.h"
 
 class ble_gatts_observer: public ble::gatts::event_observer
 {
@@ -32,6 +33,11 @@ public:
      */
     void init();
 
+    /// Record the bytes written by the client as connection traffic.
+    void set_rate_controller(ble::gap::connection_rate_controller& rate_controller) {
+        this->rate_controller_ = &rate_controller;
+    }
+
 protected:
     void write(uint16_t             conection_handle,
                uint16_t             attribute_handle,
@@ -73,4 +79,7 @@ protected:
 
     void handle_value_notifications_tx_completed(uint16_t   conection_handle,
                                                  uint8_t    count) override;
+
+private:
+    ble::gap::connection_rate_controller* rate_controller_;
 };
@@ -8,9 +8,11 @@
 #include "ble/att.h"
 #include "ble/gap_types.h"
 #include "ble/gatt_enum_types.h"
+#include "ble/gatt_attribute_arena.h"
 #include "ble/ltv_encode.h"
 
 #include "ble/gap_connection.h"
+#include "ble/gap_connection_rate_controller.h"
 #include "ble/gap_event_logger.h"
 #include "ble/profile_peripheral.h"
 #include "ble/service/gap_service.h"
@@ -93,6 +95,15 @@ static ble_gap_connection                   gap_connection(
 
 static ble_gatts_observer                   gatts_observer;
 static nordic::ble_gatts_operations         gatts_operations;
+
+// Relocatable characteristic values are placed here in handle order.
+// Currently only the ADC samples value is relocatable.
+alignas(uint32_t) static uint8_t            attribute_arena_storage[
+    sizeof(nordic::saadc_samples_characteristic::value_type) *
+    nordic::saadc_input_channel_count];
+static ble::gatt::attribute_arena           attribute_arena(
+                                                attribute_arena_storage,
+                                                sizeof(attribute_arena_storage));
 static ble::profile::peripheral             ble_peripheral(ble_stack,
                                                            gap_connection,
                                                            gatts_observer,
@@ -103,6 +114,10 @@ static nordic::ble_gap_event_observer       nordic_gap_event_logger(gap_event_lo
 static nordic::ble_gap_event_observer       nordic_gap_event_observer(gap_connection);
 static nordic::ble_gatts_event_observer     nordic_gatts_event_observer(gatts_observer);
 
+static ble::gap::connection_rate_controller rate_controller(gap_operations);
+static ble::gap::connection_rate_observer   rate_observer(rate_controller);
+static nordic::ble_gap_event_observer       nordic_gap_rate_observer(rate_observer);
+
 // GAP service: 0x1800
 //   device name: uuid = 0x2a00
 //   appearance : uuid = 0x2a01
@@ -142,11 +157,16 @@ static nordic::saadc_samples_characteristic adc_samples_characteristic;
 static nordic::saadc_enable_characteristic  adc_enable_characteristic;
 
 static timer_observable<>                   timer_1_observable(1u);
+
+// RTC2 TICK paces wake on threshold sampling: 32,768 Hz / 2048 = 16 Hz.
+static rtc                                  saadc_slow_rtc(2u, 2048u);
 static nordic::saadc_sensor_acquisition     adc_sensor_acq(
                                                 adc_samples_characteristic,
-                                                timer_1_observable);
+                                                timer_1_observable,
+                                                saadc_slow_rtc);
 
-ble::profile::peripheral& ble_peripheral_init()
+ble::profile::peripheral& ble_peripheral_init(utility::wall_clock&          wall_clock,
+                                              nordic::temperature_monitor&  temperature_monitor)
 {
     unsigned int const peripheral_count = 1u;
     unsigned int const central_count    = 0u;
@@ -172,6 +192,15 @@ ble::profile::peripheral& ble_peripheral_init()
     nordic_observables.gap_event_observable.attach_first(nordic_gap_event_logger);
     nordic_observables.gap_event_observable.attach(nordic_gap_event_observer);
     nordic_observables.gatts_event_observable.attach(nordic_gatts_event_observer);
+    nordic_observables.gap_event_observable.attach(
+        nordic_gap_rate_observer,
+        nordic::ble_gap_event_observer::event_mask({
+            BLE_GAP_EVT_CONNECTED,
+            BLE_GAP_EVT_DISCONNECTED,
+            BLE_GAP_EVT_CONN_PARAM_UPDATE,
+            BLE_GAP_EVT_PHY_UPDATE,
+            BLE_GAP_EVT_DATA_LENGTH_UPDATE}));
+    gatts_observer.set_rate_controller(rate_controller);
 
     ble_peer_init();
 
@@ -187,14 +216,24 @@ ble::profile::peripheral& ble_peripheral_init()
     battery_service.characteristic_add(battery_level_characteristic);
     battery_service.characteristic_add(battery_power_characteristic);
 
+    // ----- Current Time Service
+    current_time_service.current_time.set_clock(wall_clock);
+
     // ----- Custom ADC Sensor Service
     adc_sensor_service.characteristic_add(adc_samples_characteristic);
     adc_sensor_service.characteristic_add(adc_enable_characteristic);
     adc_samples_characteristic.set_adc_sensor_acq(adc_sensor_acq);
 
     adc_sensor_acq.init();
+#if defined SAADC_THRESHOLD_ENABLED
+    // Wake on threshold: capture AIN0 only when it leaves [512, 3584].
+    saadc_slow_rtc.start();
+    adc_sensor_acq.threshold_limits_set(0u, 512, 3584);
+#endif
+    temperature_monitor.attach(adc_sensor_acq);
 
     // ----- Add the services to the peripheral.
+    gatts_operations.set_attribute_arena(&attribute_arena);
     ble_peripheral.service_add(gap_service);
     ble_peripheral.service_add(gatt_service);
     ble_peripheral.service_add(device_information_service);
@@ -202,7 +241,18 @@ ble::profile::peripheral& ble_peripheral_init()
     ble_peripheral.service_add(current_time_service);
     ble_peripheral.service_add(adc_sensor_service);
 
+    logger::instance().info("attribute_arena: %u values, %u / %u bytes, padding: %u",
+                            attribute_arena.attribute_count(),
+                            attribute_arena.size(),
+                            attribute_arena.capacity(),
+                            attribute_arena.padding());
+
     set_advertising_data(ble_peripheral.advertising().data);
 
     return ble_peripheral;
 }
+
+void ble_peripheral_rate_update(uint32_t now_msec)
+{
+    rate_controller.update(now_msec);
+}
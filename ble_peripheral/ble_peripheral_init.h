@@ -6,6 +6,8 @@
 #pragma once
 
 #include "ble/profile_peripheral.h"
+#include "temperature_monitor.h"
+#include "wall_clock.h"
 
 /**
  * Create a BLE peripheral specific to the application requirements.
@@ -15,6 +17,18 @@
  * @return ble::profile::peripheral& The initialized BLE peripheral ready
  * for use. In this case the instance is statically allocated;
  * Its lifetime is forever.
+ *
+ * @param wall_clock          The clock presented and set by the Current Time Service.
+ * @param temperature_monitor Compensates the ADC sensor samples for temperature.
+ */
+ble::profile::peripheral& ble_peripheral_init(utility::wall_clock&          wall_clock,
+                                              nordic::temperature_monitor&  temperature_monitor);
+
+/**
+ * Evaluate the connection traffic and adapt the connection interval,
+ * PHY and data length to it. Called periodically from the run loop.
+ *
+ * @param now_msec The current time in milliseconds.
  */
-ble::profile::peripheral& ble_peripheral_init();
+void ble_peripheral_rate_update(uint32_t now_msec);
 
@@ -4,6 +4,7 @@
  */
 
 #include "ble_peripheral_init.h"
+#include "ble/nordic_ble_event_queue.h"
 
 #include "cmsis_gcc.h"
 #include "clocks.h"
@@ -11,29 +12,247 @@
 #include "buttons.h"
 #include "logger.h"
 #include "segger_rtt.h"
+#include "rtt_input_stream.h"
 #include "rtt_output_stream.h"
 #include "rtc_observer.h"
 #include "timer_observer.h"
+#include "run_loop.h"
+#include "nordic_run_loop_hooks.h"
+#include "nordic_work_timer.h"
+#include "profile.h"
+#include "isr_profile.h"
 #include "stack_usage.h"
+#include "temperature_compensation.h"
+#include "temperature_monitor.h"
 #include "version_info.h"
+#include "wall_clock.h"
+#include "watchdog_supervisor.h"
+#include "wdt.h"
+#include "section_macros.h"
 #include "project_assert.h"
 
 // The RTT output stream buffer allocation.
 static char rtt_os_buffer[4096u];
 
+#if defined ISR_PROFILE_ENABLED
+static char rtt_is_buffer[16u];
+#endif
+
+// The task which starved the watchdog; survives the watchdog reset.
+static watchdog_record_t watchdog_record IN_SECTION(".noinit");
+
+static uint64_t rtc_ticks(void* context)
+{
+    return reinterpret_cast<rtc*>(context)->get_count_extend_64();
+}
+
+static void ble_event_process(void*)
+{
+    nordic::ble_event_queue::instance().process();
+}
+
+static void ble_event_queued(void* context)
+{
+    static_cast<work_item*>(context)->post();
+}
+
+static void wall_clock_update(void* context)
+{
+    static_cast<utility::wall_clock*>(context)->update();
+}
+
+static void memory_report_log(void* context)
+{
+    static memory_report_t report;
+    memory_report(report);
+    memory_report_write(report, *static_cast<logger*>(context));
+}
+
+#if defined PROFILE_ENABLED
+static void profile_dump(void* context)
+{
+    profile::dump(*static_cast<logger*>(context));
+}
+#endif
+
+#if defined ISR_PROFILE_ENABLED
+static void isr_profile_query(void* context)
+{
+    isr_profile_instance().query(*static_cast<io::input_stream*>(context),
+                                 logger::instance());
+}
+#endif
+
+static void connection_rate_update(void* context)
+{
+    rtc const* rtc_1 = reinterpret_cast<rtc const*>(context);
+    uint64_t const now_msec = (rtc_1->get_count_extend_64() * 1000u) /
+                              rtc_1->ticks_per_second();
+    ble_peripheral_rate_update(static_cast<uint32_t>(now_msec));
+}
+
+static uint32_t rtc_ticks_32(void* context)
+{
+    return reinterpret_cast<rtc*>(context)->get_count_extend_32();
+}
+
+static void watchdog_feed(void*)
+{
+    wdt_service();
+}
+
+static void watchdog_timeout(void* context)
+{
+    static_cast<watchdog_supervisor*>(context)->timeout();
+}
+
+static void ble_pump_heartbeat(void* context)
+{
+    watchdog_supervisor::instance().check_in(
+        *static_cast<watchdog_supervisor::task_id*>(context));
+}
+
+/**
+ * @class watchdog_timer
+ * Run the watchdog supervisor and post the BLE pump heartbeat. The
+ * heartbeat runs at the BLE event priority; when it checks in the run
+ * loop is dispatching BLE events.
+ */
+class watchdog_timer: public rtc_observer
+{
+public:
+    watchdog_timer(work_item& heartbeat, uint32_t ticks_interval) :
+        rtc_observer(expiration_type::continuous, ticks_interval),
+        heartbeat_(heartbeat)
+    {
+    }
+
+    virtual void expiration_notify() override
+    {
+        watchdog_supervisor::instance().supervise();
+        this->heartbeat_.post();
+    }
+
+private:
+    work_item& heartbeat_;
+};
+
+/**
+ * @class wall_clock_temperature
+ * Correct the wall clock rate for the RTC crystal temperature drift.
+ * The crystal is assumed to be at the die temperature.
+ */
+class wall_clock_temperature: public nordic::temperature_listener
+{
+public:
+    explicit wall_clock_temperature(utility::wall_clock& wall_clock) :
+        wall_clock_(wall_clock)
+    {
+    }
+
+    virtual void temperature_update(int32_t temperature_Cx4) override
+    {
+        this->wall_clock_.temperature_drift_set(utility::crystal_drift_ppb(temperature_Cx4));
+    }
+
+private:
+    utility::wall_clock& wall_clock_;
+};
+
 int main(void)
 {
     lfclk_enable(LFCLK_SOURCE_XO);
 
+#if defined STACK_GUARD_ENABLED
+    // Count writes into the lowest 64 bytes of the stack.
+    stack_guard_enable(64u, 6u);
+#endif
+
+#if defined PROFILE_ENABLED || defined ISR_PROFILE_ENABLED
+    profile::cycle_counter_enable();
+#endif
+
     rtc_observable<> rtc_1(1u, 32u);
     rtc_1.start();
 
+    // The time base shared by the logger, the Current Time Service and
+    // sample time stamps.
+    utility::wall_clock wall_clock(rtc_1.ticks_per_second(), rtc_ticks, &rtc_1);
+
     rtt_output_stream rtt_os(rtt_os_buffer, sizeof(rtt_os_buffer));
     logger& logger = logger::instance();
     logger.set_rtc(rtc_1);
+    logger.set_wall_clock(wall_clock);
     logger.set_level(logger::level::debug);
     logger.set_output_stream(rtt_os);
 
+    // The main loop runs work items, flushes the logger in batches and
+    // sleeps until the next RTC deadline: 1 tick or less spins, 10 msec or
+    // more sleeps in low power mode.
+    nordic::run_loop_hooks run_loop_hooks(rtc_1);
+    run_loop_hooks.sleep_thresholds_set(1u, rtc_1.ticks_per_second() / 100u);
+    run_loop main_loop(run_loop_hooks);
+    main_loop.logger_flush_set(logger, rtc_1.ticks_per_second() / 10u,
+                               sizeof(rtt_os_buffer) / 2u, 2u);
+
+    // Dispatch BLE events from the main loop rather than from within the
+    // softdevice event handler.
+    work_function ble_event_work(main_loop, 0u, ble_event_process);
+    nordic::ble_event_queue& ble_event_queue = nordic::ble_event_queue::instance();
+    ble_event_queue.enable(rtc_1, ble_event_queued, &ble_event_work);
+
+    if (watchdog_record_is_valid(watchdog_record))
+    {
+        logger.error("watchdog reset: task: %s, late: %u ticks, at: %u ticks",
+                     watchdog_record.task_name, watchdog_record.ticks_late,
+                     watchdog_record.ticks);
+    }
+    watchdog_record_clear(watchdog_record);
+
+    // Tasks check in with the supervisor; the WDT is fed while all of the
+    // running tasks meet their deadlines.
+    watchdog_supervisor& watchdog = watchdog_supervisor::instance();
+    watchdog.init(watchdog_record, rtc_ticks_32, &rtc_1, rtc_1.ticks_per_second(),
+                  watchdog_feed, nullptr);
+
+    watchdog_supervisor::task_id ble_pump_task = watchdog.task_register("ble_pump", 2000u);
+    work_function  ble_pump_work(main_loop, 0u, ble_pump_heartbeat, &ble_pump_task);
+    watchdog_timer watchdog_supervise_timer(ble_pump_work, rtc_1.ticks_per_second() / 4u);
+    rtc_1.attach(watchdog_supervise_timer);
+
+    // Keep the wall clock rate correction current once a minute.
+    work_function wall_clock_work(main_loop, 3u, wall_clock_update, &wall_clock);
+    nordic::work_timer wall_clock_timer(wall_clock_work, rtc_1.ticks_per_second() * 60u);
+    rtc_1.attach(wall_clock_timer);
+
+    // Sample the die temperature every 10 seconds, filtered over 8 samples.
+    nordic::temperature_monitor temperature_monitor(main_loop, 3u,
+                                                    rtc_1.ticks_per_second() * 10u, 3u);
+    wall_clock_temperature      wall_clock_compensation(wall_clock);
+    temperature_monitor.attach(wall_clock_compensation);
+    rtc_1.attach(temperature_monitor);
+
+#if defined PROFILE_ENABLED
+    // Dump the profile zones once a minute.
+    work_function      profile_work(main_loop, 3u, profile_dump, &logger);
+    nordic::work_timer profile_timer(profile_work, rtc_1.ticks_per_second() * 60u);
+    rtc_1.attach(profile_timer);
+#endif
+
+    // Report the stack and memory pool watermarks once a minute.
+    work_function      memory_report_work(main_loop, 3u, memory_report_log, &logger);
+    nordic::work_timer memory_report_timer(memory_report_work, rtc_1.ticks_per_second() * 60u);
+    rtc_1.attach(memory_report_timer);
+
+#if defined ISR_PROFILE_ENABLED
+    // Answer ISR profile queries typed into RTT down channel 0:
+    // 'd' dump, 'w' worst ISRs, 'r' reset.
+    rtt_input_stream   rtt_is(rtt_is_buffer, sizeof(rtt_is_buffer));
+    work_function      isr_profile_work(main_loop, 3u, isr_profile_query, &rtt_is);
+    nordic::work_timer isr_profile_timer(isr_profile_work, rtc_1.ticks_per_second() / 4u);
+    rtc_1.attach(isr_profile_timer);
+#endif
+
     segger_rtt_enable();
 
     leds_board_init();
@@ -48,18 +267,19 @@ int main(void)
                 version_info.git_hash[2u],
                 version_info.git_hash[3u]);
 
-    ble::profile::peripheral& ble_peripheral = ble_peripheral_init();
+    ble::profile::peripheral& ble_peripheral = ble_peripheral_init(wall_clock, temperature_monitor);
     ble_peripheral.advertising().start();
 
-    logger.info("stack: free: %5u 0x%04x, size: %5u 0x%04x",
-                stack_free(), stack_free(), stack_size(), stack_size());
+    // Adapt the connection rate to the link traffic every 500 msec.
+    work_function      rate_work(main_loop, 2u, connection_rate_update, &rtc_1);
+    nordic::work_timer rate_timer(rate_work, rtc_1.ticks_per_second() / 2u);
+    rtc_1.attach(rate_timer);
 
-    for (;;)
-    {
-        logger.flush();
-        if (rtt_os.write_pending() == 0)
-        {
-            __WFE();
-        }
-    }
+    memory_report_log(&logger);
+
+    // Start the WDT once all of the tasks have registered.
+    wdt_init(2u, watchdog_timeout, &watchdog);
+    wdt_start(wdt_msec_to_ticks(3000u));
+
+    main_loop.run();
 }
@@ -13,9 +13,27 @@
 #include "logger.h"
 #include "project_assert.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
 namespace nordic
 {
 
+/**
+ * The SAADC gain relative to 25 C, which the offset calibration does not
+ * correct. The curve models a gain temperature coefficient of 20 ppm / C;
+ * replace the points with a characterization of the board when available.
+ */
+static constexpr utility::compensation_point const saadc_gain_points[] = {
+    { -40 * 4, 65621 },     // 1 / (1 - 0.0013)
+    {  25 * 4, 65536 },
+    {  85 * 4, 65457 },     // 1 / (1 + 0.0012)
+};
+
+static utility::compensation_curve const saadc_gain_curve(
+    saadc_gain_points, std::size(saadc_gain_points));
+
 void saadc_sensor_acquisition::init()
 {
     // Use a higher than normal priority here. This is might
@@ -56,12 +74,82 @@ void saadc_sensor_acquisition::init()
     this->timer_observable_.detach(this->saadc_sample_timer_);
 
     this->saadc_trigger_event_ = this->timer_observable_.cc_get_event(cc_index);
+
+    // Samples are taken once per second; supervised only while converting.
+    watchdog_supervisor& watchdog = watchdog_supervisor::instance();
+    this->watchdog_task_ = watchdog.task_register("saadc", 3000u);
+    ASSERT(this->watchdog_task_ != watchdog_supervisor::task_invalid);
+    watchdog.suspend(this->watchdog_task_);
 }
 
 void saadc_sensor_acquisition::conversion_start()
+{
+    this->started_ = true;
+
+    // Calibrate before starting; the calibration complete event then
+    // starts the acquisition.
+    this->calibration_retry();
+    if (not this->calibrating_ && not this->acquiring_)
+    {
+        this->acquisition_start();
+    }
+}
+
+void saadc_sensor_acquisition::conversion_stop()
+{
+    this->started_ = false;
+    if (this->acquiring_)
+    {
+        this->acquisition_stop();
+    }
+
+    // The ring stops synchronously; a timed conversion retries on STOPPED.
+    this->calibration_retry();
+    watchdog_supervisor::instance().suspend(this->watchdog_task_);
+}
+
+void saadc_sensor_acquisition::acquisition_start()
+{
+    this->acquiring_ = true;
+    if (this->threshold_enabled_)
+    {
+        this->capture_.start();
+    }
+    else
+    {
+        this->timed_conversion_start(sample_interval_msec);
+        watchdog_supervisor::instance().resume(this->watchdog_task_);
+    }
+}
+
+void saadc_sensor_acquisition::acquisition_stop()
+{
+    this->acquiring_ = false;
+    if (this->threshold_enabled_)
+    {
+        this->capture_.stop();
+        this->capture_.dump(logger::instance());
+    }
+    else
+    {
+        this->timed_conversion_stop();
+    }
+}
+
+void saadc_sensor_acquisition::threshold_limits_set(saadc_input_channel_t   channel,
+                                                    int16_t                 lower,
+                                                    int16_t                 upper)
+{
+    this->capture_.limits_set(channel, lower, upper);
+    this->threshold_enabled_ = true;
+}
+
+void saadc_sensor_acquisition::timed_conversion_start(uint32_t interval_msec)
 {
     logger& logger = logger::instance();
 
+    this->saadc_sample_timer_.expiration_set(this->timer_observable_.msec_to_ticks(interval_msec));
+
     // The saadc_sample_timer_ is not expected to be attached, but check it.
     if (not this->saadc_sample_timer_.is_attached())
     {
@@ -81,7 +169,7 @@ void saadc_sensor_acquisition::conversion_start()
                              this->saadc_trigger_event_);
 }
 
-void saadc_sensor_acquisition::conversion_stop()
+void saadc_sensor_acquisition::timed_conversion_stop()
 {
     if (this->saadc_sample_timer_.is_attached())
     {
@@ -95,6 +183,61 @@ void saadc_sensor_acquisition::conversion_stop()
     ::saadc_conversion_stop();
 }
 
+void saadc_sensor_acquisition::ring_start(int16_t*                  ring,
+                                          std::size_t               ring_length,
+                                          threshold_limits const*   limits,
+                                          std::size_t               channels)
+{
+    for (saadc_input_channel_t channel = 0u; channel < channels; ++channel)
+    {
+        if ((limits[channel].lower == INT16_MIN) && (limits[channel].upper == INT16_MAX))
+        {
+            ::saadc_disable_limit_event(channel);
+        }
+        else
+        {
+            ::saadc_enable_limits_event(channel, limits[channel].lower, limits[channel].upper);
+        }
+    }
+
+    // One frame is sampled per slow RTC tick.
+    this->ring_ticks_start_ = this->slow_rtc_.get_count_extend_32();
+    ::saadc_ring_start(ring, static_cast<uint16_t>(ring_length),
+                       this->slow_rtc_.tick_event_enable());
+
+    // Armed, there are no conversion interrupts to check in from.
+    watchdog_supervisor::instance().suspend(this->watchdog_task_);
+}
+
+threshold_capture_hooks::ring_position saadc_sensor_acquisition::ring_stop()
+{
+    struct saadc_ring_position_t const position = ::saadc_ring_stop();
+    this->slow_rtc_.tick_event_disable();
+
+    return ring_position{
+        position.sample_index,
+        position.wrapped,
+        this->slow_rtc_.get_count_extend_32() - this->ring_ticks_start_
+    };
+}
+
+void saadc_sensor_acquisition::capture_start()
+{
+    // Fast frames are compared with the limits in software.
+    for (saadc_input_channel_t channel = 0u; channel < channel_count; ++channel)
+    {
+        ::saadc_disable_limit_event(channel);
+    }
+
+    this->timed_conversion_start(capture_interval_msec);
+    watchdog_supervisor::instance().resume(this->watchdog_task_);
+}
+
+void saadc_sensor_acquisition::capture_stop()
+{
+    this->timed_conversion_stop();
+}
+
 void saadc_sensor_acquisition::saadc_conversion_started()
 {
     logger& logger = logger::instance();
@@ -117,7 +260,92 @@ void saadc_sensor_acquisition::saadc_conversion_complete(int16_t const* sample_d
     logger.debug("SAADC event: conversion complete: 0x%p, %d samples",
                  sample_data, sample_count);
 
-    this->adc_samples_characterisitc_.sample_conversion_complete(sample_data, sample_count);
+    if (this->threshold_enabled_)
+    {
+        this->capture_.frame_complete(sample_data);
+    }
+    else
+    {
+        this->frame_deliver(sample_data, sample_count);
+    }
+
+    watchdog_supervisor::instance().check_in(this->watchdog_task_);
+}
+
+void saadc_sensor_acquisition::frame_deliver(int16_t const* sample_data, uint16_t sample_count)
+{
+    int32_t const gain_q16 = this->gain_q16_.load(std::memory_order_relaxed);
+    sample_buffer compensated;
+    sample_count = std::min<uint16_t>(sample_count, compensated.size());
+    for (uint16_t index = 0u; index < sample_count; ++index)
+    {
+        compensated[index] = utility::gain_apply(sample_data[index], gain_q16);
+    }
+
+    this->adc_samples_characterisitc_.sample_conversion_complete(compensated.data(), sample_count);
+}
+
+void saadc_sensor_acquisition::capture_frame_sink(int16_t const*    frame,
+                                                  std::size_t       channel_count,
+                                                  void*             context)
+{
+    saadc_sensor_acquisition* saadc_sensor_acq = static_cast<saadc_sensor_acquisition*>(context);
+    saadc_sensor_acq->frame_deliver(frame, static_cast<uint16_t>(channel_count));
+}
+
+void saadc_sensor_acquisition::temperature_update(int32_t temperature_Cx4)
+{
+    this->gain_q16_.store(saadc_gain_curve.evaluate(temperature_Cx4), std::memory_order_relaxed);
+
+    if (this->calibration_valid_ &&
+        (std::abs(temperature_Cx4 - this->calibration_Cx4_) < calibration_step_Cx4))
+    {
+        return;
+    }
+
+    logger::instance().info("SAADC calibrate: temperature: %d, last: %d (0.25 C)",
+                            temperature_Cx4, this->calibration_Cx4_);
+
+    this->calibration_Cx4_   = temperature_Cx4;
+    this->calibration_valid_ = true;
+    this->calibration_pending_ = true;
+    this->calibration_retry();
+}
+
+void saadc_sensor_acquisition::calibration_retry()
+{
+    // A started SAADC is triggered by the timer or RTC through PPI;
+    // a SAMPLE must not land during the calibration.
+    if (not this->calibration_pending_ || this->acquiring_)
+    {
+        return;
+    }
+
+    // Called from both the run loop and the SAADC STOPPED ISR: claim the
+    // calibration atomically so that only one caller starts it.
+    // Set before starting; the calibration complete event clears it.
+    if (this->calibrating_.exchange(true))
+    {
+        return;
+    }
+
+    if (::saadc_calibrate_offset())
+    {
+        this->calibration_pending_ = false;
+    }
+    else
+    {
+        this->calibrating_ = false;
+    }
+}
+
+void saadc_sensor_acquisition::calibration_complete()
+{
+    this->calibrating_ = false;
+    if (this->started_ && not this->acquiring_)
+    {
+        this->acquisition_start();
+    }
 }
 
 size_t saadc_sensor_acquisition::sample_bank_increment(size_t index) const
@@ -150,6 +378,7 @@ void saadc_sensor_acquisition::saadc_event_handler(
     case saadc_event_conversion_stop:
         logger.debug("SAADC event: conversion stop: 0x%p, %d samples",
                      event_info->conversion.data, event_info->conversion.length);
+        saadc_sensor_acq->calibration_retry();
         break;
     case saadc_event_conversion_complete:
         {
@@ -164,6 +393,7 @@ void saadc_sensor_acquisition::saadc_event_handler(
                 saadc_get_channel_limits(event_info->limits_exceeded.input_channel);
             logger.info("SAADC event: chan: %d, lower limit %u 0x%x exceeded",
                         event_info->limits_exceeded.input_channel, limits.lower, limits.lower);
+            saadc_sensor_acq->capture_.limit_crossed(event_info->limits_exceeded.input_channel);
         }
         break;
     case saadc_event_limit_upper:
@@ -172,10 +402,12 @@ void saadc_sensor_acquisition::saadc_event_handler(
                 saadc_get_channel_limits(event_info->limits_exceeded.input_channel);
             logger.info("SAADC event: chan: %d, upper limit %u 0x%x exceeded",
                         event_info->limits_exceeded.input_channel, limits.upper, limits.upper);
+            saadc_sensor_acq->capture_.limit_crossed(event_info->limits_exceeded.input_channel);
         }
         break;
     case saddc_event_calibration_complete:
         logger.info("SAADC event: calibration complete");
+        saadc_sensor_acq->calibration_complete();
         break;
     default:
         ASSERT(0);
@@ -7,10 +7,16 @@
 #include "ble/service/nordic_saadc_sensor_service.h"
 #include "nordic/peripherals/saadc.h"
 
+#include "rtc.h"
 #include "timer.h"
 #include "timer_observer.h"
+#include "temperature_compensation.h"
+#include "temperature_monitor.h"
+#include "threshold_capture.h"
+#include "watchdog_supervisor.h"
 
 #include <array>
+#include <atomic>
 
 namespace nordic
 {
@@ -30,11 +36,21 @@ private:
 };
 
 /**
+ * Sample AIN0 and AIN1 continuously, or in wake on threshold mode once
+ * limits are set with threshold_limits_set().
+ *
+ * In wake on threshold mode the slow RTC TICK event samples into a
+ * pre-trigger ring through PPI and the SAADC limits are compared in
+ * hardware; the CPU sleeps. A limit crossing delivers the ring and starts
+ * fast TIMER triggered sampling, until the samples are quiet again.
+ *
  * @todo At present we are not utilizing the depth of the
  * nordic::saadc_samples_characteristic
  * adc_samples_characteristic::sample_data[] allocation.
  */
-class saadc_sensor_acquisition: public nordic::adc_sensor_acquisition
+class saadc_sensor_acquisition: public nordic::adc_sensor_acquisition,
+                                 public nordic::temperature_listener,
+                                 private threshold_capture_hooks
 {
 public:
     using value_type = nordic::saadc_samples_characteristic::value_type;
@@ -42,6 +58,24 @@ public:
     /// Two buffers are allocated for SAADC double buffering.
     static constexpr size_t const sample_buffer_depth = 2u;
 
+    /// The channels converted; AIN0 and AIN1.
+    static constexpr size_t const channel_count = 2u;
+
+    /// The continuous sampling interval.
+    static constexpr uint32_t const sample_interval_msec = 1000u;
+
+    /// The fast sampling interval while capturing a threshold crossing.
+    static constexpr uint32_t const capture_interval_msec = 10u;
+
+    /// The frames sampled at the slow rate kept before a crossing.
+    static constexpr size_t const pretrigger_frames = 16u;
+
+    /// The fast frames within the limits which end a capture: 2 seconds.
+    static constexpr uint32_t const quiet_frames = 200u;
+
+    /// Recalibrate the SAADC offset when the temperature moves this far.
+    static constexpr int32_t const calibration_step_Cx4 = 5 * 4;
+
     virtual ~saadc_sensor_acquisition()                                  = default;
 
     saadc_sensor_acquisition()                                           = delete;
@@ -50,22 +84,54 @@ public:
     saadc_sensor_acquisition& operator=(saadc_sensor_acquisition const&) = delete;
     saadc_sensor_acquisition& operator=(saadc_sensor_acquisition&&)      = delete;
 
+    /**
+     * @param adc_samples_char The characteristic notified with the samples.
+     * @param timer_observable Triggers the continuous and fast sampling.
+     * @param slow_rtc         Its TICK event triggers the slow sampling
+     *                         in wake on threshold mode. It must be started.
+     */
     saadc_sensor_acquisition(
         nordic::saadc_samples_characteristic&   adc_samples_char,
-        timer_observable<>&                     timer_observable)
+        timer_observable<>&                     timer_observable,
+        rtc&                                    slow_rtc)
         : adc_samples_characterisitc_(adc_samples_char),
           timer_observable_(timer_observable),
-          saadc_sample_timer_(timer_observable.msec_to_ticks(1000u)),
+          saadc_sample_timer_(timer_observable.msec_to_ticks(sample_interval_msec)),
           saadc_trigger_event_(nullptr),
+          slow_rtc_(slow_rtc),
+          ring_ticks_start_(0u),
+          threshold_enabled_(false),
+          capture_(*this, ring_.data(), pretrigger_frames, channel_count,
+                   quiet_frames, capture_frame_sink, this),
+          watchdog_task_(watchdog_supervisor::task_invalid),
+          gain_q16_(utility::gain_unity_q16),
+          calibration_Cx4_(0),
+          calibration_valid_(false),
+          calibration_pending_(false),
+          calibrating_(false),
+          started_(false),
+          acquiring_(false),
           sample_buffer_bank_index(0u)
     {
         for (sample_buffer& buffer : sample_buffer_banks) { buffer.fill(0); }
+        this->ring_.fill(0);
     }
 
     virtual void init() override;
     virtual void conversion_start() override;
     virtual void conversion_stop() override;
 
+    /// Update the gain compensation; recalibrate on a temperature step.
+    virtual void temperature_update(int32_t temperature_Cx4) override;
+
+    /**
+     * Set a channel's limits and use wake on threshold mode.
+     * Takes effect from the next conversion_start().
+     */
+    void threshold_limits_set(saadc_input_channel_t channel, int16_t lower, int16_t upper);
+
+    threshold_capture const& capture() const { return this->capture_; }
+
 private:
     nordic::saadc_samples_characteristic& adc_samples_characterisitc_;
 
@@ -73,6 +139,32 @@ private:
     saadc_sample_timer      saadc_sample_timer_;
     uint32_t volatile*      saadc_trigger_event_;
 
+    rtc&                    slow_rtc_;
+    uint32_t                ring_ticks_start_;
+    bool                    threshold_enabled_;
+
+    std::array<value_type, pretrigger_frames * channel_count> ring_;
+    threshold_capture       capture_;
+
+    /// Conversions must complete within the watchdog deadline while started.
+    watchdog_supervisor::task_id watchdog_task_;
+
+    /// The gain correction for the die temperature, applied to each sample.
+    std::atomic<int32_t>    gain_q16_;
+
+    /// The temperature at the last offset calibration.
+    int32_t                 calibration_Cx4_;
+    bool                    calibration_valid_;
+
+    /// A calibration was requested while converting; retried when stopped.
+    std::atomic<bool>       calibration_pending_;
+    std::atomic<bool>       calibrating_;
+
+    /// started_:   conversion_start() was called, without conversion_stop().
+    /// acquiring_: The SAADC is sampling; false while calibrating.
+    std::atomic<bool>       started_;
+    std::atomic<bool>       acquiring_;
+
     using sample_buffer = std::array<value_type, saadc_input_channel_count>;
 
     std::array<sample_buffer, sample_buffer_depth> sample_buffer_banks;
@@ -93,6 +185,39 @@ private:
      */
     void saadc_conversion_complete(int16_t const *sample_data, uint16_t sample_count);
 
+    /**
+     * Start a pending offset calibration if the SAADC is stopped.
+     * Calibrations are deferred until conversion_stop(), or made before
+     * the acquisition starts in conversion_start().
+     */
+    void calibration_retry();
+
+    /// Start the acquisition deferred by a calibration.
+    void calibration_complete();
+
+    void acquisition_start();
+    void acquisition_stop();
+
+    /// Sample every interval_msec, triggered by the timer through PPI.
+    void timed_conversion_start(uint32_t interval_msec);
+    void timed_conversion_stop();
+
+    /// Compensate a frame and notify the characteristic.
+    void frame_deliver(int16_t const* sample_data, uint16_t sample_count);
+
+    static void capture_frame_sink(int16_t const*   frame,
+                                   std::size_t      channel_count,
+                                   void*            context);
+
+    virtual void ring_start(int16_t*                ring,
+                            std::size_t             ring_length,
+                            threshold_limits const* limits,
+                            std::size_t             channels) override;
+
+    virtual ring_position ring_stop() override;
+    virtual void capture_start() override;
+    virtual void capture_stop() override;
+
     /// Increment the sample buffer index within the sample_buffer_banks[].
     size_t sample_bank_increment(size_t index) const;
 
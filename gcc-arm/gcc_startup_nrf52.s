@@ -256,6 +256,24 @@ Reset_Handler:
 .L_loop3_done:
 #endif /* __STARTUP_CLEAR_BSS */
 
+/* Paint the stack so that the stack high water mark can be found; see
+ * stack_usage.h. The stack is unused: paint from __StackLimit to sp.
+ * The pattern must match stack_paint_pattern.
+ */
+    ldr r1, =__StackLimit
+    mov r2, sp
+    ldr r0, =0xA5C35A3C
+
+    subs r2, r1
+    ble .L_loop4_done
+
+.L_loop4:
+    subs r2, #4
+    str r0, [r1, r2]
+    bgt .L_loop4
+
+.L_loop4_done:
+
 /* Execute SystemInit function. */
     bl SystemInit
 
@@ -4,57 +4,101 @@
  */
 
 #include "stack_usage.h"
+#include "memory_watermark.h"
+#include "mwu.h"
 #include "cmsis_gcc.h"
 
-static uint32_t fill_pattern_ = 0u;
-
 // Alignment mask for 32-bit pointers.
 constexpr uint32_t const mask_32 = ~0x03u;
 
-extern uint32_t const __StackTop;
-extern uint32_t const __StackLimit;
+/// The words left unpainted below the stack pointer by stack_fill().
+constexpr size_t const stack_fill_margin = 16u;
+
+/// The MWU REGION[] index used as the stack guard.
+constexpr uint8_t const stack_guard_region = 3u;
+
+extern uint32_t __StackTop;
+extern uint32_t __StackLimit;
+
+static stack_watermark stack_mark(&__StackLimit, &__StackTop, stack_paint_pattern);
+static size_t          stack_guard_words = 0u;
+static uint32_t        stack_guard_hit_count = 0u;
 
 // Reminder: stack grows from top down.
 // Stack is in use from __StackTop down to stack pointer.
-void stack_fill(uint32_t pattern)
+void stack_fill(void)
 {
-    fill_pattern_ = pattern;
+    // An ISR using the stack below the stack pointer would be overwritten.
+    uint32_t const primask = __get_PRIMASK();
+    __disable_irq();
 
     uintptr_t stack_ptr = __get_MSP();
     stack_ptr &= mask_32;
 
-    uint32_t* stack_iter  = reinterpret_cast<uint32_t *>(stack_ptr);
-    uint32_t* stack_limit = const_cast<uint32_t *>(&__StackLimit);
-    stack_iter -= 4u;
-
-    for ( ; stack_iter >= stack_limit; --stack_iter)
+    // The guard region is not repainted: the MWU would detect the writes.
+    uint32_t* stack_begin = &__StackLimit + stack_guard_words;
+    uint32_t* stack_end   = reinterpret_cast<uint32_t *>(stack_ptr) - stack_fill_margin;
+    if (stack_begin < stack_end)
     {
-        *stack_iter = fill_pattern_;
+        stack_mark.repaint(stack_begin, stack_end);
     }
+
+    __set_PRIMASK(primask);
 }
 
 size_t stack_free(void)
 {
-    for (uint32_t const* stack_iter = &__StackLimit; stack_iter < &__StackTop;
-          ++stack_iter)
-    {
-        if (*stack_iter != fill_pattern_)
-        {
-            ptrdiff_t const free_32 = stack_iter - &__StackLimit;
-            return free_32 * sizeof(uint32_t);
-        }
-    }
+    stack_mark.scan();
+    return stack_mark.free_min();
+}
 
-    // Unexpected: no stack used. Likely a bug in this code.
-    return stack_size();
+size_t stack_free_exact(void)
+{
+    stack_mark.scan_exact();
+    return stack_mark.free_min();
 }
 
 size_t stack_used(void)
 {
-    return stack_size() - stack_free();
+    return stack_mark.scan();
 }
 
 size_t stack_size(void)
 {
-    return (&__StackTop - &__StackLimit) * sizeof(uint32_t);
+    return stack_mark.size();
+}
+
+static void stack_guard_handler(uint8_t region, void* context)
+{
+    (void) region;
+    (void) context;
+    stack_guard_hit_count += 1u;
+}
+
+void stack_guard_enable(size_t guard_bytes, uint8_t irq_priority)
+{
+    stack_guard_words = guard_bytes / sizeof(uint32_t);
+
+    uintptr_t const guard_start = reinterpret_cast<uintptr_t>(&__StackLimit);
+    uintptr_t const guard_end   = guard_start + stack_guard_words * sizeof(uint32_t) - 1u;
+
+    mwu_write_watch_enable(stack_guard_region, guard_start, guard_end, irq_priority,
+                           stack_guard_handler, nullptr);
+}
+
+uint32_t stack_guard_hits(void)
+{
+    return stack_guard_hit_count;
+}
+
+void memory_report(memory_report_t& report)
+{
+    stack_mark.scan();
+
+    report.stack.size       = stack_mark.size();
+    report.stack.used_max   = stack_mark.used_max();
+    report.stack.free_min   = stack_mark.free_min();
+    report.stack.guard_hits = stack_guard_hit_count;
+
+    memory_watermark_collect(report);
 }
@@ -1,6 +1,13 @@
 /**
  * @file stack_usage.h
  * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The main stack high water mark. Thread mode and all exception handlers
+ * use the main stack, MSP; its high water mark includes the deepest ISR
+ * nesting at every priority.
+ *
+ * Reset_Handler paints the stack with stack_paint_pattern before any of
+ * the stack is used; see gcc_startup_nrf52.s.
  */
 
 #pragma once
@@ -8,26 +15,53 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/// The stack paint value; must match the value in gcc_startup_nrf52.s.
+#define stack_paint_pattern (0xA5C35A3Cu)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * Fill the unused region of stack with a 32-bit user defined patter.
- * @param pattern A 32-bit value.
+ * Repaint the unused region of stack below the stack pointer. Restarts the
+ * high water measurement from the current stack depth.
  */
-void stack_fill(uint32_t pattern);
+void stack_fill(void);
 
-/// @return size_t The number of bytes unused by the stack.
+/**
+ * @return size_t The number of bytes never used by the stack.
+ * An incremental binary search: @see stack_watermark::scan().
+ */
 size_t stack_free(void);
 
-/// @return size_t The number of bytes used by the stack.
+/// @return size_t The number of bytes never used by the stack; a linear scan.
+size_t stack_free_exact(void);
+
+/// @return size_t The high water mark: the most bytes used by the stack.
 size_t stack_used(void);
 
 /// @return size_t The number of bytes allocated for use by the stack.
 size_t stack_size(void);
 
+/**
+ * Watch the lowest guard_bytes of the stack with the MWU. A write into the
+ * guard region is counted by stack_guard_hits(); the stack is about to
+ * overflow.
+ *
+ * @param guard_bytes  The guard region size; a multiple of 4 bytes.
+ * @param irq_priority The MWU interrupt priority.
+ */
+void stack_guard_enable(size_t guard_bytes, uint8_t irq_priority);
+
+/// @return uint32_t The number of writes detected in the guard region.
+uint32_t stack_guard_hits(void);
+
 #ifdef __cplusplus
 }
-#endif
 
+#include "memory_watermark.h"
+
+/// Fill the report with the stack and the memory pool watermarks.
+void memory_report(memory_report_t& report);
+
+#endif
@@ -164,6 +164,14 @@ size_t logger::write_data(level                 log_level,
 
 size_t logger::log_time()
 {
+    if (this->wall_clock_)
+    {
+        utility::wall_clock::time_point const time = this->wall_clock_->now();
+        unsigned int const msec = (time.fraction_256 * 1000u) >> 8u;
+
+        return ::writef(*this->os_, "%6llu.%03u ", time.seconds, msec);
+    }
+
     if (this->rtc_)
     {
         uint64_t const timer_ticks = this->rtc_->get_count_extend_64();
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "rtc.h"
+#include "wall_clock.h"
 #include "stream.h"
 #include "write_data.h"
 
@@ -33,7 +34,11 @@ public:
     logger& operator=(logger const& other)  = delete;
 
     static logger& instance();
-    logger() : os_(nullptr), rtc_(nullptr), log_level_(logger::level::warning)
+    logger() :
+        os_(nullptr),
+        rtc_(nullptr),
+        wall_clock_(nullptr),
+        log_level_(logger::level::warning)
     {
     }
 /*
@@ -78,10 +83,16 @@ public:
 
     void set_rtc(rtc& rtc) { this->rtc_ = &rtc; }
 
+    /// When set, log entries are time stamped by the wall clock, not the rtc.
+    void set_wall_clock(utility::wall_clock& wall_clock) {
+        this->wall_clock_ = &wall_clock;
+    }
+
 private:
-    io::output_stream*  os_;
-    rtc*                rtc_;
-    logger::level       log_level_;
+    io::output_stream*      os_;
+    rtc*                    rtc_;
+    utility::wall_clock*    wall_clock_;
+    logger::level           log_level_;
 
     size_t log_time();
     size_t write_preamble(logger::level log_level);
@@ -0,0 +1,45 @@
+/**
+ * @file rtt_input_stream.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "rtt_input_stream.h"
+#include "segger_rtt.h"
+
+rtt_input_stream::~rtt_input_stream()
+{
+}
+
+rtt_input_stream::rtt_input_stream(void*            buffer,
+                                   size_t           buffer_size,
+                                   rtt_channel_t    channel,
+                                   char const*      name)
+:   channel_(channel)
+{
+    rtt_channel_alloc const rtt_chn = {
+        .direction   = rtt_channel_alloc::down,
+        .channel     = channel,
+        .buffer      = buffer,
+        .buffer_size = buffer_size,
+        .name        = name
+    };
+
+    segger_rtt_channel_allocate(&rtt_chn);
+}
+
+size_t rtt_input_stream::read(void *buffer, size_t length)
+{
+    return SEGGER_RTT_Read(this->channel_, buffer, length);
+}
+
+size_t rtt_input_stream::read_pending() const
+{
+    // SEGGER_RTT_ReadAvailable() is the number of bytes ready to be read.
+    return SEGGER_RTT_ReadAvailable(this->channel_);
+}
+
+size_t rtt_input_stream::read_avail() const
+{
+    // SEGGER_RTT_ReadPending() is the space remaining in the ring buffer.
+    return SEGGER_RTT_ReadPending(this->channel_);
+}
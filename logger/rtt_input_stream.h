@@ -0,0 +1,49 @@
+/**
+ * @file rtt_input_stream.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#pragma once
+
+#include "stream.h"
+#include "segger_rtt.h"
+
+#include <cstddef>
+
+/**
+ * @class rtt_input_stream
+ * An input stream read from an RTT 'down' channel; host to target.
+ * Used to receive commands from the host.
+ */
+class rtt_input_stream: public io::input_stream
+{
+public:
+    using input_stream::input_stream;
+    virtual ~rtt_input_stream() override;
+
+    rtt_input_stream() = delete;
+
+    /**
+     * @param buffer      The ring buffer storage; must outlive RTT usage.
+     * @param buffer_size The ring buffer size in bytes.
+     * @param channel     The RTT down channel.
+     * @param name        The channel name shown by the host; if null the
+     *                    default name for the channel is used.
+     */
+    rtt_input_stream(void*          buffer,
+                     size_t         buffer_size,
+                     rtt_channel_t  channel = 0u,
+                     char const*    name    = nullptr);
+
+    virtual size_t read(void *buffer, size_t length) override;
+    virtual size_t read_pending() const              override;
+    virtual size_t read_avail()   const              override;
+
+    /// The host writes directly into the ring buffer; there is nothing to fill.
+    virtual void   fill()                            override {}
+
+    rtt_channel_t channel() const { return this->channel_; }
+
+private:
+    rtt_channel_t const channel_;
+};
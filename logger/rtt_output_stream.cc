@@ -6,45 +6,167 @@
 #include "rtt_output_stream.h"
 #include "segger_rtt.h"
 
-// This stream always writes to the RTT "Terminal" output.
-static constexpr rtt_channel_t const rtt_channel = 0u;
-
 rtt_output_stream::~rtt_output_stream()
 {
 }
 
-rtt_output_stream::rtt_output_stream(void* buffer, size_t buffer_size)
+rtt_output_stream::rtt_output_stream(void*              buffer,
+                                     size_t             buffer_size,
+                                     rtt_channel_t      channel,
+                                     overflow_policy    policy,
+                                     char const*        name)
+:   channel_(channel),
+    policy_(policy),
+    timeout_ticks_(block_polls_default),
+    tick_source_(nullptr),
+    tick_context_(nullptr),
+    host_has_read_(false),
+    bytes_written_(0u),
+    bytes_dropped_(0u),
+    overflow_count_(0u),
+    timeout_count_(0u),
+    watermark_(name ? name : "rtt_up", buffer_size)
 {
     rtt_channel_alloc const rtt_chn = {
         .direction   = rtt_channel_alloc::up,
-        .channel     = 0u,
+        .channel     = channel,
         .buffer      = buffer,
-        .buffer_size = buffer_size
+        .buffer_size = buffer_size,
+        .name        = name
     };
 
     segger_rtt_channel_allocate(&rtt_chn);
 }
 
+void rtt_output_stream::set_block_timeout(uint64_t      timeout_ticks,
+                                          tick_source   source,
+                                          void*         context)
+{
+    this->timeout_ticks_ = timeout_ticks;
+    this->tick_source_   = source;
+    this->tick_context_  = context;
+}
+
+uint64_t rtt_output_stream::ticks() const
+{
+    return this->tick_source_ ? this->tick_source_(this->tick_context_) : 0u;
+}
+
+bool rtt_output_stream::host_has_read()
+{
+    if (not this->host_has_read_)
+    {
+        this->host_has_read_ = (segger_rtt_up_read_offset(this->channel_) != 0u);
+    }
+    return this->host_has_read_;
+}
+
 size_t rtt_output_stream::write(void const *buffer, size_t length)
 {
-    return SEGGER_RTT_Write(rtt_channel, buffer, length);
+    size_t written = 0u;
+    size_t dropped = 0u;
+
+    switch (this->policy_)
+    {
+    case overflow_policy::drop_newest:
+        written = SEGGER_RTT_Write(this->channel_, buffer, length);
+        dropped = length - written;
+        break;
+
+    case overflow_policy::block:
+        written = this->write_blocking(static_cast<uint8_t const*>(buffer), length);
+        dropped = length - written;
+        break;
+
+    default:
+        break;
+    }
+
+    this->bytes_written_ += written;
+    this->watermark_.record(this->write_pending());
+    if (dropped > 0u)
+    {
+        this->bytes_dropped_  += dropped;
+        this->overflow_count_ += 1u;
+    }
+
+    return written;
+}
+
+size_t rtt_output_stream::write_blocking(uint8_t const *buffer, size_t length)
+{
+    size_t   written = SEGGER_RTT_Write(this->channel_, buffer, length);
+    if (not this->host_has_read())
+    {
+        // Without a host reading there is no point waiting for room.
+        return written;
+    }
+
+    uint64_t const start = this->ticks();
+    uint64_t polls = 0u;
+
+    while (written < length)
+    {
+        uint64_t const elapsed = this->tick_source_ ? (this->ticks() - start) : polls++;
+        if (elapsed >= this->timeout_ticks_)
+        {
+            this->timeout_count_ += 1u;
+            break;
+        }
+
+        written += SEGGER_RTT_Write(this->channel_, buffer + written, length - written);
+    }
+
+    return written;
+}
+
+void* rtt_output_stream::reserve(size_t& length)
+{
+    return SEGGER_RTT_WriteReserve(this->channel_, &length);
+}
+
+void rtt_output_stream::commit(size_t length)
+{
+    SEGGER_RTT_WriteCommit(this->channel_, length);
+    this->bytes_written_ += length;
 }
 
 size_t rtt_output_stream::write_pending() const
 {
-    return SEGGER_RTT_WritePending(rtt_channel);
+    return SEGGER_RTT_WritePending(this->channel_);
 }
 
 size_t rtt_output_stream::write_avail() const
 {
-    return SEGGER_RTT_WriteAvailable(rtt_channel);
+    return SEGGER_RTT_WriteAvailable(this->channel_);
 }
 
 void rtt_output_stream::flush()
 {
+    if (not this->host_has_read())
+    {
+        return;
+    }
+
+    uint64_t const start = this->ticks();
+    uint64_t polls = 0u;
+
     while (this->write_pending() > 0)
     {
-        /// @todo a timeout should be used here.
+        uint64_t const elapsed = this->tick_source_ ? (this->ticks() - start) : polls++;
+        if (elapsed >= this->timeout_ticks_)
+        {
+            this->timeout_count_ += 1u;
+            break;
+        }
     }
 }
 
+void rtt_output_stream::reset_statistics()
+{
+    this->bytes_written_  = 0u;
+    this->bytes_dropped_  = 0u;
+    this->overflow_count_ = 0u;
+    this->timeout_count_  = 0u;
+    this->watermark_.reset();
+}
@@ -6,19 +6,141 @@
 #pragma once
 
 #include "stream.h"
+#include "segger_rtt.h"
+#include "memory_watermark.h"
 
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class rtt_output_stream
+ * An output stream written to an RTT 'up' channel; target to host.
+ *
+ * Each stream owns one up channel. Typically channel 0, "Terminal", carries
+ * the text log and another channel carries binary sample data.
+ *
+ * When the host does not read the channel fast enough the ring buffer fills;
+ * the overflow_policy determines what is lost:
+ * - drop_newest: Write what fits; the remainder of the write is lost.
+ * - block:       Wait for the host to make room, up to the block timeout;
+ *                then drop the remainder of the write.
+ *                Until a host has read the channel, i.e. no J-Link is
+ *                attached, writes and flush() do not wait: block behaves
+ *                as drop_newest.
+ *
+ * There is no policy which discards the oldest unread data: the read offset
+ * of an up channel is owned by the host, which updates it asynchronously,
+ * and is never written by the target.
+ */
 class rtt_output_stream: public io::output_stream
 {
 public:
+    enum class overflow_policy
+    {
+        drop_newest,
+        block,
+    };
+
+    /// Returns a free running tick count used to time blocking waits.
+    using tick_source = uint64_t (*)(void* context);
+
+    /// Without a tick source the block timeout counts polls of the ring.
+    static constexpr uint64_t const block_polls_default = 1000u * 1000u;
+
     using output_stream::output_stream;
     virtual ~rtt_output_stream() override;
 
     rtt_output_stream() = delete;
-    rtt_output_stream(void* buffer, size_t buffer_size);
+
+    /**
+     * @param buffer      The ring buffer storage; must outlive RTT usage.
+     * @param buffer_size The ring buffer size in bytes.
+     * @param channel     The RTT up channel.
+     * @param policy      The overflow policy.
+     * @param name        The channel name shown by the host; if null the
+     *                    default name for the channel is used.
+     */
+    rtt_output_stream(void*             buffer,
+                      size_t            buffer_size,
+                      rtt_channel_t     channel = 0u,
+                      overflow_policy   policy  = overflow_policy::drop_newest,
+                      char const*       name    = nullptr);
 
     virtual size_t write(void const *buffer, size_t length) override;
     virtual size_t write_pending() const                    override;
     virtual size_t write_avail()   const                    override;
+
+    /**
+     * Wait for the host to read all pending data, up to the block timeout.
+     * A timeout is counted by timeout_count().
+     * Returns immediately if a host has never read the channel.
+     */
     virtual void   flush()                                  override;
-};
 
+    /**
+     * Reserve space in the ring buffer to write in place.
+     * @see SEGGER_RTT_WriteReserve().
+     *
+     * @param [out] length The number of contiguous bytes which may be written.
+     * @return void* The reserved space.
+     */
+    void* reserve(size_t& length);
+
+    /**
+     * Publish bytes written into the space obtained from reserve().
+     * @param length The number of bytes written; no more than reserved.
+     */
+    void commit(size_t length);
+
+    /**
+     * Set the time limit for blocking writes and flush().
+     *
+     * @param timeout_ticks The limit in ticks of source; in polls of the ring
+     *                      buffer if source is null.
+     * @param source        The tick counter; may be null.
+     * @param context       Passed unmodified to source.
+     */
+    void set_block_timeout(uint64_t     timeout_ticks,
+                           tick_source  source  = nullptr,
+                           void*        context = nullptr);
+
+    rtt_channel_t   channel() const { return this->channel_; }
+    overflow_policy policy()  const { return this->policy_; }
+
+    /// The bytes accepted into the ring buffer.
+    uint64_t bytes_written() const { return this->bytes_written_; }
+
+    /// The bytes lost: written data not accepted into the ring buffer.
+    uint64_t bytes_dropped() const { return this->bytes_dropped_; }
+
+    /// The number of writes which lost data.
+    uint32_t overflow_count() const { return this->overflow_count_; }
+
+    /// The number of blocking writes and flushes which timed out.
+    uint32_t timeout_count() const { return this->timeout_count_; }
+
+    void reset_statistics();
+
+    /// The ring buffer fill level after each write.
+    memory_watermark const& watermark() const { return this->watermark_; }
+
+private:
+    size_t write_blocking(uint8_t const *buffer, size_t length);
+
+    uint64_t ticks() const;
+
+    /// Latches true once the host has moved the channel read offset.
+    bool host_has_read();
+
+    rtt_channel_t const     channel_;
+    overflow_policy const   policy_;
+    uint64_t                timeout_ticks_;
+    tick_source             tick_source_;
+    void*                   tick_context_;
+    bool                    host_has_read_;
+    uint64_t                bytes_written_;
+    uint64_t                bytes_dropped_;
+    uint32_t                overflow_count_;
+    uint32_t                timeout_count_;
+    memory_watermark        watermark_;
+};
@@ -0,0 +1,117 @@
+/**
+ * @file nordic_run_loop_hooks.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "nordic_run_loop_hooks.h"
+#include "nordic_critical_section.h"
+#include "nrf_cmsis.h"
+#include "project_assert.h"
+
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_soc.h"
+#endif
+
+namespace nordic
+{
+
+run_loop_hooks::run_loop_hooks(rtc_observable<>& rtc_observable) :
+    ::run_loop_hooks(),
+    rtc_observable_(rtc_observable),
+    wake_observer_(),
+    wake_latency_requests_(0u),
+    constant_latency_(false)
+{
+}
+
+uint32_t run_loop_hooks::ticks_now()
+{
+    return this->rtc_observable_.get_count_extend_32();
+}
+
+uint32_t run_loop_hooks::ticks_until_deadline()
+{
+    // The RTC ISR updates the observer list and the remaining ticks;
+    // a torn read could compute a late deadline and oversleep a timer.
+    nordic::auto_critical_section critical_section;
+    return this->ticks_until_deadline_locked();
+}
+
+uint32_t run_loop_hooks::ticks_until_deadline_locked()
+{
+    uint32_t const ticks = this->rtc_observable_.ticks_until_expiration(
+        this->rtc_observable_.cc_get_count());
+
+    return (ticks == UINT32_MAX) ? run_loop::ticks_forever : ticks;
+}
+
+void run_loop_hooks::sleep(sleep_mode mode, uint32_t ticks_idle)
+{
+    if (mode == sleep_mode::none)
+    {
+        return;
+    }
+
+    {
+        // The wake observer stays attached between sleeps and the RTC ISR
+        // walks it; its expiration is set within the same critical section
+        // as the deadline it is compared against.
+        nordic::auto_critical_section critical_section;
+
+        // Only sleeps which end before the next timer deadline need a wake up.
+        if (ticks_idle < this->ticks_until_deadline_locked())
+        {
+            this->wake_observer_.expiration_set(rtc_observer::expiration_type::one_shot,
+                                                ticks_idle);
+            if (not this->wake_observer_.is_attached())
+            {
+                this->rtc_observable_.attach(this->wake_observer_);
+            }
+        }
+    }
+
+    this->power_mode_set(mode);
+    __WFE();
+}
+
+void run_loop_hooks::wake_latency_request()
+{
+    ++this->wake_latency_requests_;
+}
+
+void run_loop_hooks::wake_latency_release()
+{
+    ASSERT(this->wake_latency_requests_ > 0u);
+    --this->wake_latency_requests_;
+}
+
+void run_loop_hooks::power_mode_set(sleep_mode mode)
+{
+    // Constant latency keeps the HFCLK and regulators running through the
+    // sleep; it is only worth its current when a client needs the wake
+    // latency bounded.
+    bool const constant_latency = (mode == sleep_mode::wait_for_event) &&
+                                  (this->wake_latency_requests_ > 0u);
+    if (constant_latency == this->constant_latency_)
+    {
+        return;
+    }
+
+    this->constant_latency_ = constant_latency;
+
+#ifdef SOFTDEVICE_PRESENT
+    // The POWER peripheral is restricted while the softdevice is enabled.
+    sd_power_mode_set(constant_latency ? NRF_POWER_MODE_CONSTLAT : NRF_POWER_MODE_LOWPWR);
+#else
+    if (constant_latency)
+    {
+        NRF_POWER->TASKS_CONSTLAT = 1u;
+    }
+    else
+    {
+        NRF_POWER->TASKS_LOWPWR = 1u;
+    }
+#endif
+}
+
+} // namespace nordic
@@ -0,0 +1,71 @@
+/**
+ * @file nordic_run_loop_hooks.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The run loop time source and sleep policy for the nRF52: RTC ticks, the
+ * RTC observable's next expiration and WFE sleep. Sleeps use the low power
+ * sub-power mode; the constant latency sub-power mode is used for
+ * sleep_mode::wait_for_event only while a client requests it.
+ */
+
+#pragma once
+
+#include "run_loop.h"
+#include "rtc_observer.h"
+
+namespace nordic
+{
+
+class run_loop_hooks: public ::run_loop_hooks
+{
+public:
+    virtual ~run_loop_hooks() override = default;
+
+    run_loop_hooks()                                    = delete;
+    run_loop_hooks(run_loop_hooks const&)               = delete;
+    run_loop_hooks(run_loop_hooks &&)                   = delete;
+    run_loop_hooks& operator=(run_loop_hooks const&)    = delete;
+    run_loop_hooks& operator=(run_loop_hooks&&)         = delete;
+
+    /**
+     * @param rtc_observable The RTC which schedules the timer deadlines.
+     * It must be started; a wake observer is attached to it to end sleeps
+     * which are shorter than the next timer deadline.
+     */
+    explicit run_loop_hooks(rtc_observable<>& rtc_observable);
+
+    virtual uint32_t ticks_now() override;
+    virtual uint32_t ticks_until_deadline() override;
+    virtual void     sleep(sleep_mode mode, uint32_t ticks_idle) override;
+
+    /**
+     * Request a bounded wake up latency, such as for a peripheral which
+     * must be serviced soon after its interrupt. While any request is held
+     * sleep_mode::wait_for_event sleeps in the constant latency sub-power
+     * mode, at the cost of a higher sleep current.
+     * Each request must be matched by a call to wake_latency_release().
+     * @note Call from thread context only.
+     */
+    void wake_latency_request();
+    void wake_latency_release();
+
+private:
+    /// Wakes the CPU by its RTC interrupt; there is nothing to do.
+    class wake_observer: public rtc_observer
+    {
+    public:
+        virtual void expiration_notify() override {}
+    };
+
+    /// ticks_until_deadline() with interrupts already disabled.
+    uint32_t ticks_until_deadline_locked();
+
+    void power_mode_set(sleep_mode mode);
+
+    rtc_observable<>&   rtc_observable_;
+    wake_observer       wake_observer_;
+    uint32_t            wake_latency_requests_;
+    bool                constant_latency_;
+};
+
+} // namespace nordic
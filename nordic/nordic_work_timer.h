@@ -0,0 +1,44 @@
+/**
+ * @file nordic_work_timer.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Periodic run loop work driven by an RTC observer.
+ */
+
+#pragma once
+
+#include "run_loop.h"
+#include "rtc_observer.h"
+
+namespace nordic
+{
+
+/**
+ * @class work_timer
+ * Post a work item each time the timer expires. The work runs from the
+ * run loop, at the work item priority, rather than in the RTC ISR.
+ */
+class work_timer: public rtc_observer
+{
+public:
+    virtual ~work_timer() override                  = default;
+
+    work_timer()                                    = delete;
+    work_timer(work_timer const&)                   = delete;
+    work_timer(work_timer &&)                       = delete;
+    work_timer& operator=(work_timer const&)        = delete;
+    work_timer& operator=(work_timer&&)             = delete;
+
+    work_timer(work_item& work, uint32_t ticks_interval) :
+        rtc_observer(expiration_type::continuous, ticks_interval),
+        work_(work)
+    {
+    }
+
+    virtual void expiration_notify() override { this->work_.post(); }
+
+private:
+    work_item& work_;
+};
+
+} // namespace nordic
@@ -7,7 +7,9 @@
 #include "logger.h"
 #include "nrf_cmsis.h"
 #include "arm_utilities.h"
+#include "isr_profile.h"
 #include "project_assert.h"
+#include "bit_manip.h"
 
 #include <iterator>
 #include <cstddef>
@@ -30,6 +32,10 @@ static size_t const task_set_count = std::size(reinterpret_cast<NRF_GPIOTE_Type
 // Set the channel count here and check it at run time against the others.
 static constexpr gpio_te_channel_t const gpio_te_channel_count = 8u;
 
+/// A bit per GPIO TE channel.
+using gpio_te_channel_mask_t = uint8_t;
+static_assert(gpio_te_channel_count <= sizeof(gpio_te_channel_mask_t) * CHAR_BIT);
+
 // The maximum number of NRF GPIO pins that can be accessed within a GPIO port.
 static constexpr gpio_pin_t const gpio_pin_limit = 32u;
 
@@ -51,6 +57,12 @@ struct gpio_te_control_block_t
     /// Is the GPIO TE module initialized? true if so, false if not.
     bool initialized;
 
+    /**
+     * A bit is set for each allocated channel. Allocation takes the lowest
+     * clear bit instead of reading the registers of each channel in turn.
+     */
+    gpio_te_channel_mask_t channels_allocated;
+
     /**
      * @{
      * Each GPIO TE channel is allocated a event callback handler and a context
@@ -77,6 +89,7 @@ static struct gpio_te_control_block_t gpio_te_instance_0 =
     .irq_type               = GPIOTE_IRQn,
     .channel_count          = gpio_te_channel_count,
     .initialized            = false,
+    .channels_allocated     = 0u,
 
     .pin_event_handlers     = {nullptr},
     .pin_event_contexts     = {nullptr},
@@ -89,6 +102,7 @@ static void irq_handler_gpio_te(struct gpio_te_control_block_t* gpio_te_control)
 
 extern "C" void GPIOTE_IRQHandler(void)
 {
+    ISR_PROFILE(GPIOTE_IRQn);
     irq_handler_gpio_te(&gpio_te_instance_0);
 }
 
@@ -99,6 +113,26 @@ static void gpio_te_clear_event_register(uint32_t volatile* gpio_te_register)
     (void) dummy;
 }
 
+/**
+ * Mark the lowest numbered free channel as allocated.
+ * @return gpio_te_channel_t The channel or gpio_te_channel_invalid if none are free.
+ */
+static gpio_te_channel_t gpio_te_channel_take(void)
+{
+    gpio_te_channel_mask_t const channels_all =
+        bit_manip::bit_mask<gpio_te_channel_mask_t>(gpio_te_instance_0.channel_count, 0u);
+    gpio_te_channel_mask_t const channels_free =
+        channels_all & ~gpio_te_instance_0.channels_allocated;
+
+    if (channels_free == 0u)
+    {
+        return gpio_te_channel_invalid;
+    }
+
+    gpio_te_instance_0.channels_allocated |= bit_manip::lowest_bit(channels_free);
+    return static_cast<gpio_te_channel_t>(bit_manip::count_trailing_zeros(channels_free));
+}
+
 void gpio_te_init(uint8_t irq_priority)
 {
     // If the module GPIO TE channel count value does not match the
@@ -128,6 +162,7 @@ void gpio_te_init(uint8_t irq_priority)
         gpio_te_channel_disable(channel);
         gpio_te_instance_0.gpio_te_registers->CONFIG[channel] = 0u;
     }
+    gpio_te_instance_0.channels_allocated = 0u;
 
     NVIC_SetPriority(gpio_te_instance_0.irq_type, irq_priority);
     NVIC_ClearPendingIRQ(gpio_te_instance_0.irq_type);
@@ -172,8 +207,7 @@ bool gpio_te_channel_is_allocated(gpio_te_channel_t channel)
 {
     ASSERT(channel < gpio_te_instance_0.channel_count);
 
-    return gpio_te_channel_is_allocated_as_task(channel) ||
-           gpio_te_channel_is_allocated_as_event(channel);
+    return bool(gpio_te_instance_0.channels_allocated & (1u << channel));
 }
 
 bool gpio_te_channel_is_free(gpio_te_channel_t channel)
@@ -212,28 +246,26 @@ gpio_te_channel_t gpio_te_allocate_channel_task(
     ASSERT(polarity       < gpio_te_polarity_limit);
     ASSERT(initial_output < gpio_te_output_init_limit);
 
-    for (gpio_te_channel_t channel = 0u; channel < gpio_te_instance_0.channel_count; ++channel)
+    gpio_te_channel_t const channel = gpio_te_channel_take();
+    if (channel == gpio_te_channel_invalid)
     {
-        if (gpio_te_channel_is_free(channel))
-        {
-            *gpio_te_channel_get_task_out(channel) = 0u;    // Clear all tasks
-            *gpio_te_channel_get_task_clr(channel) = 0u;
-            *gpio_te_channel_get_task_set(channel) = 0u;
-
-            uint32_t const config =
-                (GPIOTE_CONFIG_MODE_Task               << GPIOTE_CONFIG_MODE_Pos)     |
-                (static_cast<uint32_t>(pin_no)         << GPIOTE_CONFIG_PSEL_Pos)     |
-                (static_cast<uint32_t>(polarity)       << GPIOTE_CONFIG_POLARITY_Pos) |
-                (static_cast<uint32_t>(initial_output) << GPIOTE_CONFIG_OUTINIT_Pos)  |
-                0u;
-
-            gpio_te_instance_0.gpio_te_registers->CONFIG[channel] = config;
-            return channel;
-        }
+        // Failed to allocate a GPIO TE channel.
+        return gpio_te_channel_invalid;
     }
 
-    // Failed to allocate a GPIO TE channel.
-    return gpio_te_channel_invalid;
+    *gpio_te_channel_get_task_out(channel) = 0u;    // Clear all tasks
+    *gpio_te_channel_get_task_clr(channel) = 0u;
+    *gpio_te_channel_get_task_set(channel) = 0u;
+
+    uint32_t const config =
+        (GPIOTE_CONFIG_MODE_Task               << GPIOTE_CONFIG_MODE_Pos)     |
+        (static_cast<uint32_t>(pin_no)         << GPIOTE_CONFIG_PSEL_Pos)     |
+        (static_cast<uint32_t>(polarity)       << GPIOTE_CONFIG_POLARITY_Pos) |
+        (static_cast<uint32_t>(initial_output) << GPIOTE_CONFIG_OUTINIT_Pos)  |
+        0u;
+
+    gpio_te_instance_0.gpio_te_registers->CONFIG[channel] = config;
+    return channel;
 }
 
 gpio_te_channel_t gpio_te_allocate_channel_event(
@@ -252,28 +284,26 @@ gpio_te_channel_t gpio_te_allocate_channel_event(
     // An interrupt context only makese sense if there is a handler.
     if (pin_context) { ASSERT(pin_event_handler); }
 
-    for (gpio_te_channel_t channel = 0u; channel < gpio_te_instance_0.channel_count; ++channel)
+    gpio_te_channel_t const channel = gpio_te_channel_take();
+    if (channel == gpio_te_channel_invalid)
     {
-        if (gpio_te_channel_is_free(channel))
-        {
-            uint32_t const config =
-                (GPIOTE_CONFIG_MODE_Event           << GPIOTE_CONFIG_MODE_Pos)     |
-                (static_cast<uint32_t>(pin_no)      << GPIOTE_CONFIG_PSEL_Pos)     |
-                (static_cast<uint32_t>(polarity)    << GPIOTE_CONFIG_POLARITY_Pos) |
-                0u;
+        // Failed to allocate a GPIO TE channel.
+        return gpio_te_channel_invalid;
+    }
 
-            gpio_te_instance_0.pin_event_handlers[channel] = pin_event_handler;
-            gpio_te_instance_0.pin_event_contexts[channel] = pin_context;
+    uint32_t const config =
+        (GPIOTE_CONFIG_MODE_Event           << GPIOTE_CONFIG_MODE_Pos)     |
+        (static_cast<uint32_t>(pin_no)      << GPIOTE_CONFIG_PSEL_Pos)     |
+        (static_cast<uint32_t>(polarity)    << GPIOTE_CONFIG_POLARITY_Pos) |
+        0u;
 
-            gpio_te_instance_0.gpio_te_registers->CONFIG[channel] = config;
-            gpio_te_channel_bind_event(channel, event_register_pointer);
+    gpio_te_instance_0.pin_event_handlers[channel] = pin_event_handler;
+    gpio_te_instance_0.pin_event_contexts[channel] = pin_context;
 
-            return channel;
-        }
-    }
+    gpio_te_instance_0.gpio_te_registers->CONFIG[channel] = config;
+    gpio_te_channel_bind_event(channel, event_register_pointer);
 
-    // Failed to allocate a GPIO TE channel.
-    return gpio_te_channel_invalid;
+    return channel;
 }
 
 void gpio_te_channel_release(gpio_te_channel_t channel)
@@ -290,6 +320,8 @@ void gpio_te_channel_release(gpio_te_channel_t channel)
 
     gpio_te_instance_0.pin_event_handlers[channel] = nullptr;
     gpio_te_instance_0.pin_event_contexts[channel] = nullptr;
+
+    gpio_te_instance_0.channels_allocated &= ~(1u << channel);
 }
 
 gpio_pin_t gpio_te_channel_get_pin(gpio_te_channel_t channel)
@@ -351,7 +383,7 @@ void gpio_te_channel_disable(gpio_te_channel_t channel)
 
     // Disable the event interrupt. Do it even if its allocated a task.
     gpio_te_instance_0.gpio_te_registers->INTENCLR =
-        (GPIOTE_INTENSET_IN0_Pos << channel);
+        (GPIOTE_INTENSET_IN0_Msk << channel);
 
     // Clear events which may have been queued.
     gpio_te_clear_event_register(&gpio_te_instance_0.gpio_te_registers->EVENTS_IN[channel]);
@@ -421,31 +453,30 @@ static void irq_handler_gpio_te(struct gpio_te_control_block_t* gpio_te_control)
                                             gpio_te_control->port_event_context);
     }
 
-    for (gpio_te_channel_t channel = 0u; channel < gpio_te_instance_0.channel_count; ++channel)
+    // Only channels with their interrupt enabled have a handler to call;
+    // visit those rather than reading the EVENTS_IN register of each channel.
+    gpio_te_channel_mask_t const channels_enabled = static_cast<gpio_te_channel_mask_t>(
+        (gpio_te_control->gpio_te_registers->INTENSET >> GPIOTE_INTENSET_IN0_Pos) &
+        bit_manip::bit_mask<uint32_t>(gpio_te_control->channel_count, 0u));
+
+    bit_manip::for_each_set_bit(channels_enabled, [gpio_te_control, &logger](bit_manip::bit_pos_t bit_pos)
     {
+        gpio_te_channel_t const channel = static_cast<gpio_te_channel_t>(bit_pos);
         if (gpio_te_control->gpio_te_registers->EVENTS_IN[channel])
         {
-            if (channel < gpio_te_control->channel_count)
-            {
-                gpio_te_clear_event_register(
-                    &gpio_te_control->gpio_te_registers->EVENTS_IN[channel]);
+            gpio_te_clear_event_register(
+                &gpio_te_control->gpio_te_registers->EVENTS_IN[channel]);
 
-                logger.debug("GPIO TE event: channel[%u]", channel);
+            logger.debug("GPIO TE event: channel[%u]", channel);
 
-                if (gpio_te_control->pin_event_handlers[channel])
-                {
-                    gpio_te_control->pin_event_handlers[channel](
-                        channel,
-                        gpio_te_control->pin_event_contexts[channel]);
-                }
-            }
-            else
+            if (gpio_te_control->pin_event_handlers[channel])
             {
-                logger.error("irq_handler_gpio_te: invalid channel: %u / %u",
-                             channel < gpio_te_control->channel_count);
+                gpio_te_control->pin_event_handlers[channel](
+                    channel,
+                    gpio_te_control->pin_event_contexts[channel]);
             }
         }
-    }
+    });
 }
 
 
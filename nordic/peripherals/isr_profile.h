@@ -0,0 +1,379 @@
+/**
+ * @file isr_profile.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Interrupt latency and ISR duration histograms per IRQ number.
+ *
+ * @example
+ *     extern "C" void SAADC_IRQHandler(void)
+ *     {
+ *         ISR_PROFILE(SAADC_IRQn);
+ *         ...
+ *     }
+ *
+ * The ISR duration is the time spent in the handler excluding the time
+ * spent in the handlers which preempted it. The latency is the time from
+ * the peripheral event to the handler entry; since the NVIC does not
+ * record when an interrupt is pended it is only available when the
+ * handler can find the event time, for example RTC COUNTER - CC[n].
+ * The handler passes it with ISR_PROFILE_LATENCY().
+ *
+ * Times are in profile::cycle_count() units: CPU cycles on the target,
+ * once profile::cycle_counter_enable() is called.
+ *
+ * ISR_PROFILE() and ISR_PROFILE_LATENCY() compile to nothing, and their
+ * arguments are not evaluated, unless ISR_PROFILE_ENABLED is defined.
+ */
+
+#pragma once
+
+#include "profile.h"
+#include "log2_histogram.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// The statistics kept for each profiled IRQ.
+struct isr_profile_stats_t
+{
+    using histogram_type = log2_histogram<16u>;
+
+    uint8_t             irq;
+    uint8_t             depth_max;          ///< The deepest nesting at entry; 1 is not nested.
+    uint32_t            count;
+    uint32_t            latency_count;
+    profile::cycles_t   duration_max;
+    profile::cycles_t   latency_max;
+    histogram_type      duration;
+    histogram_type      latency;
+};
+
+/**
+ * @class isr_profile_table
+ *
+ * @tparam irq_count  The number of IRQ numbers; the nRF52840 has 48.
+ * @tparam slot_count The number of IRQs which may be profiled. Statistics
+ *                    slots are assigned to IRQs on first entry.
+ * @tparam depth_limit The deepest nesting tracked; the nRF52 NVIC has
+ *                     8 priority levels.
+ *
+ * Each IRQ slot is only written by its own handler. The nesting depth is
+ * written by all handlers; a handler which preempts another restores the
+ * depth before returning, so no critical section is required.
+ */
+template <std::size_t irq_count, std::size_t slot_count, std::size_t depth_limit = 8u>
+class isr_profile_table
+{
+public:
+    static constexpr uint8_t const slot_none = UINT8_MAX;
+
+    static_assert(irq_count   <  UINT8_MAX, "isr_profile_table irq_count too large");
+    static_assert(slot_count  <  UINT8_MAX, "isr_profile_table slot_count too large");
+
+    ~isr_profile_table()                                    = default;
+
+    isr_profile_table(isr_profile_table const&)             = delete;
+    isr_profile_table(isr_profile_table &&)                 = delete;
+    isr_profile_table& operator=(isr_profile_table const&)  = delete;
+    isr_profile_table& operator=(isr_profile_table&&)       = delete;
+
+    /// constexpr: a function local static instance is constant initialized.
+    constexpr isr_profile_table()
+        : slot_index_{}, slot_alloc_(0u), overflow_count_(0u), depth_(0u), depth_max_(0u),
+          nested_{}, stats_{}
+    {
+        for (uint8_t& slot : this->slot_index_) { slot = slot_none; }
+    }
+
+    /**
+     * Called on ISR entry.
+     * @return cycles_t The entry time, passed to exit().
+     */
+    profile::cycles_t enter(uint8_t irq, profile::cycles_t now)
+    {
+        std::size_t const depth = this->depth_ + 1u;
+        this->depth_ = depth;
+        if (depth <= depth_limit) { this->nested_[depth] = 0u; }
+        if (depth > this->depth_max_) { this->depth_max_ = depth; }
+
+        isr_profile_stats_t* const stats = this->slot(irq);
+        if (stats && (depth > stats->depth_max))
+        {
+            stats->depth_max = static_cast<uint8_t>(depth);
+        }
+        return now;
+    }
+
+    /// Called on ISR exit with the time returned by enter().
+    void exit(uint8_t irq, profile::cycles_t start, profile::cycles_t now)
+    {
+        std::size_t const depth = this->depth_;
+        profile::cycles_t const inclusive = now - start;
+        profile::cycles_t const nested    = (depth <= depth_limit) ? this->nested_[depth] : 0u;
+        profile::cycles_t const duration  = inclusive - nested;
+
+        this->depth_ = depth - 1u;
+        if (depth - 1u <= depth_limit) { this->nested_[depth - 1u] += inclusive; }
+
+        isr_profile_stats_t* const stats = this->slot(irq);
+        if (stats)
+        {
+            stats->count += 1u;
+            stats->duration.record(duration);
+            if (duration > stats->duration_max) { stats->duration_max = duration; }
+        }
+    }
+
+    /// Record the time from the peripheral event to the ISR entry.
+    void latency(uint8_t irq, profile::cycles_t latency)
+    {
+        isr_profile_stats_t* const stats = this->slot(irq);
+        if (stats)
+        {
+            stats->latency_count += 1u;
+            stats->latency.record(latency);
+            if (latency > stats->latency_max) { stats->latency_max = latency; }
+        }
+    }
+
+    /// @return isr_profile_stats_t const* The IRQ statistics; null if not yet entered.
+    isr_profile_stats_t const* stats(uint8_t irq) const
+    {
+        if (irq >= irq_count) { return nullptr; }
+        uint8_t const slot_index = this->slot_index_[irq];
+        return (slot_index == slot_none) ? nullptr : &this->stats_[slot_index];
+    }
+
+    /// @return std::size_t The deepest nesting seen.
+    std::size_t depth_max() const { return this->depth_max_; }
+
+    /// @return uint32_t The number of ISR entries not recorded: no slot was free.
+    uint32_t overflow_count() const { return this->overflow_count_; }
+
+    /**
+     * Find the IRQs with the longest ISR duration.
+     *
+     * @param irqs  The IRQ numbers, longest max duration first.
+     * @param count The length of irqs.
+     * @return std::size_t The number of IRQs written to irqs.
+     */
+    std::size_t worst(uint8_t* irqs, std::size_t count) const
+    {
+        std::size_t const slots = this->slots_allocated();
+        std::size_t written = 0u;
+
+        // An insertion sort of the slots, keeping the longest count.
+        for (isr_profile_stats_t const* stats = this->stats_; stats < this->stats_ + slots; ++stats)
+        {
+            std::size_t insert = written;
+            while ((insert > 0u) &&
+                   (this->stats(irqs[insert - 1u])->duration_max < stats->duration_max))
+            {
+                insert -= 1u;
+            }
+
+            if (insert >= count) { continue; }
+
+            std::size_t const last = (written < count) ? written : count - 1u;
+            for (std::size_t index = last; index > insert; --index)
+            {
+                irqs[index] = irqs[index - 1u];
+            }
+            irqs[insert] = stats->irq;
+            if (written < count) { written += 1u; }
+        }
+
+        return written;
+    }
+
+    /// Reset the statistics; the IRQ slots remain assigned.
+    void reset()
+    {
+        std::size_t const slots = this->slots_allocated();
+        for (isr_profile_stats_t* stats = this->stats_; stats < this->stats_ + slots; ++stats)
+        {
+            uint8_t const irq = stats->irq;
+            *stats = isr_profile_stats_t{};
+            stats->irq = irq;
+        }
+        this->overflow_count_ = 0u;
+        this->depth_max_      = 0u;
+    }
+
+    /// Write the statistics of each profiled IRQ, worst first, at level::info.
+    void dump(logger& logger) const
+    {
+        logger.info("isr profile: depth max: %u, overflow: %u, %s",
+                    static_cast<unsigned int>(this->depth_max_), this->overflow_count_,
+                    profile::counter_units);
+
+        uint8_t irqs[slot_count];
+        std::size_t const count = this->worst(irqs, slot_count);
+        for (uint8_t const* irq = irqs; irq < irqs + count; ++irq)
+        {
+            isr_profile_stats_t const* const stats = this->stats(*irq);
+            logger.info("irq %2u: count: %8u, duration max: %8u, latency max: %8u (%u), depth: %u",
+                        stats->irq, stats->count, stats->duration_max,
+                        stats->latency_max, stats->latency_count, stats->depth_max);
+
+            write_histogram(logger, "duration", stats->duration);
+            write_histogram(logger, "latency",  stats->latency);
+        }
+    }
+
+    /**
+     * Handle runtime queries read from an input stream, typically an RTT
+     * down channel polled from the main loop. Each command is one character:
+     * - 'd': dump()
+     * - 'w': the IRQ numbers of the longest ISRs
+     * - 'r': reset()
+     */
+    void query(io::input_stream& is, logger& logger)
+    {
+        char command = 0;
+        while (is.read(&command, sizeof(command)) == sizeof(command))
+        {
+            switch (command)
+            {
+            case 'd':
+                this->dump(logger);
+                break;
+            case 'w':
+                {
+                    uint8_t irqs[slot_count];
+                    std::size_t const count = this->worst(irqs, slot_count);
+                    for (std::size_t index = 0u; index < count; ++index)
+                    {
+                        logger.info("isr worst %u: irq %2u: %8u",
+                                    static_cast<unsigned int>(index), irqs[index],
+                                    this->stats(irqs[index])->duration_max);
+                    }
+                }
+                break;
+            case 'r':
+                this->reset();
+                logger.info("isr profile: reset");
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+private:
+    /// @return isr_profile_stats_t* The IRQ statistics; allocated on first use.
+    isr_profile_stats_t* slot(uint8_t irq)
+    {
+        if (irq >= irq_count) { return nullptr; }
+
+        uint8_t slot_index = this->slot_index_[irq];
+        if (slot_index == slot_none)
+        {
+            slot_index = static_cast<uint8_t>(this->slot_alloc_.fetch_add(1u));
+            if (slot_index >= slot_count)
+            {
+                this->slot_alloc_.store(slot_count);
+                this->overflow_count_ += 1u;
+                return nullptr;
+            }
+            this->stats_[slot_index].irq = irq;
+            this->slot_index_[irq] = slot_index;
+        }
+        return &this->stats_[slot_index];
+    }
+
+    std::size_t slots_allocated() const
+    {
+        std::size_t const slots = this->slot_alloc_.load();
+        return (slots < slot_count) ? slots : slot_count;
+    }
+
+    static void write_histogram(logger&                                     logger,
+                                char const*                                 name,
+                                isr_profile_stats_t::histogram_type const&  histogram)
+    {
+        using histogram_type = isr_profile_stats_t::histogram_type;
+        for (std::size_t bin = 0u; bin < histogram_type::bin_count; ++bin)
+        {
+            if (histogram[bin] != 0u)
+            {
+                logger.info("    %-8s >= %8u: %8u", name, histogram_type::bin_lower(bin),
+                            histogram[bin]);
+            }
+        }
+    }
+
+    uint8_t                     slot_index_[irq_count];
+    std::atomic<std::size_t>    slot_alloc_;
+    uint32_t                    overflow_count_;
+    std::size_t                 depth_;
+    std::size_t                 depth_max_;
+
+    /// The inclusive time of the handlers which preempted each depth.
+    profile::cycles_t           nested_[depth_limit + 1u];
+    isr_profile_stats_t         stats_[slot_count];
+};
+
+/// The nRF52840 has the most IRQ numbers: [0:47].
+static constexpr std::size_t const isr_profile_irq_count  = 48u;
+static constexpr std::size_t const isr_profile_slot_count = 12u;
+
+using isr_profile_table_t = isr_profile_table<isr_profile_irq_count, isr_profile_slot_count>;
+
+/// @return isr_profile_table_t& The table recorded into by ISR_PROFILE().
+inline isr_profile_table_t& isr_profile_instance()
+{
+    static isr_profile_table_t isr_profile_table_instance;
+    return isr_profile_table_instance;
+}
+
+/**
+ * @class isr_profile_scope
+ * Record the ISR entry on construction and the exit on destruction.
+ */
+template <typename table_type>
+class isr_profile_scope
+{
+public:
+    isr_profile_scope()                                     = delete;
+    isr_profile_scope(isr_profile_scope const&)             = delete;
+    isr_profile_scope(isr_profile_scope &&)                 = delete;
+    isr_profile_scope& operator=(isr_profile_scope const&)  = delete;
+    isr_profile_scope& operator=(isr_profile_scope&&)       = delete;
+
+    isr_profile_scope(table_type& table, int irq)
+        : table_(table),
+          irq_(static_cast<uint8_t>(irq)),
+          start_(table.enter(this->irq_, profile::cycle_count()))
+    {
+    }
+
+    ~isr_profile_scope()
+    {
+        this->table_.exit(this->irq_, this->start_, profile::cycle_count());
+    }
+
+    void latency(profile::cycles_t cycles) { this->table_.latency(this->irq_, cycles); }
+
+private:
+    table_type&             table_;
+    uint8_t const           irq_;
+    profile::cycles_t const start_;
+};
+
+#if defined ISR_PROFILE_ENABLED
+
+#define ISR_PROFILE(irq)                                                        \
+    isr_profile_scope<isr_profile_table_t> isr_profile_scope_(isr_profile_instance(), (irq))
+
+#define ISR_PROFILE_LATENCY(cycles) isr_profile_scope_.latency(cycles)
+
+#else
+
+#define ISR_PROFILE(irq)            do {} while (0)
+#define ISR_PROFILE_LATENCY(cycles) do {} while (0)
+
+#endif
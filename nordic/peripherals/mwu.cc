@@ -5,6 +5,18 @@
 
 #include "mwu.h"
 #include "nrf_cmsis.h"
+#include "project_assert.h"
+
+#include <iterator>
+
+static mwu_event_handler_t  mwu_handler = nullptr;
+static void*                mwu_context = nullptr;
+
+/// The REGIONnWA bit in INTEN and REGIONEN; REGIONnRA is the next bit up.
+static uint32_t mwu_region_write_mask(uint8_t region)
+{
+    return (1u << (region * 2u));
+}
 
 void mwu_enable(void)
 {
@@ -19,3 +31,50 @@ void mwu_disable(void)
         ((MWU_REGIONENCLR_RGN0WA_Clear  << MWU_REGIONENCLR_RGN0WA_Pos) |
          (MWU_REGIONENCLR_PRGN0WA_Clear << MWU_REGIONENCLR_PRGN0WA_Pos));
 }
+
+void mwu_write_watch_enable(uint8_t             region,
+                            uintptr_t           start,
+                            uintptr_t           end,
+                            uint8_t             irq_priority,
+                            mwu_event_handler_t handler,
+                            void*               context)
+{
+    ASSERT(region < std::size(NRF_MWU->REGION));
+    ASSERT(start <= end);
+
+    mwu_handler = handler;
+    mwu_context = context;
+
+    NRF_MWU->REGION[region].START     = start;
+    NRF_MWU->REGION[region].END       = end;
+    NRF_MWU->EVENTS_REGION[region].WA = 0u;
+    NRF_MWU->INTENSET                 = mwu_region_write_mask(region);
+    NRF_MWU->REGIONENSET              = mwu_region_write_mask(region);
+
+    NVIC_SetPriority(MWU_IRQn, irq_priority);
+    NVIC_ClearPendingIRQ(MWU_IRQn);
+    NVIC_EnableIRQ(MWU_IRQn);
+}
+
+void mwu_write_watch_disable(uint8_t region)
+{
+    ASSERT(region < std::size(NRF_MWU->REGION));
+
+    NRF_MWU->REGIONENCLR = mwu_region_write_mask(region);
+    NRF_MWU->INTENCLR    = mwu_region_write_mask(region);
+}
+
+extern "C" void MWU_IRQHandler(void)
+{
+    for (uint8_t region = 0u; region < std::size(NRF_MWU->EVENTS_REGION); ++region)
+    {
+        if (NRF_MWU->EVENTS_REGION[region].WA)
+        {
+            NRF_MWU->EVENTS_REGION[region].WA = 0u;
+            if (mwu_handler)
+            {
+                mwu_handler(region, mwu_context);
+            }
+        }
+    }
+}
@@ -3,16 +3,47 @@
  * Enable/Disable the nRF5x Memory watch unit.
  */
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * The MWU write watch event handler, called from the MWU ISR.
+ * @param region  The REGION[] index which was written.
+ * @param context The user supplied context passed to mwu_write_watch_enable().
+ */
+typedef void (*mwu_event_handler_t)(uint8_t region, void* context);
+
 void mwu_enable(void);
 
 void mwu_disable(void);
 
 void mwu_debug(void);
 
+/**
+ * Watch a RAM region for CPU writes. The MWU detects the write after it
+ * has completed: the write is not blocked.
+ *
+ * @param region       The REGION[] index [0:3]. When the SoftDevice is
+ *                     enabled it may reserve the MWU; see the SoftDevice
+ *                     specification for the regions available.
+ * @param start        The first address watched.
+ * @param end          The last address watched; inclusive.
+ * @param irq_priority The MWU interrupt priority.
+ * @param handler      Called from the MWU ISR on each watched write.
+ * @param context      Passed unmodified to the handler.
+ */
+void mwu_write_watch_enable(uint8_t             region,
+                            uintptr_t           start,
+                            uintptr_t           end,
+                            uint8_t             irq_priority,
+                            mwu_event_handler_t handler,
+                            void*               context);
+
+void mwu_write_watch_disable(uint8_t region);
+
 #ifdef __cplusplus
 }
 #endif
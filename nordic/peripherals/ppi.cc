@@ -4,6 +4,7 @@
  */
 
 #include "ppi.h"
+#include "ppi_graph.h"
 #include "logger.h"
 #include "nrf_cmsis.h"
 #include "arm_utilities.h"
@@ -100,3 +101,52 @@ void ppi_channel_disable(ppi_channel_t ppi_channel)
     ppi_registers->CHENCLR = (1u << ppi_channel);
 }
 
+
+ppi_group_t ppi_channel_find_free_group(void)
+{
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> const builder(*ppi_registers);
+    return builder.free_group();
+}
+
+enum ppi_graph_result_t ppi_graph_create(struct ppi_graph_t*        graph,
+                                         struct ppi_edge_t const*   edges,
+                                         size_t                     edge_count)
+{
+    ASSERT(graph);
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> builder(*ppi_registers);
+    return builder.create(*graph, edges, edge_count);
+}
+
+void ppi_graph_release(struct ppi_graph_t* graph)
+{
+    ASSERT(graph);
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> builder(*ppi_registers);
+    builder.release(*graph);
+}
+
+void ppi_graph_enable(struct ppi_graph_t const* graph)
+{
+    ASSERT(graph);
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> builder(*ppi_registers);
+    builder.enable(*graph);
+}
+
+void ppi_graph_disable(struct ppi_graph_t const* graph)
+{
+    ASSERT(graph);
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> builder(*ppi_registers);
+    builder.disable(*graph);
+}
+
+void ppi_graph_dump(struct ppi_graph_t const* graph)
+{
+    ASSERT(graph);
+    NRF_PPI_Type* const ppi_registers = reinterpret_cast<NRF_PPI_Type *>(NRF_PPI_BASE);
+    ppi_graph_builder<NRF_PPI_Type> const builder(*ppi_registers);
+    builder.dump(*graph, logger::instance());
+}
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -15,6 +16,7 @@ typedef uint8_t ppi_channel_t;
 typedef uint8_t ppi_group_t;
 
 enum { ppi_channel_invalid = (ppi_channel_t)(-1) };
+enum { ppi_group_invalid   = (ppi_group_t)(-1)   };
 
 /**
  * Get the first free PPI channel available. The search starts from zero and
@@ -49,14 +51,87 @@ void ppi_channel_enable(ppi_channel_t ppi_channel);
 void ppi_channel_disable(ppi_channel_t ppi_channel);
 
 /**
- * Find a free PPI channel group.
- * Not yet implemented.
+ * Find a free PPI channel group. A group is free when no channels are
+ * included in it; CHG[group] is zero.
  *
  * @return ppi_group_t The index into the PPI grouplist for the first unused
  * group found, starting with index zero.
+ * @retval ppi_group_invalid if no PPI channel groups are available.
  */
 ppi_group_t ppi_channel_find_free_group(void);
 
+/**
+ * @struct ppi_edge_t
+ * An edge in a PPI event graph: when the event register is signalled the
+ * task register, and the optional fork task register, are triggered.
+ */
+struct ppi_edge_t
+{
+    uint32_t volatile*  event;
+    uint32_t volatile*  task;
+    uint32_t volatile*  fork;   ///< An optional second task; may be null.
+};
+
+/**
+ * @struct ppi_graph_t
+ * The PPI channels and the channel group allocated for a set of edges.
+ * The group enables and disables the channels together.
+ */
+struct ppi_graph_t
+{
+    uint32_t    channel_mask;
+    ppi_group_t group;
+};
+
+enum ppi_graph_result_t
+{
+    ppi_graph_success = 0,
+
+    /// An edge event or task register is null.
+    ppi_graph_invalid_edge,
+
+    /// An edge event and task pair is already connected by a PPI channel;
+    /// either within the graph or by a channel allocated elsewhere.
+    ppi_graph_conflict,
+
+    /// Not enough free PPI channels for the edges.
+    ppi_graph_no_channel,
+
+    /// No free PPI channel group.
+    ppi_graph_no_group,
+};
+
+/**
+ * Allocate and bind the PPI channels and a channel group for a set of edges.
+ * Edges with the same event and no fork task share a channel, using the
+ * channel FORK task for the second. The channels are left disabled.
+ * On failure no PPI resources are allocated.
+ *
+ * @note Not reentrant: the PPI resources are allocated without a critical
+ *       section. Create and release graphs from thread context.
+ *
+ * @param graph      The graph to initialize.
+ * @param edges      The list of edges.
+ * @param edge_count The number of edges in the list.
+ *
+ * @return enum ppi_graph_result_t ppi_graph_success or the failure reason.
+ */
+enum ppi_graph_result_t ppi_graph_create(struct ppi_graph_t*        graph,
+                                         struct ppi_edge_t const*   edges,
+                                         size_t                     edge_count);
+
+/** Release the graph channels and group. The graph channels are disabled. */
+void ppi_graph_release(struct ppi_graph_t* graph);
+
+/** Enable all graph channels in a single write to the group EN task. */
+void ppi_graph_enable(struct ppi_graph_t const* graph);
+
+/** Disable all graph channels in a single write to the group DIS task. */
+void ppi_graph_disable(struct ppi_graph_t const* graph);
+
+/** Log the graph channels and their bindings at the debug level. */
+void ppi_graph_dump(struct ppi_graph_t const* graph);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,248 @@
+/**
+ * @file ppi_graph.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Build PPI event graphs: allocate and bind the PPI channels and the channel
+ * group for a list of event to task edges.
+ */
+
+#pragma once
+
+#include "ppi.h"
+#include "bit_manip.h"
+#include "logger.h"
+#include "project_assert.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @class ppi_graph_builder
+ * The PPI resource allocator behind ppi_graph_create().
+ *
+ * Channel and group ownership is kept in the PPI registers, as for
+ * ppi_channel_allocate(): a channel is free when both CH[].EEP and CH[].TEP
+ * are zero; a group is free when CHG[] is zero.
+ *
+ * @tparam ppi_registers_type NRF_PPI_Type on the target.
+ */
+template <typename ppi_registers_type>
+class ppi_graph_builder
+{
+public:
+    ~ppi_graph_builder()                                    = default;
+
+    ppi_graph_builder()                                     = delete;
+    ppi_graph_builder(ppi_graph_builder const&)             = delete;
+    ppi_graph_builder(ppi_graph_builder &&)                 = delete;
+    ppi_graph_builder& operator=(ppi_graph_builder const&)  = delete;
+    ppi_graph_builder& operator=(ppi_graph_builder&&)       = delete;
+
+    explicit ppi_graph_builder(ppi_registers_type& ppi_registers)
+        : ppi_registers_(ppi_registers)
+    {
+    }
+
+    /// @return uint32_t The bit mask of unallocated channels.
+    uint32_t free_channels() const
+    {
+        uint32_t channel_mask = 0u;
+        for (std::size_t channel = 0u; channel < channel_count; ++channel)
+        {
+            if (this->channel_is_free(channel))
+            {
+                channel_mask |= (1u << channel);
+            }
+        }
+        return channel_mask;
+    }
+
+    /// @return ppi_group_t The first unallocated group; ppi_group_invalid if none.
+    ppi_group_t free_group() const
+    {
+        for (std::size_t group = 0u; group < group_count; ++group)
+        {
+            if (this->ppi_registers_.CHG[group] == 0u)
+            {
+                return static_cast<ppi_group_t>(group);
+            }
+        }
+        return ppi_group_invalid;
+    }
+
+    /// @see ppi_graph_create().
+    enum ppi_graph_result_t create(struct ppi_graph_t&       graph,
+                                   struct ppi_edge_t const*  edges,
+                                   std::size_t               edge_count)
+    {
+        graph.channel_mask = 0u;
+        graph.group        = ppi_group_invalid;
+
+        ASSERT(edges);
+        ASSERT(edge_count > 0u);
+
+        // Plan the channels before touching the registers so that a
+        // failure leaves the PPI unchanged.
+        std::array<ppi_edge_t, channel_count> plan;
+        std::size_t plan_count = 0u;
+
+        for (struct ppi_edge_t const* edge = edges; edge < edges + edge_count; ++edge)
+        {
+            if ((edge->event == nullptr) || (edge->task == nullptr))
+            {
+                return ppi_graph_invalid_edge;
+            }
+
+            if (this->is_connected(edge->event, edge->task) ||
+                (edge->fork && this->is_connected(edge->event, edge->fork)))
+            {
+                return ppi_graph_conflict;
+            }
+
+            bool merged = false;
+            for (ppi_edge_t* planned = plan.data(); planned < plan.data() + plan_count; ++planned)
+            {
+                if (planned->event != edge->event) { continue; }
+
+                if ((planned->task == edge->task) || (planned->fork == edge->task) ||
+                    (edge->fork && ((planned->task == edge->fork) || (planned->fork == edge->fork))))
+                {
+                    return ppi_graph_conflict;
+                }
+
+                if ((not merged) && (planned->fork == nullptr) && (edge->fork == nullptr))
+                {
+                    planned->fork = edge->task;
+                    merged = true;
+                }
+            }
+
+            if (not merged)
+            {
+                if (plan_count == plan.size())
+                {
+                    return ppi_graph_no_channel;
+                }
+                plan[plan_count++] = *edge;
+            }
+        }
+
+        uint32_t free_channels = this->free_channels();
+        if (bit_manip::popcount(free_channels) < plan_count)
+        {
+            return ppi_graph_no_channel;
+        }
+
+        ppi_group_t const group = this->free_group();
+        if (group == ppi_group_invalid)
+        {
+            return ppi_graph_no_group;
+        }
+
+        for (ppi_edge_t const* planned = plan.data(); planned < plan.data() + plan_count; ++planned)
+        {
+            std::size_t const channel = bit_manip::count_trailing_zeros(free_channels);
+            free_channels = bit_manip::lowest_bit_clear(free_channels);
+
+            this->ppi_registers_.CH[channel].EEP    = reinterpret_cast<uintptr_t>(planned->event);
+            this->ppi_registers_.CH[channel].TEP    = reinterpret_cast<uintptr_t>(planned->task);
+            this->ppi_registers_.FORK[channel].TEP  = reinterpret_cast<uintptr_t>(planned->fork);
+            graph.channel_mask |= (1u << channel);
+        }
+
+        // The group is allocated once CHG[group] is non-zero.
+        this->ppi_registers_.CHENCLR    = graph.channel_mask;
+        this->ppi_registers_.CHG[group] = graph.channel_mask;
+        graph.group = group;
+
+        return ppi_graph_success;
+    }
+
+    /// @see ppi_graph_release().
+    void release(struct ppi_graph_t& graph)
+    {
+        if (graph.group == ppi_group_invalid) { return; }
+        ASSERT(graph.group < group_count);
+
+        this->disable(graph);
+        this->ppi_registers_.CHG[graph.group] = 0u;
+
+        bit_manip::for_each_set_bit(graph.channel_mask, [this](bit_manip::bit_pos_t channel) {
+            this->ppi_registers_.CH[channel].EEP   = 0u;
+            this->ppi_registers_.CH[channel].TEP   = 0u;
+            this->ppi_registers_.FORK[channel].TEP = 0u;
+        });
+
+        graph.channel_mask = 0u;
+        graph.group        = ppi_group_invalid;
+    }
+
+    void enable(struct ppi_graph_t const& graph)
+    {
+        ASSERT(graph.group < group_count);
+        this->ppi_registers_.TASKS_CHG[graph.group].EN = 1u;
+    }
+
+    void disable(struct ppi_graph_t const& graph)
+    {
+        ASSERT(graph.group < group_count);
+        this->ppi_registers_.TASKS_CHG[graph.group].DIS = 1u;
+    }
+
+    bool is_enabled(struct ppi_graph_t const& graph) const
+    {
+        return (graph.channel_mask != 0u) &&
+               ((this->ppi_registers_.CHEN & graph.channel_mask) == graph.channel_mask);
+    }
+
+    /// @see ppi_graph_dump().
+    void dump(struct ppi_graph_t const& graph, logger& logger) const
+    {
+        logger.debug("ppi graph: group: %u, channels: 0x%08x, %s",
+                     graph.group, graph.channel_mask,
+                     this->is_enabled(graph) ? "enabled" : "disabled");
+
+        bit_manip::for_each_set_bit(graph.channel_mask, [this, &logger](bit_manip::bit_pos_t channel) {
+            logger.debug("    ch %2u: event: 0x%08x -> task: 0x%08x, fork: 0x%08x",
+                         channel,
+                         static_cast<uint32_t>(this->ppi_registers_.CH[channel].EEP),
+                         static_cast<uint32_t>(this->ppi_registers_.CH[channel].TEP),
+                         static_cast<uint32_t>(this->ppi_registers_.FORK[channel].TEP));
+        });
+    }
+
+private:
+    /// Channels [0:19] are programmable; Channels [20:31] are reserved for Nordic.
+    static constexpr std::size_t const channel_count =
+        std::extent<decltype(ppi_registers_type::CH)>::value;
+    static constexpr std::size_t const group_count =
+        std::extent<decltype(ppi_registers_type::CHG)>::value;
+
+    bool channel_is_free(std::size_t channel) const
+    {
+        return (this->ppi_registers_.CH[channel].EEP == 0u) &&
+               (this->ppi_registers_.CH[channel].TEP == 0u);
+    }
+
+    /// @return true if an allocated channel triggers the task from the event.
+    bool is_connected(uint32_t volatile* event, uint32_t volatile* task) const
+    {
+        uintptr_t const event_address = reinterpret_cast<uintptr_t>(event);
+        uintptr_t const task_address  = reinterpret_cast<uintptr_t>(task);
+
+        for (std::size_t channel = 0u; channel < channel_count; ++channel)
+        {
+            if ((this->ppi_registers_.CH[channel].EEP == event_address) &&
+                ((this->ppi_registers_.CH[channel].TEP == task_address) ||
+                 (this->ppi_registers_.FORK[channel].TEP == task_address)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ppi_registers_type& ppi_registers_;
+};
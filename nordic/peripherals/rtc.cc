@@ -4,6 +4,7 @@
  */
 
 #include "rtc.h"
+#include "isr_profile.h"
 #include "project_assert.h"
 #include "nrf_cmsis.h"
 
@@ -277,8 +278,46 @@ void rtc_enable_interrupt(rtc_instance_t rtc_instance)
     NVIC_EnableIRQ(rtc_control->irq_type);
 }
 
+uint32_t volatile* rtc_tick_event_enable(rtc_instance_t rtc_instance)
+{
+    struct rtc_control_block_t* const rtc_control = rtc_control_block(rtc_instance);
+    ASSERT(rtc_control);
+
+    rtc_control->registers->INTENCLR = RTC_INTENCLR_TICK_Msk;
+    rtc_control->registers->EVTENSET = RTC_EVTENSET_TICK_Msk;
+    return &rtc_control->registers->EVENTS_TICK;
+}
+
+void rtc_tick_event_disable(rtc_instance_t rtc_instance)
+{
+    struct rtc_control_block_t* const rtc_control = rtc_control_block(rtc_instance);
+    ASSERT(rtc_control);
+
+    rtc_control->registers->EVTENCLR    = RTC_EVTENCLR_TICK_Msk;
+    rtc_control->registers->EVENTS_TICK = 0u;
+}
+
+#if defined ISR_PROFILE_ENABLED
+/**
+ * @return profile::cycles_t The CPU cycles from the compare event to now.
+ * The RTC tick is coarse: 30.5 usec with no prescaling.
+ */
+static profile::cycles_t rtc_compare_latency(rtc_control_block_t const* rtc_control,
+                                             rtc_cc_index_t             cc_index)
+{
+    uint32_t const counter_mask = (1u << rtc_counter_width) - 1u;
+    uint32_t const ticks = (rtc_control->registers->COUNTER -
+                            rtc_control->registers->CC[cc_index]) & counter_mask;
+    uint32_t const cycles_per_tick =
+        (SystemCoreClock / lfclk_frequency_Hz) * (rtc_control->registers->PRESCALER + 1u);
+    return ticks * cycles_per_tick;
+}
+#endif
+
 static void irq_handler_rtc(rtc_control_block_t *rtc_control)
 {
+    ISR_PROFILE(rtc_control->irq_type);
+
     // Handle the overflow event first so that observers will get
     // notified with the extended count value.
     if (rtc_control->registers->EVENTS_OVRFLW)
@@ -291,6 +330,7 @@ static void irq_handler_rtc(rtc_control_block_t *rtc_control)
     {
         if (rtc_control->registers->EVENTS_COMPARE[cc_index])
         {
+            ISR_PROFILE_LATENCY(rtc_compare_latency(rtc_control, cc_index));
             uint32_t const cc_count = rtc_control->registers->CC[cc_index];
             rtc_control->handler(cc_index, cc_count, rtc_control->context);
             rtc_clear_compare_event(rtc_control, cc_index);
@@ -306,7 +346,7 @@ extern "C" void rtc_event_handler(rtc_cc_index_t    cc_index,
     rtc_with_event->event_notify(cc_index, cc_count);
 }
 
-rtc::rtc(rtc_instance_t rtc_instance, uint8_t  prescaler, uint8_t irq_priority)
+rtc::rtc(rtc_instance_t rtc_instance, uint16_t prescaler, uint8_t irq_priority)
     : cc_alloc_count(rtc_instances[rtc_instance] ?
                      rtc_instances[rtc_instance]->cc_alloc_count : 0u),
       rtc_instance_(rtc_instance)
@@ -374,6 +414,16 @@ void rtc::cc_disable(rtc_cc_index_t cc_index)
     rtc_cc_disable(this->rtc_instance_, cc_index);
 }
 
+uint32_t volatile* rtc::tick_event_enable()
+{
+    return rtc_tick_event_enable(this->rtc_instance_);
+}
+
+void rtc::tick_event_disable()
+{
+    rtc_tick_event_disable(this->rtc_instance_);
+}
+
 uint32_t rtc::ticks_per_second() const
 {
     return rtc_ticks_per_second(this->rtc_instance_);
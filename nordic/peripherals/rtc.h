@@ -68,6 +68,15 @@ uint32_t rtc_ticks_per_second(rtc_instance_t rtc_instance);
 
 void rtc_enable_interrupt(rtc_instance_t rtc_instance);
 
+/**
+ * Route the TICK event, once per prescaled clock, to PPI without an
+ * interrupt.
+ * @return uint32_t volatile* The EVENTS_TICK register; a PPI event.
+ */
+uint32_t volatile* rtc_tick_event_enable(rtc_instance_t rtc_instance);
+
+void rtc_tick_event_disable(rtc_instance_t rtc_instance);
+
 #ifdef __cplusplus
 }
 
@@ -99,7 +108,7 @@ public:
 
     // 32,768 Hz clock source.
     explicit rtc(rtc_instance_t  rtc_instance,
-                 uint8_t         prescaler     = 1u,
+                 uint16_t        prescaler     = 1u,
                  uint8_t         irq_priority  = 7u);
 
     void start();
@@ -115,6 +124,9 @@ public:
     uint64_t get_count_extend_64() const;
     void     cc_disable(cc_index_t cc_index);
 
+    uint32_t volatile* tick_event_enable();
+    void     tick_event_disable();
+
     uint32_t ticks_per_second() const;
     uint32_t usec_to_ticks(uint32_t usec) const;
     uint32_t msec_to_ticks(uint32_t msec) const;
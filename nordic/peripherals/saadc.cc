@@ -8,7 +8,9 @@
 #include "logger.h"
 #include "nrf_cmsis.h"
 #include "arm_utilities.h"
+#include "isr_profile.h"
 #include "project_assert.h"
+#include "bit_manip.h"
 
 #include <iterator>
 
@@ -18,6 +20,18 @@ static saadc_input_channel_t const SAADC_INPUT_COUNT = 8u;
 /// The SAADC time of conversion in microsoeconds.
 static uint32_t const t_acq_conv = 2u;
 
+/// A bit per SAADC input channel.
+using saadc_input_mask_t = uint8_t;
+static_assert(SAADC_INPUT_COUNT <= sizeof(saadc_input_mask_t) * CHAR_BIT);
+
+/// The INTEN bits for the LIMITH, LIMITL events: two per input channel.
+static bit_manip::bit_pos_t const limit_interrupt_pos = SAADC_INTEN_CH0LIMITH_Pos;
+static uint32_t const limit_interrupt_mask =
+    bit_manip::bit_mask<uint32_t>(2u * SAADC_INPUT_COUNT, limit_interrupt_pos);
+
+static_assert(SAADC_INTEN_CH0LIMITL_Pos == SAADC_INTEN_CH0LIMITH_Pos + 1u);
+static_assert(SAADC_INTEN_CH1LIMITH_Pos == SAADC_INTEN_CH0LIMITH_Pos + 2u);
+
 /// Interrupt registers are 32-bits wide.
 /// Use this value to clear all interrupts.
 static uint32_t const interrupts_clear_all = UINT32_MAX;
@@ -40,9 +54,20 @@ struct saadc_control_block_t
 
     int16_t* sample_data_pointer;
 
+    /**
+     * A bit is set for each input channel with an analog input selected.
+     * Counting the channels to convert is a popcount rather than a read of
+     * the PSELP register of every channel.
+     */
+    saadc_input_mask_t inputs_enabled;
+
     ppi_channel_t ppi_trigger;
     ppi_channel_t ppi_sample;
 
+    /// Ring sampling: the sample event samples; END restarts the ring.
+    ppi_channel_t ppi_ring_sample;
+    ppi_channel_t ppi_ring_restart;
+
     /// The user supplied callback function.
     /// When the spi transfer is complete this function is called.
     saadc_event_handler_t handler;
@@ -59,8 +84,11 @@ static struct saadc_control_block_t saadc_instance_0 =
     .saadc_registers     = reinterpret_cast<NRF_SAADC_Type *>(NRF_SAADC_BASE),
     .irq_type            = SAADC_IRQn,
     .sample_data_pointer = nullptr,
+    .inputs_enabled      = 0u,
     .ppi_trigger         = ppi_channel_invalid,
     .ppi_sample          = ppi_channel_invalid,
+    .ppi_ring_sample     = ppi_channel_invalid,
+    .ppi_ring_restart    = ppi_channel_invalid,
     .handler             = nullptr,
     .context             = nullptr
 };
@@ -147,6 +175,16 @@ void saadc_input_configure(
 
     saadc_registers->CH[input_channel].CONFIG = channel_config;
     saadc_disable_limit_event(input_channel);
+
+    saadc_input_mask_t const input_bit = static_cast<saadc_input_mask_t>(1u << input_channel);
+    if (analog_in_positive != saadc_input_select_NC)
+    {
+        saadc_instance_0.inputs_enabled |= input_bit;
+    }
+    else
+    {
+        saadc_instance_0.inputs_enabled &= ~input_bit;
+    }
 }
 
 void saadc_input_configure_single_ended(
@@ -188,8 +226,8 @@ void saadc_input_disable(saadc_input_channel_t input_channel)
 
 bool saadc_input_is_enabled(saadc_input_channel_t input_channel)
 {
-    NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
-    return (saadc_registers->CH[input_channel].PSELP != saadc_input_select_NC);
+    ASSERT(input_channel < SAADC_INPUT_COUNT);
+    return bool(saadc_instance_0.inputs_enabled & (1u << input_channel));
 }
 
 void saadc_init(enum saadc_conversion_resolution_t  resolution,
@@ -257,10 +295,14 @@ void saadc_deinit(void)
     /// Release our PPI channels.
     ppi_channel_release(saadc_instance_0.ppi_trigger);
     ppi_channel_release(saadc_instance_0.ppi_sample);
+    ppi_channel_release(saadc_instance_0.ppi_ring_sample);
+    ppi_channel_release(saadc_instance_0.ppi_ring_restart);
 
     saadc_instance_0.sample_data_pointer = nullptr;
-    saadc_instance_0.ppi_trigger = ppi_channel_invalid;
-    saadc_instance_0.ppi_sample  = ppi_channel_invalid;
+    saadc_instance_0.ppi_trigger      = ppi_channel_invalid;
+    saadc_instance_0.ppi_sample       = ppi_channel_invalid;
+    saadc_instance_0.ppi_ring_sample  = ppi_channel_invalid;
+    saadc_instance_0.ppi_ring_restart = ppi_channel_invalid;
 
     saadc_registers->INTEN  = 0u;   // Disable all interrupts
     saadc_registers->ENABLE = 0u;   // Disable SAADC operation
@@ -320,6 +362,9 @@ void saadc_conversion_start(int16_t*              destination_pointer,
     NVIC_ClearPendingIRQ(saadc_instance_0.irq_type);
     NVIC_EnableIRQ(saadc_instance_0.irq_type);
 
+    // Ring sampling disables the EVENTS_STARTED -> TASKS_SAMPLE channel.
+    ppi_channel_enable(saadc_instance_0.ppi_sample);
+
     if (event_register == nullptr)
     {
         // The PPI channel for triggering the SAADC was previously allocated.
@@ -386,27 +431,24 @@ void saadc_conversion_stop(void)
 
 struct saadc_conversion_info_t saadc_conversion_info(void)
 {
+    saadc_input_mask_t    const inputs_enabled = saadc_instance_0.inputs_enabled;
+    saadc_input_channel_t const channel_count  =
+        static_cast<saadc_input_channel_t>(bit_manip::popcount(inputs_enabled));
+
     saadc_conversion_info_t channel_conversion = {
-        .time_usec     = 0u,
-        .channel_count = 0u
+        .time_usec     = static_cast<uint16_t>(channel_count * t_acq_conv),
+        .channel_count = channel_count
     };
 
-    for (saadc_input_channel_t input_channel = 0u;
-         input_channel < SAADC_INPUT_COUNT; ++input_channel)
+    NRF_SAADC_Type const *saadc_registers = saadc_instance_0.saadc_registers;
+    bit_manip::for_each_set_bit(inputs_enabled, [&](bit_manip::bit_pos_t input_channel)
     {
-        if (saadc_input_is_enabled(input_channel))
-        {
-            channel_conversion.channel_count += 1u;
-
-            NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
-            uint32_t const config = saadc_registers->CH[input_channel].CONFIG;
+        uint32_t const config = saadc_registers->CH[input_channel].CONFIG;
+        enum saadc_tacq_t const t_acq = static_cast<enum saadc_tacq_t>(
+            (config & SAADC_CH_CONFIG_TACQ_Msk) >> SAADC_CH_CONFIG_TACQ_Pos);
 
-            enum saadc_tacq_t const t_acq = static_cast<enum saadc_tacq_t>(
-                (config & SAADC_CH_CONFIG_TACQ_Msk) >> SAADC_CH_CONFIG_TACQ_Pos);
-
-            channel_conversion.time_usec += t_acq_usec(t_acq) + t_acq_conv;
-        }
-    }
+        channel_conversion.time_usec += t_acq_usec(t_acq);
+    });
 
     return channel_conversion;
 }
@@ -419,32 +461,45 @@ static uint32_t saadc_make_limits(int16_t limit_lower, int16_t limit_upper)
     return limits;
 }
 
+/// @return uint32_t The INTEN LIMITL bit for the input channel.
+static uint32_t saadc_limit_lower_interrupt(saadc_input_channel_t input_channel)
+{
+    return 1u << (SAADC_INTENSET_CH0LIMITL_Pos + 2u * input_channel);
+}
+
+/// @return uint32_t The INTEN LIMITH bit for the input channel.
+static uint32_t saadc_limit_upper_interrupt(saadc_input_channel_t input_channel)
+{
+    return 1u << (SAADC_INTENSET_CH0LIMITH_Pos + 2u * input_channel);
+}
+
 void saadc_enable_limits_event(saadc_input_channel_t    input_channel,
                                int16_t                  limit_lower,
                                int16_t                  limit_upper)
 {
     ASSERT(input_channel < SAADC_INPUT_COUNT);
 
-    uint32_t const limits             = saadc_make_limits(limit_upper, limit_lower);
-    uint32_t const limit_lower_enable = (input_channel * 2u) << SAADC_INTENSET_CH0LIMITL_Pos;
-    uint32_t const limit_upper_enable = (input_channel * 2u) << SAADC_INTENSET_CH0LIMITH_Pos;
+    uint32_t const limits             = saadc_make_limits(limit_lower, limit_upper);
+    uint32_t const limit_lower_enable = saadc_limit_lower_interrupt(input_channel);
+    uint32_t const limit_upper_enable = saadc_limit_upper_interrupt(input_channel);
 
     NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
 
-    saadc_registers->INTENCLR |= (limit_lower_enable | limit_upper_enable);
+    // INTENSET, INTENCLR are write '1' to modify: do not read-modify-write.
+    saadc_registers->INTENCLR = (limit_lower_enable | limit_upper_enable);
     saadc_registers->CH[input_channel].LIMIT = limits;
 
     if (limit_lower == INT16_MIN)           // INT16_MIN: -32768, 0x8000
     {
-        saadc_registers->INTENSET |= limit_upper_enable;
+        saadc_registers->INTENSET = limit_upper_enable;
     }
     else if (limit_upper == INT16_MAX)      // INT16_MAX:  32767, 0x7FFF
     {
-        saadc_registers->INTENSET |= limit_lower_enable;
+        saadc_registers->INTENSET = limit_lower_enable;
     }
     else
     {
-        saadc_registers->INTENSET |= (limit_lower_enable | limit_upper_enable);
+        saadc_registers->INTENSET = (limit_lower_enable | limit_upper_enable);
     }
 }
 
@@ -462,12 +517,12 @@ void saadc_disable_limit_event(saadc_input_channel_t input_channel)
 {
     ASSERT(input_channel < SAADC_INPUT_COUNT);
     uint32_t const limits             = saadc_make_limits(INT16_MIN, INT16_MAX);
-    uint32_t const limit_lower_enable = (input_channel * 2u) << SAADC_INTENSET_CH0LIMITL_Pos;
-    uint32_t const limit_upper_enable = (input_channel * 2u) << SAADC_INTENSET_CH0LIMITH_Pos;
+    uint32_t const limit_lower_enable = saadc_limit_lower_interrupt(input_channel);
+    uint32_t const limit_upper_enable = saadc_limit_upper_interrupt(input_channel);
 
     NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
 
-    saadc_registers->INTENCLR |= (limit_lower_enable | limit_upper_enable);
+    saadc_registers->INTENCLR = (limit_lower_enable | limit_upper_enable);
     saadc_registers->CH[input_channel].LIMIT = limits;
 }
 
@@ -491,12 +546,141 @@ bool saadc_conversion_in_progress(void)
     return bool(saadc_registers->STATUS & SAADC_STATUS_STATUS_Busy);
 }
 
+/// Stop the SAADC and wait for EVENTS_STOPPED without an interrupt.
+static void saadc_stop_wait(NRF_SAADC_Type* saadc_registers)
+{
+    saadc_registers->INTENCLR   = SAADC_INTEN_STOPPED_Msk;
+    saadc_registers->TASKS_STOP = 1u;
+
+    // STOPPED follows STOP within a conversion time; bound the wait anyway.
+    for (uint32_t spin = 0u; (spin < 10000u) && not saadc_registers->EVENTS_STOPPED; ++spin) {}
+
+    saadc_clear_event_register(&saadc_registers->EVENTS_STOPPED);
+}
+
+void saadc_ring_start(int16_t*              ring,
+                      uint16_t              ring_length,
+                      uint32_t volatile*    sample_event)
+{
+    ASSERT(ring);
+    ASSERT(sample_event);
+
+    NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
+
+    struct saadc_conversion_info_t const channel_conversion = saadc_conversion_info();
+    ASSERT(channel_conversion.channel_count > 0u);
+    ASSERT(ring_length % channel_conversion.channel_count == 0u);
+
+    // Only the limit events wake the CPU.
+    saadc_registers->INTENCLR = interrupts_clear_all & ~limit_interrupt_mask;
+
+    if (saadc_instance_0.ppi_trigger != ppi_channel_invalid)
+    {
+        ppi_channel_disable(saadc_instance_0.ppi_trigger);
+    }
+
+    // Each ring restart must not sample an extra frame.
+    ppi_channel_disable(saadc_instance_0.ppi_sample);
+
+    saadc_registers->ENABLE = 1u;
+    saadc_stop_wait(saadc_registers);
+
+    if (saadc_instance_0.ppi_ring_sample == ppi_channel_invalid)
+    {
+        saadc_instance_0.ppi_ring_sample = ppi_channel_allocate(
+            &saadc_registers->TASKS_SAMPLE, sample_event, nullptr);
+        saadc_instance_0.ppi_ring_restart = ppi_channel_allocate(
+            &saadc_registers->TASKS_START, &saadc_registers->EVENTS_END, nullptr);
+
+        logger::instance().debug("ppi ring channels: sample: %u, restart: %u",
+                                 saadc_instance_0.ppi_ring_sample,
+                                 saadc_instance_0.ppi_ring_restart);
+    }
+    else
+    {
+        ppi_channel_bind_event(saadc_instance_0.ppi_ring_sample, sample_event);
+    }
+
+    saadc_clear_event_register(&saadc_registers->EVENTS_STARTED);
+    saadc_clear_event_register(&saadc_registers->EVENTS_END);
+
+    saadc_registers->RESULT.MAXCNT = ring_length;
+    saadc_registers->RESULT.PTR    = reinterpret_cast<uintptr_t>(ring);
+    saadc_instance_0.sample_data_pointer = ring;
+
+    NVIC_ClearPendingIRQ(saadc_instance_0.irq_type);
+    NVIC_EnableIRQ(saadc_instance_0.irq_type);
+
+    ppi_channel_enable(saadc_instance_0.ppi_ring_restart);
+    ppi_channel_enable(saadc_instance_0.ppi_ring_sample);
+    saadc_registers->TASKS_START = 1u;
+}
+
+struct saadc_ring_position_t saadc_ring_stop(void)
+{
+    NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
+
+    ppi_channel_disable(saadc_instance_0.ppi_ring_sample);
+
+    // Let the frame in progress be written; it may be the frame which
+    // crossed a limit. A frame completes within a conversion time; bound
+    // the wait as saadc_stop_wait() does.
+    for (uint32_t spin = 0u; (spin < 10000u) && saadc_conversion_in_progress(); ++spin) {}
+
+    ppi_channel_disable(saadc_instance_0.ppi_ring_restart);
+
+    // EVENTS_END is set, without an interrupt, each time the ring fills.
+    bool const wrapped = bool(saadc_registers->EVENTS_END);
+
+    // RESULT.AMOUNT is valid once the SAADC has stopped.
+    saadc_stop_wait(saadc_registers);
+
+    struct saadc_ring_position_t const position = {
+        .sample_index = static_cast<uint16_t>(saadc_registers->RESULT.AMOUNT),
+        .wrapped      = wrapped,
+    };
+
+    saadc_clear_event_register(&saadc_registers->EVENTS_STARTED);
+    saadc_clear_event_register(&saadc_registers->EVENTS_END);
+    saadc_instance_0.sample_data_pointer = nullptr;
+
+    return position;
+}
+
+bool saadc_calibrate_offset(void)
+{
+    NRF_SAADC_Type *saadc_registers = saadc_instance_0.saadc_registers;
+
+    // A started SAADC may be triggered to SAMPLE during the calibration.
+    // sample_data_pointer is set from START until STOPPED.
+    if ((saadc_instance_0.sample_data_pointer != nullptr) ||
+        (saadc_registers->INTEN & SAADC_INTEN_CALIBRATEDONE_Msk) ||
+        saadc_conversion_in_progress())
+    {
+        return false;
+    }
+
+    saadc_registers->ENABLE   = 1u;
+    saadc_registers->INTENSET = SAADC_INTEN_CALIBRATEDONE_Msk;
+
+    NVIC_EnableIRQ(saadc_instance_0.irq_type);
+    saadc_registers->TASKS_CALIBRATEOFFSET = 1u;
+    return true;
+}
+
 static void irq_handler_saadc(struct saadc_control_block_t* saadc_control)
 {
+    ISR_PROFILE(saadc_control->irq_type);
+
     NRF_SAADC_Type *saadc_registers = saadc_control->saadc_registers;
     logger& logger = logger::instance();
 
-    if (saadc_registers->EVENTS_STARTED)
+    // Events are set whether or not their interrupt is enabled; ring
+    // sampling leaves EVENTS_STARTED and EVENTS_END set without interrupts.
+    // Only handle the events with their interrupt enabled.
+    uint32_t const interrupts_enabled = saadc_registers->INTEN;
+
+    if ((interrupts_enabled & SAADC_INTEN_STARTED_Msk) && saadc_registers->EVENTS_STARTED)
     {
         // If the PPI channel saadc_instance_0.ppi_sample were not used
         // saadc_registers->TASKS_SAMPLE = 1u; would be required here.
@@ -518,7 +702,7 @@ static void irq_handler_saadc(struct saadc_control_block_t* saadc_control)
                                saadc_control->context);
     }
 
-    if (saadc_registers->EVENTS_END)
+    if ((interrupts_enabled & SAADC_INTEN_END_Msk) && saadc_registers->EVENTS_END)
     {
         saadc_clear_event_register(&saadc_registers->EVENTS_END);
 
@@ -541,28 +725,34 @@ static void irq_handler_saadc(struct saadc_control_block_t* saadc_control)
             reinterpret_cast<int16_t *>(saadc_registers->RESULT.PTR);
     }
 
-    if (saadc_registers->EVENTS_DONE)
+    if ((interrupts_enabled & SAADC_INTEN_DONE_Msk) && saadc_registers->EVENTS_DONE)
     {
         saadc_clear_event_register(&saadc_registers->EVENTS_DONE);
         logger.debug("IRQ: EVENTS_DONE");
     }
 
-    if (saadc_registers->EVENTS_RESULTDONE)
+    if ((interrupts_enabled & SAADC_INTEN_RESULTDONE_Msk) && saadc_registers->EVENTS_RESULTDONE)
     {
         saadc_clear_event_register(&saadc_registers->EVENTS_RESULTDONE);
         logger.debug("IRQ: EVENTS_RESULTDONE");
     }
 
-    if (saadc_registers->EVENTS_CALIBRATEDONE)
+    if ((interrupts_enabled & SAADC_INTEN_CALIBRATEDONE_Msk) && saadc_registers->EVENTS_CALIBRATEDONE)
     {
         saadc_clear_event_register(&saadc_registers->EVENTS_CALIBRATEDONE);
+        saadc_registers->INTENCLR = SAADC_INTEN_CALIBRATEDONE_Msk;
         logger.debug("IRQ: EVENTS_CALIBRATEDONE");
+
+        // nRF52832 anomaly 86: the START following an offset calibration
+        // may write a sample to RAM unless STOP follows the calibration.
+        saadc_stop_wait(saadc_registers);
+
         saadc_control->handler(saddc_event_calibration_complete,
                                nullptr,
                                saadc_control->context);
     }
 
-    if (saadc_registers->EVENTS_STOPPED)
+    if ((interrupts_enabled & SAADC_INTEN_STOPPED_Msk) && saadc_registers->EVENTS_STOPPED)
     {
         saadc_clear_event_register(&saadc_registers->EVENTS_STOPPED);
 
@@ -577,38 +767,33 @@ static void irq_handler_saadc(struct saadc_control_block_t* saadc_control)
                      event_info.conversion.data,
                      event_info.conversion.length);
 
+        // Stopped before the handler, which may start a calibration.
+        saadc_instance_0.sample_data_pointer = nullptr;
+
         saadc_control->handler(saadc_event_conversion_stop,
                                &event_info,
                                saadc_control->context);
-
-        saadc_instance_0.sample_data_pointer = nullptr;
     }
 
-    for (saadc_input_channel_t input_channel = 0u;
-         input_channel < SAADC_INPUT_COUNT; ++input_channel)
-    {
-        if (saadc_registers->EVENTS_CH[input_channel].LIMITL)
-        {
-            saadc_clear_event_register(&saadc_registers->EVENTS_CH[input_channel].LIMITL);
-            logger.debug("IRQ: LIMITL[%u]: 0x%08x", input_channel,
-                         saadc_registers->CH[input_channel].LIMIT);
+    // Visit only the limit events with their interrupt enabled.
+    // Bit pairs, starting at LIMITH, LIMITL of input channel 0.
+    uint32_t const limits_enabled =
+        (interrupts_enabled & limit_interrupt_mask) >> limit_interrupt_pos;
 
-            union saadc_event_info_t const event_info = {
-                .limits_exceeded = {
-                    .input_channel = input_channel
-                }
-            };
+    bit_manip::for_each_set_bit(limits_enabled, [&](bit_manip::bit_pos_t bit_pos)
+    {
+        saadc_input_channel_t const input_channel = static_cast<saadc_input_channel_t>(bit_pos / 2u);
+        bool const is_lower = bool(bit_pos & 1u);
 
-            saadc_control->handler(saadc_event_limit_lower,
-                                   &event_info,
-                                   saadc_control->context);
-        }
+        uint32_t volatile* const limit_event = is_lower ?
+            &saadc_registers->EVENTS_CH[input_channel].LIMITL :
+            &saadc_registers->EVENTS_CH[input_channel].LIMITH;
 
-        if (saadc_registers->EVENTS_CH[input_channel].LIMITH)
+        if (*limit_event)
         {
-            saadc_clear_event_register(&saadc_registers->EVENTS_CH[input_channel].LIMITH);
-            logger.debug("IRQ: LIMITH[%u]: 0x%08x", input_channel,
-                         saadc_registers->CH[input_channel].LIMIT);
+            saadc_clear_event_register(limit_event);
+            logger.debug("IRQ: %s[%u]: 0x%08x", is_lower ? "LIMITL" : "LIMITH",
+                         input_channel, saadc_registers->CH[input_channel].LIMIT);
 
             union saadc_event_info_t const event_info = {
                 .limits_exceeded = {
@@ -616,9 +801,9 @@ static void irq_handler_saadc(struct saadc_control_block_t* saadc_control)
                 }
             };
 
-            saadc_control->handler(saadc_event_limit_upper,
+            saadc_control->handler(is_lower ? saadc_event_limit_lower : saadc_event_limit_upper,
                                    &event_info,
                                    saadc_control->context);
         }
-    }
+    });
 }
@@ -407,6 +407,52 @@ struct saadc_limits_t saadc_get_channel_limits(saadc_input_channel_t input_chann
  */
 bool saadc_conversion_in_progress(void);
 
+/**
+ * Sample into a ring without the CPU. Each sample event converts a frame,
+ * one sample of every enabled channel, and appends it to the ring. At the
+ * end of the ring the SAADC END event restarts the ring from its start
+ * through PPI. Only the limit events enabled with
+ * saadc_enable_limits_event() interrupt.
+ *
+ * A conversion in progress is stopped first; its events are not reported.
+ *
+ * @param ring         The ring of samples.
+ * @param ring_length  The ring length in samples; a whole number of frames.
+ * @param sample_event The peripheral event which samples a frame.
+ */
+void saadc_ring_start(int16_t*              ring,
+                      uint16_t              ring_length,
+                      uint32_t volatile*    sample_event);
+
+/// Used for returning values from saadc_ring_stop().
+struct saadc_ring_position_t
+{
+    /// The samples written in the current pass through the ring.
+    uint16_t sample_index;
+
+    /// The ring was filled at least once.
+    bool wrapped;
+};
+
+/**
+ * Stop ring sampling once the frame in progress is written.
+ * @return struct saadc_ring_position_t Where the ring sampling stopped.
+ */
+struct saadc_ring_position_t saadc_ring_stop(void);
+
+/**
+ * Start an SAADC offset calibration. When the calibration completes the
+ * SAADC is stopped, per anomaly 86, and the event handler is called with
+ * saddc_event_calibration_complete.
+ * Recalibrate when the temperature changes; the offset drifts with it.
+ *
+ * @return bool true if the calibration started.
+ *              false if the SAADC is started, not yet stopped by
+ *              saadc_conversion_stop() or saadc_ring_stop(), or a
+ *              calibration is in progress; try again later.
+ */
+bool saadc_calibrate_offset(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 #include "logger.h"
 #include "nrf_cmsis.h"
 #include "arm_utilities.h"
+#include "isr_profile.h"
 #include "project_assert.h"
 
 #include <iterator>
@@ -445,6 +446,8 @@ static void finish_transfer(struct spim_control_block_t* const spim_control)
 
 static void irq_handler_spim(struct spim_control_block_t* const spim_control)
 {
+    ISR_PROFILE(spim_control->irq_type);
+
     if (spim_control->spim_registers->EVENTS_END)
     {
         spim_clear_event_register(&spim_control->spim_registers->EVENTS_END);
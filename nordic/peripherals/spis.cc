@@ -6,13 +6,12 @@
  */
 
 #include "spis.h"
+#include "spis_ring.h"
 #include "spi_common.h"
 #include "spis_debug.h"
 #include "gpio.h"
 #include "gpio_te.h"
 
-#include "nordic_critical_section.h"
-
 #include "nrf_cmsis.h"
 #include "arm_utilities.h"
 
@@ -22,7 +21,6 @@
 #include <array>
 #include <iterator>
 #include <limits>
-#include <utility>
 
 #if defined (NRF52840_XXAA)
 static constexpr size_t const max_dma_length = std::numeric_limits<uint16_t>::max();
@@ -38,143 +36,6 @@ static constexpr IRQn_Type SPIS2_IRQn = SPIM2_SPIS2_SPI2_IRQn;
 static constexpr uint32_t spis_interrupt_mask = SPIS_INTENSET_ACQUIRED_Msk |
                                                 SPIS_INTENSET_END_Msk      |
                                                 0u;
-/**
- * @struct spis_buffer_t
- * Provides easy conversions from uintptr_t to void* and back.
- * Keeps track of the TXD, RXD DMA buffer address and pointer.
- */
-struct spis_buffer_t
-{
-    struct buffer_t
-    {
-        ~buffer_t()                          = default;
-        buffer_t(buffer_t const&)            = delete;
-        buffer_t(buffer_t &&)                = delete;
-        buffer_t& operator=(buffer_t const&) = delete;
-        buffer_t& operator=(buffer_t&&)      = delete;
-
-        buffer_t(): address(0u), length(0u) {};
-
-        void set(void* ptr, uint32_t len) {
-            this->address = reinterpret_cast<uintptr_t>(ptr);
-            this->length  = len;
-        }
-
-        void set(void const* ptr, uint32_t len) {
-            this->address = reinterpret_cast<uintptr_t>(ptr);
-            this->length  = len;
-        }
-
-        void set(uintptr_t addr, uint32_t len) {
-            this->address = addr;
-            this->length  = len;
-        }
-
-        void* get_pointer() const {
-            return reinterpret_cast<void*>(this->address);
-        }
-
-        uintptr_t address;
-        uint32_t  length;
-    };
-
-    ~spis_buffer_t()                               = default;
-    spis_buffer_t()                                = default;
-    spis_buffer_t(spis_buffer_t const&)            = delete;
-    spis_buffer_t(spis_buffer_t &&)                = delete;
-    spis_buffer_t& operator=(spis_buffer_t const&) = delete;
-    spis_buffer_t& operator=(spis_buffer_t&&)      = delete;
-
-    buffer_t mosi_buffer;
-    buffer_t miso_buffer;
-};
-
-/**
- * @struct spis_double_buffer_t
- * Keep track of which spis_buffer_t has been queued into the DMA for transfer
- * and if there is a buffer pending for transfer.
- */
-struct spis_double_buffer_t
-{
-    /// When a buffer index, queued or completed,
-    /// does not point to a valid DMA buffer.
-    static constexpr uint8_t buffer_index_none = std::numeric_limits<uint8_t>::max();
-
-    ~spis_double_buffer_t()                                      = default;
-
-    spis_double_buffer_t(spis_double_buffer_t const&)            = delete;
-    spis_double_buffer_t(spis_double_buffer_t &&)                = delete;
-    spis_double_buffer_t& operator=(spis_double_buffer_t const&) = delete;
-    spis_double_buffer_t& operator=(spis_double_buffer_t&&)      = delete;
-
-    spis_double_buffer_t()
-    :   buffer_index_to_queue(0u),
-        buffer_index_enqueued(buffer_index_none)
-    {}
-
-    std::array<spis_buffer_t, 2u> buffer;
-
-    /**
-     * Increment the queued buffer index.
-     * @return uint8_t The index pointing to the next DMA buffer which can be
-     *                 queued.
-     * @note If buffer_index_to_queue == buffer_index_enqueued then all DMA
-     *       buffers have been used and the increment fails.
-     */
-    uint8_t next_queued_index() const {
-        uint8_t const index = this->buffer_index_to_queue + 1u;
-        return (index >= this->buffer.size()) ? 0u : index;
-    }
-
-    /**
-     * Inrement the enqueued buffer index.
-     * @note If buffer_index_enqueued is the same as the buffer_index_to_queue
-     *       then all queued buffers have been transferred.
-     *
-     * @return uint8_t The index pointing to the next enqueued buffer.
-     * @retval buffer_index_none If there are no pending queued buffers to transfer.
-     * @retval incremented buffer_index_enqueued which will be the next queued
-     *         buffer to transfer.
-     */
-    uint8_t next_enqueued_index() const {
-        if (this->buffer_index_enqueued == this->buffer_index_to_queue)
-        {
-            return buffer_index_none;
-        }
-        uint8_t const index = this->buffer_index_enqueued + 1u;
-        return (index >= this->buffer.size()) ? 0u : index;
-    }
-
-    /// @{ Get the spis_buffer_t to queue as pending for DMA transfer.
-    spis_buffer_t const& buffer_to_queue() const {
-        ASSERT(this->buffer_index_to_queue < this->buffer.size());
-        return this->buffer[this->buffer_index_to_queue];
-    }
-
-    spis_buffer_t& buffer_to_queue() {
-        return const_cast<spis_buffer_t&>(std::as_const(*this).buffer_to_queue());
-    }
-    /// @}
-
-    /// @{ Get the spis_buffer_t which has been committed to the DMA transfer.
-    spis_buffer_t const& buffer_enqueued() const {
-        ASSERT(this->buffer_index_enqueued < this->buffer.size());
-        return this->buffer[this->buffer_index_enqueued];
-    }
-
-    spis_buffer_t& buffer_enqueued() {
-        return const_cast<spis_buffer_t&>(std::as_const(*this).buffer_enqueued());
-    }
-    /// @}
-
-    /// Index to the spis_buffer_t which is free and ready to queue.
-    uint8_t buffer_index_to_queue;
-
-    /// Index to the spis_buffer_t which has already been queued and is
-    /// committed to the transfer of data.
-    uint8_t buffer_index_enqueued;
-};
-
 struct spis_control_block_t
 {
     ~spis_control_block_t()                                      = default;
@@ -187,9 +48,8 @@ struct spis_control_block_t
     spis_control_block_t(uintptr_t base_address, IRQn_Type irq_no)
     :   spis_registers(reinterpret_cast<NRF_SPIS_Type *>(base_address)),
         irq_type(irq_no),
-        spis_semaphore_owned(false),
-        data_is_ready(false),
-        dma_buffer(),
+        ring(),
+        ring_mode(false),
         gpio_te_channel(gpio_te_channel_invalid),
         handler(nullptr),
         context(nullptr),
@@ -221,19 +81,16 @@ struct spis_control_block_t
      */
     IRQn_Type const irq_type;
 
-    /// Does the firmware own the SPI semaphore?
-    /// true: The firmware owns it. false: The SPI peripheral owns it.
-    /// When the firmware owns it RXD, TDX registers may be written.
-    bool spis_semaphore_owned;
+    /// The transfer slots queued, armed into the DMA and completed.
+    /// The ring also tracks the ownership of the SPIS semaphore.
+    spis_ring ring;
 
-    /// Indicates that the client has set the TX, Rx buffers into the driver
-    /// block via enable_transfer() and the data is ready to be set into the
-    /// SPIS peripheral TXD, RXD locations once the semaphore is acquired.
-    /// Once transferred into TXD, RXD, this flag is set false.
-    bool data_is_ready;
+    /// The slots used by spis_enable_transfer().
+    std::array<struct spis_slot_t, 2u> transfer_slots;
 
-    /// User buffer interaction with DMA transfer bookkeeping structure.
-    spis_double_buffer_t dma_buffer;
+    /// true:  The application slots are in use; spis_ring_start().
+    /// false: The transfer_slots are in use; spis_enable_transfer().
+    bool ring_mode;
 
     /// Used to work around DMA anomaly 109.
     /// @see spis_init_dma_anomaly_109().
@@ -437,7 +294,10 @@ enum spi_result_t spis_init(spi_port_t                  spi_port,
         (SPIS_ENABLE_ENABLE_Enabled << SPIS_ENABLE_ENABLE_Pos);
 
     // When the SPIS is first enabled the semaphore is owned by firmware.
-    spis_control->spis_semaphore_owned = true;
+    spis_control->ring_mode = false;
+    spis_control->ring.set_semaphore_owned(true);
+    spis_control->ring.assign(spis_control->transfer_slots.data(),
+                              spis_control->transfer_slots.size());
 
     spis_control->spis_registers->INTENSET = spis_interrupt_mask;
 
@@ -466,35 +326,16 @@ void spis_deinit(spi_port_t spi_port)
     }
 }
 
-/* Enqueue a DMA buffer for SPIS transfer.
- * This function should only be called when:
- * - There is a valid buffer to queue.
- * - The SPIS semaphore is owned by firmware (not the CPU).
- * This function will release the SPIS semaphore.
+/**
+ * Pend the SPIS IRQ when the ISR holds the semaphore waiting for a slot.
+ * The ISR arms the slot and releases the semaphore.
  */
-static void spis_arm_transfer(struct spis_control_block_t* spis_control)
+static void spis_ring_pend_irq(struct spis_control_block_t* spis_control)
 {
-    spis_buffer_t &buffer = spis_control->dma_buffer.buffer_to_queue();
-
-    spis_control->spis_registers->TXD.PTR    = buffer.miso_buffer.address;
-    spis_control->spis_registers->TXD.MAXCNT = buffer.miso_buffer.length;
-
-    spis_control->spis_registers->RXD.PTR    = buffer.mosi_buffer.address;
-    spis_control->spis_registers->RXD.MAXCNT = buffer.mosi_buffer.length;
-
-    // Release the SPI slave semaphore from CPU ownership.
-    spis_control->spis_semaphore_owned       = false;
-    spis_control->data_is_ready              = false;
-
-    // If buffer_index_enqueued is not in use then assign it to being used.
-    if (spis_control->dma_buffer.buffer_index_enqueued ==
-        spis_double_buffer_t::buffer_index_none)
+    if (spis_control->ring.pend_irq())
     {
-        spis_control->dma_buffer.buffer_index_enqueued =
-            spis_control->dma_buffer.buffer_index_to_queue;
+        NVIC_SetPendingIRQ(spis_control->irq_type);
     }
-
-    spis_control->spis_registers->TASKS_RELEASE = 1u;
 }
 
 bool spis_enable_transfer(spi_port_t  spi_port,
@@ -513,134 +354,132 @@ bool spis_enable_transfer(spi_port_t  spi_port,
     ASSERT(mosi_length > 0u);
     ASSERT(mosi_length <= max_dma_length);
 
-    logger &logger = logger::instance();
-
-    // Modify spis_control inside a critical section.
-    nordic::auto_critical_section cs;
+    if (spis_control->ring_mode)
+    {
+        return false;
+    }
 
-    uint8_t const next_queued_index = spis_control->dma_buffer.next_queued_index();
-    logger.debug("spis_enable_transfer, "
-                 "sem_owned: %u, next_q_idx: %u en_q_idx: %u",
-                 spis_control->spis_semaphore_owned, next_queued_index,
-                 spis_control->dma_buffer.buffer_index_enqueued);
-    if (next_queued_index == spis_control->dma_buffer.buffer_index_enqueued)
+    if (not spis_control->ring.queue(miso_buffer, miso_length,
+                                     mosi_buffer, mosi_length))
     {
         return false;       // All DMA buffers are in use.
     }
 
-    spis_control->dma_buffer.buffer_index_to_queue = next_queued_index;
-    spis_buffer_t &buffer = spis_control->dma_buffer.buffer_to_queue();
+    spis_ring_pend_irq(spis_control);
+    return true;
+}
 
-    buffer.miso_buffer.set(miso_buffer, miso_length);
-    buffer.mosi_buffer.set(mosi_buffer, mosi_length);
-    spis_control->data_is_ready = true;
+bool spis_ring_start(spi_port_t          spi_port,
+                     struct spis_slot_t* slots,
+                     size_t              slot_count)
+{
+    struct spis_control_block_t* const spis_control = spis_control_block(spi_port);
+    ASSERT(spis_control);
+    ASSERT(spis_is_initialized(spis_control));
+    ASSERT(slots);
 
-    if (spis_control->spis_semaphore_owned)
+    for (struct spis_slot_t const* slot = slots; slot < slots + slot_count; ++slot)
     {
-        // If we own the semaphore it means that the SPIS peripheral is waiting
-        // for the software to load the Rx, Tx buffers.
-        // Load the Rx, Tx buffers and release the semaphore.
-        spis_arm_transfer(spis_control);
+        ASSERT(is_valid_ram(slot->miso_pointer, slot->miso_length));
+        ASSERT((slot->miso_length > 0u) && (slot->miso_length <= max_dma_length));
+        ASSERT(is_valid_ram(slot->mosi_pointer, slot->mosi_length));
+        ASSERT((slot->mosi_length > 0u) && (slot->mosi_length <= max_dma_length));
     }
-    else
+
+    if (spis_control->ring_mode || (not spis_control->ring.is_idle()))
     {
-        // Request ownership of the spis semaphore.
-        // When the EVENTS_ACQUIRED gets triggered in the ISR,
-        // the firmware owns the semaphore.
-        spis_control->spis_registers->TASKS_ACQUIRE = 1u;
+        return false;
     }
 
-    // Note: Either TASKS_RELEASE (releasing  semaphore) or
-    //              TASKS_ACQUIRE (requesting semaphore)
-    // was set based on whether the semaphore was owned.
+    // The ring is idle: the ISR holds the semaphore and does not access
+    // the slots. Mask the SPIS IRQ while the slots are replaced.
+    NVIC_DisableIRQ(spis_control->irq_type);
+    spis_control->ring_mode = true;
+    spis_control->ring.assign(slots, slot_count);
+    spis_control->ring.queue_all();
+    NVIC_EnableIRQ(spis_control->irq_type);
+
+    spis_ring_pend_irq(spis_control);
     return true;
 }
 
+struct spis_slot_t* spis_ring_front(spi_port_t spi_port)
+{
+    struct spis_control_block_t* const spis_control = spis_control_block(spi_port);
+    ASSERT(spis_control);
+    ASSERT(spis_control->ring_mode);
+
+    return spis_control->ring.front();
+}
+
+void spis_ring_release(spi_port_t spi_port)
+{
+    struct spis_control_block_t* const spis_control = spis_control_block(spi_port);
+    ASSERT(spis_control);
+    ASSERT(spis_control->ring_mode);
+
+    bool const requeue = true;
+    spis_control->ring.release(requeue);
+    spis_ring_pend_irq(spis_control);
+}
+
+struct spis_ring_statistics_t spis_ring_statistics(spi_port_t spi_port)
+{
+    struct spis_control_block_t* const spis_control = spis_control_block(spi_port);
+    ASSERT(spis_control);
+
+    return spis_control->ring.statistics();
+}
+
 /**
- * @note Since multiple events can be pending for processing,
- *       the correct event processing order is:
- * - SPI semaphore   acquired event.
- * - SPI transaction complete event.
+ * The SPIS semaphore is acquired (by the END_ACQUIRE shortcut) and released
+ * within the ISR only; @see class spis_ring.
+ * The event handler is called without a critical section held.
  */
 static void irq_handler_spis(spis_control_block_t* spis_control)
 {
-    logger &logger = logger::instance();
-
-    // Handle the ISR in a critical section; unlocking the CS on event callbacks.
-    nordic::critical_section cs;
-    cs.enter();
+    std::size_t const queued = spis_control->ring.queued();
+    struct spis_slot_t const* const completed =
+        spis_control->ring.irq_handler(*spis_control->spis_registers);
+    bool const armed = (spis_control->ring.queued() < queued);
 
-    if (spis_control->spis_registers->EVENTS_ACQUIRED)
+    if (completed)
     {
-        // The CPU acquires the semaphore when the ACQUIRED event is received.
-        spis_clear_event_register(&spis_control->spis_registers->EVENTS_ACQUIRED);
-        spis_control->spis_semaphore_owned = true;
-
-        logger.debug("spis_irq: EVENTS_ACQUIRED, "
-                     "data ready: %u, to_q_idx: %u en_q_idx: %u",
-                     spis_control->data_is_ready,
-                     spis_control->dma_buffer.buffer_index_to_queue,
-                     spis_control->dma_buffer.buffer_index_enqueued);
+        struct spi_event_t const event = {
+            .type         = spi_event_transfer_complete,
+            .mosi_pointer = completed->mosi_pointer,
+            .mosi_length  = completed->mosi_amount,
+            .miso_pointer = completed->miso_pointer,
+            .miso_length  = completed->miso_amount
+        };
 
-        if (spis_control->data_is_ready)
+        // spis_enable_transfer() buffers are returned to the client with
+        // the completion event. Release the slot first so that the client
+        // can queue its next transfer from within the handler.
+        if (not spis_control->ring_mode)
         {
-            spis_arm_transfer(spis_control);
+            bool const requeue = false;
+            spis_control->ring.release(requeue);
         }
 
-        // If there is room for another DMA buffer to be queued as pending then
-        // notify the client that we can accept new data.
-        uint8_t const next_queued_index = spis_control->dma_buffer.next_queued_index();
-        if (next_queued_index != spis_control->dma_buffer.buffer_index_enqueued)
-        {
-            // Notify the client that the current buffer that was queued.
-            spis_buffer_t const &buffer = spis_control->dma_buffer.buffer_to_queue();
-            struct spi_event_t const event = {
-                .type         = spi_event_data_ready,
-                .mosi_pointer = buffer.mosi_buffer.get_pointer(),
-                .mosi_length  = buffer.mosi_buffer.length,
-                .miso_pointer = buffer.miso_buffer.get_pointer(),
-                .miso_length  = buffer.miso_buffer.length
-            };
-
-            cs.exit();
-            spis_control->handler(&event, spis_control->context);
-            cs.enter();
-        }
+        spis_control->handler(&event, spis_control->context);
     }
 
-    // Check for SPI transaction complete event.
-    if (spis_control->spis_registers->EVENTS_END)
+    // Notify a spis_enable_transfer() client when the armed buffer leaves
+    // room to queue another.
+    if (armed && (not spis_control->ring_mode) && (spis_control->ring.available() > 0u))
     {
-        logger.debug("spis_irq: EVENTS_END, "
-                     "data ready: %u, to_q_idx: %u en_q_idx: %u",
-                     spis_control->data_is_ready,
-                     spis_control->dma_buffer.buffer_index_to_queue,
-                     spis_control->dma_buffer.buffer_index_enqueued);
-
-        // The SPI data transfer has completed.
-        spis_clear_event_register(&spis_control->spis_registers->EVENTS_END);
-
-        // Notify the client that the MOSI, MISO buffer buffers have been
-        // used to complete a SPIS transfer.
-        spis_buffer_t &buffer = spis_control->dma_buffer.buffer_enqueued();
-
+        struct spis_slot_t const* const slot = spis_control->ring.armed();
         struct spi_event_t const event = {
-            .type         = spi_event_transfer_complete,
-            .mosi_pointer = buffer.mosi_buffer.get_pointer(),
-            .mosi_length  = spis_control->spis_registers->RXD.AMOUNT,
-            .miso_pointer = buffer.miso_buffer.get_pointer(),
-            .miso_length  = spis_control->spis_registers->TXD.AMOUNT
+            .type         = spi_event_data_ready,
+            .mosi_pointer = slot->mosi_pointer,
+            .mosi_length  = slot->mosi_length,
+            .miso_pointer = slot->miso_pointer,
+            .miso_length  = slot->miso_length
         };
 
-        spis_control->dma_buffer.buffer_index_enqueued =
-            spis_control->dma_buffer.next_enqueued_index();
-
-        cs.exit();
         spis_control->handler(&event, spis_control->context);
-        cs.enter();
     }
-
-    cs.exit();
 }
 
 static void gpio_te_pin_event_handler(gpio_te_channel_t gpio_te_channel,
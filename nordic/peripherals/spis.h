@@ -14,6 +14,37 @@
 extern "C" {
 #endif
 
+/**
+ * @struct spis_slot_t
+ * A SPIS transfer slot: the MISO and MOSI DMA buffers of one transaction.
+ * Slots are owned by the application and lent to the driver.
+ */
+struct spis_slot_t
+{
+    void const* miso_pointer;   ///< The data sent to the master.
+    size_t      miso_length;    ///< The MISO buffer length.
+    void*       mosi_pointer;   ///< The data received from the master.
+    size_t      mosi_length;    ///< The MOSI buffer length.
+    size_t      miso_amount;    ///< The MISO bytes sent; set on completion.
+    size_t      mosi_amount;    ///< The MOSI bytes received; set on completion.
+};
+
+/**
+ * @struct spis_ring_statistics_t
+ */
+struct spis_ring_statistics_t
+{
+    /// The number of completed transfers.
+    uint32_t transfer_count;
+
+    /// The number of times a transfer ended with no slot queued to arm.
+    /// Master transactions are not received until a slot is released.
+    uint32_t starved_count;
+
+    /// The maximum number of completed slots held by the application.
+    uint32_t depth_max;
+};
+
 /**
  * Initialize the SPIS driver for operation.
  *
@@ -60,12 +91,48 @@ void spis_deinit(spi_port_t spi_port);
  * @return bool       true  If the buffer was successfully queued for SPI slave
  *                          transfers.
  *                    false If the buffer could not be queued. This happens if
- *                    more than 2 buffers are queued at a time.
+ *                    more than 2 buffers are queued at a time or if the
+ *                    SPIS is transferring with spis_ring_start().
  */
 bool spis_enable_transfer(spi_port_t  spi_port,
                           void const* miso_buffer, size_t miso_length,
                           void*       mosi_buffer, size_t mosi_length);
 
+/**
+ * Start SPIS transfers using a ring of transfer slots, in place of
+ * spis_enable_transfer(). Every slot is queued for transfer.
+ *
+ * The event handler receives spi_event_transfer_complete as each slot
+ * completes. The application then owns the slot, obtained by reference from
+ * spis_ring_front(), until it is returned with spis_ring_release();
+ * the slot is then queued again with the same buffers.
+ *
+ * @param spi_port   The SPIS device to use for transfer.
+ * @param slots      The transfer slots with their MISO and MOSI buffers set.
+ *                   The slots must remain valid while the SPIS is in use.
+ * @param slot_count The number of slots; a power of 2.
+ *
+ * @return bool true if the ring was started. false if transfers are already
+ *              queued by spis_enable_transfer().
+ */
+bool spis_ring_start(spi_port_t          spi_port,
+                     struct spis_slot_t* slots,
+                     size_t              slot_count);
+
+/**
+ * @return struct spis_slot_t* The oldest completed slot held by the
+ *         application; nullptr if there is none.
+ */
+struct spis_slot_t* spis_ring_front(spi_port_t spi_port);
+
+/**
+ * Return the slot obtained by spis_ring_front() to the driver.
+ * The slot is queued for transfer with its buffers.
+ */
+void spis_ring_release(spi_port_t spi_port);
+
+struct spis_ring_statistics_t spis_ring_statistics(spi_port_t spi_port);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,321 @@
+/**
+ * @file spis_ring.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The SPIS DMA buffer ring: N transfer slots handed between the application
+ * and the SPIS peripheral without copies and without critical sections.
+ */
+
+#pragma once
+
+#include "spis.h"
+#include "project_assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class spis_ring
+ * A ring of spis_slot_t transfer buffers. Each slot passes through:
+ *
+ *   queued     The application gave the slot buffers to the driver.
+ *   armed      The slot buffers are loaded into the SPIS DMA registers.
+ *   complete   The transfer completed; the application owns the slot.
+ *   released   The application returned the slot.
+ *
+ * The slots advance in ring order and the state of each is given by four
+ * free running indices; release <= complete <= arm <= queue <= release + N.
+ * The application writes queue_index_ and release_index_; the ISR writes
+ * arm_index_ and complete_index_. Neither side needs a critical section.
+ *
+ * The SPIS semaphore is acquired and released only within the ISR:
+ * - The END_ACQUIRE shortcut hands the semaphore to the CPU when a transfer
+ *   ends; the ISR loads the next queued slot and releases the semaphore.
+ * - When no slot is queued the ISR keeps the semaphore and the ring is
+ *   starved: master transactions are not received by the slave until the
+ *   application queues or releases a slot. The application then pends the
+ *   SPIS IRQ so that the ISR arms the slot.
+ *
+ * @note The starved flag relies on the ISR running to completion with
+ *       respect to the application; as on a single core Cortex-M.
+ */
+class spis_ring
+{
+public:
+    ~spis_ring()                                = default;
+
+    spis_ring(spis_ring const&)                 = delete;
+    spis_ring(spis_ring &&)                     = delete;
+    spis_ring& operator=(spis_ring const&)      = delete;
+    spis_ring& operator=(spis_ring&&)           = delete;
+
+    spis_ring()
+    :   slots_(nullptr),
+        slot_count_(0u),
+        queue_index_(0u),
+        arm_index_(0u),
+        complete_index_(0u),
+        release_index_(0u),
+        semaphore_owned_(false),
+        starved_(false),
+        starved_count_(0u),
+        depth_max_(0u)
+    {
+    }
+
+    /**
+     * Assign the slots of the ring. All slots are free.
+     * @param slots      The transfer slots; the application owns the storage.
+     * @param slot_count The number of slots; a power of 2 so that the free
+     *                   running indices remain valid when they wrap.
+     */
+    void assign(struct spis_slot_t* slots, std::size_t slot_count)
+    {
+        ASSERT(slots);
+        ASSERT((slot_count > 0u) && ((slot_count & (slot_count - 1u)) == 0u));
+
+        this->slots_        = slots;
+        this->slot_count_   = static_cast<uint32_t>(slot_count);
+        this->queue_index_.store(0u, std::memory_order_relaxed);
+        this->arm_index_.store(0u, std::memory_order_relaxed);
+        this->complete_index_.store(0u, std::memory_order_relaxed);
+        this->release_index_.store(0u, std::memory_order_relaxed);
+        this->starved_.store(this->semaphore_owned_, std::memory_order_relaxed);
+        this->starved_count_    = 0u;
+        this->depth_max_        = 0u;
+    }
+
+    /**
+     * The semaphore is owned by the CPU when the SPIS is enabled.
+     * @param owned true if the CPU owns the SPIS semaphore.
+     */
+    void set_semaphore_owned(bool owned)
+    {
+        this->semaphore_owned_ = owned;
+        this->starved_.store(owned, std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const { return this->slot_count_; }
+
+    /**
+     * Application: queue the next free slot with transfer buffers.
+     *
+     * @return bool true if queued; false if all slots are in use.
+     * @note When pend_irq() returns true the SPIS IRQ must be pended so that
+     *       the ISR arms the slot.
+     */
+    bool queue(void const* miso_pointer, std::size_t miso_length,
+               void*       mosi_pointer, std::size_t mosi_length)
+    {
+        uint32_t const queue_index   = this->queue_index_.load(std::memory_order_relaxed);
+        uint32_t const release_index = this->release_index_.load(std::memory_order_relaxed);
+        if (queue_index - release_index >= this->slot_count_)
+        {
+            return false;
+        }
+
+        struct spis_slot_t& slot = this->slot(queue_index);
+        slot.miso_pointer   = miso_pointer;
+        slot.miso_length    = miso_length;
+        slot.mosi_pointer   = mosi_pointer;
+        slot.mosi_length    = mosi_length;
+        slot.miso_amount    = 0u;
+        slot.mosi_amount    = 0u;
+
+        this->queue_index_.store(queue_index + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Application: queue every slot with the buffers already assigned to it.
+     * @return std::size_t The number of slots queued.
+     */
+    std::size_t queue_all()
+    {
+        std::size_t count = 0u;
+        while (this->queue_index_.load(std::memory_order_relaxed) -
+               this->release_index_.load(std::memory_order_relaxed) < this->slot_count_)
+        {
+            struct spis_slot_t const& slot =
+                this->slot(this->queue_index_.load(std::memory_order_relaxed));
+            this->queue(slot.miso_pointer, slot.miso_length,
+                        slot.mosi_pointer, slot.mosi_length);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * Application: the oldest completed slot, by reference.
+     * @return spis_slot_t* The slot; nullptr if no completed slot is held.
+     */
+    struct spis_slot_t* front()
+    {
+        uint32_t const release_index  = this->release_index_.load(std::memory_order_relaxed);
+        uint32_t const complete_index = this->complete_index_.load(std::memory_order_acquire);
+        return (release_index == complete_index) ? nullptr : &this->slot(release_index);
+    }
+
+    /**
+     * Application: return the slot obtained from front() to the ring.
+     * @param requeue When true the slot is queued again with its buffers.
+     */
+    void release(bool requeue)
+    {
+        uint32_t const release_index = this->release_index_.load(std::memory_order_relaxed);
+        ASSERT(release_index != this->complete_index_.load(std::memory_order_acquire));
+
+        struct spis_slot_t const& slot = this->slot(release_index);
+        this->release_index_.store(release_index + 1u, std::memory_order_release);
+
+        if (requeue)
+        {
+            // With every slot queued the next slot to queue is the one
+            // just released; its buffers are unchanged.
+            ASSERT(&this->slot(this->queue_index_.load(std::memory_order_relaxed)) == &slot);
+            this->queue(slot.miso_pointer, slot.miso_length,
+                        slot.mosi_pointer, slot.mosi_length);
+        }
+    }
+
+    /**
+     * Application: after queue() or release(), whether the ISR is waiting
+     * for a slot and the SPIS IRQ must be pended.
+     */
+    bool pend_irq() const { return this->starved_.load(); }
+
+    /**
+     * ISR: process the SPIS END and ACQUIRED events and arm the next slot.
+     *
+     * @param spis_registers The SPIS registers; NRF_SPIS_Type on the target.
+     * @return spis_slot_t* The slot whose transfer completed;
+     *         nullptr if no transfer completed.
+     */
+    template <typename spis_registers_type>
+    struct spis_slot_t* irq_handler(spis_registers_type& spis_registers)
+    {
+        struct spis_slot_t* completed = nullptr;
+
+        if (spis_registers.EVENTS_END)
+        {
+            spis_registers.EVENTS_END = 0u;
+            (void) spis_registers.EVENTS_END;
+
+            uint32_t const complete_index = this->complete_index_.load(std::memory_order_relaxed);
+            ASSERT(complete_index != this->arm_index_.load(std::memory_order_relaxed));
+
+            completed = &this->slot(complete_index);
+            completed->mosi_amount = spis_registers.RXD.AMOUNT;
+            completed->miso_amount = spis_registers.TXD.AMOUNT;
+            this->complete_index_.store(complete_index + 1u, std::memory_order_release);
+
+            uint32_t const depth =
+                complete_index + 1u - this->release_index_.load(std::memory_order_relaxed);
+            if (depth > this->depth_max_) { this->depth_max_ = depth; }
+        }
+
+        if (spis_registers.EVENTS_ACQUIRED)
+        {
+            spis_registers.EVENTS_ACQUIRED = 0u;
+            (void) spis_registers.EVENTS_ACQUIRED;
+            this->semaphore_owned_ = true;
+        }
+
+        if (this->semaphore_owned_)
+        {
+            uint32_t const arm_index   = this->arm_index_.load(std::memory_order_relaxed);
+            uint32_t const queue_index = this->queue_index_.load(std::memory_order_acquire);
+            if (arm_index != queue_index)
+            {
+                struct spis_slot_t const& slot = this->slot(arm_index);
+                spis_registers.TXD.PTR    = reinterpret_cast<uintptr_t>(slot.miso_pointer);
+                spis_registers.TXD.MAXCNT = slot.miso_length;
+                spis_registers.RXD.PTR    = reinterpret_cast<uintptr_t>(slot.mosi_pointer);
+                spis_registers.RXD.MAXCNT = slot.mosi_length;
+
+                this->arm_index_.store(arm_index + 1u, std::memory_order_relaxed);
+                this->starved_.store(false);
+                this->semaphore_owned_ = false;
+                spis_registers.TASKS_RELEASE = 1u;
+            }
+            else if (not this->starved_.load(std::memory_order_relaxed))
+            {
+                this->starved_.store(true);
+                this->starved_count_ += 1u;
+            }
+        }
+
+        return completed;
+    }
+
+    /// @return The number of completed slots not yet released.
+    std::size_t depth() const {
+        return this->complete_index_.load(std::memory_order_acquire) -
+               this->release_index_.load(std::memory_order_acquire);
+    }
+
+    /// @return The number of queued slots not yet armed.
+    std::size_t queued() const {
+        return this->queue_index_.load(std::memory_order_acquire) -
+               this->arm_index_.load(std::memory_order_acquire);
+    }
+
+    /// @return The number of slots which may be queued.
+    std::size_t available() const {
+        return this->slot_count_ -
+               (this->queue_index_.load(std::memory_order_acquire) -
+                this->release_index_.load(std::memory_order_acquire));
+    }
+
+    /// @return true if no slot is queued, armed or held by the application.
+    bool is_idle() const {
+        return this->queue_index_.load(std::memory_order_acquire) ==
+               this->release_index_.load(std::memory_order_acquire);
+    }
+
+    /// @return The slot most recently armed; nullptr if none has been.
+    struct spis_slot_t const* armed() const {
+        uint32_t const arm_index = this->arm_index_.load(std::memory_order_acquire);
+        return (arm_index == 0u) ? nullptr : &this->slot(arm_index - 1u);
+    }
+
+    bool is_starved() const { return this->starved_.load(std::memory_order_relaxed); }
+
+    struct spis_ring_statistics_t statistics() const
+    {
+        struct spis_ring_statistics_t const stats = {
+            .transfer_count = this->complete_index_.load(std::memory_order_relaxed),
+            .starved_count  = this->starved_count_,
+            .depth_max      = this->depth_max_,
+        };
+        return stats;
+    }
+
+private:
+    struct spis_slot_t& slot(uint32_t index) {
+        return this->slots_[index & (this->slot_count_ - 1u)];
+    }
+
+    struct spis_slot_t const& slot(uint32_t index) const {
+        return this->slots_[index & (this->slot_count_ - 1u)];
+    }
+
+    struct spis_slot_t*     slots_;
+    uint32_t                slot_count_;
+
+    std::atomic<uint32_t>   queue_index_;
+    std::atomic<uint32_t>   arm_index_;
+    std::atomic<uint32_t>   complete_index_;
+    std::atomic<uint32_t>   release_index_;
+
+    /// Written only by the ISR, except before the SPIS IRQ is enabled.
+    bool                    semaphore_owned_;
+
+    /// The ISR owns the semaphore and has no slot to arm.
+    std::atomic<bool>       starved_;
+
+    /// Statistics are written only by the ISR.
+    uint32_t volatile       starved_count_;
+    uint32_t volatile       depth_max_;
+};
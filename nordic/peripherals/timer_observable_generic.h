@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <boost/intrusive/list.hpp>
 
+#include "profile.h"
 #include "project_assert.h"
 
 /**
@@ -251,6 +252,48 @@ public:
         observer.observable_ = nullptr;
     }
 
+    /**
+     * The ticks until the earliest attached observer expires.
+     * Used by the run loop to choose how deeply to sleep.
+     * One-shot observers which have already expired are skipped.
+     *
+     * @note Call with the timer interrupt masked, such as within a critical
+     * section: the ISR updates the observer list and remaining ticks.
+     *
+     * @param timer_count The current timer count.
+     *
+     * @return uint32_t The ticks until the next expiration; zero if an
+     *                  expiration is late.
+     * @retval UINT32_MAX No observer expiration is pending.
+     */
+    uint32_t ticks_until_expiration(uint32_t timer_count) const
+    {
+        uint32_t const counter_mask = (timer_type::counter_width < 32u) ?
+            ((1u << timer_type::counter_width) - 1u) : UINT32_MAX ;
+
+        uint32_t ticks_next = UINT32_MAX;
+        for (cc_index_t cc_index = 0u; cc_index < this->cc_alloc_count; ++cc_index)
+        {
+            uint32_t const ticks_elapsed = (timer_count -
+                this->cc_assoc_[cc_index].last_ticks_count_) & counter_mask;
+
+            for (observer_type const& observer : this->cc_assoc_[cc_index].observer_list_)
+            {
+                if (observer.one_shot_has_expired())
+                {
+                    continue;
+                }
+
+                int32_t const ticks_remain =
+                    static_cast<int32_t>(observer.ticks_remaining_ - ticks_elapsed);
+                uint32_t const ticks = (ticks_remain < 0) ? 0u : static_cast<uint32_t>(ticks_remain);
+                ticks_next = std::min(ticks, ticks_next);
+            }
+        }
+
+        return ticks_next;
+    }
+
     void detach_exclusve(observer_type& observer)
     {
         ASSERT(this->cc_assoc_[observer.cc_index_].exclusive_owner == &observer);
@@ -355,6 +398,8 @@ private:
      */
     uint32_t ticks_update(cc_index_t cc_index, uint32_t cc_count)
     {
+        PROFILE_ZONE("ticks_update");
+
         uint32_t const counter_mask = (timer_type::counter_width < 32u) ?
             ((1u << timer_type::counter_width) - 1u) : UINT32_MAX ;
 
@@ -6,6 +6,7 @@
  */
 
 #include "twis.h"
+#include "twis_register_map.h"
 #include "gpio.h"
 #include "logger.h"
 #include "nrf_cmsis.h"
@@ -55,6 +56,9 @@ struct twis_control_block_t
         handler(nullptr),
         context(nullptr),
         transfer_state(transfer_state::ready),
+        register_map(),
+        register_map_handler(nullptr),
+        register_map_mode(false),
         pin_scl(twi_pin_uninitialized),
         pin_sda(twi_pin_uninitialized)
     {
@@ -93,6 +97,12 @@ struct twis_control_block_t
     /// This volatile flag allows for interrupt/task resource arbitration.
     volatile enum transfer_state transfer_state;
 
+    /// The register map serving the master when register_map_mode is set;
+    /// @see twis_register_map_start().
+    twis_register_map<twis_register_write_max> register_map;
+    twis_register_map_handler_t register_map_handler;
+    bool register_map_mode;
+
     /** @{ The I2C clock and data registers.
      * @see OPS 1.4, 33.7 Master mode pin configuration page 310
      * The PSEL.SCL and PSEL.SDA registers and their configurations are only
@@ -229,7 +239,8 @@ enum twi_result_t twis_init(twi_port_t                  twi_port,
     NVIC_SetPriority(twis_control->irq_type, twis_config->irq_priority);
     NVIC_ClearPendingIRQ(twis_control->irq_type);
 
-    twis_control->transfer_state = transfer_state::ready;
+    twis_control->transfer_state    = transfer_state::ready;
+    twis_control->register_map_mode = false;
 
     return result_code;
 }
@@ -241,6 +252,7 @@ void twis_deinit(twi_port_t twi_port)
     ASSERT(twis_is_initialized(twis_control));
 
     twis_abort_transfer(twi_port);
+    twis_control->register_map_mode = false;
     twis_control->twis_registers->ENABLE = (TWIS_ENABLE_ENABLE_Disabled << TWIS_ENABLE_ENABLE_Pos);
 }
 
@@ -315,6 +327,11 @@ enum twi_result_t twis_enable_read(twi_port_t   twi_port,
 
     enum twi_result_t result = twi_result_success;
 
+    if (twis_control->register_map_mode)
+    {
+        return twi_result_invalid_state;
+    }
+
     if (twis_control->transfer_state != transfer_state::ready)
     {
         result = (twis_control->transfer_state == transfer_state::rx_busy)
@@ -366,6 +383,11 @@ enum twi_result_t twis_enable_write(twi_port_t  twi_port,
 
     enum twi_result_t result = twi_result_success;
 
+    if (twis_control->register_map_mode)
+    {
+        return twi_result_invalid_state;
+    }
+
     if (twis_control->transfer_state != transfer_state::ready)
     {
         result = (twis_control->transfer_state == transfer_state::rx_busy)
@@ -403,6 +425,55 @@ enum twi_result_t twis_enable_write(twi_port_t  twi_port,
     return result;
 }
 
+enum twi_result_t twis_register_map_start(twi_port_t                  twi_port,
+                                          void*                       registers,
+                                          size_t                      length,
+                                          size_t                      writable_length,
+                                          twis_register_map_handler_t handler,
+                                          void*                       context)
+{
+    struct twis_control_block_t* const twis_control = twis_control_block(twi_port);
+
+    ASSERT(twis_control);
+    ASSERT(twis_is_initialized(twis_control));
+    ASSERT(is_valid_ram(registers, length));
+
+    if (twis_control->transfer_state != transfer_state::ready)
+    {
+        return (twis_control->transfer_state == transfer_state::rx_busy)
+            ? twi_result_rx_busy : twi_result_tx_busy;
+    }
+
+    NVIC_DisableIRQ(twis_control->irq_type);
+    twis_control->twis_registers->INTEN = 0u;
+    twis_events_clear_all(twis_control);
+
+    twis_control->register_map.assign(registers, length, writable_length);
+    twis_control->register_map_handler = handler;
+    twis_control->context              = context;
+    twis_control->register_map_mode    = true;
+
+    // The TWIS stretches the clock after the READ and WRITE events until
+    // the ISR has armed the DMA.
+    twis_control->twis_registers->INTENSET = TWIS_INTENSET_READ_Msk      |
+                                             TWIS_INTENSET_WRITE_Msk     |
+                                             TWIS_INTENSET_ERROR_Msk     |
+                                             TWIS_INTENSET_STOPPED_Msk   ;
+
+    NVIC_ClearPendingIRQ(twis_control->irq_type);
+    NVIC_EnableIRQ(twis_control->irq_type);
+
+    return twi_result_success;
+}
+
+struct twis_register_map_statistics_t twis_register_map_statistics(twi_port_t twi_port)
+{
+    struct twis_control_block_t* const twis_control = twis_control_block(twi_port);
+    ASSERT(twis_control);
+
+    return twis_control->register_map.statistics();
+}
+
 /** @todo untested, needs work. */
 void twis_abort_transfer(twi_port_t twi_port)
 {
@@ -430,8 +501,29 @@ void twis_abort_transfer(twi_port_t twi_port)
     twis_events_clear_all(twis_control);
 }
 
+/**
+ * Serve the master from the register map within the ISR.
+ * The application is called only when registers have been written.
+ */
+static void irq_handler_twis_register_map(struct twis_control_block_t* twis_control)
+{
+    struct twis_register_range_t const dirty =
+        twis_control->register_map.irq_handler(*twis_control->twis_registers);
+
+    if ((dirty.begin != dirty.end) && twis_control->register_map_handler)
+    {
+        twis_control->register_map_handler(&dirty, twis_control->context);
+    }
+}
+
 static void irq_handler_twis(struct twis_control_block_t* twis_control)
 {
+    if (twis_control->register_map_mode)
+    {
+        irq_handler_twis_register_map(twis_control);
+        return;
+    }
+
     logger &logger = logger.instance();
     logger.debug("+++ %s", __func__);
 
@@ -107,6 +107,65 @@ enum twi_result_t twis_enable_write(twi_port_t      twi_port,
                                     void*           rx_buffer,
                                     dma_size_t      rx_buffer_length);
 
+/// The maximum number of register bytes written by the master in one
+/// register map transaction, following the register address byte.
+#define twis_register_write_max  (32u)
+
+/**
+ * @struct twis_register_range_t
+ * A range of register file offsets [begin, end).
+ */
+struct twis_register_range_t
+{
+    uint16_t    begin;
+    uint16_t    end;
+};
+
+struct twis_register_map_statistics_t
+{
+    uint32_t    write_count;    ///< Master write transactions.
+    uint32_t    read_count;     ///< Master read transactions.
+    uint32_t    error_count;    ///< TWIS ERROR events: overflow, overread.
+};
+
+/**
+ * @brief The register map handler: called from the ISR with the range of
+ * registers written by the master.
+ */
+typedef void (* twis_register_map_handler_t) (
+    struct twis_register_range_t const* dirty,
+    void*                               context);
+
+/**
+ * Serve the TWI master from a register file in RAM, in place of
+ * twis_enable_read() and twis_enable_write().
+ *
+ * The first byte written by the master in a transaction sets the register
+ * address pointer. The data bytes which follow are written to the register
+ * file at the pointer. Data read by the master is sent directly from the
+ * register file at the pointer. The pointer increments with each byte.
+ *
+ * @param twi_port        The TWI port index.
+ * @param registers       The register file. Must remain valid while the
+ *                        TWIS is in use.
+ * @param length          The register file length; at most 256 bytes.
+ * @param writable_length The length of the registers which the master may
+ *                        write, from offset 0. Registers above are read only.
+ * @param handler         Notified of the registers written; may be nullptr.
+ * @param context         The handler context.
+ *
+ * @return enum twi_result_t twi_result_success, or the busy code when a
+ *         twis_enable_read() or twis_enable_write() transfer is in progress.
+ */
+enum twi_result_t twis_register_map_start(twi_port_t                  twi_port,
+                                          void*                       registers,
+                                          size_t                      length,
+                                          size_t                      writable_length,
+                                          twis_register_map_handler_t handler,
+                                          void*                       context);
+
+struct twis_register_map_statistics_t twis_register_map_statistics(twi_port_t twi_port);
+
 /**
  * Abort a tranfer in progress.
  *
@@ -0,0 +1,264 @@
+/**
+ * @file twis_register_map.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The TWIS register map: an I2C device register file in RAM accessed by the
+ * TWI master through an auto-incrementing register address pointer.
+ */
+
+#pragma once
+
+#include "twis.h"
+#include "project_assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @class twis_register_map
+ * Serve the TWI master transactions on a register file without involving
+ * the application:
+ *
+ *   write: [address] [data ...]    Set the register address pointer and
+ *                                  write data at the pointer, incrementing it.
+ *   read:  [data ...]              Read data at the pointer, incrementing it.
+ *
+ * A read is typically preceded by a write of the address byte alone,
+ * either with a repeated start or as a separate transaction.
+ *
+ * Reads are transferred by EasyDMA directly out of the register file at the
+ * register pointer. The TWIS receives a write into a single DMA buffer;
+ * RXD.PTR cannot be moved once the address byte has arrived. The write data
+ * is therefore applied to the register file within the ISR, once, and
+ * the application is notified only of the range of registers written.
+ *
+ * The TWIS stretches the clock from the READ and WRITE events until the ISR
+ * triggers the PREPARETX and PREPARERX tasks. There is no application round
+ * trip per transaction.
+ *
+ * @tparam write_length_max The maximum number of data bytes written by the
+ *                          master in one transaction. Bytes beyond this
+ *                          are NACKed by the TWIS and reported as overflow.
+ */
+template <std::size_t write_length_max>
+class twis_register_map
+{
+public:
+    ~twis_register_map()                                        = default;
+
+    twis_register_map(twis_register_map const&)                 = delete;
+    twis_register_map(twis_register_map &&)                     = delete;
+    twis_register_map& operator=(twis_register_map const&)      = delete;
+    twis_register_map& operator=(twis_register_map&&)           = delete;
+
+    twis_register_map()
+    :   registers_(nullptr),
+        length_(0u),
+        writable_length_(0u),
+        pointer_(0u),
+        rx_pending_(false),
+        tx_pending_(false),
+        rx_buffer_{},
+        stats_{}
+    {
+    }
+
+    /**
+     * Assign the register file.
+     *
+     * @param registers       The register file; the application owns it.
+     * @param length          The register file length in bytes. Since the
+     *                        register address is one byte the length is at
+     *                        most 256 bytes.
+     * @param writable_length The registers at offsets [0, writable_length)
+     *                        may be written by the master. The registers
+     *                        above are read only; status registers.
+     */
+    void assign(void* registers, std::size_t length, std::size_t writable_length)
+    {
+        ASSERT(registers);
+        ASSERT((length > 0u) && (length <= UINT8_MAX + 1u));
+        ASSERT(writable_length <= length);
+
+        this->registers_        = static_cast<uint8_t*>(registers);
+        this->length_           = static_cast<uint16_t>(length);
+        this->writable_length_  = static_cast<uint16_t>(writable_length);
+        this->pointer_          = 0u;
+        this->rx_pending_       = false;
+        this->tx_pending_       = false;
+        this->stats_            = twis_register_map_statistics_t{};
+    }
+
+    /**
+     * ISR: process the TWIS events; arm the DMA for the transaction the
+     * master has started.
+     *
+     * @param twis_registers The TWIS registers; NRF_TWIS_Type on the target.
+     * @return twis_register_range_t The registers written by the master;
+     *         empty (begin == end) if none were written.
+     */
+    template <typename twis_registers_type>
+    struct twis_register_range_t irq_handler(twis_registers_type& twis_registers)
+    {
+        struct twis_register_range_t dirty = { 0u, 0u };
+
+        if (twis_registers.EVENTS_ERROR)
+        {
+            twis_registers.EVENTS_ERROR = 0u;
+            (void) twis_registers.EVENTS_ERROR;
+
+            // ERRORSRC bits are cleared by writing 1.
+            uint32_t const error_source = twis_registers.ERRORSRC;
+            twis_registers.ERRORSRC = error_source;
+            this->stats_.error_count += 1u;
+        }
+
+        // A transaction ends with a stop condition, or a repeated start
+        // followed by the READ or WRITE event.
+        if (twis_registers.EVENTS_STOPPED)
+        {
+            twis_registers.EVENTS_STOPPED = 0u;
+            (void) twis_registers.EVENTS_STOPPED;
+            dirty = this->transaction_end(twis_registers);
+        }
+
+        if (twis_registers.EVENTS_WRITE)
+        {
+            twis_registers.EVENTS_WRITE = 0u;
+            (void) twis_registers.EVENTS_WRITE;
+            dirty = range_union(dirty, this->transaction_end(twis_registers));
+
+            twis_registers.RXD.PTR    = reinterpret_cast<uintptr_t>(this->rx_buffer_.data());
+            twis_registers.RXD.MAXCNT = this->rx_buffer_.size();
+            this->rx_pending_ = true;
+            twis_registers.TASKS_PREPARERX = 1u;
+        }
+
+        if (twis_registers.EVENTS_READ)
+        {
+            twis_registers.EVENTS_READ = 0u;
+            (void) twis_registers.EVENTS_READ;
+            dirty = range_union(dirty, this->transaction_end(twis_registers));
+
+            // Past the end of the register file the TWIS sends ORC.
+            twis_registers.TXD.PTR    = reinterpret_cast<uintptr_t>(this->registers_ + this->pointer_);
+            twis_registers.TXD.MAXCNT = this->length_ - this->pointer_;
+            this->tx_pending_ = true;
+            twis_registers.TASKS_PREPARETX = 1u;
+        }
+
+        return dirty;
+    }
+
+    /// @return The register address pointer.
+    std::size_t pointer() const { return this->pointer_; }
+
+    struct twis_register_map_statistics_t const& statistics() const { return this->stats_; }
+
+private:
+    static struct twis_register_range_t range_union(struct twis_register_range_t lhs,
+                                                    struct twis_register_range_t rhs)
+    {
+        if (lhs.begin == lhs.end) { return rhs; }
+        if (rhs.begin == rhs.end) { return lhs; }
+        struct twis_register_range_t const range = {
+            .begin = std::min(lhs.begin, rhs.begin),
+            .end   = std::max(lhs.end,   rhs.end)
+        };
+        return range;
+    }
+
+    /**
+     * Account for the DMA transfer of the transaction which ended:
+     * apply a write to the register file; advance the pointer past a read.
+     */
+    template <typename twis_registers_type>
+    struct twis_register_range_t transaction_end(twis_registers_type const& twis_registers)
+    {
+        struct twis_register_range_t dirty = { 0u, 0u };
+
+        if (this->rx_pending_)
+        {
+            this->rx_pending_ = false;
+            std::size_t const amount = twis_registers.RXD.AMOUNT;
+            if (amount > 0u)
+            {
+                this->stats_.write_count += 1u;
+                this->pointer_ = std::min<uint16_t>(this->rx_buffer_[0u], this->length_);
+
+                std::size_t const data_length = amount - 1u;
+                uint16_t const begin = this->pointer_;
+                uint16_t const end   = static_cast<uint16_t>(
+                    std::min<std::size_t>(begin + data_length, this->writable_length_));
+                if (begin < end)
+                {
+                    std::memcpy(this->registers_ + begin, &this->rx_buffer_[1u], end - begin);
+                    dirty.begin = begin;
+                    dirty.end   = end;
+                }
+
+                this->pointer_ = static_cast<uint16_t>(
+                    std::min<std::size_t>(begin + data_length, this->length_));
+            }
+        }
+
+        if (this->tx_pending_)
+        {
+            this->tx_pending_ = false;
+            this->stats_.read_count += 1u;
+            this->pointer_ = static_cast<uint16_t>(
+                std::min<std::size_t>(this->pointer_ + twis_registers.TXD.AMOUNT, this->length_));
+        }
+
+        return dirty;
+    }
+
+    uint8_t*    registers_;
+    uint16_t    length_;
+    uint16_t    writable_length_;
+
+    /// The register address pointer; written only by the ISR.
+    uint16_t    pointer_;
+
+    /// A write or read DMA transfer is armed and not yet accounted for.
+    bool        rx_pending_;
+    bool        tx_pending_;
+
+    /// The address byte followed by the write data.
+    std::array<uint8_t, 1u + write_length_max>  rx_buffer_;
+
+    struct twis_register_map_statistics_t       stats_;
+};
+
+/**
+ * Start the register map on a typed register file.
+ *
+ * @example
+ *     struct device_registers {
+ *         uint8_t  control;
+ *         uint16_t threshold;
+ *         uint8_t  status;            // read only
+ *     } __attribute__((packed));
+ *     static device_registers registers;
+ *     twis_register_map_start(0u, registers, offsetof(device_registers, status),
+ *                             registers_written, nullptr);
+ */
+template <typename register_file_type>
+enum twi_result_t twis_register_map_start(twi_port_t                  twi_port,
+                                          register_file_type&         registers,
+                                          std::size_t                 writable_length,
+                                          twis_register_map_handler_t handler,
+                                          void*                       context)
+{
+    static_assert(std::is_trivially_copyable<register_file_type>::value);
+    static_assert(std::is_standard_layout<register_file_type>::value);
+    static_assert(sizeof(register_file_type) <= UINT8_MAX + 1u,
+                  "the register address is one byte");
+
+    return twis_register_map_start(twi_port, &registers, sizeof(registers),
+                                   writable_length, handler, context);
+}
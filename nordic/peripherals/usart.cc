@@ -9,6 +9,9 @@
 #include "nrf_cmsis.h"
 #include "nordic_critical_section.h"
 #include "arm_utilities.h"
+#include "isr_profile.h"
+#include "memory_watermark.h"
+#include "profile.h"
 #include "project_assert.h"
 
 #include <algorithm>
@@ -110,7 +113,10 @@ struct usart_control_block_t
     usart_control_block_t& operator=(usart_control_block_t const&)  = delete;
     usart_control_block_t& operator=(usart_control_block_t&&)       = delete;
 
-    usart_control_block_t(uintptr_t base_address, IRQn_Type irq_no)
+    usart_control_block_t(uintptr_t     base_address,
+                          IRQn_Type     irq_no,
+                          char const*   rx_name,
+                          char const*   tx_name)
     :   usart_registers(reinterpret_cast<NRF_UARTE_Type *>(base_address)),
         irq_type(irq_no),
         handler(nullptr),
@@ -122,7 +128,9 @@ struct usart_control_block_t
         tx_buffer(tx_allocator),
         rx_bytes_ready(0u),
         rx_dma_index(0u),
-        rx_dma_state(0u)
+        rx_dma_state(0u),
+        rx_watermark(rx_name),
+        tx_watermark(tx_name)
     {
     }
 
@@ -184,15 +192,21 @@ struct usart_control_block_t
     /// conditions ignored (ignore test, do what is inside the curlies)
     /// and operation should work fine.
     uint8_t rx_dma_state;
+
+    /// The rx_buffer and tx_buffer fill levels.
+    memory_watermark rx_watermark;
+    memory_watermark tx_watermark;
 };
 
 static void irq_handler_usart(struct usart_control_block_t* usart_control);
-static struct usart_control_block_t usart_instance_0(NRF_UARTE0_BASE, UARTE0_UART0_IRQn);
+static struct usart_control_block_t usart_instance_0(NRF_UARTE0_BASE, UARTE0_UART0_IRQn,
+                                                         "usart0_rx", "usart0_tx");
 static struct usart_control_block_t* const usart_instance_ptr_0 = &usart_instance_0;
 extern "C" void UARTE0_UART0_IRQHandler(void) { irq_handler_usart(&usart_instance_0); }
 
 #if defined (NRF52840_XXAA)
-static struct usart_control_block_t usart_instance_1(NRF_UARTE1_BASE, UARTE1_IRQn);
+static struct usart_control_block_t usart_instance_1(NRF_UARTE1_BASE, UARTE1_IRQn,
+                                                         "usart1_rx", "usart1_tx");
 static struct usart_control_block_t* const usart_instance_ptr_1 = &usart_instance_1;
 extern "C" void UARTE1_IRQHandler(void) { irq_handler_usart(&usart_instance_1); }
 #else
@@ -332,6 +346,7 @@ static size_t usart_dma_dequeue_rx_buffer(struct usart_control_block_t* usart_co
     size_t  const  rx_len = usart_control->usart_registers->RXD.AMOUNT;
 
     usart_control->rx_buffer.insert(usart_control->rx_buffer.end(), rx_ptr, rx_ptr + rx_len);
+    usart_control->rx_watermark.record(usart_control->rx_buffer.size());
     usart_control->rx_dma_state -= 1u;
 
     return rx_len;
@@ -369,6 +384,9 @@ void usart_init(usart_port_t                    usart_port,
     usart_control->rx_buffer.set_capacity(rx_length);
     usart_control->tx_buffer.set_capacity(tx_length);
 
+    usart_control->rx_watermark.set_capacity(rx_length);
+    usart_control->tx_watermark.set_capacity(tx_length);
+
     if (usart_config->tx_pin != usart_pin_not_used)
     {
         usart_pin_config_output(usart_config->tx_pin);
@@ -459,6 +477,7 @@ size_t usart_write(usart_port_t usart_port, void const* tx_buffer, size_t tx_len
         uint8_t const* tx_begin = reinterpret_cast<uint8_t const*>(tx_buffer);
         uint8_t const* tx_end   = tx_begin + tx_length;
         usart_control->tx_buffer.insert(usart_control->tx_buffer.end(), tx_begin, tx_end);
+        usart_control->tx_watermark.record(usart_control->tx_buffer.size());
 
         if (not usart_control->tx_dma_in_progress)
         {
@@ -638,6 +657,9 @@ void usart_read_stop(usart_port_t usart_port)
 
 static void irq_handler_usart(struct usart_control_block_t* const usart_control)
 {
+    ISR_PROFILE(usart_control->irq_type);
+    PROFILE_ZONE("irq_handler_usart");
+
     void* usart_context = const_cast<void*>(usart_control->context);
 
     // A auto critical section is not used here.
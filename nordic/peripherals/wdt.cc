@@ -101,7 +101,12 @@ extern "C" void WDT_IRQHandler(void)
     logger &logger = logger.instance();
     logger.error("%s", __func__);
 
-    __asm("bkpt #0");
+    // Without a debugger attached bkpt escalates to a HardFault and the
+    // handler below would not get to save its state before the reset.
+    if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk)
+    {
+        __asm("bkpt #0");
+    }
 
     wdt_clear_event_register(&wdt_instance.wdt_registers->EVENTS_TIMEOUT);
     if (wdt_instance.handler)
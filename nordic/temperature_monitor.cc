@@ -0,0 +1,95 @@
+/**
+ * @file temperature_monitor.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "temperature_monitor.h"
+#include "temperature_sensor.h"
+#include "logger.h"
+
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#endif
+
+namespace nordic
+{
+
+temperature_monitor::temperature_monitor(run_loop&              loop,
+                                         work_item::priority_t  priority,
+                                         uint32_t               interval_ticks,
+                                         uint8_t                filter_shift) :
+    rtc_observer(expiration_type::continuous, interval_ticks),
+    filter_(filter_shift),
+    filter_work_(loop, priority, filter_update, this),
+    measurement_Cx4_(0),
+    listeners_(nullptr),
+    busy_count_(0u)
+{
+}
+
+void temperature_monitor::attach(temperature_listener& listener)
+{
+    temperature_listener** link = &this->listeners_;
+    while (*link)
+    {
+        link = &(*link)->next_;
+    }
+
+    listener.next_ = nullptr;
+    *link = &listener;
+}
+
+void temperature_monitor::expiration_notify()
+{
+#ifdef SOFTDEVICE_PRESENT
+    // The TEMP peripheral is restricted while the softdevice is enabled;
+    // the softdevice uses it for its own calibration.
+    uint8_t softdevice_enabled = 0u;
+    sd_softdevice_is_enabled(&softdevice_enabled);
+    if (softdevice_enabled)
+    {
+        int32_t temperature_Cx4 = 0;
+        if (sd_temp_get(&temperature_Cx4) == NRF_SUCCESS)
+        {
+            measurement_complete(temperature_Cx4, this);
+        }
+        else
+        {
+            this->busy_count_ += 1u;
+        }
+        return;
+    }
+#endif
+
+    if (not temperature_sensor_take_measurement(measurement_complete, this))
+    {
+        this->busy_count_ += 1u;
+    }
+}
+
+void temperature_monitor::measurement_complete(int32_t temperature_Cx4, void* context)
+{
+    temperature_monitor* monitor = static_cast<temperature_monitor*>(context);
+    monitor->measurement_Cx4_.store(temperature_Cx4, std::memory_order_relaxed);
+    monitor->filter_work_.post();
+}
+
+void temperature_monitor::filter_update(void* context)
+{
+    temperature_monitor* monitor = static_cast<temperature_monitor*>(context);
+
+    int32_t const measurement_Cx4 = monitor->measurement_Cx4_.load(std::memory_order_relaxed);
+    int32_t const temperature_Cx4 = monitor->filter_.update(measurement_Cx4);
+
+    logger::instance().debug("temperature: %d, filtered: %d (0.25 C)",
+                             measurement_Cx4, temperature_Cx4);
+
+    for (temperature_listener* listener = monitor->listeners_; listener;
+         listener = listener->next_)
+    {
+        listener->temperature_update(temperature_Cx4);
+    }
+}
+
+} // namespace nordic
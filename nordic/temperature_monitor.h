@@ -0,0 +1,109 @@
+/**
+ * @file temperature_monitor.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Periodic die temperature sampling for temperature compensation.
+ */
+
+#pragma once
+
+#include "rtc_observer.h"
+#include "run_loop.h"
+#include "temperature_compensation.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace nordic
+{
+
+/**
+ * @class temperature_listener
+ * Notified of the filtered temperature by a temperature_monitor.
+ */
+class temperature_listener
+{
+public:
+    virtual ~temperature_listener()                                 = default;
+
+    temperature_listener(temperature_listener const&)               = delete;
+    temperature_listener(temperature_listener &&)                   = delete;
+    temperature_listener& operator=(temperature_listener const&)    = delete;
+    temperature_listener& operator=(temperature_listener&&)         = delete;
+
+    temperature_listener() : next_(nullptr) {}
+
+    /**
+     * Called from the run loop after each measurement.
+     * @param temperature_Cx4 The filtered temperature in 0.25 C units.
+     */
+    virtual void temperature_update(int32_t temperature_Cx4) = 0;
+
+private:
+    friend class temperature_monitor;
+    temperature_listener* next_;
+};
+
+/**
+ * @class temperature_monitor
+ * Start a TEMP measurement on each expiration of an RTC observer. The TEMP
+ * ISR posts the measurement to the run loop, where it is filtered and the
+ * listeners are notified. A measurement takes about 36 usec of TEMP
+ * peripheral time and no CPU time until it completes.
+ *
+ * While the softdevice is enabled the measurement is taken with
+ * sd_temp_get(), which blocks for the measurement time.
+ *
+ * Attach the monitor to an rtc_observable to start sampling.
+ */
+class temperature_monitor: public rtc_observer
+{
+public:
+    virtual ~temperature_monitor() override                     = default;
+
+    temperature_monitor()                                       = delete;
+    temperature_monitor(temperature_monitor const&)             = delete;
+    temperature_monitor(temperature_monitor &&)                 = delete;
+    temperature_monitor& operator=(temperature_monitor const&)  = delete;
+    temperature_monitor& operator=(temperature_monitor&&)       = delete;
+
+    /**
+     * @param loop           The run loop which filters the measurements.
+     * @param priority       The run loop priority of the filter work.
+     * @param interval_ticks The RTC ticks between measurements.
+     * @param filter_shift   The filter time constant in measurements,
+     *                       as a power of 2.
+     */
+    temperature_monitor(run_loop&               loop,
+                        work_item::priority_t   priority,
+                        uint32_t                interval_ticks,
+                        uint8_t                 filter_shift);
+
+    /// Listeners are notified in the order attached.
+    void attach(temperature_listener& listener);
+
+    bool    is_valid()        const { return this->filter_.is_valid(); }
+    int32_t temperature_Cx4() const { return this->filter_.value_Cx4(); }
+
+    uint32_t measurement_count() const { return this->filter_.sample_count(); }
+
+    /// The expirations which found a measurement pending or the TEMP busy.
+    uint32_t busy_count() const { return this->busy_count_; }
+
+    virtual void expiration_notify() override;
+
+private:
+    /// The TEMP ISR measurement handler.
+    static void measurement_complete(int32_t temperature_Cx4, void* context);
+
+    /// The run loop filter work.
+    static void filter_update(void* context);
+
+    utility::temperature_filter filter_;
+    work_function               filter_work_;
+    std::atomic<int32_t>        measurement_Cx4_;
+    temperature_listener*       listeners_;
+    uint32_t                    busy_count_;
+};
+
+} // namespace nordic
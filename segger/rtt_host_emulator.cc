@@ -0,0 +1,313 @@
+/**
+ * @file rtt_host_emulator.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "rtt_host_emulator.h"
+#include "segger_rtt_control_block.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <sys/uio.h>
+
+static_assert(sizeof(void*) == sizeof(uintptr_t));
+static_assert(offsetof(rtt_buffer_up_t,   length)       == 2u * sizeof(uintptr_t));
+static_assert(offsetof(rtt_buffer_up_t,   read_offset)  == 2u * sizeof(uintptr_t) + 8u);
+static_assert(offsetof(rtt_buffer_down_t, write_offset) == 2u * sizeof(uintptr_t) + 4u);
+static_assert(offsetof(rtt_control_block_t, buffer_up)  == 24u);
+
+/// The signature, including its zero padding to 16 bytes.
+static char const rtt_signature[16u] = "SEGGER RTT";
+
+/// Target memory is searched in chunks of this size.
+static constexpr std::size_t const search_chunk_size = 64u * 1024u;
+
+rtt_host_emulator::rtt_host_emulator(pid_t pid)
+:   pid_(pid),
+    control_block_(0u),
+    up_count_(0u),
+    down_count_(0u),
+    bytes_read_(0u),
+    bytes_written_(0u)
+{
+}
+
+bool rtt_host_emulator::read_memory(uintptr_t address, void* buffer, size_t length)
+{
+    struct iovec local  = { buffer, length };
+    struct iovec remote = { reinterpret_cast<void*>(address), length };
+
+    ssize_t const result = process_vm_readv(this->pid_, &local, 1u, &remote, 1u, 0u);
+    return (result >= 0) && (static_cast<size_t>(result) == length);
+}
+
+bool rtt_host_emulator::write_memory(uintptr_t address, void const* buffer, size_t length)
+{
+    struct iovec local  = { const_cast<void*>(buffer), length };
+    struct iovec remote = { reinterpret_cast<void*>(address), length };
+
+    ssize_t const result = process_vm_writev(this->pid_, &local, 1u, &remote, 1u, 0u);
+    return (result >= 0) && (static_cast<size_t>(result) == length);
+}
+
+bool rtt_host_emulator::attach()
+{
+    this->detach();
+
+    char maps_path[32u];
+    std::snprintf(maps_path, sizeof(maps_path), "/proc/%d/maps", static_cast<int>(this->pid_));
+
+    FILE* const maps = std::fopen(maps_path, "r");
+    if (not maps) { return false; }
+
+    // Each line: "begin-end perms offset dev inode path".
+    char line[512u];
+    while (std::fgets(line, sizeof(line), maps))
+    {
+        unsigned long long begin = 0u;
+        unsigned long long end   = 0u;
+        char perms[8u] = {};
+        if (std::sscanf(line, "%llx-%llx %7s", &begin, &end, perms) != 3)
+        {
+            continue;
+        }
+
+        // The control block is in RAM which the target writes.
+        if ((perms[0] == 'r') && (perms[1] == 'w') &&
+            this->search(static_cast<uintptr_t>(begin), static_cast<uintptr_t>(end)))
+        {
+            break;
+        }
+    }
+
+    std::fclose(maps);
+    return this->is_attached();
+}
+
+bool rtt_host_emulator::search(uintptr_t begin, uintptr_t end)
+{
+    // Chunks overlap by the signature size so that a signature which
+    // straddles a chunk boundary is found.
+    std::vector<char> chunk(search_chunk_size + sizeof(rtt_signature));
+
+    for (uintptr_t address = begin; address < end; address += search_chunk_size)
+    {
+        size_t const length = std::min<uintptr_t>(chunk.size(), end - address);
+        if (not this->read_memory(address, chunk.data(), length))
+        {
+            return false;
+        }
+
+        // The control block is 4 byte aligned.
+        for (size_t offset = 0u; offset + sizeof(rtt_signature) <= length; offset += 4u)
+        {
+            if ((std::memcmp(&chunk[offset], rtt_signature, sizeof(rtt_signature)) == 0) &&
+                this->attach(address + offset))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool rtt_host_emulator::attach(uintptr_t control_block_address)
+{
+    this->detach();
+
+    char     signature[signature_size];
+    uint32_t counts[2u];
+
+    if (not this->read_memory(control_block_address, signature, sizeof(signature)) ||
+        not this->read_memory(control_block_address + up_count_offset, counts, sizeof(counts)))
+    {
+        return false;
+    }
+
+    if ((std::memcmp(signature, rtt_signature, sizeof(rtt_signature)) != 0) ||
+        (counts[0] == 0u) || (counts[0] > buffer_count_limit) ||
+        (counts[1] == 0u) || (counts[1] > buffer_count_limit))
+    {
+        return false;
+    }
+
+    this->control_block_ = control_block_address;
+    this->up_count_      = counts[0];
+    this->down_count_    = counts[1];
+    return true;
+}
+
+uintptr_t rtt_host_emulator::descriptor_address(bool up, rtt_channel_t channel) const
+{
+    // As the J-Link does, locate the down buffers from the up buffer count.
+    uintptr_t const base = this->control_block_ + up_buffers_offset;
+    return up ? base + channel * sizeof(buffer_descriptor)
+              : base + (this->up_count_ + channel) * sizeof(buffer_descriptor);
+}
+
+bool rtt_host_emulator::descriptor_read(bool                up,
+                                        rtt_channel_t       channel,
+                                        buffer_descriptor&  descriptor)
+{
+    if (not this->is_attached() ||
+        (channel >= (up ? this->up_count_ : this->down_count_)))
+    {
+        return false;
+    }
+
+    if (not this->read_memory(this->descriptor_address(up, channel),
+                              &descriptor, sizeof(descriptor)))
+    {
+        this->detach();
+        return false;
+    }
+
+    // Unallocated channels have no buffer; reject corrupt offsets.
+    return (descriptor.base_pointer != 0u) && (descriptor.length > 1u) &&
+           (descriptor.write_offset < descriptor.length) &&
+           (descriptor.read_offset  < descriptor.length);
+}
+
+std::string rtt_host_emulator::name_read(bool up, rtt_channel_t channel)
+{
+    buffer_descriptor descriptor;
+    if (not this->descriptor_read(up, channel, descriptor) || (descriptor.name == 0u))
+    {
+        return std::string();
+    }
+
+    char name[32u] = {};
+    if (not this->read_memory(descriptor.name, name, sizeof(name) - 1u))
+    {
+        return std::string();
+    }
+    return std::string(name);
+}
+
+std::string rtt_host_emulator::up_name(rtt_channel_t channel)
+{
+    return this->name_read(true, channel);
+}
+
+std::string rtt_host_emulator::down_name(rtt_channel_t channel)
+{
+    return this->name_read(false, channel);
+}
+
+size_t rtt_host_emulator::up_pending(rtt_channel_t channel)
+{
+    buffer_descriptor descriptor;
+    if (not this->descriptor_read(true, channel, descriptor))
+    {
+        return 0u;
+    }
+
+    return (descriptor.write_offset >= descriptor.read_offset) ?
+        descriptor.write_offset - descriptor.read_offset :
+        descriptor.write_offset + descriptor.length - descriptor.read_offset;
+}
+
+size_t rtt_host_emulator::read(rtt_channel_t channel, void* buffer, size_t length)
+{
+    buffer_descriptor descriptor;
+    if (not this->descriptor_read(true, channel, descriptor))
+    {
+        return 0u;
+    }
+
+    uint8_t* buffer_iter = static_cast<uint8_t*>(buffer);
+    uint32_t read_offset = descriptor.read_offset;
+    size_t   remain      = length;
+
+    // At most two segments: to the end of the ring, then from its start.
+    while (remain > 0u)
+    {
+        uint32_t const write_offset = descriptor.write_offset;
+        size_t const linear = (write_offset >= read_offset) ?
+                              write_offset - read_offset :
+                              descriptor.length - read_offset;
+        size_t const count  = std::min(linear, remain);
+        if (count == 0u) { break; }
+
+        if (not this->read_memory(descriptor.base_pointer + read_offset, buffer_iter, count))
+        {
+            this->detach();
+            return 0u;
+        }
+
+        buffer_iter += count;
+        remain      -= count;
+        read_offset += count;
+        read_offset -= (read_offset == descriptor.length) ? descriptor.length : 0u;
+    }
+
+    size_t const count = length - remain;
+    if (count > 0u)
+    {
+        uintptr_t const read_offset_address = this->descriptor_address(true, channel) +
+                                              offsetof(buffer_descriptor, read_offset);
+        if (not this->write_memory(read_offset_address, &read_offset, sizeof(read_offset)))
+        {
+            this->detach();
+            return 0u;
+        }
+    }
+
+    this->bytes_read_ += count;
+    return count;
+}
+
+size_t rtt_host_emulator::write(rtt_channel_t channel, void const* buffer, size_t length)
+{
+    buffer_descriptor descriptor;
+    if (not this->descriptor_read(false, channel, descriptor))
+    {
+        return 0u;
+    }
+
+    uint8_t const* buffer_iter  = static_cast<uint8_t const*>(buffer);
+    uint32_t       write_offset = descriptor.write_offset;
+    size_t         remain       = length;
+
+    while (remain > 0u)
+    {
+        // One byte is always left empty: equal offsets mean an empty ring.
+        uint32_t const read_offset = descriptor.read_offset;
+        size_t const linear = (read_offset > write_offset) ?
+                              read_offset - write_offset - 1u :
+                              descriptor.length - write_offset - (read_offset == 0u ? 1u : 0u);
+        size_t const count  = std::min(linear, remain);
+        if (count == 0u) { break; }
+
+        if (not this->write_memory(descriptor.base_pointer + write_offset, buffer_iter, count))
+        {
+            this->detach();
+            return 0u;
+        }
+
+        buffer_iter  += count;
+        remain       -= count;
+        write_offset += count;
+        write_offset -= (write_offset == descriptor.length) ? descriptor.length : 0u;
+    }
+
+    size_t const count = length - remain;
+    if (count > 0u)
+    {
+        uintptr_t const write_offset_address = this->descriptor_address(false, channel) +
+                                               offsetof(buffer_descriptor, write_offset);
+        if (not this->write_memory(write_offset_address, &write_offset, sizeof(write_offset)))
+        {
+            this->detach();
+            return 0u;
+        }
+    }
+
+    this->bytes_written_ += count;
+    return count;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file rtt_host_emulator.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The host side of the SEGGER RTT protocol for a Linux process target.
+ */
+
+#pragma once
+
+#include "segger_rtt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @class rtt_host_emulator
+ * Reads RTT up channels from, and writes RTT down channels to, the memory
+ * of a Linux process which runs the target RTT implementation, segger_rtt.cc.
+ * This performs the J-Link role without a probe so that RTT streaming
+ * throughput and loss can be tested on the host.
+ *
+ * As with a J-Link, the control block is found by searching the target's
+ * writable memory for the "SEGGER RTT" signature. Target memory is accessed
+ * with process_vm_readv() and process_vm_writev(); the process may be this
+ * process. The target must have the same pointer size and byte order as the
+ * host since the control block is interpreted with the native layout.
+ *
+ * Methods return the number of bytes transferred, or false on failure;
+ * a failure to access target memory detaches the emulator.
+ */
+class rtt_host_emulator
+{
+public:
+    ~rtt_host_emulator()                                    = default;
+
+    rtt_host_emulator()                                     = delete;
+    rtt_host_emulator(rtt_host_emulator const&)             = delete;
+    rtt_host_emulator(rtt_host_emulator &&)                 = delete;
+    rtt_host_emulator& operator=(rtt_host_emulator const&)  = delete;
+    rtt_host_emulator& operator=(rtt_host_emulator&&)       = delete;
+
+    /// The largest buffer count accepted as a valid control block.
+    static constexpr uint32_t const buffer_count_limit = 32u;
+
+    explicit rtt_host_emulator(pid_t pid);
+
+    /**
+     * Search the writable memory mappings of the target for the control block.
+     * @return bool true if a valid control block was found.
+     */
+    bool attach();
+
+    /**
+     * Attach to a control block at a known address.
+     * @return bool true if a valid control block is at the address.
+     */
+    bool attach(uintptr_t control_block_address);
+
+    void detach() { this->control_block_ = 0u; }
+
+    bool is_attached() const { return this->control_block_ != 0u; }
+
+    uintptr_t control_block_address() const { return this->control_block_; }
+
+    uint32_t up_count()   const { return this->up_count_; }
+    uint32_t down_count() const { return this->down_count_; }
+
+    /** @return std::string The name of an up channel; empty if unnamed. */
+    std::string up_name(rtt_channel_t channel);
+    std::string down_name(rtt_channel_t channel);
+
+    /** @return size_t The bytes written by the target and not yet read. */
+    size_t up_pending(rtt_channel_t channel);
+
+    /**
+     * Read from an up channel; target to host.
+     * @return size_t The number of bytes read.
+     */
+    size_t read(rtt_channel_t channel, void* buffer, size_t length);
+
+    /**
+     * Write to a down channel; host to target.
+     * @return size_t The number of bytes written; limited by the space in
+     *                the down buffer.
+     */
+    size_t write(rtt_channel_t channel, void const* buffer, size_t length);
+
+    uint64_t bytes_read()    const { return this->bytes_read_; }
+    uint64_t bytes_written() const { return this->bytes_written_; }
+
+private:
+    /// The native layout of rtt_buffer_up_t and rtt_buffer_down_t.
+    struct buffer_descriptor
+    {
+        uintptr_t   name;
+        uintptr_t   base_pointer;
+        uint32_t    length;
+        uint32_t    write_offset;
+        uint32_t    read_offset;
+        uint32_t    flags;
+    };
+
+    /// Offsets within the control block.
+    static constexpr std::size_t const signature_size = 16u;
+    static constexpr std::size_t const up_count_offset = signature_size;
+    static constexpr std::size_t const down_count_offset = up_count_offset + sizeof(uint32_t);
+    static constexpr std::size_t const up_buffers_offset = down_count_offset + sizeof(uint32_t);
+
+    bool read_memory(uintptr_t address, void* buffer, size_t length);
+    bool write_memory(uintptr_t address, void const* buffer, size_t length);
+
+    /// Read a region of memory and search it for a valid control block.
+    bool search(uintptr_t begin, uintptr_t end);
+
+    uintptr_t descriptor_address(bool up, rtt_channel_t channel) const;
+    bool descriptor_read(bool up, rtt_channel_t channel, buffer_descriptor& descriptor);
+    std::string name_read(bool up, rtt_channel_t channel);
+
+    pid_t const pid_;
+    uintptr_t   control_block_;
+    uint32_t    up_count_;
+    uint32_t    down_count_;
+    uint64_t    bytes_read_;
+    uint64_t    bytes_written_;
+};
@@ -8,47 +8,20 @@
  */
 
 #include "segger_rtt.h"
+#include "segger_rtt_control_block.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iterator>
 #include <type_traits>
 
 #include "nordic_critical_section.h"
 #include "project_assert.h"
 
-static constexpr rtt_channel_t const channel_count_max = 4u;
-
-static char const* const channel_name [channel_count_max] = {
-    "Terminal",
-    "SysView",
-    "J-Scope_t4i4",
-    "Aux"
-};
-
-/**
- * @enum rtt_mode
- * Only RTT_MODE_NO_BLOCK_TRIM is supported to reduce complexity.
- * When writing the buffer the number of bytes written is returned and it is
- * up to the client to determine if the writing of the unwritten bytes needs
- * to be performed. Or more convenient: increase the output (UP) buffer size.
- * These flags are here for RTT buffer compliance.
- */
-enum rtt_mode
-{
-    /// Skip. Do not block, output nothing. (Default)
-    RTT_MODE_NO_BLOCK_SKIP          = 0u,
-    /// Trim: Do not block, output as much as fits.
-    RTT_MODE_NO_BLOCK_TRIM          = 1u,
-
-    /// Block: Wait until there is space in the buffer.
-    RTT_MODE_BLOCK_IF_FIFO_FULL     = 2u,
-
-    /// Bits allocation within the rtt_buffer_up_t::flags   for mode.
-    /// Bits allocation within the rtt_buffer_down_t::flags for mode.
-    RTT_MODE_MASK                   = 3u
-};
+static constexpr rtt_channel_t const channel_count_max = rtt_channel_count_max;
 
 using signed_size_t = typename std::make_signed<size_t>::type;
 
@@ -63,84 +36,11 @@ static_assert(sizeof(unsigned int) == sizeof(size_t));
 static_assert(sizeof(unsigned int) == sizeof(signed_size_t));
 #endif // __arm__
 
-/// Circular buffer which is used as the up-buffer; target to host.
-extern "C" struct rtt_buffer_up_t
-{
-    /// Optional name. Gets set when the channel is allocated.
-    char const *name;
-
-    /// Pointer to start of buffer
-    char *base_pointer;
-
-    /// Buffer size in bytes.
-    /// @note The actual capacity is length - 1. When the write_offset equals
-    /// read_offset the buffer is considered empty, not full.
-    uint32_t length;
-
-    /// The position to write the next character into the buffer.
-    uint32_t write_offset;
-
-    /// The position to read the next character from the buffer.
-    uint32_t volatile read_offset;
-
-    /// This implementation only sets the flags to RTT_MODE_NO_BLOCK_TRIM.
-    uint32_t flags;
-};
-
-/// Circular buffer which is used as the down-buffer; host to target.
-///
-/// @note This is exactly the same layout as the struct rtt_buffer_up_t
-/// except that the volatile qualifier is on the write_offset data member
-/// rather than the read_offset. It is these volatile member value which are
-/// modified by the Segger host software.
-extern "C" struct rtt_buffer_down_t
-{
-    /// Optional name.
-    /// Standard names so far are: "Terminal", "SysView", "J-Scope_t4i4"
-    char const*         name;
-    char*               base_pointer;
-    uint32_t            length;
-    uint32_t volatile   write_offset;
-    uint32_t            read_offset;
-    uint32_t            flags;
-};
-
-// Only perform these checks when compiling for ARM.
-#if defined __arm__
-static_assert(sizeof(struct rtt_buffer_down_t) == sizeof(uint32_t) * 6u);
-static_assert(sizeof(struct rtt_buffer_up_t)   == sizeof(uint32_t) * 6u);
-#endif
-
-/**
- * RTT control block which describes the number of buffers available
- * as well as the configuration for each buffer.
- *
- * @note The buffer layouts are cast in stone and must be in the formwat
- * determined by Segger. The member signature, followed by the data
- * layout of this struct
- *
- * follows is assumed by the host software. Changing the struct layouts
- * results in the Segger host software to understand the buffer structs
- * and contents.
- */
-extern "C" struct rtt_control_block_t
-{
-    /// Must be Initialized to "SEGGER RTT". This is the signature used by the
-    /// Segger RTT client host software to determine where the buffer layouts
-    /// are held. This must be 16 bytes in length and carry 4 byte alignment.
-    char signature[16u];
-
-    /// Must be initialized to RTT_BUFFER_UP_COUNT.
-    uint32_t rtt_buffer_up_count;
-
-    /// Must be Initialized to RTT_BUFFER_DOWN_COUNT.
-    uint32_t rtt_buffer_down_count;
-
-    /// Up buffers, transferring information up from target to host
-    struct rtt_buffer_up_t buffer_up[channel_count_max];
-
-    /// Down buffers, transferring information down from host to target
-    struct rtt_buffer_down_t buffer_down[channel_count_max];
+static char const* const channel_name [channel_count_max] = {
+    "Terminal",
+    "SysView",
+    "J-Scope_t4i4",
+    "Aux"
 };
 
 // Setting the alignment since there is no actual guarantee that the signature
@@ -177,14 +77,13 @@ void segger_rtt_channel_allocate(struct rtt_channel_alloc const* channel_alloc)
         // Fault if the channel is already allocated.
         ASSERT(buffer->base_pointer == nullptr);
 
-        buffer->name            = channel_name[channel];
+        buffer->name            = channel_alloc->name ? channel_alloc->name
+                                                  : channel_name[channel];
         buffer->base_pointer    = reinterpret_cast<char*>(channel_alloc->buffer);
         buffer->length          = channel_alloc->buffer_size;
         buffer->read_offset     = 0u;
         buffer->write_offset    = 0u;
         buffer->flags           = RTT_MODE_NO_BLOCK_TRIM;
-
-        rtt_control_block.rtt_buffer_up_count += 1u;
     }
     else if (channel_alloc->direction == rtt_channel_alloc::down)
     {
@@ -195,14 +94,13 @@ void segger_rtt_channel_allocate(struct rtt_channel_alloc const* channel_alloc)
         // Fault if the channel is already allocated.
         ASSERT(buffer->base_pointer == nullptr);
 
-        buffer->name            = channel_name[channel];
+        buffer->name            = channel_alloc->name ? channel_alloc->name
+                                                  : channel_name[channel];
         buffer->base_pointer    = reinterpret_cast<char*>(channel_alloc->buffer);
         buffer->length          = channel_alloc->buffer_size;
         buffer->read_offset     = 0u;
         buffer->write_offset    = 0u;
         buffer->flags           = RTT_MODE_NO_BLOCK_TRIM;
-
-        rtt_control_block.rtt_buffer_down_count += 1u;
     }
     else
     {
@@ -222,13 +120,23 @@ void segger_rtt_enable(void)
         return;             // Already initialized.
     }
 
-    if ((rtt_control_block.rtt_buffer_down_count == 0u) &&
-        (rtt_control_block.rtt_buffer_up_count == 0u))
+    bool allocated = false;
+    for (rtt_channel_t channel = 0u; channel < channel_count_max; ++channel)
     {
-        // Nothing allocated.
-        ASSERT(0);
+        allocated = allocated ||
+                    rtt_control_block.buffer_up[channel].base_pointer ||
+                    rtt_control_block.buffer_down[channel].base_pointer;
     }
 
+    // Nothing allocated.
+    ASSERT(allocated);
+
+    // The host locates buffer_down[] from the up buffer count: the counts
+    // are the array sizes, not the number of channels allocated.
+    // Unallocated channels have a zero length and are ignored by the host.
+    rtt_control_block.rtt_buffer_up_count   = channel_count_max;
+    rtt_control_block.rtt_buffer_down_count = channel_count_max;
+
     std::fill(std::begin(rtt_control_block.signature),
               std::end(rtt_control_block.signature),
               0);
@@ -249,6 +157,30 @@ void segger_rtt_enable(void)
     *sep_loc = id_sep;
 }
 
+void segger_rtt_disable(void)
+{
+    nordic::auto_critical_section cs;
+
+    // Clear the signature first so that the host stops using the buffers.
+    std::fill(std::begin(rtt_control_block.signature),
+              std::end(rtt_control_block.signature),
+              0);
+
+    rtt_control_block.rtt_buffer_up_count   = 0u;
+    rtt_control_block.rtt_buffer_down_count = 0u;
+    std::fill(std::begin(rtt_control_block.buffer_up),
+              std::end(rtt_control_block.buffer_up),
+              rtt_buffer_up_t{});
+    std::fill(std::begin(rtt_control_block.buffer_down),
+              std::end(rtt_control_block.buffer_down),
+              rtt_buffer_down_t{});
+}
+
+void const* segger_rtt_control_block(void)
+{
+    return &rtt_control_block;
+}
+
 static size_t rtt_write_avail(size_t read_offset, size_t write_offset, size_t length)
 {
     signed_size_t const delta_offset = read_offset - write_offset;
@@ -266,12 +198,90 @@ static size_t rtt_read_avail(size_t write_offset, size_t read_offset, size_t len
 {
     signed_size_t read_avail = write_offset - read_offset;
 
-    read_avail += (read_avail <= 0) ? length : 0u;
+    // Equal offsets are an empty buffer.
+    read_avail += (read_avail < 0) ? length : 0u;
     return read_avail;
 }
 
+/**
+ * Copy into or out of an RTT ring buffer.
+ *
+ * The newlib-nano memcpy() is the size optimized byte loop; RTT writes of
+ * log bursts and binary dumps are dominated by it. Here, once the
+ * destination is word aligned, data is moved 16 bytes per iteration which
+ * the compiler emits as LDM/STM when the source is also word aligned, and as
+ * unaligned LDR with aligned STR otherwise (Cortex-M3 and later).
+ * Short copies do not repay the alignment handling and are copied bytewise.
+ */
+static void rtt_copy(char* dest, char const* src, size_t length)
+{
+    constexpr size_t const word_size     = sizeof(uint32_t);
+    constexpr size_t const word_copy_min = 16u;
+
+    if (length >= word_copy_min)
+    {
+        // Head: bytes until the destination is word aligned.
+        for (; reinterpret_cast<uintptr_t>(dest) & (word_size - 1u); --length)
+        {
+            *dest++ = *src++;
+        }
+
+        char* const dest_aligned =
+            static_cast<char*>(__builtin_assume_aligned(dest, word_size));
+
+        size_t offset = 0u;
+        if ((reinterpret_cast<uintptr_t>(src) & (word_size - 1u)) == 0u)
+        {
+            char const* const src_aligned =
+                static_cast<char const*>(__builtin_assume_aligned(src, word_size));
+            for (; offset + 4u * word_size <= length; offset += 4u * word_size)
+            {
+                std::memcpy(dest_aligned + offset, src_aligned + offset, 4u * word_size);
+            }
+        }
+
+        for (; offset + word_size <= length; offset += word_size)
+        {
+            uint32_t word;
+            std::memcpy(&word, src + offset, word_size);
+            std::memcpy(dest_aligned + offset, &word, word_size);
+        }
+
+        dest   += offset;
+        src    += offset;
+        length -= offset;
+    }
+
+    // Tail, or the whole of a short copy.
+    for (; length > 0u; --length)
+    {
+        *dest++ = *src++;
+    }
+}
+
+/**
+ * Make ring buffer data visible to the host before the offset which covers it.
+ * The host reads target memory concurrently; on Cortex-M the fence is a DMB
+ * which completes the data stores ahead of the offset store.
+ */
+static void rtt_offset_publish(uint32_t volatile& offset, size_t value)
+{
+    std::atomic_thread_fence(std::memory_order_release);
+    offset = static_cast<uint32_t>(value);
+}
+
+/// Load the offset written by the host; ring data is accessed after it.
+static size_t rtt_offset_acquire(uint32_t const volatile& offset)
+{
+    size_t const value = offset;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return value;
+}
+
 /**
  * Write data from a user supplied buffer into the Segger RTT up ring buffer .
+ * At most two copies are made, to the end of the ring and from its start;
+ * the write offset is published once for both.
  *
  * @param rtt_ring_buffer The ring buffer to write to; device to host.
  * @param buffer          Pointer to the user supplied buffer.
@@ -286,57 +296,78 @@ static size_t rtt_write(struct rtt_buffer_up_t* rtt_ring_buffer,
                         size_t                  buffer_length)
 {
     char   const* buffer_iter   = reinterpret_cast<char const *>(buffer);
+    size_t const  length        = rtt_ring_buffer->length;
     size_t        write_offset  = rtt_ring_buffer->write_offset;
-    size_t const  read_offset   = rtt_ring_buffer->read_offset;
-    size_t        write_avail   = rtt_write_avail(read_offset, write_offset,
-                                                  rtt_ring_buffer->length);
-    size_t const  write_linear  = rtt_ring_buffer->length - write_offset;
-    size_t const  avail_linear  = std::min(write_avail,  write_linear);
-    size_t const  buffer_linear = std::min(avail_linear, buffer_length);
-
-    std::copy(buffer_iter,
-              buffer_iter + buffer_linear,
-              &rtt_ring_buffer->base_pointer[write_offset]);
-
-    write_offset    += buffer_linear;
-    buffer_iter     += buffer_linear;
-    buffer_length   -= buffer_linear;
-    write_avail     -= buffer_linear;
+    size_t const  read_offset   = rtt_offset_acquire(rtt_ring_buffer->read_offset);
+    size_t const  write_avail   = rtt_write_avail(read_offset, write_offset, length);
+    size_t const  write_count   = std::min(write_avail, buffer_length);
+    size_t const  write_linear  = std::min(write_count, length - write_offset);
 
-    size_t const write_remain = std::min(buffer_length, write_avail);
+    rtt_copy(&rtt_ring_buffer->base_pointer[write_offset], buffer_iter, write_linear);
+    write_offset += write_linear;
+    buffer_iter  += write_linear;
 
-    if (write_remain > 0u)
+    if (write_count > write_linear)
     {
-        // The first copy() wrote what could be fit in after write_offset
-        // to the end of the allocated ring write buffer.
-        // Fill what remains of the write request.
-        std::copy(buffer_iter,
-                  buffer_iter + write_remain,
-                  rtt_ring_buffer->base_pointer);
-
+        // The first copy filled the ring to its end; wrap to its start.
+        size_t const write_remain = write_count - write_linear;
+        rtt_copy(rtt_ring_buffer->base_pointer, buffer_iter, write_remain);
         write_offset = write_remain;
-        buffer_iter += write_remain;
     }
-    else
+    else if (write_offset >= length)
     {
-        // Handle the condition when 'buffer_length' matches the linear
-        // available ring write buffer space.
         // Do not let write_offset dangle past the end of the ring buffer.
-        // Note: '==' would be sufficient, '>=' is being defensive.
-        if (write_offset >= rtt_ring_buffer->length)
-        {
-            write_offset = 0u;
-        }
+        write_offset = 0u;
     }
 
-    rtt_ring_buffer->write_offset = write_offset;
-    return buffer_iter - reinterpret_cast<char const *>(buffer);
+    if (write_count > 0u)
+    {
+        rtt_offset_publish(rtt_ring_buffer->write_offset, write_offset);
+    }
+    return write_count;
+}
+
+/**
+ * Reserve the contiguous free space at the write offset of an up buffer.
+ *
+ * @param rtt_ring_buffer The ring buffer to write to; device to host.
+ * @param [out] length    The number of bytes which may be written.
+ *
+ * @return char* Where the next byte written to the ring is placed.
+ */
+static char* rtt_write_reserve(struct rtt_buffer_up_t* rtt_ring_buffer, size_t& length)
+{
+    size_t const write_offset = rtt_ring_buffer->write_offset;
+    size_t const read_offset  = rtt_offset_acquire(rtt_ring_buffer->read_offset);
+    size_t const write_avail  = rtt_write_avail(read_offset, write_offset,
+                                                rtt_ring_buffer->length);
+
+    length = std::min(write_avail, rtt_ring_buffer->length - write_offset);
+    return &rtt_ring_buffer->base_pointer[write_offset];
+}
+
+/**
+ * Publish bytes written into space obtained from rtt_write_reserve().
+ *
+ * @param rtt_ring_buffer The ring buffer to write to; device to host.
+ * @param commit_length   The number of bytes written; no more than reserved.
+ */
+static void rtt_write_commit(struct rtt_buffer_up_t* rtt_ring_buffer, size_t commit_length)
+{
+    size_t const length = rtt_ring_buffer->length;
+    size_t write_offset = rtt_ring_buffer->write_offset;
+
+    ASSERT(commit_length <= length - write_offset);
+    write_offset += commit_length;
+    write_offset -= (write_offset >= length) ? length : 0u;
+
+    rtt_offset_publish(rtt_ring_buffer->write_offset, write_offset);
 }
 
 static size_t rtt_putc(struct rtt_buffer_up_t* rtt_ring_buffer, char value)
 {
     size_t       write_offset = rtt_ring_buffer->write_offset;
-    size_t const read_offset  = rtt_ring_buffer->read_offset;
+    size_t const read_offset  = rtt_offset_acquire(rtt_ring_buffer->read_offset);
     size_t const write_avail  = rtt_write_avail(read_offset, write_offset,
                                                 rtt_ring_buffer->length);
     if (write_avail > 0u)
@@ -348,7 +379,7 @@ static size_t rtt_putc(struct rtt_buffer_up_t* rtt_ring_buffer, char value)
             write_offset = 0u;
         }
 
-        rtt_ring_buffer->write_offset = write_offset;
+        rtt_offset_publish(rtt_ring_buffer->write_offset, write_offset);
         return 1u;
     }
 
@@ -371,16 +402,14 @@ static size_t rtt_read(struct rtt_buffer_down_t*    rtt_ring_buffer,
                        size_t                       buffer_length)
 {
     size_t        read_offset   = rtt_ring_buffer->read_offset;
-    size_t const  write_offset  = rtt_ring_buffer->write_offset;
+    size_t const  write_offset  = rtt_offset_acquire(rtt_ring_buffer->write_offset);
     char*         buffer_iter   = reinterpret_cast<char *>(buffer);
     size_t        read_avail    = rtt_read_avail(write_offset, read_offset, rtt_ring_buffer->length);
     size_t const  read_linear   = rtt_ring_buffer->length - read_offset;
     size_t const  avail_linear  = std::min(read_avail,   read_linear);
     size_t const  buffer_linear = std::min(avail_linear, buffer_length);
 
-    std::copy(&rtt_ring_buffer->base_pointer[read_offset],
-              &rtt_ring_buffer->base_pointer[read_offset] + buffer_linear,
-              buffer_iter);
+    rtt_copy(buffer_iter, &rtt_ring_buffer->base_pointer[read_offset], buffer_linear);
 
     read_offset     += buffer_linear;
     buffer_iter     += buffer_linear;
@@ -391,12 +420,10 @@ static size_t rtt_read(struct rtt_buffer_down_t*    rtt_ring_buffer,
 
     if (read_remain > 0u)
     {
-        // The first copy() read what was available after read_offset
+        // The first copy read what was available after read_offset
         // to the end of the allocated ring read buffer.
         // Fill what remains of the read request.
-        std::copy(rtt_ring_buffer->base_pointer,
-                  rtt_ring_buffer->base_pointer + read_remain,
-                  buffer_iter);
+        rtt_copy(buffer_iter, rtt_ring_buffer->base_pointer, read_remain);
 
         read_offset  = read_remain;
         buffer_iter += read_remain;
@@ -413,14 +440,14 @@ static size_t rtt_read(struct rtt_buffer_down_t*    rtt_ring_buffer,
         }
     }
 
-    rtt_ring_buffer->read_offset = read_offset;
+    rtt_offset_publish(rtt_ring_buffer->read_offset, read_offset);
     return buffer_iter - reinterpret_cast<char const *>(buffer);
 }
 
 static int rtt_getc(rtt_buffer_down_t* rtt_ring_buffer)
 {
     size_t        read_offset   = rtt_ring_buffer->read_offset;
-    size_t const  write_offset  = rtt_ring_buffer->write_offset;
+    size_t const  write_offset  = rtt_offset_acquire(rtt_ring_buffer->write_offset);
     size_t const  read_avail    = rtt_read_avail(write_offset, read_offset,
                                                  rtt_ring_buffer->length);
 
@@ -433,7 +460,7 @@ static int rtt_getc(rtt_buffer_down_t* rtt_ring_buffer)
             read_offset = 0u;
         }
 
-        rtt_ring_buffer->read_offset = read_offset;
+        rtt_offset_publish(rtt_ring_buffer->read_offset, read_offset);
         return value;
     }
 
@@ -450,6 +477,19 @@ size_t SEGGER_RTT_Write(rtt_channel_t   channel,
                      buffer_length);
 }
 
+void* SEGGER_RTT_WriteReserve(rtt_channel_t channel, size_t* length)
+{
+    ASSERT(length);
+    nordic::auto_critical_section cs;
+    return rtt_write_reserve(&rtt_control_block.buffer_up[channel], *length);
+}
+
+void SEGGER_RTT_WriteCommit(rtt_channel_t channel, size_t length)
+{
+    nordic::auto_critical_section cs;
+    rtt_write_commit(&rtt_control_block.buffer_up[channel], length);
+}
+
 size_t SEGGER_RTT_PutChar(rtt_channel_t channel, char value)
 {
     nordic::auto_critical_section cs;
@@ -478,6 +518,11 @@ size_t SEGGER_RTT_WriteAvailable(rtt_channel_t channel)
         rtt_control_block.buffer_up[channel].length);
 }
 
+size_t segger_rtt_up_read_offset(rtt_channel_t channel)
+{
+    return rtt_offset_acquire(rtt_control_block.buffer_up[channel].read_offset);
+}
+
 size_t SEGGER_RTT_Read(rtt_channel_t    channel,
                        void*            buffer,
                        size_t           buffer_length)
@@ -29,6 +29,9 @@ struct rtt_channel_alloc
     rtt_channel_t       channel;
     void*               buffer;
     size_t              buffer_size;
+
+    /// The channel name shown by the host; if null a default name is used.
+    char const*         name;
 };
 
 /**
@@ -57,6 +60,25 @@ void segger_rtt_channel_allocate(struct rtt_channel_alloc const* channel_alloc);
  */
 void segger_rtt_enable(void);
 
+/**
+ * Withdraw the control block from the host and release all channel
+ * allocations. Channels may then be allocated and enabled again.
+ */
+void segger_rtt_disable(void);
+
+/**
+ * @return void const* The address of the RTT control block; what the host
+ *         finds by searching target RAM for the control block signature.
+ */
+void const* segger_rtt_control_block(void);
+
+/**
+ * @param channel The RTT up channel.
+ * @return size_t The read offset of the up channel. Only the host writes it;
+ *         it remains 0 from allocation until a host first reads the channel.
+ */
+size_t segger_rtt_up_read_offset(rtt_channel_t channel);
+
 /**
  * Write a specified number of characters into the SEGGER Real Time Terminal
  * (RTT) 'up' buffer.
@@ -79,6 +101,32 @@ size_t SEGGER_RTT_Write(rtt_channel_t   channel,
                         void const*     buffer,
                         size_t          buffer_length);
 
+/**
+ * Reserve space in an RTT 'up' buffer to be written in place, such as by
+ * formatting directly into the ring buffer. The data is not visible to the
+ * host until SEGGER_RTT_WriteCommit() is called.
+ *
+ * @note Reserve and commit are not atomic as a pair: only one context may
+ *       write the channel between the reserve and the commit.
+ *
+ * @param channel      The RTT up channel.
+ * @param [out] length The number of contiguous bytes which may be written.
+ *                     This is less than the free space when the free space
+ *                     wraps around the end of the ring; commit and reserve
+ *                     again to obtain the remainder.
+ *
+ * @return void* The reserved space.
+ */
+void* SEGGER_RTT_WriteReserve(rtt_channel_t channel, size_t* length);
+
+/**
+ * Publish data written into space obtained from SEGGER_RTT_WriteReserve().
+ *
+ * @param channel The RTT up channel.
+ * @param length  The number of bytes written; no more than reserved.
+ */
+void SEGGER_RTT_WriteCommit(rtt_channel_t channel, size_t length);
+
 size_t SEGGER_RTT_PutChar(rtt_channel_t channel, char value);
 
 size_t SEGGER_RTT_WritePending(rtt_channel_t);
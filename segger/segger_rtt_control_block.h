@@ -0,0 +1,123 @@
+/**
+ * @file segger_rtt_control_block.h
+ * RTT version: 6.18a
+ *
+ * (c) 2014 - 2017  SEGGER Microcontroller GmbH & Co. KG
+ * This is a derivative work and subject to the restrictions and copyright
+ * claims found at the end of segger_rtt.h.
+ *
+ * The RTT control block memory layout, shared by the target implementation
+ * in segger_rtt.cc and host side readers of target memory.
+ */
+
+#pragma once
+
+#include "segger_rtt.h"
+
+#include <cstdint>
+
+/// The number of up buffers and the number of down buffers in the control block.
+static constexpr rtt_channel_t const rtt_channel_count_max = 4u;
+
+/**
+ * @enum rtt_mode
+ * Only RTT_MODE_NO_BLOCK_TRIM is supported to reduce complexity.
+ * When writing the buffer the number of bytes written is returned and it is
+ * up to the client to determine if the writing of the unwritten bytes needs
+ * to be performed. Or more convenient: increase the output (UP) buffer size.
+ * These flags are here for RTT buffer compliance.
+ */
+enum rtt_mode
+{
+    /// Skip. Do not block, output nothing. (Default)
+    RTT_MODE_NO_BLOCK_SKIP          = 0u,
+    /// Trim: Do not block, output as much as fits.
+    RTT_MODE_NO_BLOCK_TRIM          = 1u,
+
+    /// Block: Wait until there is space in the buffer.
+    RTT_MODE_BLOCK_IF_FIFO_FULL     = 2u,
+
+    /// Bits allocation within the rtt_buffer_up_t::flags   for mode.
+    /// Bits allocation within the rtt_buffer_down_t::flags for mode.
+    RTT_MODE_MASK                   = 3u
+};
+
+/// Circular buffer which is used as the up-buffer; target to host.
+struct rtt_buffer_up_t
+{
+    /// Optional name. Gets set when the channel is allocated.
+    char const *name;
+
+    /// Pointer to start of buffer
+    char *base_pointer;
+
+    /// Buffer size in bytes.
+    /// @note The actual capacity is length - 1. When the write_offset equals
+    /// read_offset the buffer is considered empty, not full.
+    uint32_t length;
+
+    /// The position to write the next character into the buffer.
+    uint32_t write_offset;
+
+    /// The position to read the next character from the buffer.
+    uint32_t volatile read_offset;
+
+    /// This implementation only sets the flags to RTT_MODE_NO_BLOCK_TRIM.
+    uint32_t flags;
+};
+
+/// Circular buffer which is used as the down-buffer; host to target.
+///
+/// @note This is exactly the same layout as the struct rtt_buffer_up_t
+/// except that the volatile qualifier is on the write_offset data member
+/// rather than the read_offset. It is these volatile member value which are
+/// modified by the Segger host software.
+struct rtt_buffer_down_t
+{
+    /// Optional name.
+    /// Standard names so far are: "Terminal", "SysView", "J-Scope_t4i4"
+    char const*         name;
+    char*               base_pointer;
+    uint32_t            length;
+    uint32_t volatile   write_offset;
+    uint32_t            read_offset;
+    uint32_t            flags;
+};
+
+// Only perform these checks when compiling for ARM.
+#if defined __arm__
+static_assert(sizeof(struct rtt_buffer_down_t) == sizeof(uint32_t) * 6u);
+static_assert(sizeof(struct rtt_buffer_up_t)   == sizeof(uint32_t) * 6u);
+#endif
+
+/**
+ * RTT control block which describes the number of buffers available
+ * as well as the configuration for each buffer.
+ *
+ * @note The buffer layouts are cast in stone and must be in the formwat
+ * determined by Segger. The member signature, followed by the data
+ * layout of this struct
+ *
+ * follows is assumed by the host software. Changing the struct layouts
+ * results in the Segger host software to understand the buffer structs
+ * and contents.
+ */
+struct rtt_control_block_t
+{
+    /// Must be Initialized to "SEGGER RTT". This is the signature used by the
+    /// Segger RTT client host software to determine where the buffer layouts
+    /// are held. This must be 16 bytes in length and carry 4 byte alignment.
+    char signature[16u];
+
+    /// Must be initialized to RTT_BUFFER_UP_COUNT.
+    uint32_t rtt_buffer_up_count;
+
+    /// Must be Initialized to RTT_BUFFER_DOWN_COUNT.
+    uint32_t rtt_buffer_down_count;
+
+    /// Up buffers, transferring information up from target to host
+    struct rtt_buffer_up_t buffer_up[rtt_channel_count_max];
+
+    /// Down buffers, transferring information down from host to target
+    struct rtt_buffer_down_t buffer_down[rtt_channel_count_max];
+};
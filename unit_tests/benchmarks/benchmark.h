@@ -0,0 +1,62 @@
+/**
+ * @file benchmark.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Minimal host timing support for the benchmark programs.
+ * Host timings are only meaningful relative to one another; they are used to
+ * compare an implementation against the one it replaces.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace benchmark
+{
+
+/** Prevent the optimizer from discarding a value which is otherwise unused. */
+template <typename value_type>
+inline void do_not_optimize(value_type const& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * Measure the time taken to call a function repeatedly.
+ *
+ * @param iterations The number of times to call func().
+ * @param func       The function to time.
+ *
+ * @return double The mean nanoseconds per call.
+ */
+template <typename func_type>
+double measure_ns(std::size_t iterations, func_type&& func)
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point const start = clock::now();
+    for (std::size_t iter = 0u; iter < iterations; ++iter)
+    {
+        func();
+    }
+    clock::time_point const stop = clock::now();
+
+    std::chrono::duration<double, std::nano> const elapsed = stop - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+/** Print a single benchmark result line. */
+inline void report(char const* name, double ns_per_op)
+{
+    std::printf("%-40s %12.2f ns/op\n", name, ns_per_op);
+}
+
+/** Print the ratio of a baseline measurement to an optimized measurement. */
+inline void report_speedup(char const* name, double baseline_ns, double optimized_ns)
+{
+    std::printf("%-40s %12.2f x\n", name, baseline_ns / optimized_ns);
+}
+
+} // namespace benchmark
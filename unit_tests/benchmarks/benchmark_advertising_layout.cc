@@ -0,0 +1,89 @@
+/**
+ * @file benchmark_advertising_layout.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Update the sensor value and battery level of beacon advertising data:
+ * - baseline: encode the advertising data from scratch with ltv_encode().
+ * - advertising_layout: write the two values in place.
+ */
+
+#include "benchmark.h"
+#include "ble/gap_advertising_layout.h"
+#include "ble/ltv_encode.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+using namespace ble::gap;
+
+static constexpr uint16_t const company_id   = 0x0059u;
+static constexpr uint16_t const battery_uuid = 0x180Fu;
+static constexpr char     const short_name[] = "sensor";
+
+using sensor_layout = advertising_layout<
+    ltv_field<type::flags, uint8_t>,
+    ltv_field<type::local_name_short, std::array<char, 6u>>,
+    ltv_field<type::manufacturer_specific_data, uint16_t, int16_t>,
+    ltv_field<type::service_data_uuid_16, uint16_t, uint8_t>>;
+
+static void sensor_encode(advertising_data& data, int16_t sensor_value, uint8_t battery_level)
+{
+    ltv_encode(data, type::flags, static_cast<uint8_t>(le_general_discovery));
+    ltv_encode(data, type::local_name_short, short_name, sizeof(short_name) - 1u);
+
+    uint8_t const manufacturer_data[4u] = {
+        static_cast<uint8_t>(company_id), static_cast<uint8_t>(company_id >> 8u),
+        static_cast<uint8_t>(sensor_value), static_cast<uint8_t>(sensor_value >> 8u),
+    };
+    ltv_encode(data, type::manufacturer_specific_data, manufacturer_data, sizeof(manufacturer_data));
+
+    uint8_t const service_data[3u] = {
+        static_cast<uint8_t>(battery_uuid), static_cast<uint8_t>(battery_uuid >> 8u),
+        battery_level,
+    };
+    ltv_encode(data, type::service_data_uuid_16, service_data, sizeof(service_data));
+}
+
+int main()
+{
+    std::size_t const iterations = 20u * 1000u * 1000u;
+
+    int16_t sensor_value  = 0;
+    uint8_t battery_level = 100u;
+
+    double const encode_ns = benchmark::measure_ns(iterations, [&]() {
+        advertising_data data;
+        sensor_encode(data, sensor_value++, battery_level);
+        benchmark::do_not_optimize(data);
+    });
+
+    static constexpr sensor_layout::container const sensor_template = []() {
+        sensor_layout::container payload = sensor_layout::template_data;
+        sensor_layout::set<0>(payload, static_cast<uint8_t>(le_general_discovery));
+        sensor_layout::set<1>(payload, {{ 's', 'e', 'n', 's', 'o', 'r' }});
+        sensor_layout::set<2, 0>(payload, company_id);
+        sensor_layout::set<3, 0>(payload, battery_uuid);
+        return payload;
+    }();
+
+    advertising_data data;
+    sensor_layout::assign(data, sensor_template);
+
+    double const patch_ns = benchmark::measure_ns(iterations, [&]() {
+        sensor_layout::set<2, 1>(data, sensor_value++);
+        sensor_layout::set<3, 1>(data, battery_level);
+        benchmark::do_not_optimize(data);
+    });
+
+    advertising_data encoded;
+    sensor_encode(encoded, sensor_value - 1, battery_level);
+    bool const equal = std::equal(data.data(), data.data() + data.size(),
+                                  encoded.data(), encoded.data() + encoded.size());
+
+    benchmark::report("ltv_encode() from scratch", encode_ns);
+    benchmark::report("advertising_layout::set()", patch_ns);
+    benchmark::report_speedup("speedup", encode_ns, patch_ns);
+    std::printf("payloads equal: %s\n", equal ? "yes" : "NO");
+    return equal ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file benchmark_allocators.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Allocation latency of block_pool, slab_allocator and monotonic_arena
+ * compared with malloc() and free().
+ *
+ * Each sample times a batch of allocations followed by their release.
+ * The mean shows throughput; the worst batch shows how deterministic the
+ * allocator is, which is what matters in an ISR.
+ */
+
+#include "benchmark.h"
+#include "block_pool.h"
+#include "monotonic_arena.h"
+#include "slab_allocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr std::size_t const batch_size   = 64u;
+static constexpr std::size_t const sample_count = 20000u;
+
+/// Request sizes cycled through by the variable size benchmarks.
+static std::size_t const request_sizes[] = { 8u, 24u, 12u, 60u, 16u, 100u, 4u, 32u };
+
+struct latency
+{
+    double mean_ns;
+    double max_ns;
+};
+
+/**
+ * @param batch A function which allocates and releases batch_size blocks.
+ * @return latency The mean and the worst case nanoseconds per
+ *         allocate/release pair.
+ */
+template <typename func_type>
+static latency measure_latency(func_type&& batch)
+{
+    using clock = std::chrono::steady_clock;
+
+    double total_ns = 0.0;
+    double max_ns   = 0.0;
+    for (std::size_t sample = 0u; sample < sample_count; ++sample)
+    {
+        clock::time_point const start = clock::now();
+        batch();
+        clock::time_point const stop = clock::now();
+
+        std::chrono::duration<double, std::nano> const elapsed = stop - start;
+        total_ns += elapsed.count();
+        max_ns    = std::max(max_ns, elapsed.count());
+    }
+
+    return latency{ total_ns / (sample_count * batch_size), max_ns / batch_size };
+}
+
+static void report(char const* name, latency const& result)
+{
+    std::printf("%-40s %12.2f ns/op mean %12.2f ns/op worst batch\n",
+                name, result.mean_ns, result.max_ns);
+}
+
+int main()
+{
+    void* blocks[batch_size];
+
+    latency const malloc_fixed = measure_latency([&]() {
+        for (void*& block : blocks) { block = std::malloc(32u); }
+        benchmark::do_not_optimize(blocks);
+        for (void* block : blocks) { std::free(block); }
+    });
+
+    fixed_block_pool<32u, batch_size> pool;
+    latency const pool_fixed = measure_latency([&]() {
+        for (void*& block : blocks) { block = pool.allocate(); }
+        benchmark::do_not_optimize(blocks);
+        for (void* block : blocks) { pool.deallocate(block); }
+    });
+
+    latency const malloc_variable = measure_latency([&]() {
+        for (std::size_t index = 0u; index < batch_size; ++index)
+        {
+            blocks[index] = std::malloc(request_sizes[index % std::size(request_sizes)]);
+        }
+        benchmark::do_not_optimize(blocks);
+        for (void* block : blocks) { std::free(block); }
+    });
+
+    fixed_block_pool<16u,  batch_size> pool_16;
+    fixed_block_pool<32u,  batch_size> pool_32;
+    fixed_block_pool<128u, batch_size> pool_128;
+    slab_allocator<3u> slab({&pool_16, &pool_32, &pool_128});
+    latency const slab_variable = measure_latency([&]() {
+        for (std::size_t index = 0u; index < batch_size; ++index)
+        {
+            blocks[index] = slab.allocate(request_sizes[index % std::size(request_sizes)]);
+        }
+        benchmark::do_not_optimize(blocks);
+        for (std::size_t index = 0u; index < batch_size; ++index)
+        {
+            slab.deallocate(blocks[index], request_sizes[index % std::size(request_sizes)]);
+        }
+    });
+
+    alignas(std::max_align_t) static uint8_t arena_storage[batch_size * 128u];
+    monotonic_arena arena(arena_storage, sizeof(arena_storage));
+    latency const arena_variable = measure_latency([&]() {
+        for (std::size_t index = 0u; index < batch_size; ++index)
+        {
+            blocks[index] = arena.allocate(request_sizes[index % std::size(request_sizes)], 4u);
+        }
+        benchmark::do_not_optimize(blocks);
+        arena.reset();
+    });
+
+    std::printf("batches of %zu allocations, %zu samples\n", batch_size, sample_count);
+    report("malloc/free, 32 bytes",              malloc_fixed);
+    report("block_pool, 32 bytes",               pool_fixed);
+    report("malloc/free, variable",              malloc_variable);
+    report("slab_allocator, variable",           slab_variable);
+    report("monotonic_arena, variable",          arena_variable);
+    benchmark::report_speedup("block_pool speedup",      malloc_fixed.mean_ns,    pool_fixed.mean_ns);
+    benchmark::report_speedup("slab_allocator speedup",  malloc_variable.mean_ns, slab_variable.mean_ns);
+    benchmark::report_speedup("monotonic_arena speedup", malloc_variable.mean_ns, arena_variable.mean_ns);
+
+    std::printf("slab fragmentation at peak: %zu / %zu bytes high water\n",
+                slab.high_water_bytes(), pool_16.block_stride() * batch_size +
+                pool_32.block_stride() * batch_size + pool_128.block_stride() * batch_size);
+    std::printf("arena padding: %zu bytes, high water: %zu bytes\n",
+                arena.padding(), arena.high_water());
+
+    return 0;
+}
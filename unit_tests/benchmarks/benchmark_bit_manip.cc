@@ -0,0 +1,134 @@
+/**
+ * @file benchmark_bit_manip.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Compare the bit_manip primitives against the loops they replace:
+ * - popcount: a loop over each bit position.
+ * - for_each_set_bit: a loop testing each bit position; the SAADC channel
+ *   enable scan and the SAADC limit event scan.
+ * - count_trailing_zeros of the free mask: a loop over each channel testing
+ *   whether it is free; the GPIO TE channel allocation.
+ */
+
+#include "benchmark.h"
+#include "bit_manip.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace baseline
+{
+
+static unsigned int popcount(uint32_t value)
+{
+    unsigned int count = 0u;
+    for (unsigned int bit_pos = 0u; bit_pos < 32u; ++bit_pos)
+    {
+        count += (value >> bit_pos) & 1u;
+    }
+    return count;
+}
+
+template <typename func_type>
+static void for_each_set_bit(uint32_t bits, func_type&& func)
+{
+    for (bit_manip::bit_pos_t bit_pos = 0u; bit_pos < 32u; ++bit_pos)
+    {
+        if (bits & (1u << bit_pos)) { func(bit_pos); }
+    }
+}
+
+static uint8_t channel_first_free(uint8_t channels_allocated)
+{
+    for (uint8_t channel = 0u; channel < 8u; ++channel)
+    {
+        if (not (channels_allocated & (1u << channel))) { return channel; }
+    }
+    return UINT8_MAX;
+}
+
+} // namespace baseline
+
+static uint8_t channel_first_free(uint8_t channels_allocated)
+{
+    uint8_t const channels_free = static_cast<uint8_t>(~channels_allocated);
+    return (channels_free == 0u) ? UINT8_MAX :
+        static_cast<uint8_t>(bit_manip::count_trailing_zeros(channels_free));
+}
+
+/// Run func over the values; values are prevented from being constant folded.
+template <typename func_type>
+static double measure(std::vector<uint32_t> const& values, func_type&& func)
+{
+    std::size_t const passes = 200u;
+    return benchmark::measure_ns(passes, [&]() {
+        uint32_t sum = 0u;
+        for (uint32_t value : values) { sum += func(value); }
+        benchmark::do_not_optimize(sum);
+    }) / static_cast<double>(values.size());
+}
+
+static void run(char const* name, std::vector<uint32_t> const& values)
+{
+    std::printf("%s\n", name);
+
+    double const popcount_loop_ns = measure(values, [](uint32_t value) {
+        return baseline::popcount(value);
+    });
+    double const popcount_ns = measure(values, [](uint32_t value) {
+        return bit_manip::popcount(value);
+    });
+    benchmark::report("  popcount: bit loop", popcount_loop_ns);
+    benchmark::report("  popcount: bit_manip", popcount_ns);
+    benchmark::report_speedup("  popcount speedup", popcount_loop_ns, popcount_ns);
+
+    double const set_bits_loop_ns = measure(values, [](uint32_t value) {
+        uint32_t sum = 0u;
+        baseline::for_each_set_bit(value, [&sum](bit_manip::bit_pos_t bit_pos) { sum += bit_pos; });
+        return sum;
+    });
+    double const set_bits_ns = measure(values, [](uint32_t value) {
+        uint32_t sum = 0u;
+        bit_manip::for_each_set_bit(value, [&sum](bit_manip::bit_pos_t bit_pos) { sum += bit_pos; });
+        return sum;
+    });
+    benchmark::report("  set bits: bit loop", set_bits_loop_ns);
+    benchmark::report("  set bits: for_each_set_bit", set_bits_ns);
+    benchmark::report_speedup("  set bits speedup", set_bits_loop_ns, set_bits_ns);
+
+    double const first_free_loop_ns = measure(values, [](uint32_t value) {
+        return baseline::channel_first_free(static_cast<uint8_t>(value));
+    });
+    double const first_free_ns = measure(values, [](uint32_t value) {
+        return channel_first_free(static_cast<uint8_t>(value));
+    });
+    benchmark::report("  first free: channel loop", first_free_loop_ns);
+    benchmark::report("  first free: count_trailing_zeros", first_free_ns);
+    benchmark::report_speedup("  first free speedup", first_free_loop_ns, first_free_ns);
+    std::printf("\n");
+}
+
+int main()
+{
+    std::size_t const value_count = 4096u;
+    uint32_t state = 0x12345678u;
+    auto random = [&state]() {
+        state ^= state << 13u;
+        state ^= state >> 17u;
+        state ^= state <<  5u;
+        return state;
+    };
+
+    // Sparse values resemble channel enable and interrupt masks:
+    // a few channels are in use.
+    std::vector<uint32_t> sparse(value_count);
+    for (uint32_t& value : sparse) { value = random() & random() & random(); }
+
+    std::vector<uint32_t> dense(value_count);
+    for (uint32_t& value : dense) { value = random(); }
+
+    run("Sparse values (~4 bits set)", sparse);
+    run("Dense values (~16 bits set)", dense);
+    return 0;
+}
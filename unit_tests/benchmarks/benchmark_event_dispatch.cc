@@ -0,0 +1,204 @@
+/**
+ * @file benchmark_event_dispatch.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Replay a recorded BLE GAP event trace through:
+ * - The observer list walk where every observer decodes every event.
+ *   This is how the Nordic observables dispatched prior to the table.
+ * - The event_dispatch_table where only interested observers are visited.
+ *
+ * The Nordic event ids are replaced with their offset from BLE_GAP_EVT_BASE
+ * so that the benchmark builds without the Nordic SDK headers.
+ */
+
+#include "benchmark.h"
+#include "event_dispatch_table.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+
+// BLE_GAP_EVTS offsets from BLE_GAP_EVT_BASE.
+enum gap_event: uint8_t
+{
+    connected                   = 0x00,
+    disconnected                = 0x01,
+    conn_param_update           = 0x02,
+    sec_params_request          = 0x03,
+    sec_info_request            = 0x04,
+    auth_status                 = 0x08,
+    conn_sec_update             = 0x09,
+    timeout                     = 0x0a,
+    rssi_changed                = 0x0b,
+    adv_report                  = 0x0c,
+    sec_request                 = 0x0d,
+    conn_param_update_request   = 0x0e,
+    phy_update_request          = 0x11,
+    phy_update                  = 0x12,
+    data_length_update_request  = 0x13,
+    data_length_update          = 0x14,
+};
+
+/// A central scanning, connecting, negotiating, securing and disconnecting.
+static uint8_t const gap_event_trace[] = {
+    adv_report, adv_report, adv_report, adv_report, adv_report, adv_report,
+    adv_report, adv_report, adv_report, adv_report, adv_report, adv_report,
+    connected,
+    data_length_update_request, data_length_update,
+    phy_update_request, phy_update,
+    conn_param_update_request, conn_param_update,
+    sec_request, sec_params_request, auth_status, conn_sec_update,
+    rssi_changed, rssi_changed, rssi_changed, rssi_changed,
+    rssi_changed, rssi_changed, rssi_changed, rssi_changed,
+    conn_param_update,
+    disconnected,
+    adv_report, adv_report, adv_report, adv_report, timeout,
+};
+
+struct gap_event_data
+{
+    uint16_t conn_handle;
+    uint8_t  params[32u];
+};
+
+/**
+ * @class gap_observer
+ * Emulates the Nordic GAP observable switch: each case decodes the event
+ * data and makes a virtual call into the observer interface.
+ */
+class gap_observer
+{
+public:
+    virtual ~gap_observer() = default;
+    explicit gap_observer(uint32_t interest_mask): event_mask(interest_mask) {}
+
+    void notify(uint8_t event_index, gap_event_data const& event_data)
+    {
+        switch (event_index)
+        {
+        case connected:         this->connect(event_data.conn_handle, event_data.params[0]);     break;
+        case disconnected:      this->disconnect(event_data.conn_handle, event_data.params[0]);  break;
+        case adv_report:        this->report(event_data.params, sizeof(event_data.params));     break;
+        case rssi_changed:      this->rssi(event_data.conn_handle, event_data.params[1]);        break;
+        default:                this->other(event_data.conn_handle, event_index);                break;
+        }
+    }
+
+    virtual void connect(uint16_t, uint8_t)             {}
+    virtual void disconnect(uint16_t, uint8_t)          {}
+    virtual void report(uint8_t const*, std::size_t)    {}
+    virtual void rssi(uint16_t, uint8_t)                {}
+    virtual void other(uint16_t, uint8_t)               {}
+
+    uint32_t const event_mask;
+    uint32_t       handled = 0u;
+};
+
+class logger_observer: public gap_observer
+{
+public:
+    logger_observer(): gap_observer(0xFFFFFFFFu) {}
+    void connect(uint16_t, uint8_t)                 override { ++handled; }
+    void disconnect(uint16_t, uint8_t)              override { ++handled; }
+    void report(uint8_t const*, std::size_t)        override { ++handled; }
+    void rssi(uint16_t, uint8_t)                    override { ++handled; }
+    void other(uint16_t, uint8_t)                   override { ++handled; }
+};
+
+class connection_observer: public gap_observer
+{
+public:
+    connection_observer(): gap_observer((1u << connected) | (1u << disconnected) |
+                                        (1u << conn_param_update) |
+                                        (1u << phy_update) |
+                                        (1u << data_length_update)) {}
+    void connect(uint16_t, uint8_t)                 override { ++handled; }
+    void disconnect(uint16_t, uint8_t)              override { ++handled; }
+    void other(uint16_t, uint8_t)                   override { ++handled; }
+};
+
+class scan_observer: public gap_observer
+{
+public:
+    scan_observer(): gap_observer((1u << adv_report) | (1u << timeout)) {}
+    void report(uint8_t const*, std::size_t)        override { ++handled; }
+    void other(uint16_t, uint8_t)                   override { ++handled; }
+};
+
+class security_observer: public gap_observer
+{
+public:
+    security_observer(): gap_observer((1u << sec_params_request) |
+                                      (1u << sec_info_request)   |
+                                      (1u << auth_status)        |
+                                      (1u << conn_sec_update)    |
+                                      (1u << sec_request)) {}
+    void other(uint16_t, uint8_t)                   override { ++handled; }
+};
+
+static logger_observer      observer_logger;
+static connection_observer  observer_connection;
+static scan_observer        observer_scan;
+static security_observer    observer_security;
+
+static gap_observer* const observer_list[] = {
+    &observer_logger, &observer_connection, &observer_scan, &observer_security
+};
+
+using dispatch_table = event_dispatch_table<gap_observer, 32u>;
+
+int main()
+{
+    std::size_t const iterations = 200000u;
+    gap_event_data event_data = { 0x0010u, { 0u } };
+
+    dispatch_table table;
+    for (gap_observer* observer : observer_list)
+    {
+        table.insert(*observer, observer->event_mask);
+    }
+
+    double const list_ns = benchmark::measure_ns(iterations, [&]() {
+        for (uint8_t event_index : gap_event_trace)
+        {
+            for (gap_observer* observer : observer_list)
+            {
+                observer->notify(event_index, event_data);
+            }
+        }
+        benchmark::do_not_optimize(event_data);
+    });
+
+    double const table_ns = benchmark::measure_ns(iterations, [&]() {
+        for (uint8_t event_index : gap_event_trace)
+        {
+            for (auto iter = table.dispatch_begin(event_index); iter != table.end(); )
+            {
+                gap_observer& observer = *iter;
+                ++iter;
+                observer.notify(event_index, event_data);
+            }
+        }
+        benchmark::do_not_optimize(event_data);
+    });
+
+    std::size_t const events = std::size(gap_event_trace);
+    std::printf("GAP event trace: %zu events, %zu observers\n",
+                events, std::size(observer_list));
+    benchmark::report("observer list, per event",    list_ns  / events);
+    benchmark::report("dispatch table, per event",   table_ns / events);
+    benchmark::report_speedup("dispatch table speedup", list_ns, table_ns);
+
+    std::printf("dispatch counters:\n");
+    for (std::size_t event_index = 0u; event_index < 32u; ++event_index)
+    {
+        uint32_t const count = table.dispatch_count(event_index);
+        if (count > 0u)
+        {
+            std::printf("  event 0x%02zx: %10u dispatched, %zu observers\n",
+                        event_index, count, table.observer_count(event_index));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file benchmark_float_format.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Compare the vwritef() floating point and fixed point conversions against
+ * the C library snprintf(); the alternative on the target is linking the
+ * newlib printf floating point support.
+ *
+ * Before timing, the conversions of each value set are checked against
+ * snprintf(); a mismatch fails the benchmark.
+ */
+
+#include "benchmark.h"
+#include "vwritef.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/// An output stream into a fixed buffer; reset before each conversion.
+class buffer_output_stream: public io::output_stream
+{
+public:
+    virtual ~buffer_output_stream() override = default;
+
+    virtual std::size_t write(void const *buffer, std::size_t length) override
+    {
+        length = std::min(length, sizeof(this->buffer) - 1u - this->length);
+        std::memcpy(this->buffer + this->length, buffer, length);
+        this->length += length;
+        return length;
+    }
+
+    virtual std::size_t write_pending() const override { return 0u; }
+    virtual std::size_t write_avail()   const override { return sizeof(this->buffer) - 1u - this->length; }
+    virtual void        flush()               override {}
+
+    char const* c_str()
+    {
+        this->buffer[this->length] = 0;
+        return this->buffer;
+    }
+
+    char        buffer[512u];
+    std::size_t length = 0u;
+};
+
+static std::size_t vwritef_convert(buffer_output_stream& os, char const* format, ...)
+{
+    os.length = 0u;
+
+    va_list args;
+    va_start(args, format);
+    std::size_t const length = vwritef(os, format, args);
+    va_end(args);
+
+    return length;
+}
+
+/// @return bool true if vwritef() matches snprintf() for all values.
+static bool validate(char const* format, std::vector<double> const& values)
+{
+    buffer_output_stream os;
+    char expected[512u];
+    std::size_t failures = 0u;
+
+    for (double value : values)
+    {
+        vwritef_convert(os, format, value);
+        std::snprintf(expected, sizeof(expected), format, value);
+        if (std::strcmp(os.c_str(), expected) != 0)
+        {
+            if (failures++ < 10u)
+            {
+                std::printf("  %s %a: %s != %s\n", format, value, os.c_str(), expected);
+            }
+        }
+    }
+
+    return failures == 0u;
+}
+
+static bool run(char const* name, char const* format, std::vector<double> const& values)
+{
+    std::printf("%s: \"%s\"\n", name, format);
+    if (not validate(format, values))
+    {
+        std::printf("  FAILED validation\n");
+        return false;
+    }
+
+    std::size_t const passes = 10u;
+    buffer_output_stream os;
+    char buffer[512u];
+
+    double const snprintf_ns = benchmark::measure_ns(passes, [&]() {
+        for (double value : values)
+        {
+            benchmark::do_not_optimize(std::snprintf(buffer, sizeof(buffer), format, value));
+        }
+    }) / static_cast<double>(values.size());
+
+    double const vwritef_ns = benchmark::measure_ns(passes, [&]() {
+        for (double value : values)
+        {
+            benchmark::do_not_optimize(vwritef_convert(os, format, value));
+        }
+    }) / static_cast<double>(values.size());
+
+    benchmark::report("  snprintf", snprintf_ns);
+    benchmark::report("  vwritef",  vwritef_ns);
+    benchmark::report_speedup("  speedup", snprintf_ns, vwritef_ns);
+    return true;
+}
+
+static bool run_fixed_point(std::vector<int32_t> const& raw_values)
+{
+    std::printf("Q16.16: \"%%q16.16\" vs \"%%.5f\" of the value as a double\n");
+
+    buffer_output_stream os;
+    char buffer[512u];
+    std::size_t failures = 0u;
+
+    for (int32_t raw : raw_values)
+    {
+        vwritef_convert(os, "%q16.16", raw);
+        std::snprintf(buffer, sizeof(buffer), "%.5f", raw / 65536.0);
+        if (std::strcmp(os.c_str(), buffer) != 0) { failures += 1u; }
+    }
+
+    if (failures > 0u)
+    {
+        std::printf("  FAILED validation: %zu values\n", failures);
+        return false;
+    }
+
+    std::size_t const passes = 10u;
+    double const snprintf_ns = benchmark::measure_ns(passes, [&]() {
+        for (int32_t raw : raw_values)
+        {
+            benchmark::do_not_optimize(std::snprintf(buffer, sizeof(buffer), "%.5f", raw / 65536.0));
+        }
+    }) / static_cast<double>(raw_values.size());
+
+    double const vwritef_ns = benchmark::measure_ns(passes, [&]() {
+        for (int32_t raw : raw_values)
+        {
+            benchmark::do_not_optimize(vwritef_convert(os, "%q16.16", raw));
+        }
+    }) / static_cast<double>(raw_values.size());
+
+    benchmark::report("  snprintf", snprintf_ns);
+    benchmark::report("  vwritef",  vwritef_ns);
+    benchmark::report_speedup("  speedup", snprintf_ns, vwritef_ns);
+    return true;
+}
+
+int main()
+{
+    std::size_t const value_count = 1000u * 1000u;
+    std::mt19937_64 generator(1u);
+
+    // Full range: random bit patterns.
+    std::vector<double> full_range;
+    full_range.reserve(value_count);
+    while (full_range.size() < value_count)
+    {
+        uint64_t const bits = generator();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isfinite(value)) { full_range.push_back(value); }
+    }
+
+    // Sensor range: values as logged; e.g. temperatures and voltages.
+    std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+    std::vector<double> sensor_range(value_count);
+    for (double& value : sensor_range) { value = distribution(generator); }
+
+    std::vector<int32_t> raw_values(value_count);
+    for (int32_t& raw : raw_values) { raw = static_cast<int32_t>(generator()); }
+
+    bool valid = true;
+    valid = run("Full range",   "%e",   full_range)   && valid;
+    valid = run("Full range",   "%g",   full_range)   && valid;
+    valid = run("Full range",   "%.17g", full_range)  && valid;
+    valid = run("Sensor range", "%g",   sensor_range) && valid;
+    valid = run("Sensor range", "%.3f", sensor_range) && valid;
+    valid = run("Sensor range", "%.2e", sensor_range) && valid;
+    valid = run_fixed_point(raw_values) && valid;
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file benchmark_gatt_table.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Compare a GATT server database built at runtime against the
+ * ble::gatt::table built at compile time:
+ * - startup: constructing the service and characteristic objects, linking
+ *   the intrusive lists and assigning handles in list order; as
+ *   nordic::gatts_service_add() does. The table has no startup work.
+ * - lookup: finding the attribute of each handle; the runtime services
+ *   through service::find_attribute(), the table by index.
+ * - RAM: the runtime objects are in RAM; the table attributes are const and
+ *   located in flash, only the characteristic values are in RAM.
+ */
+
+#include "benchmark.h"
+
+#include "ble/gatt_table.h"
+#include "ble/gatt_service.h"
+#include "ble/gatt_characteristic.h"
+#include "ble/service/battery_service.h"
+#include "ble/service/device_information_service.h"
+#include "ble/service/adc_sensor_service.h"
+#include "ble/service/custom_uuid.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <new>
+
+using namespace ble::gatt;
+namespace custom = ble::service::custom;
+
+static constexpr std::size_t const adc_channel_count   = 8u;
+static constexpr std::size_t const serial_number_size  = 16u;
+static constexpr uint16_t    const handle_first        = 12u;
+
+static constexpr boost::uuids::uuid const& adc_sensor_base =
+    custom::service_uuid_base<custom::services::adc_sensor>;
+
+using gatt_table = table<
+    handle_first,
+    schema::service<
+        schema::uuid16<service_type::battery_service>,
+        schema::characteristic<schema::uuid16<characteristic_type::battery_level>,
+                               properties::read | properties::notify, uint8_t, schema::cccd>,
+        schema::characteristic<schema::uuid16<characteristic_type::battery_power_state>,
+                               properties::read | properties::notify, uint8_t, schema::cccd>>,
+    schema::service<
+        schema::uuid16<service_type::device_information>,
+        schema::characteristic<schema::uuid16<characteristic_type::serial_number_string>,
+                               properties::read, std::array<char, serial_number_size>>>,
+    schema::service<
+        schema::uuid128<adc_sensor_base>,
+        schema::characteristic<
+            schema::uuid128<adc_sensor_base, static_cast<uint16_t>(custom::characteristics::adc_samples)>,
+            properties::read | properties::notify,
+            std::array<int16_t, adc_channel_count>,
+            schema::cccd>,
+        schema::characteristic<
+            schema::uuid128<adc_sensor_base, static_cast<uint16_t>(custom::characteristics::adc_enable)>,
+            properties::read_write,
+            std::array<bool, adc_channel_count>>>>;
+
+/// The same services built at runtime.
+struct runtime_database
+{
+    ble::service::battery_level                                     battery_level;
+    ble::service::battery_power_state                               battery_power_state;
+    ble::service::battery_service                                   battery_service;
+
+    ble::service::serial_number_string<serial_number_size>          serial_number;
+    ble::service::device_information_service                       device_information_service;
+
+    custom::adc_samples_characteristic<int16_t, adc_channel_count>  adc_samples;
+    custom::adc_enable_characteristic<adc_channel_count>            adc_enable;
+    custom::adc_sensor_service                                      adc_sensor_service;
+
+    service* const services[3u] = {
+        &battery_service, &device_information_service, &adc_sensor_service
+    };
+
+    runtime_database() : serial_number("0123456789ABCDEF")
+    {
+        battery_service.characteristic_add(battery_level);
+        battery_service.characteristic_add(battery_power_state);
+        device_information_service.characteristic_add(serial_number);
+        adc_sensor_service.characteristic_add(adc_samples);
+        adc_sensor_service.characteristic_add(adc_enable);
+
+        // Handles assigned in list order, as the softdevice does.
+        uint16_t handle = handle_first;
+        for (service* service_node : this->services)
+        {
+            service_node->decl.handle = handle++;
+            for (attribute& attr_node : service_node->characteristic_list)
+            {
+                characteristic& chr = static_cast<characteristic&>(attr_node);
+                chr.decl.handle  = handle++;
+                chr.value_handle = handle++;
+                for (attribute& descriptor : chr.descriptor_list)
+                {
+                    descriptor.decl.handle = handle++;
+                }
+            }
+        }
+    }
+
+    attribute const* find_attribute(uint16_t handle) const
+    {
+        for (service const* service_node : this->services)
+        {
+            attribute const* attr = service_node->find_attribute(handle);
+            if (attr) { return attr; }
+        }
+        return nullptr;
+    }
+};
+
+int main()
+{
+    alignas(runtime_database) static uint8_t database_storage[sizeof(runtime_database)];
+
+    double const runtime_startup_ns = benchmark::measure_ns(1000u * 1000u, []() {
+        runtime_database* database = new (database_storage) runtime_database;
+        benchmark::do_not_optimize(database);
+        database->~runtime_database();
+    });
+
+    runtime_database const database;
+    uint16_t const handle_end = gatt_table::handle_end();
+    std::size_t const passes = 100u * 1000u;
+
+    double const runtime_lookup_ns = benchmark::measure_ns(passes, [&database, handle_end]() {
+        for (uint16_t handle = handle_first; handle < handle_end; ++handle)
+        {
+            benchmark::do_not_optimize(database.find_attribute(handle));
+        }
+    }) / static_cast<double>(gatt_table::attribute_count);
+
+    double const table_lookup_ns = benchmark::measure_ns(passes, [handle_end]() {
+        for (uint16_t handle = handle_first; handle < handle_end; ++handle)
+        {
+            benchmark::do_not_optimize(gatt_table::find(handle));
+        }
+    }) / static_cast<double>(gatt_table::attribute_count);
+
+    std::printf("Battery, Device Information and ADC sensor services: %zu attributes\n",
+                gatt_table::attribute_count);
+    benchmark::report("startup: runtime build and handles", runtime_startup_ns);
+    benchmark::report("startup: table", 0.0);
+    benchmark::report("lookup: service::find_attribute", runtime_lookup_ns);
+    benchmark::report("lookup: table::find", table_lookup_ns);
+    benchmark::report_speedup("lookup speedup", runtime_lookup_ns, table_lookup_ns);
+
+    // The runtime database value storage is included in its object sizes.
+    std::printf("\n");
+    std::printf("%-40s %8zu bytes RAM\n", "runtime services", sizeof(runtime_database));
+    std::printf("%-40s %8zu bytes flash\n", "table attributes", sizeof(gatt_table::attributes));
+    std::printf("%-40s %8zu bytes RAM\n", "table value storage", sizeof(gatt_table::value_storage));
+    return 0;
+}
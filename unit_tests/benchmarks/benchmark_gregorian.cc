@@ -0,0 +1,159 @@
+/**
+ * @file benchmark_gregorian.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Compare the gregorian calendar conversions against the implementation
+ * they replaced:
+ * - to_calendar(): cascaded 64-bit divisions and a month by month loop.
+ * - seconds_since_epoch(): a month by month day of year loop.
+ * - to_chars(): snprintf().
+ */
+
+#include "benchmark.h"
+#include "gregorian.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+
+using utility::gregorian;
+
+namespace baseline
+{
+
+static constexpr uint32_t const seconds_per_day = 86400u;
+static constexpr uint64_t const days_per_400_years    = 146097u;
+static constexpr uint64_t const seconds_per_400_years = days_per_400_years * seconds_per_day;
+static constexpr uint64_t const days_per_100_years    = 36524u;
+static constexpr uint64_t const seconds_per_100_years = days_per_100_years * seconds_per_day;
+static constexpr uint64_t const days_per_4_years      = 1461u;
+static constexpr uint64_t const seconds_per_4_years   = days_per_4_years * seconds_per_day;
+static constexpr uint64_t const seconds_per_1_years   = 365u * seconds_per_day;
+
+static gregorian to_calendar(uint64_t seconds_since_epoch)
+{
+    uint64_t span_400 = seconds_since_epoch  / seconds_per_400_years;
+                        seconds_since_epoch -= seconds_per_400_years * span_400;
+    uint64_t span_100 = seconds_since_epoch  / seconds_per_100_years;
+             span_100 = (span_100 > 3u) ? 3u : span_100;
+                        seconds_since_epoch -= seconds_per_100_years * span_100;
+    uint64_t span_4   = seconds_since_epoch  / seconds_per_4_years;
+             span_4   = (span_4 > 24u) ? 24u : span_4;
+                        seconds_since_epoch -= seconds_per_4_years * span_4;
+    uint64_t span_1   = seconds_since_epoch  / seconds_per_1_years;
+             span_1   = (span_1 > 3u) ? 3u : span_1;
+                        seconds_since_epoch -= seconds_per_1_years * span_1;
+
+    uint16_t const year = span_400 * 400u + span_100 * 100u + span_4 * 4u + span_1 +
+                          gregorian::epoch_year;
+    uint16_t const day_of_year  = seconds_since_epoch  / seconds_per_day;
+                                  seconds_since_epoch -= seconds_per_day * day_of_year;
+
+    uint16_t day_count = day_of_year;
+    for (uint8_t month_iter = gregorian::January; month_iter <= gregorian::December; ++month_iter)
+    {
+        uint16_t const days_in_month_iter = gregorian::days_in_month(month_iter, year);
+        if (day_count >= days_in_month_iter)
+        {
+            day_count -= days_in_month_iter;
+        }
+        else
+        {
+            uint8_t const hours = seconds_since_epoch / 3600u;
+            seconds_since_epoch -= hours * 3600u;
+            uint8_t const minutes = seconds_since_epoch / 60u;
+            seconds_since_epoch -= minutes * 60u;
+            return gregorian(year, month_iter, day_count + 1u,
+                             hours, minutes, seconds_since_epoch);
+        }
+    }
+    return gregorian();
+}
+
+static uint64_t seconds_since_epoch(gregorian const& greg)
+{
+    uint16_t day_of_year = 0u;
+    for (uint8_t month_iter = gregorian::January; month_iter < greg.month; ++month_iter)
+    {
+        day_of_year += gregorian::days_in_month(month_iter, greg.year);
+    }
+    day_of_year += greg.day_of_month;
+
+    uint64_t const day_count = (greg.year - gregorian::epoch_year) * 365u +
+                               gregorian::leap_years_since_epoch(greg.year) +
+                               day_of_year - 1u;
+
+    return day_count * seconds_per_day + greg.hours * 3600u + greg.minutes * 60u + greg.seconds;
+}
+
+static void to_chars(char *first, char *last, gregorian const& greg)
+{
+    // Clamp the fields to their printed widths so that the formatted
+    // length provably fits gregorian::char_buffer_size.
+    snprintf(first, last - first, "%04u-%02u-%02uT%02u:%02u:%02u",
+             greg.year % 10000u, greg.month   % 100u, greg.day_of_month % 100u,
+             greg.hours % 100u,  greg.minutes % 100u, greg.seconds      % 100u);
+}
+
+} // namespace baseline
+
+int main()
+{
+    std::size_t const iterations = 2000000u;
+
+    // Step through 1601 .. 2700 by a prime number of seconds so that the
+    // dates fall on every month and time of day.
+    uint64_t const seconds_step = 17325241u;
+    uint64_t const seconds_end  = uint64_t(401768u) * 86400u;
+    uint64_t seconds = 0u;
+    auto next_seconds = [&]() {
+        seconds += seconds_step;
+        seconds  = (seconds >= seconds_end) ? seconds - seconds_end : seconds;
+        return seconds;
+    };
+
+    double const calendar_base_ns = benchmark::measure_ns(iterations, [&]() {
+        gregorian const greg = baseline::to_calendar(next_seconds());
+        benchmark::do_not_optimize(greg);
+    });
+
+    double const calendar_ns = benchmark::measure_ns(iterations, [&]() {
+        gregorian const greg = gregorian::to_calendar(next_seconds());
+        benchmark::do_not_optimize(greg);
+    });
+
+    gregorian const greg_now(2018u, gregorian::November, 23u, 17u, 45u, 12u);
+
+    double const seconds_base_ns = benchmark::measure_ns(iterations, [&]() {
+        uint64_t const result = baseline::seconds_since_epoch(greg_now);
+        benchmark::do_not_optimize(result);
+    });
+
+    double const seconds_ns = benchmark::measure_ns(iterations, [&]() {
+        uint64_t const result = gregorian::seconds_since_epoch(greg_now);
+        benchmark::do_not_optimize(result);
+    });
+
+    char buffer[gregorian::char_buffer_size];
+    double const chars_base_ns = benchmark::measure_ns(iterations, [&]() {
+        baseline::to_chars(std::begin(buffer), std::end(buffer), greg_now);
+        benchmark::do_not_optimize(buffer);
+    });
+
+    double const chars_ns = benchmark::measure_ns(iterations, [&]() {
+        gregorian::to_chars(std::begin(buffer), std::end(buffer), greg_now);
+        benchmark::do_not_optimize(buffer);
+    });
+
+    benchmark::report("to_calendar, baseline",               calendar_base_ns);
+    benchmark::report("to_calendar",                         calendar_ns);
+    benchmark::report("seconds_since_epoch, baseline",       seconds_base_ns);
+    benchmark::report("seconds_since_epoch",                 seconds_ns);
+    benchmark::report("to_chars, snprintf baseline",         chars_base_ns);
+    benchmark::report("to_chars",                            chars_ns);
+    benchmark::report_speedup("to_calendar speedup",         calendar_base_ns, calendar_ns);
+    benchmark::report_speedup("seconds_since_epoch speedup", seconds_base_ns,  seconds_ns);
+    benchmark::report_speedup("to_chars speedup",            chars_base_ns,    chars_ns);
+
+    return 0;
+}
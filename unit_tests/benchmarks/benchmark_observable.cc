@@ -0,0 +1,166 @@
+/**
+ * @file benchmark_observable.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Deliver notifications to 1, 8 and 32 observers through:
+ * - observable: the intrusive list with a virtual notify() per observer.
+ * - priority_observable: the sorted intrusive list, one notification and
+ *   batches of notifications per observer visit.
+ * - observer_array: the contiguous array of a final observer class,
+ *   one notification and batches of notifications per observer visit.
+ */
+
+#include "benchmark.h"
+#include "observable.h"
+#include "observer_array.h"
+#include "priority_observable.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+static constexpr std::size_t const batch_size        = 16u;
+static constexpr std::size_t const notification_count = 1u << 20u;
+
+class list_observer: public observer<uint32_t>
+{
+public:
+    void notify(uint32_t const &notification) override { this->sum += notification; }
+    uint64_t sum = 0u;
+};
+
+class sorted_observer: public priority_observer<uint32_t>
+{
+public:
+    void notify(uint32_t const &notification) override { this->sum += notification; }
+
+    void notify_batch(uint32_t const *notifications, std::size_t count) override
+    {
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            this->sum += notifications[index];
+        }
+    }
+
+    uint64_t sum = 0u;
+};
+
+class array_observer final
+{
+public:
+    using notification_type = uint32_t;
+
+    void notify(uint32_t const &notification) { this->sum += notification; }
+
+    void notify_batch(uint32_t const *notifications, std::size_t count)
+    {
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            this->sum += notifications[index];
+        }
+    }
+
+    uint64_t sum = 0u;
+};
+
+/** @return double The notifications delivered to all observers per second. */
+static double per_second(double ns_per_notification)
+{
+    return 1.0e9 / ns_per_notification;
+}
+
+static void report_rate(char const* name, std::size_t observer_count, double ns)
+{
+    char label[64u];
+    std::snprintf(label, sizeof(label), "%s [%2zu]", name, observer_count);
+    std::printf("%-40s %12.2f ns/notify %10.2f M notify/s\n",
+                label, ns, per_second(ns) / 1.0e6);
+}
+
+template <std::size_t observer_count>
+static void run()
+{
+    uint32_t notifications[batch_size];
+    for (std::size_t index = 0u; index < batch_size; ++index)
+    {
+        notifications[index] = static_cast<uint32_t>(index * 3u + 1u);
+    }
+
+    // Allocate the list observers separately, as attached objects typically
+    // are, rather than in one contiguous block.
+    std::vector<std::unique_ptr<list_observer>>     list_observers;
+    std::vector<std::unique_ptr<sorted_observer>>   sorted_observers;
+    std::vector<array_observer>                     array_observers(observer_count);
+
+    observable<uint32_t>                            list_observable;
+    priority_observable<uint32_t>                   sorted_observable;
+    observer_array<array_observer, observer_count>  array_observable;
+
+    for (std::size_t index = 0u; index < observer_count; ++index)
+    {
+        list_observers.emplace_back(new list_observer);
+        sorted_observers.emplace_back(new sorted_observer);
+        list_observable.attach(*list_observers.back());
+        sorted_observable.attach(*sorted_observers.back(),
+                                 static_cast<int8_t>(index % 4u));
+        array_observable.attach(array_observers[index],
+                                static_cast<int8_t>(index % 4u));
+    }
+
+    std::size_t const iterations = notification_count / observer_count;
+    std::size_t const batches    = iterations / batch_size;
+
+    uint32_t value = 0u;
+    double const list_ns = benchmark::measure_ns(iterations, [&]() {
+        list_observable.notify_all(++value);
+    });
+
+    double const sorted_ns = benchmark::measure_ns(iterations, [&]() {
+        sorted_observable.notify_all(++value);
+    });
+
+    double const sorted_batch_ns = benchmark::measure_ns(batches, [&]() {
+        notifications[0] = ++value;
+        sorted_observable.notify_batch(notifications, batch_size);
+    }) / batch_size;
+
+    double const array_ns = benchmark::measure_ns(iterations, [&]() {
+        array_observable.notify_all(++value);
+    });
+
+    double const array_batch_ns = benchmark::measure_ns(batches, [&]() {
+        notifications[0] = ++value;
+        array_observable.notify_batch(notifications, batch_size);
+    }) / batch_size;
+
+    uint64_t sum = 0u;
+    for (std::size_t index = 0u; index < observer_count; ++index)
+    {
+        sum += list_observers[index]->sum;
+        sum += sorted_observers[index]->sum;
+        sum += array_observers[index].sum;
+        sorted_observable.detach(*sorted_observers[index]);
+        list_observable.detach(*list_observers[index]);
+    }
+    benchmark::do_not_optimize(sum);
+
+    report_rate("observable",                    observer_count, list_ns);
+    report_rate("priority_observable",           observer_count, sorted_ns);
+    report_rate("priority_observable batch",     observer_count, sorted_batch_ns);
+    report_rate("observer_array",                observer_count, array_ns);
+    report_rate("observer_array batch",          observer_count, array_batch_ns);
+    benchmark::report_speedup("observer_array vs observable",       list_ns, array_ns);
+    benchmark::report_speedup("observer_array batch vs observable", list_ns, array_batch_ns);
+    std::printf("\n");
+}
+
+int main()
+{
+    std::printf("Notification cost to all observers, %zu notifications per batch\n\n",
+                batch_size);
+    run<1u>();
+    run<8u>();
+    run<32u>();
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file benchmark_rtt.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Write 1, 16, 256 and 4096 bytes into an RTT up buffer through:
+ * - baseline: the rtt_write() which copied with std::copy(). On the host
+ *   this is the libc memmove().
+ * - bytewise: the same with a byte loop, as the size optimized newlib-nano
+ *   memcpy() used on the target copies.
+ * - SEGGER_RTT_Write(): the word copy kernel.
+ * The host drains the ring after each write so that no write is truncated.
+ */
+
+#include "benchmark.h"
+#include "segger_rtt.h"
+#include "segger_rtt_control_block.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+namespace baseline
+{
+
+static size_t rtt_write_avail(size_t read_offset, size_t write_offset, size_t length)
+{
+    return (read_offset > write_offset) ? read_offset - write_offset - 1u
+                                        : read_offset - write_offset + length - 1u;
+}
+
+/// The rtt_write() implementation prior to the word copy kernel.
+template <bool bytewise>
+static size_t rtt_write(rtt_buffer_up_t* rtt_ring_buffer,
+                        void const*      buffer,
+                        size_t           buffer_length)
+{
+    auto copy = [](char const* first, char const* last, char* dest) {
+        if (bytewise)
+        {
+            char volatile* dest_byte = dest;
+            while (first != last) { *dest_byte++ = *first++; }
+        }
+        else
+        {
+            std::copy(first, last, dest);
+        }
+    };
+
+    char   const* buffer_iter   = reinterpret_cast<char const *>(buffer);
+    size_t        write_offset  = rtt_ring_buffer->write_offset;
+    size_t const  read_offset   = rtt_ring_buffer->read_offset;
+    size_t        write_avail   = rtt_write_avail(read_offset, write_offset,
+                                                  rtt_ring_buffer->length);
+    size_t const  write_linear  = rtt_ring_buffer->length - write_offset;
+    size_t const  avail_linear  = std::min(write_avail,  write_linear);
+    size_t const  buffer_linear = std::min(avail_linear, buffer_length);
+
+    copy(buffer_iter, buffer_iter + buffer_linear,
+         &rtt_ring_buffer->base_pointer[write_offset]);
+
+    write_offset    += buffer_linear;
+    buffer_iter     += buffer_linear;
+    buffer_length   -= buffer_linear;
+    write_avail     -= buffer_linear;
+
+    size_t const write_remain = std::min(buffer_length, write_avail);
+    if (write_remain > 0u)
+    {
+        copy(buffer_iter, buffer_iter + write_remain, rtt_ring_buffer->base_pointer);
+        write_offset = write_remain;
+        buffer_iter += write_remain;
+    }
+    else if (write_offset >= rtt_ring_buffer->length)
+    {
+        write_offset = 0u;
+    }
+
+    rtt_ring_buffer->write_offset = write_offset;
+    return buffer_iter - reinterpret_cast<char const *>(buffer);
+}
+
+} // namespace baseline
+
+static constexpr size_t const ring_size = 8192u + 1u;
+
+alignas(4) static char ring_baseline[ring_size];
+alignas(4) static char ring_optimized[ring_size];
+
+static void run(size_t write_size, size_t src_offset, size_t iterations)
+{
+    alignas(4) static uint8_t source[4096u + 4u];
+    for (size_t index = 0u; index < sizeof(source); ++index)
+    {
+        source[index] = static_cast<uint8_t>(index);
+    }
+    uint8_t const* const data = source + src_offset;
+
+    rtt_buffer_up_t baseline_ring = {};
+    baseline_ring.base_pointer = ring_baseline;
+    baseline_ring.length       = ring_size;
+
+    rtt_control_block_t* const control_block = static_cast<rtt_control_block_t*>(
+        const_cast<void*>(segger_rtt_control_block()));
+    rtt_buffer_up_t& optimized_ring = control_block->buffer_up[0];
+
+    double const std_copy_ns = benchmark::measure_ns(iterations, [&]() {
+        benchmark::do_not_optimize(baseline::rtt_write<false>(&baseline_ring, data, write_size));
+        baseline_ring.read_offset = baseline_ring.write_offset;
+    });
+
+    double const bytewise_ns = benchmark::measure_ns(iterations, [&]() {
+        benchmark::do_not_optimize(baseline::rtt_write<true>(&baseline_ring, data, write_size));
+        baseline_ring.read_offset = baseline_ring.write_offset;
+    });
+
+    double const optimized_ns = benchmark::measure_ns(iterations, [&]() {
+        benchmark::do_not_optimize(SEGGER_RTT_Write(0u, data, write_size));
+        optimized_ring.read_offset = optimized_ring.write_offset;
+    });
+
+    char label[64u];
+    std::snprintf(label, sizeof(label), "std::copy %4zu bytes%s",
+                  write_size, src_offset ? " unaligned" : "");
+    benchmark::report(label, std_copy_ns);
+    std::snprintf(label, sizeof(label), "bytewise  %4zu bytes%s",
+                  write_size, src_offset ? " unaligned" : "");
+    benchmark::report(label, bytewise_ns);
+    std::snprintf(label, sizeof(label), "SEGGER_RTT_Write %4zu bytes%s",
+                  write_size, src_offset ? " unaligned" : "");
+    benchmark::report(label, optimized_ns);
+    benchmark::report_speedup("  vs std::copy", std_copy_ns, optimized_ns);
+    benchmark::report_speedup("  vs bytewise",  bytewise_ns, optimized_ns);
+}
+
+int main()
+{
+    rtt_channel_alloc const channel_alloc = {
+        .direction   = rtt_channel_alloc::up,
+        .channel     = 0u,
+        .buffer      = ring_optimized,
+        .buffer_size = ring_size,
+        .name        = nullptr
+    };
+    segger_rtt_channel_allocate(&channel_alloc);
+    segger_rtt_enable();
+
+    run(1u,    0u, 4u * 1000u * 1000u);
+    run(16u,   0u, 4u * 1000u * 1000u);
+    run(256u,  0u, 1000u * 1000u);
+    run(4096u, 0u, 100u * 1000u);
+    run(4096u, 1u, 100u * 1000u);
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file benchmark_twis_register_map.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Compare register map transactions per second on the host TWIS model:
+ * - baseline: the twis_enable_read()/twis_enable_write() pattern. The ISR
+ *   passes each event to the application, which decodes the register
+ *   address, copies register data to and from its raw buffers and re-arms
+ *   the TWIS for the next transaction.
+ * - twis_register_map: the ISR arms the DMA in and out of the register file
+ *   and notifies the application of the registers written.
+ *
+ * The transaction mix is a register read (address write, repeated start,
+ * 4 byte read) and a register write (address and 2 data bytes).
+ */
+
+#include "benchmark.h"
+#include "twis_register_map.h"
+#include "twis_register_model.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+static constexpr std::size_t const register_file_length = 64u;
+static constexpr std::size_t const write_max            = twis_register_write_max;
+
+/**
+ * The baseline: the application implements the register map on top of the
+ * raw buffer transfers. The ISR mirrors irq_handler_twis(); the arming
+ * mirrors twis_enable_read() and twis_enable_write() without the NVIC.
+ */
+class baseline_register_map
+{
+public:
+    explicit baseline_register_map(twis_registers_model& registers)
+        : twis_registers_(registers), file_{}, rx_buffer_{}, tx_buffer_{},
+          pointer_(0u), dirty_count_(0u)
+    {
+    }
+
+    void irq_handler()
+    {
+        twis_event_t event = {
+            .type       = twi_event_none,
+            .xfer       = { .tx_bytes = 0u, .rx_bytes = 0u },
+            .addr_index = 0u
+        };
+
+        if (this->twis_registers_.EVENTS_STOPPED)
+        {
+            event.type         |= twi_event_stopped;
+            event.xfer.tx_bytes = this->twis_registers_.TXD.AMOUNT;
+            event.xfer.rx_bytes = this->twis_registers_.RXD.AMOUNT;
+            this->twis_registers_.EVENTS_STOPPED = 0u;
+        }
+        if (this->twis_registers_.EVENTS_ERROR)
+        {
+            this->twis_registers_.EVENTS_ERROR = 0u;
+        }
+        if (this->twis_registers_.EVENTS_WRITE)
+        {
+            event.type |= twis_event_write_cmd;
+            event.xfer.rx_bytes = this->twis_registers_.RXD.AMOUNT;
+            this->twis_registers_.EVENTS_WRITE = 0u;
+        }
+        if (this->twis_registers_.EVENTS_READ)
+        {
+            event.type |= twis_event_read_cmd;
+            event.xfer.rx_bytes = this->twis_registers_.RXD.AMOUNT;
+            this->twis_registers_.EVENTS_READ = 0u;
+        }
+
+        this->event_handler(&event);
+    }
+
+    std::size_t dirty_count() const { return this->dirty_count_; }
+
+private:
+    void event_handler(twis_event_t const* event)
+    {
+        if (event->type & (twis_event_read_cmd | twi_event_stopped))
+        {
+            this->apply_write(event->xfer.rx_bytes);
+        }
+
+        if (event->type & twis_event_write_cmd)
+        {
+            this->apply_write(event->xfer.rx_bytes);
+            this->enable_transfer();
+            this->twis_registers_.RXD.PTR    = reinterpret_cast<uintptr_t>(this->rx_buffer_.data());
+            this->twis_registers_.RXD.MAXCNT = this->rx_buffer_.size();
+            this->twis_registers_.RXD.AMOUNT = 0u;
+            this->twis_registers_.TASKS_PREPARERX = 1u;
+        }
+
+        if (event->type & twis_event_read_cmd)
+        {
+            // The raw buffer interface: copy out of the register file.
+            std::size_t const length = register_file_length - this->pointer_;
+            std::memcpy(this->tx_buffer_.data(), &this->file_[this->pointer_], length);
+            this->enable_transfer();
+            this->twis_registers_.TXD.PTR    = reinterpret_cast<uintptr_t>(this->tx_buffer_.data());
+            this->twis_registers_.TXD.MAXCNT = length;
+            this->twis_registers_.TASKS_PREPARETX = 1u;
+        }
+
+        if ((event->type & twi_event_stopped) && event->xfer.tx_bytes)
+        {
+            this->pointer_ = std::min(this->pointer_ + event->xfer.tx_bytes, register_file_length);
+            this->twis_registers_.TXD.AMOUNT = 0u;
+        }
+    }
+
+    /// twis_enable_read(), twis_enable_write(): clear all events, set INTEN.
+    void enable_transfer()
+    {
+        this->twis_registers_.EVENTS_STOPPED = 0u;
+        this->twis_registers_.EVENTS_ERROR   = 0u;
+        this->twis_registers_.EVENTS_WRITE   = 0u;
+        this->twis_registers_.EVENTS_READ    = 0u;
+        benchmark::do_not_optimize(this->twis_registers_);
+    }
+
+    void apply_write(std::size_t rx_bytes)
+    {
+        if (rx_bytes == 0u) { return; }
+        this->pointer_ = std::min<std::size_t>(this->rx_buffer_[0u], register_file_length);
+        std::size_t const length = std::min(rx_bytes - 1u, register_file_length - this->pointer_);
+        if (length > 0u)
+        {
+            std::memcpy(&this->file_[this->pointer_], &this->rx_buffer_[1u], length);
+            this->dirty_count_ += 1u;
+        }
+        this->pointer_ += length;
+        this->twis_registers_.RXD.AMOUNT = 0u;
+    }
+
+    twis_registers_model&                       twis_registers_;
+    std::array<uint8_t, register_file_length>   file_;
+    std::array<uint8_t, 1u + write_max>         rx_buffer_;
+    std::array<uint8_t, register_file_length>   tx_buffer_;
+    std::size_t                                 pointer_;
+    std::size_t                                 dirty_count_;
+};
+
+template <typename master_type>
+static void transaction_mix(master_type& master, uint8_t address)
+{
+    bool const repeated_start = false;
+    std::array<uint8_t, 4u> read;
+    master.write(&address, sizeof(address), repeated_start);
+    master.read(read.data(), read.size());
+    benchmark::do_not_optimize(read);
+
+    uint8_t const write[] = { static_cast<uint8_t>(address + 8u), 0x12u, 0x34u };
+    master.write(write, sizeof(write));
+}
+
+int main()
+{
+    std::size_t const iterations = 1000u * 1000u;
+    std::size_t const transactions_per_iteration = 3u;
+
+    twis_registers_model baseline_registers = {};
+    baseline_register_map baseline(baseline_registers);
+    auto baseline_isr = [&baseline]() { baseline.irq_handler(); };
+    twis_master_model<decltype(baseline_isr)> baseline_master(baseline_registers, baseline_isr);
+
+    twis_registers_model map_registers = {};
+    static std::array<uint8_t, register_file_length> register_file;
+    twis_register_map<write_max> register_map;
+    register_map.assign(register_file.data(), register_file.size(), register_file.size());
+    std::size_t dirty_count = 0u;
+    auto map_isr = [&register_map, &map_registers, &dirty_count]() {
+        twis_register_range_t const dirty = register_map.irq_handler(map_registers);
+        if (dirty.begin != dirty.end) { dirty_count += 1u; }
+    };
+    twis_master_model<decltype(map_isr)> map_master(map_registers, map_isr);
+
+    uint8_t address = 0u;
+    double const baseline_ns = benchmark::measure_ns(iterations, [&]() {
+        transaction_mix(baseline_master, address);
+        address = (address + 4u) & 0x1Fu;
+    }) / transactions_per_iteration;
+
+    address = 0u;
+    double const map_ns = benchmark::measure_ns(iterations, [&]() {
+        transaction_mix(map_master, address);
+        address = (address + 4u) & 0x1Fu;
+    }) / transactions_per_iteration;
+
+    if (baseline.dirty_count() != dirty_count)
+    {
+        std::printf("dirty notification mismatch: %zu, %zu\n", baseline.dirty_count(), dirty_count);
+        return 1;
+    }
+
+    benchmark::report("baseline: per transaction", baseline_ns);
+    benchmark::report("twis_register_map: per transaction", map_ns);
+    benchmark::report_speedup("speedup", baseline_ns, map_ns);
+
+    std::printf("\n");
+    std::printf("%-40s %12.0f transactions/s\n", "baseline", 1.0e9 / baseline_ns);
+    std::printf("%-40s %12.0f transactions/s\n", "twis_register_map", 1.0e9 / map_ns);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_advertising_layout.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/gap_advertising_layout.h"
+#include "ble/gap_address.h"
+#include "ble/gatt_enum_types.h"
+#include "ble/ltv_encode.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace ble::gap;
+
+namespace
+{
+
+constexpr std::array<char, 6u> const short_name = {{ 'p', 'e', 'r', 'i', 'p', 'h' }};
+
+constexpr std::array<ble::gatt::service_type, 3u> const services_16 = {{
+    ble::gatt::service_type::device_information,
+    ble::gatt::service_type::battery_service,
+    ble::gatt::service_type::current_time_service,
+}};
+
+constexpr std::array<uint8_t, address::octet_length> const address_octets = {{
+    0x11u, 0x22u, 0x33u, 0x44u, 0x55u, 0xC6u
+}};
+
+constexpr uint16_t const company_id       = 0x0059u;
+constexpr uint16_t const battery_uuid     = 0x180Fu;
+
+/// The ble_peripheral advertising data with manufacturer and battery data.
+using beacon_layout = advertising_layout<
+    ltv_field<type::flags, uint8_t>,
+    ltv_field<type::local_name_short, std::array<char, 6u>>,
+    ltv_field<type::device_dddress, uint8_t, std::array<uint8_t, address::octet_length>>,
+    ltv_field<type::uuid_service_16_incomplete, std::array<ble::gatt::service_type, 3u>>>;
+
+using sensor_layout = advertising_layout<
+    ltv_field<type::flags, uint8_t>,
+    ltv_field<type::manufacturer_specific_data, uint16_t, int16_t>,
+    ltv_field<type::service_data_uuid_16, uint16_t, uint8_t>>;
+
+std::vector<uint8_t> to_vector(advertising_data const& data)
+{
+    return std::vector<uint8_t>(data.data(), data.data() + data.size());
+}
+
+/// Encode the sensor advertising data with ltv_encode().
+void sensor_encode(advertising_data& data, int16_t sensor_value, uint8_t battery_level)
+{
+    uint8_t const flags = static_cast<uint8_t>(le_general_discovery);
+    ltv_encode(data, type::flags, flags);
+
+    // Multiple values in one LTV are encoded as a struct would be, packed.
+    uint8_t manufacturer_data[4u] = {
+        static_cast<uint8_t>(company_id), static_cast<uint8_t>(company_id >> 8u),
+        static_cast<uint8_t>(sensor_value), static_cast<uint8_t>(sensor_value >> 8u),
+    };
+    ltv_encode(data, type::manufacturer_specific_data, manufacturer_data, sizeof(manufacturer_data));
+
+    uint8_t service_data[3u] = {
+        static_cast<uint8_t>(battery_uuid), static_cast<uint8_t>(battery_uuid >> 8u),
+        battery_level,
+    };
+    ltv_encode(data, type::service_data_uuid_16, service_data, sizeof(service_data));
+}
+
+} // anonymous namespace
+
+TEST(AdvertisingLayout, Offsets)
+{
+    static_assert(sensor_layout::length == 3u + 6u + 5u);
+    static_assert(sensor_layout::field_offset<0>()    == 0u);
+    static_assert(sensor_layout::field_offset<1>()    == 3u);
+    static_assert(sensor_layout::field_offset<2>()    == 9u);
+    static_assert(sensor_layout::value_offset<1, 0>() == 5u);
+    static_assert(sensor_layout::value_offset<1, 1>() == 7u);
+    static_assert(sensor_layout::value_offset<2, 1>() == 13u);
+
+    // The template carries the LTV length and type octets.
+    std::array<uint8_t, sensor_layout::length> const expected = {{
+        2u, 0x01u, 0u,
+        5u, 0xFFu, 0u, 0u, 0u, 0u,
+        4u, 0x16u, 0u, 0u, 0u,
+    }};
+    EXPECT_EQ(sensor_layout::template_data, expected);
+}
+
+TEST(AdvertisingLayout, MatchesLtvEncode)
+{
+    advertising_data encoded;
+    ltv_encode(encoded, type::flags, static_cast<uint8_t>(le_general_discovery));
+    ltv_encode(encoded, type::local_name_short, short_name.data(), short_name.size());
+    ltv_encode_address(encoded, true, address_octets.data());
+    ltv_encode(encoded, type::uuid_service_16_incomplete, services_16.data(), services_16.size());
+
+    // The constant fields are set at compile time.
+    static constexpr beacon_layout::container const beacon = []() {
+        beacon_layout::container payload = beacon_layout::template_data;
+        beacon_layout::set<0>(payload, static_cast<uint8_t>(le_general_discovery));
+        beacon_layout::set<1>(payload, short_name);
+        beacon_layout::set<2, 0>(payload, uint8_t{1u});             // random address
+        beacon_layout::set<2, 1>(payload, address_octets);
+        beacon_layout::set<3>(payload, services_16);
+        return payload;
+    }();
+
+    advertising_data data;
+    beacon_layout::assign(data, beacon);
+
+    EXPECT_EQ(to_vector(data), to_vector(encoded));
+}
+
+TEST(AdvertisingLayout, PatchMatchesReencode)
+{
+    advertising_data data;
+    sensor_layout::assign(data);
+    sensor_layout::set<0>(data, static_cast<uint8_t>(le_general_discovery));
+    sensor_layout::set<1, 0>(data, company_id);
+    sensor_layout::set<2, 0>(data, battery_uuid);
+
+    int16_t const sensor_values[]  = { 0, 1, -1, 2500, -32768, 32767 };
+    uint8_t const battery_levels[] = { 100u, 99u, 50u, 0u, 7u, 255u };
+
+    for (std::size_t index = 0u; index < std::size(sensor_values); ++index)
+    {
+        sensor_layout::set<1, 1>(data, sensor_values[index]);
+        sensor_layout::set<2, 1>(data, battery_levels[index]);
+
+        advertising_data encoded;
+        sensor_encode(encoded, sensor_values[index], battery_levels[index]);
+
+        EXPECT_EQ(to_vector(data), to_vector(encoded)) << "index: " << index;
+    }
+}
+
+TEST(AdvertisingLayout, AssignTruncates)
+{
+    uint8_t const payload[advertising_data::max_length + 4u] = {};
+
+    advertising_data data;
+    data.assign(payload, sizeof(payload));
+    EXPECT_EQ(data.size(), advertising_data::max_length);
+
+    data.assign(payload, 3u);
+    EXPECT_EQ(data.size(), 3u);
+}
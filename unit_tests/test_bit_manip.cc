@@ -7,8 +7,10 @@
 #include "bit_manip.h"
 
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 static constexpr bool debug_print = false;
 
@@ -158,3 +160,161 @@ TEST(BitManipSignExtend_64, Value_0x000000000)
 
     ASSERT_EQ(test_value, test_sign_ext);
 }
+
+static unsigned int popcount_naive(uint64_t value)
+{
+    unsigned int count = 0u;
+    for (; value != 0u; value >>= 1u) { count += value & 1u; }
+    return count;
+}
+
+static unsigned int clz_naive(uint64_t value, unsigned int bits)
+{
+    unsigned int count = 0u;
+    for (unsigned int pos = bits; pos-- > 0u; ++count)
+    {
+        if (value & (uint64_t(1u) << pos)) { break; }
+    }
+    return count;
+}
+
+static unsigned int ctz_naive(uint64_t value, unsigned int bits)
+{
+    unsigned int count = 0u;
+    for (; (count < bits) && not (value & (uint64_t(1u) << count)); ++count) {}
+    return count;
+}
+
+/// A xorshift generator; deterministic values spread across all bits.
+static uint64_t bit_manip_random(uint64_t& state)
+{
+    state ^= state << 13u;
+    state ^= state >>  7u;
+    state ^= state << 17u;
+    return state;
+}
+
+static_assert(bit_manip::popcount(uint32_t(0xF0F0F0F0u)) == 16u);
+static_assert(bit_manip::count_leading_zeros(uint8_t(0x01u)) == 7u);
+static_assert(bit_manip::count_leading_zeros(uint16_t(0u)) == 16u);
+static_assert(bit_manip::count_trailing_zeros(uint64_t(1u) << 40u) == 40u);
+static_assert(bit_manip::field_get<4u, 8u>(uint32_t(0x12345678u)) == 0x6u);
+static_assert(bit_manip::field_set<4u, 8u>(uint32_t(0x12345678u), 0xAu) == 0x12345A78u);
+static_assert(bit_manip::endian_swap_32(0x12345678u) == 0x78563412u);
+
+TEST(BitManipCount, Exhaustive_16)
+{
+    unsigned int failures = 0u;
+    for (uint32_t value = 0u; value <= UINT16_MAX; ++value)
+    {
+        uint16_t const value_16 = static_cast<uint16_t>(value);
+        uint8_t  const value_8  = static_cast<uint8_t>(value);
+        if ((bit_manip::popcount(value_16) != popcount_naive(value_16)) ||
+            (bit_manip::count_leading_zeros(value_16)  != clz_naive(value_16, 16u)) ||
+            (bit_manip::count_trailing_zeros(value_16) != ctz_naive(value_16, 16u)) ||
+            (bit_manip::popcount(value_8) != popcount_naive(value_8)) ||
+            (bit_manip::count_leading_zeros(value_8)   != clz_naive(value_8, 8u)) ||
+            (bit_manip::count_trailing_zeros(value_8)  != ctz_naive(value_8, 8u)))
+        {
+            if (++failures <= 4u) { ADD_FAILURE() << "value: " << value; }
+        }
+    }
+}
+
+TEST(BitManipCount, Random_32_64)
+{
+    uint64_t state = 0x0123456789abcdefULL;
+    unsigned int failures = 0u;
+    for (unsigned int iter = 0u; iter < 100000u; ++iter)
+    {
+        // Clear a random number of high bits to exercise leading zero counts.
+        uint64_t const random   = bit_manip_random(state);
+        uint64_t const value_64 = random >> (iter % 64u);
+        uint32_t const value_32 = static_cast<uint32_t>(random) >> (iter % 32u);
+        if ((bit_manip::popcount(value_64) != popcount_naive(value_64)) ||
+            (bit_manip::count_leading_zeros(value_64)  != clz_naive(value_64, 64u)) ||
+            (bit_manip::count_trailing_zeros(value_64) != ctz_naive(value_64, 64u)) ||
+            (bit_manip::popcount(value_32) != popcount_naive(value_32)) ||
+            (bit_manip::count_leading_zeros(value_32)  != clz_naive(value_32, 32u)) ||
+            (bit_manip::count_trailing_zeros(value_32) != ctz_naive(value_32, 32u)))
+        {
+            if (++failures <= 4u) { ADD_FAILURE() << "value: 0x" << std::hex << value_64; }
+        }
+    }
+
+    EXPECT_EQ(bit_manip::count_leading_zeros(uint64_t(0u)),  64u);
+    EXPECT_EQ(bit_manip::count_trailing_zeros(uint64_t(0u)), 64u);
+    EXPECT_EQ(bit_manip::count_leading_zeros(uint32_t(0u)),  32u);
+    EXPECT_EQ(bit_manip::count_trailing_zeros(uint32_t(0u)), 32u);
+}
+
+TEST(BitManipField, MatchesValueGetSet)
+{
+    uint64_t state = 0xfedcba9876543210ULL;
+    for (unsigned int iter = 0u; iter < 1000u; ++iter)
+    {
+        uint32_t const value = static_cast<uint32_t>(bit_manip_random(state));
+        uint32_t const field = static_cast<uint32_t>(bit_manip_random(state));
+
+        ASSERT_EQ((bit_manip::field_get<1u,  0u>(value)), (bit_manip::value_get(value,  1u,  0u)));
+        ASSERT_EQ((bit_manip::field_get<5u,  3u>(value)), (bit_manip::value_get(value,  5u,  3u)));
+        ASSERT_EQ((bit_manip::field_get<12u, 20u>(value)), (bit_manip::value_get(value, 12u, 20u)));
+        ASSERT_EQ((bit_manip::field_get<32u, 0u>(value)), value);
+
+        ASSERT_EQ((bit_manip::field_set<1u,  0u>(value, field)), (bit_manip::value_set(value, field,  1u,  0u)));
+        ASSERT_EQ((bit_manip::field_set<5u,  3u>(value, field)), (bit_manip::value_set(value, field,  5u,  3u)));
+        ASSERT_EQ((bit_manip::field_set<12u, 20u>(value, field)), (bit_manip::value_set(value, field, 12u, 20u)));
+        ASSERT_EQ((bit_manip::field_set<32u, 0u>(value, field)), field);
+    }
+}
+
+TEST(BitManipEndian, Swap)
+{
+    EXPECT_EQ(bit_manip::endian_swap_16(0x1234u), 0x3412u);
+    EXPECT_EQ(bit_manip::endian_swap_32(0x12345678u), 0x78563412u);
+    EXPECT_EQ(bit_manip::endian_swap_64(0x0123456789abcdefULL), 0xefcdab8967452301ULL);
+
+    // The swap must return the full width; the value must round trip.
+    EXPECT_EQ(bit_manip::endian_swap_32(bit_manip::endian_swap_32(0xdeadbeefu)), 0xdeadbeefu);
+
+    // little_endian() produces the byte order of a BLE PDU in memory.
+    uint32_t const value = bit_manip::little_endian(uint32_t(0x04030201u));
+    uint8_t bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    EXPECT_EQ(bytes[0], 0x01u);
+    EXPECT_EQ(bytes[3], 0x04u);
+    EXPECT_EQ(bit_manip::little_endian(bit_manip::little_endian(uint16_t(0xabcdu))), 0xabcdu);
+}
+
+TEST(BitManipSetBits, ForEach)
+{
+    std::vector<bit_manip::bit_pos_t> positions;
+    bit_manip::for_each_set_bit(uint32_t(0x80010006u), [&positions](bit_manip::bit_pos_t pos) {
+        positions.push_back(pos);
+    });
+    EXPECT_EQ(positions, (std::vector<bit_manip::bit_pos_t>{1u, 2u, 16u, 31u}));
+
+    positions.clear();
+    bit_manip::for_each_set_bit(uint8_t(0u), [&positions](bit_manip::bit_pos_t pos) {
+        positions.push_back(pos);
+    });
+    EXPECT_TRUE(positions.empty());
+
+    uint64_t state = 0x5555aaaa5555aaaaULL;
+    for (unsigned int iter = 0u; iter < 1000u; ++iter)
+    {
+        uint64_t const value = bit_manip_random(state);
+        uint64_t rebuilt = 0u;
+        unsigned int count = 0u;
+        bit_manip::for_each_set_bit(value, [&](bit_manip::bit_pos_t pos) {
+            rebuilt |= uint64_t(1u) << pos;
+            ++count;
+        });
+        ASSERT_EQ(rebuilt, value);
+        ASSERT_EQ(count, bit_manip::popcount(value));
+    }
+
+    EXPECT_EQ(bit_manip::lowest_bit(uint16_t(0x0a80u)), 0x0080u);
+    EXPECT_EQ(bit_manip::lowest_bit_clear(uint16_t(0x0a80u)), 0x0a00u);
+    EXPECT_EQ(bit_manip::lowest_bit(uint8_t(0u)), 0u);
+}
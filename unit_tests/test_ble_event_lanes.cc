@@ -0,0 +1,175 @@
+/**
+ * @file test_ble_event_lanes.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/ble_event_lanes.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+
+using test_lanes = ble::event_lanes<16u, 4u, 4u>;
+using lane = test_lanes::lane;
+
+/// Events which must never be dropped, with the lane
+/// each is queued in. The Nordic event ids are not available on the host;
+/// nordic::ble_event_queue::is_must_answer() classifies them on target.
+struct must_answer_event
+{
+    char const* name;
+    lane        event_lane;
+};
+
+must_answer_event const must_answer_events[] = {
+    {"BLE_COMMON_EVT_USER_MEM_REQUEST",     lane::gap },
+    {"BLE_GAP_EVT_CONNECTED",               lane::gap },
+    {"BLE_GAP_EVT_DISCONNECTED",            lane::gap },
+    {"BLE_GAP_EVT_SEC_PARAMS_REQUEST",      lane::gap },
+    {"BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST",  lane::gatt},
+    {"BLE_GATTS_EVT_SYS_ATTR_MISSING",      lane::gatt},
+};
+
+std::size_t lane_capacity(lane event_lane)
+{
+    return (event_lane == lane::gap) ? test_lanes::gap_ring::capacity() :
+                                       test_lanes::gatt_ring::capacity();
+}
+
+std::size_t lane_depth(test_lanes const& lanes, lane event_lane)
+{
+    return (event_lane == lane::gap) ? lanes.gap().depth() : lanes.gatt().depth();
+}
+
+/// Push ordinary events into a lane until it refuses them.
+std::size_t lane_fill(test_lanes& lanes, lane event_lane)
+{
+    uint8_t const data[4u] = {0u};
+    std::size_t count = 0u;
+    while (lanes.push(event_lane, false, data, sizeof(data), 0u))
+    {
+        ++count;
+    }
+    return count;
+}
+
+} // anonymous namespace
+
+TEST(BleEventLanes, OrdinaryEventsLeaveReservedSlot)
+{
+    for (lane event_lane : {lane::gap, lane::gatt})
+    {
+        test_lanes lanes;
+        std::size_t const capacity = lane_capacity(event_lane);
+        EXPECT_EQ(lane_fill(lanes, event_lane),
+                  capacity - test_lanes::reserved_slot_count);
+        EXPECT_EQ(lane_depth(lanes, event_lane),
+                  capacity - test_lanes::reserved_slot_count);
+    }
+}
+
+TEST(BleEventLanes, MustAnswerEventTakesReservedSlot)
+{
+    for (must_answer_event const& event : must_answer_events)
+    {
+        SCOPED_TRACE(event.name);
+
+        test_lanes lanes;
+        lane_fill(lanes, event.event_lane);
+
+        char const data[] = "must answer";
+        ASSERT_TRUE(lanes.push(event.event_lane, true, data, sizeof(data), 7u));
+        EXPECT_EQ(lane_depth(lanes, event.event_lane), lane_capacity(event.event_lane));
+
+        // The event is delivered intact, after the events queued before it.
+        test_lanes::slot const* slot = nullptr;
+        lane front_lane = lane::gatt;
+        for (std::size_t iter = 1u; iter < lane_capacity(event.event_lane); ++iter)
+        {
+            ASSERT_NE(lanes.front(front_lane), nullptr);
+            lanes.pop(front_lane);
+        }
+
+        slot = lanes.front(front_lane);
+        ASSERT_NE(slot, nullptr);
+        EXPECT_EQ(front_lane, event.event_lane);
+        EXPECT_EQ(slot->timestamp, 7u);
+        EXPECT_EQ(slot->length, sizeof(data));
+        EXPECT_EQ(std::memcmp(slot->data, data, sizeof(data)), 0);
+        lanes.pop(front_lane);
+        EXPECT_TRUE(lanes.empty());
+    }
+}
+
+TEST(BleEventLanes, FullLaneRejectsAndCounts)
+{
+    test_lanes lanes;
+    uint8_t const data[4u] = {0u};
+    lane_fill(lanes, lane::gatt);
+    ASSERT_TRUE(lanes.push(lane::gatt, true, data, sizeof(data), 0u));
+
+    EXPECT_FALSE(lanes.push(lane::gatt, true,  data, sizeof(data), 0u));
+    EXPECT_FALSE(lanes.push(lane::gatt, false, data, sizeof(data), 0u));
+    EXPECT_EQ(lanes.gatt().overflow_count(), 3u);  // Including lane_fill().
+    EXPECT_EQ(lanes.gap().overflow_count(), 0u);
+}
+
+TEST(BleEventLanes, BackPressure)
+{
+    for (lane event_lane : {lane::gap, lane::gatt})
+    {
+        test_lanes lanes;
+        uint8_t const data[4u] = {0u};
+        EXPECT_TRUE(lanes.is_accepting());
+
+        // The producer takes events from the stack only while is_accepting();
+        // each one is then guaranteed a slot, must answer or not.
+        std::size_t taken = 0u;
+        while (lanes.is_accepting())
+        {
+            ASSERT_TRUE(lanes.push(event_lane, false, data, sizeof(data), 0u));
+            ++taken;
+        }
+        EXPECT_EQ(taken, lane_capacity(event_lane) - test_lanes::reserved_slot_count);
+        EXPECT_FALSE(lanes.push(event_lane, false, data, sizeof(data), 0u));
+        EXPECT_TRUE(lanes.push(event_lane, true,   data, sizeof(data), 0u));
+        EXPECT_FALSE(lanes.is_accepting());
+
+        // Consuming the events resumes the producer.
+        lane front_lane = lane::gap;
+        ASSERT_NE(lanes.front(front_lane), nullptr);
+        lanes.pop(front_lane);
+        EXPECT_FALSE(lanes.is_accepting());
+        ASSERT_NE(lanes.front(front_lane), nullptr);
+        lanes.pop(front_lane);
+        EXPECT_TRUE(lanes.is_accepting());
+    }
+}
+
+TEST(BleEventLanes, GapLaneFirst)
+{
+    test_lanes lanes;
+    uint8_t const gatt_data = 1u;
+    uint8_t const gap_data  = 2u;
+
+    ASSERT_TRUE(lanes.push(lane::gatt, false, &gatt_data, 1u, 0u));
+    ASSERT_TRUE(lanes.push(lane::gap,  false, &gap_data,  1u, 1u));
+
+    lane front_lane = lane::gatt;
+    test_lanes::slot const* slot = lanes.front(front_lane);
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(front_lane, lane::gap);
+    EXPECT_EQ(slot->data[0], gap_data);
+    lanes.pop(front_lane);
+
+    slot = lanes.front(front_lane);
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(front_lane, lane::gatt);
+    EXPECT_EQ(slot->data[0], gatt_data);
+    lanes.pop(front_lane);
+
+    EXPECT_EQ(lanes.front(front_lane), nullptr);
+}
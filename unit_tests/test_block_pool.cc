@@ -0,0 +1,195 @@
+/**
+ * @file test_block_pool.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "block_pool.h"
+#include "resource_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <new>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(BlockPool, AllocateAll)
+{
+    fixed_block_pool<24u, 8u, 8u> pool;
+
+    EXPECT_EQ(pool.block_stride(), 24u);
+    EXPECT_EQ(pool.available(), 8u);
+
+    std::set<void*> blocks;
+    for (std::size_t index = 0u; index < pool.block_count(); ++index)
+    {
+        void* const block = pool.allocate();
+        ASSERT_NE(block, nullptr);
+        EXPECT_TRUE(pool.owns(block));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 8u, 0u);
+        std::memset(block, 0xa5, pool.block_size());
+        blocks.insert(block);
+    }
+
+    // Each block is unique.
+    EXPECT_EQ(blocks.size(), pool.block_count());
+    EXPECT_EQ(pool.allocate(), nullptr);
+    EXPECT_EQ(pool.failure_count(), 1u);
+    EXPECT_EQ(pool.in_use(), 8u);
+    EXPECT_EQ(pool.high_water(), 8u);
+
+    for (void* block : blocks)
+    {
+        pool.deallocate(block);
+    }
+
+    EXPECT_EQ(pool.in_use(), 0u);
+    EXPECT_EQ(pool.high_water(), 8u);
+
+    // Freed blocks are reused, last in first out.
+    void* const block = pool.allocate();
+    EXPECT_EQ(block, *blocks.rbegin());
+    pool.deallocate(block);
+
+    pool.reset_statistics();
+    EXPECT_EQ(pool.high_water(), 0u);
+    EXPECT_EQ(pool.failure_count(), 0u);
+}
+
+TEST(BlockPool, Owns)
+{
+    fixed_block_pool<16u, 4u> pool;
+    uint8_t* const block = static_cast<uint8_t*>(pool.allocate());
+
+    EXPECT_TRUE(pool.owns(block));
+    EXPECT_FALSE(pool.owns(block + 1u));
+    EXPECT_FALSE(pool.owns(block + pool.block_stride() * pool.block_count()));
+    EXPECT_FALSE(pool.owns(&pool));
+}
+
+TEST(BlockPool, SizedAllocate)
+{
+    fixed_block_pool<32u, 4u, 4u> pool;
+
+    EXPECT_EQ(pool.allocate(33u, 4u), nullptr);
+    EXPECT_EQ(pool.allocate(8u, 8u), nullptr);
+    EXPECT_EQ(pool.failure_count(), 2u);
+
+    void* const block_1 = pool.allocate(10u, 4u);
+    void* const block_2 = pool.allocate(32u, 1u);
+    EXPECT_EQ(pool.requested_bytes(), 42u);
+    EXPECT_EQ(pool.unused_bytes(), 22u);
+
+    pool.deallocate(block_1, 10u);
+    pool.deallocate(block_2, 32u);
+    EXPECT_EQ(pool.requested_bytes(), 0u);
+    EXPECT_EQ(pool.unused_bytes(), 0u);
+}
+
+TEST(BlockPool, StdList)
+{
+    using node_pool = fixed_block_pool<64u, 16u>;
+    using allocator = resource_allocator<int, node_pool>;
+
+    node_pool pool;
+    std::list<int, allocator> list{allocator(pool)};
+
+    for (int value = 0; value < 16; ++value)
+    {
+        list.push_back(value);
+    }
+    EXPECT_EQ(pool.in_use(), 16u);
+    EXPECT_THROW(list.push_back(16), std::bad_alloc);
+
+    list.remove_if([](int value) { return (value % 2) == 0; });
+    EXPECT_EQ(pool.in_use(), 8u);
+
+    list.clear();
+    EXPECT_EQ(pool.in_use(), 0u);
+    EXPECT_EQ(pool.high_water(), 16u);
+}
+
+/**
+ * Several threads allocate and free blocks concurrently, writing a pattern
+ * unique to the thread into each block it holds and checking the pattern is
+ * intact before returning it. A block handed out twice is detected as a
+ * corrupted pattern.
+ */
+TEST(BlockPool, Stress)
+{
+    constexpr std::size_t const thread_count = 4u;
+    constexpr std::size_t const iterations   = 100000u;
+    constexpr std::size_t const held_max     = 8u;
+
+    fixed_block_pool<16u, thread_count * held_max> pool;
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> errors(thread_count, 0u);
+
+    for (std::size_t thread_id = 0u; thread_id < thread_count; ++thread_id)
+    {
+        threads.emplace_back([&pool, &errors, thread_id]()
+        {
+            std::vector<std::pair<uint32_t*, uint32_t>> held;
+            uint32_t pattern = static_cast<uint32_t>(thread_id) << 24u;
+            for (std::size_t iter = 0u; iter < iterations; ++iter)
+            {
+                bool const do_allocate = held.empty() ||
+                    ((held.size() < held_max) && ((iter * 7u + thread_id) % 3u != 0u));
+                if (do_allocate)
+                {
+                    uint32_t* const block = static_cast<uint32_t*>(pool.allocate());
+                    if (block)
+                    {
+                        block[0] = ++pattern;
+                        block[3] = ~pattern;
+                        held.emplace_back(block, pattern);
+                    }
+                }
+                else
+                {
+                    uint32_t* const block = held.back().first;
+                    if ((block[0] != held.back().second) || (block[3] != ~held.back().second))
+                    {
+                        errors[thread_id] += 1u;
+                    }
+                    held.pop_back();
+                    pool.deallocate(block);
+                }
+            }
+
+            for (auto const& [block, block_pattern] : held)
+            {
+                if ((block[0] != block_pattern) || (block[3] != ~block_pattern))
+                {
+                    errors[thread_id] += 1u;
+                }
+                pool.deallocate(block);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (std::size_t error_count : errors)
+    {
+        EXPECT_EQ(error_count, 0u);
+    }
+
+    EXPECT_EQ(pool.in_use(), 0u);
+    EXPECT_LE(pool.high_water(), pool.block_count());
+
+    // Every block is back on the free list exactly once.
+    std::set<void*> blocks;
+    while (void* block = pool.allocate())
+    {
+        blocks.insert(block);
+    }
+    EXPECT_EQ(blocks.size(), pool.block_count());
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_event_dispatch_table.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "event_dispatch_table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct dispatch_observer
+ * Records the event indices and the order in which it was notified.
+ */
+struct dispatch_observer
+{
+    explicit dispatch_observer(int observer_id): id(observer_id) {}
+
+    int              id;
+    std::vector<int> events;
+};
+
+using dispatch_test_table = event_dispatch_table<dispatch_observer, 32u, 8u>;
+
+static std::vector<int> dispatch(dispatch_test_table &table, std::size_t event_index)
+{
+    std::vector<int> notified;
+    for (auto iter = table.dispatch_begin(event_index); iter != table.end(); )
+    {
+        dispatch_observer &observer = *iter;
+        ++iter;
+        observer.events.push_back(static_cast<int>(event_index));
+        notified.push_back(observer.id);
+    }
+    return notified;
+}
+
+TEST(EventDispatchTable, MaskedDispatch)
+{
+    dispatch_test_table table;
+    dispatch_observer observer_1(1);
+    dispatch_observer observer_2(2);
+    dispatch_observer observer_3(3);
+
+    table.insert(observer_1, dispatch_test_table::all_events);
+    table.insert(observer_2, (1u << 0u) | (1u << 5u));
+    table.insert(observer_3, (1u << 5u) | (1u << 31u));
+
+    EXPECT_EQ(dispatch(table, 0u),  (std::vector<int>{1, 2}));
+    EXPECT_EQ(dispatch(table, 5u),  (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(dispatch(table, 31u), (std::vector<int>{1, 3}));
+    EXPECT_EQ(dispatch(table, 7u),  (std::vector<int>{1}));
+
+    // Out of range event indices reach no observers.
+    EXPECT_EQ(dispatch(table, 32u), (std::vector<int>{}));
+
+    EXPECT_EQ(observer_2.events, (std::vector<int>{0, 5}));
+    EXPECT_EQ(table.observer_count(5u), 3u);
+    EXPECT_EQ(table.observer_count(7u), 1u);
+}
+
+TEST(EventDispatchTable, DispatchCounters)
+{
+    dispatch_test_table table;
+    dispatch_observer observer_1(1);
+    table.insert(observer_1, 1u << 3u);
+
+    dispatch(table, 3u);
+    dispatch(table, 3u);
+    dispatch(table, 4u);
+
+    // Events are counted whether or not any observer is interested.
+    EXPECT_EQ(table.dispatch_count(3u), 2u);
+    EXPECT_EQ(table.dispatch_count(4u), 1u);
+    EXPECT_EQ(table.dispatch_count(5u), 0u);
+    EXPECT_EQ(table.dispatch_count(99u), 0u);
+
+    table.reset_counters();
+    EXPECT_EQ(table.dispatch_count(3u), 0u);
+}
+
+TEST(EventDispatchTable, RemoveDuringDispatch)
+{
+    dispatch_test_table table;
+    dispatch_observer observer_1(1);
+    dispatch_observer observer_2(2);
+    dispatch_observer observer_3(3);
+
+    table.insert(observer_1, dispatch_test_table::all_events);
+    table.insert(observer_2, dispatch_test_table::all_events);
+    table.insert(observer_3, dispatch_test_table::all_events);
+
+    // Observer 1 removes observer 2 while the event is being dispatched.
+    std::vector<int> notified;
+    for (auto iter = table.dispatch_begin(0u); iter != table.end(); )
+    {
+        dispatch_observer &observer = *iter;
+        ++iter;
+        notified.push_back(observer.id);
+        if (observer.id == 1)
+        {
+            table.remove(observer_2);
+        }
+    }
+
+    EXPECT_EQ(notified, (std::vector<int>{1, 3}));
+    EXPECT_EQ(dispatch(table, 1u), (std::vector<int>{1, 3}));
+
+    // Clearing and re-inserting compacts the table.
+    table.clear();
+    table.insert(observer_3, dispatch_test_table::all_events);
+    table.insert(observer_1, dispatch_test_table::all_events);
+    EXPECT_EQ(dispatch(table, 1u), (std::vector<int>{3, 1}));
+}
@@ -0,0 +1,256 @@
+/**
+ * @file test_float_conversion.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Floating point and fixed point vwritef() conversions compared with the
+ * C library snprintf().
+ */
+
+#include "gtest/gtest.h"
+#include "float_to_string.h"
+#include "vwritef.h"
+#include "stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+/// An output stream which appends to a string.
+class float_conversion_stream: public io::output_stream
+{
+public:
+    virtual ~float_conversion_stream() override = default;
+
+    virtual std::size_t write(void const *buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    virtual std::size_t write_pending() const override { return 0u; }
+    virtual std::size_t write_avail()   const override { return SIZE_MAX; }
+    virtual void        flush()               override {}
+
+    std::string text;
+};
+
+static std::string vwritef_string(char const* format, ...)
+{
+    float_conversion_stream os;
+
+    va_list args;
+    va_start(args, format);
+    vwritef(os, format, args);
+    va_end(args);
+
+    return os.text;
+}
+
+static std::string snprintf_string(char const* format, ...)
+{
+    char buffer[512u];
+
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    return std::string(buffer);
+}
+
+/// Random doubles over the full range: random bit patterns, finite only.
+static double random_double(std::mt19937_64& generator)
+{
+    for (;;)
+    {
+        uint64_t const bits = generator();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isfinite(value)) { return value; }
+    }
+}
+
+static constexpr std::size_t const test_value_count = 100u * 1000u;
+
+/// Allow a few failures to be reported without flooding the output.
+static constexpr std::size_t const failure_report_limit = 10u;
+
+TEST(FloatConversion, ShortestRoundTrip)
+{
+    std::mt19937_64 generator(1u);
+    std::size_t failures = 0u;
+
+    for (std::size_t count = 0u; count < test_value_count; ++count)
+    {
+        double const value = std::fabs(random_double(generator));
+
+        decimal_digits decimal;
+        double_to_shortest(decimal, value);
+
+        std::string text = "0";
+        if (decimal.count > 0u)
+        {
+            text  = std::string(decimal.digits, decimal.count);
+            text += "e" + std::to_string(decimal.exponent - decimal.count + 1);
+        }
+
+        // The digits must be the fewest; at most 17 for a double.
+        if ((std::strtod(text.c_str(), nullptr) != value) || (decimal.count > 17u))
+        {
+            if (failures++ < failure_report_limit)
+            {
+                ADD_FAILURE() << std::hexfloat << value << ": " << text;
+            }
+        }
+    }
+
+    EXPECT_EQ(failures, 0u);
+}
+
+TEST(FloatConversion, SpecialValues)
+{
+    EXPECT_EQ(vwritef_string("%f", 0.0),                "0.000000");
+    EXPECT_EQ(vwritef_string("%f", -0.0),               "-0.000000");
+    EXPECT_EQ(vwritef_string("%e", 0.0),                "0.000000e+00");
+    EXPECT_EQ(vwritef_string("%g", 0.0),                "0");
+    EXPECT_EQ(vwritef_string("%#g", 0.0),               "0.00000");
+    EXPECT_EQ(vwritef_string("%f", INFINITY),           "inf");
+    EXPECT_EQ(vwritef_string("%F", -INFINITY),          "-INF");
+    EXPECT_EQ(vwritef_string("%08e", INFINITY),         "     inf");
+    EXPECT_EQ(vwritef_string("%g", NAN),                "nan");
+    EXPECT_EQ(vwritef_string("%.0f", 0.5),              "0");
+    EXPECT_EQ(vwritef_string("%.0f", 1.5),              "2");
+    EXPECT_EQ(vwritef_string("%.0f", 2.5),              "2");
+    EXPECT_EQ(vwritef_string("%.2f", 9.995),            snprintf_string("%.2f", 9.995));
+    EXPECT_EQ(vwritef_string("%.3e", 9.9995e-300),      snprintf_string("%.3e", 9.9995e-300));
+    EXPECT_EQ(vwritef_string("%e", 4.9406564584124654e-324), "4.940656e-324");
+    EXPECT_EQ(vwritef_string("%g", 1.7976931348623157e308),  "1.79769e+308");
+    EXPECT_EQ(vwritef_string("%.6f", 1e-7),             "0.000000");
+    EXPECT_EQ(vwritef_string("%.6f", 6e-7),             "0.000001");
+    EXPECT_EQ(vwritef_string("[%-+10.2f]", 3.14159),    "[+3.14     ]");
+    EXPECT_EQ(vwritef_string("[%010.2f]", -3.14159),    "[-000003.14]");
+    EXPECT_EQ(vwritef_string("%f %d", 1.0, 2),          "1.000000 2");
+}
+
+/// Compare vwritef() with snprintf() over random values for each format.
+static void test_formats(char const* const* formats,
+                         std::size_t        format_count,
+                         double             magnitude_limit)
+{
+    std::mt19937_64 generator(2u);
+    std::size_t failures = 0u;
+
+    for (std::size_t count = 0u; count < test_value_count; ++count)
+    {
+        double const value  = random_double(generator);
+        char const*  format = formats[count % format_count];
+        if (std::fabs(value) >= magnitude_limit) { continue; }
+
+        std::string const actual   = vwritef_string(format, value);
+        std::string const expected = snprintf_string(format, value);
+
+        if ((actual != expected) && (failures++ < failure_report_limit))
+        {
+            ADD_FAILURE() << format << " " << std::hexfloat << value << ": "
+                          << actual << " != " << expected;
+        }
+    }
+
+    EXPECT_EQ(failures, 0u);
+}
+
+TEST(FloatConversion, ExponentVsLibc)
+{
+    char const* const formats[] = {
+        "%e", "%.0e", "%.1e", "%.3E", "%.9e", "%.16e", "%.17e", "%.25e", "%.39e",
+        "%+15.4e", "%-15.2e", "% e", "%#.0e", "%015.3e",
+    };
+    test_formats(formats, std::size(formats), INFINITY);
+}
+
+TEST(FloatConversion, GeneralVsLibc)
+{
+    char const* const formats[] = {
+        "%g", "%.0g", "%.1g", "%.3G", "%.10g", "%.17g", "%.30g",
+        "%#g", "%#.3g", "%+12g", "%-12.4g", "%012g",
+    };
+    test_formats(formats, std::size(formats), INFINITY);
+}
+
+TEST(FloatConversion, FixedVsLibc)
+{
+    // Fixed conversions of large values exceed decimal_digits_max digits.
+    char const* const formats[] = {
+        "%f", "%.0f", "%.1f", "%.3F", "%.9f", "%#.0f", "%+20.5f", "%-20.2f", "%020.4f",
+    };
+    test_formats(formats, std::size(formats), 1e30);
+}
+
+TEST(FloatConversion, FixedSmallVsLibc)
+{
+    // Values near the rounding digit exercise the exact conversion.
+    char const* const formats[] = { "%.3f", "%.6f", "%.9f", "%.2g", "%.5e" };
+
+    std::mt19937_64 generator(3u);
+    std::uniform_real_distribution<double> distribution(-1000.0, 1000.0);
+    std::size_t failures = 0u;
+
+    for (std::size_t count = 0u; count < test_value_count; ++count)
+    {
+        // Round to a half way decimal value which is usually not exact.
+        double const value  = std::round(distribution(generator) * 2000.0) / 2000.0;
+        char const*  format = formats[count % std::size(formats)];
+
+        std::string const actual   = vwritef_string(format, value);
+        std::string const expected = snprintf_string(format, value);
+
+        if ((actual != expected) && (failures++ < failure_report_limit))
+        {
+            ADD_FAILURE() << format << " " << std::hexfloat << value << ": "
+                          << actual << " != " << expected;
+        }
+    }
+
+    EXPECT_EQ(failures, 0u);
+}
+
+TEST(FloatConversion, FixedPointVsLibc)
+{
+    EXPECT_EQ(vwritef_string("%q16.16",  0x00018000),               "1.50000");
+    EXPECT_EQ(vwritef_string("%q16.16", -0x00018000),               "-1.50000");
+    EXPECT_EQ(vwritef_string("%.2q8.8",  0x0080),                   "0.50");
+    EXPECT_EQ(vwritef_string("%q8.8",    0xFF80),                   "-0.500");
+    EXPECT_EQ(vwritef_string("%q1.31",   INT32_MIN),                "-1.0000000000");
+    EXPECT_EQ(vwritef_string("%.0q64.0", static_cast<long long>(INT64_MIN)),
+              "-9223372036854775808");
+    EXPECT_EQ(vwritef_string("[%-+9.1q4.4]", 0x18),                 "[+1.5     ]");
+
+    // A Q16.16 value is exact as a double; the libc conversion is exact.
+    std::mt19937 generator(4u);
+    std::size_t failures = 0u;
+
+    for (std::size_t count = 0u; count < test_value_count; ++count)
+    {
+        int32_t const raw       = static_cast<int32_t>(generator());
+        int const     precision = static_cast<int>(count % 12u);
+        double const  value     = raw / 65536.0;
+
+        // The '*' precision is not supported by vwritef().
+        char format[16u];
+        std::snprintf(format, sizeof(format), "%%.%dq16.16", precision);
+
+        std::string const actual   = vwritef_string(format, raw);
+        std::string const expected = snprintf_string("%.*f", precision, value);
+
+        if ((actual != expected) && (failures++ < failure_report_limit))
+        {
+            ADD_FAILURE() << "%." << precision << "q16.16 " << raw << ": "
+                          << actual << " != " << expected;
+        }
+    }
+
+    EXPECT_EQ(failures, 0u);
+}
@@ -466,3 +466,34 @@ TEST(FormatConversion, Pointer)
     format_expected.format_length           = strnlen(format_spec, std::size(format_spec));
     test_format_conversion(format_spec, format_converted, format_expected);
 }
+
+TEST(FormatConversion, FixedPoint_q)
+{
+    char const format_spec[] = "%-12.4q16.16";
+    format_conversion const format_converted(format_spec);
+    format_conversion format_expected;
+    format_expected.conversion_specifier    = 'q';
+    format_expected.width                   = 12;
+    format_expected.width_state             = format_conversion::modifier_state::is_specified;
+    format_expected.precision               = 4;
+    format_expected.precision_state         = format_conversion::modifier_state::is_specified;
+    format_expected.justification           = format_conversion::justification::left;
+    format_expected.q_integer_bits          = 16;
+    format_expected.q_fraction_bits         = 16;
+    format_expected.format_length           = strnlen(format_spec, std::size(format_spec));
+    test_format_conversion(format_spec, format_converted, format_expected);
+}
+
+TEST(FormatConversion, FixedPoint_q_invalid)
+{
+    // The Q format is required; the bit total is limited.
+    char const* const format_specs[] = { "%q", "%q16", "%q16.", "%q.16", "%q0.8", "%q4.61", "%q32.33" };
+    for (char const* format_spec : format_specs)
+    {
+        format_conversion const format_converted(format_spec);
+        EXPECT_EQ(format_converted.parse_error, format_conversion::parse_error::bad_parse) << format_spec;
+    }
+
+    format_conversion const format_converted("%q1.60");
+    EXPECT_EQ(format_converted.parse_error, format_conversion::parse_error::none);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file test_gap_connection_rate_controller.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/gap_connection_rate_controller.h"
+#include "ble/gap_operations.h"
+
+#include <cstdint>
+#include <vector>
+
+using ble::gap::connection_rate_controller;
+using status = ble::gap::operations::status;
+
+/**
+ * @class fake_gap_operations
+ * Record the link change requests made through ble::gap::operations.
+ */
+class fake_gap_operations: public ble::gap::operations
+{
+public:
+    virtual ~fake_gap_operations() override = default;
+    fake_gap_operations() = default;
+
+    status connect(ble::gap::address const&,
+                   ble::gap::connection_parameters const&) override {
+        return status::unimplemented;
+    }
+
+    status connect_cancel() override { return status::unimplemented; }
+
+    status disconnect(uint16_t, ble::hci::error_code) override {
+        return status::unimplemented;
+    }
+
+    status connection_parameter_update_request(
+        uint16_t                                connection_handle,
+        ble::gap::connection_parameters const&  connection_parameters) override
+    {
+        this->parameter_requests.push_back(connection_parameters);
+        return this->parameter_status;
+    }
+
+    status link_layer_length_update_request(
+        uint16_t, uint16_t rx_length_max, uint16_t,
+        uint16_t, uint16_t) override
+    {
+        this->data_length_requests.push_back(rx_length_max);
+        return status::success;
+    }
+
+    status phy_update_request(uint16_t,
+                              ble::gap::phy_layer_parameters phy_rx,
+                              ble::gap::phy_layer_parameters) override
+    {
+        this->phy_requests.push_back(phy_rx);
+        return status::success;
+    }
+
+    status pairing_request(uint16_t, bool,
+                           ble::gap::security::pairing_request const&) override {
+        return status::unimplemented;
+    }
+
+    status pairing_response(uint16_t, bool,
+                            ble::gap::security::pairing_response const&) override {
+        return status::unimplemented;
+    }
+
+    status security_authentication_key_response(uint16_t, uint8_t, uint8_t*) override {
+        return status::unimplemented;
+    }
+
+    status pairing_dhkey_response(uint16_t, ble::gap::security::dhkey const&) override {
+        return status::unimplemented;
+    }
+
+    status parameter_status = status::success;
+    std::vector<ble::gap::connection_parameters>  parameter_requests;
+    std::vector<uint16_t>                         data_length_requests;
+    std::vector<ble::gap::phy_layer_parameters>   phy_requests;
+};
+
+static connection_rate_controller::policy const& policy =
+    connection_rate_controller::default_policy;
+
+/**
+ * Run the controller with a constant traffic rate in bytes per second,
+ * updating every 100 msec.
+ *
+ * @return uint32_t The time after the traffic has run.
+ */
+static uint32_t run_traffic(connection_rate_controller& controller,
+                            uint32_t                    now_msec,
+                            uint32_t                    duration_msec,
+                            uint32_t                    bytes_per_sec)
+{
+    uint32_t const update_msec = 100u;
+    for (uint32_t elapsed = 0u; elapsed < duration_msec; elapsed += update_msec)
+    {
+        controller.record_notification(bytes_per_sec * update_msec / 1000u);
+        now_msec += update_msec;
+        controller.update(now_msec);
+    }
+    return now_msec;
+}
+
+TEST(ConnectionRateController, LoadAndIdle)
+{
+    fake_gap_operations operations;
+    connection_rate_controller controller(operations);
+
+    uint32_t now_msec = 1000u;
+    controller.connect(0x10u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::idle);
+
+    // Traffic well above the load threshold.
+    now_msec = run_traffic(controller, now_msec, 2000u, 10000u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::loaded);
+    ASSERT_EQ(operations.parameter_requests.size(), 1u);
+    EXPECT_EQ(operations.parameter_requests[0].interval_min,
+              policy.loaded_parameters.interval_min);
+    ASSERT_EQ(operations.phy_requests.size(), 1u);
+    EXPECT_EQ(operations.phy_requests[0], ble::gap::phy_layer_parameters::rate_2_Mbps);
+    ASSERT_EQ(operations.data_length_requests.size(), 1u);
+    EXPECT_EQ(operations.data_length_requests[0], policy.data_length_max);
+
+    // Traffic in the hysteresis band does not change the mode.
+    now_msec = run_traffic(controller, now_msec, 20000u, 1000u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::loaded);
+    EXPECT_EQ(operations.parameter_requests.size(), 1u);
+
+    // Quiet traffic returns to idle only after the hold time.
+    now_msec = run_traffic(controller, now_msec, 2000u, 0u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::loaded);
+    now_msec = run_traffic(controller, now_msec, policy.idle_hold_msec, 0u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::idle);
+    ASSERT_EQ(operations.parameter_requests.size(), 2u);
+    EXPECT_EQ(operations.parameter_requests[1].slave_latency,
+              policy.idle_parameters.slave_latency);
+}
+
+TEST(ConnectionRateController, QueueDepthLoad)
+{
+    fake_gap_operations operations;
+    connection_rate_controller controller(operations);
+
+    controller.connect(0x10u);
+
+    // The PHY and data length are not requested when already in place.
+    controller.phy_update(ble::gap::phy_layer_parameters::rate_2_Mbps,
+                          ble::gap::phy_layer_parameters::rate_2_Mbps);
+    controller.link_layer_update(policy.data_length_max, policy.data_length_max);
+    controller.set_queue_depth(policy.load_queue_depth);
+    EXPECT_EQ(controller.update(100u), connection_rate_controller::link_mode::loaded);
+    EXPECT_EQ(operations.parameter_requests.size(), 1u);
+    EXPECT_EQ(operations.phy_requests.size(), 0u);
+    EXPECT_EQ(operations.data_length_requests.size(), 0u);
+}
+
+TEST(ConnectionRateController, IdleRestoresPhyAndDataLength)
+{
+    fake_gap_operations operations;
+    connection_rate_controller controller(operations);
+
+    controller.connect(0x10u);
+    controller.set_queue_depth(policy.load_queue_depth);
+    EXPECT_EQ(controller.update(100u), connection_rate_controller::link_mode::loaded);
+    ASSERT_EQ(operations.phy_requests.size(), 1u);
+    ASSERT_EQ(operations.data_length_requests.size(), 1u);
+
+    controller.phy_update(ble::gap::phy_layer_parameters::rate_2_Mbps,
+                          ble::gap::phy_layer_parameters::rate_2_Mbps);
+    controller.link_layer_update(policy.data_length_max, policy.data_length_max);
+    controller.set_queue_depth(0u);
+    run_traffic(controller, 100u, policy.idle_hold_msec + 1000u, 0u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::idle);
+
+    ASSERT_EQ(operations.phy_requests.size(), 2u);
+    EXPECT_EQ(operations.phy_requests[1], ble::gap::phy_layer_parameters::rate_1_Mbps);
+    ASSERT_EQ(operations.data_length_requests.size(), 2u);
+    EXPECT_EQ(operations.data_length_requests[1], policy.data_length_idle);
+}
+
+TEST(ConnectionRateController, PolicyCopied)
+{
+    fake_gap_operations operations;
+
+    // The controller keeps its own copy of a temporary policy.
+    connection_rate_controller::policy rate_policy = policy;
+    rate_policy.load_queue_depth = 1u;
+    connection_rate_controller controller(
+        operations, connection_rate_controller::policy(rate_policy));
+    rate_policy.load_queue_depth = 100u;
+
+    controller.connect(0x10u);
+    controller.set_queue_depth(1u);
+    EXPECT_EQ(controller.update(100u), connection_rate_controller::link_mode::loaded);
+}
+
+TEST(ConnectionRateController, ObserverForwardsEvents)
+{
+    fake_gap_operations operations;
+    connection_rate_controller controller(operations);
+    ble::gap::connection_rate_observer observer(controller);
+    ble::gap::event_observer& gap_observer = observer;
+
+    uint8_t const peer_octets[ble::gap::address::octet_length] = {};
+    ble::gap::address const peer_address(peer_octets, 0u);
+    gap_observer.connect(0x10u, peer_address, 0u);
+    EXPECT_TRUE(controller.is_connected());
+    EXPECT_EQ(controller.get_connection_handle(), 0x10u);
+
+    gap_observer.connection_parameter_update(0x10u, policy.idle_parameters);
+    EXPECT_EQ(controller.get_connection_parameters().slave_latency,
+              policy.idle_parameters.slave_latency);
+
+    // Link state already in place: loading requests the interval only.
+    gap_observer.phy_update(0x10u, ble::hci::error_code::success,
+                            ble::gap::phy_layer_parameters::rate_2_Mbps,
+                            ble::gap::phy_layer_parameters::rate_2_Mbps);
+    gap_observer.link_layer_update(0x10u, policy.data_length_max, 0u,
+                                   policy.data_length_max, 0u);
+    controller.set_queue_depth(policy.load_queue_depth);
+    controller.update(100u);
+    EXPECT_EQ(operations.phy_requests.size(), 0u);
+    EXPECT_EQ(operations.data_length_requests.size(), 0u);
+
+    // Events for another connection are ignored.
+    gap_observer.disconnect(0x11u, ble::hci::error_code::success);
+    EXPECT_TRUE(controller.is_connected());
+
+    gap_observer.disconnect(0x10u, ble::hci::error_code::success);
+    EXPECT_FALSE(controller.is_connected());
+}
+
+TEST(ConnectionRateController, RateLimit)
+{
+    fake_gap_operations operations;
+    connection_rate_controller controller(operations);
+
+    uint32_t now_msec = 0u;
+    controller.connect(0x10u);
+
+    // A busy link layer rejects the request; the retry is rate limited.
+    operations.parameter_status = status::busy;
+    now_msec = run_traffic(controller, now_msec, 1000u, 10000u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::idle);
+    std::size_t const busy_requests = operations.parameter_requests.size();
+    EXPECT_EQ(busy_requests, 1u);
+
+    operations.parameter_status = status::success;
+    now_msec = run_traffic(controller, now_msec, policy.request_interval_min_msec, 10000u);
+    EXPECT_EQ(controller.mode(), connection_rate_controller::link_mode::loaded);
+    EXPECT_EQ(operations.parameter_requests.size(), busy_requests + 1u);
+
+    // Traffic stopping and restarting quickly does not cause request churn.
+    now_msec = run_traffic(controller, now_msec, 500u, 0u);
+    now_msec = run_traffic(controller, now_msec, 500u, 10000u);
+    EXPECT_EQ(operations.parameter_requests.size(), busy_requests + 1u);
+
+    // No requests are made after disconnect.
+    controller.disconnect();
+    run_traffic(controller, now_msec, 30000u, 0u);
+    EXPECT_EQ(operations.parameter_requests.size(), busy_requests + 1u);
+}
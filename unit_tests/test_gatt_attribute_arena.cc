@@ -0,0 +1,129 @@
+/**
+ * @file test_gatt_attribute_arena.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/gatt_attribute_arena.h"
+#include "ble/gatt_characteristic.h"
+#include "ble/gatt_service.h"
+#include "ble/service/battery_service.h"
+#include "ble/service/adc_sensor_service.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @struct arena_value_characteristic
+ * A characteristic of length bytes whose value is held in the arena.
+ */
+struct arena_value_characteristic: public ble::gatt::characteristic
+{
+    virtual ~arena_value_characteristic() override = default;
+
+    arena_value_characteristic(uint16_t uuid_16, ble::att::length_t length) :
+        ble::gatt::characteristic(uuid_16, ble::gatt::properties::read_write),
+        length_(length),
+        data_(nullptr)
+    {
+    }
+
+    virtual void const* data_pointer() const override { return this->data_; }
+    virtual ble::att::length_t data_length() const override { return this->length_; }
+
+    virtual bool value_relocate(void* location) override {
+        this->data_ = static_cast<uint8_t*>(location);
+        return true;
+    }
+
+    ble::att::length_t  length_;
+    uint8_t*            data_;
+};
+
+using adc_samples = ble::service::custom::adc_samples_characteristic<int16_t, 8u>;
+
+TEST(GattAttributeArena, Layout)
+{
+    alignas(uint32_t) uint8_t storage[64u];
+    ble::gatt::attribute_arena arena(storage, sizeof(storage));
+
+    ble::gatt::service service(0x1234u, ble::gatt::attribute_type::primary_service);
+    arena_value_characteristic  value_1(0x2001u, 3u);
+    ble::service::battery_level battery_level;
+    adc_samples                 samples;
+    arena_value_characteristic  value_2(0x2002u, 5u);
+
+    service.characteristic_add(value_1);
+    service.characteristic_add(battery_level);
+    service.characteristic_add(samples);
+    service.characteristic_add(value_2);
+
+    // Before layout the values are not located; the stack would hold them.
+    EXPECT_EQ(std::as_const(samples).data_pointer(), nullptr);
+
+    EXPECT_EQ(arena.layout(service), 3u);
+    EXPECT_EQ(arena.attribute_count(), 3u);
+
+    // Values are placed in list (handle) order, each 4 byte aligned.
+    // The battery level value is held inline and is not relocated.
+    EXPECT_EQ(value_1.data_, storage);
+    EXPECT_EQ(std::as_const(samples).data_pointer(), storage + 4u);
+    EXPECT_EQ(value_2.data_, storage + 4u + 16u);
+    EXPECT_NE(std::as_const(battery_level).data_pointer(), nullptr);
+
+    EXPECT_EQ(arena.size(), 4u + 16u + 5u);
+    EXPECT_EQ(arena.padding(), 1u);
+
+    // Attribute writes land in the arena.
+    uint8_t const write_data[] = { 0x11u, 0x22u, 0x33u, 0x44u, 0x55u };
+    EXPECT_EQ(value_2.write(ble::att::op_code::write_request, 0u,
+                            sizeof(write_data), write_data), 5u);
+    EXPECT_EQ(std::memcmp(storage + 20u, write_data, sizeof(write_data)), 0);
+}
+
+TEST(GattAttributeArena, Full)
+{
+    alignas(uint32_t) uint8_t storage[8u];
+    ble::gatt::attribute_arena arena(storage, sizeof(storage));
+
+    arena_value_characteristic value_1(0x2001u, 6u);
+    arena_value_characteristic value_2(0x2002u, 4u);
+    arena_value_characteristic value_3(0x2003u, 0u);
+
+    EXPECT_EQ(arena.allocate(value_1), storage);
+    EXPECT_EQ(arena.allocate(value_2), nullptr);
+    EXPECT_EQ(value_2.data_, nullptr);
+    EXPECT_EQ(arena.allocate(value_3), nullptr);
+    EXPECT_EQ(arena.attribute_count(), 1u);
+
+    arena.clear();
+    EXPECT_EQ(arena.size(), 0u);
+    EXPECT_EQ(arena.allocate(value_2), storage);
+}
+
+TEST(GattAttributeArena, SnapshotRestore)
+{
+    alignas(uint32_t) uint8_t storage[32u];
+    ble::gatt::attribute_arena arena(storage, sizeof(storage));
+
+    arena_value_characteristic value_1(0x2001u, 2u);
+    arena_value_characteristic value_2(0x2002u, 7u);
+    arena.allocate(value_1);
+    arena.allocate(value_2);
+
+    value_1.data_[0] = 0xa5u;
+    value_2.data_[6] = 0x5au;
+
+    std::vector<uint8_t> snapshot(arena.size());
+    EXPECT_EQ(arena.snapshot(snapshot.data(), snapshot.size()), arena.size());
+    EXPECT_EQ(arena.snapshot(snapshot.data(), snapshot.size() - 1u), 0u);
+
+    value_1.data_[0] = 0u;
+    value_2.data_[6] = 0u;
+
+    EXPECT_FALSE(arena.restore(snapshot.data(), snapshot.size() - 1u));
+    EXPECT_TRUE(arena.restore(snapshot.data(), snapshot.size()));
+    EXPECT_EQ(value_1.data_[0], 0xa5u);
+    EXPECT_EQ(value_2.data_[6], 0x5au);
+}
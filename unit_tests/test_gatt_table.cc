@@ -0,0 +1,236 @@
+/**
+ * @file test_gatt_table.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/gatt_table.h"
+#include "ble/gatt_characteristic.h"
+#include "ble/gatt_service.h"
+#include "ble/service/battery_service.h"
+#include "ble/service/current_time_service.h"
+#include "ble/service/device_information_service.h"
+#include "ble/service/adc_sensor_service.h"
+#include "ble/service/custom_uuid.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace ble::gatt;
+namespace custom = ble::service::custom;
+
+namespace
+{
+
+constexpr std::size_t const adc_channel_count   = 8u;
+constexpr std::size_t const serial_number_size  = 16u;
+constexpr uint16_t    const handle_first        = 12u;
+
+constexpr boost::uuids::uuid const& adc_sensor_base =
+    custom::service_uuid_base<custom::services::adc_sensor>;
+
+using battery_schema = schema::service<
+    schema::uuid16<service_type::battery_service>,
+    schema::characteristic<schema::uuid16<characteristic_type::battery_level>,
+                           properties::read | properties::notify, uint8_t, schema::cccd>,
+    schema::characteristic<schema::uuid16<characteristic_type::battery_power_state>,
+                           properties::read | properties::notify, uint8_t, schema::cccd>>;
+
+// ble::service::current_time is declared with the date_time uuid.
+using current_time_schema = schema::service<
+    schema::uuid16<service_type::current_time_service>,
+    schema::characteristic<schema::uuid16<characteristic_type::date_time>,
+                           properties::read | properties::write | properties::notify,
+                           std::array<uint8_t, ble::service::current_time::value_length>,
+                           schema::cccd>>;
+
+using device_information_schema = schema::service<
+    schema::uuid16<service_type::device_information>,
+    schema::characteristic<schema::uuid16<characteristic_type::serial_number_string>,
+                           properties::read, std::array<char, serial_number_size>>>;
+
+using adc_sensor_schema = schema::service<
+    schema::uuid128<adc_sensor_base>,
+    schema::characteristic<
+        schema::uuid128<adc_sensor_base, static_cast<uint16_t>(custom::characteristics::adc_samples)>,
+        properties::read | properties::notify,
+        std::array<int16_t, adc_channel_count>,
+        schema::cccd>,
+    schema::characteristic<
+        schema::uuid128<adc_sensor_base, static_cast<uint16_t>(custom::characteristics::adc_enable)>,
+        properties::read_write,
+        std::array<bool, adc_channel_count>>>;
+
+using gatt_table = table<handle_first,
+                         battery_schema,
+                         current_time_schema,
+                         device_information_schema,
+                         adc_sensor_schema>;
+
+/**
+ * Assign handles to the runtime services the way the softdevice does:
+ * the service declaration, then for each characteristic the declaration,
+ * the value and the descriptors in list order.
+ */
+void assign_handles(std::vector<service*> const& services, uint16_t handle)
+{
+    for (service* service_node : services)
+    {
+        service_node->decl.handle = handle++;
+        for (attribute& attr_node : service_node->characteristic_list)
+        {
+            characteristic& chr = static_cast<characteristic&>(attr_node);
+            chr.decl.handle  = handle++;
+            chr.value_handle = handle++;
+            for (attribute& descriptor : chr.descriptor_list)
+            {
+                descriptor.decl.handle = handle++;
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+static_assert(gatt_table::attribute_count == 7u + 4u + 3u + 6u);
+static_assert(gatt_table::find(handle_first)->is_service());
+static_assert(gatt_table::find(handle_first + 1u)->is_characteristic());
+static_assert(gatt_table::find(handle_first - 1u) == nullptr);
+static_assert(gatt_table::find(gatt_table::handle_end()) == nullptr);
+
+TEST(GattTable, MatchesRuntimeServices)
+{
+    ble::service::battery_level         battery_level;
+    ble::service::battery_power_state   battery_power_state;
+    ble::service::battery_service       battery_service;
+    battery_service.characteristic_add(battery_level);
+    battery_service.characteristic_add(battery_power_state);
+
+    ble::service::current_time_service  current_time_service;
+
+    ble::service::serial_number_string<serial_number_size> serial_number("0123456789ABCDEF");
+    ble::service::device_information_service device_information_service;
+    device_information_service.characteristic_add(serial_number);
+
+    custom::adc_samples_characteristic<int16_t, adc_channel_count> adc_samples;
+    custom::adc_enable_characteristic<adc_channel_count>           adc_enable;
+    custom::adc_sensor_service                                     adc_sensor_service;
+    adc_sensor_service.characteristic_add(adc_samples);
+    adc_sensor_service.characteristic_add(adc_enable);
+
+    std::vector<service*> const services = {
+        &battery_service, &current_time_service,
+        &device_information_service, &adc_sensor_service
+    };
+    assign_handles(services, handle_first);
+
+    std::size_t attribute_count = 0u;
+    for (service const* service_node : services)
+    {
+        table_attribute const* service_attr = gatt_table::find(service_node->decl.handle);
+        ASSERT_NE(service_attr, nullptr);
+        EXPECT_TRUE(service_attr->is_service());
+        EXPECT_EQ(service_attr->type, service_node->decl.attribute_type);
+        EXPECT_EQ(service_attr->uuid_value(), service_node->uuid);
+        EXPECT_EQ(service_attr->service_handle, service_node->decl.handle);
+        ++attribute_count;
+
+        for (attribute const& attr_node : service_node->characteristic_list)
+        {
+            characteristic const& chr = static_cast<characteristic const&>(attr_node);
+
+            table_attribute const* decl_attr = gatt_table::find(chr.decl.handle);
+            ASSERT_NE(decl_attr, nullptr);
+            EXPECT_TRUE(decl_attr->is_characteristic());
+            EXPECT_EQ(decl_attr->uuid_value(), chr.uuid);
+            EXPECT_EQ(decl_attr->properties, chr.decl.properties.get());
+            EXPECT_EQ(decl_attr->service_handle, service_node->decl.handle);
+
+            table_attribute const* value_attr = gatt_table::find(chr.value_handle);
+            ASSERT_NE(value_attr, nullptr);
+            EXPECT_TRUE(value_attr->is_value());
+            EXPECT_EQ(value_attr->uuid_value(), chr.uuid);
+            EXPECT_EQ(value_attr->properties, chr.decl.properties.get());
+            EXPECT_EQ(value_attr->length,     chr.data_length());
+            EXPECT_EQ(value_attr->length_max, chr.data_length_max());
+            EXPECT_EQ(value_attr->data_length_is_variable(), chr.data_length_is_variable());
+            EXPECT_EQ(value_attr->service_handle, service_node->decl.handle);
+            attribute_count += 2u;
+
+            for (attribute const& descriptor : chr.descriptor_list)
+            {
+                table_attribute const* desc_attr = gatt_table::find(descriptor.decl.handle);
+                ASSERT_NE(desc_attr, nullptr);
+                EXPECT_EQ(desc_attr->type, descriptor.decl.attribute_type);
+                EXPECT_EQ(desc_attr->uuid_value(), ble::att::uuid(descriptor.decl.attribute_type));
+                EXPECT_EQ(desc_attr->length, descriptor.data_length());
+                EXPECT_EQ(desc_attr->service_handle, service_node->decl.handle);
+                ++attribute_count;
+            }
+
+            // The runtime lookup and the table agree on each handle.
+            for (uint16_t handle = chr.value_handle; handle <= chr.hande_range().second; ++handle)
+            {
+                attribute const* runtime_attr = service_node->find_attribute(handle);
+                ASSERT_NE(runtime_attr, nullptr);
+                EXPECT_EQ(gatt_table::find(handle)->handle, handle);
+            }
+        }
+    }
+
+    EXPECT_EQ(attribute_count, gatt_table::attribute_count);
+    EXPECT_EQ(gatt_table::handle_end(), handle_first + attribute_count);
+}
+
+TEST(GattTable, HandleOrder)
+{
+    uint16_t handle         = handle_first;
+    uint16_t service_handle = ble::att::handle_invalid;
+    for (table_attribute const& attribute : gatt_table::attributes)
+    {
+        EXPECT_EQ(attribute.handle, handle);
+        EXPECT_EQ(gatt_table::find(handle), &attribute);
+        if (attribute.is_service()) { service_handle = attribute.handle; }
+        EXPECT_EQ(attribute.service_handle, service_handle);
+
+        if (attribute.is_characteristic())
+        {
+            // A characteristic declaration is followed by its value.
+            ASSERT_LT(handle + 1u, gatt_table::handle_end());
+            EXPECT_TRUE(gatt_table::find(handle + 1u)->is_value());
+        }
+        ++handle;
+    }
+}
+
+TEST(GattTable, ValueStorage)
+{
+    static gatt_table::value_storage storage;
+    storage.fill(0u);
+
+    std::size_t value_count = 0u;
+    uint8_t const* const storage_begin = reinterpret_cast<uint8_t const*>(storage.data());
+    uint8_t const* const storage_end   = storage_begin + gatt_table::value_storage_size;
+
+    for (table_attribute const& attribute : gatt_table::attributes)
+    {
+        void* value = gatt_table::find_value(storage, attribute.handle);
+        if (not attribute.is_value())
+        {
+            EXPECT_EQ(value, nullptr);
+            EXPECT_EQ(attribute.value_offset, table_attribute::value_offset_none);
+            continue;
+        }
+
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(value) % sizeof(uint32_t), 0u);
+        EXPECT_LE(static_cast<uint8_t const*>(value) + attribute.length_max, storage_end);
+        ++value_count;
+    }
+
+    // Values are placed in handle order without overlap.
+    EXPECT_EQ(value_count, 6u);
+    EXPECT_EQ(gatt_table::value_storage_size, 4u + 4u + 12u + 16u + 16u + 8u);
+    EXPECT_EQ(gatt_table::find_value(storage, gatt_table::handle_end()), nullptr);
+}
@@ -0,0 +1,584 @@
+/**
+ * @file test_gattc_attribute_transfer.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "ble/gattc_attribute_transfer.h"
+#include "ble/gattc_operations.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using ble::gattc::attribute_transfer;
+using ble::att::error_code;
+
+static constexpr uint16_t const connection_handle = 0x0010u;
+
+/**
+ * @class simulated_gatt_server
+ * A GATT server behind the ble::gattc::operations interface.
+ * Each request produces one response which is held until deliver() is
+ * called; one request/response pair is one round trip.
+ */
+class simulated_gatt_server: public ble::gattc::operations
+{
+public:
+    using value_type = std::vector<uint8_t>;
+
+    virtual ~simulated_gatt_server() override = default;
+
+    explicit simulated_gatt_server(ble::att::length_t mtu): mtu_(mtu) {}
+
+    attribute_transfer* client = nullptr;
+
+    std::map<uint16_t, value_type> attributes;
+
+    bool        variable_supported  = true;
+    std::size_t prepare_queue_max   = 64u;
+    bool        corrupt_echo        = false;
+    uint32_t    round_trips         = 0u;
+
+    /** Deliver the responses until the transfer is complete. */
+    void deliver()
+    {
+        while (this->response_)
+        {
+            std::function<void()> response = std::move(this->response_);
+            this->response_ = nullptr;
+            this->round_trips += 1u;
+            response();
+        }
+    }
+
+    std::errc read(uint16_t conn, uint16_t handle, ble::att::length_t offset) override
+    {
+        EXPECT_FALSE(this->response_);
+        auto iter = this->attributes.find(handle);
+        if (iter == this->attributes.end())
+        {
+            return this->respond_read_error(conn, handle, error_code::invalid_handle);
+        }
+
+        value_type const& value = iter->second;
+        if (offset > value.size())
+        {
+            return this->respond_read_error(conn, handle, error_code::invalid_offset);
+        }
+
+        std::size_t const length =
+            std::min<std::size_t>(this->mtu_ - 1u, value.size() - offset);
+        value_type data(value.begin() + offset, value.begin() + offset + length);
+        this->response_ = [this, conn, handle, offset, data]() {
+            this->client->read_response(conn, error_code::success,
+                                        ble::att::handle_invalid, handle,
+                                        data.data(), offset, data.size());
+        };
+        return errc_success;
+    }
+
+    std::errc read_multiple(uint16_t conn, uint16_t const* handles,
+                            std::size_t count) override
+    {
+        EXPECT_FALSE(this->response_);
+        EXPECT_GE(count, 2u);
+        EXPECT_LE(count * sizeof(uint16_t), this->mtu_ - 1u);
+
+        value_type data;
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            value_type const& value = this->attributes.at(handles[index]);
+            data.insert(data.end(), value.begin(), value.end());
+        }
+        data.resize(std::min<std::size_t>(data.size(), this->mtu_ - 1u));
+
+        this->response_ = [this, conn, data]() {
+            this->client->read_multi_response(conn, error_code::success,
+                                              ble::att::handle_invalid,
+                                              data.data(), data.size());
+        };
+        return errc_success;
+    }
+
+    std::errc read_multiple_variable(uint16_t conn, uint16_t const* handles,
+                                     std::size_t count) override
+    {
+        if (not this->variable_supported)
+        {
+            return std::errc::function_not_supported;
+        }
+
+        EXPECT_FALSE(this->response_);
+        EXPECT_LE(count * sizeof(uint16_t), this->mtu_ - 1u);
+
+        value_type data;
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            value_type const& value = this->attributes.at(handles[index]);
+            data.push_back(static_cast<uint8_t>(value.size()));
+            data.push_back(static_cast<uint8_t>(value.size() >> 8u));
+            data.insert(data.end(), value.begin(), value.end());
+        }
+        data.resize(std::min<std::size_t>(data.size(), this->mtu_ - 1u));
+
+        this->response_ = [this, conn, data]() {
+            this->client->read_multi_variable_response(conn, error_code::success,
+                                                       ble::att::handle_invalid,
+                                                       data.data(), data.size());
+        };
+        return errc_success;
+    }
+
+    std::errc write_request(uint16_t conn, uint16_t handle, void const* data,
+                            ble::att::length_t offset,
+                            ble::att::length_t length) override
+    {
+        EXPECT_FALSE(this->response_);
+        EXPECT_LE(length, this->mtu_ - 3u);
+        uint8_t const* bytes = static_cast<uint8_t const*>(data);
+        this->attributes[handle].assign(bytes, bytes + length);
+        return this->respond_write(conn, error_code::success,
+                                   ble::att::op_code::write_request,
+                                   handle, value_type(), 0u);
+    }
+
+    std::errc write_command(uint16_t, uint16_t, void const*,
+                            ble::att::length_t, ble::att::length_t) override {
+        return std::errc::function_not_supported;
+    }
+
+    std::errc write_command_signed(uint16_t, uint16_t, void const*,
+                                   ble::att::length_t, ble::att::length_t) override {
+        return std::errc::function_not_supported;
+    }
+
+    std::errc write_prepare(uint16_t conn, uint16_t handle, void const* data,
+                            ble::att::length_t offset,
+                            ble::att::length_t length) override
+    {
+        EXPECT_FALSE(this->response_);
+        EXPECT_LE(length, this->mtu_ - 5u);
+        if (this->prepare_queue_.size() >= this->prepare_queue_max)
+        {
+            return this->respond_write(conn, error_code::prepare_queue_full,
+                                       ble::att::op_code::write_prepare_request,
+                                       handle, value_type(), offset);
+        }
+
+        uint8_t const* bytes = static_cast<uint8_t const*>(data);
+        value_type value(bytes, bytes + length);
+        this->prepare_queue_.push_back({handle, offset, value});
+
+        if (this->corrupt_echo && (offset > 0u))
+        {
+            value[0] ^= 0xffu;
+        }
+        return this->respond_write(conn, error_code::success,
+                                   ble::att::op_code::write_prepare_request,
+                                   handle, value, offset);
+    }
+
+    std::errc write_execute(uint16_t conn, uint16_t handle, void const*,
+                            ble::att::length_t, ble::att::length_t) override
+    {
+        EXPECT_FALSE(this->response_);
+        for (prepared_write const& write : this->prepare_queue_)
+        {
+            value_type& value = this->attributes[write.handle];
+            value.resize(std::max(value.size(), write.offset + write.value.size()));
+            std::copy(write.value.begin(), write.value.end(),
+                      value.begin() + write.offset);
+        }
+        this->prepare_queue_.clear();
+        return this->respond_write(conn, error_code::success,
+                                   ble::att::op_code::write_execute_request,
+                                   handle, value_type(), 0u);
+    }
+
+    std::errc write_cancel(uint16_t conn, uint16_t handle, void const*,
+                           ble::att::length_t, ble::att::length_t) override
+    {
+        EXPECT_FALSE(this->response_);
+        this->prepare_queue_.clear();
+        this->cancel_count += 1u;
+        return this->respond_write(conn, error_code::success,
+                                   ble::att::op_code::write_execute_request,
+                                   handle, value_type(), 0u);
+    }
+
+    std::errc handle_value_confirm(uint16_t, uint16_t) override {
+        return std::errc::function_not_supported;
+    }
+
+    std::errc exchange_mtu_request(uint16_t, ble::att::length_t) override {
+        return std::errc::function_not_supported;
+    }
+
+    uint32_t cancel_count = 0u;
+
+private:
+    struct prepared_write
+    {
+        uint16_t            handle;
+        std::size_t         offset;
+        value_type          value;
+    };
+
+    std::errc respond_read_error(uint16_t conn, uint16_t handle, error_code error)
+    {
+        this->response_ = [this, conn, handle, error]() {
+            this->client->read_response(conn, error, handle, handle,
+                                        nullptr, 0u, 0u);
+        };
+        return errc_success;
+    }
+
+    std::errc respond_write(uint16_t conn, error_code error,
+                            ble::att::op_code op_code, uint16_t handle,
+                            value_type data, ble::att::length_t offset)
+    {
+        this->response_ = [this, conn, error, op_code, handle, data, offset]() {
+            this->client->write_response(conn, error, handle, op_code, handle,
+                                         data.data(), offset, data.size());
+        };
+        return errc_success;
+    }
+
+    ble::att::length_t                  mtu_;
+    std::function<void()>               response_;
+    std::vector<prepared_write>         prepare_queue_;
+};
+
+/**
+ * @struct transfer_result
+ * Record the completion notifications.
+ */
+struct transfer_result: public attribute_transfer::completion_notify
+{
+    virtual ~transfer_result() override = default;
+    transfer_result() = default;
+
+    void read_complete(uint16_t, uint16_t handle, error_code error,
+                       ble::att::length_t read_length) override
+    {
+        this->count += 1u;
+        this->error  = error;
+        this->length = read_length;
+    }
+
+    void write_complete(uint16_t, uint16_t, error_code error) override
+    {
+        this->count += 1u;
+        this->error  = error;
+    }
+
+    void read_multiple_complete(uint16_t, error_code error,
+                                uint16_t handle) override
+    {
+        this->count       += 1u;
+        this->error        = error;
+        this->error_handle = handle;
+    }
+
+    uint32_t            count        = 0u;
+    error_code          error        = error_code::unknown;
+    ble::att::length_t  length       = 0u;
+    uint16_t            error_handle = ble::att::handle_invalid;
+};
+
+static std::vector<uint8_t> make_value(std::size_t length, uint8_t seed)
+{
+    std::vector<uint8_t> value(length);
+    for (std::size_t index = 0u; index < length; ++index)
+    {
+        value[index] = static_cast<uint8_t>(seed + index * 7u);
+    }
+    return value;
+}
+
+/**
+ * @struct transfer_link
+ * A client and a simulated server connected with a given ATT_MTU.
+ */
+struct transfer_link
+{
+    explicit transfer_link(ble::att::length_t mtu): server(mtu), client(server)
+    {
+        this->server.client = &this->client;
+        this->client.exchange_mtu_response(connection_handle, error_code::success,
+                                           ble::att::handle_invalid, mtu);
+    }
+
+    simulated_gatt_server   server;
+    attribute_transfer      client;
+    transfer_result         result;
+};
+
+static ble::att::length_t const mtu_sizes[] = { 23u, 185u, 247u };
+
+/// The number of PDUs needed to carry length bytes, count_max per PDU.
+static uint32_t pdu_count(std::size_t length, std::size_t count_max)
+{
+    return static_cast<uint32_t>((length + count_max - 1u) / count_max);
+}
+
+TEST(GattcAttributeTransfer, LongRead)
+{
+    std::size_t const value_length = 512u;
+    std::vector<uint8_t> const value = make_value(value_length, 0x11u);
+
+    for (ble::att::length_t const mtu : mtu_sizes)
+    {
+        transfer_link link(mtu);
+        link.server.attributes[0x20u] = value;
+        EXPECT_EQ(link.client.mtu(), mtu);
+
+        // A buffer sized to the value ends the read when it is full.
+        std::vector<uint8_t> buffer(value_length);
+        EXPECT_EQ(link.client.read(connection_handle, 0x20u, buffer.data(),
+                                   buffer.size(), &link.result), errc_success);
+        EXPECT_TRUE(link.client.is_busy());
+        link.server.deliver();
+
+        EXPECT_FALSE(link.client.is_busy());
+        EXPECT_EQ(link.result.count, 1u);
+        EXPECT_EQ(link.result.error, error_code::success);
+        EXPECT_EQ(link.result.length, value_length);
+        EXPECT_EQ(buffer, value);
+        EXPECT_EQ(link.server.round_trips, pdu_count(value_length, mtu - 1u));
+        EXPECT_EQ(link.client.request_count(), link.server.round_trips);
+
+        // A larger buffer reads until a short response.
+        link.server.round_trips = 0u;
+        std::vector<uint8_t> large_buffer(1024u);
+        EXPECT_EQ(link.client.read(connection_handle, 0x20u, large_buffer.data(),
+                                   large_buffer.size(), &link.result), errc_success);
+        link.server.deliver();
+
+        EXPECT_EQ(link.result.count, 2u);
+        EXPECT_EQ(link.result.length, value_length);
+        EXPECT_TRUE(std::equal(value.begin(), value.end(), large_buffer.begin()));
+        EXPECT_EQ(link.server.round_trips, value_length / (mtu - 1u) + 1u);
+    }
+}
+
+TEST(GattcAttributeTransfer, LongReadBoundary)
+{
+    // A value whose length is a multiple of (ATT_MTU - 1) ends with an
+    // empty Read Blob Response.
+    ble::att::length_t const mtu = 23u;
+    std::vector<uint8_t> const value = make_value(3u * (mtu - 1u), 0x22u);
+
+    transfer_link link(mtu);
+    link.server.attributes[0x30u] = value;
+
+    std::vector<uint8_t> buffer(256u);
+    EXPECT_EQ(link.client.read(connection_handle, 0x30u, buffer.data(),
+                               buffer.size(), &link.result), errc_success);
+    link.server.deliver();
+
+    EXPECT_EQ(link.result.error, error_code::success);
+    EXPECT_EQ(link.result.length, value.size());
+    EXPECT_EQ(link.server.round_trips, 4u);
+
+    // Reading a missing attribute reports the server's error.
+    EXPECT_EQ(link.client.read(connection_handle, 0x31u, buffer.data(),
+                               buffer.size(), &link.result), errc_success);
+    link.server.deliver();
+    EXPECT_EQ(link.result.error, error_code::invalid_handle);
+    EXPECT_FALSE(link.client.is_busy());
+}
+
+TEST(GattcAttributeTransfer, LongWrite)
+{
+    std::size_t const value_length = 512u;
+    std::vector<uint8_t> const value = make_value(value_length, 0x33u);
+
+    for (ble::att::length_t const mtu : mtu_sizes)
+    {
+        transfer_link link(mtu);
+
+        EXPECT_EQ(link.client.write(connection_handle, 0x40u, value.data(),
+                                    value.size(), &link.result), errc_success);
+        link.server.deliver();
+
+        EXPECT_EQ(link.result.count, 1u);
+        EXPECT_EQ(link.result.error, error_code::success);
+        EXPECT_EQ(link.server.attributes[0x40u], value);
+
+        // Prepare Write Requests followed by one Execute Write Request.
+        EXPECT_EQ(link.server.round_trips, pdu_count(value_length, mtu - 5u) + 1u);
+        EXPECT_EQ(link.server.cancel_count, 0u);
+
+        // A short value uses a single Write Request.
+        link.server.round_trips = 0u;
+        std::vector<uint8_t> const short_value = make_value(mtu - 3u, 0x44u);
+        EXPECT_EQ(link.client.write(connection_handle, 0x41u, short_value.data(),
+                                    short_value.size(), &link.result), errc_success);
+        link.server.deliver();
+
+        EXPECT_EQ(link.result.error, error_code::success);
+        EXPECT_EQ(link.server.attributes[0x41u], short_value);
+        EXPECT_EQ(link.server.round_trips, 1u);
+    }
+}
+
+TEST(GattcAttributeTransfer, LongWriteEchoMismatch)
+{
+    transfer_link link(23u);
+    std::vector<uint8_t> const original = make_value(8u, 0x55u);
+    std::vector<uint8_t> const value    = make_value(100u, 0x66u);
+    link.server.attributes[0x50u] = original;
+    link.server.corrupt_echo = true;
+
+    EXPECT_EQ(link.client.write(connection_handle, 0x50u, value.data(),
+                                value.size(), &link.result), errc_success);
+    link.server.deliver();
+
+    // The second Prepare Write Response is corrupt; the queue is cancelled.
+    EXPECT_EQ(link.result.count, 1u);
+    EXPECT_EQ(link.result.error, error_code::unlikely_error);
+    EXPECT_EQ(link.server.cancel_count, 1u);
+    EXPECT_EQ(link.server.round_trips, 3u);
+    EXPECT_EQ(link.server.attributes[0x50u], original);
+    EXPECT_FALSE(link.client.is_busy());
+}
+
+TEST(GattcAttributeTransfer, LongWriteQueueFull)
+{
+    transfer_link link(23u);
+    std::vector<uint8_t> const value = make_value(100u, 0x77u);
+    link.server.prepare_queue_max = 2u;
+
+    EXPECT_EQ(link.client.write(connection_handle, 0x60u, value.data(),
+                                value.size(), &link.result), errc_success);
+    link.server.deliver();
+
+    EXPECT_EQ(link.result.error, error_code::prepare_queue_full);
+    EXPECT_EQ(link.server.cancel_count, 1u);
+    EXPECT_EQ(link.server.attributes.count(0x60u), 0u);
+}
+
+TEST(GattcAttributeTransfer, Busy)
+{
+    transfer_link link(23u);
+    link.server.attributes[0x70u] = make_value(4u, 0u);
+
+    uint8_t buffer[4u];
+    EXPECT_EQ(link.client.read(connection_handle, 0x70u, buffer, sizeof(buffer),
+                               &link.result), errc_success);
+    EXPECT_EQ(link.client.read(connection_handle, 0x70u, buffer, sizeof(buffer),
+                               &link.result), std::errc::device_or_resource_busy);
+    EXPECT_EQ(link.client.write(connection_handle, 0x70u, buffer, sizeof(buffer),
+                                &link.result), std::errc::device_or_resource_busy);
+    link.server.deliver();
+    EXPECT_EQ(link.result.count, 1u);
+}
+
+/**
+ * Populate the server with value_count attributes starting at handle 0x100.
+ * The lengths are taken from the lengths table in rotation.
+ */
+static void make_attribute_set(transfer_link&                          link,
+                               std::vector<std::size_t> const&         lengths,
+                               std::size_t                             value_count,
+                               std::vector<std::vector<uint8_t>>&      buffers,
+                               std::vector<attribute_transfer::attribute_value>& values)
+{
+    buffers.resize(value_count);
+    values.resize(value_count);
+    for (std::size_t index = 0u; index < value_count; ++index)
+    {
+        uint16_t const handle = static_cast<uint16_t>(0x100u + index);
+        std::size_t const length = lengths[index % lengths.size()];
+        link.server.attributes[handle] = make_value(length, static_cast<uint8_t>(index));
+        buffers[index].assign(length, 0u);
+        values[index] = { handle, buffers[index].data(),
+                          static_cast<ble::att::length_t>(length), 0u };
+    }
+}
+
+static void expect_attribute_set(transfer_link const&                                    link,
+                                 std::vector<std::vector<uint8_t>> const&               buffers,
+                                 std::vector<attribute_transfer::attribute_value> const& values)
+{
+    for (std::size_t index = 0u; index < values.size(); ++index)
+    {
+        EXPECT_EQ(values[index].length, buffers[index].size());
+        EXPECT_EQ(buffers[index], link.server.attributes.at(values[index].handle));
+    }
+}
+
+TEST(GattcAttributeTransfer, ReadMultiple)
+{
+    std::size_t const value_count = 20u;
+
+    for (ble::att::length_t const mtu : mtu_sizes)
+    {
+        transfer_link link(mtu);
+        std::vector<std::vector<uint8_t>> buffers;
+        std::vector<attribute_transfer::attribute_value> values;
+        make_attribute_set(link, {4u}, value_count, buffers, values);
+
+        EXPECT_EQ(link.client.read_multiple(connection_handle, values.data(),
+                                            values.size(), false, &link.result),
+                  errc_success);
+        link.server.deliver();
+
+        EXPECT_EQ(link.result.count, 1u);
+        EXPECT_EQ(link.result.error, error_code::success);
+        expect_attribute_set(link, buffers, values);
+
+        // Each response carries as many 4 byte values as fit in (ATT_MTU - 1).
+        EXPECT_EQ(link.server.round_trips, pdu_count(value_count, (mtu - 1u) / 4u));
+        EXPECT_LT(link.server.round_trips, value_count);
+    }
+}
+
+TEST(GattcAttributeTransfer, ReadMultipleVariable)
+{
+    std::size_t const value_count = 20u;
+    std::vector<std::size_t> const lengths = { 2u, 9u, 1u, 30u, 4u, 120u };
+
+    for (ble::att::length_t const mtu : mtu_sizes)
+    {
+        transfer_link link(mtu);
+        std::vector<std::vector<uint8_t>> buffers;
+        std::vector<attribute_transfer::attribute_value> values;
+        make_attribute_set(link, lengths, value_count, buffers, values);
+
+        EXPECT_EQ(link.client.read_multiple(connection_handle, values.data(),
+                                            values.size(), true, &link.result),
+                  errc_success);
+        link.server.deliver();
+
+        EXPECT_EQ(link.result.error, error_code::success);
+        expect_attribute_set(link, buffers, values);
+        uint32_t const variable_round_trips = link.server.round_trips;
+
+        // Without server support each value is read individually.
+        transfer_link fallback(mtu);
+        fallback.server.variable_supported = false;
+        make_attribute_set(fallback, lengths, value_count, buffers, values);
+
+        EXPECT_EQ(fallback.client.read_multiple(connection_handle, values.data(),
+                                                values.size(), true, &fallback.result),
+                  errc_success);
+        fallback.server.deliver();
+
+        EXPECT_EQ(fallback.result.error, error_code::success);
+        expect_attribute_set(fallback, buffers, values);
+        EXPECT_GE(fallback.server.round_trips, value_count);
+        EXPECT_LT(variable_round_trips, fallback.server.round_trips);
+
+        std::cout << "ATT_MTU " << mtu
+                  << ": read multiple variable round trips: " << variable_round_trips
+                  << ", individual reads: " << fallback.server.round_trips
+                  << std::endl;
+    }
+}
@@ -5,6 +5,7 @@
 
 #include "gtest/gtest.h"
 #include "gregorian.h"
+#include <iterator>
 #include <vector>
 
 /**
@@ -130,3 +131,101 @@ TEST(GregorianTest, Fixed)
         test_greg(greg);
     }
 }
+
+/**
+ * Cross check the conversions against a calendar which is advanced one day
+ * at a time, for every day from the epoch to the last day of UINT16_MAX.
+ * The time of day is varied so that each field of the time conversion is
+ * exercised as well.
+ */
+TEST(GregorianTest, Exhaustive)
+{
+    static uint8_t const month_days[] = {
+        31u, 28u, 31u, 30u, 31u, 30u, 31u, 31u, 30u, 31u, 30u, 31u
+    };
+
+    uint32_t year          = utility::gregorian::epoch_year;
+    uint32_t month         = utility::gregorian::January;
+    uint32_t day_of_month  = 1u;
+    uint32_t day_of_year   = 1u;
+    uint32_t day_of_week   = utility::gregorian::epoch_day_of_week;
+    uint32_t failure_count = 0u;
+
+    for (uint32_t day_count = 0u; year <= UINT16_MAX; ++day_count)
+    {
+        uint32_t const time_of_day = (day_count * 7919u) % 86400u;
+        uint64_t const seconds     = uint64_t(day_count) * 86400u + time_of_day;
+
+        utility::gregorian const greg = utility::gregorian::to_calendar(seconds);
+        bool const match =
+            (greg.year          == year)                        &&
+            (greg.month         == month)                       &&
+            (greg.day_of_month  == day_of_month)                &&
+            (greg.hours         == time_of_day / 3600u)         &&
+            (greg.minutes       == (time_of_day / 60u) % 60u)   &&
+            (greg.seconds       == time_of_day % 60u)           &&
+            (utility::gregorian::days_since_epoch(greg)    == day_count)    &&
+            (utility::gregorian::seconds_since_epoch(greg) == seconds)      &&
+            (utility::gregorian::calc_day_of_year(greg)    == day_of_year)  &&
+            (utility::gregorian::calc_day_of_week(greg)    == day_of_week);
+
+        if (not match)
+        {
+            // Limit the output should the conversion be broken.
+            failure_count += 1u;
+            if (failure_count <= 10u)
+            {
+                ADD_FAILURE() << "day " << day_count << ": " << greg << " expected "
+                              << year << "-" << month << "-" << day_of_month;
+            }
+        }
+
+        bool const is_leap = ((year % 4u) == 0u) &&
+                             (((year % 100u) != 0u) || ((year % 400u) == 0u));
+        uint32_t const days_this_month =
+            month_days[month - 1u] + ((month == utility::gregorian::February && is_leap) ? 1u : 0u);
+
+        day_of_week  = (day_of_week == utility::gregorian::sunday) ?
+                       utility::gregorian::monday : day_of_week + 1u;
+        day_of_year += 1u;
+        if (++day_of_month > days_this_month)
+        {
+            day_of_month = 1u;
+            if (++month > utility::gregorian::December)
+            {
+                month       = utility::gregorian::January;
+                day_of_year = 1u;
+                year       += 1u;
+            }
+        }
+    }
+
+    EXPECT_EQ(failure_count, 0u);
+}
+
+TEST(GregorianTest, ToChars)
+{
+    char buffer[utility::gregorian::char_buffer_size];
+
+    utility::gregorian::to_chars(std::begin(buffer), std::end(buffer),
+                                 utility::gregorian{2007, 4, 5, 14, 30, 0});
+    EXPECT_STREQ(buffer, "2007-04-05T14:30:00");
+
+    utility::gregorian::to_chars(std::begin(buffer), std::end(buffer),
+                                 utility::gregorian{1601, 1, 1});
+    EXPECT_STREQ(buffer, "1601-01-01T00:00:00");
+
+    utility::gregorian::to_chars(std::begin(buffer), std::end(buffer),
+                                 utility::gregorian{2999, 12, 31, 23, 59, 59});
+    EXPECT_STREQ(buffer, "2999-12-31T23:59:59");
+
+    // Truncation matches snprintf: the result is always null terminated.
+    utility::gregorian::to_chars(std::begin(buffer), std::begin(buffer) + 11u,
+                                 utility::gregorian{2007, 4, 5, 14, 30, 0});
+    EXPECT_STREQ(buffer, "2007-04-05");
+
+    // 5 digit years overflow the buffer and are truncated.
+    utility::gregorian::to_chars(std::begin(buffer), std::end(buffer),
+                                 utility::gregorian{10000, 1, 2, 3, 4, 5});
+    EXPECT_STREQ(buffer, "10000-01-02T03:04:0");
+}
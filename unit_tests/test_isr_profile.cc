@@ -0,0 +1,333 @@
+/**
+ * @file test_isr_profile.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+// Exercise the ISR_PROFILE() macros; the table is otherwise driven directly.
+#define ISR_PROFILE_ENABLED
+
+#include "gtest/gtest.h"
+#include "isr_profile.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr uint8_t const irq_rtc1   = 17u;
+constexpr uint8_t const irq_spim0  = 3u;
+constexpr uint8_t const irq_saadc  = 7u;
+constexpr uint8_t const irq_gpiote = 6u;
+
+/// An interrupt pended by a peripheral event.
+struct irq_request
+{
+    uint8_t             irq;
+    uint8_t             priority;       ///< Lower values preempt higher values.
+    profile::cycles_t   pended_at;
+    profile::cycles_t   work;           ///< The handler execution time.
+    bool                timestamped;    ///< The handler can find the event time.
+};
+
+/**
+ * @class nvic_simulator
+ * Run the ISRs for a list of peripheral events, cycle by cycle, with
+ * NVIC priority preemption and a fixed exception entry time.
+ */
+template <typename table_type>
+class nvic_simulator
+{
+public:
+    /// Cortex-M4 exception entry, zero wait state memory.
+    static constexpr profile::cycles_t const entry_cycles = 12u;
+
+    explicit nvic_simulator(table_type& table) : table_(table) {}
+
+    void run(std::vector<irq_request> requests)
+    {
+        std::stable_sort(requests.begin(), requests.end(),
+                         [](irq_request const& a, irq_request const& b) {
+                             return a.pended_at < b.pended_at;
+                         });
+
+        std::vector<irq_request> pending;
+        std::vector<frame>       active;
+        auto next = requests.begin();
+
+        profile::cycles_t now = 0u;
+        while ((next != requests.end()) || not pending.empty() || not active.empty())
+        {
+            for (; (next != requests.end()) && (next->pended_at <= now); ++next)
+            {
+                pending.push_back(*next);
+            }
+
+            auto const highest = std::min_element(
+                pending.begin(), pending.end(),
+                [](irq_request const& a, irq_request const& b) {
+                    return (a.priority < b.priority) ||
+                           ((a.priority == b.priority) && (a.irq < b.irq));
+                });
+
+            if ((highest != pending.end()) &&
+                (active.empty() || (highest->priority < active.back().request.priority)))
+            {
+                irq_request const request = *highest;
+                pending.erase(highest);
+
+                now += entry_cycles;
+                frame const entered = { request, this->table_.enter(request.irq, now), request.work };
+                if (request.timestamped)
+                {
+                    this->table_.latency(request.irq, now - request.pended_at);
+                }
+                active.push_back(entered);
+                continue;
+            }
+
+            now += 1u;
+            if (not active.empty())
+            {
+                frame& running = active.back();
+                running.remaining -= 1u;
+                if (running.remaining == 0u)
+                {
+                    this->table_.exit(running.request.irq, running.start, now);
+                    active.pop_back();
+                }
+            }
+        }
+    }
+
+private:
+    struct frame
+    {
+        irq_request         request;
+        profile::cycles_t   start;
+        profile::cycles_t   remaining;
+    };
+
+    table_type& table_;
+};
+
+class isr_query_stream: public io::input_stream
+{
+public:
+    explicit isr_query_stream(std::string commands) : commands_(commands) {}
+
+    std::size_t read(void* buffer, std::size_t length) override
+    {
+        length = std::min(length, this->commands_.size());
+        this->commands_.copy(static_cast<char*>(buffer), length);
+        this->commands_.erase(0u, length);
+        return length;
+    }
+
+    std::size_t read_pending() const override { return this->commands_.size(); }
+    std::size_t read_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void fill() override {}
+
+private:
+    std::string commands_;
+};
+
+class isr_log_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string text;
+};
+
+using table_type = isr_profile_table<48u, 8u>;
+using histogram_type = isr_profile_stats_t::histogram_type;
+
+} // anonymous namespace
+
+TEST(IsrProfile, DurationAndLatency)
+{
+    table_type table;
+    nvic_simulator<table_type> nvic(table);
+    nvic.run({
+        { irq_rtc1,  6u, 100u, 50u, true  },
+        { irq_rtc1,  6u, 300u, 70u, true  },
+        { irq_saadc, 6u, 500u, 20u, false },
+    });
+
+    isr_profile_stats_t const* const rtc = table.stats(irq_rtc1);
+    ASSERT_NE(rtc, nullptr);
+    EXPECT_EQ(rtc->count, 2u);
+    EXPECT_EQ(rtc->duration_max, 70u);
+    EXPECT_EQ(rtc->duration[histogram_type::bin(50u)], 1u);
+    EXPECT_EQ(rtc->duration[histogram_type::bin(70u)], 1u);
+    EXPECT_EQ(rtc->latency_count, 2u);
+    EXPECT_EQ(rtc->latency_max, nvic_simulator<table_type>::entry_cycles);
+    EXPECT_EQ(rtc->latency[histogram_type::bin(nvic_simulator<table_type>::entry_cycles)], 2u);
+    EXPECT_EQ(rtc->depth_max, 1u);
+
+    // Without an event timestamp no latency is recorded.
+    isr_profile_stats_t const* const saadc = table.stats(irq_saadc);
+    ASSERT_NE(saadc, nullptr);
+    EXPECT_EQ(saadc->count, 1u);
+    EXPECT_EQ(saadc->latency_count, 0u);
+
+    EXPECT_EQ(table.stats(irq_spim0), nullptr);
+    EXPECT_EQ(table.depth_max(), 1u);
+}
+
+TEST(IsrProfile, PreemptionExcludedFromDuration)
+{
+    table_type table;
+    nvic_simulator<table_type> nvic(table);
+    nvic.run({
+        { irq_rtc1,  6u, 100u, 100u, true },
+        { irq_spim0, 2u, 150u,  40u, true },
+    });
+
+    isr_profile_stats_t const* const rtc  = table.stats(irq_rtc1);
+    isr_profile_stats_t const* const spim = table.stats(irq_spim0);
+    ASSERT_NE(rtc,  nullptr);
+    ASSERT_NE(spim, nullptr);
+
+    // The SPIM ISR preempts the RTC ISR. The RTC duration excludes the SPIM
+    // ISR and includes the exception entry for the preemption.
+    EXPECT_EQ(spim->duration_max, 40u);
+    EXPECT_EQ(rtc->duration_max,  100u + nvic_simulator<table_type>::entry_cycles);
+    EXPECT_EQ(spim->latency_max,  nvic_simulator<table_type>::entry_cycles);
+    EXPECT_EQ(spim->depth_max, 2u);
+    EXPECT_EQ(rtc->depth_max,  1u);
+    EXPECT_EQ(table.depth_max(), 2u);
+}
+
+TEST(IsrProfile, LowerPriorityLatency)
+{
+    table_type table;
+    nvic_simulator<table_type> nvic(table);
+    nvic.run({
+        { irq_spim0, 2u, 100u, 50u, true },
+        { irq_rtc1,  6u, 110u, 30u, true },
+    });
+
+    // The RTC ISR waits for the SPIM ISR to complete.
+    profile::cycles_t const spim_exit = 100u + nvic_simulator<table_type>::entry_cycles + 50u;
+    profile::cycles_t const rtc_entry = spim_exit + nvic_simulator<table_type>::entry_cycles;
+
+    isr_profile_stats_t const* const rtc = table.stats(irq_rtc1);
+    ASSERT_NE(rtc, nullptr);
+    EXPECT_EQ(rtc->latency_max, rtc_entry - 110u);
+    EXPECT_EQ(rtc->duration_max, 30u);
+    EXPECT_EQ(rtc->depth_max, 1u);
+    EXPECT_EQ(table.depth_max(), 1u);
+}
+
+TEST(IsrProfile, WorstOffenders)
+{
+    table_type table;
+    nvic_simulator<table_type> nvic(table);
+    nvic.run({
+        { irq_gpiote, 4u, 100u,  10u, false },
+        { irq_spim0,  4u, 200u, 300u, false },
+        { irq_saadc,  4u, 600u, 150u, false },
+        { irq_rtc1,   4u, 800u,  60u, false },
+    });
+
+    uint8_t irqs[3u];
+    ASSERT_EQ(table.worst(irqs, 3u), 3u);
+    EXPECT_EQ(irqs[0], irq_spim0);
+    EXPECT_EQ(irqs[1], irq_saadc);
+    EXPECT_EQ(irqs[2], irq_rtc1);
+
+    uint8_t all[8u];
+    ASSERT_EQ(table.worst(all, 8u), 4u);
+    EXPECT_EQ(all[3], irq_gpiote);
+}
+
+TEST(IsrProfile, SlotOverflowAndReset)
+{
+    isr_profile_table<48u, 2u> table;
+    nvic_simulator<isr_profile_table<48u, 2u>> nvic(table);
+    nvic.run({
+        { irq_gpiote, 4u, 100u, 10u, false },
+        { irq_spim0,  4u, 200u, 10u, false },
+        { irq_saadc,  4u, 300u, 10u, false },
+    });
+
+    EXPECT_NE(table.stats(irq_gpiote), nullptr);
+    EXPECT_NE(table.stats(irq_spim0),  nullptr);
+    EXPECT_EQ(table.stats(irq_saadc),  nullptr);
+    EXPECT_GT(table.overflow_count(), 0u);
+
+    table.reset();
+    EXPECT_EQ(table.overflow_count(), 0u);
+    EXPECT_EQ(table.depth_max(), 0u);
+    ASSERT_NE(table.stats(irq_gpiote), nullptr);
+    EXPECT_EQ(table.stats(irq_gpiote)->count, 0u);
+    EXPECT_EQ(table.stats(irq_gpiote)->irq, irq_gpiote);
+    EXPECT_EQ(table.stats(irq_gpiote)->duration[histogram_type::bin(10u)], 0u);
+}
+
+TEST(IsrProfile, Query)
+{
+    table_type table;
+    nvic_simulator<table_type> nvic(table);
+    nvic.run({
+        { irq_rtc1,  6u, 100u, 100u, true },
+        { irq_spim0, 2u, 150u,  40u, true },
+    });
+
+    isr_log_stream os;
+    logger         isr_logger;
+    isr_logger.set_output_stream(os);
+    isr_logger.set_level(logger::level::info);
+
+    isr_query_stream dump_query("d");
+    table.query(dump_query, isr_logger);
+    EXPECT_NE(os.text.find("isr profile: depth max: 2, overflow: 0"), std::string::npos);
+    EXPECT_NE(os.text.find("irq 17: count:        1, duration max:      112"), std::string::npos);
+    EXPECT_NE(os.text.find("irq  3: count:        1, duration max:       40"), std::string::npos);
+    EXPECT_NE(os.text.find("latency  >=        8:        1"), std::string::npos);
+
+    // The worst is listed first.
+    EXPECT_LT(os.text.find("irq 17:"), os.text.find("irq  3:"));
+
+    os.text.clear();
+    isr_query_stream worst_reset_query("wr");
+    table.query(worst_reset_query, isr_logger);
+    EXPECT_NE(os.text.find("isr worst 0: irq 17:      112"), std::string::npos);
+    EXPECT_NE(os.text.find("isr worst 1: irq  3:       40"), std::string::npos);
+    EXPECT_NE(os.text.find("isr profile: reset"), std::string::npos);
+    EXPECT_EQ(table.stats(irq_rtc1)->count, 0u);
+}
+
+TEST(IsrProfile, ScopeMacro)
+{
+    auto const isr = []() {
+        ISR_PROFILE(irq_saadc);
+        ISR_PROFILE_LATENCY(25u);
+    };
+
+    isr();
+    isr();
+
+    isr_profile_stats_t const* const saadc = isr_profile_instance().stats(irq_saadc);
+    ASSERT_NE(saadc, nullptr);
+    EXPECT_EQ(saadc->count, 2u);
+    EXPECT_EQ(saadc->latency_count, 2u);
+    EXPECT_EQ(saadc->latency_max, 25u);
+    EXPECT_EQ(saadc->depth_max, 1u);
+}
@@ -0,0 +1,282 @@
+/**
+ * @file test_memory_watermark.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "memory_watermark.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+
+namespace
+{
+
+constexpr uint32_t const paint_pattern = 0xA5C35A3Cu;
+
+/// A synthetic stack region; the stack grows down from the end.
+class StackWatermark : public ::testing::Test
+{
+protected:
+    static constexpr std::size_t const stack_words = 256u;
+
+    void SetUp() override
+    {
+        stack_watermark::paint(this->stack.data(), this->stack.data() + this->stack.size(),
+                               paint_pattern);
+    }
+
+    /// Simulate the stack use of a call depth in words.
+    void use(std::size_t words)
+    {
+        for (std::size_t index = stack_words - words; index < stack_words; ++index)
+        {
+            this->stack[index] = static_cast<uint32_t>(index);
+        }
+    }
+
+    std::array<uint32_t, stack_words> stack;
+    stack_watermark watermark{this->stack.data(),
+                              this->stack.data() + this->stack.size(),
+                              paint_pattern};
+};
+
+class watermark_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string text;
+};
+
+bool watermark_is_registered(memory_watermark const& watermark_find)
+{
+    for (memory_watermark const* watermark = memory_watermark::first();
+         watermark; watermark = watermark->next())
+    {
+        if (watermark == &watermark_find) { return true; }
+    }
+    return false;
+}
+
+memory_report_t::pool_type const* find_pool(memory_report_t const& report, char const* name)
+{
+    for (memory_report_t::pool_type const* pool = report.pools;
+         pool < report.pools + report.pool_count; ++pool)
+    {
+        if (std::string(pool->name) == name) { return pool; }
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+TEST_F(StackWatermark, Unused)
+{
+    EXPECT_EQ(this->watermark.size(), stack_words * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.scan(), 0u);
+    EXPECT_EQ(this->watermark.free_min(), stack_words * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.scan_exact(), 0u);
+}
+
+TEST_F(StackWatermark, ScanFindsDeepestUse)
+{
+    for (std::size_t words : { 1u, 2u, 17u, 64u, 100u, 255u })
+    {
+        this->use(words);
+        EXPECT_EQ(this->watermark.scan(), words * sizeof(uint32_t));
+        EXPECT_EQ(this->watermark.free_min(), (stack_words - words) * sizeof(uint32_t));
+        EXPECT_EQ(this->watermark.mark(), this->stack.data() + stack_words - words);
+    }
+}
+
+TEST_F(StackWatermark, HighWaterOnlyMovesDown)
+{
+    this->use(80u);
+    EXPECT_EQ(this->watermark.scan(), 80u * sizeof(uint32_t));
+
+    // Shallower use after a deep call does not lower the high water mark.
+    SetUp();
+    this->use(10u);
+    EXPECT_EQ(this->watermark.scan(), 80u * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.scan_exact(), 80u * sizeof(uint32_t));
+}
+
+TEST_F(StackWatermark, Overflow)
+{
+    this->use(stack_words);
+    EXPECT_EQ(this->watermark.scan(), stack_words * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.free_min(), 0u);
+
+    // At the limit the scan reads nothing.
+    EXPECT_EQ(this->watermark.scan(), stack_words * sizeof(uint32_t));
+}
+
+TEST_F(StackWatermark, UnwrittenHole)
+{
+    // A deep frame with an unwritten local buffer leaves a painted hole.
+    this->use(40u);
+    std::size_t const deepest = stack_words - 120u;
+    for (std::size_t index = deepest; index < deepest + 8u; ++index)
+    {
+        this->stack[index] = 0u;
+    }
+
+    // The binary search may stop at the hole; the linear scan does not.
+    std::size_t const used_search = this->watermark.scan();
+    EXPECT_GE(used_search, 40u * sizeof(uint32_t));
+    EXPECT_LE(used_search, 120u * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.scan_exact(), 120u * sizeof(uint32_t));
+}
+
+TEST_F(StackWatermark, Repaint)
+{
+    this->use(100u);
+    EXPECT_EQ(this->watermark.scan(), 100u * sizeof(uint32_t));
+
+    // Repaint below the current depth of 20 words.
+    uint32_t* const current = this->stack.data() + stack_words - 20u;
+    this->watermark.repaint(this->stack.data(), current);
+    EXPECT_EQ(this->watermark.used_max(), 20u * sizeof(uint32_t));
+    EXPECT_EQ(this->watermark.scan(), 20u * sizeof(uint32_t));
+
+    this->use(30u);
+    EXPECT_EQ(this->watermark.scan(), 30u * sizeof(uint32_t));
+}
+
+TEST(MemoryWatermark, Levels)
+{
+    memory_watermark watermark("ring", 64u);
+    EXPECT_EQ(watermark.level_min(), 0u);
+    EXPECT_EQ(watermark.level_max(), 0u);
+    EXPECT_FALSE(watermark_is_registered(watermark));
+
+    watermark.record(10u);
+    watermark.record(40u);
+    watermark.record(25u);
+
+    EXPECT_TRUE(watermark_is_registered(watermark));
+    EXPECT_STREQ(watermark.name(), "ring");
+    EXPECT_EQ(watermark.capacity(), 64u);
+    EXPECT_EQ(watermark.level(), 25u);
+    EXPECT_EQ(watermark.level_min(), 10u);
+    EXPECT_EQ(watermark.level_max(), 40u);
+
+    watermark.reset();
+    EXPECT_EQ(watermark.level_min(), 25u);
+    EXPECT_EQ(watermark.level_max(), 25u);
+}
+
+TEST(MemoryWatermark, UnregisterOnDestruction)
+{
+    memory_watermark outer("outer");
+    outer.record(1u);
+    {
+        memory_watermark inner_1("inner_1");
+        memory_watermark inner_2("inner_2");
+        inner_1.record(1u);
+        inner_2.record(1u);
+        EXPECT_TRUE(watermark_is_registered(inner_1));
+        EXPECT_TRUE(watermark_is_registered(inner_2));
+    }
+
+    EXPECT_TRUE(watermark_is_registered(outer));
+    std::size_t count = 0u;
+    for (memory_watermark const* watermark = memory_watermark::first();
+         watermark; watermark = watermark->next())
+    {
+        EXPECT_STRNE(watermark->name(), "inner_1");
+        EXPECT_STRNE(watermark->name(), "inner_2");
+        count += 1u;
+    }
+    EXPECT_GE(count, 1u);
+}
+
+TEST(MemoryWatermark, Report)
+{
+    memory_watermark free_list("free_list", 16u);
+    memory_watermark ring("ring", 128u);
+    free_list.record(16u);
+    free_list.record(3u);
+    free_list.record(9u);
+    ring.record(100u);
+    ring.record(0u);
+
+    memory_report_t report = {};
+    report.stack.size       = 2048u;
+    report.stack.used_max   = 612u;
+    report.stack.free_min   = 1436u;
+    report.stack.guard_hits = 0u;
+    memory_watermark_collect(report);
+
+    memory_report_t::pool_type const* const pool = find_pool(report, "free_list");
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->capacity,  16u);
+    EXPECT_EQ(pool->level,     9u);
+    EXPECT_EQ(pool->level_min, 3u);
+    EXPECT_EQ(pool->level_max, 16u);
+    EXPECT_NE(find_pool(report, "ring"), nullptr);
+    EXPECT_EQ(report.pool_overflow, 0u);
+
+    watermark_stream os;
+    logger           report_logger;
+    report_logger.set_output_stream(os);
+    report_logger.set_level(logger::level::info);
+    memory_report_write(report, report_logger);
+
+    EXPECT_NE(os.text.find("stack: size:  2048, used max:   612, free min:  1436, guard hits: 0"),
+              std::string::npos);
+    EXPECT_NE(os.text.find("pool: free_list        capacity:    16, level:     9, min:     3, max:    16"),
+              std::string::npos);
+    EXPECT_NE(os.text.find("pool: ring             capacity:   128, level:     0, min:     0, max:   100"),
+              std::string::npos);
+}
+
+TEST(MemoryWatermark, ReportOverflow)
+{
+    std::array<char const*, memory_report_pool_max + 2u> const names = {
+        "p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10", "p11", "p12", "p13"
+    };
+
+    std::size_t registered = 0u;
+    for (memory_watermark const* watermark = memory_watermark::first();
+         watermark; watermark = watermark->next())
+    {
+        registered += 1u;
+    }
+
+    // Construct in place; memory_watermark is neither copyable nor movable.
+    union pool_storage
+    {
+        pool_storage() {}
+        ~pool_storage() {}
+        memory_watermark watermark;
+    };
+    std::array<pool_storage, names.size()> pools;
+    for (std::size_t index = 0u; index < names.size(); ++index)
+    {
+        new (&pools[index].watermark) memory_watermark(names[index]);
+        pools[index].watermark.record(index);
+    }
+
+    memory_report_t report = {};
+    memory_watermark_collect(report);
+    EXPECT_EQ(report.pool_count, memory_report_pool_max);
+    EXPECT_EQ(report.pool_overflow, registered + names.size() - memory_report_pool_max);
+
+    for (pool_storage& pool : pools) { pool.watermark.~memory_watermark(); }
+}
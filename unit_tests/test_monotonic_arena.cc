@@ -0,0 +1,117 @@
+/**
+ * @file test_monotonic_arena.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "monotonic_arena.h"
+#include "resource_allocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+TEST(MonotonicArena, Allocate)
+{
+    alignas(8) uint8_t storage[64u];
+    monotonic_arena arena(storage, sizeof(storage));
+
+    EXPECT_EQ(arena.allocate(3u, 1u), storage);
+    EXPECT_EQ(arena.allocate(4u, 4u), storage + 4u);
+    EXPECT_EQ(arena.allocate(8u, 8u), storage + 8u);
+    EXPECT_EQ(arena.allocate(1u, 1u), storage + 16u);
+    EXPECT_EQ(arena.allocate(2u, 2u), storage + 18u);
+    EXPECT_EQ(arena.size(), 20u);
+    EXPECT_EQ(arena.padding(), 1u + 1u);
+    EXPECT_TRUE(arena.owns(storage + 19u));
+    EXPECT_FALSE(arena.owns(storage + 20u));
+
+    EXPECT_EQ(arena.allocate(45u, 1u), nullptr);
+    EXPECT_EQ(arena.failure_count(), 1u);
+    EXPECT_EQ(arena.allocate(44u, 1u), storage + 20u);
+    EXPECT_EQ(arena.available(), 0u);
+
+    arena.reset();
+    EXPECT_EQ(arena.size(), 0u);
+    EXPECT_EQ(arena.padding(), 0u);
+    EXPECT_EQ(arena.high_water(), 64u);
+    EXPECT_EQ(arena.allocate(1u, 1u), storage);
+
+    arena.reset_statistics();
+    EXPECT_EQ(arena.high_water(), 1u);
+    EXPECT_EQ(arena.failure_count(), 0u);
+}
+
+TEST(MonotonicArena, StdVector)
+{
+    using allocator = resource_allocator<uint32_t, monotonic_arena>;
+
+    alignas(std::max_align_t) uint8_t storage[256u];
+    monotonic_arena arena(storage, sizeof(storage));
+
+    std::vector<uint32_t, allocator> vector{allocator(arena)};
+    vector.reserve(16u);
+    for (uint32_t value = 0u; value < 16u; ++value)
+    {
+        vector.push_back(value);
+    }
+    EXPECT_EQ(arena.size(), 64u);
+
+    // Growth reallocates; the old storage is not reclaimed until reset().
+    vector.push_back(16u);
+    EXPECT_EQ(arena.size(), 64u + 128u);
+    EXPECT_THROW(vector.resize(64u), std::bad_alloc);
+}
+
+TEST(MonotonicArena, Stress)
+{
+    constexpr std::size_t const thread_count = 4u;
+    constexpr std::size_t const alloc_count  = 1000u;
+    constexpr std::size_t const alloc_size   = 12u;
+
+    std::vector<uint8_t> storage(thread_count * alloc_count * 16u);
+    monotonic_arena arena(storage.data(), storage.size());
+
+    std::vector<std::vector<uint8_t*>> allocations(thread_count);
+    std::vector<std::thread> threads;
+    for (std::size_t thread_id = 0u; thread_id < thread_count; ++thread_id)
+    {
+        threads.emplace_back([&arena, &allocations, thread_id]()
+        {
+            for (std::size_t iter = 0u; iter < alloc_count; ++iter)
+            {
+                uint8_t* const data = static_cast<uint8_t*>(arena.allocate(alloc_size, 4u));
+                allocations[thread_id].push_back(data);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Each allocation is distinct, aligned and does not overlap another.
+    std::vector<uint8_t*> all;
+    for (std::vector<uint8_t*> const& thread_allocations : allocations)
+    {
+        all.insert(all.end(), thread_allocations.begin(), thread_allocations.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    ASSERT_EQ(all.size(), thread_count * alloc_count);
+    EXPECT_NE(all.front(), nullptr);
+    for (std::size_t index = 0u; index < all.size(); ++index)
+    {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(all[index]) % 4u, 0u);
+        if (index > 0u)
+        {
+            EXPECT_GE(all[index] - all[index - 1u], static_cast<std::ptrdiff_t>(alloc_size));
+        }
+    }
+
+    EXPECT_EQ(arena.size(), arena.high_water());
+    EXPECT_EQ(arena.size(), all.size() * alloc_size + arena.padding());
+}
@@ -6,10 +6,14 @@
 #include "gtest/gtest.h"
 #include "observer.h"
 #include "observable.h"
+#include "priority_observable.h"
+#include "observer_array.h"
 
 #include <cstddef>
 #include <cassert>
 #include <iostream>
+#include <iterator>
+#include <vector>
 
 static constexpr bool const debug_print = false;
 
@@ -115,3 +119,260 @@ TEST(Observer, AttachNotifyDetach)
     ASSERT_EQ(test_observable.get_observer_count() , 0u);
     ASSERT_FALSE(test_observer_4.is_attached());
 }
+
+/**
+ * @class ordered_observer
+ * Records the order in which it is notified into a shared log and,
+ * optionally, detaches itself when the notification matches detach_on.
+ */
+class ordered_observer: public priority_observer<int>
+{
+public:
+    ordered_observer(int id, std::vector<int>& log, int detach_on = -1):
+        id_(id), log_(log), detach_on_(detach_on), batch_count_(0u) {}
+
+    void notify(int const &notification) override
+    {
+        this->log_.push_back(this->id_);
+        if (notification == this->detach_on_)
+        {
+            this->observable_->detach(*this);
+        }
+    }
+
+    void notify_batch(int const *notifications, std::size_t count) override
+    {
+        this->batch_count_ += 1u;
+        priority_observer<int>::notify_batch(notifications, count);
+    }
+
+    void set_observable(priority_observable<int>& observable) {
+        this->observable_ = &observable;
+    }
+
+    std::size_t batch_count() const { return this->batch_count_; }
+
+private:
+    int                         id_;
+    std::vector<int>&           log_;
+    int                         detach_on_;
+    std::size_t                 batch_count_;
+    priority_observable<int>*   observable_ = nullptr;
+};
+
+TEST(PriorityObservable, StableOrder)
+{
+    std::vector<int> log;
+    priority_observable<int> observable;
+    ordered_observer observer_1(1, log);
+    ordered_observer observer_2(2, log);
+    ordered_observer observer_3(3, log);
+    ordered_observer observer_4(4, log);
+    ordered_observer observer_5(5, log);
+
+    observable.attach(observer_1, 10);
+    observable.attach(observer_2);
+    observable.attach(observer_3, 10);
+    observable.attach(observer_4, -5);
+    observable.attach(observer_5);
+
+    EXPECT_EQ(observable.get_observer_count(), 5u);
+    EXPECT_TRUE(observer_3.is_attached());
+    EXPECT_EQ(observer_4.priority(), -5);
+
+    observable.notify_all(0);
+    EXPECT_EQ(log, (std::vector<int>{4, 2, 5, 1, 3}));
+
+    observable.detach(observer_2);
+    EXPECT_FALSE(observer_2.is_attached());
+    EXPECT_EQ(observable.get_observer_count(), 4u);
+
+    // Re-attaching at the same priority places the observer last in its tier.
+    observable.attach(observer_2);
+    log.clear();
+    observable.notify_all(0);
+    EXPECT_EQ(log, (std::vector<int>{4, 5, 2, 1, 3}));
+
+    observable.detach(observer_1);
+    observable.detach(observer_2);
+    observable.detach(observer_3);
+    observable.detach(observer_4);
+    observable.detach(observer_5);
+    EXPECT_EQ(observable.get_observer_count(), 0u);
+}
+
+TEST(PriorityObservable, DetachWhileNotifying)
+{
+    std::vector<int> log;
+    priority_observable<int> observable;
+    ordered_observer observer_1(1, log, 1);
+    ordered_observer observer_2(2, log, 1);
+    ordered_observer observer_3(3, log);
+
+    observer_1.set_observable(observable);
+    observer_2.set_observable(observable);
+
+    observable.attach(observer_3, 1);
+    observable.attach(observer_2);
+    observable.attach(observer_1);
+
+    observable.notify_all(1);
+    EXPECT_EQ(log, (std::vector<int>{2, 1, 3}));
+    EXPECT_EQ(observable.get_observer_count(), 1u);
+    EXPECT_FALSE(observer_1.is_attached());
+    EXPECT_FALSE(observer_2.is_attached());
+
+    // Observers still attached when the observable is destroyed are released.
+    {
+        priority_observable<int> scoped_observable;
+        scoped_observable.attach(observer_1);
+        EXPECT_TRUE(observer_1.is_attached());
+    }
+    EXPECT_FALSE(observer_1.is_attached());
+
+    observable.detach(observer_3);
+}
+
+TEST(PriorityObservable, NotifyBatch)
+{
+    std::vector<int> log;
+    priority_observable<int> observable;
+    ordered_observer observer_1(1, log);
+    ordered_observer observer_2(2, log);
+
+    observable.attach(observer_2, 2);
+    observable.attach(observer_1, 1);
+
+    int const notifications[] = {10, 11, 12};
+    observable.notify_batch(notifications, std::size(notifications));
+    observable.notify_batch(notifications, 0u);
+
+    EXPECT_EQ(observer_1.batch_count(), 1u);
+    EXPECT_EQ(observer_2.batch_count(), 1u);
+    EXPECT_EQ(log, (std::vector<int>{1, 1, 1, 2, 2, 2}));
+
+    observable.detach(observer_1);
+    observable.detach(observer_2);
+}
+
+/**
+ * @class summing_observer
+ * A final observer class: observer_array calls it without a virtual call.
+ */
+class summing_observer final
+{
+public:
+    using notification_type = int;
+
+    explicit summing_observer(std::vector<int>& log, int id): log_(log), id_(id) {}
+
+    void notify(int const &notification)
+    {
+        this->sum += notification;
+        this->log_.push_back(this->id_);
+        if (this->detach_from)
+        {
+            this->detach_from->detach(this->detach_target ? *this->detach_target : *this);
+            this->detach_from = nullptr;
+        }
+    }
+
+    void notify_batch(int const *notifications, std::size_t count)
+    {
+        this->batch_count += 1u;
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            this->sum += notifications[index];
+        }
+        this->log_.push_back(this->id_);
+    }
+
+    int                                     sum = 0;
+    std::size_t                             batch_count = 0u;
+    observer_array<summing_observer, 4u>*   detach_from = nullptr;
+    summing_observer*                       detach_target = nullptr;
+
+private:
+    std::vector<int>&   log_;
+    int                 id_;
+};
+
+TEST(ObserverArray, StableOrder)
+{
+    std::vector<int> log;
+    observer_array<summing_observer, 4u> observable;
+    summing_observer observer_1(log, 1);
+    summing_observer observer_2(log, 2);
+    summing_observer observer_3(log, 3);
+    summing_observer observer_4(log, 4);
+
+    observable.attach(observer_1, 3);
+    observable.attach(observer_2, 1);
+    observable.attach(observer_3, 3);
+    observable.attach(observer_4, 1);
+    EXPECT_EQ(observable.get_observer_count(), 4u);
+    EXPECT_TRUE(observable.is_attached(observer_3));
+
+    observable.notify_all(5);
+    EXPECT_EQ(log, (std::vector<int>{2, 4, 1, 3}));
+    EXPECT_EQ(observer_1.sum, 5);
+
+    observable.detach(observer_2);
+    EXPECT_FALSE(observable.is_attached(observer_2));
+    log.clear();
+    observable.notify_all(1);
+    EXPECT_EQ(log, (std::vector<int>{4, 1, 3}));
+    EXPECT_EQ(observer_2.sum, 5);
+}
+
+TEST(ObserverArray, DetachWhileNotifying)
+{
+    std::vector<int> log;
+    observer_array<summing_observer, 4u> observable;
+    summing_observer observer_1(log, 1);
+    summing_observer observer_2(log, 2);
+    summing_observer observer_3(log, 3);
+
+    observable.attach(observer_1);
+    observable.attach(observer_2);
+    observable.attach(observer_3);
+
+    // observer_1 detaches observer_3 which has not yet been notified;
+    // observer_2 detaches itself.
+    observer_1.detach_from   = &observable;
+    observer_1.detach_target = &observer_3;
+    observer_2.detach_from   = &observable;
+    observable.notify_all(1);
+    EXPECT_EQ(log, (std::vector<int>{1, 2}));
+    EXPECT_EQ(observable.get_observer_count(), 1u);
+    EXPECT_FALSE(observable.is_attached(observer_3));
+
+    log.clear();
+    observable.notify_all(1);
+    EXPECT_EQ(log, (std::vector<int>{1}));
+
+    // The compacted array accepts new observers in priority order.
+    observable.attach(observer_3, -1);
+    observable.attach(observer_2);
+    log.clear();
+    observable.notify_all(1);
+    EXPECT_EQ(log, (std::vector<int>{3, 1, 2}));
+}
+
+TEST(ObserverArray, NotifyBatch)
+{
+    std::vector<int> log;
+    observer_array<summing_observer, 4u> observable;
+    summing_observer observer_1(log, 1);
+    summing_observer observer_2(log, 2);
+
+    observable.attach(observer_2, 1);
+    observable.attach(observer_1, 0);
+
+    int const notifications[] = {1, 2, 3, 4};
+    observable.notify_batch(notifications, std::size(notifications));
+
+    EXPECT_EQ(log, (std::vector<int>{1, 2}));
+    EXPECT_EQ(observer_1.batch_count, 1u);
+    EXPECT_EQ(observer_2.sum, 10);
+}
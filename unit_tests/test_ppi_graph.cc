@@ -0,0 +1,365 @@
+/**
+ * @file test_ppi_graph.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Test the PPI graph builder against a simulation of the PPI registers.
+ */
+
+#include "gtest/gtest.h"
+#include "ppi_graph.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+
+/**
+ * @class ppi_registers_sim
+ * The NRF_PPI_Type registers. Writes to the TASKS_CHG[], CHENSET and CHENCLR
+ * registers act on CHEN as the PPI does. Task and event registers are
+ * modelled as uint32_t; signal() increments the tasks bound to the event.
+ */
+class ppi_registers_sim
+{
+public:
+    struct channel_enable_register
+    {
+        uint32_t*   chen;
+        bool        set;
+
+        channel_enable_register& operator=(uint32_t channel_mask)
+        {
+            *this->chen = this->set ? (*this->chen | channel_mask) : (*this->chen & ~channel_mask);
+            return *this;
+        }
+    };
+
+    struct group_task_register
+    {
+        ppi_registers_sim*  ppi;
+        std::size_t         group;
+        bool                enable;
+
+        group_task_register& operator=(uint32_t value)
+        {
+            if (value)
+            {
+                uint32_t const channel_mask = this->ppi->CHG[this->group];
+                this->ppi->CHEN = this->enable ? (this->ppi->CHEN | channel_mask)
+                                               : (this->ppi->CHEN & ~channel_mask);
+                this->ppi->group_task_count += 1u;
+            }
+            return *this;
+        }
+    };
+
+    struct tasks_chg_type { group_task_register EN; group_task_register DIS; };
+    struct ch_type        { uintptr_t EEP; uintptr_t TEP; };
+    struct fork_type      { uintptr_t TEP; };
+
+    tasks_chg_type          TASKS_CHG[6u];
+    uint32_t                CHEN;
+    channel_enable_register CHENSET;
+    channel_enable_register CHENCLR;
+    ch_type                 CH[20u];
+    uint32_t                CHG[6u];
+    fork_type               FORK[32u];
+
+    std::size_t             group_task_count;
+
+    ppi_registers_sim(ppi_registers_sim const&)             = delete;
+    ppi_registers_sim& operator=(ppi_registers_sim const&)  = delete;
+
+    ppi_registers_sim()
+        : CHEN(0u), CHENSET{&this->CHEN, true}, CHENCLR{&this->CHEN, false},
+          CH{}, CHG{}, FORK{}, group_task_count(0u)
+    {
+        for (std::size_t group = 0u; group < std::size(this->TASKS_CHG); ++group)
+        {
+            this->TASKS_CHG[group].EN  = group_task_register{this, group, true};
+            this->TASKS_CHG[group].DIS = group_task_register{this, group, false};
+        }
+    }
+
+    /// The event is signalled by a peripheral; enabled channels trigger tasks.
+    void signal(uint32_t volatile* event)
+    {
+        uintptr_t const event_address = reinterpret_cast<uintptr_t>(event);
+        for (std::size_t channel = 0u; channel < std::size(this->CH); ++channel)
+        {
+            if ((this->CHEN & (1u << channel)) && (this->CH[channel].EEP == event_address))
+            {
+                trigger(this->CH[channel].TEP);
+                trigger(this->FORK[channel].TEP);
+            }
+        }
+    }
+
+    bool registers_equal(ppi_registers_sim const& other) const
+    {
+        return (this->CHEN == other.CHEN) &&
+               (std::memcmp(this->CH,   other.CH,   sizeof(this->CH))   == 0) &&
+               (std::memcmp(this->CHG,  other.CHG,  sizeof(this->CHG))  == 0) &&
+               (std::memcmp(this->FORK, other.FORK, sizeof(this->FORK)) == 0);
+    }
+
+    void copy_registers(ppi_registers_sim const& other)
+    {
+        this->CHEN = other.CHEN;
+        std::memcpy(this->CH,   other.CH,   sizeof(this->CH));
+        std::memcpy(this->CHG,  other.CHG,  sizeof(this->CHG));
+        std::memcpy(this->FORK, other.FORK, sizeof(this->FORK));
+    }
+
+private:
+    static void trigger(uintptr_t task_address)
+    {
+        if (task_address)
+        {
+            *reinterpret_cast<uint32_t volatile*>(task_address) += 1u;
+        }
+    }
+};
+
+/// Event and task registers of the peripherals being connected.
+struct peripheral_registers
+{
+    uint32_t volatile events[8u];
+    uint32_t volatile tasks[8u];
+};
+
+class string_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string text;
+};
+
+class PpiGraph : public ::testing::Test
+{
+protected:
+    ppi_registers_sim                   ppi;
+    ppi_graph_builder<ppi_registers_sim> builder{this->ppi};
+    peripheral_registers                regs = {};
+};
+
+} // anonymous namespace
+
+TEST_F(PpiGraph, CreateEnableSignal)
+{
+    // A channel allocated elsewhere by ppi_channel_allocate().
+    this->ppi.CH[0].EEP = reinterpret_cast<uintptr_t>(&this->regs.events[7]);
+    this->ppi.CH[0].TEP = reinterpret_cast<uintptr_t>(&this->regs.tasks[7]);
+
+    ppi_edge_t const edges[] = {
+        { &this->regs.events[0], &this->regs.tasks[0], nullptr               },
+        { &this->regs.events[1], &this->regs.tasks[1], &this->regs.tasks[2]  },
+        { &this->regs.events[2], &this->regs.tasks[3], nullptr               },
+    };
+
+    ppi_graph_t graph;
+    ASSERT_EQ(this->builder.create(graph, edges, std::size(edges)), ppi_graph_success);
+    EXPECT_EQ(graph.channel_mask, 0x0Eu);
+    EXPECT_EQ(graph.group, 0u);
+    EXPECT_EQ(this->ppi.CHG[0], graph.channel_mask);
+    EXPECT_EQ(this->ppi.FORK[2].TEP, reinterpret_cast<uintptr_t>(&this->regs.tasks[2]));
+    EXPECT_FALSE(this->builder.is_enabled(graph));
+
+    // Events are not connected until the graph is enabled.
+    this->ppi.signal(&this->regs.events[0]);
+    EXPECT_EQ(this->regs.tasks[0], 0u);
+
+    // All channels are enabled by a single group task write.
+    this->builder.enable(graph);
+    EXPECT_TRUE(this->builder.is_enabled(graph));
+    EXPECT_EQ(this->ppi.CHEN, graph.channel_mask);
+    EXPECT_EQ(this->ppi.group_task_count, 1u);
+
+    this->ppi.signal(&this->regs.events[0]);
+    this->ppi.signal(&this->regs.events[1]);
+    this->ppi.signal(&this->regs.events[2]);
+    EXPECT_EQ(this->regs.tasks[0], 1u);
+    EXPECT_EQ(this->regs.tasks[1], 1u);
+    EXPECT_EQ(this->regs.tasks[2], 1u);
+    EXPECT_EQ(this->regs.tasks[3], 1u);
+
+    this->builder.disable(graph);
+    EXPECT_EQ(this->ppi.CHEN, 0u);
+    this->ppi.signal(&this->regs.events[0]);
+    EXPECT_EQ(this->regs.tasks[0], 1u);
+}
+
+TEST_F(PpiGraph, SameEventSharesChannelWithFork)
+{
+    ppi_edge_t const edges[] = {
+        { &this->regs.events[0], &this->regs.tasks[0], nullptr },
+        { &this->regs.events[0], &this->regs.tasks[1], nullptr },
+        { &this->regs.events[0], &this->regs.tasks[2], nullptr },
+    };
+
+    ppi_graph_t graph;
+    ASSERT_EQ(this->builder.create(graph, edges, std::size(edges)), ppi_graph_success);
+    EXPECT_EQ(graph.channel_mask, 0x03u);
+    EXPECT_EQ(this->ppi.FORK[0].TEP, reinterpret_cast<uintptr_t>(&this->regs.tasks[1]));
+    EXPECT_EQ(this->ppi.FORK[1].TEP, 0u);
+
+    this->builder.enable(graph);
+    this->ppi.signal(&this->regs.events[0]);
+    EXPECT_EQ(this->regs.tasks[0], 1u);
+    EXPECT_EQ(this->regs.tasks[1], 1u);
+    EXPECT_EQ(this->regs.tasks[2], 1u);
+}
+
+TEST_F(PpiGraph, ConflictLeavesPpiUnchanged)
+{
+    ppi_edge_t const edges[] = {
+        { &this->regs.events[0], &this->regs.tasks[0], nullptr },
+    };
+    ppi_graph_t graph;
+    ASSERT_EQ(this->builder.create(graph, edges, std::size(edges)), ppi_graph_success);
+
+    ppi_registers_sim before;
+    before.copy_registers(this->ppi);
+
+    // The same edge is already connected by another graph.
+    ppi_edge_t const duplicate_allocated[] = {
+        { &this->regs.events[1], &this->regs.tasks[1], nullptr },
+        { &this->regs.events[0], &this->regs.tasks[0], nullptr },
+    };
+    ppi_graph_t graph_2;
+    EXPECT_EQ(this->builder.create(graph_2, duplicate_allocated, std::size(duplicate_allocated)),
+              ppi_graph_conflict);
+    EXPECT_EQ(graph_2.group, ppi_group_invalid);
+    EXPECT_EQ(graph_2.channel_mask, 0u);
+
+    // The same edge twice within a graph; as a fork.
+    ppi_edge_t const duplicate_fork[] = {
+        { &this->regs.events[1], &this->regs.tasks[1], &this->regs.tasks[2] },
+        { &this->regs.events[1], &this->regs.tasks[2], nullptr },
+    };
+    EXPECT_EQ(this->builder.create(graph_2, duplicate_fork, std::size(duplicate_fork)),
+              ppi_graph_conflict);
+
+    ppi_edge_t const invalid[] = {
+        { &this->regs.events[1], nullptr, nullptr },
+    };
+    EXPECT_EQ(this->builder.create(graph_2, invalid, std::size(invalid)),
+              ppi_graph_invalid_edge);
+
+    EXPECT_TRUE(this->ppi.registers_equal(before));
+}
+
+TEST_F(PpiGraph, ChannelAndGroupExhaustion)
+{
+    // Distinct events so that no edges share a channel.
+    uint32_t volatile events[20u];
+    uint32_t volatile tasks[20u];
+    ppi_edge_t edges[20u];
+    for (std::size_t index = 0u; index < std::size(edges); ++index)
+    {
+        edges[index] = { &events[index], &tasks[index], nullptr };
+    }
+
+    // 18 channels leave 2 free: a 3 channel graph fails without allocating.
+    ppi_graph_t graph_18;
+    ASSERT_EQ(this->builder.create(graph_18, edges, 18u), ppi_graph_success);
+    EXPECT_EQ(bit_manip::popcount(graph_18.channel_mask), 18u);
+
+    ppi_registers_sim before;
+    before.copy_registers(this->ppi);
+
+    uint32_t volatile event_3[3u];
+    uint32_t volatile task_3[3u];
+    ppi_edge_t const edges_3[] = {
+        { &event_3[0], &task_3[0], nullptr },
+        { &event_3[1], &task_3[1], nullptr },
+        { &event_3[2], &task_3[2], nullptr },
+    };
+    ppi_graph_t graph;
+    EXPECT_EQ(this->builder.create(graph, edges_3, 3u), ppi_graph_no_channel);
+    EXPECT_TRUE(this->ppi.registers_equal(before));
+
+    // Each of the 2 remaining channels in its own graph uses up the groups.
+    ppi_graph_t graphs[6u];
+    ASSERT_EQ(this->builder.create(graphs[0], &edges_3[0], 1u), ppi_graph_success);
+    ASSERT_EQ(this->builder.create(graphs[1], &edges_3[1], 1u), ppi_graph_success);
+    EXPECT_EQ(this->builder.free_channels(), 0u);
+
+    this->builder.release(graph_18);
+    EXPECT_EQ(bit_manip::popcount(this->builder.free_channels()), 18u);
+    EXPECT_EQ(graph_18.group, ppi_group_invalid);
+
+    for (std::size_t index = 2u; index < std::size(graphs); ++index)
+    {
+        ASSERT_EQ(this->builder.create(graphs[index], &edges[index], 1u), ppi_graph_success);
+    }
+    EXPECT_EQ(this->builder.free_group(), ppi_group_invalid);
+    EXPECT_EQ(this->builder.create(graph, &edges_3[2], 1u), ppi_graph_no_group);
+
+    // Released channels and groups are reused.
+    ppi_group_t const group_released = graphs[3].group;
+    this->builder.release(graphs[3]);
+    EXPECT_EQ(this->builder.create(graph, &edges_3[2], 1u), ppi_graph_success);
+    EXPECT_EQ(graph.group, group_released);
+}
+
+TEST_F(PpiGraph, ReleaseDisablesAndClears)
+{
+    ppi_edge_t const edges[] = {
+        { &this->regs.events[0], &this->regs.tasks[0], &this->regs.tasks[1] },
+        { &this->regs.events[1], &this->regs.tasks[2], nullptr },
+    };
+
+    ppi_graph_t graph;
+    ASSERT_EQ(this->builder.create(graph, edges, std::size(edges)), ppi_graph_success);
+    this->builder.enable(graph);
+    this->builder.release(graph);
+
+    ppi_registers_sim const reset;
+    EXPECT_TRUE(this->ppi.registers_equal(reset));
+    EXPECT_EQ(graph.channel_mask, 0u);
+
+    this->ppi.signal(&this->regs.events[0]);
+    EXPECT_EQ(this->regs.tasks[0], 0u);
+
+    // Releasing a released graph is harmless.
+    this->builder.release(graph);
+}
+
+TEST_F(PpiGraph, Dump)
+{
+    ppi_edge_t const edges[] = {
+        { &this->regs.events[0], &this->regs.tasks[0], &this->regs.tasks[1] },
+        { &this->regs.events[1], &this->regs.tasks[2], nullptr },
+    };
+
+    ppi_graph_t graph;
+    ASSERT_EQ(this->builder.create(graph, edges, std::size(edges)), ppi_graph_success);
+    this->builder.enable(graph);
+
+    string_stream os;
+    logger        graph_logger;
+    graph_logger.set_output_stream(os);
+    graph_logger.set_level(logger::level::debug);
+    this->builder.dump(graph, graph_logger);
+
+    EXPECT_NE(os.text.find("ppi graph: group: 0, channels: 0x00000003, enabled"), std::string::npos);
+    EXPECT_NE(os.text.find("ch  0: event: 0x"), std::string::npos);
+    EXPECT_NE(os.text.find("ch  1: event: 0x"), std::string::npos);
+    EXPECT_EQ(os.text.find("ch  2:"), std::string::npos);
+}
@@ -0,0 +1,242 @@
+/**
+ * @file test_profile.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "profile.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+
+class profile_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->data.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string data;
+};
+
+// Recorded zones are linked into the zone list; they must be static.
+profile::zone_stats zone_aggregate("aggregate");
+profile::zone_stats zone_scoped("scoped");
+profile::zone_stats zone_dump("dump_zone");
+
+bool zone_is_registered(profile::zone_stats const& zone_find)
+{
+    for (profile::zone_stats const* zone = profile::zone_stats::first(); zone; zone = zone->next())
+    {
+        if (zone == &zone_find) { return true; }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+TEST(Log2Histogram, Bins)
+{
+    using histogram_type = log2_histogram<8u>;
+
+    EXPECT_EQ(histogram_type::bin(0u), 0u);
+    EXPECT_EQ(histogram_type::bin(1u), 1u);
+    EXPECT_EQ(histogram_type::bin(2u), 2u);
+    EXPECT_EQ(histogram_type::bin(3u), 2u);
+    EXPECT_EQ(histogram_type::bin(4u), 3u);
+    EXPECT_EQ(histogram_type::bin(127u), 7u);
+
+    // Values wider than the last bin are counted in the last bin.
+    EXPECT_EQ(histogram_type::bin(128u), 7u);
+    EXPECT_EQ(histogram_type::bin(UINT32_MAX), 7u);
+
+    EXPECT_EQ(histogram_type::bin_lower(0u), 0u);
+    EXPECT_EQ(histogram_type::bin_lower(1u), 1u);
+    EXPECT_EQ(histogram_type::bin_lower(2u), 2u);
+    EXPECT_EQ(histogram_type::bin_lower(7u), 64u);
+
+    histogram_type histogram;
+    histogram.record(5u);
+    histogram.record(6u);
+    histogram.record(1000u);
+    EXPECT_EQ(histogram[3u], 2u);
+    EXPECT_EQ(histogram[7u], 1u);
+
+    histogram.reset();
+    for (std::size_t bin = 0u; bin < histogram_type::bin_count; ++bin)
+    {
+        EXPECT_EQ(histogram[bin], 0u);
+    }
+}
+
+TEST(Profile, ZoneAggregation)
+{
+    zone_aggregate.reset();
+
+    // Before recording min and mean are zero, not the min sentinel.
+    EXPECT_EQ(zone_aggregate.count(), 0u);
+    EXPECT_EQ(zone_aggregate.min(), 0u);
+    EXPECT_EQ(zone_aggregate.max(), 0u);
+    EXPECT_EQ(zone_aggregate.mean(), 0u);
+
+    zone_aggregate.record(20u);
+    zone_aggregate.record(10u);
+    zone_aggregate.record(31u);
+
+    EXPECT_TRUE(zone_is_registered(zone_aggregate));
+    EXPECT_STREQ(zone_aggregate.name(), "aggregate");
+    EXPECT_EQ(zone_aggregate.count(), 3u);
+    EXPECT_EQ(zone_aggregate.min(),  10u);
+    EXPECT_EQ(zone_aggregate.max(),  31u);
+    EXPECT_EQ(zone_aggregate.total(), 61u);
+    EXPECT_EQ(zone_aggregate.mean(), 20u);          // Truncated.
+
+    using histogram_type = profile::zone_stats::histogram_type;
+    EXPECT_EQ(zone_aggregate.histogram()[histogram_type::bin(10u)], 1u);
+    EXPECT_EQ(zone_aggregate.histogram()[histogram_type::bin(20u)], 2u);   // [16:31]
+
+    zone_aggregate.reset();
+    EXPECT_EQ(zone_aggregate.count(), 0u);
+    EXPECT_EQ(zone_aggregate.total(), 0u);
+    EXPECT_EQ(zone_aggregate.histogram()[histogram_type::bin(20u)], 0u);
+
+    // After reset the min is restored from the first record.
+    zone_aggregate.record(40u);
+    EXPECT_EQ(zone_aggregate.min(), 40u);
+    EXPECT_TRUE(zone_is_registered(zone_aggregate));
+}
+
+TEST(Profile, TotalWiderThanCycles)
+{
+    zone_aggregate.reset();
+
+    profile::cycles_t const cycles_max = std::numeric_limits<profile::cycles_t>::max();
+    zone_aggregate.record(cycles_max);
+    zone_aggregate.record(cycles_max);
+    zone_aggregate.record(cycles_max);
+
+    EXPECT_EQ(zone_aggregate.total(), 3u * static_cast<uint64_t>(cycles_max));
+    EXPECT_EQ(zone_aggregate.mean(), cycles_max);
+    EXPECT_EQ(zone_aggregate.histogram()[profile::zone_stats::histogram_type::bin_count - 1u], 3u);
+}
+
+TEST(Profile, WrapSafeDuration)
+{
+    // The counter wrapped between the zone entry and exit.
+    profile::cycles_t const start = 0xFFFFFF00u;
+    profile::cycles_t const end   = 0x00000100u;
+    EXPECT_EQ(static_cast<profile::cycles_t>(end - start), 0x200u);
+}
+
+TEST(Profile, ZoneScope)
+{
+    zone_scoped.reset();
+
+    for (int iteration = 0; iteration < 4; ++iteration)
+    {
+        profile::zone_scope const scope(zone_scoped);
+        profile::cycles_t const start = profile::cycle_count();
+        while (profile::cycle_count() - start < 1000u) {}
+    }
+
+    EXPECT_EQ(zone_scoped.count(), 4u);
+    EXPECT_GE(zone_scoped.min(), 1000u);
+    EXPECT_GE(zone_scoped.mean(), zone_scoped.min());
+    EXPECT_LE(zone_scoped.mean(), zone_scoped.max());
+}
+
+TEST(Profile, ResetAll)
+{
+    zone_aggregate.record(10u);
+    zone_scoped.record(10u);
+
+    profile::reset();
+    EXPECT_EQ(zone_aggregate.count(), 0u);
+    EXPECT_EQ(zone_scoped.count(), 0u);
+}
+
+TEST(Profile, Dump)
+{
+    zone_dump.reset();
+    zone_dump.record(3u);
+    zone_dump.record(5u);
+
+    profile_stream os;
+    logger         profile_logger;
+    profile_logger.set_output_stream(os);
+    profile_logger.set_level(logger::level::info);
+    profile::dump(profile_logger);
+
+    std::size_t const zone_line = os.data.find("dump_zone");
+    ASSERT_NE(zone_line, std::string::npos);
+    std::string const line = os.data.substr(zone_line, os.data.find('\n', zone_line) - zone_line);
+    EXPECT_NE(line.find("count:        2"), std::string::npos);
+    EXPECT_NE(line.find("min:        3"), std::string::npos);
+    EXPECT_NE(line.find("max:        5"), std::string::npos);
+    EXPECT_NE(line.find("mean:        4"), std::string::npos);
+
+    // The histogram lines follow the zone line: 3 in [2:3], 5 in [4:7].
+    std::size_t const bin_2 = os.data.find(">=        2:        1", zone_line);
+    std::size_t const bin_4 = os.data.find(">=        4:        1", zone_line);
+    EXPECT_NE(bin_2, std::string::npos);
+    EXPECT_NE(bin_4, std::string::npos);
+}
+
+TEST(Profile, WriteBinary)
+{
+    zone_dump.reset();
+    zone_dump.record(100u);
+
+    profile_stream os;
+    std::size_t const length = profile::write_binary(os);
+    ASSERT_EQ(length, os.data.size());
+    ASSERT_GE(length, sizeof(profile::binary_header));
+
+    profile::binary_header header;
+    std::memcpy(&header, os.data.data(), sizeof(header));
+
+    // Packed fields are copied; they cannot be bound to EXPECT_EQ references.
+    uint32_t const magic          = header.magic;
+    uint16_t const histogram_bins = header.histogram_bins;
+    uint16_t const zone_count     = header.zone_count;
+    EXPECT_EQ(magic, profile::binary_magic);
+    EXPECT_EQ(histogram_bins, profile::zone_stats::histogram_type::bin_count);
+    ASSERT_EQ(length, sizeof(header) + zone_count * sizeof(profile::binary_zone));
+
+    bool found = false;
+    for (std::size_t index = 0u; index < zone_count; ++index)
+    {
+        profile::binary_zone record;
+        std::memcpy(&record,
+                    os.data.data() + sizeof(header) + index * sizeof(record),
+                    sizeof(record));
+        if (std::strncmp(record.name, "dump_zone", sizeof(record.name)) == 0)
+        {
+            uint32_t const count = record.count;
+            uint32_t const min   = record.min;
+            uint32_t const max   = record.max;
+            uint32_t const mean  = record.mean;
+            uint32_t const bin   = record.histogram[profile::zone_stats::histogram_type::bin(100u)];
+
+            found = true;
+            EXPECT_EQ(count, 1u);
+            EXPECT_EQ(min,   100u);
+            EXPECT_EQ(max,   100u);
+            EXPECT_EQ(mean,  100u);
+            EXPECT_EQ(bin,   1u);
+        }
+    }
+    EXPECT_TRUE(found);
+}
@@ -0,0 +1,472 @@
+/**
+ * @file test_rtt.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * The target RTT streams in this process are read and written by the
+ * rtt_host_emulator through process memory access, as a J-Link would.
+ */
+
+#include "gtest/gtest.h"
+#include "rtt_host_emulator.h"
+#include "rtt_input_stream.h"
+#include "rtt_output_stream.h"
+#include "segger_rtt.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+class RttStream: public ::testing::Test
+{
+protected:
+    void SetUp()    override { segger_rtt_disable(); }
+    void TearDown() override { segger_rtt_disable(); }
+};
+
+/// A sequence of bytes in which each byte is identified by its position.
+static std::vector<uint8_t> byte_sequence(size_t length, uint8_t first = 0u)
+{
+    std::vector<uint8_t> sequence(length);
+    for (size_t index = 0u; index < length; ++index)
+    {
+        sequence[index] = static_cast<uint8_t>(first + index);
+    }
+    return sequence;
+}
+
+TEST_F(RttStream, MultiChannel)
+{
+    static char terminal_buffer[256u];
+    static char samples_buffer[128u];
+    static char command_buffer[32u];
+
+    rtt_output_stream terminal(terminal_buffer, sizeof(terminal_buffer));
+    rtt_output_stream samples(samples_buffer, sizeof(samples_buffer), 1u,
+                              rtt_output_stream::overflow_policy::drop_newest,
+                              "Samples");
+    rtt_input_stream  commands(command_buffer, sizeof(command_buffer));
+
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+    EXPECT_EQ(host.control_block_address(),
+              reinterpret_cast<uintptr_t>(segger_rtt_control_block()));
+    EXPECT_EQ(host.up_count(), 4u);
+    EXPECT_EQ(host.down_count(), 4u);
+    EXPECT_EQ(host.up_name(0u), "Terminal");
+    EXPECT_EQ(host.up_name(1u), "Samples");
+    EXPECT_EQ(host.up_name(2u), "");
+    EXPECT_EQ(host.down_name(0u), "Terminal");
+
+    char const text[] = "hello host\n";
+    EXPECT_EQ(terminal.write(text, std::strlen(text)), std::strlen(text));
+
+    uint16_t const sample_values[] = {0x1234u, 0xabcdu, 0x0042u};
+    EXPECT_EQ(samples.write(sample_values, sizeof(sample_values)), sizeof(sample_values));
+
+    EXPECT_EQ(host.up_pending(0u), std::strlen(text));
+    EXPECT_EQ(host.up_pending(1u), sizeof(sample_values));
+    EXPECT_EQ(terminal.write_pending(), std::strlen(text));
+
+    char text_read[32u] = {};
+    EXPECT_EQ(host.read(0u, text_read, sizeof(text_read)), std::strlen(text));
+    EXPECT_STREQ(text_read, text);
+    EXPECT_EQ(terminal.write_pending(), 0u);
+
+    uint16_t samples_read[4u] = {};
+    EXPECT_EQ(host.read(1u, samples_read, sizeof(samples_read)), sizeof(sample_values));
+    EXPECT_EQ(0, std::memcmp(samples_read, sample_values, sizeof(sample_values)));
+
+    // Host commands arrive on the down channel.
+    EXPECT_EQ(commands.read_pending(), 0u);
+    char const command[] = "reset stats";
+    EXPECT_EQ(host.write(0u, command, sizeof(command)), sizeof(command));
+    EXPECT_EQ(commands.read_pending(), sizeof(command));
+    EXPECT_EQ(commands.read_avail(), sizeof(command_buffer) - 1u - sizeof(command));
+
+    char command_read[32u] = {};
+    EXPECT_EQ(commands.read(command_read, sizeof(command_read)), sizeof(command));
+    EXPECT_STREQ(command_read, command);
+    EXPECT_EQ(commands.read_pending(), 0u);
+    EXPECT_EQ(commands.read(command_read, sizeof(command_read)), 0u);
+
+    // The down ring holds one byte less than its size.
+    std::vector<uint8_t> const long_command = byte_sequence(64u);
+    EXPECT_EQ(host.write(0u, long_command.data(), long_command.size()),
+              sizeof(command_buffer) - 1u);
+
+    uint8_t long_command_read[64u];
+    EXPECT_EQ(commands.read(long_command_read, sizeof(long_command_read)),
+              sizeof(command_buffer) - 1u);
+    EXPECT_EQ(0, std::memcmp(long_command_read, long_command.data(),
+                             sizeof(command_buffer) - 1u));
+}
+
+TEST_F(RttStream, DropNewest)
+{
+    static char ring[64u];
+    rtt_output_stream stream(ring, sizeof(ring));
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach(reinterpret_cast<uintptr_t>(segger_rtt_control_block())));
+
+    std::vector<uint8_t> const data = byte_sequence(100u);
+    EXPECT_EQ(stream.write(data.data(), data.size()), sizeof(ring) - 1u);
+    EXPECT_EQ(stream.write(data.data(), 1u), 0u);
+    EXPECT_EQ(stream.bytes_written(), sizeof(ring) - 1u);
+    EXPECT_EQ(stream.bytes_dropped(), data.size() - (sizeof(ring) - 1u) + 1u);
+    EXPECT_EQ(stream.overflow_count(), 2u);
+
+    // The oldest data is kept.
+    uint8_t data_read[100u];
+    EXPECT_EQ(host.read(0u, data_read, sizeof(data_read)), sizeof(ring) - 1u);
+    EXPECT_EQ(0, std::memcmp(data_read, data.data(), sizeof(ring) - 1u));
+}
+
+/**
+ * Stream a counting sequence through a small ring while the host drains it
+ * more slowly than it is written. Every byte the host receives must be in
+ * sequence order, with gaps exactly accounting for the dropped bytes.
+ * The target never moves the host's read offset.
+ */
+TEST_F(RttStream, DropNewestLossAccounting)
+{
+    // A capacity, one less than the size, of whole words.
+    static char ring[1025u];
+    rtt_output_stream stream(ring, sizeof(ring), 1u,
+                             rtt_output_stream::overflow_policy::drop_newest);
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+
+    uint32_t sequence = 0u;
+    uint32_t expected = 0u;
+    uint64_t gaps     = 0u;
+    size_t   errors   = 0u;
+
+    for (size_t iter = 0u; iter < 4096u; ++iter)
+    {
+        // Writes of 1 to 31 32-bit words.
+        uint32_t words[32u];
+        size_t const word_count = 1u + (iter * 7u) % 31u;
+        for (size_t index = 0u; index < word_count; ++index)
+        {
+            words[index] = sequence++;
+        }
+        stream.write(words, word_count * sizeof(uint32_t));
+
+        // The host drains 48 bytes per write: on average less than written.
+        // Whole words are read since drops occur in multiples of 4 bytes.
+        uint32_t words_read[12u];
+        size_t const count = host.read(1u, words_read, sizeof(words_read));
+        ASSERT_EQ(count % sizeof(uint32_t), 0u);
+        for (size_t index = 0u; index < count / sizeof(uint32_t); ++index)
+        {
+            if (words_read[index] < expected)
+            {
+                if (++errors <= 10u)
+                {
+                    ADD_FAILURE() << "word " << words_read[index] << " after " << expected;
+                }
+            }
+            gaps     += words_read[index] - expected;
+            expected  = words_read[index] + 1u;
+        }
+    }
+
+    // Drain what remains.
+    uint32_t words_read[256u];
+    size_t const count = host.read(1u, words_read, sizeof(words_read));
+    for (size_t index = 0u; index < count / sizeof(uint32_t); ++index)
+    {
+        gaps     += words_read[index] - expected;
+        expected  = words_read[index] + 1u;
+    }
+
+    EXPECT_EQ(errors, 0u);
+    EXPECT_EQ(expected, sequence);
+    EXPECT_GT(stream.bytes_dropped(), 0u);
+    EXPECT_EQ(gaps * sizeof(uint32_t), stream.bytes_dropped());
+    EXPECT_EQ(host.bytes_read() + stream.bytes_dropped(), uint64_t(sequence) * sizeof(uint32_t));
+}
+
+/// A tick source which lets the host drain the ring as time passes.
+struct draining_host
+{
+    rtt_host_emulator*  host;
+    rtt_channel_t       channel;
+    size_t              bytes_per_tick;
+    uint64_t            ticks;
+    std::vector<uint8_t> received;
+};
+
+static uint64_t draining_host_ticks(void* context)
+{
+    draining_host& drain = *static_cast<draining_host*>(context);
+    if (drain.host && drain.bytes_per_tick)
+    {
+        uint8_t buffer[256u];
+        size_t const count = drain.host->read(drain.channel, buffer,
+                                              std::min(sizeof(buffer), drain.bytes_per_tick));
+        drain.received.insert(drain.received.end(), buffer, buffer + count);
+    }
+    return drain.ticks++;
+}
+
+TEST_F(RttStream, BlockWithTimeout)
+{
+    static char ring[64u];
+    rtt_output_stream stream(ring, sizeof(ring), 3u,
+                             rtt_output_stream::overflow_policy::block);
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+
+    // Writes block only once a host has read the channel.
+    uint8_t const prime = 0xA5u;
+    uint8_t       prime_read = 0u;
+    ASSERT_EQ(stream.write(&prime, sizeof(prime)), sizeof(prime));
+    ASSERT_EQ(host.read(3u, &prime_read, sizeof(prime_read)), sizeof(prime_read));
+
+    draining_host drain = { &host, 3u, 16u, 0u, {} };
+    stream.set_block_timeout(100u, draining_host_ticks, &drain);
+
+    // The host drains quickly enough: nothing is lost.
+    std::vector<uint8_t> const data = byte_sequence(1000u);
+    EXPECT_EQ(stream.write(data.data(), data.size()), data.size());
+    EXPECT_EQ(stream.timeout_count(), 0u);
+    EXPECT_EQ(stream.bytes_dropped(), 0u);
+
+    stream.flush();
+    EXPECT_EQ(stream.timeout_count(), 0u);
+    EXPECT_EQ(stream.write_pending(), 0u);
+    EXPECT_EQ(drain.received, data);
+
+    // The host stops reading: the write times out having filled the ring.
+    drain.bytes_per_tick = 0u;
+    EXPECT_EQ(stream.write(data.data(), data.size()), sizeof(ring) - 1u);
+    EXPECT_EQ(stream.timeout_count(), 1u);
+    EXPECT_EQ(stream.bytes_dropped(), data.size() - (sizeof(ring) - 1u));
+    EXPECT_EQ(stream.overflow_count(), 1u);
+
+    uint64_t const ticks_before_flush = drain.ticks;
+    stream.flush();
+    EXPECT_EQ(stream.timeout_count(), 2u);
+    EXPECT_GE(drain.ticks - ticks_before_flush, 100u);
+
+    // Without a tick source the timeout counts polls.
+    stream.set_block_timeout(10u);
+    stream.flush();
+    EXPECT_EQ(stream.timeout_count(), 3u);
+}
+
+TEST_F(RttStream, BlockWithoutHost)
+{
+    static char ring[64u];
+    rtt_output_stream stream(ring, sizeof(ring), 3u,
+                             rtt_output_stream::overflow_policy::block);
+    segger_rtt_enable();
+
+    // No host has ever read the channel: nothing waits for room.
+    draining_host drain = { nullptr, 3u, 0u, 0u, {} };
+    stream.set_block_timeout(100u, draining_host_ticks, &drain);
+
+    std::vector<uint8_t> const data = byte_sequence(1000u);
+    EXPECT_EQ(stream.write(data.data(), data.size()), sizeof(ring) - 1u);
+    stream.flush();
+    EXPECT_EQ(drain.ticks, 0u);
+    EXPECT_EQ(stream.timeout_count(), 0u);
+    EXPECT_EQ(stream.bytes_dropped(), data.size() - (sizeof(ring) - 1u));
+    EXPECT_EQ(stream.overflow_count(), 1u);
+
+    // Once a host reads, the stream blocks.
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+    uint8_t buffer[8u];
+    ASSERT_EQ(host.read(3u, buffer, sizeof(buffer)), sizeof(buffer));
+
+    stream.flush();
+    EXPECT_EQ(stream.timeout_count(), 1u);
+    EXPECT_GE(drain.ticks, 100u);
+}
+
+TEST_F(RttStream, DisableAndReallocate)
+{
+    static char ring[32u];
+    {
+        rtt_output_stream stream(ring, sizeof(ring));
+        segger_rtt_enable();
+        EXPECT_EQ(stream.write("abc", 3u), 3u);
+    }
+
+    segger_rtt_disable();
+    rtt_host_emulator host(getpid());
+    EXPECT_FALSE(host.attach(reinterpret_cast<uintptr_t>(segger_rtt_control_block())));
+
+    // The channel may be allocated again once disabled.
+    rtt_output_stream stream(ring, sizeof(ring), 0u,
+                             rtt_output_stream::overflow_policy::drop_newest, "Log");
+    segger_rtt_enable();
+    ASSERT_TRUE(host.attach(reinterpret_cast<uintptr_t>(segger_rtt_control_block())));
+    EXPECT_EQ(host.up_name(0u), "Log");
+    EXPECT_EQ(host.up_pending(0u), 0u);
+}
+
+/**
+ * Write every length from 0 to beyond the ring size, from sources at every
+ * word alignment, starting at every ring offset. Compare what the host
+ * reads with a reference model of the ring.
+ */
+TEST_F(RttStream, WriteWrapAround)
+{
+    // An odd ring size so that ring offsets take every word alignment.
+    alignas(4) static char ring[67u];
+    rtt_output_stream stream(ring, sizeof(ring), 1u);
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+
+    std::vector<uint8_t> const data = byte_sequence(sizeof(ring) + 8u, 0x10u);
+    size_t const capacity = sizeof(ring) - 1u;
+    size_t errors = 0u;
+
+    for (size_t start = 0u; start < sizeof(ring); ++start)
+    {
+        for (size_t src_offset = 0u; src_offset < 4u; ++src_offset)
+        {
+            for (size_t length = 0u; length + src_offset <= data.size(); ++length)
+            {
+                size_t const expected = std::min(length, capacity);
+                size_t const written  = stream.write(data.data() + src_offset, length);
+
+                uint8_t data_read[sizeof(ring)] = {};
+                size_t const count = host.read(1u, data_read, sizeof(data_read));
+
+                if ((written != expected) || (count != expected) ||
+                    (std::memcmp(data_read, data.data() + src_offset, expected) != 0))
+                {
+                    if (++errors <= 10u)
+                    {
+                        ADD_FAILURE() << "start " << start << " src_offset " << src_offset
+                                      << " length " << length << " written " << written
+                                      << " read " << count;
+                    }
+                }
+            }
+        }
+
+        // Move the ring offsets on by one for the next start position.
+        stream.write(data.data(), 1u);
+        uint8_t one;
+        host.read(1u, &one, 1u);
+    }
+
+    EXPECT_EQ(errors, 0u);
+}
+
+TEST_F(RttStream, ReadWrapAround)
+{
+    static char ring[23u];
+    rtt_input_stream commands(ring, sizeof(ring), 1u);
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+
+    std::vector<uint8_t> const data = byte_sequence(sizeof(ring) + 4u, 0x40u);
+    size_t const capacity = sizeof(ring) - 1u;
+    size_t errors = 0u;
+
+    for (size_t start = 0u; start < sizeof(ring); ++start)
+    {
+        for (size_t length = 0u; length <= data.size(); ++length)
+        {
+            size_t const expected = std::min(length, capacity);
+            size_t const written  = host.write(1u, data.data(), length);
+
+            uint8_t data_read[sizeof(ring) + 4u] = {};
+            size_t const count = commands.read(data_read, sizeof(data_read));
+
+            if ((written != expected) || (count != expected) ||
+                (std::memcmp(data_read, data.data(), expected) != 0))
+            {
+                if (++errors <= 10u)
+                {
+                    ADD_FAILURE() << "start " << start << " length " << length
+                                  << " written " << written << " read " << count;
+                }
+            }
+        }
+
+        host.write(1u, data.data(), 1u);
+        EXPECT_EQ(SEGGER_RTT_GetChar(1u), data[0]);
+        EXPECT_EQ(SEGGER_RTT_GetChar(1u), -1);
+    }
+
+    EXPECT_EQ(errors, 0u);
+}
+
+TEST_F(RttStream, ReserveCommit)
+{
+    static char ring[32u];
+    rtt_output_stream stream(ring, sizeof(ring));
+    segger_rtt_enable();
+
+    rtt_host_emulator host(getpid());
+    ASSERT_TRUE(host.attach());
+
+    // Format straight into the ring.
+    size_t length = 0u;
+    char* region = static_cast<char*>(stream.reserve(length));
+    EXPECT_EQ(region, ring);
+    EXPECT_EQ(length, sizeof(ring) - 1u);
+
+    int const n_format = std::snprintf(region, length, "t=%u", 1234u);
+    ASSERT_EQ(n_format, 6);
+
+    // Nothing is visible to the host until committed.
+    EXPECT_EQ(host.up_pending(0u), 0u);
+    stream.commit(static_cast<size_t>(n_format));
+    EXPECT_EQ(host.up_pending(0u), 6u);
+    EXPECT_EQ(stream.bytes_written(), 6u);
+
+    char text[32u] = {};
+    EXPECT_EQ(host.read(0u, text, sizeof(text)), 6u);
+    EXPECT_STREQ(text, "t=1234");
+
+    // Free space which wraps is reserved in two parts.
+    std::vector<uint8_t> const data = byte_sequence(20u);
+    EXPECT_EQ(stream.write(data.data(), data.size()), data.size());
+    uint8_t data_read[32u];
+    EXPECT_EQ(host.read(0u, data_read, sizeof(data_read)), data.size());
+
+    // The write offset is 26 and the read offset 26: 31 bytes free.
+    region = static_cast<char*>(stream.reserve(length));
+    EXPECT_EQ(region, ring + 26u);
+    EXPECT_EQ(length, 6u);
+    std::memset(region, 'a', length);
+    stream.commit(length);
+
+    region = static_cast<char*>(stream.reserve(length));
+    EXPECT_EQ(region, ring);
+    EXPECT_EQ(length, 25u);
+    std::memset(region, 'b', 4u);
+    stream.commit(4u);
+
+    EXPECT_EQ(host.read(0u, text, sizeof(text)), 10u);
+    EXPECT_EQ(std::string(text, 10u), "aaaaaabbbb");
+
+    // Committing nothing is allowed.
+    stream.reserve(length);
+    stream.commit(0u);
+    EXPECT_EQ(host.up_pending(0u), 0u);
+}
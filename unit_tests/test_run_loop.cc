@@ -0,0 +1,457 @@
+/**
+ * @file test_run_loop.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "run_loop.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @class simulated_hooks
+ * A simulated clock with injected events. Timer events are known to the
+ * timer scheduler and bound the idle interval; other events, such as a
+ * radio event, arrive unannounced. Sleeping advances the clock to the
+ * next event or the end of the idle interval and runs the event ISRs.
+ */
+class simulated_hooks: public run_loop_hooks
+{
+public:
+    struct sleep_record
+    {
+        sleep_mode  mode;
+        uint32_t    ticks_idle;
+        uint32_t    ticks_at;
+    };
+
+    virtual uint32_t ticks_now() override { return this->now; }
+
+    virtual uint32_t ticks_until_deadline() override
+    {
+        uint32_t ticks = run_loop::ticks_forever;
+        for (event const& timer_event : this->events)
+        {
+            if (timer_event.is_timer)
+            {
+                ticks = std::min(ticks, timer_event.at - this->now);
+            }
+        }
+        return ticks;
+    }
+
+    virtual void sleep(sleep_mode mode, uint32_t ticks_idle) override
+    {
+        this->sleeps.push_back({mode, ticks_idle, this->now});
+
+        uint32_t wake = (ticks_idle == run_loop::ticks_forever) ?
+            run_loop::ticks_forever : this->now + ticks_idle;
+        if (mode == sleep_mode::none)
+        {
+            wake = this->now + 1u;
+        }
+
+        for (event const& next_event : this->events)
+        {
+            wake = std::min(wake, next_event.at);
+        }
+
+        // Nothing will wake the CPU; treat as a spurious wake.
+        if (wake == run_loop::ticks_forever)
+        {
+            return;
+        }
+
+        this->advance(wake - this->now);
+    }
+
+    /// Advance the clock, running the ISRs of the events which occur.
+    void advance(uint32_t ticks)
+    {
+        this->now += ticks;
+        std::stable_sort(this->events.begin(), this->events.end(),
+                         [](event const& a, event const& b) { return a.at < b.at; });
+
+        while (not this->events.empty() && (this->events.front().at <= this->now))
+        {
+            event const isr_event = this->events.front();
+            this->events.erase(this->events.begin());
+            isr_event.isr();
+        }
+    }
+
+    void inject(uint32_t at, bool is_timer, std::function<void()> isr)
+    {
+        this->events.push_back({at, is_timer, isr});
+    }
+
+    uint32_t                    now = 0u;
+    std::vector<sleep_record>   sleeps;
+
+private:
+    struct event
+    {
+        uint32_t                at;
+        bool                    is_timer;
+        std::function<void()>   isr;
+    };
+
+    std::vector<event> events;
+};
+
+/// Record the order in which work items run; optionally take time.
+class recording_work: public work_item
+{
+public:
+    recording_work(run_loop&                loop,
+                   priority_t               priority,
+                   char                     name,
+                   std::string&             order,
+                   std::function<void()>    action = nullptr) :
+        work_item(loop, priority), name_(name), order_(order), action_(action)
+    {
+    }
+
+    virtual void run() override
+    {
+        this->order_.push_back(this->name_);
+        if (this->action_) { this->action_(); }
+    }
+
+private:
+    char                    name_;
+    std::string&            order_;
+    std::function<void()>   action_;
+};
+
+/// An output stream whose data is pending until flushed.
+class pending_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return this->text.size(); }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+
+    void flush() override
+    {
+        this->flushed.append(this->text);
+        this->text.clear();
+        this->flush_count += 1u;
+    }
+
+    void write(std::size_t length) { this->text.append(length, '.'); }
+
+    std::string text;
+    std::string flushed;
+    std::size_t flush_count = 0u;
+};
+
+class counting_work: public work_item
+{
+public:
+    counting_work(run_loop& loop, priority_t priority) : work_item(loop, priority) {}
+
+    virtual void run() override { this->run_count.fetch_add(1u); }
+
+    std::atomic<uint32_t> run_count{0u};
+};
+
+} // anonymous namespace
+
+TEST(RunLoop, PriorityOrder)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+    std::string     order;
+
+    recording_work a(loop, 3u, 'a', order);
+    recording_work b(loop, 1u, 'b', order);
+    recording_work c(loop, 0u, 'c', order);
+    recording_work d(loop, 2u, 'd', order);
+    recording_work e(loop, 1u, 'e', order);
+
+    for (work_item* item : std::vector<work_item*>{&a, &b, &c, &d, &e})
+    {
+        EXPECT_TRUE(item->post());
+        EXPECT_TRUE(item->is_pending());
+    }
+
+    EXPECT_TRUE(loop.has_work());
+    EXPECT_EQ(loop.run_once(), 5u);
+    EXPECT_EQ(order, "cbeda");
+    EXPECT_FALSE(loop.has_work());
+    EXPECT_FALSE(a.is_pending());
+
+    EXPECT_EQ(loop.stats().run_count[0], 1u);
+    EXPECT_EQ(loop.stats().run_count[1], 2u);
+    EXPECT_EQ(loop.stats().run_count[2], 1u);
+    EXPECT_EQ(loop.stats().run_count[3], 1u);
+}
+
+TEST(RunLoop, HigherPriorityPostedDuringPass)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+    std::string     order;
+
+    recording_work urgent(loop, 0u, 'u', order);
+    recording_work same(loop,   2u, 's', order);
+    recording_work first(loop,  2u, 'f', order, [&]() {
+        urgent.post();
+        same.post();
+    });
+    recording_work second(loop, 2u, 'g', order);
+
+    first.post();
+    second.post();
+
+    // The urgent item runs ahead of the rest of the pass; the same
+    // priority item waits for the next pass.
+    EXPECT_EQ(loop.run_once(), 3u);
+    EXPECT_EQ(order, "fug");
+    EXPECT_TRUE(loop.has_work());
+    EXPECT_TRUE(hooks.sleeps.empty());
+
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(order, "fugs");
+}
+
+TEST(RunLoop, RepostDoesNotStarve)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+    std::string     order;
+
+    recording_work* self_ptr = nullptr;
+    recording_work  self(loop, 0u, 'r', order, [&]() { self_ptr->post(); });
+    recording_work  other(loop, 1u, 'o', order);
+    self_ptr = &self;
+
+    // The item runs again only ahead of lower priority work in the pass.
+    self.post();
+    other.post();
+    EXPECT_EQ(loop.run_once(), 3u);
+    EXPECT_EQ(order, "ror");
+    EXPECT_TRUE(self.is_pending());
+}
+
+TEST(RunLoop, CoalescePendingPost)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+    std::string     order;
+
+    recording_work a(loop, 1u, 'a', order);
+    EXPECT_TRUE(a.post());
+    EXPECT_FALSE(a.post());
+    EXPECT_FALSE(loop.post(a));
+    EXPECT_EQ(loop.coalesced_count(), 2u);
+
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(order, "a");
+}
+
+TEST(RunLoop, SleepDepthFromDeadline)
+{
+    simulated_hooks hooks;
+    hooks.sleep_thresholds_set(1u, 10u);
+    run_loop loop(hooks);
+
+    hooks.inject(1u,   true, []() {});
+    loop.run_once();
+    hooks.inject(6u,   true, []() {});
+    loop.run_once();
+    hooks.inject(106u, true, []() {});
+    loop.run_once();
+
+    ASSERT_EQ(hooks.sleeps.size(), 3u);
+    EXPECT_EQ(hooks.sleeps[0].mode, sleep_mode::none);
+    EXPECT_EQ(hooks.sleeps[0].ticks_idle, 1u);
+    EXPECT_EQ(hooks.sleeps[1].mode, sleep_mode::wait_for_event);
+    EXPECT_EQ(hooks.sleeps[1].ticks_idle, 5u);
+    EXPECT_EQ(hooks.sleeps[2].mode, sleep_mode::low_power);
+    EXPECT_EQ(hooks.sleeps[2].ticks_idle, 100u);
+    EXPECT_EQ(hooks.now, 106u);
+
+    EXPECT_EQ(loop.stats().sleep_count[static_cast<std::size_t>(sleep_mode::none)], 1u);
+    EXPECT_EQ(loop.stats().sleep_count[static_cast<std::size_t>(sleep_mode::wait_for_event)], 1u);
+    EXPECT_EQ(loop.stats().ticks_sleep[static_cast<std::size_t>(sleep_mode::low_power)], 100u);
+}
+
+TEST(RunLoop, IsrEventWakesLoop)
+{
+    simulated_hooks hooks;
+    hooks.sleep_thresholds_set(1u, 10u);
+    run_loop        loop(hooks);
+    std::string     order;
+    recording_work  radio(loop, 0u, 'r', order);
+
+    // An unannounced event; the loop sleeps without a deadline.
+    hooks.inject(50u, false, [&]() { radio.post(); });
+    EXPECT_EQ(loop.run_once(), 0u);
+    ASSERT_EQ(hooks.sleeps.size(), 1u);
+    EXPECT_EQ(hooks.sleeps[0].mode, sleep_mode::low_power);
+    EXPECT_EQ(hooks.sleeps[0].ticks_idle, run_loop::ticks_forever);
+    EXPECT_EQ(hooks.now, 50u);
+
+    EXPECT_EQ(loop.run_once(), 1u);
+    EXPECT_EQ(order, "r");
+}
+
+TEST(RunLoop, LoggerFlushBatching)
+{
+    simulated_hooks hooks;
+    hooks.sleep_thresholds_set(1u, 10u);
+    run_loop        loop(hooks);
+    pending_stream  os;
+    logger          flush_logger;
+    flush_logger.set_output_stream(os);
+    loop.logger_flush_set(flush_logger, 20u, 100u, 2u);
+
+    // Small writes are held until the flush latency expires.
+    os.write(10u);
+    loop.run_once();
+    EXPECT_EQ(os.flush_count, 0u);
+    ASSERT_EQ(hooks.sleeps.size(), 1u);
+    EXPECT_EQ(hooks.sleeps[0].ticks_idle, 20u);
+    EXPECT_EQ(hooks.now, 20u);
+
+    os.write(10u);
+    loop.run_once();
+    EXPECT_EQ(os.flush_count, 1u);
+    EXPECT_EQ(os.flushed.size(), 20u);
+    EXPECT_EQ(loop.stats().flush_count, 1u);
+
+    // Exceeding the threshold flushes at once.
+    os.write(150u);
+    loop.run_once();
+    EXPECT_EQ(os.flush_count, 2u);
+}
+
+TEST(RunLoop, LoggerFlushDeferredByDeadline)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+    pending_stream  os;
+    logger          flush_logger;
+    flush_logger.set_output_stream(os);
+    loop.logger_flush_set(flush_logger, 20u, 100u, 2u);
+
+    hooks.inject(2u, true, []() {});
+    os.write(150u);
+    loop.run_once();
+    EXPECT_EQ(os.flush_count, 0u);
+    EXPECT_EQ(loop.stats().flush_deferred_count, 1u);
+    EXPECT_EQ(hooks.now, 2u);
+
+    // After the deadline the flush proceeds.
+    loop.run_once();
+    EXPECT_EQ(os.flush_count, 1u);
+}
+
+TEST(RunLoop, DutyCycle)
+{
+    simulated_hooks hooks;
+    hooks.sleep_thresholds_set(1u, 50u);
+    run_loop        loop(hooks);
+    std::string     order;
+
+    // A periodic timer whose work takes 10 of every 100 ticks.
+    recording_work sample(loop, 1u, 's', order, [&]() { hooks.advance(10u); });
+    std::function<void()> timer_isr;
+    timer_isr = [&]() {
+        sample.post();
+        hooks.inject(hooks.now + 100u, true, timer_isr);
+    };
+    hooks.inject(100u, true, timer_isr);
+
+    loop.run_once();
+    loop.reset_statistics();
+    for (int pass = 0; pass < 10; ++pass)
+    {
+        loop.run_once();
+    }
+
+    EXPECT_EQ(order.size(), 10u);
+    EXPECT_EQ(loop.stats().ticks_active, 100u);
+    EXPECT_EQ(loop.stats().ticks_sleep[static_cast<std::size_t>(sleep_mode::low_power)], 900u);
+    EXPECT_EQ(loop.duty_cycle_permille(), 100u);
+
+    pending_stream os;
+    logger         dump_logger;
+    dump_logger.set_output_stream(os);
+    dump_logger.set_level(logger::level::info);
+    loop.dump(dump_logger);
+    EXPECT_NE(os.text.find("run loop: passes: 10, duty cycle: 10.0%"), std::string::npos);
+    EXPECT_NE(os.text.find("run loop: priority 1: runs:       10"), std::string::npos);
+    EXPECT_NE(os.text.find("run loop: sleep low_power      count:       10, ticks:        900"),
+              std::string::npos);
+}
+
+TEST(RunLoop, ConcurrentProducers)
+{
+    simulated_hooks hooks;
+    run_loop        loop(hooks);
+
+    constexpr std::size_t const producer_count = 4u;
+    constexpr std::size_t const item_count     = 16u;
+    constexpr uint32_t    const post_count     = 2000u;
+
+    std::vector<std::unique_ptr<counting_work>> items;
+    for (std::size_t index = 0u; index < producer_count * item_count; ++index)
+    {
+        items.emplace_back(new counting_work(loop, index % run_loop::priority_count));
+    }
+
+    std::atomic<uint32_t>    posted{0u};
+    std::atomic<std::size_t> producers_done{0u};
+    std::vector<std::thread> producers;
+    for (std::size_t producer = 0u; producer < producer_count; ++producer)
+    {
+        producers.emplace_back([&, producer]() {
+            for (uint32_t count = 0u; count < post_count; ++count)
+            {
+                work_item& item = *items[producer * item_count + (count % item_count)];
+                if (item.post()) { posted.fetch_add(1u); }
+            }
+            producers_done.fetch_add(1u);
+        });
+    }
+
+    while ((producers_done.load() < producer_count) || loop.has_work())
+    {
+        loop.run_once();
+    }
+
+    for (std::thread& producer : producers) { producer.join(); }
+    loop.run_once();
+
+    uint32_t run_total = 0u;
+    for (auto const& item : items)
+    {
+        run_total += item->run_count.load();
+        EXPECT_FALSE(item->is_pending());
+    }
+
+    EXPECT_EQ(run_total, posted.load());
+    EXPECT_EQ(posted.load() + loop.coalesced_count(), producer_count * post_count);
+}
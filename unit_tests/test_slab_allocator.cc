@@ -0,0 +1,175 @@
+/**
+ * @file test_slab_allocator.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "slab_allocator.h"
+#include "resource_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <thread>
+#include <vector>
+
+TEST(SlabAllocator, SizeClasses)
+{
+    fixed_block_pool<16u,  4u> pool_16;
+    fixed_block_pool<64u,  2u> pool_64;
+    fixed_block_pool<256u, 1u> pool_256;
+    slab_allocator<3u> slab({&pool_16, &pool_64, &pool_256});
+
+    EXPECT_EQ(slab.size_max(), 256u);
+
+    void* const alloc_1 = slab.allocate(10u);
+    void* const alloc_2 = slab.allocate(40u);
+    void* const alloc_3 = slab.allocate(200u);
+    EXPECT_EQ(slab.owner(alloc_1), &pool_16);
+    EXPECT_EQ(slab.owner(alloc_2), &pool_64);
+    EXPECT_EQ(slab.owner(alloc_3), &pool_256);
+    EXPECT_EQ(slab.spill_count(), 0u);
+
+    EXPECT_EQ(slab.allocate(257u), nullptr);
+    EXPECT_EQ(slab.failure_count(), 1u);
+
+    EXPECT_EQ(slab.requested_bytes(), 250u);
+    EXPECT_EQ(slab.allocated_bytes(), 16u + 64u + 256u);
+    EXPECT_EQ(slab.fragmentation_permille(), (86u * 1000u) / 336u);
+
+    slab.deallocate(alloc_1, 10u);
+    slab.deallocate(alloc_2, 40u);
+    slab.deallocate(alloc_3, 200u);
+    EXPECT_EQ(slab.allocated_bytes(), 0u);
+    EXPECT_EQ(slab.fragmentation_permille(), 0u);
+    EXPECT_EQ(slab.high_water_bytes(), 16u + 64u + 256u);
+}
+
+TEST(SlabAllocator, Spill)
+{
+    fixed_block_pool<16u, 1u> pool_16;
+    fixed_block_pool<32u, 2u> pool_32;
+    slab_allocator<2u> slab({&pool_16, &pool_32});
+
+    void* const alloc_1 = slab.allocate(8u);
+    void* const alloc_2 = slab.allocate(8u);
+    EXPECT_EQ(slab.owner(alloc_1), &pool_16);
+    EXPECT_EQ(slab.owner(alloc_2), &pool_32);
+    EXPECT_EQ(slab.spill_count(), 1u);
+
+    // A spill is not a failure of the exhausted class.
+    EXPECT_EQ(pool_16.failure_count(), 0u);
+    EXPECT_EQ(slab.failure_count(), 0u);
+
+    void* const alloc_3 = slab.allocate(8u);
+    EXPECT_EQ(slab.owner(alloc_3), &pool_32);
+    EXPECT_EQ(slab.allocate(8u), nullptr);
+    EXPECT_EQ(slab.failure_count(), 1u);
+    EXPECT_EQ(pool_16.failure_count(), 0u);
+    EXPECT_EQ(pool_32.failure_count(), 0u);
+
+    slab.deallocate(alloc_3, 8u);
+    slab.deallocate(alloc_2, 8u);
+    slab.deallocate(alloc_1, 8u);
+
+    slab.reset_statistics();
+    EXPECT_EQ(slab.spill_count(), 0u);
+    EXPECT_EQ(slab.failure_count(), 0u);
+    EXPECT_EQ(slab.high_water_bytes(), 0u);
+}
+
+TEST(SlabAllocator, StdMap)
+{
+    using slab_type = slab_allocator<2u>;
+    using value_type = std::pair<int const, int>;
+    using allocator = resource_allocator<value_type, slab_type>;
+
+    fixed_block_pool<32u, 8u>  pool_32;
+    fixed_block_pool<64u, 32u> pool_64;
+    slab_type slab({&pool_32, &pool_64});
+
+    std::map<int, int, std::less<int>, allocator> map{allocator(slab)};
+    for (int key = 0; key < 32; ++key)
+    {
+        map[key] = key * key;
+    }
+
+    // Map nodes are larger than 32 bytes; all land in the 64 byte class.
+    EXPECT_EQ(pool_32.in_use(), 0u);
+    EXPECT_EQ(pool_64.in_use(), 32u);
+    EXPECT_EQ(map[31], 961);
+    EXPECT_GT(slab.fragmentation_permille(), 0u);
+
+    map.clear();
+    EXPECT_EQ(slab.allocated_bytes(), 0u);
+}
+
+TEST(SlabAllocator, Stress)
+{
+    constexpr std::size_t const thread_count = 4u;
+    constexpr std::size_t const iterations   = 50000u;
+
+    fixed_block_pool<16u,  16u> pool_16;
+    fixed_block_pool<64u,  16u> pool_64;
+    fixed_block_pool<128u, 16u> pool_128;
+    slab_allocator<3u> slab({&pool_16, &pool_64, &pool_128});
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> errors(thread_count, 0u);
+
+    for (std::size_t thread_id = 0u; thread_id < thread_count; ++thread_id)
+    {
+        threads.emplace_back([&slab, &errors, thread_id]()
+        {
+            struct allocation { uint8_t* data; std::size_t size; uint8_t fill; };
+            std::vector<allocation> held;
+            uint32_t random = static_cast<uint32_t>(thread_id) * 2654435761u + 1u;
+
+            for (std::size_t iter = 0u; iter < iterations; ++iter)
+            {
+                random = random * 1664525u + 1013904223u;
+                std::size_t const size = 1u + ((random >> 8u) % 128u);
+
+                if (held.empty() || ((held.size() < 8u) && (random & 0x80000000u)))
+                {
+                    uint8_t* const data = static_cast<uint8_t*>(slab.allocate(size));
+                    if (data)
+                    {
+                        uint8_t const fill = static_cast<uint8_t>(random);
+                        std::memset(data, fill, size);
+                        held.push_back({data, size, fill});
+                    }
+                }
+                else
+                {
+                    allocation const& alloc = held.back();
+                    for (std::size_t index = 0u; index < alloc.size; ++index)
+                    {
+                        if (alloc.data[index] != alloc.fill) { errors[thread_id] += 1u; break; }
+                    }
+                    slab.deallocate(alloc.data, alloc.size);
+                    held.pop_back();
+                }
+            }
+
+            for (allocation const& alloc : held)
+            {
+                slab.deallocate(alloc.data, alloc.size);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (std::size_t error_count : errors)
+    {
+        EXPECT_EQ(error_count, 0u);
+    }
+
+    EXPECT_EQ(slab.allocated_bytes(), 0u);
+    EXPECT_EQ(slab.requested_bytes(), 0u);
+}
@@ -0,0 +1,412 @@
+/**
+ * @file test_spis_ring.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Test the SPIS slot ring against a simulation of the SPIS registers and
+ * semaphore, driven by a SPI master which sends transactions in bursts.
+ */
+
+#include "gtest/gtest.h"
+#include "spis_ring.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @struct spis_registers_sim
+ * The NRF_SPIS_Type registers accessed by spis_ring.
+ */
+struct spis_registers_sim
+{
+    struct dma_registers
+    {
+        uintptr_t PTR;
+        uint32_t  MAXCNT;
+        uint32_t  AMOUNT;
+    };
+
+    uint32_t        TASKS_RELEASE;
+    uint32_t        EVENTS_END;
+    uint32_t        EVENTS_ACQUIRED;
+    dma_registers   RXD;
+    dma_registers   TXD;
+};
+
+/**
+ * @class spis_simulator
+ * The SPIS peripheral with the END_ACQUIRE shortcut enabled:
+ * - A master transaction is received only when the SPIS owns the semaphore.
+ *   Otherwise the slave responds with the DEF character and the MOSI data
+ *   is lost.
+ * - At the end of a transaction the semaphore is handed to the CPU and the
+ *   END and ACQUIRED events are raised.
+ * - TASKS_RELEASE hands the semaphore to the SPIS.
+ */
+class spis_simulator
+{
+public:
+    spis_simulator(spis_ring& ring) :
+        ring_(ring), registers_{}, spis_owns_semaphore_(false),
+        irq_pending_(false), irq_pend_time_(0u), lost_count_(0u)
+    {
+        this->ring_.set_semaphore_owned(true);
+    }
+
+    /// The master clocks a transaction; the MOSI data carries sequence.
+    bool master_transaction(uint32_t sequence, uint32_t time)
+    {
+        if (not this->spis_owns_semaphore_)
+        {
+            this->lost_count_ += 1u;
+            return false;
+        }
+
+        std::size_t const length = std::min<std::size_t>(sizeof(sequence),
+                                                         this->registers_.RXD.MAXCNT);
+        std::memcpy(reinterpret_cast<void*>(this->registers_.RXD.PTR), &sequence, length);
+        this->registers_.RXD.AMOUNT = length;
+        this->registers_.TXD.AMOUNT = std::min<uint32_t>(sizeof(sequence),
+                                                         this->registers_.TXD.MAXCNT);
+
+        this->spis_owns_semaphore_      = false;
+        this->registers_.EVENTS_END      = 1u;
+        this->registers_.EVENTS_ACQUIRED = 1u;
+        this->pend_irq(time);
+        return true;
+    }
+
+    void pend_irq(uint32_t time)
+    {
+        if (not this->irq_pending_)
+        {
+            this->irq_pending_   = true;
+            this->irq_pend_time_ = time;
+        }
+    }
+
+    /// Run the ISR if it is pending for at least the interrupt latency.
+    spis_slot_t* service_irq(uint32_t time, uint32_t irq_latency)
+    {
+        if ((not this->irq_pending_) || (time - this->irq_pend_time_ < irq_latency))
+        {
+            return nullptr;
+        }
+
+        this->irq_pending_ = false;
+        spis_slot_t* const completed = this->ring_.irq_handler(this->registers_);
+        if (this->registers_.TASKS_RELEASE)
+        {
+            this->registers_.TASKS_RELEASE = 0u;
+            this->spis_owns_semaphore_     = true;
+        }
+        return completed;
+    }
+
+    bool spis_owns_semaphore() const { return this->spis_owns_semaphore_; }
+    uint32_t lost_count() const { return this->lost_count_; }
+
+private:
+    spis_ring&          ring_;
+    spis_registers_sim  registers_;
+    bool                spis_owns_semaphore_;
+    bool                irq_pending_;
+    uint32_t            irq_pend_time_;
+    uint32_t            lost_count_;
+};
+
+/// A SPI master which sends bursts of transactions.
+struct bursty_master
+{
+    uint32_t burst_period_us;       ///< The time between the start of bursts.
+    uint32_t burst_length;          ///< The number of transactions per burst.
+    uint32_t transaction_period_us; ///< The time between transactions in a burst.
+
+    bool transaction_at(uint32_t time) const
+    {
+        uint32_t const burst_time = time % this->burst_period_us;
+        return ((burst_time % this->transaction_period_us) == 0u) &&
+               (burst_time / this->transaction_period_us < this->burst_length);
+    }
+};
+
+struct simulation_result
+{
+    uint32_t sent;
+    uint32_t received;
+    uint32_t lost;
+    uint32_t sequence_errors;
+    uint32_t handoff_latency_max;   ///< Transaction end to the ISR completion.
+    uint32_t consume_latency_max;   ///< Transaction end to the slot released.
+    spis_ring_statistics_t stats;
+
+    double loss_rate() const {
+        return static_cast<double>(this->lost) / static_cast<double>(this->sent);
+    }
+};
+
+constexpr uint32_t const irq_latency_us  = 2u;
+
+/// The master starts once the driver has armed the first slot.
+constexpr uint32_t const master_start_us = 100u;
+
+/**
+ * Run the master, the SPIS ISR and an application which holds each
+ * completed slot for app_service_us before releasing it.
+ */
+simulation_result simulate(std::size_t          slot_count,
+                           bursty_master const& master,
+                           uint32_t             app_service_us,
+                           uint32_t             duration_us)
+{
+    std::vector<std::array<uint32_t, 1u>> mosi_buffers(slot_count);
+    std::vector<std::array<uint32_t, 1u>> miso_buffers(slot_count);
+    std::vector<spis_slot_t>              slots(slot_count);
+    std::vector<uint32_t>                 end_time(slot_count);
+
+    for (std::size_t index = 0u; index < slot_count; ++index)
+    {
+        slots[index] = spis_slot_t {
+            .miso_pointer = miso_buffers[index].data(),
+            .miso_length  = sizeof(miso_buffers[index]),
+            .mosi_pointer = mosi_buffers[index].data(),
+            .mosi_length  = sizeof(mosi_buffers[index]),
+            .miso_amount  = 0u,
+            .mosi_amount  = 0u
+        };
+    }
+
+    spis_ring       ring;
+    spis_simulator  spis(ring);
+    ring.assign(slots.data(), slots.size());
+    ring.queue_all();
+    if (ring.pend_irq()) { spis.pend_irq(0u); }
+
+    simulation_result result = {};
+    uint32_t sequence       = 0u;
+    uint32_t last_received  = UINT32_MAX;
+    uint32_t last_end_time  = 0u;
+    uint32_t app_busy_until = 0u;
+    bool     app_holding    = false;
+
+    for (uint32_t time = 0u; time < duration_us; ++time)
+    {
+        if ((time >= master_start_us) && master.transaction_at(time - master_start_us))
+        {
+            result.sent += 1u;
+            if (spis.master_transaction(sequence, time)) { last_end_time = time; }
+            sequence += 1u;
+        }
+
+        spis_slot_t* const completed = spis.service_irq(time, irq_latency_us);
+        if (completed)
+        {
+            std::size_t const index = completed - slots.data();
+            end_time[index] = last_end_time;
+            result.handoff_latency_max =
+                std::max(result.handoff_latency_max, time - last_end_time);
+        }
+
+        // The application releases the slot it holds once processed and
+        // then takes the next completed slot, by reference.
+        if (app_holding && (time >= app_busy_until))
+        {
+            spis_slot_t const* const slot = ring.front();
+            std::size_t const index = slot - slots.data();
+            result.consume_latency_max =
+                std::max(result.consume_latency_max, time - end_time[index]);
+
+            ring.release(true);
+            if (ring.pend_irq()) { spis.pend_irq(time); }
+            app_holding = false;
+        }
+
+        if (not app_holding)
+        {
+            spis_slot_t const* const slot = ring.front();
+            if (slot)
+            {
+                uint32_t received = 0u;
+                std::memcpy(&received, slot->mosi_pointer, sizeof(received));
+                if ((slot->mosi_amount != sizeof(received)) ||
+                    ((last_received != UINT32_MAX) && (received <= last_received)))
+                {
+                    result.sequence_errors += 1u;
+                }
+                last_received   = received;
+                result.received += 1u;
+                app_holding     = true;
+                app_busy_until  = time + app_service_us;
+            }
+        }
+    }
+
+    result.lost  = spis.lost_count();
+    result.stats = ring.statistics();
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(SpisRing, QueueArmCompleteRelease)
+{
+    std::array<uint8_t, 4u>         mosi[4u];
+    std::array<uint8_t, 4u> const   miso[4u] = {};
+    std::array<spis_slot_t, 4u>     slots = {};
+
+    spis_ring ring;
+    ring.set_semaphore_owned(true);
+    ring.assign(slots.data(), slots.size());
+    EXPECT_TRUE(ring.is_idle());
+    EXPECT_TRUE(ring.is_starved());
+
+    for (std::size_t index = 0u; index < slots.size(); ++index)
+    {
+        EXPECT_TRUE(ring.queue(miso[index].data(), miso[index].size(),
+                               mosi[index].data(), mosi[index].size()));
+    }
+    EXPECT_FALSE(ring.queue(miso[0].data(), miso[0].size(), mosi[0].data(), mosi[0].size()));
+    EXPECT_EQ(ring.available(), 0u);
+    EXPECT_TRUE(ring.pend_irq());
+
+    // The pended ISR arms the first slot and releases the semaphore.
+    spis_registers_sim registers = {};
+    EXPECT_EQ(ring.irq_handler(registers), nullptr);
+    EXPECT_EQ(registers.TASKS_RELEASE, 1u);
+    EXPECT_EQ(registers.RXD.PTR, reinterpret_cast<uintptr_t>(mosi[0].data()));
+    EXPECT_EQ(registers.RXD.MAXCNT, mosi[0].size());
+    EXPECT_EQ(ring.armed(), &slots[0]);
+    EXPECT_EQ(ring.queued(), 3u);
+    EXPECT_FALSE(ring.pend_irq());
+    EXPECT_EQ(ring.front(), nullptr);
+
+    // The transfer ends: slot 0 completes and slot 1 is armed.
+    registers.TASKS_RELEASE   = 0u;
+    registers.EVENTS_END      = 1u;
+    registers.EVENTS_ACQUIRED = 1u;
+    registers.RXD.AMOUNT      = 3u;
+    registers.TXD.AMOUNT      = 2u;
+    EXPECT_EQ(ring.irq_handler(registers), &slots[0]);
+    EXPECT_EQ(registers.EVENTS_END, 0u);
+    EXPECT_EQ(registers.EVENTS_ACQUIRED, 0u);
+    EXPECT_EQ(registers.TASKS_RELEASE, 1u);
+    EXPECT_EQ(registers.RXD.PTR, reinterpret_cast<uintptr_t>(mosi[1].data()));
+    EXPECT_EQ(slots[0].mosi_amount, 3u);
+    EXPECT_EQ(slots[0].miso_amount, 2u);
+
+    // The application holds slot 0 by reference and returns it.
+    EXPECT_EQ(ring.front(), &slots[0]);
+    EXPECT_EQ(ring.depth(), 1u);
+    ring.release(true);
+    EXPECT_EQ(ring.front(), nullptr);
+    EXPECT_EQ(ring.available(), 0u);
+    EXPECT_EQ(ring.queued(), 3u);
+
+    spis_ring_statistics_t const stats = ring.statistics();
+    EXPECT_EQ(stats.transfer_count, 1u);
+    EXPECT_EQ(stats.starved_count, 0u);
+    EXPECT_EQ(stats.depth_max, 1u);
+}
+
+TEST(SpisRing, StarvedUntilRelease)
+{
+    std::array<uint8_t, 4u>     mosi[2u];
+    std::array<uint8_t, 4u>     miso[2u] = {};
+    std::array<spis_slot_t, 2u> slots = {{
+        { miso[0].data(), miso[0].size(), mosi[0].data(), mosi[0].size(), 0u, 0u },
+        { miso[1].data(), miso[1].size(), mosi[1].data(), mosi[1].size(), 0u, 0u },
+    }};
+
+    spis_ring ring;
+    ring.set_semaphore_owned(true);
+    ring.assign(slots.data(), slots.size());
+    EXPECT_EQ(ring.queue_all(), 2u);
+
+    spis_registers_sim registers = {};
+    ring.irq_handler(registers);
+
+    // Two transfers complete while the application holds both slots.
+    for (std::size_t index = 0u; index < 2u; ++index)
+    {
+        registers.TASKS_RELEASE   = 0u;
+        registers.EVENTS_END      = 1u;
+        registers.EVENTS_ACQUIRED = 1u;
+        EXPECT_EQ(ring.irq_handler(registers), &slots[index]);
+    }
+
+    // The ISR keeps the semaphore: no slot is queued.
+    EXPECT_EQ(registers.TASKS_RELEASE, 0u);
+    EXPECT_TRUE(ring.is_starved());
+    EXPECT_EQ(ring.statistics().starved_count, 1u);
+    EXPECT_EQ(ring.depth(), 2u);
+
+    // Releasing a slot requires the IRQ to be pended; the ISR arms it.
+    ring.release(true);
+    EXPECT_TRUE(ring.pend_irq());
+    EXPECT_EQ(ring.irq_handler(registers), nullptr);
+    EXPECT_EQ(registers.TASKS_RELEASE, 1u);
+    EXPECT_EQ(registers.RXD.PTR, reinterpret_cast<uintptr_t>(mosi[0].data()));
+    EXPECT_FALSE(ring.is_starved());
+}
+
+/**
+ * Bursts of 8 transactions 10 usec apart, every 1 msec. The application
+ * takes 25 usec to process each slot: 3 transactions complete for each
+ * slot processed during a burst, so a burst needs about 6 slots.
+ * The previous SPIS driver with 2 DMA buffers corresponds to slot_count 2.
+ */
+TEST(SpisRing, BurstyMasterLossRate)
+{
+    bursty_master const master = { 1000u, 8u, 10u };
+    uint32_t const app_service_us = 25u;
+    uint32_t const duration_us    = 100u * 1000u;
+
+    double loss_rate_prev = 1.0;
+    for (std::size_t slot_count : { 2u, 4u, 8u, 16u })
+    {
+        simulation_result const result =
+            simulate(slot_count, master, app_service_us, duration_us);
+
+        EXPECT_EQ(result.sent, 800u);
+        EXPECT_EQ(result.received + result.lost, result.sent);
+        EXPECT_EQ(result.received, result.stats.transfer_count);
+        EXPECT_EQ(result.sequence_errors, 0u);
+
+        // The ISR hands each completed slot over within the IRQ latency.
+        EXPECT_LE(result.handoff_latency_max, irq_latency_us);
+
+        // A slot is released at most after the slots held ahead of it.
+        EXPECT_LE(result.consume_latency_max, slot_count * app_service_us + irq_latency_us);
+        EXPECT_LE(result.stats.depth_max, slot_count);
+
+        EXPECT_LE(result.loss_rate(), loss_rate_prev) << "slot_count " << slot_count;
+        loss_rate_prev = result.loss_rate();
+
+        if (slot_count == 2u)
+        {
+            EXPECT_GT(result.loss_rate(), 0.25);
+            EXPECT_GT(result.stats.starved_count, 0u);
+        }
+        if (slot_count >= 8u)
+        {
+            EXPECT_EQ(result.lost, 0u) << "slot_count " << slot_count;
+        }
+    }
+}
+
+/// A consumer faster than the master never starves the ring.
+TEST(SpisRing, FastConsumerNoLoss)
+{
+    bursty_master const master = { 1000u, 8u, 10u };
+    simulation_result const result = simulate(2u, master, 5u, 20u * 1000u);
+
+    EXPECT_EQ(result.lost, 0u);
+    EXPECT_EQ(result.stats.starved_count, 0u);
+    EXPECT_EQ(result.received, 160u);
+    EXPECT_EQ(result.sequence_errors, 0u);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_spsc_slot_ring.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "spsc_slot_ring.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+using test_ring = spsc_slot_ring<16u, 4u>;
+
+TEST(SpscSlotRing, PushPop)
+{
+    test_ring ring;
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.front(), nullptr);
+
+    char const data_1[] = "first";
+    char const data_2[] = "second";
+    ASSERT_TRUE(ring.push(data_1, sizeof(data_1), 10u));
+    ASSERT_TRUE(ring.push(data_2, sizeof(data_2), 20u));
+    EXPECT_EQ(ring.depth(), 2u);
+
+    test_ring::slot const* slot = ring.front();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(slot->timestamp, 10u);
+    EXPECT_EQ(slot->length, sizeof(data_1));
+    EXPECT_EQ(std::memcmp(slot->data, data_1, sizeof(data_1)), 0);
+    ring.pop();
+
+    slot = ring.front();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(slot->timestamp, 20u);
+    EXPECT_EQ(std::memcmp(slot->data, data_2, sizeof(data_2)), 0);
+    ring.pop();
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.depth_max(), 2u);
+}
+
+TEST(SpscSlotRing, OverflowAndTruncate)
+{
+    test_ring ring;
+    uint8_t data[32u] = {0u};
+
+    for (std::size_t iter = 0u; iter < test_ring::capacity(); ++iter)
+    {
+        ASSERT_TRUE(ring.push(data, 1u, 0u));
+    }
+
+    EXPECT_FALSE(ring.push(data, 1u, 0u));
+    EXPECT_FALSE(ring.push(data, 1u, 0u));
+    EXPECT_EQ(ring.overflow_count(), 2u);
+    EXPECT_EQ(ring.depth_max(), test_ring::capacity());
+
+    // Draining the ring and wrapping the indices around.
+    for (std::size_t iter = 0u; iter < 3u * test_ring::capacity(); ++iter)
+    {
+        ring.pop();
+        ASSERT_TRUE(ring.push(data, sizeof(data), iter));
+    }
+
+    // Lengths beyond the slot size are truncated.
+    for (std::size_t iter = 0u; iter < test_ring::capacity() - 1u; ++iter)
+    {
+        ring.pop();
+    }
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(ring.front()->length, 16u);
+}
+
+TEST(SpscSlotRing, ProducerConsumerThreads)
+{
+    static spsc_slot_ring<sizeof(uint32_t), 8u> ring;
+    uint32_t const message_count = 100000u;
+
+    std::thread producer([&]() {
+        for (uint32_t value = 0u; value < message_count; )
+        {
+            if (ring.push(&value, sizeof(value), value))
+            {
+                ++value;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0u;
+    while (expected < message_count)
+    {
+        auto const* slot = ring.front();
+        if (slot)
+        {
+            uint32_t value = 0u;
+            std::memcpy(&value, slot->data, sizeof(value));
+            ASSERT_EQ(value, expected);
+            ASSERT_EQ(slot->timestamp, expected);
+            ring.pop();
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
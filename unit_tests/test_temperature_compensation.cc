@@ -0,0 +1,168 @@
+/**
+ * @file test_temperature_compensation.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "temperature_compensation.h"
+
+#include <cstdint>
+#include <iterator>
+
+TEST(TemperatureFilter, FirstSampleSetsValue)
+{
+    utility::temperature_filter filter(3u);
+    EXPECT_FALSE(filter.is_valid());
+
+    EXPECT_EQ(filter.update(100), 100);
+    EXPECT_TRUE(filter.is_valid());
+    EXPECT_EQ(filter.value_Cx4(), 100);
+    EXPECT_EQ(filter.sample_count(), 1u);
+
+    filter.reset();
+    EXPECT_FALSE(filter.is_valid());
+    EXPECT_EQ(filter.update(-20), -20);
+}
+
+TEST(TemperatureFilter, StepResponse)
+{
+    utility::temperature_filter filter(2u);
+    filter.update(0);
+
+    // Each sample closes 1/4 of the remaining difference.
+    EXPECT_EQ(filter.update(64), 16);
+    EXPECT_EQ(filter.update(64), 28);
+    EXPECT_EQ(filter.update(64), 37);
+
+    for (int sample = 0; sample < 64; ++sample) { filter.update(64); }
+    EXPECT_EQ(filter.value_Cx4(), 64);
+}
+
+TEST(TemperatureFilter, NegativeStepConverges)
+{
+    utility::temperature_filter filter(3u);
+    filter.update(100);
+    for (int sample = 0; sample < 200; ++sample) { filter.update(-160); }
+    EXPECT_EQ(filter.value_Cx4(), -160);
+}
+
+TEST(TemperatureFilter, SmallStepsAreNotLost)
+{
+    // A 0.25 C step is smaller than 1/2^shift in Cx4 units;
+    // the Q16 state still tracks it.
+    utility::temperature_filter filter(4u);
+    filter.update(100);
+    for (int sample = 0; sample < 100; ++sample) { filter.update(101); }
+    EXPECT_EQ(filter.value_Cx4(), 101);
+}
+
+TEST(TemperatureFilter, SingleOutlierIsAttenuated)
+{
+    utility::temperature_filter filter(3u);
+    filter.update(100);
+    EXPECT_EQ(filter.update(180), 110);
+    EXPECT_LT(filter.update(100), 110);
+}
+
+namespace
+{
+
+utility::compensation_point const curve_points[] = {
+    { -40 * 4,  1000 },
+    {  25 * 4,     0 },
+    {  85 * 4, -3000 },
+};
+
+} // anonymous namespace
+
+TEST(CompensationCurve, Points)
+{
+    utility::compensation_curve const curve(curve_points, std::size(curve_points));
+
+    EXPECT_EQ(curve.evaluate(-40 * 4),  1000);
+    EXPECT_EQ(curve.evaluate( 25 * 4),     0);
+    EXPECT_EQ(curve.evaluate( 85 * 4), -3000);
+}
+
+TEST(CompensationCurve, Interpolates)
+{
+    utility::compensation_curve const curve(curve_points, std::size(curve_points));
+
+    // Halfway between the points: 55 C is halfway from 25 C to 85 C.
+    EXPECT_EQ(curve.evaluate(55 * 4), -1500);
+
+    // Quarter degree resolution: 1000 / 260 per 0.25 C below 25 C,
+    // truncated toward the colder point.
+    EXPECT_EQ(curve.evaluate(25 * 4 - 26), 100);
+    EXPECT_EQ(curve.evaluate(25 * 4 - 1), 4);
+}
+
+TEST(CompensationCurve, FlatBeyondEnds)
+{
+    utility::compensation_curve const curve(curve_points, std::size(curve_points));
+
+    EXPECT_EQ(curve.evaluate(-55 * 4),  1000);
+    EXPECT_EQ(curve.evaluate(125 * 4), -3000);
+}
+
+TEST(CompensationCurve, SinglePoint)
+{
+    utility::compensation_point const point[] = { { 0, 42 } };
+    utility::compensation_curve const curve(point, std::size(point));
+
+    EXPECT_EQ(curve.evaluate(-100), 42);
+    EXPECT_EQ(curve.evaluate(0),    42);
+    EXPECT_EQ(curve.evaluate(100),  42);
+}
+
+TEST(CrystalDrift, Parabola)
+{
+    EXPECT_EQ(utility::crystal_drift_ppb(utility::crystal_turnover_Cx4), 0);
+
+    // -0.034 ppm / C^2: 10 C away is -3.4 ppm on either side.
+    EXPECT_EQ(utility::crystal_drift_ppb(35 * 4), -3400);
+    EXPECT_EQ(utility::crystal_drift_ppb(15 * 4), -3400);
+
+    // -40 C is 65 C from turnover: -143.65 ppm.
+    EXPECT_EQ(utility::crystal_drift_ppb(-40 * 4), -143650);
+
+    // 0.25 C resolution: 0.5 C from turnover is -8.5 ppb.
+    EXPECT_EQ(utility::crystal_drift_ppb(25 * 4 + 2), -8);
+}
+
+TEST(CrystalDrift, Parameters)
+{
+    EXPECT_EQ(utility::crystal_drift_ppb(20 * 4, 20 * 4, 40), 0);
+    EXPECT_EQ(utility::crystal_drift_ppb(30 * 4, 20 * 4, 40), -4000);
+}
+
+TEST(GainApply, Unity)
+{
+    EXPECT_EQ(utility::gain_apply(0,     utility::gain_unity_q16), 0);
+    EXPECT_EQ(utility::gain_apply(1234,  utility::gain_unity_q16), 1234);
+    EXPECT_EQ(utility::gain_apply(-1234, utility::gain_unity_q16), -1234);
+    EXPECT_EQ(utility::gain_apply(INT16_MAX, utility::gain_unity_q16), INT16_MAX);
+    EXPECT_EQ(utility::gain_apply(INT16_MIN, utility::gain_unity_q16), INT16_MIN);
+}
+
+TEST(GainApply, Rounds)
+{
+    int32_t const gain_q16 = utility::gain_unity_q16 + utility::gain_unity_q16 / 1000;
+
+    // 0.1% of 2000 is 2; of 1499 is 1.499.
+    EXPECT_EQ(utility::gain_apply(2000, gain_q16), 2002);
+    EXPECT_EQ(utility::gain_apply(1499, gain_q16), 1500);
+    EXPECT_EQ(utility::gain_apply(-2000, gain_q16), -2002);
+
+    // Half of 3 rounds up.
+    EXPECT_EQ(utility::gain_apply(3, utility::gain_unity_q16 / 2), 2);
+}
+
+TEST(GainApply, Saturates)
+{
+    int32_t const gain_q16 = utility::gain_unity_q16 * 2;
+
+    EXPECT_EQ(utility::gain_apply(20000,  gain_q16), INT16_MAX);
+    EXPECT_EQ(utility::gain_apply(-20000, gain_q16), INT16_MIN);
+    EXPECT_EQ(utility::gain_apply(10000,  gain_q16), 20000);
+}
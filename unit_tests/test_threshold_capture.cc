@@ -0,0 +1,507 @@
+/**
+ * @file test_threshold_capture.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "threshold_capture.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * A register model of the SAADC in ring mode: the RESULT.PTR write
+ * position, RESULT.AMOUNT, the latched EVENTS_END wrap indication and the
+ * per-channel limit comparison, paced by the slow RTC TICK event.
+ */
+class saadc_model: public threshold_capture_hooks
+{
+public:
+    enum class mode { idle, ring, fast };
+
+    explicit saadc_model(std::size_t channel_count) :
+        capture(nullptr),
+        channel_count_(channel_count),
+        mode_(mode::idle),
+        ring_(nullptr),
+        ring_length_(0u),
+        amount_(0u),
+        events_end_(false),
+        limits_(nullptr),
+        ticks_(0u),
+        ring_start_count(0u),
+        capture_start_count(0u),
+        capture_stop_count(0u)
+    {
+    }
+
+    virtual void ring_start(int16_t*                ring,
+                            std::size_t             ring_length,
+                            threshold_limits const* limits,
+                            std::size_t             channel_count) override
+    {
+        EXPECT_EQ(this->mode_, mode::idle);
+        EXPECT_EQ(channel_count, this->channel_count_);
+        EXPECT_EQ(ring_length % channel_count, 0u);
+
+        this->mode_         = mode::ring;
+        this->ring_         = ring;
+        this->ring_length_  = ring_length;
+        this->limits_       = limits;
+        this->amount_       = 0u;
+        this->events_end_   = false;
+        this->ticks_        = 0u;
+        this->ring_start_count += 1u;
+    }
+
+    virtual ring_position ring_stop() override
+    {
+        EXPECT_EQ(this->mode_, mode::ring);
+        this->mode_ = mode::idle;
+        return ring_position{this->amount_, this->events_end_, this->ticks_};
+    }
+
+    virtual void capture_start() override
+    {
+        EXPECT_EQ(this->mode_, mode::idle);
+        this->mode_ = mode::fast;
+        this->capture_start_count += 1u;
+    }
+
+    virtual void capture_stop() override
+    {
+        EXPECT_EQ(this->mode_, mode::fast);
+        this->mode_ = mode::idle;
+        this->capture_stop_count += 1u;
+    }
+
+    /**
+     * One RTC TICK while armed: each channel is converted into the ring
+     * without CPU involvement; a limit crossing raises the SAADC interrupt
+     * once the frame has been written.
+     */
+    void slow_sample(std::vector<int16_t> const& frame)
+    {
+        ASSERT_EQ(this->mode_, mode::ring);
+        ASSERT_EQ(frame.size(), this->channel_count_);
+
+        this->ticks_ += 1u;
+
+        std::size_t crossed_channel = this->channel_count_;
+        for (std::size_t channel = 0u; channel < this->channel_count_; ++channel)
+        {
+            this->ring_[this->amount_] = frame[channel];
+            this->amount_ += 1u;
+            if (this->amount_ == this->ring_length_)
+            {
+                // EVENTS_END latches; the PPI END -> START restarts at PTR.
+                this->amount_     = 0u;
+                this->events_end_ = true;
+            }
+
+            threshold_limits const& limits = this->limits_[channel];
+            if ((frame[channel] < limits.lower) || (frame[channel] > limits.upper))
+            {
+                crossed_channel = std::min(crossed_channel, channel);
+            }
+        }
+
+        if (crossed_channel < this->channel_count_)
+        {
+            this->capture->limit_crossed(crossed_channel);
+        }
+    }
+
+    /// One fast TIMER conversion while capturing; the END interrupt fires.
+    void fast_sample(std::vector<int16_t> const& frame)
+    {
+        ASSERT_EQ(this->mode_, mode::fast);
+        ASSERT_EQ(frame.size(), this->channel_count_);
+        this->capture->frame_complete(frame.data());
+    }
+
+    /// Feed a frame at the current rate.
+    void sample(std::vector<int16_t> const& frame)
+    {
+        if (this->mode_ == mode::ring)
+        {
+            this->slow_sample(frame);
+        }
+        else
+        {
+            this->fast_sample(frame);
+        }
+    }
+
+    mode get_mode() const { return this->mode_; }
+
+    threshold_capture* capture;
+
+private:
+    std::size_t const       channel_count_;
+    mode                    mode_;
+    int16_t*                ring_;
+    std::size_t             ring_length_;
+    std::size_t             amount_;
+    bool                    events_end_;
+    threshold_limits const* limits_;
+    uint32_t                ticks_;
+
+public:
+    unsigned int            ring_start_count;
+    unsigned int            capture_start_count;
+    unsigned int            capture_stop_count;
+};
+
+std::vector<std::vector<int16_t>> delivered_frames;
+
+void frame_record(int16_t const* frame, std::size_t channel_count, void* context)
+{
+    (void) context;
+    delivered_frames.emplace_back(frame, frame + channel_count);
+}
+
+std::size_t  const ring_frames   = 4u;
+std::size_t  const channel_count = 2u;
+uint32_t     const quiet_frames  = 3u;
+
+struct threshold_fixture
+{
+    threshold_fixture() :
+        model(channel_count),
+        ring{},
+        capture(model, ring, ring_frames, channel_count, quiet_frames, frame_record)
+    {
+        delivered_frames.clear();
+        this->model.capture = &this->capture;
+        this->capture.limits_set(0u, 100, 200);
+        this->capture.limits_set(1u, -50, 50);
+    }
+
+    saadc_model         model;
+    int16_t             ring[ring_frames * channel_count];
+    threshold_capture   capture;
+};
+
+std::vector<int16_t> quiet(int16_t tag) { return std::vector<int16_t>{150, tag}; }
+std::vector<int16_t> loud(int16_t tag)  { return std::vector<int16_t>{250, tag}; }
+
+/// Reports a ring position set by the test.
+class ring_stub: public threshold_capture_hooks
+{
+public:
+    void ring_start(int16_t*, std::size_t, threshold_limits const*, std::size_t) override {}
+    ring_position ring_stop() override { return this->position; }
+    void capture_start() override {}
+    void capture_stop() override {}
+
+    ring_position position = {};
+};
+
+class threshold_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string text;
+};
+
+} // anonymous namespace
+
+TEST(ThresholdCapture, LimitsDefaultToFullRange)
+{
+    saadc_model model(channel_count);
+    int16_t ring[ring_frames * channel_count];
+    threshold_capture capture(model, ring, ring_frames, channel_count, quiet_frames, frame_record);
+
+    EXPECT_EQ(capture.limits(0u).lower, INT16_MIN);
+    EXPECT_EQ(capture.limits(1u).upper, INT16_MAX);
+    EXPECT_EQ(capture.get_state(), threshold_capture::state::stopped);
+    EXPECT_EQ(capture.wakes_per_1000_frames(), 0u);
+}
+
+TEST(ThresholdCapture, ArmedQuietSamplesDoNotWake)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+    EXPECT_EQ(fixture.model.get_mode(), saadc_model::mode::ring);
+
+    for (int16_t tag = 0; tag < 100; ++tag)
+    {
+        fixture.model.slow_sample(quiet(tag % 40));
+    }
+
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+    EXPECT_EQ(fixture.capture.stats().wake_count, 0u);
+    EXPECT_TRUE(delivered_frames.empty());
+
+    // Starting again while armed does not restart the ring.
+    fixture.capture.start();
+    EXPECT_EQ(fixture.model.ring_start_count, 1u);
+}
+
+TEST(ThresholdCapture, PretriggerBeforeWrap)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+
+    fixture.model.slow_sample(quiet(1));
+    fixture.model.slow_sample(loud(2));
+
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::capturing);
+    EXPECT_EQ(fixture.model.get_mode(), saadc_model::mode::fast);
+
+    ASSERT_EQ(delivered_frames.size(), 2u);
+    EXPECT_EQ(delivered_frames[0], quiet(1));
+    EXPECT_EQ(delivered_frames[1], loud(2));
+
+    threshold_capture::statistics const& stats = fixture.capture.stats();
+    EXPECT_EQ(stats.trigger_count,     1u);
+    EXPECT_EQ(stats.wake_count,        1u);
+    EXPECT_EQ(stats.pretrigger_frames, 2u);
+    EXPECT_EQ(stats.frames_slow,       2u);
+}
+
+TEST(ThresholdCapture, PretriggerWrappedIsOldestFirst)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+
+    for (int16_t tag = 0; tag < 10; ++tag)
+    {
+        fixture.model.slow_sample(quiet(tag));
+    }
+    fixture.model.slow_sample(loud(10));
+
+    // The ring holds the last ring_frames frames, ending with the crossing.
+    ASSERT_EQ(delivered_frames.size(), ring_frames);
+    EXPECT_EQ(delivered_frames[0], quiet(7));
+    EXPECT_EQ(delivered_frames[1], quiet(8));
+    EXPECT_EQ(delivered_frames[2], quiet(9));
+    EXPECT_EQ(delivered_frames[3], loud(10));
+
+    EXPECT_EQ(fixture.capture.stats().frames_slow, 11u);
+    EXPECT_EQ(fixture.capture.stats().pretrigger_frames, ring_frames);
+}
+
+TEST(ThresholdCapture, PretriggerWrappedAtRingEnd)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+
+    // The crossing frame is the last in the ring: AMOUNT wraps to 0.
+    for (int16_t tag = 0; tag < 7; ++tag)
+    {
+        fixture.model.slow_sample(quiet(tag));
+    }
+    fixture.model.slow_sample(loud(7));
+
+    ASSERT_EQ(delivered_frames.size(), ring_frames);
+    EXPECT_EQ(delivered_frames[0], quiet(4));
+    EXPECT_EQ(delivered_frames[3], loud(7));
+}
+
+TEST(ThresholdCapture, PartialFrameIsSkipped)
+{
+    ring_stub stub;
+    int16_t ring[ring_frames * channel_count] = { 0, 0, 1, 1, 2, 2, 3, 3 };
+    threshold_capture capture(stub, ring, ring_frames, channel_count, quiet_frames, frame_record);
+    delivered_frames.clear();
+
+    // The ring stopped between the channels of frame 2 after wrapping:
+    // frame 2 holds one new sample and one from the previous pass.
+    stub.position = threshold_capture_hooks::ring_position{5u, true, 9u};
+    capture.start();
+    capture.limit_crossed(0u);
+
+    ASSERT_EQ(delivered_frames.size(), ring_frames - 1u);
+    EXPECT_EQ(delivered_frames[0], (std::vector<int16_t>{3, 3}));
+    EXPECT_EQ(delivered_frames[1], (std::vector<int16_t>{0, 0}));
+    EXPECT_EQ(delivered_frames[2], (std::vector<int16_t>{1, 1}));
+    EXPECT_EQ(capture.stats().frames_slow, 9u);
+}
+
+TEST(ThresholdCapture, FastCaptureFallsBackWhenQuiet)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+    fixture.model.slow_sample(loud(0));
+    delivered_frames.clear();
+
+    fixture.model.fast_sample(loud(1));
+    fixture.model.fast_sample(quiet(2));
+    fixture.model.fast_sample(quiet(3));
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::capturing);
+
+    fixture.model.fast_sample(quiet(4));
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+    EXPECT_EQ(fixture.model.get_mode(), saadc_model::mode::ring);
+    EXPECT_EQ(fixture.model.capture_stop_count, 1u);
+    EXPECT_EQ(fixture.model.ring_start_count, 2u);
+
+    // Every fast frame is delivered.
+    ASSERT_EQ(delivered_frames.size(), 4u);
+    EXPECT_EQ(delivered_frames[0], loud(1));
+    EXPECT_EQ(delivered_frames[3], quiet(4));
+    EXPECT_EQ(fixture.capture.stats().frames_fast, 4u);
+}
+
+TEST(ThresholdCapture, LoudFrameRestartsQuietPeriod)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+    fixture.model.slow_sample(loud(0));
+
+    fixture.model.fast_sample(quiet(1));
+    fixture.model.fast_sample(quiet(2));
+
+    // Channel 1 is outside of its limits.
+    fixture.model.fast_sample(std::vector<int16_t>{150, 60});
+    fixture.model.fast_sample(quiet(4));
+    fixture.model.fast_sample(quiet(5));
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::capturing);
+
+    fixture.model.fast_sample(quiet(6));
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+}
+
+TEST(ThresholdCapture, RearmedRingStartsEmpty)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+
+    for (int16_t tag = 0; tag < 6; ++tag)
+    {
+        fixture.model.slow_sample(quiet(tag));
+    }
+    fixture.model.slow_sample(loud(6));
+    for (int16_t tag = 7; tag < 10; ++tag)
+    {
+        fixture.model.fast_sample(quiet(tag));
+    }
+    ASSERT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+    delivered_frames.clear();
+
+    // Stale frames from the previous pass are not delivered.
+    fixture.model.slow_sample(loud(10));
+    ASSERT_EQ(delivered_frames.size(), 1u);
+    EXPECT_EQ(delivered_frames[0], loud(10));
+    EXPECT_EQ(fixture.capture.stats().trigger_count, 2u);
+}
+
+TEST(ThresholdCapture, IgnoresEventsInWrongState)
+{
+    threshold_fixture fixture;
+
+    fixture.capture.limit_crossed(0u);
+    fixture.capture.frame_complete(loud(0).data());
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::stopped);
+
+    fixture.capture.start();
+    fixture.capture.frame_complete(loud(0).data());
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+
+    fixture.model.slow_sample(loud(1));
+    fixture.capture.limit_crossed(0u);
+    EXPECT_EQ(fixture.model.capture_start_count, 1u);
+    EXPECT_EQ(fixture.capture.stats().trigger_count, 1u);
+    EXPECT_EQ(delivered_frames.size(), 1u);
+}
+
+TEST(ThresholdCapture, StopFromEachState)
+{
+    threshold_fixture fixture;
+
+    fixture.capture.stop();
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::stopped);
+
+    fixture.capture.start();
+    fixture.model.slow_sample(quiet(0));
+    fixture.model.slow_sample(quiet(1));
+    fixture.capture.stop();
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::stopped);
+    EXPECT_EQ(fixture.model.get_mode(), saadc_model::mode::idle);
+    EXPECT_EQ(fixture.capture.stats().frames_slow, 2u);
+
+    fixture.capture.start();
+    fixture.model.slow_sample(loud(2));
+    fixture.capture.stop();
+    EXPECT_EQ(fixture.capture.get_state(), threshold_capture::state::stopped);
+    EXPECT_EQ(fixture.model.get_mode(), saadc_model::mode::idle);
+    EXPECT_EQ(fixture.model.capture_stop_count, 1u);
+}
+
+TEST(ThresholdCapture, WakesPerSampleRatio)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+
+    // A quiet signal with one event: 1000 slow frames, one crossing,
+    // 10 loud fast frames and the quiet period which ends the capture.
+    for (int frame = 0; frame < 999; ++frame)
+    {
+        fixture.model.sample(quiet(0));
+    }
+    fixture.model.sample(loud(0));
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        fixture.model.sample(loud(0));
+    }
+    for (uint32_t frame = 0; frame < quiet_frames; ++frame)
+    {
+        fixture.model.sample(quiet(0));
+    }
+    ASSERT_EQ(fixture.capture.get_state(), threshold_capture::state::armed);
+
+    for (int frame = 0; frame < 987; ++frame)
+    {
+        fixture.model.sample(quiet(0));
+    }
+    fixture.capture.stop();
+
+    threshold_capture::statistics const& stats = fixture.capture.stats();
+    EXPECT_EQ(stats.frames_slow, 1987u);
+    EXPECT_EQ(stats.frames_fast, 13u);
+    EXPECT_EQ(stats.wake_count,  14u);
+
+    // Interrupting every frame is 1000 wakes per 1000 frames.
+    EXPECT_EQ(fixture.capture.wakes_per_1000_frames(), 7u);
+}
+
+TEST(ThresholdCapture, Dump)
+{
+    threshold_fixture fixture;
+    fixture.capture.start();
+    fixture.model.slow_sample(quiet(0));
+    fixture.model.slow_sample(loud(1));
+    fixture.model.fast_sample(quiet(2));
+
+    threshold_stream stream;
+    logger           dump_logger;
+    dump_logger.set_output_stream(stream);
+    dump_logger.set_level(logger::level::info);
+
+    fixture.capture.dump(dump_logger);
+
+    EXPECT_NE(stream.text.find("threshold: triggers: 1, pre-trigger frames: 2, wakes: 2"),
+              std::string::npos);
+    EXPECT_NE(stream.text.find("threshold: frames: slow: 2, fast: 1, wakes per 1000: 666"),
+              std::string::npos);
+}
@@ -0,0 +1,197 @@
+/**
+ * @file test_twis_register_map.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "twis_register_map.h"
+#include "twis_register_model.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+struct device_registers
+{
+    uint8_t     control;
+    uint16_t    threshold;
+    uint8_t     mode;
+    uint8_t     coefficients[8u];
+    uint8_t     status;             // Read only from status.
+    uint8_t     device_id;
+} __attribute__((packed));
+
+constexpr std::size_t const writable_length = offsetof(device_registers, status);
+constexpr std::size_t const write_max       = 8u;
+
+class TwisRegisterMap : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        this->registers            = device_registers{};
+        this->registers.status     = 0x5Au;
+        this->registers.device_id  = 0xA5u;
+        this->register_map.assign(&this->registers, sizeof(this->registers), writable_length);
+    }
+
+    void isr()
+    {
+        twis_register_range_t const dirty = this->register_map.irq_handler(this->twis_registers);
+        if (dirty.begin != dirty.end) { this->dirty_ranges.push_back(dirty); }
+    }
+
+    uint8_t const* register_bytes() const {
+        return reinterpret_cast<uint8_t const*>(&this->registers);
+    }
+
+    device_registers                        registers;
+    twis_register_map<write_max>            register_map;
+    twis_registers_model                    twis_registers = {};
+    std::vector<twis_register_range_t>      dirty_ranges;
+
+    twis_master_model<std::function<void()>> master{this->twis_registers, [this]() { this->isr(); }};
+};
+
+} // anonymous namespace
+
+TEST_F(TwisRegisterMap, WriteSetsRegisters)
+{
+    uint8_t const write[] = { offsetof(device_registers, threshold), 0x34u, 0x12u, 0x07u };
+    EXPECT_EQ(this->master.write(write, sizeof(write)), sizeof(write));
+
+    uint16_t const threshold = this->registers.threshold;
+    EXPECT_EQ(threshold, 0x1234u);
+    EXPECT_EQ(this->registers.mode, 0x07u);
+    EXPECT_EQ(this->register_map.pointer(), offsetof(device_registers, coefficients));
+
+    ASSERT_EQ(this->dirty_ranges.size(), 1u);
+    EXPECT_EQ(this->dirty_ranges[0].begin, offsetof(device_registers, threshold));
+    EXPECT_EQ(this->dirty_ranges[0].end,   offsetof(device_registers, coefficients));
+    EXPECT_EQ(this->register_map.statistics().write_count, 1u);
+}
+
+TEST_F(TwisRegisterMap, AddressThenRepeatedStartRead)
+{
+    this->registers.coefficients[0] = 0x11u;
+    this->registers.coefficients[1] = 0x22u;
+
+    uint8_t const address = offsetof(device_registers, coefficients);
+    bool const repeated_start = false;
+    this->master.write(&address, sizeof(address), repeated_start);
+
+    // The read is sent by DMA directly out of the register file.
+    std::array<uint8_t, 2u> read;
+    this->master.read(read.data(), read.size());
+    EXPECT_EQ(this->twis_registers.TXD.PTR,
+              reinterpret_cast<uintptr_t>(this->register_bytes() + address));
+    EXPECT_EQ(read[0], 0x11u);
+    EXPECT_EQ(read[1], 0x22u);
+
+    // Setting the address alone does not notify the application.
+    EXPECT_TRUE(this->dirty_ranges.empty());
+    EXPECT_EQ(this->register_map.pointer(), address + read.size());
+    EXPECT_EQ(this->register_map.statistics().write_count, 1u);
+    EXPECT_EQ(this->register_map.statistics().read_count, 1u);
+}
+
+TEST_F(TwisRegisterMap, ReadAutoIncrements)
+{
+    for (uint8_t index = 0u; index < std::size(this->registers.coefficients); ++index)
+    {
+        this->registers.coefficients[index] = index + 1u;
+    }
+
+    uint8_t const address = offsetof(device_registers, coefficients);
+    this->master.write(&address, sizeof(address));
+
+    // Successive reads continue from the register address pointer.
+    for (uint8_t index = 0u; index < std::size(this->registers.coefficients); index += 2u)
+    {
+        std::array<uint8_t, 2u> read;
+        this->master.read(read.data(), read.size());
+        EXPECT_EQ(read[0], index + 1u);
+        EXPECT_EQ(read[1], index + 2u);
+    }
+
+    std::array<uint8_t, 2u> read;
+    this->master.read(read.data(), read.size());
+    EXPECT_EQ(read[0], 0x5Au);
+    EXPECT_EQ(read[1], 0xA5u);
+}
+
+TEST_F(TwisRegisterMap, ReadOnlyRegistersAreNotWritten)
+{
+    uint8_t const write[] = { offsetof(device_registers, coefficients) + 7u, 0x01u, 0x02u, 0x03u };
+    EXPECT_EQ(this->master.write(write, sizeof(write)), sizeof(write));
+
+    EXPECT_EQ(this->registers.coefficients[7], 0x01u);
+    EXPECT_EQ(this->registers.status,    0x5Au);
+    EXPECT_EQ(this->registers.device_id, 0xA5u);
+
+    // The dirty range excludes the read only registers.
+    ASSERT_EQ(this->dirty_ranges.size(), 1u);
+    EXPECT_EQ(this->dirty_ranges[0].begin, offsetof(device_registers, coefficients) + 7u);
+    EXPECT_EQ(this->dirty_ranges[0].end,   writable_length);
+}
+
+TEST_F(TwisRegisterMap, ReadPastEndSendsOrc)
+{
+    uint8_t const address = offsetof(device_registers, device_id);
+    this->master.write(&address, sizeof(address));
+
+    std::array<uint8_t, 3u> read;
+    this->master.read(read.data(), read.size());
+    EXPECT_EQ(read[0], 0xA5u);
+    EXPECT_EQ(read[1], 0xFFu);
+    EXPECT_EQ(read[2], 0xFFu);
+    EXPECT_EQ(this->register_map.pointer(), sizeof(device_registers));
+    EXPECT_EQ(this->register_map.statistics().error_count, 1u);
+
+    // An address beyond the register file is clamped to its end.
+    uint8_t const address_invalid = 0xF0u;
+    this->master.write(&address_invalid, sizeof(address_invalid));
+    EXPECT_EQ(this->register_map.pointer(), sizeof(device_registers));
+    this->master.read(read.data(), read.size());
+    EXPECT_EQ(read[0], 0xFFu);
+}
+
+TEST_F(TwisRegisterMap, WriteOverflow)
+{
+    std::array<uint8_t, 1u + write_max + 2u> write;
+    write[0] = offsetof(device_registers, control);
+    for (std::size_t index = 1u; index < write.size(); ++index) { write[index] = index; }
+
+    // Bytes beyond the receive buffer are NACKed.
+    EXPECT_EQ(this->master.write(write.data(), write.size()), 1u + write_max);
+    EXPECT_EQ(this->register_map.statistics().error_count, 1u);
+
+    ASSERT_EQ(this->dirty_ranges.size(), 1u);
+    EXPECT_EQ(this->dirty_ranges[0].begin, 0u);
+    EXPECT_EQ(this->dirty_ranges[0].end,   write_max);
+    for (std::size_t index = 0u; index < write_max; ++index)
+    {
+        EXPECT_EQ(this->register_bytes()[index], write[index + 1u]);
+    }
+    EXPECT_EQ(this->register_bytes()[write_max], 0u);
+}
+
+TEST_F(TwisRegisterMap, WriteRepeatedStartWrite)
+{
+    bool const repeated_start = false;
+    uint8_t const write_1[] = { offsetof(device_registers, control), 0x80u };
+    uint8_t const write_2[] = { offsetof(device_registers, mode), 0x03u };
+    this->master.write(write_1, sizeof(write_1), repeated_start);
+    this->master.write(write_2, sizeof(write_2));
+
+    EXPECT_EQ(this->registers.control, 0x80u);
+    EXPECT_EQ(this->registers.mode,    0x03u);
+    ASSERT_EQ(this->dirty_ranges.size(), 2u);
+    EXPECT_EQ(this->dirty_ranges[0].begin, offsetof(device_registers, control));
+    EXPECT_EQ(this->dirty_ranges[1].begin, offsetof(device_registers, mode));
+}
@@ -46,5 +46,8 @@ int main(int argc, char **argv)
     writef(os, "%llu, %llu, %llx, %llx\n",
             0x123456789abcdefull, 0x23456789abcdefull, 0x3456789abcdefull, 0x456789abcdefull);
 
+    writef(os, "%f, %.3e, %g, %G\n", 3.14159265, -6.02214076e23, 1e-5, 1e100);
+    writef(os, "%q16.16, %.2q8.24\n", -0x00018000, 0x00400000);
+
     return result;
 }
@@ -0,0 +1,259 @@
+/**
+ * @file test_wall_clock.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "wall_clock.h"
+#include "gregorian.h"
+#include "ble/service/current_time_service.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * @struct drifting_rtc
+ * An RTC whose crystal runs fast (positive drift) or slow by a fixed error.
+ * The true time is advanced by the test; the tick count follows it at the
+ * drifted frequency.
+ */
+struct drifting_rtc
+{
+    drifting_rtc(uint32_t nominal_hz, int32_t ppb) :
+        ticks_per_second(nominal_hz), drift_ppb(ppb), true_msec(0u)
+    {
+    }
+
+    uint64_t ticks() const
+    {
+        using uint128_t = unsigned __int128;
+        uint128_t const ticks = uint128_t(this->true_msec) * this->ticks_per_second *
+                                uint128_t(1000000000 + this->drift_ppb);
+        return static_cast<uint64_t>(ticks / (uint128_t(1000u) * 1000000000u));
+    }
+
+    /** @return uint64_t The true time in 1/256 second units. */
+    uint64_t true_256() const { return (this->true_msec * 256u) / 1000u; }
+
+    void advance_seconds(uint64_t seconds) { this->true_msec += seconds * 1000u; }
+
+    static uint64_t tick_source(void* context) {
+        return static_cast<drifting_rtc*>(context)->ticks();
+    }
+
+    uint32_t const  ticks_per_second;
+    int32_t const   drift_ppb;
+    uint64_t        true_msec;
+};
+
+/// The clock error against the true time, in 1/256 second units.
+static int64_t clock_error_256(utility::wall_clock const& clock,
+                               drifting_rtc const&        rtc,
+                               uint64_t                   epoch_256)
+{
+    return static_cast<int64_t>(clock.now_256() - epoch_256 - rtc.true_256());
+}
+
+TEST(WallClock, Nominal)
+{
+    drifting_rtc rtc(1024u, 0);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    EXPECT_FALSE(clock.is_synchronized());
+    EXPECT_EQ(clock.now_256(), 0u);
+    EXPECT_EQ(clock.rate_q32(), 1u << 30u);
+
+    rtc.advance_seconds(10u);
+    EXPECT_EQ(clock.now_256(), 10u * 256u);
+
+    // 1.5 seconds: 384 1/256 units.
+    rtc.true_msec += 1500u;
+    utility::wall_clock::time_point const time = clock.now();
+    EXPECT_EQ(time.seconds, 11u);
+    EXPECT_EQ(time.fraction_256, 128u);
+}
+
+TEST(WallClock, UpdateKeepsRemainder)
+{
+    // A tick rate which does not divide evenly into 1/256 second units.
+    utility::wall_clock clock(1000u);
+    utility::wall_clock reference(1000u);
+
+    uint64_t ticks = 0u;
+    for (unsigned int iter = 0u; iter < 10000u; ++iter)
+    {
+        ticks += 7u;
+        clock.update(ticks);
+    }
+
+    // Incremental updates lose nothing against a single conversion.
+    // Both are within the 32.32 rate rounding of the exact time.
+    EXPECT_EQ(clock.now_256(ticks), reference.now_256(ticks));
+    EXPECT_NEAR(double(clock.now_256(ticks)), double(ticks * 256u) / 1000.0, 1.0);
+}
+
+TEST(WallClock, DriftCorrection)
+{
+    int32_t const drift_ppb = 150 * 1000;
+    drifting_rtc rtc(1024u, drift_ppb);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    utility::gregorian const greg_epoch(2018u, utility::gregorian::November, 23u, 12u, 0u, 0u);
+    uint64_t const epoch_seconds = utility::gregorian::seconds_since_epoch(greg_epoch);
+    uint64_t const epoch_256     = epoch_seconds * 256u;
+
+    // The first synchronization steps the time; no drift is known.
+    EXPECT_FALSE(clock.synchronize(epoch_seconds, 0u));
+    EXPECT_TRUE(clock.is_synchronized());
+    EXPECT_EQ(clock_error_256(clock, rtc, epoch_256), 0);
+
+    // Uncorrected, a 150 ppm fast crystal gains 0.54 seconds per hour.
+    rtc.advance_seconds(3600u);
+    int64_t const error_uncorrected = clock_error_256(clock, rtc, epoch_256);
+    EXPECT_NEAR(error_uncorrected, (3600 * 256 * 150) / 1000000, 1);
+
+    // The reference time corrects the time and measures the drift.
+    EXPECT_TRUE(clock.synchronize(epoch_seconds + 3600u, 0u));
+    EXPECT_EQ(clock.last_offset_256(), -error_uncorrected);
+    EXPECT_NEAR(clock.drift_ppb(), drift_ppb, 500);
+
+    // A day later without synchronization the error is a small fraction
+    // of the uncorrected 13 seconds.
+    for (unsigned int hour = 0u; hour < 24u; ++hour)
+    {
+        rtc.advance_seconds(3600u);
+        clock.update();
+    }
+    EXPECT_LE(std::llabs(clock_error_256(clock, rtc, epoch_256)), 256 / 10);
+}
+
+TEST(WallClock, SlowCrystal)
+{
+    int32_t const drift_ppb = -40 * 1000;
+    drifting_rtc rtc(32768u, drift_ppb);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    clock.synchronize(0u, 0u);
+    rtc.advance_seconds(600u);
+    EXPECT_TRUE(clock.synchronize(600u, 0u));
+    EXPECT_NEAR(clock.drift_ppb(), drift_ppb, 100);
+
+    rtc.advance_seconds(7u * 86400u);
+    EXPECT_LE(std::llabs(clock_error_256(clock, rtc, 0u)), 256 / 10);
+}
+
+TEST(WallClock, TemperatureDrift)
+{
+    // A crystal 30 C below its turnover runs 30.6 ppm slow.
+    int32_t const drift_ppb = -30600;
+    drifting_rtc rtc(32768u, drift_ppb);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    clock.synchronize(0u, 0u);
+    clock.temperature_drift_set(drift_ppb);
+    EXPECT_EQ(clock.temperature_drift_ppb(), drift_ppb);
+
+    // Uncorrected, the clock would lose 2.6 seconds per day.
+    rtc.advance_seconds(86400u);
+    EXPECT_LE(std::llabs(clock_error_256(clock, rtc, 0u)), 256 / 10);
+}
+
+TEST(WallClock, TemperatureDriftAfterMeasurement)
+{
+    int32_t const drift_ppb = 20 * 1000;
+    drifting_rtc rtc(32768u, drift_ppb);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    // The measured drift includes the temperature drift at the time.
+    clock.temperature_drift_set(-5000);
+    clock.synchronize(0u, 0u);
+    rtc.advance_seconds(600u);
+    EXPECT_TRUE(clock.synchronize(600u, 0u));
+    EXPECT_NEAR(clock.drift_ppb(), drift_ppb, 100);
+
+    uint32_t const rate_measured = clock.rate_q32();
+    clock.temperature_drift_set(-5000);
+    EXPECT_EQ(clock.rate_q32(), rate_measured);
+
+    // A colder crystal runs slower: more time per tick.
+    clock.temperature_drift_set(-15000);
+    EXPECT_GT(clock.rate_q32(), rate_measured);
+    clock.temperature_drift_set(-5000);
+    EXPECT_EQ(clock.rate_q32(), rate_measured);
+}
+
+TEST(WallClock, ShortIntervalSteps)
+{
+    int32_t const drift_ppb = 100 * 1000;
+    drifting_rtc rtc(1024u, drift_ppb);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    clock.synchronize(0u, 0u);
+
+    // Too short to measure drift: the time is stepped only.
+    rtc.advance_seconds(30u);
+    EXPECT_FALSE(clock.synchronize(30u, 0u));
+    EXPECT_EQ(clock.drift_ppb(), 0);
+    EXPECT_EQ(clock_error_256(clock, rtc, 0u), 0);
+
+    // The measurement continues from the first synchronization.
+    rtc.advance_seconds(1000u);
+    EXPECT_TRUE(clock.synchronize(1030u, 0u));
+    EXPECT_NEAR(clock.drift_ppb(), drift_ppb, 1000);
+    EXPECT_EQ(clock.sync_count(), 3u);
+}
+
+TEST(WallClock, RejectBadReference)
+{
+    drifting_rtc rtc(1024u, 0);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    clock.synchronize(1000u, 0u);
+    rtc.advance_seconds(100u);
+
+    // The reference claims 110 seconds passed: a 10% error is not drift.
+    EXPECT_FALSE(clock.synchronize(1110u, 0u));
+    EXPECT_EQ(clock.drift_reject_count(), 1u);
+    EXPECT_EQ(clock.drift_ppb(), 0);
+    EXPECT_EQ(clock.rate_q32(), 1u << 30u);
+    EXPECT_EQ(clock.now().seconds, 1110u);
+
+    // A reference in the past restarts the measurement interval.
+    rtc.advance_seconds(100u);
+    EXPECT_FALSE(clock.synchronize(500u, 0u));
+    EXPECT_EQ(clock.now().seconds, 500u);
+}
+
+TEST(WallClock, CurrentTimeCharacteristic)
+{
+    drifting_rtc rtc(1024u, 0);
+    utility::wall_clock clock(rtc.ticks_per_second, drifting_rtc::tick_source, &rtc);
+
+    ble::service::current_time current_time;
+    current_time.set_clock(clock);
+
+    // 2018-11-23T17:45:12 + 64/256, a Friday, manual adjustment.
+    uint8_t const cts_value[] = { 0xe2u, 0x07u, 11u, 23u, 17u, 45u, 12u, 5u, 64u, 1u };
+    EXPECT_EQ(current_time.write(ble::att::op_code::write_request, 0u,
+                                 sizeof(cts_value), cts_value), sizeof(cts_value));
+
+    utility::gregorian const greg(2018u, 11u, 23u, 17u, 45u, 12u);
+    EXPECT_TRUE(current_time.date() == greg);
+    EXPECT_EQ(clock.now().seconds, utility::gregorian::seconds_since_epoch(greg));
+    EXPECT_EQ(clock.now().fraction_256, 64u);
+
+    // Reads reflect the clock as it advances.
+    rtc.advance_seconds(50u);
+    current_time.refresh();
+
+    utility::gregorian const greg_later(2018u, 11u, 23u, 17u, 46u, 2u);
+    EXPECT_TRUE(current_time.date() == greg_later);
+    EXPECT_EQ(current_time.week_day(), utility::gregorian::friday);
+    EXPECT_EQ(current_time.fraction_256(), 64u);
+    EXPECT_EQ(current_time.data_length(), 10u);
+
+    // Partial writes do not set the clock.
+    uint8_t const partial[] = { 0xe3u, 0x07u };
+    current_time.write(ble::att::op_code::write_request, 0u, sizeof(partial), partial);
+    EXPECT_EQ(clock.sync_count(), 1u);
+}
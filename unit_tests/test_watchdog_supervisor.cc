@@ -0,0 +1,310 @@
+/**
+ * @file test_watchdog_supervisor.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "gtest/gtest.h"
+#include "watchdog_supervisor.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+
+/// A simulated time source with one tick per millisecond.
+class WatchdogSupervisor : public ::testing::Test
+{
+protected:
+    static constexpr uint32_t const ticks_per_second = 1000u;
+
+    void SetUp() override
+    {
+        std::memset(&this->record, 0xA5, sizeof(this->record));
+        this->supervisor.init(this->record, ticks_get, this, ticks_per_second,
+                              feed, this);
+    }
+
+    /**
+     * When preempt_task is set the next tick read is followed by a check-in
+     * of preempt_task one tick later: an ISR preempting the reader.
+     */
+    static uint32_t ticks_get(void* context)
+    {
+        WatchdogSupervisor* const test = static_cast<WatchdogSupervisor*>(context);
+        uint32_t const ticks = test->ticks;
+
+        watchdog_supervisor::task_id const task = test->preempt_task;
+        if (task != watchdog_supervisor::task_invalid)
+        {
+            test->preempt_task = watchdog_supervisor::task_invalid;
+            test->advance(1u);
+            test->supervisor.check_in(task);
+        }
+        return ticks;
+    }
+
+    static void feed(void* context)
+    {
+        static_cast<WatchdogSupervisor*>(context)->feeds += 1u;
+    }
+
+    void advance(uint32_t msec) { this->ticks += msec; }
+
+    uint32_t            ticks = 0u;
+    uint32_t            feeds = 0u;
+    watchdog_supervisor::task_id preempt_task = watchdog_supervisor::task_invalid;
+    watchdog_record_t   record;
+    watchdog_supervisor supervisor;
+};
+
+class watchdog_stream: public io::output_stream
+{
+public:
+    std::size_t write(void const* buffer, std::size_t length) override
+    {
+        this->text.append(static_cast<char const*>(buffer), length);
+        return length;
+    }
+
+    std::size_t write_pending() const override { return 0u; }
+    std::size_t write_avail() const override { return std::numeric_limits<std::size_t>::max(); }
+    void flush() override {}
+
+    std::string text;
+};
+
+} // anonymous namespace
+
+TEST_F(WatchdogSupervisor, HealthyTasksFeed)
+{
+    watchdog_supervisor::task_id const ble  = this->supervisor.task_register("ble", 100u);
+    watchdog_supervisor::task_id const uart = this->supervisor.task_register("uart", 250u);
+    EXPECT_EQ(this->supervisor.task_count(), 2u);
+
+    for (int pass = 0; pass < 20; ++pass)
+    {
+        this->advance(50u);
+        this->supervisor.check_in(ble);
+        if (pass % 4 == 0) { this->supervisor.check_in(uart); }
+        EXPECT_TRUE(this->supervisor.supervise());
+    }
+
+    EXPECT_EQ(this->feeds, 20u);
+    EXPECT_EQ(this->supervisor.feed_count(), 20u);
+    EXPECT_FALSE(this->supervisor.is_starved());
+    EXPECT_FALSE(watchdog_record_is_valid(this->record));
+}
+
+TEST_F(WatchdogSupervisor, StarvedTaskLatchesAndStopsFeeding)
+{
+    watchdog_supervisor::task_id const ble  = this->supervisor.task_register("ble", 100u);
+    watchdog_supervisor::task_id const saadc = this->supervisor.task_register("saadc", 100u);
+
+    this->advance(60u);
+    this->supervisor.check_in(ble);
+    EXPECT_TRUE(this->supervisor.supervise());
+
+    // saadc last checked in at registration, tick 0.
+    this->advance(70u);
+    this->supervisor.check_in(ble);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_TRUE(this->supervisor.is_starved());
+    EXPECT_EQ(this->supervisor.starved_task(), saadc);
+
+    ASSERT_TRUE(watchdog_record_is_valid(this->record));
+    EXPECT_STREQ(this->record.task_name, "saadc");
+    EXPECT_EQ(this->record.ticks, 130u);
+    EXPECT_EQ(this->record.ticks_late, 30u);
+
+    // A late check-in does not recover; the device must reset.
+    this->supervisor.check_in(saadc);
+    this->advance(10u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_EQ(this->feeds, 1u);
+    EXPECT_STREQ(this->record.task_name, "saadc");
+}
+
+TEST_F(WatchdogSupervisor, DeadlineIsInclusive)
+{
+    watchdog_supervisor::task_id const ble = this->supervisor.task_register("ble", 100u);
+    (void) ble;
+
+    this->advance(100u);
+    EXPECT_TRUE(this->supervisor.supervise());
+    this->advance(1u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_EQ(this->record.ticks_late, 1u);
+}
+
+TEST_F(WatchdogSupervisor, CheckInPreemptsSupervise)
+{
+    watchdog_supervisor::task_id const saadc = this->supervisor.task_register("saadc", 100u);
+
+    // The check-in lands between supervise() reading the ticks and loading
+    // the task check-in time; it is newer than the ticks read.
+    this->advance(50u);
+    this->preempt_task = saadc;
+    EXPECT_TRUE(this->supervisor.supervise());
+    EXPECT_EQ(this->preempt_task, watchdog_supervisor::task_invalid);
+    EXPECT_FALSE(this->supervisor.is_starved());
+    EXPECT_EQ(this->feeds, 1u);
+
+    this->advance(100u);
+    EXPECT_TRUE(this->supervisor.supervise());
+    this->advance(1u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_EQ(this->record.ticks_late, 1u);
+}
+
+TEST_F(WatchdogSupervisor, SuspendedTaskIsNotSupervised)
+{
+    watchdog_supervisor::task_id const ble   = this->supervisor.task_register("ble", 100u);
+    watchdog_supervisor::task_id const saadc = this->supervisor.task_register("saadc", 100u);
+
+    this->supervisor.suspend(saadc);
+    for (int pass = 0; pass < 10; ++pass)
+    {
+        this->advance(90u);
+        this->supervisor.check_in(ble);
+        EXPECT_TRUE(this->supervisor.supervise());
+    }
+
+    // The deadline restarts on resume; the suspended time is not counted.
+    this->supervisor.resume(saadc);
+    this->advance(90u);
+    this->supervisor.check_in(ble);
+    EXPECT_TRUE(this->supervisor.supervise());
+    this->advance(20u);
+    this->supervisor.check_in(ble);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_STREQ(this->record.task_name, "saadc");
+}
+
+TEST_F(WatchdogSupervisor, TickWraparound)
+{
+    this->ticks = UINT32_MAX - 40u;
+    watchdog_supervisor::task_id const ble = this->supervisor.task_register("ble", 100u);
+
+    this->advance(80u);
+    EXPECT_LT(this->ticks, 100u);
+    EXPECT_TRUE(this->supervisor.supervise());
+    this->supervisor.check_in(ble);
+    EXPECT_EQ(this->supervisor.check_in_interval_max(ble), 80u);
+
+    this->advance(101u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    EXPECT_EQ(this->record.ticks_late, 1u);
+}
+
+TEST_F(WatchdogSupervisor, DeadlineScalesWithTickRate)
+{
+    watchdog_supervisor slow;
+    slow.init(this->record, ticks_get, this, 32768u, feed, this);
+    watchdog_supervisor::task_id const ble = slow.task_register("ble", 2000u);
+    (void) ble;
+
+    this->advance(65536u);
+    EXPECT_TRUE(slow.supervise());
+    this->advance(1u);
+    EXPECT_FALSE(slow.supervise());
+}
+
+TEST_F(WatchdogSupervisor, TimeoutRecordsSupervisor)
+{
+    watchdog_supervisor::task_id const ble = this->supervisor.task_register("ble", 100u);
+    (void) ble;
+
+    this->advance(50u);
+    this->supervisor.timeout();
+    EXPECT_EQ(this->supervisor.starved_task(), watchdog_supervisor::task_supervisor);
+    ASSERT_TRUE(watchdog_record_is_valid(this->record));
+    EXPECT_STREQ(this->record.task_name, "supervisor");
+    EXPECT_EQ(this->record.ticks, 50u);
+    EXPECT_FALSE(this->supervisor.supervise());
+}
+
+TEST_F(WatchdogSupervisor, TimeoutKeepsStarvedTask)
+{
+    watchdog_supervisor::task_id const ble = this->supervisor.task_register("ble", 100u);
+    (void) ble;
+
+    this->advance(150u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    this->advance(50u);
+    this->supervisor.timeout();
+    EXPECT_STREQ(this->record.task_name, "ble");
+    EXPECT_EQ(this->record.ticks, 150u);
+}
+
+TEST_F(WatchdogSupervisor, RecordIntegrity)
+{
+    EXPECT_FALSE(watchdog_record_is_valid(this->record));
+
+    this->supervisor.task_register("a_very_long_task_name", 10u);
+    this->advance(11u);
+    EXPECT_FALSE(this->supervisor.supervise());
+    ASSERT_TRUE(watchdog_record_is_valid(this->record));
+    EXPECT_STREQ(this->record.task_name, "a_very_long_tas");
+
+    watchdog_record_t corrupt = this->record;
+    corrupt.ticks_late ^= 1u;
+    EXPECT_FALSE(watchdog_record_is_valid(corrupt));
+
+    corrupt = this->record;
+    corrupt.task_name[0] = 'A';
+    EXPECT_FALSE(watchdog_record_is_valid(corrupt));
+
+    watchdog_record_clear(this->record);
+    EXPECT_FALSE(watchdog_record_is_valid(this->record));
+}
+
+TEST_F(WatchdogSupervisor, RegisterOverflow)
+{
+    for (std::size_t index = 0u; index < watchdog_supervisor::task_count_max; ++index)
+    {
+        EXPECT_EQ(this->supervisor.task_register("task", 100u), index);
+    }
+
+    EXPECT_EQ(this->supervisor.task_register("task", 100u), watchdog_supervisor::task_invalid);
+    EXPECT_EQ(this->supervisor.task_count(), watchdog_supervisor::task_count_max);
+}
+
+TEST_F(WatchdogSupervisor, IntervalMaxAndDump)
+{
+    watchdog_supervisor::task_id const ble   = this->supervisor.task_register("ble_pump", 2000u);
+    watchdog_supervisor::task_id const saadc = this->supervisor.task_register("saadc", 3000u);
+
+    this->advance(250u);
+    this->supervisor.check_in(ble);
+    this->advance(400u);
+    this->supervisor.check_in(ble);
+    this->advance(100u);
+    this->supervisor.check_in(ble);
+    EXPECT_EQ(this->supervisor.check_in_interval_max(ble), 400u);
+
+    // Time spent suspended does not count toward the interval.
+    this->supervisor.suspend(saadc);
+    this->advance(5000u);
+    this->supervisor.check_in(saadc);
+    EXPECT_EQ(this->supervisor.check_in_interval_max(saadc), 0u);
+
+    this->supervisor.check_in(ble);
+    EXPECT_TRUE(this->supervisor.supervise());
+
+    watchdog_stream os;
+    logger          dump_logger;
+    dump_logger.set_output_stream(os);
+    dump_logger.set_level(logger::level::info);
+    this->supervisor.dump(dump_logger);
+
+    EXPECT_NE(os.text.find("watchdog: tasks: 2, feeds: 1, starved: none"), std::string::npos);
+    EXPECT_NE(os.text.find("watchdog: ble_pump     deadline:     2000, interval max:     5000"),
+              std::string::npos);
+    EXPECT_NE(os.text.find("watchdog: saadc        deadline:     3000, interval max:        0, suspended"),
+              std::string::npos);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file twis_register_model.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A host model of the TWIS peripheral registers and the TWI master which
+ * addresses it. The ISR is called synchronously for each event raised, as
+ * the TWIS stretches the clock until the DMA is prepared.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @struct twis_registers_model
+ * The NRF_TWIS_Type registers accessed by the TWIS drivers.
+ */
+struct twis_registers_model
+{
+    struct dma_registers
+    {
+        uintptr_t PTR;
+        uint32_t  MAXCNT;
+        uint32_t  AMOUNT;
+    };
+
+    uint32_t        TASKS_PREPARERX;
+    uint32_t        TASKS_PREPARETX;
+    uint32_t        EVENTS_STOPPED;
+    uint32_t        EVENTS_ERROR;
+    uint32_t        EVENTS_WRITE;
+    uint32_t        EVENTS_READ;
+    uint32_t        ERRORSRC;
+    dma_registers   RXD;
+    dma_registers   TXD;
+};
+
+/**
+ * @class twis_master_model
+ * The TWI master performing transactions on the TWIS.
+ * @tparam isr_type A callable invoked as the TWIS ISR.
+ */
+template <typename isr_type>
+class twis_master_model
+{
+public:
+    static constexpr uint32_t const errorsrc_overflow = (1u << 0u);
+    static constexpr uint32_t const errorsrc_overread = (1u << 3u);
+
+    twis_master_model(twis_registers_model& registers, isr_type isr, uint8_t orc = 0xFFu)
+        : registers_(registers), isr_(isr), orc_(orc)
+    {
+    }
+
+    /**
+     * The master writes bytes to the slave.
+     * @param stop true to end with a stop condition; false for a repeated start.
+     * @return std::size_t The number of bytes ACKed by the slave.
+     */
+    std::size_t write(uint8_t const* data, std::size_t length, bool stop = true)
+    {
+        this->registers_.EVENTS_WRITE = 1u;
+        this->isr_();
+        if (not this->registers_.TASKS_PREPARERX) { return 0u; }
+        this->registers_.TASKS_PREPARERX = 0u;
+
+        std::size_t const amount = std::min<std::size_t>(length, this->registers_.RXD.MAXCNT);
+        std::memcpy(reinterpret_cast<void*>(this->registers_.RXD.PTR), data, amount);
+        this->registers_.RXD.AMOUNT = amount;
+
+        if (amount < length)
+        {
+            this->registers_.ERRORSRC    |= errorsrc_overflow;
+            this->registers_.EVENTS_ERROR = 1u;
+        }
+
+        this->end(stop);
+        return amount;
+    }
+
+    /**
+     * The master reads bytes from the slave; the slave sends ORC once the
+     * TXD.MAXCNT bytes have been sent.
+     */
+    void read(uint8_t* data, std::size_t length, bool stop = true)
+    {
+        this->registers_.EVENTS_READ = 1u;
+        this->isr_();
+        std::size_t amount = 0u;
+        if (this->registers_.TASKS_PREPARETX)
+        {
+            this->registers_.TASKS_PREPARETX = 0u;
+            amount = std::min<std::size_t>(length, this->registers_.TXD.MAXCNT);
+            std::memcpy(data, reinterpret_cast<void const*>(this->registers_.TXD.PTR), amount);
+        }
+        std::memset(data + amount, this->orc_, length - amount);
+        this->registers_.TXD.AMOUNT = amount;
+
+        if (amount < length)
+        {
+            this->registers_.ERRORSRC    |= errorsrc_overread;
+            this->registers_.EVENTS_ERROR = 1u;
+        }
+
+        this->end(stop);
+    }
+
+private:
+    void end(bool stop)
+    {
+        if (stop)
+        {
+            this->registers_.EVENTS_STOPPED = 1u;
+        }
+
+        if (this->registers_.EVENTS_STOPPED || this->registers_.EVENTS_ERROR)
+        {
+            this->isr_();
+        }
+    }
+
+    twis_registers_model&   registers_;
+    isr_type                isr_;
+    uint8_t                 orc_;
+};
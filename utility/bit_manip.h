@@ -8,13 +8,10 @@
 #pragma once
 
 #include <climits>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 
-#if defined __arm__
-#include "cmsis_gcc.h"
-#endif
-
 namespace bit_manip
 {
 /// When specifying a bit position, width unsigned short is sufficient.
@@ -194,31 +191,180 @@ auto value_get(int_type    int_value,
     return static_cast<int_type>(uint_value);
 }
 
-#if defined __arm__
-
+/**
+ * @{
+ * Reverse the byte order of an integer.
+ * GCC emits REV16 and REV on Cortex-M; the __REV() CMSIS intrinsics are not
+ * constexpr.
+ */
 constexpr inline uint16_t endian_swap_16(uint16_t value)
 {
-    return __REV16(value);
+    return __builtin_bswap16(value);
 }
 
-constexpr inline uint16_t endian_swap_32(uint32_t value)
+constexpr inline uint32_t endian_swap_32(uint32_t value)
 {
-    return __REV(value);
+    return __builtin_bswap32(value);
 }
 
-#else   // __arm__
+constexpr inline uint64_t endian_swap_64(uint64_t value)
+{
+    return __builtin_bswap64(value);
+}
+/** @} */
 
-constexpr inline uint16_t endian_swap_16(uint16_t value)
+/**
+ * Convert an integer between the native byte order and the little endian
+ * byte order of BLE PDUs and GATT values. On Cortex-M this is a no-op.
+ *
+ * @tparam uint_type An unsigned integer type of 1, 2, 4 or 8 bytes.
+ */
+template <typename uint_type> constexpr inline
+auto little_endian(uint_type value) -> uint_type
 {
-    return (value >> 8u) | (value << 8u);
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(sizeof(uint_type) <= sizeof(uint64_t));
+
+    return (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? value :
+           (sizeof(uint_type) == sizeof(uint8_t))  ? value :
+           (sizeof(uint_type) == sizeof(uint16_t)) ? static_cast<uint_type>(endian_swap_16(value)) :
+           (sizeof(uint_type) == sizeof(uint32_t)) ? static_cast<uint_type>(endian_swap_32(value)) :
+                                                     static_cast<uint_type>(endian_swap_64(value));
 }
 
-constexpr inline uint32_t endian_swap_32(uint32_t value)
+/**
+ * @return unsigned int The number of bits set in the value.
+ * On Cortex-M4 GCC emits a branch-free bit counting sequence.
+ */
+template <typename uint_type> constexpr inline
+unsigned int popcount(uint_type value)
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(sizeof(uint_type) <= sizeof(unsigned long long));
+
+    return (sizeof(uint_type) <= sizeof(unsigned int)) ?
+        static_cast<unsigned int>(__builtin_popcount(value)) :
+        static_cast<unsigned int>(__builtin_popcountll(value));
+}
+
+/**
+ * @return bit_width_t The number of zero bits above the most significant set
+ *         bit; the width of uint_type if value is zero.
+ * On Cortex-M this is a single CLZ instruction; CLZ returns 32 for zero so
+ * the zero check is optimized away.
+ */
+template <typename uint_type> constexpr inline
+bit_width_t count_leading_zeros(uint_type value)
 {
-    return ((value >> 24) & 0x000000ff) | ((value << 8) & 0x00ff0000) |
-           ((value << 24) & 0xff000000) | ((value >> 8) & 0x0000ff00);
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(sizeof(uint_type) <= sizeof(unsigned long long));
+
+    // Types narrower than unsigned int are promoted; discount the extra zeros.
+    constexpr bit_width_t const uint_bits     = sizeof(uint_type) * CHAR_BIT;
+    constexpr bit_width_t const promoted_bits = sizeof(unsigned int) * CHAR_BIT;
+
+    return (value == 0u) ? uint_bits :
+           (sizeof(uint_type) <= sizeof(unsigned int)) ?
+               static_cast<bit_width_t>(__builtin_clz(value) - (promoted_bits - uint_bits)) :
+               static_cast<bit_width_t>(__builtin_clzll(value));
+}
+
+/**
+ * @return bit_width_t The number of zero bits below the least significant
+ *         set bit; the width of uint_type if value is zero.
+ * On Cortex-M this is RBIT followed by CLZ.
+ */
+template <typename uint_type> constexpr inline
+bit_width_t count_trailing_zeros(uint_type value)
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(sizeof(uint_type) <= sizeof(unsigned long long));
+
+    constexpr bit_width_t const uint_bits = sizeof(uint_type) * CHAR_BIT;
+
+    return (value == 0u) ? uint_bits :
+           (sizeof(uint_type) <= sizeof(unsigned int)) ?
+               static_cast<bit_width_t>(__builtin_ctz(value)) :
+               static_cast<bit_width_t>(__builtin_ctzll(value));
 }
 
-#endif  // __arm__
+/// @return uint_type The value with all but its least significant set bit cleared.
+template <typename uint_type> constexpr inline
+auto lowest_bit(uint_type value) -> uint_type
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    return static_cast<uint_type>(value & (~value + 1u));
+}
+
+/// @return uint_type The value with its least significant set bit cleared.
+template <typename uint_type> constexpr inline
+auto lowest_bit_clear(uint_type value) -> uint_type
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    return static_cast<uint_type>(value & (value - 1u));
+}
+
+/**
+ * Extract a bit field whose position is known at compile time.
+ * Unlike value_get() there are no run time range checks; on Cortex-M this
+ * is a single UBFX instruction.
+ *
+ * @tparam bit_width  The field width.
+ * @tparam bit_pos_lo The field least significant bit position.
+ * @param  value      The value containing the field.
+ *
+ * @return uint_type The field, right justified.
+ */
+template <bit_width_t bit_width, bit_pos_t bit_pos_lo, typename uint_type> constexpr inline
+auto field_get(uint_type value) -> uint_type
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(bit_width > 0u);
+    static_assert(bit_pos_lo + bit_width <= sizeof(uint_type) * CHAR_BIT);
+
+    constexpr uint_type const mask = bit_mask<uint_type>(bit_width, 0u);
+    return static_cast<uint_type>((value >> bit_pos_lo) & mask);
+}
+
+/**
+ * Insert a bit field whose position is known at compile time.
+ * Field bits beyond bit_width are ignored. On Cortex-M this is a single BFI
+ * instruction.
+ *
+ * @tparam bit_width  The field width.
+ * @tparam bit_pos_lo The field least significant bit position.
+ * @param  value      The value into which the field is inserted.
+ * @param  field      The field value, right justified.
+ *
+ * @return uint_type The value with the field replaced.
+ */
+template <bit_width_t bit_width, bit_pos_t bit_pos_lo, typename uint_type> constexpr inline
+auto field_set(uint_type value, uint_type field) -> uint_type
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+    static_assert(bit_width > 0u);
+    static_assert(bit_pos_lo + bit_width <= sizeof(uint_type) * CHAR_BIT);
+
+    constexpr uint_type const mask = bit_mask<uint_type>(bit_width, bit_pos_lo);
+    return static_cast<uint_type>((value & ~mask) | ((field << bit_pos_lo) & mask));
+}
+
+/**
+ * Call func(bit_pos) for each bit set in bits, least significant first.
+ * The loop iterates once per set bit rather than once per bit position.
+ *
+ * @param bits The set of bits.
+ * @param func A callable taking a bit_pos_t.
+ */
+template <typename uint_type, typename func_type> constexpr inline
+void for_each_set_bit(uint_type bits, func_type&& func)
+{
+    static_assert(std::is_unsigned<uint_type>::value);
+
+    for (; bits != 0u; bits = lowest_bit_clear(bits))
+    {
+        func(static_cast<bit_pos_t>(count_trailing_zeros(bits)));
+    }
+}
 
 }  // namespace bit_manip
@@ -0,0 +1,339 @@
+/**
+ * @file block_pool.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A pool of fixed size blocks with a lock-free free list.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @class block_pool
+ * Allocate and free fixed size blocks from a caller supplied buffer in O(1).
+ *
+ * The free list is a lock-free stack. Its head packs the index of the first
+ * free block (low 16 bits) with a modification tag (high 16 bits) into a
+ * single 32-bit word updated with compare-and-swap; the tag defeats the ABA
+ * problem when an ISR allocates and frees blocks while the main loop is
+ * between reading the head and swapping it. The link to the next free block
+ * is held in the free block itself.
+ *
+ * allocate() and deallocate() may be called from any context, including an
+ * ISR, on targets with lock-free 32-bit atomics (Cortex-M3 and above).
+ *
+ * Statistics: the number of blocks in use, the high-water mark, the
+ * allocation failure count and the bytes requested through the sized
+ * interface, from which internal fragmentation is reported.
+ */
+class block_pool
+{
+public:
+    /// The maximum number of blocks; one index value marks the list end.
+    static constexpr std::size_t const block_count_max = UINT16_MAX;
+
+    ~block_pool()                               = default;
+
+    block_pool()                                = delete;
+    block_pool(block_pool const&)               = delete;
+    block_pool(block_pool &&)                   = delete;
+    block_pool& operator=(block_pool const&)    = delete;
+    block_pool& operator=(block_pool&&)         = delete;
+
+    /**
+     * @param buffer      The block storage, block_stride * block_count bytes.
+     *                    Aligned to block_stride's alignment requirement.
+     * @param block_size  The usable size of each block in bytes.
+     * @param block_count The number of blocks in the pool.
+     * @param alignment   The alignment of each block; a power of 2.
+     */
+    block_pool(void*        buffer,
+               std::size_t  block_size,
+               std::size_t  block_count,
+               std::size_t  alignment = alignof(std::max_align_t))
+    :   buffer_(static_cast<uint8_t*>(buffer)),
+        block_size_(block_size),
+        block_stride_(stride(block_size, alignment)),
+        block_count_(block_count),
+        alignment_(alignment),
+        head_(0u),
+        in_use_(0u),
+        high_water_(0u),
+        failure_count_(0u),
+        requested_bytes_(0u)
+    {
+        ASSERT(block_count <= block_count_max);
+        ASSERT((alignment & (alignment - 1u)) == 0u);
+        ASSERT((reinterpret_cast<uintptr_t>(buffer) & (alignment - 1u)) == 0u);
+        this->reset();
+    }
+
+    /**
+     * The number of bytes each block occupies in the buffer; the block size
+     * rounded up to the alignment, large enough to hold the free list link.
+     */
+    static constexpr std::size_t stride(std::size_t block_size,
+                                        std::size_t alignment)
+    {
+        std::size_t const size = (block_size < sizeof(uint16_t)) ?
+                                 sizeof(uint16_t) : block_size;
+        return (size + alignment - 1u) & ~(alignment - 1u);
+    }
+
+    /**
+     * Return all blocks to the free list.
+     * Must not be called while blocks are allocated or concurrently with
+     * allocate() or deallocate().
+     */
+    void reset()
+    {
+        for (std::size_t index = 0u; index < this->block_count_; ++index)
+        {
+            uint16_t const next = (index + 1u < this->block_count_) ?
+                                  static_cast<uint16_t>(index + 1u) : list_end;
+            this->set_link(index, next);
+        }
+
+        uint16_t const first = (this->block_count_ > 0u) ? 0u : list_end;
+        this->head_.store(first, std::memory_order_release);
+        this->in_use_.store(0u, std::memory_order_relaxed);
+        this->requested_bytes_.store(0u, std::memory_order_relaxed);
+    }
+
+    /** @return void* A free block or nullptr if the pool is exhausted. */
+    void* allocate()
+    {
+        void* const block_ptr = this->pop();
+        if (not block_ptr)
+        {
+            this->failure_count_.fetch_add(1u, std::memory_order_relaxed);
+        }
+        return block_ptr;
+    }
+
+    /** Return a block obtained from allocate() to the pool. */
+    void deallocate(void* block_ptr)
+    {
+        ASSERT(this->owns(block_ptr));
+        uint16_t const index = this->index(block_ptr);
+
+        uint32_t head = this->head_.load(std::memory_order_relaxed);
+        uint32_t next_head;
+        do
+        {
+            this->set_link(index, static_cast<uint16_t>(head));
+            next_head = next_tag(head) | index;
+        }
+        while (not this->head_.compare_exchange_weak(head, next_head,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed));
+
+        this->in_use_.fetch_sub(1u, std::memory_order_relaxed);
+    }
+
+    /**
+     * The sized interface, used by resource_allocator and slab_allocator.
+     * @return void* A block if size and alignment fit the block,
+     *               otherwise nullptr.
+     */
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        void* const block_ptr = this->try_allocate(size, alignment);
+        if (not block_ptr)
+        {
+            this->failure_count_.fetch_add(1u, std::memory_order_relaxed);
+        }
+        return block_ptr;
+    }
+
+    /**
+     * As allocate(size, alignment) but a failure is not counted; for a
+     * caller with a fallback, such as slab_allocator, which counts the
+     * failure only once every choice has failed.
+     */
+    void* try_allocate(std::size_t size, std::size_t alignment)
+    {
+        if ((size > this->block_size_) || (alignment > this->alignment_))
+        {
+            return nullptr;
+        }
+
+        void* const block_ptr = this->pop();
+        if (block_ptr)
+        {
+            this->requested_bytes_.fetch_add(size, std::memory_order_relaxed);
+        }
+        return block_ptr;
+    }
+
+    void deallocate(void* block_ptr, std::size_t size)
+    {
+        this->requested_bytes_.fetch_sub(size, std::memory_order_relaxed);
+        this->deallocate(block_ptr);
+    }
+
+    /** @return bool true if ptr is the start of a block in this pool. */
+    bool owns(void const* ptr) const
+    {
+        uint8_t const* const byte_ptr = static_cast<uint8_t const*>(ptr);
+        if ((byte_ptr < this->buffer_) ||
+            (byte_ptr >= this->buffer_ + this->block_stride_ * this->block_count_))
+        {
+            return false;
+        }
+        return ((byte_ptr - this->buffer_) % this->block_stride_) == 0u;
+    }
+
+    std::size_t block_size()   const { return this->block_size_; }
+    std::size_t block_stride() const { return this->block_stride_; }
+    std::size_t block_count()  const { return this->block_count_; }
+    std::size_t alignment()    const { return this->alignment_; }
+
+    std::size_t in_use() const {
+        return this->in_use_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t available() const { return this->block_count_ - this->in_use(); }
+
+    /** @return std::size_t The maximum number of blocks in use at once. */
+    std::size_t high_water() const {
+        return this->high_water_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t failure_count() const {
+        return this->failure_count_.load(std::memory_order_relaxed);
+    }
+
+    /** @return std::size_t The bytes requested through the sized interface. */
+    std::size_t requested_bytes() const {
+        return this->requested_bytes_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return std::size_t The bytes of the blocks in use which were not
+     * requested: the internal fragmentation of sized allocations.
+     */
+    std::size_t unused_bytes() const {
+        return this->in_use() * this->block_stride_ - this->requested_bytes();
+    }
+
+    void reset_statistics()
+    {
+        this->high_water_.store(this->in_use(), std::memory_order_relaxed);
+        this->failure_count_.store(0u, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint16_t const list_end = UINT16_MAX;
+    static constexpr uint32_t const tag_one  = 1u << 16u;
+
+    /** @return void* A free block or nullptr; a failure is not counted. */
+    void* pop()
+    {
+        uint32_t head = this->head_.load(std::memory_order_acquire);
+        uint32_t next_head;
+        do
+        {
+            uint16_t const index = static_cast<uint16_t>(head);
+            if (index == list_end)
+            {
+                return nullptr;
+            }
+
+            // The link may be stale if another context took the block after
+            // the head was read; the tag makes the swap below fail if so.
+            next_head = next_tag(head) | this->get_link(index);
+        }
+        while (not this->head_.compare_exchange_weak(head, next_head,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire));
+
+        this->in_use_increment();
+        return this->block(static_cast<uint16_t>(head));
+    }
+
+    static uint32_t next_tag(uint32_t head) {
+        return (head + tag_one) & ~uint32_t(UINT16_MAX);
+    }
+
+    void* block(uint16_t index) const {
+        return this->buffer_ + std::size_t(index) * this->block_stride_;
+    }
+
+    uint16_t index(void const* block_ptr) const {
+        return static_cast<uint16_t>(
+            (static_cast<uint8_t const*>(block_ptr) - this->buffer_) / this->block_stride_);
+    }
+
+    uint16_t get_link(uint16_t index) const
+    {
+        uint16_t link;
+        std::memcpy(&link, this->block(index), sizeof(link));
+        return link;
+    }
+
+    void set_link(std::size_t index, uint16_t link)
+    {
+        std::memcpy(this->block(static_cast<uint16_t>(index)), &link, sizeof(link));
+    }
+
+    void in_use_increment()
+    {
+        std::size_t const in_use = this->in_use_.fetch_add(1u, std::memory_order_relaxed) + 1u;
+        std::size_t high_water   = this->high_water_.load(std::memory_order_relaxed);
+        while ((in_use > high_water) &&
+               not this->high_water_.compare_exchange_weak(high_water, in_use,
+                                                           std::memory_order_relaxed))
+        {
+        }
+    }
+
+    uint8_t* const              buffer_;
+    std::size_t const           block_size_;
+    std::size_t const           block_stride_;
+    std::size_t const           block_count_;
+    std::size_t const           alignment_;
+
+    std::atomic<uint32_t>       head_;
+    std::atomic<std::size_t>    in_use_;
+    std::atomic<std::size_t>    high_water_;
+    std::atomic<uint32_t>       failure_count_;
+    std::atomic<std::size_t>    requested_bytes_;
+};
+
+/**
+ * @class fixed_block_pool
+ * A block_pool which contains its block storage.
+ *
+ * @tparam pool_block_size  The usable size of each block in bytes.
+ * @tparam pool_block_count The number of blocks.
+ * @tparam pool_alignment   The alignment of each block.
+ */
+template <std::size_t pool_block_size,
+          std::size_t pool_block_count,
+          std::size_t pool_alignment = alignof(std::max_align_t)>
+class fixed_block_pool: public block_pool
+{
+public:
+    ~fixed_block_pool()                                     = default;
+
+    fixed_block_pool(fixed_block_pool const&)               = delete;
+    fixed_block_pool(fixed_block_pool &&)                   = delete;
+    fixed_block_pool& operator=(fixed_block_pool const&)    = delete;
+    fixed_block_pool& operator=(fixed_block_pool&&)         = delete;
+
+    fixed_block_pool() :
+        block_pool(storage_, pool_block_size, pool_block_count, pool_alignment)
+    {
+    }
+
+private:
+    alignas(pool_alignment)
+    uint8_t storage_[block_pool::stride(pool_block_size, pool_alignment) * pool_block_count];
+};
@@ -0,0 +1,213 @@
+/**
+ * @file event_dispatch_table.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A per-event dispatch table for demultiplexing events to observers.
+ * Each observer registers a bitmask of the event indices it is interested in.
+ * The table holds, for each event index, a bitmask of the observer slots
+ * which want that event. Dispatching an event visits only those observers.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <type_traits>
+
+/**
+ * @class event_dispatch_table
+ *
+ * @tparam observer_type  The observer type dispatched to.
+ * @tparam event_count    The number of event indices [0:event_count).
+ *                        Limited to 32 so that an event mask fits in uint32_t.
+ * @tparam observer_max   The number of observer slots in the table.
+ *
+ * @note Observer slot order is the dispatch order. Slots are assigned by
+ * insert() and are not compacted by remove(); this allows an observer to be
+ * removed while the table is being dispatched. Call clear() and re-insert all
+ * observers to compact the table.
+ */
+template <typename observer_type,
+          std::size_t event_count,
+          std::size_t observer_max = 8u>
+class event_dispatch_table
+{
+public:
+    static_assert(event_count  <= 32u);
+    static_assert(observer_max <= 32u);
+
+    using event_mask_t    = uint32_t;
+    using observer_mask_t =
+        std::conditional_t<(observer_max <= 8u),  uint8_t,
+        std::conditional_t<(observer_max <= 16u), uint16_t, uint32_t> >;
+
+    /// The event mask which selects all event indices.
+    static constexpr event_mask_t const all_events =
+        (event_count < sizeof(event_mask_t) * CHAR_BIT) ?
+        ((event_mask_t(1u) << event_count) - 1u) : ~event_mask_t(0u);
+
+    /**
+     * @class iterator
+     * Iterate over the observers interested in a single event index.
+     * The set of observers is determined when the iterator is created;
+     * observers removed during iteration are skipped.
+     */
+    class iterator
+    {
+    public:
+        ~iterator()                                 = default;
+        iterator(iterator const&)                   = default;
+        iterator(iterator&&)                        = default;
+        iterator& operator=(iterator const&)        = default;
+        iterator& operator=(iterator&&)             = default;
+
+        observer_type& operator*() const
+        {
+            return *this->table_->observers_[__builtin_ctz(this->pending())];
+        }
+
+        iterator& operator++()
+        {
+            observer_mask_t const pending = this->pending();
+            this->remaining_ = pending & (pending - 1u);
+            return *this;
+        }
+
+        bool operator==(iterator const& other) const {
+            return this->pending() == other.pending();
+        }
+
+        bool operator!=(iterator const& other) const {
+            return not (*this == other);
+        }
+
+    private:
+        iterator(event_dispatch_table const* table,
+                 std::size_t                 event_index,
+                 observer_mask_t             remaining)
+            : table_(table), event_index_(event_index), remaining_(remaining) {}
+
+        /**
+         * The observers not yet visited which are still in the table.
+         * Observers removed from the table since the iterator was created
+         * are dropped here.
+         */
+        observer_mask_t pending() const
+        {
+            return this->remaining_ &
+                   this->table_->event_observers_[this->event_index_];
+        }
+
+        event_dispatch_table const* table_;
+        std::size_t                 event_index_;
+        observer_mask_t             remaining_;
+
+        friend class event_dispatch_table;
+    };
+
+    ~event_dispatch_table()                                         = default;
+    event_dispatch_table(event_dispatch_table const&)               = delete;
+    event_dispatch_table(event_dispatch_table&&)                    = delete;
+    event_dispatch_table& operator=(event_dispatch_table const&)    = delete;
+    event_dispatch_table& operator=(event_dispatch_table&&)         = delete;
+
+    event_dispatch_table() : observers_{}, event_observers_{},
+                             dispatch_counters_{}, slot_count_(0u) {}
+
+    /** Remove all observers from the table. Dispatch counters are retained. */
+    void clear()
+    {
+        for (observer_type*& observer : this->observers_) { observer = nullptr; }
+        for (observer_mask_t& mask : this->event_observers_) { mask = 0u; }
+        this->slot_count_ = 0u;
+    }
+
+    /**
+     * Insert an observer into the next available slot.
+     *
+     * @param observer   The observer to dispatch events to.
+     * @param event_mask The bitmask of event indices the observer wants.
+     */
+    void insert(observer_type& observer, event_mask_t event_mask)
+    {
+        ASSERT(this->slot_count_ < observer_max);
+        std::size_t const slot = this->slot_count_++;
+        this->observers_[slot] = &observer;
+
+        observer_mask_t const slot_bit = observer_mask_t(1u) << slot;
+        event_mask &= all_events;
+        while (event_mask)
+        {
+            this->event_observers_[__builtin_ctz(event_mask)] |= slot_bit;
+            event_mask &= event_mask - 1u;
+        }
+    }
+
+    /**
+     * Remove an observer from the table.
+     * The slot which the observer occupied is left vacant.
+     */
+    void remove(observer_type const& observer)
+    {
+        for (std::size_t slot = 0u; slot < this->slot_count_; ++slot)
+        {
+            if (this->observers_[slot] == &observer)
+            {
+                observer_mask_t const slot_bit = observer_mask_t(1u) << slot;
+                for (observer_mask_t& mask : this->event_observers_)
+                {
+                    mask &= ~slot_bit;
+                }
+                this->observers_[slot] = nullptr;
+            }
+        }
+    }
+
+    /**
+     * Begin dispatching an event; increments the event's dispatch counter.
+     *
+     * @param event_index The event index [0:event_count).
+     *                    Out of range indices dispatch to no observers.
+     * @return iterator   The first observer interested in the event.
+     */
+    iterator dispatch_begin(std::size_t event_index)
+    {
+        if (event_index >= event_count)
+        {
+            return this->end();
+        }
+
+        this->dispatch_counters_[event_index] += 1u;
+        return iterator(this, event_index, this->event_observers_[event_index]);
+    }
+
+    iterator end() const { return iterator(this, 0u, 0u); }
+
+    /** @return uint32_t The number of times the event index was dispatched. */
+    uint32_t dispatch_count(std::size_t event_index) const
+    {
+        return (event_index < event_count) ?
+            this->dispatch_counters_[event_index] : 0u;
+    }
+
+    /** @return std::size_t The number of observers the event index reaches. */
+    std::size_t observer_count(std::size_t event_index) const
+    {
+        return (event_index < event_count) ?
+            __builtin_popcount(this->event_observers_[event_index]) : 0u;
+    }
+
+    void reset_counters()
+    {
+        for (uint32_t& counter : this->dispatch_counters_) { counter = 0u; }
+    }
+
+private:
+    observer_type*  observers_[observer_max];
+    observer_mask_t event_observers_[event_count];
+    uint32_t        dispatch_counters_[event_count];
+    std::size_t     slot_count_;
+};
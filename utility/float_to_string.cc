@@ -0,0 +1,785 @@
+/**
+ * @file float_to_string.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Double to decimal conversions using integer arithmetic only.
+ *
+ * The shortest digits are found with Grisu2:
+ * Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+ * with Integers", PLDI 2010.
+ *
+ * Digits at a requested precision are taken from the shortest digits when
+ * those are provably the correctly rounded result. Otherwise the digits are
+ * generated exactly from the binary value with big integer arithmetic, as
+ * Steele & White's Dragon4; this is the slow path.
+ */
+
+#include "float_to_string.h"
+#include "bit_manip.h"
+#include "project_assert.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace
+{
+
+/// A double as significand * 2^exponent; the significand is an integer.
+struct double_binary
+{
+    uint64_t    significand;
+    int         exponent;
+
+    /// The next lower double is closer than the next higher double.
+    bool        lower_boundary_closer;
+};
+
+constexpr unsigned int const double_fraction_bits = 52u;
+constexpr uint64_t     const double_hidden_bit    = uint64_t(1u) << double_fraction_bits;
+constexpr int          const double_exponent_bias = 1023 + double_fraction_bits;
+
+double_binary double_decompose(double value)
+{
+    uint64_t bits = 0u;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint64_t const fraction = bits & (double_hidden_bit - 1u);
+    int      const biased   = static_cast<int>((bits >> double_fraction_bits) & 0x7FFu);
+
+    // Subnormals have no hidden bit and the minimum exponent.
+    double_binary const binary = {
+        .significand            = (biased == 0) ? fraction : (fraction | double_hidden_bit),
+        .exponent               = ((biased == 0) ? 1 : biased) - double_exponent_bias,
+        .lower_boundary_closer  = (fraction == 0u) && (biased > 1),
+    };
+
+    return binary;
+}
+
+/**
+ * @return bool true if 2^binary_exponent < 10^decimal_position.
+ * May return false when true; never true when false.
+ */
+bool binary_unit_below(int binary_exponent, int decimal_position)
+{
+    // floor(binary_exponent * log10(2)), or one less, for |binary_exponent| < 1650.
+    // The arithmetic shift right of a negative value rounds toward -infinity.
+    int const decimal_floor = (binary_exponent * 78913) >> 18;
+    return decimal_floor + 2 <= decimal_position;
+}
+
+/// Remove trailing zero digits; they are implied.
+void decimal_digits_trim(decimal_digits& result)
+{
+    while ((result.count > 0u) && (result.digits[result.count - 1u] == '0'))
+    {
+        result.count -= 1u;
+    }
+}
+
+/**
+ * Add one to the least significant digit, which is the 10^position digit.
+ * When there are no digits the result is 10^position.
+ */
+void decimal_digits_increment(decimal_digits& result, int position)
+{
+    int index = static_cast<int>(result.count) - 1;
+    for ( ; (index >= 0) && (result.digits[index] == '9'); --index)
+    {
+        result.digits[index] = '0';
+    }
+
+    if (index >= 0)
+    {
+        result.digits[index] += 1;
+    }
+    else
+    {
+        // All nines carried out, or there were no digits.
+        result.exponent  = (result.count == 0u) ? position : result.exponent + 1;
+        result.digits[0] = '1';
+        result.count     = 1u;
+    }
+
+    decimal_digits_trim(result);
+}
+
+/**
+ * Round the shortest digits of a value to count digits when that provably
+ * equals rounding the value itself.
+ *
+ * The value is within 1/2 binary unit of the shortest digits. When the
+ * discarded shortest digits are further than that from the half way point
+ * the value rounds the same way.
+ *
+ * @param binary_exponent The exponent of the value's binary unit.
+ * @param count The number of digits to keep; less than result.count.
+ * @return bool true if rounded; false if the exact digits are required.
+ */
+bool decimal_digits_round(decimal_digits& result, int binary_exponent, int count)
+{
+    int const discard_count = static_cast<int>(result.count) - count;
+    if ((count < 1) || (discard_count < 1) || (discard_count > 19))
+    {
+        return false;
+    }
+
+    uint64_t discarded = 0u;
+    uint64_t half      = 5u;
+    for (int index = count; index < result.count; ++index)
+    {
+        discarded = discarded * 10u + (result.digits[index] - '0');
+        half     *= (index > count) ? 10u : 1u;
+    }
+
+    // 1/2 binary unit < 10^(decimal_floor + 2); in units of the last digit.
+    int const last_position = result.exponent - static_cast<int>(result.count) + 1;
+    int const margin_power  = ((binary_exponent * 78913) >> 18) + 2 - last_position;
+    if (margin_power >= discard_count)
+    {
+        return false;
+    }
+
+    uint64_t margin = 1u;
+    for (int power = 0; power < margin_power; ++power) { margin *= 10u; }
+
+    uint64_t const distance = (discarded > half) ? discarded - half : half - discarded;
+    if (distance < margin)
+    {
+        return false;
+    }
+
+    result.count = static_cast<uint8_t>(count);
+    if (discarded > half)
+    {
+        decimal_digits_increment(result, result.exponent - count + 1);
+    }
+    else
+    {
+        decimal_digits_trim(result);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Grisu2
+
+/// A 'do it yourself' floating point value: f * 2^e.
+struct diy_fp
+{
+    uint64_t    f;
+    int         e;
+};
+
+/// @return diy_fp The rounded upper 64 bits of the 128 bit product.
+diy_fp diy_fp_multiply(diy_fp x, diy_fp y)
+{
+    uint64_t const x_lo = x.f & UINT32_MAX;
+    uint64_t const x_hi = x.f >> 32u;
+    uint64_t const y_lo = y.f & UINT32_MAX;
+    uint64_t const y_hi = y.f >> 32u;
+
+    uint64_t const p0 = x_lo * y_lo;
+    uint64_t const p1 = x_lo * y_hi;
+    uint64_t const p2 = x_hi * y_lo;
+    uint64_t const p3 = x_hi * y_hi;
+
+    uint64_t const middle = (p0 >> 32u) + (p1 & UINT32_MAX) + (p2 & UINT32_MAX) +
+                            (uint64_t(1u) << 31u);      // Round to nearest.
+
+    diy_fp const product = {
+        .f = p3 + (p1 >> 32u) + (p2 >> 32u) + (middle >> 32u),
+        .e = x.e + y.e + 64,
+    };
+
+    return product;
+}
+
+diy_fp diy_fp_normalize(diy_fp x)
+{
+    int const shift = bit_manip::count_leading_zeros(x.f);
+    return diy_fp{x.f << shift, x.e - shift};
+}
+
+diy_fp diy_fp_normalize_to(diy_fp x, int e)
+{
+    return diy_fp{x.f << (x.e - e), e};
+}
+
+/// The scaled product exponent range; the integer part fits in 32 bits.
+constexpr int const grisu_alpha = -60;
+constexpr int const grisu_gamma = -32;
+
+/// 10^k ~= f * 2^e; f normalized.
+struct cached_power
+{
+    uint64_t    f;
+    int16_t     e;
+    int16_t     k;
+};
+
+constexpr int const cached_power_k_min  = -300;
+constexpr int const cached_power_k_step =    8;
+
+constexpr cached_power const cached_powers[] = {
+    { 0xAB70FE17C79AC6CAu, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4Fu, -1034, -292 },
+    { 0xBE5691EF416BD60Cu, -1007, -284 },
+    { 0x8DD01FAD907FFC3Cu,  -980, -276 },
+    { 0xD3515C2831559A83u,  -954, -268 },
+    { 0x9D71AC8FADA6C9B5u,  -927, -260 },
+    { 0xEA9C227723EE8BCBu,  -901, -252 },
+    { 0xAECC49914078536Du,  -874, -244 },
+    { 0x823C12795DB6CE57u,  -847, -236 },
+    { 0xC21094364DFB5637u,  -821, -228 },
+    { 0x9096EA6F3848984Fu,  -794, -220 },
+    { 0xD77485CB25823AC7u,  -768, -212 },
+    { 0xA086CFCD97BF97F4u,  -741, -204 },
+    { 0xEF340A98172AACE5u,  -715, -196 },
+    { 0xB23867FB2A35B28Eu,  -688, -188 },
+    { 0x84C8D4DFD2C63F3Bu,  -661, -180 },
+    { 0xC5DD44271AD3CDBAu,  -635, -172 },
+    { 0x936B9FCEBB25C996u,  -608, -164 },
+    { 0xDBAC6C247D62A584u,  -582, -156 },
+    { 0xA3AB66580D5FDAF6u,  -555, -148 },
+    { 0xF3E2F893DEC3F126u,  -529, -140 },
+    { 0xB5B5ADA8AAFF80B8u,  -502, -132 },
+    { 0x87625F056C7C4A8Bu,  -475, -124 },
+    { 0xC9BCFF6034C13053u,  -449, -116 },
+    { 0x964E858C91BA2655u,  -422, -108 },
+    { 0xDFF9772470297EBDu,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88Fu,  -369,  -92 },
+    { 0xF8A95FCF88747D94u,  -343,  -84 },
+    { 0xB94470938FA89BCFu,  -316,  -76 },
+    { 0x8A08F0F8BF0F156Bu,  -289,  -68 },
+    { 0xCDB02555653131B6u,  -263,  -60 },
+    { 0x993FE2C6D07B7FACu,  -236,  -52 },
+    { 0xE45C10C42A2B3B06u,  -210,  -44 },
+    { 0xAA242499697392D3u,  -183,  -36 },
+    { 0xFD87B5F28300CA0Eu,  -157,  -28 },
+    { 0xBCE5086492111AEBu,  -130,  -20 },
+    { 0x8CBCCC096F5088CCu,  -103,  -12 },
+    { 0xD1B71758E219652Cu,   -77,   -4 },
+    { 0x9C40000000000000u,   -50,    4 },
+    { 0xE8D4A51000000000u,   -24,   12 },
+    { 0xAD78EBC5AC620000u,     3,   20 },
+    { 0x813F3978F8940984u,    30,   28 },
+    { 0xC097CE7BC90715B3u,    56,   36 },
+    { 0x8F7E32CE7BEA5C70u,    83,   44 },
+    { 0xD5D238A4ABE98068u,   109,   52 },
+    { 0x9F4F2726179A2245u,   136,   60 },
+    { 0xED63A231D4C4FB27u,   162,   68 },
+    { 0xB0DE65388CC8ADA8u,   189,   76 },
+    { 0x83C7088E1AAB65DBu,   216,   84 },
+    { 0xC45D1DF942711D9Au,   242,   92 },
+    { 0x924D692CA61BE758u,   269,  100 },
+    { 0xDA01EE641A708DEAu,   295,  108 },
+    { 0xA26DA3999AEF774Au,   322,  116 },
+    { 0xF209787BB47D6B85u,   348,  124 },
+    { 0xB454E4A179DD1877u,   375,  132 },
+    { 0x865B86925B9BC5C2u,   402,  140 },
+    { 0xC83553C5C8965D3Du,   428,  148 },
+    { 0x952AB45CFA97A0B3u,   455,  156 },
+    { 0xDE469FBD99A05FE3u,   481,  164 },
+    { 0xA59BC234DB398C25u,   508,  172 },
+    { 0xF6C69A72A3989F5Cu,   534,  180 },
+    { 0xB7DCBF5354E9BECEu,   561,  188 },
+    { 0x88FCF317F22241E2u,   588,  196 },
+    { 0xCC20CE9BD35C78A5u,   614,  204 },
+    { 0x98165AF37B2153DFu,   641,  212 },
+    { 0xE2A0B5DC971F303Au,   667,  220 },
+    { 0xA8D9D1535CE3B396u,   694,  228 },
+    { 0xFB9B7CD9A4A7443Cu,   720,  236 },
+    { 0xBB764C4CA7A44410u,   747,  244 },
+    { 0x8BAB8EEFB6409C1Au,   774,  252 },
+    { 0xD01FEF10A657842Cu,   800,  260 },
+    { 0x9B10A4E5E9913129u,   827,  268 },
+    { 0xE7109BFBA19C0C9Du,   853,  276 },
+    { 0xAC2820D9623BF429u,   880,  284 },
+    { 0x80444B5E7AA7CF85u,   907,  292 },
+    { 0xBF21E44003ACDD2Du,   933,  300 },
+    { 0x8E679C2F5E44FF8Fu,   960,  308 },
+    { 0xD433179D9C8CB841u,   986,  316 },
+    { 0x9E19DB92B4E31BA9u,  1013,  324 },
+};
+
+/// @return cached_power The power of ten which scales 2^e to [alpha, gamma].
+cached_power cached_power_for_binary_exponent(int e)
+{
+    int const f     = grisu_alpha - e - 1;
+    int const k     = (f * 78913) / (1 << 18) + ((f > 0) ? 1 : 0);
+    int const index = (-cached_power_k_min + k + (cached_power_k_step - 1)) / cached_power_k_step;
+
+    ASSERT((index >= 0) && (static_cast<size_t>(index) < sizeof(cached_powers) / sizeof(cached_powers[0])));
+    return cached_powers[index];
+}
+
+/// @return unsigned int The digit count of value; pow10 is 10^(count - 1).
+unsigned int decimal_digit_count(uint32_t value, uint32_t& pow10)
+{
+    unsigned int count = 1u;
+    for (pow10 = 1u; (count < 10u) && (value >= pow10 * 10u); ++count)
+    {
+        pow10 *= 10u;
+    }
+    return count;
+}
+
+/// Move the last digit toward w while it remains within the interval.
+void grisu2_round(char*    digits,
+                  unsigned count,
+                  uint64_t dist,
+                  uint64_t delta,
+                  uint64_t rest,
+                  uint64_t ten_k)
+{
+    while ((rest < dist) && (delta - rest >= ten_k) &&
+           ((rest + ten_k < dist) || (dist - rest > rest + ten_k - dist)))
+    {
+        digits[count - 1u] -= 1;
+        rest += ten_k;
+    }
+}
+
+/**
+ * Generate the fewest digits within (m_minus, m_plus), closest to w.
+ * The values are scaled so that their exponents are within [alpha, gamma].
+ */
+void grisu2_digit_gen(decimal_digits&   result,
+                      int&              decimal_exponent,
+                      diy_fp            m_minus,
+                      diy_fp            w,
+                      diy_fp            m_plus)
+{
+    uint64_t delta = m_plus.f - m_minus.f;
+    uint64_t dist  = m_plus.f - w.f;
+
+    int      const one_shift = -m_plus.e;
+    uint64_t const one       = uint64_t(1u) << one_shift;
+
+    uint32_t p1 = static_cast<uint32_t>(m_plus.f >> one_shift);   // integer part
+    uint64_t p2 = m_plus.f & (one - 1u);                          // fraction part
+
+    char*    const digits = result.digits;
+    unsigned int   count  = 0u;
+
+    uint32_t pow10 = 0u;
+    for (unsigned int n = decimal_digit_count(p1, pow10); n > 0u; pow10 /= 10u)
+    {
+        digits[count++] = static_cast<char>('0' + p1 / pow10);
+        p1 %= pow10;
+        n  -= 1u;
+
+        uint64_t const rest = (uint64_t(p1) << one_shift) + p2;
+        if (rest <= delta)
+        {
+            decimal_exponent += n;
+            grisu2_round(digits, count, dist, delta, rest, uint64_t(pow10) << one_shift);
+            result.count = static_cast<uint8_t>(count);
+            return;
+        }
+    }
+
+    // The integer part did not narrow enough; generate fraction digits.
+    do
+    {
+        p2    *= 10u;
+        delta *= 10u;
+        dist  *= 10u;
+
+        digits[count++] = static_cast<char>('0' + (p2 >> one_shift));
+        p2 &= one - 1u;
+        decimal_exponent -= 1;
+    }
+    while (p2 > delta);
+
+    grisu2_round(digits, count, dist, delta, p2, one);
+    result.count = static_cast<uint8_t>(count);
+}
+
+// ---------------------------------------------------------------------------
+// Exact digit generation.
+
+/// A fixed capacity unsigned big integer; enough for any double scaled by a power of ten.
+class big_uint
+{
+public:
+    static constexpr std::size_t const limb_max = 40u;
+
+    ~big_uint()                             = default;
+
+    big_uint()                              = delete;
+    big_uint(big_uint const&)               = default;
+    big_uint(big_uint&&)                    = delete;
+    big_uint& operator=(big_uint const&)    = delete;
+    big_uint& operator=(big_uint&&)         = delete;
+
+    explicit big_uint(uint64_t value) : limbs_{}, count_(0u)
+    {
+        for ( ; value != 0u; value >>= 32u)
+        {
+            this->limbs_[this->count_++] = static_cast<uint32_t>(value);
+        }
+    }
+
+    void multiply(uint32_t factor)
+    {
+        uint64_t carry = 0u;
+        for (std::size_t index = 0u; index < this->count_; ++index)
+        {
+            uint64_t const product = uint64_t(this->limbs_[index]) * factor + carry;
+            this->limbs_[index] = static_cast<uint32_t>(product);
+            carry = product >> 32u;
+        }
+
+        if (carry != 0u)
+        {
+            ASSERT(this->count_ < limb_max);
+            this->limbs_[this->count_++] = static_cast<uint32_t>(carry);
+        }
+    }
+
+    void multiply_pow10(unsigned int power)
+    {
+        for ( ; power >= 9u; power -= 9u)
+        {
+            this->multiply(1000u * 1000u * 1000u);
+        }
+
+        uint32_t factor = 1u;
+        for ( ; power > 0u; --power) { factor *= 10u; }
+        this->multiply(factor);
+    }
+
+    void shift_left(unsigned int bits)
+    {
+        if (this->count_ == 0u) { return; }
+
+        std::size_t  const limb_shift = bits / 32u;
+        unsigned int const bit_shift  = bits % 32u;
+        ASSERT(this->count_ + limb_shift + 1u <= limb_max);
+
+        this->limbs_[this->count_ + limb_shift] = 0u;
+        for (std::size_t index = this->count_; index-- > 0u; )
+        {
+            uint64_t const shifted = uint64_t(this->limbs_[index]) << bit_shift;
+            this->limbs_[index + limb_shift + 1u] |= static_cast<uint32_t>(shifted >> 32u);
+            this->limbs_[index + limb_shift]       = static_cast<uint32_t>(shifted);
+        }
+        std::fill(this->limbs_, this->limbs_ + limb_shift, 0u);
+
+        this->count_ += limb_shift + 1u;
+        this->trim();
+    }
+
+    /// *this -= other; *this must be >= other.
+    void subtract(big_uint const& other)
+    {
+        int64_t borrow = 0;
+        for (std::size_t index = 0u; index < this->count_; ++index)
+        {
+            int64_t const other_limb = (index < other.count_) ? other.limbs_[index] : 0;
+            int64_t const difference = int64_t(this->limbs_[index]) - other_limb - borrow;
+            this->limbs_[index] = static_cast<uint32_t>(difference);
+            borrow = (difference < 0) ? 1 : 0;
+        }
+        ASSERT(borrow == 0);
+        this->trim();
+    }
+
+    int compare(big_uint const& other) const
+    {
+        if (this->count_ != other.count_)
+        {
+            return (this->count_ < other.count_) ? -1 : 1;
+        }
+
+        for (std::size_t index = this->count_; index-- > 0u; )
+        {
+            if (this->limbs_[index] != other.limbs_[index])
+            {
+                return (this->limbs_[index] < other.limbs_[index]) ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /// *this %= divisor; @return unsigned int The quotient, which must be < 10.
+    unsigned int divide_digit(big_uint const& divisor)
+    {
+        unsigned int quotient = 0u;
+        for ( ; this->compare(divisor) >= 0; ++quotient)
+        {
+            this->subtract(divisor);
+        }
+        ASSERT(quotient < 10u);
+        return quotient;
+    }
+
+private:
+    void trim()
+    {
+        while ((this->count_ > 0u) && (this->limbs_[this->count_ - 1u] == 0u))
+        {
+            this->count_ -= 1u;
+        }
+    }
+
+    uint32_t    limbs_[limb_max];
+    std::size_t count_;
+};
+
+/**
+ * Generate the exact digits of value, rounded half to even after
+ * digit_count digits or at the 10^position digit; whichever comes first.
+ *
+ * @param exponent_estimate floor(log10(value)) or one more.
+ */
+void double_to_digits_exact(decimal_digits& result,
+                            double          value,
+                            int             exponent_estimate,
+                            unsigned int    digit_count,
+                            int             position)
+{
+    double_binary const binary = double_decompose(value);
+
+    // value = (numerator / denominator) * 10^exponent
+    big_uint numerator(binary.significand);
+    big_uint denominator(1u);
+
+    if (binary.exponent >= 0)
+    {
+        numerator.shift_left(binary.exponent);
+    }
+    else
+    {
+        denominator.shift_left(-binary.exponent);
+    }
+
+    int exponent = exponent_estimate;
+    if (exponent >= 0)
+    {
+        denominator.multiply_pow10(exponent);
+    }
+    else
+    {
+        numerator.multiply_pow10(-exponent);
+    }
+
+    if (numerator.compare(denominator) < 0)
+    {
+        exponent -= 1;
+        numerator.multiply(10u);
+    }
+
+    // 1 <= numerator / denominator < 10.
+    int const digits_to_position = exponent - position + 1;
+    int const count = std::min({static_cast<int>(digit_count),
+                                static_cast<int>(decimal_digits_max),
+                                digits_to_position});
+
+    result.count    = 0u;
+    result.exponent = static_cast<int16_t>(exponent);
+
+    if (count <= 0)
+    {
+        // The value is less than 10^position; it rounds to zero or 10^position.
+        // Only the value in [10^(position - 1), 10^position) can round up;
+        // rounding to even a tie is zero.
+        numerator.shift_left(1u);
+        denominator.multiply(10u);
+        result.exponent = 0;
+        if ((count == 0) && (numerator.compare(denominator) > 0))
+        {
+            decimal_digits_increment(result, position);
+        }
+        return;
+    }
+
+    for (int index = 0; index < count; ++index)
+    {
+        if (index > 0) { numerator.multiply(10u); }
+        result.digits[index] = static_cast<char>('0' + numerator.divide_digit(denominator));
+    }
+    result.count = static_cast<uint8_t>(count);
+
+    // The remainder is numerator / denominator units of the last digit.
+    numerator.shift_left(1u);
+    int  const half_compare = numerator.compare(denominator);
+    bool const last_odd     = bool((result.digits[count - 1] - '0') & 1);
+
+    if ((half_compare > 0) || ((half_compare == 0) && last_odd))
+    {
+        decimal_digits_increment(result, exponent - count + 1);
+    }
+    else
+    {
+        decimal_digits_trim(result);
+    }
+}
+
+void decimal_digits_zero(decimal_digits& result)
+{
+    result.count    = 0u;
+    result.exponent = 0;
+}
+
+} // anonymous namespace
+
+void double_to_shortest(decimal_digits& result, double value)
+{
+    double_binary const binary = double_decompose(value);
+    if (binary.significand == 0u)
+    {
+        decimal_digits_zero(result);
+        return;
+    }
+
+    // The rounding interval boundaries are half way to the adjacent doubles.
+    diy_fp const m_plus  = {2u * binary.significand + 1u, binary.exponent - 1};
+    diy_fp const m_minus = binary.lower_boundary_closer ?
+                           diy_fp{4u * binary.significand - 1u, binary.exponent - 2} :
+                           diy_fp{2u * binary.significand - 1u, binary.exponent - 1};
+
+    diy_fp const w_plus  = diy_fp_normalize(m_plus);
+    diy_fp const w_minus = diy_fp_normalize_to(m_minus, w_plus.e);
+    diy_fp const w       = diy_fp_normalize(diy_fp{binary.significand, binary.exponent});
+
+    cached_power const cached = cached_power_for_binary_exponent(w_plus.e);
+    diy_fp const c_minus_k    = {cached.f, cached.e};
+
+    diy_fp const w_scaled       = diy_fp_multiply(w,       c_minus_k);
+    diy_fp const w_minus_scaled = diy_fp_multiply(w_minus, c_minus_k);
+    diy_fp const w_plus_scaled  = diy_fp_multiply(w_plus,  c_minus_k);
+
+    // Each product may be off by one; narrow the interval to be safe.
+    diy_fp const m_minus_safe = {w_minus_scaled.f + 1u, w_minus_scaled.e};
+    diy_fp const m_plus_safe  = {w_plus_scaled.f  - 1u, w_plus_scaled.e};
+
+    int decimal_exponent = -cached.k;
+    grisu2_digit_gen(result, decimal_exponent, m_minus_safe, w_scaled, m_plus_safe);
+
+    result.exponent = static_cast<int16_t>(decimal_exponent + result.count - 1);
+    decimal_digits_trim(result);
+}
+
+void double_to_significant(decimal_digits& result, double value, unsigned int digit_count)
+{
+    double_to_shortest(result, value);
+    if (result.count == 0u)
+    {
+        return;
+    }
+
+    digit_count = std::max(digit_count, 1u);
+    digit_count = std::min(digit_count, static_cast<unsigned int>(decimal_digits_max));
+
+    // The shortest digits are within 1/2 unit in the last binary place of
+    // the value. If the shortest digits fit and that binary unit is below
+    // the rounding digit then the shortest digits are the rounded value.
+    // The value may be just below the shortest digits' power of ten; allow
+    // for the rounding digit to be one place lower.
+    int const binary_exponent = double_decompose(value).exponent;
+    int const position = result.exponent - static_cast<int>(digit_count) + 1;
+    if ((result.count <= digit_count) && binary_unit_below(binary_exponent, position - 1))
+    {
+        return;
+    }
+
+    if ((result.count > digit_count) &&
+        decimal_digits_round(result, binary_exponent, static_cast<int>(digit_count)))
+    {
+        return;
+    }
+
+    double_to_digits_exact(result, value, result.exponent, digit_count, INT16_MIN);
+}
+
+void double_to_fixed(decimal_digits& result, double value, int position)
+{
+    double_to_shortest(result, value);
+    if (result.count == 0u)
+    {
+        return;
+    }
+
+    int const binary_exponent = double_decompose(value).exponent;
+    int const last_position   = result.exponent - static_cast<int>(result.count) + 1;
+    if ((last_position >= position) && binary_unit_below(binary_exponent, position))
+    {
+        return;
+    }
+
+    if ((last_position < position) &&
+        decimal_digits_round(result, binary_exponent, result.exponent - position + 1))
+    {
+        return;
+    }
+
+    double_to_digits_exact(result, value, result.exponent, decimal_digits_max, position);
+}
+
+void fixed_to_decimal(decimal_digits& result,
+                      uint64_t        magnitude,
+                      unsigned int    fraction_bits,
+                      int             position)
+{
+    ASSERT(fraction_bits <= 60u);
+    ASSERT(position <= 0);
+
+    uint64_t const one      = uint64_t(1u) << fraction_bits;
+    uint64_t const integer  = magnitude >> fraction_bits;
+    uint64_t       fraction = magnitude & (one - 1u);
+
+    decimal_digits_zero(result);
+
+    // Integer digits; at most 20, which always fit.
+    char integer_digits[20u];
+    unsigned int integer_count = 0u;
+    for (uint64_t value = integer; value != 0u; value /= 10u)
+    {
+        integer_digits[integer_count++] = static_cast<char>('0' + value % 10u);
+    }
+    std::reverse_copy(integer_digits, integer_digits + integer_count, result.digits);
+    result.count    = static_cast<uint8_t>(integer_count);
+    result.exponent = static_cast<int16_t>(integer_count - 1u);
+
+    // Fraction digits; leading zeros of a value less than 1 are not stored.
+    int digit_position = 0;
+    for ( ; (digit_position > position) && (result.count < decimal_digits_max); --digit_position)
+    {
+        fraction *= 10u;
+        char const digit = static_cast<char>('0' + (fraction >> fraction_bits));
+        fraction &= one - 1u;
+
+        if (result.count > 0u)
+        {
+            result.digits[result.count++] = digit;
+        }
+        else if (digit != '0')
+        {
+            result.digits[0] = digit;
+            result.count     = 1u;
+            result.exponent  = static_cast<int16_t>(digit_position - 1);
+        }
+    }
+
+    // The remainder is fraction / one units of the 10^digit_position digit.
+    bool const last_odd = (result.count > 0u) &&
+                          bool((result.digits[result.count - 1u] - '0') & 1);
+    uint64_t const fraction_twice = fraction << 1u;
+
+    if ((fraction_twice > one) || ((fraction_twice == one) && last_odd))
+    {
+        decimal_digits_increment(result, digit_position);
+    }
+    else
+    {
+        decimal_digits_trim(result);
+        if (result.count == 0u)
+        {
+            decimal_digits_zero(result);
+        }
+    }
+}
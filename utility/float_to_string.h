@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <type_traits>
 
@@ -49,7 +50,8 @@ struct double_parts
 
 inline double_parts double_extract_parts(double value)
 {
-    uint64_t const u64_float = *reinterpret_cast<uint64_t*>(&value);
+    uint64_t u64_float = 0u;
+    std::memcpy(&u64_float, &value, sizeof(u64_float));
 
     uint64_t mantissa_1 = 1u;
     mantissa_1 <<= 51u;
@@ -177,3 +179,57 @@ inline size_t double_to_hex(char        *buffer,
     return buffer_iter - buffer;
 }
 
+/**
+ * The most significant digits produced by a double to decimal conversion.
+ * A conversion requesting more digits is rounded at this digit and the
+ * digits which follow are zero.
+ */
+static constexpr size_t const decimal_digits_max = 40u;
+
+/**
+ * @struct decimal_digits
+ * A decimal value: digits[0].digits[1]digits[2]... x 10^exponent.
+ * Digits following count are zero; a count of zero is the value zero.
+ */
+struct decimal_digits
+{
+    char        digits[decimal_digits_max];
+    uint8_t     count;
+    int16_t     exponent;
+};
+
+/**
+ * The conversions below use integer arithmetic only; no FPU or soft-float
+ * library calls are made. The value must be finite; its sign is ignored.
+ */
+
+/**
+ * Convert to the shortest digits which read back as the same double.
+ * Uses Grisu2; the result always round trips and is the shortest possible
+ * for all but a small fraction of values, where it is one digit longer.
+ */
+void double_to_shortest(decimal_digits& result, double value);
+
+/**
+ * Convert to digit_count significant digits, correctly rounded half to even
+ * from the exact binary value as glibc printf() does; for "%e", "%g".
+ */
+void double_to_significant(decimal_digits& result, double value, unsigned int digit_count);
+
+/**
+ * Convert rounding at the 10^position digit, correctly rounded half to even
+ * from the exact binary value; for "%f" position is -precision.
+ */
+void double_to_fixed(decimal_digits& result, double value, int position);
+
+/**
+ * Convert a fixed point magnitude, magnitude / 2^fraction_bits, rounding at
+ * the 10^position digit half to even. The conversion is exact.
+ *
+ * @param fraction_bits The Q format fraction bits; no more than 60.
+ * @param position      The least significant digit; must be <= 0.
+ */
+void fixed_to_decimal(decimal_digits& result,
+                      uint64_t        magnitude,
+                      unsigned int    fraction_bits,
+                      int             position);
@@ -8,7 +8,9 @@
 #include <cstdint>
 
 constexpr char const format_conversion::format_char;
-constexpr std::array<char, 19> const format_conversion::known_conversion_specifiers;
+constexpr std::array<char, 20> const format_conversion::known_conversion_specifiers;
+constexpr short int const format_conversion::q_bits_max;
+constexpr short int const format_conversion::q_fraction_bits_max;
 
 bool format_conversion::is_integer_conversion_specifier(char conversion_specifier)
 {
@@ -56,6 +58,8 @@ bool format_conversion::operator==(format_conversion const& other) const
         (this->justification            == other.justification)          &&
         (this->prepend_value            == other.prepend_value)          &&
         (this->alternative_conversion   == other.alternative_conversion) &&
+        (this->q_integer_bits           == other.q_integer_bits)         &&
+        (this->q_fraction_bits          == other.q_fraction_bits)        &&
         (this->format_length            == other.format_length)          &&
         (this->parse_error              == other.parse_error)            ;
 }
@@ -77,6 +81,8 @@ void format_conversion::init()
     this->justification             = justification::right;
     this->prepend_value             = 0;
     this->alternative_conversion    = false;
+    this->q_integer_bits            = 0;
+    this->q_fraction_bits           = 0;
     this->format_length             = 0u;
     this->parse_error               = parse_error::none;
 }
@@ -95,6 +101,14 @@ void format_conversion::parse(char const *format_spec)
 
         this->conversion_specifier = *format_iter++;
 
+        bool q_format_valid = true;
+        if (this->conversion_specifier == 'q')
+        {
+            char const* const q_format_begin = format_iter;
+            format_iter = this->parse_q_format(format_iter);
+            q_format_valid = (format_iter != q_format_begin);
+        }
+
         if (this->precision_state == format_conversion::modifier_state::use_default)
         {
             if (is_integer_conversion_specifier(this->conversion_specifier))
@@ -121,7 +135,8 @@ void format_conversion::parse(char const *format_spec)
                                     std::end(known_conversion_specifiers),
                                     this->conversion_specifier);
 
-        this->parse_error = (iter_found == std::end(known_conversion_specifiers))
+        this->parse_error = ((iter_found == std::end(known_conversion_specifiers)) ||
+                             not q_format_valid)
                             ? parse_error::bad_parse
                             : parse_error::none;
     }
@@ -271,6 +286,30 @@ char const* format_conversion::parse_length_modifiers(char const *format_iter)
     return format_iter;
 }
 
+char const* format_conversion::parse_q_format(char const *format_iter)
+{
+    // "<integer_bits>.<fraction_bits>"; on failure do not consume anything.
+    char const* q_format_iter = format_iter;
+    if (not is_digit(*q_format_iter))
+    {
+        return format_iter;
+    }
+    q_format_iter = this->parse_short_int(this->q_integer_bits, q_format_iter);
+
+    if ((*q_format_iter != '.') || not is_digit(q_format_iter[1]))
+    {
+        return format_iter;
+    }
+    q_format_iter = this->parse_short_int(this->q_fraction_bits, q_format_iter + 1u);
+
+    bool const bits_valid =
+        (this->q_integer_bits  >  0) &&
+        (this->q_fraction_bits <= q_fraction_bits_max) &&
+        (this->q_integer_bits + this->q_fraction_bits <= q_bits_max);
+
+    return bits_valid ? q_format_iter : format_iter;
+}
+
 char const* format_conversion::parse_short_int(short int& value,
                                                char const *format_iter)
 {
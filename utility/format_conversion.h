@@ -44,6 +44,14 @@
  * 'g' 'G'  Converts floating point, notation E or F depending on value, precision.
  * 'n'      The number of characters written by the printf call.
  * 'p'      Prints the pointer value.
+ *
+ * Extensions:
+ * 'q'      Signed fixed point Q format conversion; "%q16.16".
+ *          The integer and fraction bit counts follow the 'q' and are
+ *          required. The argument is the raw two's complement integer:
+ *          an int if the bit count total is <= 32, otherwise long long int.
+ *          The precision defaults to the decimal digits needed to
+ *          distinguish adjacent fixed point values.
  */
 struct format_conversion
 {
@@ -51,7 +59,7 @@ struct format_conversion
     /// to be performed.
     static constexpr char const format_char = '%';
 
-    static constexpr std::array<char, 19> const known_conversion_specifiers =
+    static constexpr std::array<char, 20> const known_conversion_specifiers =
     {{
         '%',                                        // percent print
         'c',                                        // char    conversion
@@ -60,8 +68,15 @@ struct format_conversion
         'f', 'F', 'e', 'E', 'a', 'A', 'g', 'G',     // float   conversions
         'p',                                        // pointer conversions
         'n',
+        'q',                                        // fixed point conversion
     }};
 
+    /// The 'q' conversion integer and fraction bits total is limited to 64.
+    static constexpr short int const q_bits_max          = 64;
+
+    /// The 'q' conversion fraction bits are limited to 60.
+    static constexpr short int const q_fraction_bits_max = 60;
+
     static bool is_integer_conversion_specifier(char conversion_specifier);
     static bool is_float_conversion_specifier(char conversion_specifier);
 
@@ -180,6 +195,12 @@ struct format_conversion
      */
     bool alternative_conversion;
 
+    /// For 'q' conversions: the Q format integer bits, including the sign.
+    short int q_integer_bits;
+
+    /// For 'q' conversions: the Q format fraction bits.
+    short int q_fraction_bits;
+
     /// The number of characters comprising the format conversion sequenece.
     /// This is the number of characters following the format_char delimiter
     /// and does not include the format_char delimiter
@@ -210,6 +231,7 @@ private:
     char const* parse_field_width(char const *format_iter);
     char const* parse_precision(char const *format_iter);
     char const* parse_length_modifiers(char const *format_iter);
+    char const* parse_q_format(char const *format_iter);
     char const* parse_short_int(short int& value, char const *format_iter);
 };
 
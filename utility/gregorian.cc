@@ -7,7 +7,9 @@
 #include "logger.h"
 #include "project_assert.h"
 
-#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 namespace utility
 {
@@ -19,76 +21,158 @@ constexpr uint8_t const days_per_month[gregorian::months_per_year + 1u] =
      0u,    // Not a month
     31u,    // January
     28u,    // February     note: except in a leap year.
-    30u,    // March
+    31u,    // March
     30u,    // April
     31u,    // May
     30u,    // June
     31u,    // July
     31u,    // August
-    31u,    // September
+    30u,    // September
     31u,    // October
     30u,    // November
     31u,    // December
 };
 
-gregorian gregorian::to_calendar(uint64_t seconds_since_epoch)
+// The number of days in a non-leap year preceding the first of each month.
+constexpr uint16_t const days_before_month[gregorian::months_per_year + 1u] =
 {
-    uint64_t span_400 = seconds_since_epoch  / seconds_per_400_years;
-                        seconds_since_epoch -= seconds_per_400_years * span_400;
-    uint64_t span_100 = seconds_since_epoch  / seconds_per_100_years;
-             span_100 = (span_100 > 3u) ? 3u : span_100;
-                        seconds_since_epoch -= seconds_per_100_years * span_100;
-    uint64_t span_4   = seconds_since_epoch  / seconds_per_4_years;
-             span_4   = (span_4 > 24u) ? 24u : span_4;
-                        seconds_since_epoch -= seconds_per_4_years * span_4;
-    uint64_t span_1   = seconds_since_epoch  / seconds_per_1_years;
-             span_1   = (span_1 > 3u) ? 3u : span_1;
-                        seconds_since_epoch -= seconds_per_1_years * span_1;
-
-    uint16_t const year_span =
-        span_400 * 400u +
-        span_100 * 100u +
-        span_4   *   4u +
-        span_1   *   1u ;
-
-    uint16_t const year         = static_cast<uint16_t>(year_span) + gregorian::epoch_year;
-    uint16_t const day_of_year  = seconds_since_epoch  / seconds_per_day;
-                                  seconds_since_epoch -= seconds_per_day * day_of_year;
-
-    uint16_t day_count = day_of_year;
-    for (uint8_t month_iter = January; month_iter <= December; ++month_iter)
-    {
-        uint16_t const days_in_month_iter = days_in_month(month_iter, year);
-        if (day_count >= days_in_month_iter)
-        {
-            day_count -= days_in_month_iter;
-        }
-        else
-        {
-            uint8_t const hours = seconds_since_epoch / seconds_per_hour;
-            seconds_since_epoch -= hours * seconds_per_hour;
+      0u,   // Not a month
+      0u,   // January
+     31u,   // February
+     59u,   // March
+     90u,   // April
+    120u,   // May
+    151u,   // June
+    181u,   // July
+    212u,   // August
+    243u,   // September
+    273u,   // October
+    304u,   // November
+    334u,   // December
+};
 
-            uint8_t const minutes = seconds_since_epoch / seconds_per_minute;
-            seconds_since_epoch -= minutes * seconds_per_minute;
+/**
+ * The date conversions use a computational calendar whose years start on
+ * March 1st so that the leap day is the last day of the year. Its epoch,
+ * 1600-03-01, begins a 400 year cycle and precedes the gregorian epoch
+ * 1601-01-01 by 306 days: March 1st through December 31st.
+ */
+static constexpr uint16_t const computational_epoch_year   = 1600u;
+static constexpr uint32_t const computational_epoch_offset = 306u;
 
-            // The day count of zero means the first day in the month.
-            // Add one to day_count to normalize to human style day of month
-            // interpretation.
-            return gregorian(year, month_iter, day_count + 1u,
-                             hours, minutes, seconds_since_epoch);
-        }
-    }
+/**
+ * Divide the seconds since epoch by the seconds per day without a 64-bit
+ * division, which is a library call on Cortex-M.
+ *
+ * 86,400 = 128 * 675. The shift by 7 is exact; the division by 675 is done
+ * in 16-bit digits so that each step is a 32-bit division by a constant,
+ * which the compiler emits as a multiply and shift.
+ *
+ * @param seconds       The seconds since the epoch.
+ * @param second_of_day [out] seconds modulo seconds per day.
+ * @return uint64_t     The days since the epoch.
+ */
+static uint64_t divide_by_seconds_per_day(uint64_t seconds, uint32_t& second_of_day)
+{
+    constexpr uint32_t const divisor = 675u;
+    static_assert(divisor * 128u == 86400u);
+
+    uint64_t const dividend = seconds >> 7u;
+
+    // dividend < 2^57: the leading digit fits 25 bits; each remainder
+    // shifted by 16 bits with the next digit fits 26 bits.
+    uint32_t const digit_2 = static_cast<uint32_t>(dividend >> 32u);
+    uint32_t const digit_1 = static_cast<uint32_t>(dividend >> 16u) & UINT16_MAX;
+    uint32_t const digit_0 = static_cast<uint32_t>(dividend)        & UINT16_MAX;
+
+    uint32_t const quotient_2  = digit_2 / divisor;
+    uint32_t const partial_1   = ((digit_2 - quotient_2 * divisor) << 16u) | digit_1;
+    uint32_t const quotient_1  = partial_1 / divisor;
+    uint32_t const partial_0   = ((partial_1 - quotient_1 * divisor) << 16u) | digit_0;
+    uint32_t const quotient_0  = partial_0 / divisor;
+    uint32_t const remainder   = partial_0 - quotient_0 * divisor;
 
-    // This should never happen. We have run out of days within the year.
-    ASSERT(0);
-    return gregorian();
+    second_of_day = (remainder << 7u) | (static_cast<uint32_t>(seconds) & 0x7Fu);
+
+    return (static_cast<uint64_t>(quotient_2) << 32u) |
+           (static_cast<uint64_t>(quotient_1) << 16u) | quotient_0;
+}
+
+gregorian gregorian::to_calendar(uint64_t seconds_since_epoch)
+{
+    uint32_t second_of_day = 0u;
+    uint32_t const day_count = static_cast<uint32_t>(
+        divide_by_seconds_per_day(seconds_since_epoch, second_of_day));
+
+    // Calendar from day count, after C. Neri and L. Schneider,
+    // "Euclidean affine functions and their application to calendar
+    // algorithms", 2022. Divisions are by constants; the compiler emits
+    // multiplies and shifts. Valid for all uint16_t years.
+    uint32_t const n_1          = 4u * (day_count + computational_epoch_offset) + 3u;
+    uint32_t const century      = n_1 / days_per_400_years;
+    uint32_t const n_2          = (n_1 % days_per_400_years) | 3u;
+    uint64_t const p_2          = static_cast<uint64_t>(2939745u) * n_2;
+    uint32_t const year_of_century = static_cast<uint32_t>(p_2 >> 32u);
+    uint32_t const day_of_year  = static_cast<uint32_t>(p_2) / 2939745u / 4u;
+    uint32_t const n_3          = 2141u * day_of_year + 197913u;
+    uint32_t const month        = n_3 >> 16u;
+    uint32_t const day          = (n_3 & UINT16_MAX) / 2141u;
+
+    // Map the computational year, starting in March, to January.
+    uint32_t const is_jan_feb   = (day_of_year >= 306u) ? 1u : 0u;
+    uint32_t const year         = 100u * century + year_of_century + is_jan_feb;
+
+    uint32_t const hours        = second_of_day / seconds_per_hour;
+    uint32_t const hour_seconds = second_of_day - hours * seconds_per_hour;
+    uint32_t const minutes      = hour_seconds  / seconds_per_minute;
+    uint32_t const seconds      = hour_seconds  - minutes * seconds_per_minute;
+
+    return gregorian(static_cast<uint16_t>(year + computational_epoch_year),
+                     static_cast<uint8_t>(is_jan_feb ? month - 12u : month),
+                     static_cast<uint8_t>(day + 1u),
+                     static_cast<uint8_t>(hours),
+                     static_cast<uint8_t>(minutes),
+                     static_cast<uint8_t>(seconds));
+}
+
+/**
+ * Write a value as a fixed number of decimal digits.
+ * @return char* The position following the last digit written.
+ */
+static char* write_digits(char* first, uint32_t value, std::size_t digit_count)
+{
+    for (char* iter = first + digit_count; iter != first; value /= 10u)
+    {
+        *--iter = static_cast<char>('0' + value % 10u);
+    }
+    return first + digit_count;
 }
 
 void gregorian::to_chars(char *first, char *last, gregorian const& greg)
 {
-    snprintf(first, last - first, "%04u-%02u-%02uT%02u:%02u:%02u",
-             greg.year,  greg.month, greg.day_of_month,
-             greg.hours, greg.minutes, greg.seconds);
+    if (first == last)
+    {
+        return;
+    }
+
+    // Years past 9999 take 5 digits, as snprintf("%04u") would.
+    char buffer[char_buffer_size + 1u];
+    char* iter = write_digits(buffer, greg.year, (greg.year > 9999u) ? 5u : 4u);
+    *iter++ = '-';
+    iter = write_digits(iter, greg.month,        2u);
+    *iter++ = '-';
+    iter = write_digits(iter, greg.day_of_month, 2u);
+    *iter++ = 'T';
+    iter = write_digits(iter, greg.hours,        2u);
+    *iter++ = ':';
+    iter = write_digits(iter, greg.minutes,      2u);
+    *iter++ = ':';
+    iter = write_digits(iter, greg.seconds,      2u);
+
+    // Truncate to the destination and null terminate, as snprintf does.
+    std::size_t const length = std::min<std::size_t>(iter - buffer, last - first - 1u);
+    std::memcpy(first, buffer, length);
+    first[length] = 0;
 }
 
 uint32_t gregorian::days_since_epoch(gregorian const &greg)
@@ -99,7 +183,7 @@ uint32_t gregorian::days_since_epoch(gregorian const &greg)
 
     // Determine the number of days within the number of years since epoch.
     uint32_t day_count = 0u;
-    day_count += years_since_epoch * days_per_non_leap_year;
+    day_count += static_cast<uint32_t>(years_since_epoch) * days_per_non_leap_year;
     day_count += leap_year_count;
     day_count += calc_day_of_year(greg) - 1u;
 
@@ -108,13 +192,15 @@ uint32_t gregorian::days_since_epoch(gregorian const &greg)
 
 uint64_t gregorian::seconds_since_epoch(gregorian const &greg)
 {
-    uint64_t const day_count = days_since_epoch(greg);
+    uint32_t const day_count = days_since_epoch(greg);
+
+    // A 32 x 32 bit multiply with a 64-bit result; the time of day fits
+    // 32 bits.
+    uint32_t const time_of_day = greg.hours     * seconds_per_hour    +
+                                 greg.minutes   * seconds_per_minute  +
+                                 greg.seconds;
 
-    uint64_t const seconds = day_count      * seconds_per_day     +
-                             greg.hours     * seconds_per_hour    +
-                             greg.minutes   * seconds_per_minute  +
-                             greg.seconds;
-    return seconds;
+    return static_cast<uint64_t>(day_count) * seconds_per_day + time_of_day;
 }
 
 bool gregorian::is_leap_year(uint16_t year)
@@ -179,10 +265,10 @@ uint16_t gregorian::calc_day_of_year(gregorian const &greg)
         return 0u;
     }
 
-    uint16_t day_count = 0u;
-    for (uint8_t month_iter = January; month_iter < greg.month; ++month_iter)
+    uint16_t day_count = days_before_month[greg.month];
+    if ((greg.month > February) && is_leap_year(greg.year))
     {
-        day_count += days_in_month(month_iter, greg.year);
+        day_count += 1u;
     }
 
     // Note: since 'day of year' and 'day of month' both start with '1',
@@ -213,8 +299,9 @@ bool gregorian::is_valid(gregorian const &greg)
 
 gregorian::day_of_week gregorian::calc_day_of_week(gregorian const &greg)
 {
+    // The enum days_per_week counts dow_invalid; there are 7 days per week.
     uint32_t const day_count = days_since_epoch(greg);
-    uint8_t const dow = day_count % days_per_week + monday;
+    uint8_t const dow = day_count % (days_per_week - monday) + monday;
     return static_cast<day_of_week>(dow);
 }
 
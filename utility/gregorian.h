@@ -214,19 +214,8 @@ private:
     static constexpr uint16_t const leaps_per_400_years = (400u / 4u) - (400u / 100u) + 1u;
     static_assert(leaps_per_400_years == 97u);
 
-    /// In any 100 year span there are 24 leap years.
-    static constexpr uint16_t const leaps_per_100_years = (100u / 4u) - 1u;
-    static_assert(leaps_per_100_years == 24u);
-
-    static constexpr uint64_t const days_per_400_years    = 400u * days_per_non_leap_year + leaps_per_400_years;
-    static constexpr uint64_t const seconds_per_400_years = days_per_400_years * seconds_per_day;
-
-    static constexpr uint64_t const days_per_100_years    = 100u * days_per_non_leap_year + leaps_per_100_years;
-    static constexpr uint64_t const seconds_per_100_years = days_per_100_years * seconds_per_day;
-
-    static constexpr uint64_t const days_per_4_years      = 4u * days_per_non_leap_year + 1u;
-    static constexpr uint64_t const seconds_per_4_years   = days_per_4_years * seconds_per_day;
-    static constexpr uint64_t const seconds_per_1_years   = days_per_non_leap_year * seconds_per_day;
+    static constexpr uint32_t const days_per_400_years  = 400u * days_per_non_leap_year + leaps_per_400_years;
+    static_assert(days_per_400_years == 146097u);
 };
 
 bool operator == (gregorian const& greg_1, gregorian const& greg_2);
@@ -0,0 +1,67 @@
+/**
+ * @file log2_histogram.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A fixed size histogram with power of 2 bins.
+ */
+
+#pragma once
+
+#include "bit_manip.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class log2_histogram
+ * Bin n counts the values of bit width n:
+ * bin 0 counts the value 0, bin 1 the value 1, bin 2 the values [2:3],
+ * bin 3 the values [4:7], ... Values wider than the last bin are counted in
+ * the last bin.
+ *
+ * The bin is found with a single count leading zeros instruction, making
+ * the histogram cheap enough to be updated from an ISR.
+ *
+ * @tparam bin_count The number of bins.
+ */
+template <std::size_t bin_count_>
+class log2_histogram
+{
+public:
+    static constexpr std::size_t const bin_count = bin_count_;
+
+    static_assert(bin_count > 1u, "log2_histogram requires at least 2 bins");
+
+    ~log2_histogram()                                   = default;
+    log2_histogram(log2_histogram const&)               = default;
+    log2_histogram& operator=(log2_histogram const&)    = default;
+
+    constexpr log2_histogram() : bins_{} {}
+
+    /// @return std::size_t The bin into which the value is counted.
+    static std::size_t bin(uint32_t value)
+    {
+        std::size_t const bit_width =
+            (sizeof(value) * CHAR_BIT) - bit_manip::count_leading_zeros(value);
+        return (bit_width < bin_count) ? bit_width : bin_count - 1u;
+    }
+
+    /// @return uint32_t The smallest value counted in the bin.
+    static constexpr uint32_t bin_lower(std::size_t bin_index)
+    {
+        return (bin_index == 0u) ? 0u : (1u << (bin_index - 1u));
+    }
+
+    void record(uint32_t value) { this->bins_[bin(value)] += 1u; }
+
+    uint32_t operator[](std::size_t bin_index) const { return this->bins_[bin_index]; }
+
+    void reset()
+    {
+        for (uint32_t& bin_value : this->bins_) { bin_value = 0u; }
+    }
+
+private:
+    uint32_t bins_[bin_count];
+};
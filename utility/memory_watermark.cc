@@ -0,0 +1,50 @@
+/**
+ * @file memory_watermark.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "memory_watermark.h"
+#include "logger.h"
+
+void memory_watermark_collect(memory_report_t& report)
+{
+    report.pool_count    = 0u;
+    report.pool_overflow = 0u;
+
+    for (memory_watermark const* watermark = memory_watermark::first();
+         watermark; watermark = watermark->next())
+    {
+        if (report.pool_count == memory_report_pool_max)
+        {
+            report.pool_overflow += 1u;
+            continue;
+        }
+
+        memory_report_t::pool_type& pool = report.pools[report.pool_count++];
+        pool.name      = watermark->name();
+        pool.capacity  = watermark->capacity();
+        pool.level     = watermark->level();
+        pool.level_min = watermark->level_min();
+        pool.level_max = watermark->level_max();
+    }
+}
+
+void memory_report_write(memory_report_t const& report, logger& logger)
+{
+    logger.info("stack: size: %5u, used max: %5u, free min: %5u, guard hits: %u",
+                report.stack.size, report.stack.used_max,
+                report.stack.free_min, report.stack.guard_hits);
+
+    for (memory_report_t::pool_type const* pool = report.pools;
+         pool < report.pools + report.pool_count; ++pool)
+    {
+        logger.info("pool: %-16s capacity: %5u, level: %5u, min: %5u, max: %5u",
+                    pool->name, pool->capacity, pool->level,
+                    pool->level_min, pool->level_max);
+    }
+
+    if (report.pool_overflow > 0u)
+    {
+        logger.warn("pool: %u not reported", report.pool_overflow);
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * @file memory_watermark.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * High water marks for the stack and for memory pools: free lists,
+ * ring buffers, allocators.
+ */
+
+#pragma once
+
+#include "registry_node.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+class logger;
+
+/**
+ * @class stack_watermark
+ * Find the deepest stack use by scanning a painted stack region.
+ *
+ * The region [limit, top) is painted with a pattern; the stack grows down
+ * from top. Words below the deepest stack use keep the pattern.
+ *
+ * scan() is incremental: the high water mark only moves down, so only the
+ * words below the previous mark are searched. When the word below the mark
+ * still holds the pattern the stack has not grown and scan() returns after
+ * a single read; otherwise a binary search finds the new mark in
+ * log2(words) reads.
+ *
+ * The binary search assumes that every word above the mark has been
+ * written. A deep frame which leaves a run of words unwritten, such as an
+ * unused local buffer, can make scan() find a mark above the true one.
+ * scan_exact() reads linearly up from limit to the mark and always finds
+ * the true mark.
+ */
+class stack_watermark
+{
+public:
+    ~stack_watermark()                                  = default;
+
+    stack_watermark()                                   = delete;
+    stack_watermark(stack_watermark const&)             = delete;
+    stack_watermark(stack_watermark &&)                 = delete;
+    stack_watermark& operator=(stack_watermark const&)  = delete;
+    stack_watermark& operator=(stack_watermark&&)       = delete;
+
+    /**
+     * @param limit   The lowest stack address; 32-bit aligned.
+     * @param top     The address above the stack; 32-bit aligned.
+     * @param pattern The value painted into the unused stack.
+     */
+    constexpr stack_watermark(uint32_t const volatile* limit,
+                              uint32_t const volatile* top,
+                              uint32_t                 pattern)
+        : limit_(limit), top_(top), mark_(top), pattern_(pattern)
+    {
+    }
+
+    /// Paint [begin, end) with the pattern.
+    static void paint(uint32_t volatile* begin, uint32_t volatile* end, uint32_t pattern)
+    {
+        for (uint32_t volatile* iter = begin; iter < end; ++iter) { *iter = pattern; }
+    }
+
+    /**
+     * Repaint [begin, end) and restart the high water measurement from end.
+     * The words in [limit, begin) must still hold the pattern.
+     */
+    void repaint(uint32_t volatile* begin, uint32_t volatile* end)
+    {
+        paint(begin, end, this->pattern_);
+        this->mark_ = end;
+    }
+
+    /// @return std::size_t The high water mark: the most stack bytes used.
+    std::size_t scan()
+    {
+        if ((this->mark_ == this->limit_) || (this->mark_[-1] == this->pattern_))
+        {
+            return this->used_max();
+        }
+
+        // The word below the mark is in use: binary search [limit, mark)
+        // for the lowest word in use.
+        std::size_t lower = 0u;
+        std::size_t upper = (this->mark_ - this->limit_) - 1u;
+        while (lower < upper)
+        {
+            std::size_t const middle = lower + (upper - lower) / 2u;
+            if (this->limit_[middle] == this->pattern_)
+            {
+                lower = middle + 1u;
+            }
+            else
+            {
+                upper = middle;
+            }
+        }
+
+        this->mark_ = this->limit_ + lower;
+        return this->used_max();
+    }
+
+    /// @return std::size_t The high water mark, found by a linear scan.
+    std::size_t scan_exact()
+    {
+        uint32_t const volatile* iter = this->limit_;
+        while ((iter < this->mark_) && (*iter == this->pattern_)) { ++iter; }
+
+        this->mark_ = iter;
+        return this->used_max();
+    }
+
+    std::size_t size()     const { return (this->top_  - this->limit_) * sizeof(uint32_t); }
+    std::size_t used_max() const { return (this->top_  - this->mark_)  * sizeof(uint32_t); }
+    std::size_t free_min() const { return (this->mark_ - this->limit_) * sizeof(uint32_t); }
+
+    uint32_t const volatile* mark() const { return this->mark_; }
+
+private:
+    uint32_t const volatile* const  limit_;
+    uint32_t const volatile* const  top_;
+    uint32_t const volatile*        mark_;
+    uint32_t const                  pattern_;
+};
+
+/**
+ * @class memory_watermark
+ * The minimum and maximum levels seen by a memory pool: the bytes held in
+ * a ring buffer, the nodes left in a free list.
+ *
+ * A watermark registers itself into a list of watermarks when first
+ * recorded; memory_watermark_collect() reads the list. The constructor is
+ * constexpr so that static instances are constant initialized. A
+ * watermark which is destroyed must be destroyed in thread context.
+ */
+class memory_watermark: public registry_node<memory_watermark>
+{
+public:
+    memory_watermark()                                      = delete;
+    memory_watermark(memory_watermark const&)               = delete;
+    memory_watermark(memory_watermark &&)                   = delete;
+    memory_watermark& operator=(memory_watermark const&)    = delete;
+    memory_watermark& operator=(memory_watermark&&)         = delete;
+
+    /**
+     * @param name     The pool name; must outlive the watermark.
+     * @param capacity The pool capacity; zero if unknown.
+     */
+    constexpr explicit memory_watermark(char const* name, std::size_t capacity = 0u)
+        : registry_node(),
+          name_(name),
+          capacity_(capacity),
+          level_(0u),
+          level_min_(std::numeric_limits<std::size_t>::max()),
+          level_max_(0u)
+    {
+    }
+
+    ~memory_watermark() { this->unregister_node(); }
+
+    void record(std::size_t level)
+    {
+        if (not this->is_registered())
+        {
+            this->register_node();
+        }
+
+        this->level_     = level;
+        this->level_min_ = (level < this->level_min_) ? level : this->level_min_;
+        this->level_max_ = (level > this->level_max_) ? level : this->level_max_;
+    }
+
+    void set_capacity(std::size_t capacity) { this->capacity_ = capacity; }
+
+    /// Restart the min and max from the current level.
+    void reset()
+    {
+        this->level_min_ = this->level_;
+        this->level_max_ = this->level_;
+    }
+
+    char const* name()      const { return this->name_; }
+    std::size_t capacity()  const { return this->capacity_; }
+    std::size_t level()     const { return this->level_; }
+    std::size_t level_max() const { return this->level_max_; }
+
+    /// @return std::size_t The lowest level recorded; zero if none recorded.
+    std::size_t level_min() const
+    {
+        return (this->level_min_ > this->level_max_) ? 0u : this->level_min_;
+    }
+
+private:
+    char const*         name_;
+    std::size_t         capacity_;
+    std::size_t         level_;
+    std::size_t         level_min_;
+    std::size_t         level_max_;
+};
+
+/// The maximum number of pools reported by memory_report_t.
+static constexpr std::size_t const memory_report_pool_max = 12u;
+
+/// The stack and memory pool watermarks in a single record.
+struct memory_report_t
+{
+    struct stack_type
+    {
+        uint32_t    size;
+        uint32_t    used_max;
+        uint32_t    free_min;
+        uint32_t    guard_hits;     ///< Writes into the stack guard region.
+    };
+
+    struct pool_type
+    {
+        char const* name;
+        uint32_t    capacity;
+        uint32_t    level;
+        uint32_t    level_min;
+        uint32_t    level_max;
+    };
+
+    stack_type  stack;
+    uint32_t    pool_count;
+    uint32_t    pool_overflow;      ///< Registered pools not in pools[].
+    pool_type   pools[memory_report_pool_max];
+};
+
+/// Fill the report pools from the registered memory watermarks.
+void memory_watermark_collect(memory_report_t& report);
+
+/// Write the report to the logger at level::info.
+void memory_report_write(memory_report_t const& report, logger& logger);
@@ -0,0 +1,141 @@
+/**
+ * @file monotonic_arena.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A bump allocator which releases all of its allocations at once.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class monotonic_arena
+ * Allocate by advancing an offset into a caller supplied buffer.
+ * Individual deallocation is a no-op; reset() releases everything.
+ * Suited to state with a common lifetime, such as per-connection state
+ * which is discarded on disconnect.
+ *
+ * allocate() is lock-free and may be called from an ISR.
+ * reset() must not be called concurrently with allocate().
+ */
+class monotonic_arena
+{
+public:
+    ~monotonic_arena()                                  = default;
+
+    monotonic_arena()                                   = delete;
+    monotonic_arena(monotonic_arena const&)             = delete;
+    monotonic_arena(monotonic_arena &&)                 = delete;
+    monotonic_arena& operator=(monotonic_arena const&)  = delete;
+    monotonic_arena& operator=(monotonic_arena&&)       = delete;
+
+    /**
+     * @param buffer The arena storage.
+     * @param size   The size of buffer in bytes.
+     */
+    monotonic_arena(void* buffer, std::size_t size) :
+        buffer_(static_cast<uint8_t*>(buffer)),
+        capacity_(size),
+        offset_(0u),
+        padding_(0u),
+        high_water_(0u),
+        failure_count_(0u)
+    {
+    }
+
+    /**
+     * @return void* size bytes aligned to alignment; nullptr if the arena
+     *         does not have the space.
+     */
+    void* allocate(std::size_t size,
+                   std::size_t alignment = alignof(std::max_align_t))
+    {
+        ASSERT((alignment & (alignment - 1u)) == 0u);
+
+        uintptr_t const base = reinterpret_cast<uintptr_t>(this->buffer_);
+        std::size_t offset   = this->offset_.load(std::memory_order_relaxed);
+        std::size_t aligned;
+        std::size_t next;
+        do
+        {
+            aligned = ((base + offset + alignment - 1u) & ~(alignment - 1u)) - base;
+            next    = aligned + size;
+            if ((aligned < offset) || (next > this->capacity_))
+            {
+                this->failure_count_.fetch_add(1u, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        while (not this->offset_.compare_exchange_weak(offset, next,
+                                                       std::memory_order_relaxed));
+
+        this->padding_.fetch_add(aligned - offset, std::memory_order_relaxed);
+
+        std::size_t high_water = this->high_water_.load(std::memory_order_relaxed);
+        while ((next > high_water) &&
+               not this->high_water_.compare_exchange_weak(high_water, next,
+                                                           std::memory_order_relaxed))
+        {
+        }
+
+        return this->buffer_ + aligned;
+    }
+
+    /** Memory is only released by reset(). */
+    void deallocate(void*, std::size_t) {}
+
+    /** Release all allocations. */
+    void reset()
+    {
+        this->offset_.store(0u, std::memory_order_relaxed);
+        this->padding_.store(0u, std::memory_order_relaxed);
+    }
+
+    /** @return bool true if ptr lies within the allocated part of the arena. */
+    bool owns(void const* ptr) const
+    {
+        uint8_t const* const byte_ptr = static_cast<uint8_t const*>(ptr);
+        return (byte_ptr >= this->buffer_) && (byte_ptr < this->buffer_ + this->size());
+    }
+
+    /** @return std::size_t The number of bytes allocated, including padding. */
+    std::size_t size() const {
+        return this->offset_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity()  const { return this->capacity_; }
+    std::size_t available() const { return this->capacity_ - this->size(); }
+
+    /** @return std::size_t The bytes lost to alignment padding since reset(). */
+    std::size_t padding() const {
+        return this->padding_.load(std::memory_order_relaxed);
+    }
+
+    /** @return std::size_t The largest size() reached. */
+    std::size_t high_water() const {
+        return this->high_water_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t failure_count() const {
+        return this->failure_count_.load(std::memory_order_relaxed);
+    }
+
+    void reset_statistics()
+    {
+        this->high_water_.store(this->size(), std::memory_order_relaxed);
+        this->failure_count_.store(0u, std::memory_order_relaxed);
+    }
+
+private:
+    uint8_t* const              buffer_;
+    std::size_t const           capacity_;
+    std::atomic<std::size_t>    offset_;
+    std::atomic<std::size_t>    padding_;
+    std::atomic<std::size_t>    high_water_;
+    std::atomic<uint32_t>       failure_count_;
+};
@@ -0,0 +1,180 @@
+/**
+ * @file observer_array.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A priority ordered observable backed by a fixed size array of observers.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class observer_array
+ * A priority_observable alternative for a small, fixed number of observers.
+ *
+ * Observer pointers are held contiguously in notification order so that
+ * notifying walks an array rather than chasing list links. The observer
+ * type is a template parameter: when it is a concrete or final class the
+ * compiler can call notify() directly and inline it.
+ *
+ * @tparam observer_type The observer class, providing:
+ *         void notify(notification_type const&) and
+ *         void notify_batch(notification_type const*, std::size_t).
+ *         priority_observer<notification_type> meets these requirements,
+ *         although is_attached() is not maintained by the array.
+ * @tparam observer_max  The maximum number of attached observers.
+ *
+ * @note Observers may detach themselves, or any other observer, from within
+ * a notification; the slot is compacted once the notification completes.
+ * Attaching from within a notification is not supported.
+ */
+template <typename observer_type, std::size_t observer_max>
+class observer_array
+{
+public:
+    using notification_type = typename observer_type::notification_type;
+
+    /// Lower values are notified first.
+    using priority_type = int8_t;
+
+    static constexpr priority_type const priority_default = 0;
+
+    ~observer_array()                                   = default;
+    observer_array()                                    = default;
+    observer_array(observer_array const&)               = delete;
+    observer_array(observer_array&&)                    = delete;
+    observer_array& operator=(observer_array const&)    = delete;
+    observer_array& operator=(observer_array&&)         = delete;
+
+    /**
+     * Attach an observer after all observers of lower or equal priority.
+     *
+     * @param observer The observer to notify with events.
+     * @param priority Lower values are notified first.
+     */
+    void attach(observer_type& observer, priority_type priority = priority_default)
+    {
+        ASSERT(not this->notifying_);
+        ASSERT(this->count_ < observer_max);
+        ASSERT(not this->is_attached(observer));
+
+        std::size_t index = this->count_;
+        for ( ; (index > 0u) && (this->priorities_[index - 1u] > priority); --index)
+        {
+            this->observers_[index]  = this->observers_[index - 1u];
+            this->priorities_[index] = this->priorities_[index - 1u];
+        }
+
+        this->observers_[index]  = &observer;
+        this->priorities_[index] = priority;
+        this->count_ += 1u;
+    }
+
+    void detach(observer_type& observer)
+    {
+        std::size_t const index = this->find(observer);
+        ASSERT(index < this->count_);
+
+        if (this->notifying_)
+        {
+            // Notification is in progress; compact once it completes.
+            this->observers_[index] = nullptr;
+            this->detach_pending_   = true;
+        }
+        else
+        {
+            this->erase(index);
+        }
+    }
+
+    bool is_attached(observer_type const& observer) const
+    {
+        return this->find(observer) < this->count_;
+    }
+
+    /**
+     * Notify all observers of an event.
+     * @param notification The information to be sent as a notification event.
+     */
+    void notify_all(notification_type const &notification)
+    {
+        this->notifying_ = true;
+        for (std::size_t index = 0u; index < this->count_; ++index)
+        {
+            observer_type* const observer = this->observers_[index];
+            if (observer) { observer->notify(notification); }
+        }
+        this->notify_complete();
+    }
+
+    /**
+     * Notify all observers of several events; each observer is visited
+     * once and receives the whole batch through notify_batch().
+     *
+     * @param notifications A contiguous sequence of notifications.
+     * @param count         The number of notifications.
+     */
+    void notify_batch(notification_type const *notifications, std::size_t count)
+    {
+        if (count == 0u) { return; }
+
+        this->notifying_ = true;
+        for (std::size_t index = 0u; index < this->count_; ++index)
+        {
+            observer_type* const observer = this->observers_[index];
+            if (observer) { observer->notify_batch(notifications, count); }
+        }
+        this->notify_complete();
+    }
+
+    /** @return size_t The number of observers attached to this observable. */
+    std::size_t get_observer_count() const { return this->count_; }
+
+    static constexpr std::size_t capacity() { return observer_max; }
+
+private:
+    std::size_t find(observer_type const& observer) const
+    {
+        std::size_t index = 0u;
+        for ( ; index < this->count_; ++index)
+        {
+            if (this->observers_[index] == &observer) { break; }
+        }
+        return index;
+    }
+
+    void erase(std::size_t index)
+    {
+        this->count_ -= 1u;
+        for ( ; (index < this->count_) && (index + 1u < observer_max); ++index)
+        {
+            this->observers_[index]  = this->observers_[index + 1u];
+            this->priorities_[index] = this->priorities_[index + 1u];
+        }
+    }
+
+    void notify_complete()
+    {
+        this->notifying_ = false;
+        if (this->detach_pending_)
+        {
+            this->detach_pending_ = false;
+            std::size_t index = 0u;
+            while (index < this->count_)
+            {
+                if (this->observers_[index]) { ++index; }
+                else                         { this->erase(index); }
+            }
+        }
+    }
+
+    observer_type*  observers_[observer_max]    = {};
+    priority_type   priorities_[observer_max]   = {};
+    std::size_t     count_                      = 0u;
+    bool            notifying_                  = false;
+    bool            detach_pending_             = false;
+};
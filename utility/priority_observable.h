@@ -0,0 +1,134 @@
+/**
+ * @file priority_observable.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#pragma once
+
+#include "priority_observer.h"
+#include "project_assert.h"
+
+#include <cstddef>
+#include <iterator>
+
+/**
+ * @class priority_observable
+ * An observable 'Subject' which notifies its observers in priority order.
+ * @see observable.h for the unordered implementation.
+ *
+ * Observers are kept in an intrusive list sorted by priority. Insertion is
+ * stable: observers of equal priority are notified in the order in which
+ * they were attached. The list keeps its size so get_observer_count()
+ * is constant time.
+ *
+ * Observers may detach themselves from within a notification. An observer
+ * attached from within a notification may or may not receive the
+ * notification in progress, depending on its priority.
+ *
+ * @tparam _notification_type The type of data passed to observers as the
+ * notification within the notify() function.
+ */
+template <typename _notification_type>
+class priority_observable
+{
+public:
+    using notification_type = _notification_type;
+    using observer_type     = priority_observer<notification_type>;
+    using priority_type     = typename observer_type::priority_type;
+
+    ~priority_observable()
+    {
+        this->observer_list_.clear_and_dispose(
+            [](observer_type* observer) { observer->observable_ = nullptr; });
+    }
+
+    priority_observable()                                       = default;
+    priority_observable(priority_observable const&)             = delete;
+    priority_observable(priority_observable&&)                  = delete;
+    priority_observable& operator=(priority_observable const&)  = delete;
+    priority_observable& operator=(priority_observable&&)       = delete;
+
+    /**
+     * Attach an observer after all observers of lower or equal priority.
+     *
+     * @param observer The observer to notify with events.
+     * @param priority Lower values are notified first.
+     */
+    void attach(observer_type&  observer,
+                priority_type   priority = observer_type::priority_default)
+    {
+        ASSERT(not observer.is_attached());
+        observer.observable_ = this;
+        observer.priority_   = priority;
+
+        // Search from the back: observers are typically attached in
+        // priority order so the insertion point is found immediately.
+        auto iter = this->observer_list_.end();
+        while ((iter != this->observer_list_.begin()) &&
+               (std::prev(iter)->priority_ > priority))
+        {
+            --iter;
+        }
+        this->observer_list_.insert(iter, observer);
+    }
+
+    void detach(observer_type& observer)
+    {
+        ASSERT(observer.observable_ == this);
+        observer.observable_ = nullptr;
+        this->observer_list_.erase(this->observer_list_.iterator_to(observer));
+    }
+
+    /**
+     * Notify all observers of an event.
+     * @param notification The information to be sent as a notification event.
+     */
+    void notify_all(notification_type const &notification)
+    {
+        // The observer may detach itself rendering the current iterator
+        // position invalid. Therefore: iterate first, operate next.
+        for (auto iter = this->observer_list_.begin();
+             iter != this->observer_list_.end(); )
+        {
+            observer_type &observer = *iter;
+            ++iter;
+            observer.notify(notification);
+        }
+    }
+
+    /**
+     * Notify all observers of several events; each observer is visited
+     * once and receives the whole batch through notify_batch().
+     *
+     * @param notifications A contiguous sequence of notifications.
+     * @param count         The number of notifications.
+     */
+    void notify_batch(notification_type const *notifications, std::size_t count)
+    {
+        if (count == 0u) { return; }
+
+        for (auto iter = this->observer_list_.begin();
+             iter != this->observer_list_.end(); )
+        {
+            observer_type &observer = *iter;
+            ++iter;
+            observer.notify_batch(notifications, count);
+        }
+    }
+
+    /** @return size_t The number of observers attached to this observable. */
+    std::size_t get_observer_count() const { return this->observer_list_.size(); }
+
+private:
+    using list_type =
+        boost::intrusive::list<
+            observer_type,
+            boost::intrusive::constant_time_size<true>,
+            boost::intrusive::member_hook<
+                observer_type,
+                typename observer_type::list_hook_type,
+                &observer_type::hook_>
+        >;
+
+    list_type observer_list_;
+};
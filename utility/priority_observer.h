@@ -0,0 +1,85 @@
+/**
+ * @file priority_observer.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <boost/intrusive/list.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/// Forward declare the observable so that friendship can be established.
+template <typename _notification_type>
+class priority_observable;
+
+/**
+ * @class priority_observer
+ * An observer which is notified in priority order by a priority_observable.
+ *
+ * Unlike observer, notifications may be delivered in batches:
+ * notify_batch() receives several notifications for a single visit of the
+ * observer. The default implementation calls notify() for each; observers
+ * which can consume a batch more cheaply override it.
+ *
+ * @tparam _notification_type The data type passed as a notification.
+ */
+template <typename _notification_type>
+class priority_observer
+{
+public:
+    using notification_type = _notification_type;
+
+    /// Lower values are notified first.
+    using priority_type = int8_t;
+
+    static constexpr priority_type const priority_default = 0;
+
+    virtual ~priority_observer()
+    {
+        ASSERT(not this->is_attached());
+    }
+
+    priority_observer()                                     = default;
+    priority_observer(priority_observer const&)             = delete;
+    priority_observer(priority_observer &&)                 = delete;
+    priority_observer& operator=(priority_observer const&)  = delete;
+    priority_observer& operator=(priority_observer&&)       = delete;
+
+    /**
+     * @param notification The notification data passed to the observer from
+     * the observable.
+     */
+    virtual void notify(notification_type const &notification) = 0;
+
+    /**
+     * @param notifications A contiguous sequence of notifications, in the
+     *                      order in which they occurred.
+     * @param count         The number of notifications.
+     */
+    virtual void notify_batch(notification_type const *notifications,
+                              std::size_t              count)
+    {
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+            this->notify(notifications[index]);
+        }
+    }
+
+    bool is_attached() const { return this->observable_ != nullptr; }
+
+    priority_type priority() const { return this->priority_; }
+
+private:
+    using list_hook_type = boost::intrusive::list_member_hook<
+        boost::intrusive::link_mode<boost::intrusive::safe_link>
+        >;
+
+    list_hook_type                                  hook_;
+    priority_observable<notification_type>*         observable_ = nullptr;
+    priority_type                                   priority_   = priority_default;
+
+    friend class priority_observable<notification_type>;
+};
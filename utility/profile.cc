@@ -0,0 +1,79 @@
+/**
+ * @file profile.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "profile.h"
+#include "logger.h"
+#include "stream.h"
+
+#include <cstring>
+
+namespace profile
+{
+
+void reset()
+{
+    for (zone_stats* zone = zone_stats::first(); zone; zone = zone->next())
+    {
+        zone->reset();
+    }
+}
+
+void dump(logger& logger)
+{
+    for (zone_stats const* zone = zone_stats::first(); zone; zone = zone->next())
+    {
+        logger.info("profile: %-20s count: %8u, min: %8u, max: %8u, mean: %8u %s",
+                    zone->name(), zone->count(),
+                    zone->min(), zone->max(), zone->mean(), counter_units);
+
+        using histogram_type = zone_stats::histogram_type;
+        for (std::size_t bin = 0u; bin < histogram_type::bin_count; ++bin)
+        {
+            if (zone->histogram()[bin] != 0u)
+            {
+                logger.info("    >= %8u: %8u", histogram_type::bin_lower(bin),
+                            zone->histogram()[bin]);
+            }
+        }
+    }
+}
+
+std::size_t write_binary(io::output_stream& os)
+{
+    binary_header header = {
+        .magic          = binary_magic,
+        .zone_count     = 0u,
+        .histogram_bins = zone_stats::histogram_type::bin_count
+    };
+
+    // Zones registered while writing are pushed ahead of first; not written.
+    zone_stats const* const first = zone_stats::first();
+    for (zone_stats const* zone = first; zone; zone = zone->next())
+    {
+        header.zone_count += 1u;
+    }
+
+    std::size_t length = os.write(&header, sizeof(header));
+
+    for (zone_stats const* zone = first; zone; zone = zone->next())
+    {
+        binary_zone record;
+        std::strncpy(record.name, zone->name(), sizeof(record.name));
+        record.count = zone->count();
+        record.min   = zone->min();
+        record.max   = zone->max();
+        record.mean  = zone->mean();
+        for (std::size_t bin = 0u; bin < zone_stats::histogram_type::bin_count; ++bin)
+        {
+            record.histogram[bin] = zone->histogram()[bin];
+        }
+
+        length += os.write(&record, sizeof(record));
+    }
+
+    return length;
+}
+
+} // namespace profile
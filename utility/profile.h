@@ -0,0 +1,247 @@
+/**
+ * @file profile.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A hot path profiler: scoped zones timed by the cycle counter.
+ *
+ * @example
+ *     void gatts_write(...)
+ *     {
+ *         PROFILE_ZONE("gatts_write");
+ *         ...
+ *     }
+ *
+ * Each zone keeps its count, min, max, mean and a log2 histogram of its
+ * duration in a static zone_stats. The zones register themselves into a
+ * list on first use; profile::dump() writes them to a logger and
+ * profile::write_binary() to an output stream, typically an
+ * rtt_output_stream on its own RTT channel.
+ *
+ * Durations are measured with:
+ * - The target: the DWT cycle counter, CYCCNT; in CPU clock cycles.
+ *   Call profile::cycle_counter_enable() once at start up.
+ * - The host: std::chrono::steady_clock; in nanoseconds.
+ *
+ * PROFILE_ZONE() compiles to nothing unless PROFILE_ENABLED is defined.
+ */
+
+#pragma once
+
+#include "log2_histogram.h"
+#include "registry_node.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if ! defined __arm__
+#include <chrono>
+#endif
+
+class logger;
+namespace io { class output_stream; }
+
+namespace profile
+{
+/// The cycle counter is 32 bits wide; durations are wrap safe differences.
+using cycles_t = uint32_t;
+
+#if defined __arm__
+constexpr char const counter_units[] = "cycles";
+#else
+constexpr char const counter_units[] = "ns";
+#endif
+
+/// @return cycles_t The free running cycle counter.
+inline cycles_t cycle_count()
+{
+#if defined __arm__
+    // DWT_CYCCNT
+    return *reinterpret_cast<uint32_t volatile const*>(0xE0001004u);
+#else
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<cycles_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+#endif
+}
+
+/**
+ * Enable the DWT cycle counter. The counter stops counting while the CPU
+ * sleeps (WFE, WFI) since the CPU clock is gated.
+ */
+inline void cycle_counter_enable()
+{
+#if defined __arm__
+    uint32_t volatile* const demcr    = reinterpret_cast<uint32_t volatile*>(0xE000EDFCu);
+    uint32_t volatile* const dwt_ctrl = reinterpret_cast<uint32_t volatile*>(0xE0001000u);
+    uint32_t volatile* const cyccnt   = reinterpret_cast<uint32_t volatile*>(0xE0001004u);
+
+    *demcr    |= (1u << 24u);       // DEMCR.TRCENA: enable the DWT.
+    *cyccnt    = 0u;
+    *dwt_ctrl |= (1u << 0u);        // DWT_CTRL.CYCCNTENA
+#endif
+}
+
+/**
+ * @class zone_stats
+ * The duration statistics for a profile zone.
+ *
+ * A zone is expected to be recorded from a single execution context;
+ * a zone entered from both thread and ISR context may lose a sample.
+ * The constructor is constexpr so that a function local static zone is
+ * constant initialized, without a guard variable.
+ */
+class zone_stats: public registry_node<zone_stats>
+{
+public:
+    using histogram_type = log2_histogram<24u>;
+
+    ~zone_stats()                               = default;
+
+    zone_stats()                                = delete;
+    zone_stats(zone_stats const&)               = delete;
+    zone_stats(zone_stats &&)                   = delete;
+    zone_stats& operator=(zone_stats const&)    = delete;
+    zone_stats& operator=(zone_stats&&)         = delete;
+
+    constexpr explicit zone_stats(char const* name)
+        : registry_node(),
+          name_(name),
+          count_(0u),
+          min_(std::numeric_limits<cycles_t>::max()),
+          max_(0u),
+          total_(0u),
+          histogram_()
+    {
+    }
+
+    void record(cycles_t cycles)
+    {
+        if (not this->is_registered())
+        {
+            this->register_node();
+        }
+
+        this->count_ += 1u;
+        this->total_ += cycles;
+        this->min_    = (cycles < this->min_) ? cycles : this->min_;
+        this->max_    = (cycles > this->max_) ? cycles : this->max_;
+        this->histogram_.record(cycles);
+    }
+
+    void reset()
+    {
+        this->count_ = 0u;
+        this->total_ = 0u;
+        this->min_   = std::numeric_limits<cycles_t>::max();
+        this->max_   = 0u;
+        this->histogram_.reset();
+    }
+
+    char const*             name()      const { return this->name_; }
+    uint32_t                count()     const { return this->count_; }
+    uint64_t                total()     const { return this->total_; }
+    cycles_t                max()       const { return this->max_; }
+    histogram_type const&   histogram() const { return this->histogram_; }
+
+    /// @return cycles_t The minimum duration; zero if not yet recorded.
+    cycles_t min() const
+    {
+        return (this->count_ == 0u) ? 0u : this->min_;
+    }
+
+    /// @return cycles_t The mean duration, truncated; zero if not yet recorded.
+    cycles_t mean() const
+    {
+        return (this->count_ == 0u) ? 0u : static_cast<cycles_t>(this->total_ / this->count_);
+    }
+
+private:
+    char const*         name_;
+    uint32_t            count_;
+    cycles_t            min_;
+    cycles_t            max_;
+    uint64_t            total_;
+    histogram_type      histogram_;
+};
+
+/**
+ * @class zone_scope
+ * Record the duration from construction to destruction into a zone.
+ */
+class zone_scope
+{
+public:
+    zone_scope()                                = delete;
+    zone_scope(zone_scope const&)               = delete;
+    zone_scope(zone_scope &&)                   = delete;
+    zone_scope& operator=(zone_scope const&)    = delete;
+    zone_scope& operator=(zone_scope&&)         = delete;
+
+    explicit zone_scope(zone_stats& zone) : zone_(zone), start_(cycle_count()) {}
+
+    ~zone_scope() { this->zone_.record(cycle_count() - this->start_); }
+
+private:
+    zone_stats&     zone_;
+    cycles_t const  start_;
+};
+
+/// Reset the statistics of all registered zones.
+void reset();
+
+/**
+ * Write the statistics of all registered zones to the logger, one line per
+ * zone and one line of non-zero histogram bins, at level::info.
+ */
+void dump(logger& logger);
+
+/**
+ * The binary dump format written by write_binary(); little endian.
+ * A binary_header followed by header.zone_count binary_zone records.
+ */
+struct binary_header
+{
+    uint32_t    magic;              ///< binary_magic
+    uint16_t    zone_count;
+    uint16_t    histogram_bins;
+} __attribute__((packed));
+
+struct binary_zone
+{
+    char        name[16u];          ///< Truncated, null padded.
+    uint32_t    count;
+    uint32_t    min;
+    uint32_t    max;
+    uint32_t    mean;
+    uint32_t    histogram[zone_stats::histogram_type::bin_count];
+} __attribute__((packed));
+
+constexpr uint32_t const binary_magic = 0x30465250u;   // "PRF0"
+
+/**
+ * Write the statistics of all registered zones in the binary format.
+ * For an rtt_output_stream use a channel with overflow_policy::block so
+ * that records are not split.
+ *
+ * @return std::size_t The number of bytes written.
+ */
+std::size_t write_binary(io::output_stream& os);
+
+} // namespace profile
+
+#if defined PROFILE_ENABLED
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+
+#define PROFILE_ZONE(zone_name)                                                       \
+    static ::profile::zone_stats PROFILE_CONCAT(profile_zone_, __LINE__)(zone_name);  \
+    ::profile::zone_scope PROFILE_CONCAT(profile_scope_, __LINE__)(                   \
+        PROFILE_CONCAT(profile_zone_, __LINE__))
+
+#else
+
+#define PROFILE_ZONE(zone_name) do {} while (0)
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file registry_node.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A lock free, self registering list of statically allocated records.
+ */
+
+#pragma once
+
+#include <atomic>
+
+/**
+ * @class registry_node
+ * A node_type registers itself into a list of all node_type instances the
+ * first time it is used; node_type::first() and next() walk the list.
+ *
+ * Registration pushes onto the list head with a compare and swap and may
+ * be made from any context, thread or ISR. The list is walked from thread
+ * context; nodes registered during a walk are pushed ahead of it.
+ *
+ * The constructor is constexpr so that a derived class with a constexpr
+ * constructor is constant initialized, without a guard variable.
+ *
+ * @example
+ *     class zone_stats: public registry_node<zone_stats> { ... };
+ *
+ * @tparam node_type The derived class.
+ */
+template <typename node_type>
+class registry_node
+{
+public:
+    registry_node(registry_node const&)             = delete;
+    registry_node(registry_node &&)                 = delete;
+    registry_node& operator=(registry_node const&)  = delete;
+    registry_node& operator=(registry_node&&)       = delete;
+
+    /// @return node_type* The next registered node; null at the end.
+    node_type* next() const { return this->next_; }
+
+    /// @return node_type* The most recently registered node; null if none.
+    static node_type* first() { return list_head().load(std::memory_order_acquire); }
+
+    bool is_registered() const { return this->registered_.load(std::memory_order_relaxed); }
+
+protected:
+    ~registry_node()                                = default;
+
+    constexpr registry_node() : next_(nullptr), registered_(false) {}
+
+    /// Push the node on to the list; only the first call registers.
+    void register_node()
+    {
+        if (this->registered_.exchange(true)) { return; }
+
+        std::atomic<node_type*>& head = list_head();
+        node_type* first = head.load(std::memory_order_relaxed);
+        do
+        {
+            this->next_ = first;
+        }
+        while (not head.compare_exchange_weak(first, static_cast<node_type*>(this),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+
+    /**
+     * Unlink a registered node. Must be called from thread context and
+     * not concurrently with another unregister_node().
+     */
+    void unregister_node()
+    {
+        if (not this->registered_.exchange(false)) { return; }
+
+        // Registration pushes onto the head; unlinking the head requires a CAS.
+        std::atomic<node_type*>& head = list_head();
+        node_type* expected = static_cast<node_type*>(this);
+        if (head.compare_exchange_strong(expected, this->next_)) { return; }
+
+        for (registry_node* node = head.load(); node; node = node->next_)
+        {
+            if (node->next_ == this)
+            {
+                node->next_ = this->next_;
+                return;
+            }
+        }
+    }
+
+private:
+    static std::atomic<node_type*>& list_head()
+    {
+        static std::atomic<node_type*> head(nullptr);
+        return head;
+    }
+
+    node_type*          next_;
+    std::atomic<bool>   registered_;
+};
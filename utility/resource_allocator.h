@@ -0,0 +1,95 @@
+/**
+ * @file resource_allocator.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#pragma once
+
+#include "project_assert.h"
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @class resource_allocator
+ * An STL allocator which draws memory from a memory resource:
+ * block_pool, slab_allocator or monotonic_arena.
+ * @see https://en.cppreference.com/w/cpp/named_req/Allocator
+ *
+ * The resource is held by reference; it must outlive all containers which
+ * use it. Allocators compare equal when they share the same resource.
+ * When the resource is exhausted std::bad_alloc is thrown if exceptions are
+ * enabled; otherwise it is an assertion failure.
+ *
+ * @tparam data_type     The data type which is to be allocated.
+ * @tparam resource_type The memory resource, providing
+ *                       void* allocate(size, alignment) and
+ *                       void deallocate(void*, size).
+ */
+template <typename data_type, typename resource_type>
+class resource_allocator
+{
+public:
+    using value_type = data_type;
+
+    template <typename other_type> struct rebind
+    {
+        using other = resource_allocator<other_type, resource_type>;
+    };
+
+    ~resource_allocator()                                       = default;
+
+    resource_allocator()                                        = delete;
+    resource_allocator(resource_allocator const&)               = default;
+    resource_allocator(resource_allocator &&)                   = default;
+    resource_allocator& operator=(resource_allocator const&)    = default;
+    resource_allocator& operator=(resource_allocator&&)         = default;
+
+    explicit resource_allocator(resource_type& resource) : resource_(&resource) {}
+
+    /// Required by rebind.
+    template <typename other_type>
+    resource_allocator(resource_allocator<other_type, resource_type> const& other) :
+        resource_(&other.resource())
+    {
+    }
+
+    value_type* allocate(std::size_t count)
+    {
+        void* const ptr = this->resource_->allocate(count * sizeof(value_type),
+                                                    alignof(value_type));
+        if (ptr == nullptr)
+        {
+#if defined __cpp_exceptions
+            throw std::bad_alloc();
+#else
+            ASSERT(0);
+#endif
+        }
+        return static_cast<value_type*>(ptr);
+    }
+
+    void deallocate(value_type* ptr, std::size_t count)
+    {
+        this->resource_->deallocate(ptr, count * sizeof(value_type));
+    }
+
+    resource_type& resource() const { return *this->resource_; }
+
+private:
+    resource_type* resource_;
+};
+
+template <typename type_1, typename type_2, typename resource_type>
+bool operator == (resource_allocator<type_1, resource_type> const& alloc_1,
+                  resource_allocator<type_2, resource_type> const& alloc_2)
+{
+    return &alloc_1.resource() == &alloc_2.resource();
+}
+
+template <typename type_1, typename type_2, typename resource_type>
+bool operator != (resource_allocator<type_1, resource_type> const& alloc_1,
+                  resource_allocator<type_2, resource_type> const& alloc_2)
+{
+    return not (alloc_1 == alloc_2);
+}
@@ -0,0 +1,282 @@
+/**
+ * @file run_loop.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "run_loop.h"
+#include "logger.h"
+#include "stream.h"
+#include "project_assert.h"
+
+static char const* const sleep_mode_names[sleep_mode_count] = {
+    "none",
+    "wait_for_event",
+    "low_power"
+};
+
+run_loop::run_loop(run_loop_hooks& hooks) :
+    hooks_(hooks),
+    posted_{},
+    ready_{},
+    coalesced_count_(0u),
+    logger_(nullptr),
+    flush_latency_ticks_(ticks_forever),
+    flush_pending_threshold_(0u),
+    flush_guard_ticks_(0u),
+    flush_pending_since_(0u),
+    flush_pending_(false),
+    ticks_wake_(0u),
+    ticks_wake_valid_(false),
+    stats_{}
+{
+}
+
+bool run_loop::post(work_item& item)
+{
+    ASSERT(item.priority_ < priority_count);
+
+    if (item.pending_.exchange(true, std::memory_order_acquire))
+    {
+        this->coalesced_count_.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::atomic<work_item*>& posted = this->posted_[item.priority_];
+    work_item* head = posted.load(std::memory_order_relaxed);
+    do
+    {
+        item.next_ = head;
+    }
+    while (not posted.compare_exchange_weak(head, &item,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+    return true;
+}
+
+void run_loop::logger_flush_set(logger&       logger,
+                                uint32_t      latency_ticks,
+                                std::size_t   pending_threshold,
+                                uint32_t      guard_ticks)
+{
+    this->logger_                  = &logger;
+    this->flush_latency_ticks_     = latency_ticks;
+    this->flush_pending_threshold_ = pending_threshold;
+    this->flush_guard_ticks_       = guard_ticks;
+    this->flush_pending_           = false;
+}
+
+bool run_loop::has_work() const
+{
+    for (std::atomic<work_item*> const& posted : this->posted_)
+    {
+        if (posted.load(std::memory_order_relaxed)) { return true; }
+    }
+    return false;
+}
+
+bool run_loop::collect(work_item::priority_t priority)
+{
+    std::atomic<work_item*>& posted = this->posted_[priority];
+    if (posted.load(std::memory_order_relaxed) == nullptr)
+    {
+        return false;
+    }
+
+    // The posted list is last in, first out; reverse it into post order.
+    work_item* item  = posted.exchange(nullptr, std::memory_order_acquire);
+    work_item* ready = this->ready_[priority];
+    work_item* fifo  = nullptr;
+    while (item)
+    {
+        work_item* const next = item->next_;
+        item->next_ = fifo;
+        fifo = item;
+        item = next;
+    }
+
+    if (ready == nullptr)
+    {
+        this->ready_[priority] = fifo;
+    }
+    else
+    {
+        while (ready->next_) { ready = ready->next_; }
+        ready->next_ = fifo;
+    }
+
+    return true;
+}
+
+std::size_t run_loop::dispatch()
+{
+    for (work_item::priority_t priority = 0u; priority < priority_count; ++priority)
+    {
+        this->collect(priority);
+    }
+
+    std::size_t run_count = 0u;
+    work_item::priority_t priority = 0u;
+    while (priority < priority_count)
+    {
+        work_item* const item = this->ready_[priority];
+        if (item == nullptr)
+        {
+            priority += 1u;
+            continue;
+        }
+
+        // Once the item is no longer pending it may be posted again.
+        this->ready_[priority] = item->next_;
+        item->next_ = nullptr;
+        item->pending_.store(false, std::memory_order_release);
+        item->run();
+
+        this->stats_.run_count[priority] += 1u;
+        run_count += 1u;
+
+        for (work_item::priority_t higher = 0u; higher < priority; ++higher)
+        {
+            if (this->collect(higher))
+            {
+                priority = higher;
+                break;
+            }
+        }
+    }
+
+    return run_count;
+}
+
+uint32_t run_loop::flush_check(uint32_t ticks_now, uint32_t ticks_deadline)
+{
+    io::output_stream* const os = this->logger_ ? this->logger_->get_output_stream() : nullptr;
+    if (os == nullptr)
+    {
+        return ticks_forever;
+    }
+
+    std::size_t const pending = os->write_pending();
+    if (pending == 0u)
+    {
+        this->flush_pending_ = false;
+        return ticks_forever;
+    }
+
+    if (not this->flush_pending_)
+    {
+        this->flush_pending_       = true;
+        this->flush_pending_since_ = ticks_now;
+    }
+
+    uint32_t const ticks_age = ticks_now - this->flush_pending_since_;
+    if ((pending < this->flush_pending_threshold_) && (ticks_age < this->flush_latency_ticks_))
+    {
+        return this->flush_latency_ticks_ - ticks_age;
+    }
+
+    if (ticks_deadline <= this->flush_guard_ticks_)
+    {
+        this->stats_.flush_deferred_count += 1u;
+        return ticks_forever;
+    }
+
+    this->logger_->flush();
+    this->stats_.flush_count += 1u;
+
+    // A flush which timed out restarts the latency interval.
+    if (os->write_pending() == 0u)
+    {
+        this->flush_pending_ = false;
+        return ticks_forever;
+    }
+
+    this->flush_pending_since_ = this->hooks_.ticks_now();
+    return this->flush_latency_ticks_;
+}
+
+std::size_t run_loop::run_once()
+{
+    if (not this->ticks_wake_valid_)
+    {
+        this->ticks_wake_       = this->hooks_.ticks_now();
+        this->ticks_wake_valid_ = true;
+    }
+
+    std::size_t const run_count = this->dispatch();
+    this->stats_.pass_count += 1u;
+
+    uint32_t const ticks_flush = this->flush_check(this->hooks_.ticks_now(),
+                                                   this->hooks_.ticks_until_deadline());
+    if (this->has_work())
+    {
+        return run_count;
+    }
+
+    uint32_t const ticks_deadline = this->hooks_.ticks_until_deadline();
+    uint32_t const ticks_idle     = (ticks_flush < ticks_deadline) ? ticks_flush : ticks_deadline;
+    sleep_mode const mode         = this->hooks_.sleep_select(ticks_idle);
+
+    uint32_t const ticks_sleep = this->hooks_.ticks_now();
+    this->stats_.ticks_active += ticks_sleep - this->ticks_wake_;
+
+    this->hooks_.sleep(mode, ticks_idle);
+
+    this->ticks_wake_ = this->hooks_.ticks_now();
+    std::size_t const mode_index = static_cast<std::size_t>(mode);
+    this->stats_.sleep_count[mode_index] += 1u;
+    this->stats_.ticks_sleep[mode_index] += this->ticks_wake_ - ticks_sleep;
+
+    return run_count;
+}
+
+void run_loop::run()
+{
+    for (;;)
+    {
+        this->run_once();
+    }
+}
+
+uint32_t run_loop::duty_cycle_permille() const
+{
+    uint64_t const ticks_awake = this->stats_.ticks_active +
+        this->stats_.ticks_sleep[static_cast<std::size_t>(sleep_mode::none)];
+
+    uint64_t ticks_total = this->stats_.ticks_active;
+    for (uint64_t ticks_sleep : this->stats_.ticks_sleep)
+    {
+        ticks_total += ticks_sleep;
+    }
+
+    return (ticks_total == 0u) ? 0u :
+        static_cast<uint32_t>((ticks_awake * 1000u) / ticks_total);
+}
+
+void run_loop::reset_statistics()
+{
+    this->stats_ = statistics{};
+    this->coalesced_count_.store(0u, std::memory_order_relaxed);
+    this->ticks_wake_valid_ = false;
+}
+
+void run_loop::dump(logger& logger) const
+{
+    uint32_t const duty_cycle = this->duty_cycle_permille();
+    logger.info("run loop: passes: %u, duty cycle: %u.%u%%, coalesced: %u, flushes: %u, deferred: %u",
+                this->stats_.pass_count, duty_cycle / 10u, duty_cycle % 10u,
+                this->coalesced_count(), this->stats_.flush_count,
+                this->stats_.flush_deferred_count);
+
+    for (std::size_t priority = 0u; priority < priority_count; ++priority)
+    {
+        logger.info("run loop: priority %u: runs: %8u",
+                    static_cast<unsigned int>(priority), this->stats_.run_count[priority]);
+    }
+
+    for (std::size_t mode = 0u; mode < sleep_mode_count; ++mode)
+    {
+        logger.info("run loop: sleep %-14s count: %8u, ticks: %10llu",
+                    sleep_mode_names[mode], this->stats_.sleep_count[mode],
+                    static_cast<unsigned long long>(this->stats_.ticks_sleep[mode]));
+    }
+}
@@ -0,0 +1,291 @@
+/**
+ * @file run_loop.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A cooperative main loop: prioritised work items posted from ISRs,
+ * batched logger flushing and a sleep depth chosen from the next timer
+ * deadline.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class logger;
+class run_loop;
+
+/**
+ * @class work_item
+ * A unit of deferred work run by a run_loop at thread priority.
+ *
+ * An item is either idle or pending; posting a pending item is coalesced
+ * into the pending run. The item is idle again when run() is called, so
+ * run() may post the item again. An item must not be destroyed while it
+ * is pending.
+ */
+class work_item
+{
+public:
+    /// Lower values run first; [0, run_loop::priority_count).
+    using priority_t = uint8_t;
+
+    virtual ~work_item()                        = default;
+
+    work_item()                                 = delete;
+    work_item(work_item const&)                 = delete;
+    work_item(work_item &&)                     = delete;
+    work_item& operator=(work_item const&)      = delete;
+    work_item& operator=(work_item&&)           = delete;
+
+    /**
+     * @param loop     The run loop which runs this item.
+     * @param priority The item priority; lower values run first.
+     */
+    constexpr work_item(run_loop& loop, priority_t priority)
+        : loop_(loop), next_(nullptr), pending_(false), priority_(priority)
+    {
+    }
+
+    virtual void run() = 0;
+
+    /**
+     * Schedule the item to run. May be called from any ISR.
+     * @return bool true if posted, false if already pending.
+     */
+    bool post();
+
+    bool       is_pending() const { return this->pending_.load(std::memory_order_relaxed); }
+    priority_t priority()   const { return this->priority_; }
+
+private:
+    friend class run_loop;
+
+    run_loop&           loop_;
+    work_item*          next_;
+    std::atomic<bool>   pending_;
+    priority_t const    priority_;
+};
+
+/**
+ * @class work_function
+ * A work item which calls a function; for posting from C style handlers.
+ */
+class work_function: public work_item
+{
+public:
+    using function_type = void (*)(void* context);
+
+    virtual ~work_function() override = default;
+
+    constexpr work_function(run_loop&       loop,
+                            priority_t      priority,
+                            function_type   function,
+                            void*           context = nullptr)
+        : work_item(loop, priority), function_(function), context_(context)
+    {
+    }
+
+    virtual void run() override { this->function_(this->context_); }
+
+private:
+    function_type const function_;
+    void* const         context_;
+};
+
+/// The sleep depths, shallowest first.
+enum class sleep_mode: uint8_t
+{
+    none = 0,           ///< Do not sleep; the next deadline is too close.
+    wait_for_event,     ///< Sleep with constant wake latency.
+    low_power,          ///< Sleep with the lowest power and a longer wake latency.
+};
+
+static constexpr std::size_t const sleep_mode_count = 3u;
+
+/**
+ * @class run_loop_hooks
+ * The time source and the low power policy used by a run_loop.
+ * Ticks are free running and wrap at 32 bits.
+ */
+class run_loop_hooks
+{
+public:
+    virtual ~run_loop_hooks()                           = default;
+
+    run_loop_hooks(run_loop_hooks const&)               = delete;
+    run_loop_hooks(run_loop_hooks &&)                   = delete;
+    run_loop_hooks& operator=(run_loop_hooks const&)    = delete;
+    run_loop_hooks& operator=(run_loop_hooks&&)         = delete;
+
+    run_loop_hooks() :
+        spin_ticks_max_(0u),
+        low_power_ticks_min_(UINT32_MAX)
+    {
+    }
+
+    /// @return uint32_t The current tick count.
+    virtual uint32_t ticks_now() = 0;
+
+    /**
+     * @return uint32_t The ticks until the timer scheduler's next deadline.
+     * @retval run_loop::ticks_forever If no deadline is scheduled.
+     */
+    virtual uint32_t ticks_until_deadline() = 0;
+
+    /**
+     * Choose the sleep depth for an idle interval. Idle intervals up to
+     * spin_ticks_max do not sleep; intervals of at least
+     * low_power_ticks_min sleep in low_power.
+     */
+    virtual sleep_mode sleep_select(uint32_t ticks_idle)
+    {
+        if (ticks_idle <= this->spin_ticks_max_)
+        {
+            return sleep_mode::none;
+        }
+
+        return (ticks_idle < this->low_power_ticks_min_) ? sleep_mode::wait_for_event
+                                                         : sleep_mode::low_power;
+    }
+
+    /**
+     * Sleep until an event; return no later than ticks_idle from now.
+     * sleep_mode::none returns immediately.
+     */
+    virtual void sleep(sleep_mode mode, uint32_t ticks_idle) = 0;
+
+    void sleep_thresholds_set(uint32_t spin_ticks_max, uint32_t low_power_ticks_min)
+    {
+        this->spin_ticks_max_      = spin_ticks_max;
+        this->low_power_ticks_min_ = low_power_ticks_min;
+    }
+
+private:
+    uint32_t spin_ticks_max_;
+    uint32_t low_power_ticks_min_;
+};
+
+/**
+ * @class run_loop
+ * Run posted work items in priority order, flush the logger in batches
+ * and sleep when idle.
+ *
+ * Each priority has a lock-free list which ISRs push onto. A pass of
+ * run_once() takes the items posted to every priority and runs them
+ * highest priority first, in the order posted. After each item the
+ * priorities above it are checked for new posts, which run before the
+ * rest of the pass. Posts at the running priority or below are taken by
+ * the next pass, so an item which posts itself runs at most once per
+ * lower priority item and cannot starve the loop.
+ *
+ * After each pass the logger is flushed if its pending data is older
+ * than the flush latency or larger than the flush threshold, and the
+ * flush would not delay the next timer deadline. When no work is pending
+ * the loop then sleeps until the next timer deadline or flush latency
+ * expiration.
+ */
+class run_loop
+{
+public:
+    static constexpr std::size_t const priority_count = 4u;
+    static constexpr uint32_t    const ticks_forever  = UINT32_MAX;
+
+    struct statistics
+    {
+        uint32_t    pass_count;
+        uint32_t    run_count[priority_count];
+        uint32_t    sleep_count[sleep_mode_count];
+        uint64_t    ticks_sleep[sleep_mode_count];
+        uint64_t    ticks_active;
+        uint32_t    flush_count;
+        uint32_t    flush_deferred_count;   ///< Passes which held back a due flush.
+    };
+
+    ~run_loop()                             = default;
+
+    run_loop()                              = delete;
+    run_loop(run_loop const&)               = delete;
+    run_loop(run_loop &&)                   = delete;
+    run_loop& operator=(run_loop const&)    = delete;
+    run_loop& operator=(run_loop&&)         = delete;
+
+    explicit run_loop(run_loop_hooks& hooks);
+
+    /**
+     * Schedule a work item to run. May be called from any ISR.
+     * @return bool true if posted, false if already pending.
+     */
+    bool post(work_item& item);
+
+    /**
+     * Flush the logger from the run loop.
+     *
+     * @param logger            The logger to flush.
+     * @param latency_ticks     The longest time log data waits for a flush.
+     * @param pending_threshold Flush when this many bytes are pending.
+     * @param guard_ticks       Do not flush within this many ticks of the
+     *                          next timer deadline.
+     */
+    void logger_flush_set(logger&       logger,
+                          uint32_t      latency_ticks,
+                          std::size_t   pending_threshold,
+                          uint32_t      guard_ticks);
+
+    /**
+     * Run the pending work, flush the logger when due and sleep if idle.
+     * @return std::size_t The number of work items run.
+     */
+    std::size_t run_once();
+
+    /// The main loop; does not return.
+    void run();
+
+    /// @return bool true if work items are pending.
+    bool has_work() const;
+
+    statistics const& stats() const { return this->stats_; }
+
+    /// The posts of items which were already pending.
+    uint32_t coalesced_count() const { return this->coalesced_count_; }
+
+    /**
+     * @return uint32_t The time awake, including sleep_mode::none, as
+     *                  parts per thousand of the time measured.
+     */
+    uint32_t duty_cycle_permille() const;
+
+    void reset_statistics();
+
+    /// Write the statistics to the logger at level::info.
+    void dump(logger& logger) const;
+
+private:
+    /// Move the items posted to a priority into its ready list.
+    bool collect(work_item::priority_t priority);
+
+    std::size_t dispatch();
+    uint32_t    flush_check(uint32_t ticks_now, uint32_t ticks_deadline);
+
+    run_loop_hooks&                 hooks_;
+    std::atomic<work_item*>         posted_[priority_count];
+    work_item*                      ready_[priority_count];
+    std::atomic<uint32_t>           coalesced_count_;
+
+    logger*                         logger_;
+    uint32_t                        flush_latency_ticks_;
+    std::size_t                     flush_pending_threshold_;
+    uint32_t                        flush_guard_ticks_;
+    uint32_t                        flush_pending_since_;
+    bool                            flush_pending_;
+
+    uint32_t                        ticks_wake_;
+    bool                            ticks_wake_valid_;
+    statistics                      stats_;
+};
+
+inline bool work_item::post()
+{
+    return this->loop_.post(*this);
+}
@@ -0,0 +1,202 @@
+/**
+ * @file slab_allocator.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A size class allocator built from block pools.
+ */
+
+#pragma once
+
+#include "block_pool.h"
+#include "project_assert.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * @class slab_allocator
+ * Allocate variable sized objects from a set of block pools, one pool for
+ * each size class. A request is served by the smallest class whose block
+ * fits it; if that class is exhausted the next larger class is used and the
+ * spill is counted. A failure is counted by the slab_allocator, once every
+ * class which fits the request is exhausted; the class pools do not count
+ * a spill as a failure.
+ *
+ * Allocation and deallocation are O(class_count) and lock-free; they are as
+ * ISR safe as block_pool.
+ *
+ * @tparam class_count The number of size classes.
+ */
+template <std::size_t class_count>
+class slab_allocator
+{
+public:
+    ~slab_allocator()                                   = default;
+
+    slab_allocator()                                    = delete;
+    slab_allocator(slab_allocator const&)               = delete;
+    slab_allocator(slab_allocator &&)                   = delete;
+    slab_allocator& operator=(slab_allocator const&)    = delete;
+    slab_allocator& operator=(slab_allocator&&)         = delete;
+
+    /**
+     * @param pools The size class pools, in increasing block size order.
+     *              The pools must outlive the slab_allocator.
+     */
+    slab_allocator(std::initializer_list<block_pool*> pools) :
+        pools_(),
+        spill_count_(0u),
+        failure_count_(0u)
+    {
+        ASSERT(pools.size() == class_count);
+
+        std::size_t index = 0u;
+        for (block_pool* pool : pools)
+        {
+            ASSERT(pool != nullptr);
+            ASSERT((index == 0u) ||
+                   (this->pools_[index - 1u]->block_size() < pool->block_size()));
+            this->pools_[index++] = pool;
+        }
+    }
+
+    /**
+     * @return void* A block of at least size bytes aligned to alignment;
+     *               nullptr if no size class can satisfy the request.
+     */
+    void* allocate(std::size_t size,
+                   std::size_t alignment = alignof(std::max_align_t))
+    {
+        bool fits = false;
+        for (block_pool* pool : this->pools_)
+        {
+            if ((size > pool->block_size()) || (alignment > pool->alignment()))
+            {
+                continue;
+            }
+
+            if (fits)
+            {
+                this->spill_count_.fetch_add(1u, std::memory_order_relaxed);
+            }
+            fits = true;
+
+            void* const block_ptr = pool->try_allocate(size, alignment);
+            if (block_ptr)
+            {
+                return block_ptr;
+            }
+        }
+
+        this->failure_count_.fetch_add(1u, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    /** @param size The size passed to allocate() for this block. */
+    void deallocate(void* block_ptr, std::size_t size)
+    {
+        block_pool* const pool = this->owner(block_ptr);
+        ASSERT(pool != nullptr);
+        pool->deallocate(block_ptr, size);
+    }
+
+    /** @return block_pool* The size class pool containing ptr; or nullptr. */
+    block_pool* owner(void const* ptr) const
+    {
+        for (block_pool* pool : this->pools_)
+        {
+            if (pool->owns(ptr))
+            {
+                return pool;
+            }
+        }
+        return nullptr;
+    }
+
+    block_pool& size_class(std::size_t index) { return *this->pools_[index]; }
+
+    /** @return std::size_t The largest request which can be satisfied. */
+    std::size_t size_max() const {
+        return this->pools_[class_count - 1u]->block_size();
+    }
+
+    /** @return uint32_t The allocations served by a larger class than best fit. */
+    uint32_t spill_count() const {
+        return this->spill_count_.load(std::memory_order_relaxed);
+    }
+
+    /** @return uint32_t The requests which no size class could serve. */
+    uint32_t failure_count() const {
+        return this->failure_count_.load(std::memory_order_relaxed);
+    }
+
+    /** @return std::size_t The bytes requested by the allocations in use. */
+    std::size_t requested_bytes() const
+    {
+        std::size_t bytes = 0u;
+        for (block_pool const* pool : this->pools_)
+        {
+            bytes += pool->requested_bytes();
+        }
+        return bytes;
+    }
+
+    /** @return std::size_t The bytes of the blocks in use. */
+    std::size_t allocated_bytes() const
+    {
+        std::size_t bytes = 0u;
+        for (block_pool const* pool : this->pools_)
+        {
+            bytes += pool->in_use() * pool->block_stride();
+        }
+        return bytes;
+    }
+
+    /**
+     * @return std::size_t The high-water mark in bytes; the sum of each class
+     * high-water mark. It is an upper bound since the classes need not have
+     * peaked at the same time.
+     */
+    std::size_t high_water_bytes() const
+    {
+        std::size_t bytes = 0u;
+        for (block_pool const* pool : this->pools_)
+        {
+            bytes += pool->high_water() * pool->block_stride();
+        }
+        return bytes;
+    }
+
+    /**
+     * @return unsigned The internal fragmentation of the blocks in use, in
+     * parts per thousand of the allocated bytes.
+     */
+    unsigned int fragmentation_permille() const
+    {
+        std::size_t const allocated = this->allocated_bytes();
+        if (allocated == 0u)
+        {
+            return 0u;
+        }
+        std::size_t const unused = allocated - this->requested_bytes();
+        return static_cast<unsigned int>((unused * 1000u) / allocated);
+    }
+
+    void reset_statistics()
+    {
+        for (block_pool* pool : this->pools_)
+        {
+            pool->reset_statistics();
+        }
+        this->spill_count_.store(0u, std::memory_order_relaxed);
+        this->failure_count_.store(0u, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<block_pool*, class_count>    pools_;
+    std::atomic<uint32_t>                   spill_count_;
+    std::atomic<uint32_t>                   failure_count_;
+};
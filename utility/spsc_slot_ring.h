@@ -0,0 +1,189 @@
+/**
+ * @file spsc_slot_ring.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * A lock-free single producer, single consumer ring of fixed size slots.
+ * The producer is typically an ISR and the consumer the main loop.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @struct spsc_slot
+ * A slot of an spsc_slot_ring. Rings of the same slot_size share the slot
+ * type regardless of their slot count.
+ */
+template <std::size_t slot_size>
+struct spsc_slot
+{
+    /// The producer supplied time at which the slot was pushed.
+    uint32_t timestamp;
+
+    /// The number of valid bytes in data.
+    uint16_t length;
+
+    alignas(uint32_t) uint8_t data[slot_size];
+};
+
+/**
+ * @class spsc_slot_ring
+ *
+ * @tparam slot_size  The maximum number of bytes held in a slot.
+ * @tparam slot_count The number of slots in the ring; must be a power of 2.
+ *
+ * The read and write indices are free running and are masked when used to
+ * access the slots. The producer only writes write_index_ and the consumer
+ * only writes read_index_. Release stores publish the slot contents;
+ * acquire loads observe them. On Cortex-M these compile to plain load/store
+ * with DMB barriers.
+ */
+template <std::size_t slot_size, std::size_t slot_count>
+class spsc_slot_ring
+{
+public:
+    static_assert((slot_count > 0u) && ((slot_count & (slot_count - 1u)) == 0u),
+                  "spsc_slot_ring slot_count must be a power of 2");
+
+    using slot = spsc_slot<slot_size>;
+
+    ~spsc_slot_ring()                                   = default;
+    spsc_slot_ring(spsc_slot_ring const&)               = delete;
+    spsc_slot_ring(spsc_slot_ring&&)                    = delete;
+    spsc_slot_ring& operator=(spsc_slot_ring const&)    = delete;
+    spsc_slot_ring& operator=(spsc_slot_ring&&)         = delete;
+
+    spsc_slot_ring() :
+        write_index_(0u),
+        read_index_(0u),
+        depth_max_(0u),
+        overflow_count_(0u)
+    {
+    }
+
+    /**
+     * Producer: obtain the next free slot to fill in place.
+     * The slot is not visible to the consumer until commit() is called.
+     *
+     * @param keep_free The number of free slots which must remain after this
+     *                  one is taken; held back for higher priority producers.
+     *
+     * @return slot* The slot to fill or nullptr if the ring is full.
+     *               A full ring increments the overflow count.
+     */
+    slot* reserve(std::size_t keep_free = 0u)
+    {
+        uint32_t const write_index = this->write_index_.load(std::memory_order_relaxed);
+        uint32_t const read_index  = this->read_index_.load(std::memory_order_acquire);
+        if (write_index - read_index + keep_free >= slot_count)
+        {
+            this->overflow_count_ += 1u;
+            return nullptr;
+        }
+
+        return &this->slots_[write_index & index_mask];
+    }
+
+    /**
+     * Producer: publish the slot obtained by reserve() to the consumer.
+     */
+    void commit()
+    {
+        uint32_t const write_index = this->write_index_.load(std::memory_order_relaxed) + 1u;
+        this->write_index_.store(write_index, std::memory_order_release);
+
+        uint32_t const depth = write_index - this->read_index_.load(std::memory_order_relaxed);
+        if (depth > this->depth_max_)
+        {
+            this->depth_max_ = depth;
+        }
+    }
+
+    /**
+     * Producer: copy data into the next free slot and publish it.
+     *
+     * @param data      The data to copy.
+     * @param length    The number of bytes to copy; truncated to slot_size.
+     * @param timestamp The time at which the data was produced.
+     * @param keep_free The number of free slots to leave; @see reserve().
+     *
+     * @return bool true if the data was pushed, false if the ring was full.
+     */
+    bool push(void const*   data,
+              std::size_t   length,
+              uint32_t      timestamp,
+              std::size_t   keep_free = 0u)
+    {
+        slot* const slot_ptr = this->reserve(keep_free);
+        if (slot_ptr == nullptr)
+        {
+            return false;
+        }
+
+        length = (length < slot_size) ? length : slot_size;
+        std::memcpy(slot_ptr->data, data, length);
+        slot_ptr->length    = static_cast<uint16_t>(length);
+        slot_ptr->timestamp = timestamp;
+        this->commit();
+        return true;
+    }
+
+    /**
+     * Consumer: access the oldest published slot without removing it.
+     * @return slot const* The oldest slot or nullptr if the ring is empty.
+     */
+    slot const* front() const
+    {
+        uint32_t const read_index  = this->read_index_.load(std::memory_order_relaxed);
+        uint32_t const write_index = this->write_index_.load(std::memory_order_acquire);
+        if (read_index == write_index)
+        {
+            return nullptr;
+        }
+
+        return &this->slots_[read_index & index_mask];
+    }
+
+    /** Consumer: release the slot returned by front() back to the producer. */
+    void pop()
+    {
+        uint32_t const read_index = this->read_index_.load(std::memory_order_relaxed);
+        this->read_index_.store(read_index + 1u, std::memory_order_release);
+    }
+
+    bool empty() const { return this->depth() == 0u; }
+
+    /** @return std::size_t The number of slots published and not yet popped. */
+    std::size_t depth() const
+    {
+        return this->write_index_.load(std::memory_order_acquire) -
+               this->read_index_.load(std::memory_order_acquire);
+    }
+
+    /** @return std::size_t The number of free slots. */
+    std::size_t available() const { return slot_count - this->depth(); }
+
+    /** @return std::size_t The maximum depth observed by the producer. */
+    std::size_t depth_max() const { return this->depth_max_; }
+
+    /** @return uint32_t The number of pushes rejected due to a full ring. */
+    uint32_t overflow_count() const { return this->overflow_count_; }
+
+    static constexpr std::size_t capacity() { return slot_count; }
+
+private:
+    static constexpr uint32_t const index_mask = slot_count - 1u;
+
+    std::atomic<uint32_t>   write_index_;
+    std::atomic<uint32_t>   read_index_;
+
+    /// Statistics are written only by the producer.
+    uint32_t volatile       depth_max_;
+    uint32_t volatile       overflow_count_;
+
+    slot                    slots_[slot_count];
+};
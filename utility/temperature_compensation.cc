@@ -0,0 +1,94 @@
+/**
+ * @file temperature_compensation.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "temperature_compensation.h"
+#include "project_assert.h"
+
+namespace utility
+{
+
+temperature_filter::temperature_filter(uint8_t shift) :
+    shift_(shift),
+    value_q16_(0),
+    sample_count_(0u)
+{
+    // The Q16 temperature difference must not overflow.
+    ASSERT(shift < 16u);
+}
+
+int32_t temperature_filter::update(int32_t temperature_Cx4)
+{
+    int32_t const sample_q16 = temperature_Cx4 * gain_unity_q16;
+    if (this->sample_count_ == 0u)
+    {
+        this->value_q16_ = sample_q16;
+    }
+    else
+    {
+        this->value_q16_ += (sample_q16 - this->value_q16_) >> this->shift_;
+    }
+
+    this->sample_count_ += 1u;
+    return this->value_Cx4();
+}
+
+int32_t temperature_filter::value_Cx4() const
+{
+    return (this->value_q16_ + (gain_unity_q16 / 2)) >> 16u;
+}
+
+compensation_curve::compensation_curve(compensation_point const* points,
+                                       std::size_t               point_count) :
+    points_(points),
+    point_count_(point_count)
+{
+    ASSERT(points);
+    ASSERT(point_count > 0u);
+}
+
+int32_t compensation_curve::evaluate(int32_t temperature_Cx4) const
+{
+    compensation_point const* const last = this->points_ + this->point_count_ - 1u;
+    if (temperature_Cx4 <= this->points_->temperature_Cx4)
+    {
+        return this->points_->value;
+    }
+
+    for (compensation_point const* point = this->points_; point < last; ++point)
+    {
+        compensation_point const& next = point[1u];
+        if (temperature_Cx4 < next.temperature_Cx4)
+        {
+            int64_t const value_span = int64_t(next.value) - point->value;
+            int32_t const temp_span  = next.temperature_Cx4 - point->temperature_Cx4;
+            int32_t const temp_delta = temperature_Cx4 - point->temperature_Cx4;
+
+            return point->value + static_cast<int32_t>((value_span * temp_delta) / temp_span);
+        }
+    }
+
+    return last->value;
+}
+
+int32_t crystal_drift_ppb(int32_t temperature_Cx4,
+                          int32_t turnover_Cx4,
+                          int32_t parabolic_ppb)
+{
+    // (T - T0)^2 in 1/16 C^2 units.
+    int64_t const delta = temperature_Cx4 - turnover_Cx4;
+    return static_cast<int32_t>(-(parabolic_ppb * delta * delta) / 16);
+}
+
+int16_t gain_apply(int16_t sample, int32_t gain_q16)
+{
+    int64_t const product = int64_t(sample) * gain_q16 + (gain_unity_q16 / 2);
+    int64_t const value   = product >> 16u;
+
+    if (value > INT16_MAX) { return INT16_MAX; }
+    if (value < INT16_MIN) { return INT16_MIN; }
+    return static_cast<int16_t>(value);
+}
+
+} // namespace utility
@@ -0,0 +1,124 @@
+/**
+ * @file temperature_compensation.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Fixed point temperature filtering and compensation curves.
+ * Temperatures are in 0.25 C units, as measured by the TEMP peripheral.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utility
+{
+
+/**
+ * @class temperature_filter
+ * A first order exponential filter: each sample moves the filtered value
+ * by 1/2^shift of the difference. The filtered value is held in Q16 so
+ * that small steps are not lost to truncation.
+ */
+class temperature_filter
+{
+public:
+    ~temperature_filter()                                       = default;
+
+    temperature_filter()                                        = delete;
+    temperature_filter(temperature_filter const&)               = delete;
+    temperature_filter(temperature_filter &&)                   = delete;
+    temperature_filter& operator=(temperature_filter const&)    = delete;
+    temperature_filter& operator=(temperature_filter&&)         = delete;
+
+    /// @param shift The filter time constant in samples, as a power of 2.
+    explicit temperature_filter(uint8_t shift);
+
+    /**
+     * Filter a sample; the first sample sets the filtered value.
+     * @return int32_t The filtered temperature in 0.25 C units.
+     */
+    int32_t update(int32_t temperature_Cx4);
+
+    /// @return int32_t The filtered temperature in 0.25 C units, rounded.
+    int32_t value_Cx4() const;
+
+    bool is_valid() const { return this->sample_count_ > 0u; }
+
+    uint32_t sample_count() const { return this->sample_count_; }
+
+    void reset() { this->sample_count_ = 0u; this->value_q16_ = 0; }
+
+private:
+    uint8_t const shift_;
+    int32_t       value_q16_;
+    uint32_t      sample_count_;
+};
+
+/// A point on a compensation curve.
+struct compensation_point
+{
+    int16_t temperature_Cx4;
+    int32_t value;
+};
+
+/**
+ * @class compensation_curve
+ * A piecewise linear curve over temperature. The points are sorted by
+ * increasing temperature; beyond the first and last points the curve is
+ * flat.
+ */
+class compensation_curve
+{
+public:
+    ~compensation_curve()                                       = default;
+
+    compensation_curve()                                        = delete;
+    compensation_curve(compensation_curve const&)               = delete;
+    compensation_curve(compensation_curve &&)                   = delete;
+    compensation_curve& operator=(compensation_curve const&)    = delete;
+    compensation_curve& operator=(compensation_curve&&)         = delete;
+
+    /**
+     * @param points      The curve points; must outlive the curve.
+     * @param point_count At least 1.
+     */
+    compensation_curve(compensation_point const* points, std::size_t point_count);
+
+    int32_t evaluate(int32_t temperature_Cx4) const;
+
+private:
+    compensation_point const* const points_;
+    std::size_t const               point_count_;
+};
+
+/// The turnover temperature of a 32.768 kHz tuning fork crystal.
+static constexpr int32_t const crystal_turnover_Cx4 = 25 * 4;
+
+/// The parabolic coefficient of a 32.768 kHz tuning fork crystal: 0.034 ppm / C^2.
+static constexpr int32_t const crystal_parabolic_ppb = 34;
+
+/**
+ * The frequency error of a tuning fork crystal, which runs slow on both
+ * sides of its turnover temperature: -k * (T - T0)^2.
+ *
+ * @param temperature_Cx4 The crystal temperature.
+ * @param turnover_Cx4    The temperature of zero error.
+ * @param parabolic_ppb   k, in parts per billion per C^2.
+ *
+ * @return int32_t The frequency error in parts per billion; positive is fast.
+ */
+int32_t crystal_drift_ppb(int32_t temperature_Cx4,
+                          int32_t turnover_Cx4  = crystal_turnover_Cx4,
+                          int32_t parabolic_ppb = crystal_parabolic_ppb);
+
+/// Unity gain in Q16.
+static constexpr int32_t const gain_unity_q16 = 1 << 16;
+
+/**
+ * Scale a sample by a Q16 gain, rounding to nearest and saturating to
+ * the int16_t range.
+ */
+int16_t gain_apply(int16_t sample, int32_t gain_q16);
+
+} // namespace utility
@@ -0,0 +1,181 @@
+/**
+ * @file threshold_capture.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "threshold_capture.h"
+#include "logger.h"
+#include "project_assert.h"
+
+threshold_capture::threshold_capture(threshold_capture_hooks&   hooks,
+                                     int16_t*                   ring,
+                                     std::size_t                ring_frames,
+                                     std::size_t                channel_count,
+                                     uint32_t                   quiet_frames,
+                                     frame_sink                 sink,
+                                     void*                      context) :
+    hooks_(hooks),
+    ring_(ring),
+    ring_frames_(ring_frames),
+    channel_count_(channel_count),
+    quiet_frames_(quiet_frames),
+    sink_(sink),
+    context_(context),
+    limits_{},
+    state_(state::stopped),
+    quiet_count_(0u),
+    stats_{}
+{
+    ASSERT(ring);
+    ASSERT(ring_frames > 0u);
+    ASSERT((channel_count > 0u) && (channel_count <= channel_count_max));
+    ASSERT(sink);
+
+    for (threshold_limits& limits : this->limits_)
+    {
+        limits = threshold_limits{INT16_MIN, INT16_MAX};
+    }
+}
+
+void threshold_capture::limits_set(std::size_t channel, int16_t lower, int16_t upper)
+{
+    ASSERT(channel < this->channel_count_);
+    this->limits_[channel] = threshold_limits{lower, upper};
+}
+
+threshold_limits const& threshold_capture::limits(std::size_t channel) const
+{
+    ASSERT(channel < this->channel_count_);
+    return this->limits_[channel];
+}
+
+void threshold_capture::start()
+{
+    if (this->state_ == state::stopped)
+    {
+        this->arm();
+    }
+}
+
+void threshold_capture::stop()
+{
+    if (this->state_ == state::armed)
+    {
+        this->stats_.frames_slow += this->hooks_.ring_stop().frame_count;
+    }
+    else if (this->state_ == state::capturing)
+    {
+        this->hooks_.capture_stop();
+    }
+
+    this->state_ = state::stopped;
+}
+
+void threshold_capture::arm()
+{
+    this->state_ = state::armed;
+    this->hooks_.ring_start(this->ring_,
+                            this->ring_frames_ * this->channel_count_,
+                            this->limits_,
+                            this->channel_count_);
+}
+
+void threshold_capture::limit_crossed(std::size_t channel)
+{
+    (void) channel;
+    if (this->state_ != state::armed)
+    {
+        return;
+    }
+
+    this->stats_.wake_count    += 1u;
+    this->stats_.trigger_count += 1u;
+
+    threshold_capture_hooks::ring_position const position = this->hooks_.ring_stop();
+    this->stats_.frames_slow += position.frame_count;
+
+    this->deliver_ring(position);
+
+    this->quiet_count_ = 0u;
+    this->state_       = state::capturing;
+    this->hooks_.capture_start();
+}
+
+void threshold_capture::deliver_ring(threshold_capture_hooks::ring_position const& position)
+{
+    // A partly written frame holds samples from two passes: skip it.
+    std::size_t const frame_index = position.sample_index / this->channel_count_;
+    bool        const partial     = (position.sample_index % this->channel_count_) != 0u;
+
+    std::size_t frame_first = 0u;
+    std::size_t frame_count = frame_index;
+    if (position.wrapped)
+    {
+        frame_first = frame_index + (partial ? 1u : 0u);
+        frame_count = this->ring_frames_ - (partial ? 1u : 0u);
+    }
+
+    for (std::size_t count = 0u; count < frame_count; ++count)
+    {
+        std::size_t const ring_index = (frame_first + count) % this->ring_frames_;
+        this->sink_(this->ring_ + ring_index * this->channel_count_,
+                    this->channel_count_, this->context_);
+    }
+
+    this->stats_.pretrigger_frames += static_cast<uint32_t>(frame_count);
+}
+
+bool threshold_capture::frame_is_quiet(int16_t const* frame) const
+{
+    for (std::size_t channel = 0u; channel < this->channel_count_; ++channel)
+    {
+        threshold_limits const& limits = this->limits_[channel];
+        if ((frame[channel] < limits.lower) || (frame[channel] > limits.upper))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void threshold_capture::frame_complete(int16_t const* frame)
+{
+    if (this->state_ != state::capturing)
+    {
+        return;
+    }
+
+    this->stats_.wake_count  += 1u;
+    this->stats_.frames_fast += 1u;
+    this->sink_(frame, this->channel_count_, this->context_);
+
+    this->quiet_count_ = this->frame_is_quiet(frame) ? this->quiet_count_ + 1u : 0u;
+    if (this->quiet_count_ >= this->quiet_frames_)
+    {
+        this->hooks_.capture_stop();
+        this->arm();
+    }
+}
+
+uint32_t threshold_capture::wakes_per_1000_frames() const
+{
+    uint64_t const frames = this->stats_.frames_slow + this->stats_.frames_fast;
+    if (frames == 0u)
+    {
+        return 0u;
+    }
+
+    return static_cast<uint32_t>((uint64_t(this->stats_.wake_count) * 1000u) / frames);
+}
+
+void threshold_capture::dump(logger& logger) const
+{
+    logger.info("threshold: triggers: %u, pre-trigger frames: %u, wakes: %u",
+                this->stats_.trigger_count, this->stats_.pretrigger_frames,
+                this->stats_.wake_count);
+    logger.info("threshold: frames: slow: %llu, fast: %llu, wakes per 1000: %u",
+                static_cast<unsigned long long>(this->stats_.frames_slow),
+                static_cast<unsigned long long>(this->stats_.frames_fast),
+                this->wakes_per_1000_frames());
+}
@@ -0,0 +1,187 @@
+/**
+ * @file threshold_capture.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Wake on threshold sampling: slow sampling into a ring with hardware limit
+ * comparison, switching to fast capture when a limit is crossed.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class logger;
+
+/// Samples outside of [lower, upper] cross the threshold.
+struct threshold_limits
+{
+    int16_t lower;
+    int16_t upper;
+};
+
+/**
+ * @class threshold_capture_hooks
+ * The sampling hardware used by a threshold_capture.
+ *
+ * A frame is one sample of each channel, written in channel order.
+ */
+class threshold_capture_hooks
+{
+public:
+    /// Where ring sampling stopped.
+    struct ring_position
+    {
+        std::size_t sample_index;   ///< The samples written in the current ring pass.
+        bool        wrapped;        ///< The ring was filled at least once.
+        uint32_t    frame_count;    ///< The frames sampled since ring_start().
+    };
+
+    virtual ~threshold_capture_hooks()                                  = default;
+
+    threshold_capture_hooks()                                           = default;
+    threshold_capture_hooks(threshold_capture_hooks const&)             = delete;
+    threshold_capture_hooks(threshold_capture_hooks &&)                 = delete;
+    threshold_capture_hooks& operator=(threshold_capture_hooks const&)  = delete;
+    threshold_capture_hooks& operator=(threshold_capture_hooks&&)       = delete;
+
+    /**
+     * Sample at the slow rate into the ring, wrapping at its end, without
+     * waking the CPU. Wake only when a sample crosses its channel limits by
+     * calling threshold_capture::limit_crossed().
+     *
+     * @param ring          The ring of samples.
+     * @param ring_length   The ring length in samples; a whole number of frames.
+     * @param limits        The limits of each channel.
+     * @param channel_count The number of channels per frame.
+     */
+    virtual void ring_start(int16_t*                ring,
+                            std::size_t             ring_length,
+                            threshold_limits const* limits,
+                            std::size_t             channel_count) = 0;
+
+    /// Stop ring sampling; the ring is not written after this returns.
+    virtual ring_position ring_stop() = 0;
+
+    /**
+     * Sample at the fast rate, calling threshold_capture::frame_complete()
+     * for each frame. Limit crossings are not reported.
+     */
+    virtual void capture_start() = 0;
+
+    virtual void capture_stop() = 0;
+};
+
+/**
+ * @class threshold_capture
+ * Sample slowly while the signal is quiet and quickly while it is not.
+ *
+ * While armed the hardware samples into the pre-trigger ring and compares
+ * each sample with the channel limits; the CPU sleeps. On a limit
+ * crossing the ring is delivered to the frame sink oldest first, ending
+ * with the crossing frame, and fast capture starts: each captured frame
+ * is delivered to the sink. After quiet_frames consecutive frames within
+ * the limits, the capture is armed again.
+ *
+ * limit_crossed() and frame_complete() are called from the sampling ISR;
+ * start() and stop() must not be preempted by them.
+ */
+class threshold_capture
+{
+public:
+    static constexpr std::size_t const channel_count_max = 8u;
+
+    using frame_sink = void (*)(int16_t const*  frame,
+                                std::size_t     channel_count,
+                                void*           context);
+
+    enum class state: uint8_t
+    {
+        stopped,
+        armed,          ///< Slow sampling into the ring; waiting for a crossing.
+        capturing,      ///< Fast sampling; waiting for quiet.
+    };
+
+    struct statistics
+    {
+        uint32_t wake_count;            ///< CPU wakes: crossings and fast frames.
+        uint32_t trigger_count;         ///< Limit crossings which started a capture.
+        uint32_t pretrigger_frames;     ///< Ring frames delivered on triggers.
+        uint64_t frames_slow;           ///< Frames sampled while armed.
+        uint64_t frames_fast;           ///< Frames sampled while capturing.
+    };
+
+    ~threshold_capture()                                    = default;
+
+    threshold_capture()                                     = delete;
+    threshold_capture(threshold_capture const&)             = delete;
+    threshold_capture(threshold_capture &&)                 = delete;
+    threshold_capture& operator=(threshold_capture const&)  = delete;
+    threshold_capture& operator=(threshold_capture&&)       = delete;
+
+    /**
+     * @param hooks         The sampling hardware.
+     * @param ring          The pre-trigger ring storage:
+     *                      ring_frames * channel_count samples.
+     * @param ring_frames   The pre-trigger depth in frames.
+     * @param channel_count The number of channels per frame.
+     * @param quiet_frames  Fast frames within the limits which end a capture.
+     * @param sink          Receives the pre-trigger and captured frames.
+     * @param context       Passed to sink.
+     */
+    threshold_capture(threshold_capture_hooks&  hooks,
+                      int16_t*                  ring,
+                      std::size_t               ring_frames,
+                      std::size_t               channel_count,
+                      uint32_t                  quiet_frames,
+                      frame_sink                sink,
+                      void*                     context = nullptr);
+
+    /// Set a channel's limits; takes effect when next armed.
+    void limits_set(std::size_t channel, int16_t lower, int16_t upper);
+
+    threshold_limits const& limits(std::size_t channel) const;
+
+    /// Arm the capture.
+    void start();
+
+    void stop();
+
+    /// A sample crossed its channel limits while armed.
+    void limit_crossed(std::size_t channel);
+
+    /// A frame was captured at the fast rate.
+    void frame_complete(int16_t const* frame);
+
+    state get_state() const { return this->state_; }
+
+    statistics const& stats() const { return this->stats_; }
+
+    /**
+     * @return uint32_t The CPU wakes per 1000 frames sampled. Sampling
+     * every frame with an interrupt is 1000. Frames sampled while armed are
+     * counted when the ring stops.
+     */
+    uint32_t wakes_per_1000_frames() const;
+
+    /// Write the statistics to the logger at level::info.
+    void dump(logger& logger) const;
+
+private:
+    void arm();
+    void deliver_ring(threshold_capture_hooks::ring_position const& position);
+    bool frame_is_quiet(int16_t const* frame) const;
+
+    threshold_capture_hooks&    hooks_;
+    int16_t* const              ring_;
+    std::size_t const           ring_frames_;
+    std::size_t const           channel_count_;
+    uint32_t const              quiet_frames_;
+    frame_sink const            sink_;
+    void* const                 context_;
+
+    threshold_limits            limits_[channel_count_max];
+    state volatile              state_;
+    uint32_t                    quiet_count_;
+    statistics                  stats_;
+};
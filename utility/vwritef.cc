@@ -10,7 +10,9 @@
  * + String padding
  * + Justification to right
  * + No octal conversion.
- * + No floating point.
+ * + No 'a' 'A' hex floating point conversions.
+ * + Floating point conversions are limited to decimal_digits_max
+ *   significant digits; digits beyond these are written as zeros.
  * + Small case only for hex conversions.
  * + Padding longer than the conversion buffer is truncated.
  */
@@ -18,7 +20,12 @@
 #include "vwritef.h"
 #include "format_conversion.h"
 #include "int_to_string.h"
+#include "float_to_string.h"
+#include "bit_manip.h"
+#include "profile.h"
 
+#include <algorithm>
+#include <cmath>
 #include <type_traits>
 #include <cstring>
 
@@ -35,11 +42,19 @@ static size_t convert_char(io::output_stream&       os,
 
 static size_t write_padding(io::output_stream& os, size_t length, char pad_value)
 {
+    // Pad in chunks rather than a write per character.
+    static char const spaces[] = "                ";
+    static char const zeros[]  = "0000000000000000";
+    char const* const padding  = (pad_value == '0') ? zeros : spaces;
+
     size_t n_written = 0u;
-    for (; length > 0u; --length)
+    while (length > 0u)
     {
-        char const space = ' ';
-        n_written += os.write(&space, sizeof(space));
+        size_t const chunk = std::min(length, sizeof(spaces) - 1u);
+        size_t const n_chunk = os.write(padding, chunk);
+        n_written += n_chunk;
+        length    -= chunk;
+        if (n_chunk < chunk) { break; }
     }
 
     return n_written;
@@ -62,14 +77,11 @@ static size_t convert_string(io::output_stream&         os,
         if (conversion.width > static_cast<signed_size_t>(string_length))
         {
             size_t const pad_length = conversion.width - string_length;
-            n_write += write_padding(os, pad_length, conversion.pad_value);
+            n_write += write_padding(os, pad_length, ' ');
         }
     }
 
-    for (; *string_ptr != 0; ++string_ptr)
-    {
-        n_write += os.write(string_ptr, sizeof(*string_ptr));
-    }
+    n_write += os.write(string_ptr, strlen(string_ptr));
 
     if ((conversion.width_state == format_conversion::modifier_state::is_specified) &&
         (conversion.justification == format_conversion::justification::left))
@@ -77,7 +89,7 @@ static size_t convert_string(io::output_stream&         os,
         if (conversion.width > static_cast<signed_size_t>(n_write))
         {
             size_t const pad_length = conversion.width - n_write;
-            n_write += write_padding(os, pad_length, conversion.pad_value);
+            n_write += write_padding(os, pad_length, ' ');
         }
     }
 
@@ -178,6 +190,286 @@ static size_t convert_int_to_hex(io::output_stream&         os,
     }
 }
 
+/**
+ * Write the digits decimal.digits[begin, end); indices outside of the
+ * converted digits are zeros.
+ */
+static size_t write_digits(io::output_stream&       os,
+                           decimal_digits const&    decimal,
+                           int                      begin,
+                           int                      end)
+{
+    size_t n_written = 0u;
+    char   buffer[16u];
+    size_t length = 0u;
+
+    for (int index = begin; index < end; ++index)
+    {
+        bool const is_digit = (index >= 0) && (index < decimal.count);
+        buffer[length++] = is_digit ? decimal.digits[index] : '0';
+        if (length == sizeof(buffer))
+        {
+            n_written += os.write(buffer, length);
+            length = 0u;
+        }
+    }
+
+    n_written += (length > 0u) ? os.write(buffer, length) : 0u;
+    return n_written;
+}
+
+/// The sign character to write for a value; zero if none.
+static char sign_char(format_conversion const& conversion, bool is_negative)
+{
+    return is_negative ? '-' : conversion.prepend_value;
+}
+
+/**
+ * Write the sign and padding which precede a number.
+ * @param length The number of characters following the sign.
+ * @param is_finite Infinity and nan are padded with spaces only.
+ */
+static size_t write_number_prefix(io::output_stream&        os,
+                                  format_conversion const&  conversion,
+                                  char                      sign,
+                                  size_t                    length,
+                                  bool                      is_finite)
+{
+    size_t const total_length = length + ((sign != 0) ? 1u : 0u);
+    size_t const pad_length   =
+        (conversion.width > static_cast<signed_size_t>(total_length)) ?
+        conversion.width - total_length : 0u;
+
+    size_t n_written = 0u;
+    if (conversion.justification == format_conversion::justification::right)
+    {
+        // Zero padding is written after the sign.
+        if (is_finite && (conversion.pad_value == '0'))
+        {
+            n_written += (sign != 0) ? os.write(&sign, sizeof(sign)) : 0u;
+            return n_written + write_padding(os, pad_length, '0');
+        }
+
+        n_written += write_padding(os, pad_length, ' ');
+    }
+
+    n_written += (sign != 0) ? os.write(&sign, sizeof(sign)) : 0u;
+    return n_written;
+}
+
+/// Left justified numbers are followed by space padding.
+static size_t write_number_suffix(io::output_stream&        os,
+                                  format_conversion const&  conversion,
+                                  size_t                    n_written)
+{
+    if ((conversion.justification == format_conversion::justification::left) &&
+        (conversion.width > static_cast<signed_size_t>(n_written)))
+    {
+        return write_padding(os, conversion.width - n_written, ' ');
+    }
+    return 0u;
+}
+
+/**
+ * Write decimal digits in the fixed notation: [-]ddd.ddd
+ * @param fraction_digits The number of digits following the decimal point.
+ */
+static size_t write_fixed(io::output_stream&        os,
+                          format_conversion const&  conversion,
+                          char                      sign,
+                          decimal_digits const&     decimal,
+                          int                       fraction_digits)
+{
+    int  const exponent      = decimal.exponent;
+    int  const integer_count = (exponent >= 0) ? exponent + 1 : 1;
+    bool const decimal_point = (fraction_digits > 0) || conversion.alternative_conversion;
+    size_t const length      = integer_count + (decimal_point ? 1u : 0u) + fraction_digits;
+
+    size_t n_written = write_number_prefix(os, conversion, sign, length, true);
+
+    // The digit index of the 10^position digit is (exponent - position).
+    n_written += write_digits(os, decimal, exponent - integer_count + 1, exponent + 1);
+    if (decimal_point)
+    {
+        n_written += os.write(".", 1u);
+    }
+    n_written += write_digits(os, decimal, exponent + 1, exponent + 1 + fraction_digits);
+
+    return n_written + write_number_suffix(os, conversion, n_written);
+}
+
+/**
+ * Write decimal digits in the exponent notation: [-]d.ddde[+-]dd
+ * @param fraction_digits The number of digits following the decimal point.
+ */
+static size_t write_exponent(io::output_stream&         os,
+                             format_conversion const&   conversion,
+                             char                       sign,
+                             decimal_digits const&      decimal,
+                             int                        fraction_digits,
+                             bool                       upper_case)
+{
+    // The exponent is written with at least 2 digits.
+    char exponent_buffer[8u];
+    int  exponent_value = (decimal.count > 0u) ? decimal.exponent : 0;
+    exponent_buffer[0]  = upper_case ? 'E' : 'e';
+    exponent_buffer[1]  = (exponent_value < 0) ? '-' : '+';
+    exponent_value      = (exponent_value < 0) ? -exponent_value : exponent_value;
+
+    char   digits_reversed[4u];
+    size_t exponent_digits = 0u;
+    do
+    {
+        digits_reversed[exponent_digits++] = static_cast<char>('0' + exponent_value % 10);
+        exponent_value /= 10;
+    }
+    while ((exponent_value != 0) || (exponent_digits < 2u));
+
+    std::reverse_copy(digits_reversed, digits_reversed + exponent_digits, exponent_buffer + 2u);
+    size_t const exponent_length = exponent_digits + 2u;
+
+    bool const decimal_point = (fraction_digits > 0) || conversion.alternative_conversion;
+    size_t const length      = 1u + (decimal_point ? 1u : 0u) + fraction_digits + exponent_length;
+
+    size_t n_written = write_number_prefix(os, conversion, sign, length, true);
+
+    n_written += write_digits(os, decimal, 0, 1);
+    if (decimal_point)
+    {
+        n_written += os.write(".", 1u);
+    }
+    n_written += write_digits(os, decimal, 1, 1 + fraction_digits);
+    n_written += os.write(exponent_buffer, exponent_length);
+
+    return n_written + write_number_suffix(os, conversion, n_written);
+}
+
+static size_t write_non_finite(io::output_stream&       os,
+                               format_conversion const& conversion,
+                               bool                     is_negative,
+                               bool                     is_nan,
+                               bool                     upper_case)
+{
+    char const* const text = is_nan ? (upper_case ? "NAN" : "nan")
+                                    : (upper_case ? "INF" : "inf");
+    size_t const length    = 3u;
+    char   const sign      = sign_char(conversion, is_negative);
+
+    size_t n_written = write_number_prefix(os, conversion, sign, length, false);
+    n_written += os.write(text, length);
+    return n_written + write_number_suffix(os, conversion, n_written);
+}
+
+/**
+ * The number of fraction digits to write for a %g conversion when the
+ * '#' flag is not specified: trailing zeros are removed.
+ */
+static int fraction_digits_trimmed(decimal_digits const& decimal,
+                                   int                   fraction_digits,
+                                   int                   digit_index_begin)
+{
+    int const digits_remaining = static_cast<int>(decimal.count) - digit_index_begin;
+    return std::max(0, std::min(fraction_digits, digits_remaining));
+}
+
+static size_t convert_float(io::output_stream&          os,
+                            format_conversion const&    conversion,
+                            va_list&                    args)
+{
+    double const value =
+        (conversion.length_modifier == format_conversion::length_modifier::L) ?
+        static_cast<double>(va_arg(args, long double)) : va_arg(args, double);
+
+    char const specifier  = conversion.conversion_specifier;
+    bool const upper_case = (specifier == 'F') || (specifier == 'E') || (specifier == 'G');
+    bool const is_negative = std::signbit(value);
+
+    if (not std::isfinite(value))
+    {
+        return write_non_finite(os, conversion, is_negative, std::isnan(value), upper_case);
+    }
+
+    char const   sign      = sign_char(conversion, is_negative);
+    double const magnitude = std::fabs(value);
+    int    const precision = conversion.precision;
+
+    decimal_digits decimal;
+    switch (specifier)
+    {
+    case 'f':
+    case 'F':
+        double_to_fixed(decimal, magnitude, -precision);
+        return write_fixed(os, conversion, sign, decimal, precision);
+
+    case 'e':
+    case 'E':
+        double_to_significant(decimal, magnitude, precision + 1u);
+        return write_exponent(os, conversion, sign, decimal, precision, upper_case);
+
+    default:
+        break;
+    }
+
+    // 'g' 'G': Use the exponent notation when the exponent is less than -4
+    // or not less than the precision; otherwise the fixed notation.
+    int const significant = (precision == 0) ? 1 : precision;
+    double_to_significant(decimal, magnitude, significant);
+
+    int const exponent = (decimal.count > 0u) ? decimal.exponent : 0;
+    if ((significant > exponent) && (exponent >= -4))
+    {
+        int fraction_digits = significant - 1 - exponent;
+        if (not conversion.alternative_conversion)
+        {
+            fraction_digits = fraction_digits_trimmed(decimal, fraction_digits, exponent + 1);
+        }
+        return write_fixed(os, conversion, sign, decimal, fraction_digits);
+    }
+
+    int fraction_digits = significant - 1;
+    if (not conversion.alternative_conversion)
+    {
+        fraction_digits = fraction_digits_trimmed(decimal, fraction_digits, 1);
+    }
+    return write_exponent(os, conversion, sign, decimal, fraction_digits, upper_case);
+}
+
+static size_t convert_fixed_point(io::output_stream&        os,
+                                  format_conversion const&  conversion,
+                                  va_list&                  args)
+{
+    // Without a valid Q format the argument size is unknown.
+    if (conversion.parse_error != format_conversion::parse_error::none)
+    {
+        return 0u;
+    }
+
+    unsigned int const fraction_bits = conversion.q_fraction_bits;
+    unsigned int const total_bits    = conversion.q_integer_bits + fraction_bits;
+
+    uint64_t const raw_value = (total_bits <= 32u) ?
+        static_cast<uint32_t>(va_arg(args, int)) :
+        static_cast<uint64_t>(va_arg(args, long long int));
+
+    int64_t const value = bit_manip::sign_extend(raw_value, total_bits - 1u);
+    bool const is_negative = (value < 0);
+
+    // Negate as unsigned so that the most negative value does not overflow.
+    uint64_t const magnitude = is_negative ? (0u - static_cast<uint64_t>(value))
+                                           : static_cast<uint64_t>(value);
+
+    // The default precision: ceil(fraction_bits * log10(2)) digits
+    // distinguish adjacent fixed point values.
+    int const precision =
+        (conversion.precision_state == format_conversion::modifier_state::is_specified) ?
+        conversion.precision : static_cast<int>((fraction_bits * 1233u + 4095u) >> 12u);
+
+    decimal_digits decimal;
+    fixed_to_decimal(decimal, magnitude, fraction_bits, -precision);
+
+    return write_fixed(os, conversion, sign_char(conversion, is_negative), decimal, precision);
+}
+
 static size_t convert_pointer(io::output_stream&            os,
                               format_conversion const&      conversion,
                               va_list&                      args)
@@ -198,6 +490,8 @@ size_t writef(io::output_stream& os, char const *fmt, ...)
 
 size_t vwritef(io::output_stream& os, char const* fmt, va_list& args)
 {
+    PROFILE_ZONE("vwritef");
+
     size_t n_written = 0u;
     char const *fmt_iter = fmt;
 
@@ -242,10 +536,17 @@ size_t vwritef(io::output_stream& os, char const* fmt, va_list& args)
             case 'F':
             case 'e':
             case 'E':
-            case 'a':
-            case 'A':
             case 'g':
             case 'G':
+                n_write = convert_float(os, conversion, args);
+                break;
+
+            case 'a':
+            case 'A':
+                break;
+
+            case 'q':
+                n_write = convert_fixed_point(os, conversion, args);
                 break;
 
             case 'p':
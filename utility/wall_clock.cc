@@ -0,0 +1,132 @@
+/**
+ * @file wall_clock.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "wall_clock.h"
+#include "project_assert.h"
+
+#include <cstdlib>
+
+namespace utility
+{
+
+static constexpr int64_t const ppb_per_unit = 1000 * 1000 * 1000;
+
+wall_clock::wall_clock(uint32_t     ticks_per_second,
+                       tick_source  source,
+                       void*        context)
+:   ticks_per_second_(ticks_per_second),
+    nominal_rate_q32_(static_cast<uint32_t>(
+        ((uint64_t(fraction_per_second) << 32u) + ticks_per_second / 2u) / ticks_per_second)),
+    tick_source_(source),
+    tick_context_(context),
+    anchors_{ {0u, 0u, 0u, nominal_rate_q32_}, {0u, 0u, 0u, nominal_rate_q32_} },
+    generation_(0u),
+    sync_time_256_(0u),
+    sync_ticks_(0u),
+    sync_count_(0u),
+    drift_reject_count_(0u),
+    drift_ppb_(0),
+    last_offset_256_(0),
+    temperature_ppb_(0),
+    temperature_ppb_sync_(0)
+{
+    // The rate, 1/256 second units per tick, must be less than 1.
+    ASSERT(ticks_per_second > fraction_per_second);
+    if (source)
+    {
+        this->anchors_[0u].ticks = source(context);
+        this->anchors_[1u].ticks = this->anchors_[0u].ticks;
+    }
+}
+
+void wall_clock::publish(anchor const& state)
+{
+    uint32_t const generation = this->generation_.load(std::memory_order_relaxed);
+    this->anchors_[(generation + 1u) & 1u] = state;
+    this->generation_.store(generation + 1u, std::memory_order_release);
+}
+
+uint32_t wall_clock::drift_rate_q32(int64_t drift_ppb) const
+{
+    // A fast tick counter (positive drift) advances time more
+    // slowly per tick: rate = nominal / (1 + drift).
+    int64_t const rate = (int64_t(this->nominal_rate_q32_) * ppb_per_unit) /
+                         (ppb_per_unit + drift_ppb);
+    return static_cast<uint32_t>(rate);
+}
+
+void wall_clock::update(uint64_t ticks)
+{
+    this->publish(advance(this->current(), ticks));
+}
+
+void wall_clock::temperature_drift_set(int32_t drift_ppb, uint64_t ticks)
+{
+    this->temperature_ppb_ = drift_ppb;
+
+    anchor state = advance(this->current(), ticks);
+    state.rate_q32 = this->drift_rate_q32(
+        int64_t(this->drift_ppb_) + this->temperature_ppb_ - this->temperature_ppb_sync_);
+    this->publish(state);
+}
+
+bool wall_clock::synchronize(uint64_t seconds, uint8_t fraction_256, uint64_t ticks)
+{
+    uint64_t const reference_256 = (seconds << 8u) | fraction_256;
+    anchor state = advance(this->current(), ticks);
+
+    this->last_offset_256_ = static_cast<int64_t>(reference_256 - state.time_256);
+
+    bool drift_updated = false;
+    if ((this->sync_count_ == 0u) || (reference_256 < this->sync_time_256_))
+    {
+        // First synchronization or the reference went backwards:
+        // restart the drift measurement interval.
+        this->sync_time_256_ = reference_256;
+        this->sync_ticks_    = ticks;
+    }
+    else if (reference_256 - this->sync_time_256_ >=
+             uint64_t(drift_interval_min_seconds) * fraction_per_second)
+    {
+        // Compare the ticks counted against the ticks expected at the
+        // nominal rate, both scaled by 256, over the reference interval.
+        uint64_t const reference_elapsed = reference_256 - this->sync_time_256_;
+        int64_t  const measured = static_cast<int64_t>((ticks - this->sync_ticks_) * fraction_per_second);
+        int64_t        expected = static_cast<int64_t>(reference_elapsed * this->ticks_per_second_);
+        int64_t        error    = measured - expected;
+
+        // Scale down so that error * ppb_per_unit does not overflow.
+        while (std::llabs(error) >= (int64_t(1) << 32u))
+        {
+            error    /= 2;
+            expected /= 2;
+        }
+
+        int64_t const drift_ppb = (error * ppb_per_unit) / expected;
+        if (std::llabs(drift_ppb) <= drift_ppb_limit)
+        {
+            this->drift_ppb_            = static_cast<int32_t>(drift_ppb);
+            this->temperature_ppb_sync_ = this->temperature_ppb_;
+            state.rate_q32              = this->drift_rate_q32(drift_ppb);
+            drift_updated               = true;
+        }
+        else
+        {
+            this->drift_reject_count_ += 1u;
+        }
+
+        this->sync_time_256_ = reference_256;
+        this->sync_ticks_    = ticks;
+    }
+
+    state.time_256      = reference_256;
+    state.remainder_q32 = 0u;
+    this->publish(state);
+
+    this->sync_count_ += 1u;
+    return drift_updated;
+}
+
+} // namespace utility
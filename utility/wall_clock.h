@@ -0,0 +1,231 @@
+/**
+ * @file wall_clock.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Calendar time maintained from a free running tick counter.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace utility
+{
+
+/**
+ * @class wall_clock
+ * Seconds since the gregorian epoch, 1601-01-01T00:00:00, with a 1/256
+ * second fraction as used by the BLE Current Time Service.
+ *
+ * The clock advances from a tick counter, typically the extended RTC count.
+ * Elapsed ticks are converted to 1/256 second units with a fixed point
+ * multiply by rate_q32: there is no division when reading the time.
+ *
+ * When the time is synchronized to a reference, such as a peer writing the
+ * Current Time characteristic, the tick counter frequency error is measured
+ * over the interval since the previous synchronization and the rate is
+ * corrected for it.
+ *
+ * Concurrency: update() and synchronize() must be called from a single
+ * context, such as the main loop. now() may be called from any context,
+ * including an ISR which preempts update(): the clock state is double
+ * buffered and readers use the copy which is not being written.
+ */
+class wall_clock
+{
+public:
+    /// Returns the free running tick count.
+    using tick_source = uint64_t (*)(void* context);
+
+    static constexpr uint32_t const fraction_per_second = 256u;
+
+    /// Drift measurements beyond this limit are rejected as a bad reference.
+    static constexpr int32_t const drift_ppb_limit = 500 * 1000;
+
+    /// The minimum reference interval over which drift is measured.
+    static constexpr uint32_t const drift_interval_min_seconds = 60u;
+
+    struct time_point
+    {
+        uint64_t seconds;           ///< Seconds since the gregorian epoch.
+        uint8_t  fraction_256;      ///< Fractions of a second in 1/256 units.
+    };
+
+    ~wall_clock()                               = default;
+
+    wall_clock()                                = delete;
+    wall_clock(wall_clock const&)               = delete;
+    wall_clock(wall_clock &&)                   = delete;
+    wall_clock& operator=(wall_clock const&)    = delete;
+    wall_clock& operator=(wall_clock&&)         = delete;
+
+    /**
+     * @param ticks_per_second The nominal tick counter frequency;
+     *                         greater than 256 Hz.
+     * @param source           The tick counter; may be null if only the
+     *                         methods taking an explicit tick count are used.
+     * @param context          Passed unmodified to source.
+     */
+    wall_clock(uint32_t     ticks_per_second,
+               tick_source  source  = nullptr,
+               void*        context = nullptr);
+
+    uint64_t ticks() const { return this->tick_source_(this->tick_context_); }
+
+    /** @return uint64_t The time since the epoch in 1/256 second units. */
+    uint64_t now_256() const { return this->now_256(this->ticks()); }
+
+    uint64_t now_256(uint64_t ticks) const
+    {
+        for (;;)
+        {
+            uint32_t const generation = this->generation_.load(std::memory_order_acquire);
+            anchor const& state = this->anchors_[generation & 1u];
+
+            uint64_t const time_256 = advance(state, ticks).time_256;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (generation == this->generation_.load(std::memory_order_relaxed))
+            {
+                return time_256;
+            }
+        }
+    }
+
+    time_point now() const { return to_time_point(this->now_256()); }
+
+    time_point now(uint64_t ticks) const { return to_time_point(this->now_256(ticks)); }
+
+    /**
+     * Fold the elapsed ticks into the clock state.
+     * Call at least once per 2^64 / rate_q32 ticks (194 days for a 1024 Hz
+     * tick) so that the elapsed tick product cannot overflow.
+     */
+    void update() { this->update(this->ticks()); }
+    void update(uint64_t ticks);
+
+    /**
+     * Set the clock to a reference time.
+     *
+     * If the clock was synchronized at least drift_interval_min_seconds of
+     * reference time earlier, the tick frequency error over that interval
+     * is measured and the rate corrected for it. Shorter intervals only step
+     * the time; the measurement interval continues from the earlier
+     * synchronization.
+     *
+     * @param seconds      The reference seconds since the gregorian epoch.
+     * @param fraction_256 The reference fraction of a second.
+     * @return bool true if the drift correction was updated.
+     */
+    bool synchronize(uint64_t seconds, uint8_t fraction_256) {
+        return this->synchronize(seconds, fraction_256, this->ticks());
+    }
+
+    bool synchronize(uint64_t seconds, uint8_t fraction_256, uint64_t ticks);
+
+    /**
+     * Correct the rate for the tick counter frequency error due to
+     * temperature, from this tick count on. Call from the update() context.
+     *
+     * A drift measured by synchronize() includes the temperature drift at
+     * the time of the measurement; only the change in temperature drift
+     * since then is applied on top of it.
+     *
+     * @param drift_ppb The temperature frequency error in parts per billion;
+     *                  positive is fast.
+     */
+    void temperature_drift_set(int32_t drift_ppb) {
+        this->temperature_drift_set(drift_ppb, this->ticks());
+    }
+
+    void temperature_drift_set(int32_t drift_ppb, uint64_t ticks);
+
+    /** @return int32_t The temperature frequency error in parts per billion. */
+    int32_t temperature_drift_ppb() const { return this->temperature_ppb_; }
+
+    bool is_synchronized() const { return this->sync_count_ > 0u; }
+
+    uint32_t sync_count() const { return this->sync_count_; }
+
+    /// The number of drift measurements rejected as out of bounds.
+    uint32_t drift_reject_count() const { return this->drift_reject_count_; }
+
+    /** @return int32_t The tick frequency error in parts per billion. */
+    int32_t drift_ppb() const { return this->drift_ppb_; }
+
+    /**
+     * @return int64_t The step applied by the last synchronize(): the
+     * reference time less the clock time, in 1/256 second units.
+     */
+    int64_t last_offset_256() const { return this->last_offset_256_; }
+
+    uint32_t ticks_per_second() const { return this->ticks_per_second_; }
+
+    /** @return uint32_t 1/256 second units per tick, in 32.32 fixed point. */
+    uint32_t rate_q32() const {
+        return this->anchors_[this->generation_.load(std::memory_order_acquire) & 1u].rate_q32;
+    }
+
+private:
+    /**
+     * The clock state: at tick count 'ticks' the time was
+     * time_256 + remainder_q32 / 2^32.
+     */
+    struct anchor
+    {
+        uint64_t time_256;
+        uint64_t ticks;
+        uint32_t remainder_q32;
+        uint32_t rate_q32;
+    };
+
+    static anchor advance(anchor const& state, uint64_t ticks)
+    {
+        uint64_t const elapsed = ticks - state.ticks;
+        uint64_t const product = elapsed * state.rate_q32 + state.remainder_q32;
+
+        return anchor{ state.time_256 + (product >> 32u),
+                       ticks,
+                       static_cast<uint32_t>(product),
+                       state.rate_q32 };
+    }
+
+    static time_point to_time_point(uint64_t time_256)
+    {
+        return time_point{ time_256 >> 8u, static_cast<uint8_t>(time_256) };
+    }
+
+    anchor const& current() const {
+        return this->anchors_[this->generation_.load(std::memory_order_relaxed) & 1u];
+    }
+
+    /// Write the next state into the inactive copy, then publish it.
+    void publish(anchor const& state);
+
+    /// @return uint32_t The rate for a tick counter frequency error.
+    uint32_t drift_rate_q32(int64_t drift_ppb) const;
+
+    uint32_t const          ticks_per_second_;
+    uint32_t const          nominal_rate_q32_;
+    tick_source const       tick_source_;
+    void* const             tick_context_;
+
+    anchor                  anchors_[2u];
+    std::atomic<uint32_t>   generation_;
+
+    /// The reference time and tick count at which drift measurement began.
+    uint64_t                sync_time_256_;
+    uint64_t                sync_ticks_;
+    uint32_t                sync_count_;
+    uint32_t                drift_reject_count_;
+    int32_t                 drift_ppb_;
+    int64_t                 last_offset_256_;
+
+    /// The temperature drift now and when drift_ppb_ was measured.
+    int32_t                 temperature_ppb_;
+    int32_t                 temperature_ppb_sync_;
+};
+
+} // namespace utility
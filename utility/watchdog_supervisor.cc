@@ -0,0 +1,215 @@
+/**
+ * @file watchdog_supervisor.cc
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ */
+
+#include "watchdog_supervisor.h"
+#include "logger.h"
+#include "project_assert.h"
+
+#include <cstring>
+
+static uint32_t watchdog_record_check(watchdog_record_t const& record)
+{
+    uint32_t words[offsetof(watchdog_record_t, check) / sizeof(uint32_t)];
+    std::memcpy(words, &record, sizeof(words));
+
+    uint32_t check = 0u;
+    for (uint32_t word : words)
+    {
+        check = ((check << 5u) | (check >> 27u)) ^ word;
+    }
+
+    return ~check;
+}
+
+bool watchdog_record_is_valid(watchdog_record_t const& record)
+{
+    return (record.magic == watchdog_record_magic) &&
+           (record.check == watchdog_record_check(record));
+}
+
+void watchdog_record_clear(watchdog_record_t& record)
+{
+    std::memset(&record, 0, sizeof(record));
+}
+
+static watchdog_supervisor watchdog_supervisor_instance;
+
+watchdog_supervisor& watchdog_supervisor::instance()
+{
+    return watchdog_supervisor_instance;
+}
+
+watchdog_supervisor::watchdog_supervisor() :
+    record_(nullptr),
+    ticks_(nullptr),
+    ticks_context_(nullptr),
+    ticks_per_second_(0u),
+    feed_(nullptr),
+    feed_context_(nullptr),
+    tasks_{},
+    task_count_(0u),
+    starved_task_(task_invalid),
+    feed_count_(0u)
+{
+}
+
+void watchdog_supervisor::init(watchdog_record_t&    record,
+                               tick_source           ticks,
+                               void*                 ticks_context,
+                               uint32_t              ticks_per_second,
+                               feed_function         feed,
+                               void*                 feed_context)
+{
+    this->record_           = &record;
+    this->ticks_            = ticks;
+    this->ticks_context_    = ticks_context;
+    this->ticks_per_second_ = ticks_per_second;
+    this->feed_             = feed;
+    this->feed_context_     = feed_context;
+}
+
+uint32_t watchdog_supervisor::ticks_now() const
+{
+    return this->ticks_(this->ticks_context_);
+}
+
+watchdog_supervisor::task_id watchdog_supervisor::task_register(char const* name,
+                                                                uint32_t    deadline_msec)
+{
+    ASSERT(this->ticks_);
+    if (this->task_count_ == task_count_max)
+    {
+        return task_invalid;
+    }
+
+    task_type& task = this->tasks_[this->task_count_];
+    uint64_t const deadline_ticks =
+        (static_cast<uint64_t>(deadline_msec) * this->ticks_per_second_) / 1000u;
+
+    task.name           = name;
+    task.deadline_ticks = static_cast<uint32_t>(deadline_ticks);
+    task.interval_max   = 0u;
+    task.suspended.store(false);
+    task.ticks_check_in.store(this->ticks_now());
+
+    return static_cast<task_id>(this->task_count_++);
+}
+
+void watchdog_supervisor::check_in(task_id task_index)
+{
+    ASSERT(task_index < this->task_count_);
+    task_type& task = this->tasks_[task_index];
+
+    uint32_t const ticks    = this->ticks_now();
+    uint32_t const interval = ticks - task.ticks_check_in.exchange(ticks);
+    if ((interval > task.interval_max) && not task.suspended.load())
+    {
+        task.interval_max = interval;
+    }
+}
+
+void watchdog_supervisor::suspend(task_id task_index)
+{
+    ASSERT(task_index < this->task_count_);
+    this->tasks_[task_index].suspended.store(true);
+}
+
+void watchdog_supervisor::resume(task_id task_index)
+{
+    ASSERT(task_index < this->task_count_);
+    task_type& task = this->tasks_[task_index];
+
+    task.ticks_check_in.store(this->ticks_now());
+    task.suspended.store(false);
+}
+
+bool watchdog_supervisor::supervise()
+{
+    if (this->is_starved())
+    {
+        return false;
+    }
+
+    uint32_t const ticks = this->ticks_now();
+    for (std::size_t task_index = 0u; task_index < this->task_count_; ++task_index)
+    {
+        task_type const& task = this->tasks_[task_index];
+        if (task.suspended.load())
+        {
+            continue;
+        }
+
+        // A task may check in from a preempting ISR after ticks was read;
+        // a check-in newer than ticks is on time, not 2^32 ticks late.
+        int32_t const elapsed = static_cast<int32_t>(ticks - task.ticks_check_in.load());
+        if (elapsed > static_cast<int32_t>(task.deadline_ticks))
+        {
+            this->starved_task_ = static_cast<task_id>(task_index);
+            this->record_write(task.name, ticks,
+                               static_cast<uint32_t>(elapsed) - task.deadline_ticks);
+            return false;
+        }
+    }
+
+    this->feed_(this->feed_context_);
+    this->feed_count_ += 1u;
+    return true;
+}
+
+void watchdog_supervisor::timeout()
+{
+    if (not this->is_starved())
+    {
+        this->starved_task_ = task_supervisor;
+        this->record_write(this->task_name(task_supervisor), this->ticks_now(), 0u);
+    }
+}
+
+void watchdog_supervisor::record_write(char const* task_name, uint32_t ticks, uint32_t ticks_late)
+{
+    if (this->record_ == nullptr)
+    {
+        return;
+    }
+
+    watchdog_record_t& record = *this->record_;
+    watchdog_record_clear(record);
+    record.magic      = watchdog_record_magic;
+    record.ticks      = ticks;
+    record.ticks_late = ticks_late;
+    std::strncpy(record.task_name, task_name, sizeof(record.task_name) - 1u);
+    record.check      = watchdog_record_check(record);
+}
+
+char const* watchdog_supervisor::task_name(task_id task_index) const
+{
+    if (task_index == task_supervisor)
+    {
+        return "supervisor";
+    }
+
+    return (task_index < this->task_count_) ? this->tasks_[task_index].name : "";
+}
+
+uint32_t watchdog_supervisor::check_in_interval_max(task_id task_index) const
+{
+    ASSERT(task_index < this->task_count_);
+    return this->tasks_[task_index].interval_max;
+}
+
+void watchdog_supervisor::dump(logger& logger) const
+{
+    logger.info("watchdog: tasks: %u, feeds: %u, starved: %s",
+                static_cast<unsigned int>(this->task_count_), this->feed_count_,
+                this->is_starved() ? this->task_name(this->starved_task_) : "none");
+
+    for (std::size_t task_index = 0u; task_index < this->task_count_; ++task_index)
+    {
+        task_type const& task = this->tasks_[task_index];
+        logger.info("watchdog: %-12s deadline: %8u, interval max: %8u%s",
+                    task.name, task.deadline_ticks, task.interval_max,
+                    task.suspended.load() ? ", suspended" : "");
+    }
+}
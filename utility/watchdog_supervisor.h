@@ -0,0 +1,158 @@
+/**
+ * @file watchdog_supervisor.h
+ * @copyright (c) 2018, natersoz. Distributed under the Apache 2.0 license.
+ *
+ * Feed the hardware watchdog only while every supervised task checks in
+ * within its own deadline.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class logger;
+
+/// watchdog_record_t::magic when the record holds a starvation.
+#define watchdog_record_magic (0x57444F47u)
+
+/**
+ * @struct watchdog_record_t
+ * The task which starved the watchdog. Place the record in RAM which is
+ * not initialized at reset so that it survives the watchdog reset.
+ */
+struct watchdog_record_t
+{
+    uint32_t    magic;
+    uint32_t    ticks;              ///< When the starvation was detected.
+    uint32_t    ticks_late;         ///< The time past the task deadline.
+    char        task_name[16];
+    uint32_t    check;              ///< Integrity check of the words above.
+};
+
+/**
+ * Determine whether a record holds a starvation; a record in
+ * uninitialized RAM after a power on reset is not valid.
+ */
+bool watchdog_record_is_valid(watchdog_record_t const& record);
+
+void watchdog_record_clear(watchdog_record_t& record);
+
+/**
+ * @class watchdog_supervisor
+ * A software aggregator in front of a single hardware watchdog reload.
+ *
+ * Each task registers with the longest interval allowed between its
+ * check-ins. supervise() is called periodically, typically from a timer
+ * ISR; it feeds the watchdog only when no running task is overdue. The
+ * first overdue task is written to the watchdog record and feeding stops
+ * for good, so the hardware watchdog resets the device.
+ *
+ * check_in(), suspend() and resume() may be called from any context.
+ * Register tasks before calling supervise().
+ */
+class watchdog_supervisor
+{
+public:
+    using task_id       = uint8_t;
+    using tick_source   = uint32_t (*)(void* context);
+    using feed_function = void (*)(void* context);
+
+    static constexpr std::size_t const task_count_max  = 8u;
+    static constexpr task_id     const task_invalid    = UINT8_MAX;
+
+    /// The starved task when the supervisor itself stopped running.
+    static constexpr task_id     const task_supervisor = task_count_max;
+
+    ~watchdog_supervisor()                                      = default;
+
+    watchdog_supervisor(watchdog_supervisor const&)             = delete;
+    watchdog_supervisor(watchdog_supervisor &&)                 = delete;
+    watchdog_supervisor& operator=(watchdog_supervisor const&)  = delete;
+    watchdog_supervisor& operator=(watchdog_supervisor&&)       = delete;
+
+    watchdog_supervisor();
+
+    static watchdog_supervisor& instance();
+
+    /**
+     * @param record           Written when a task starves the watchdog.
+     * @param ticks            The free running time source.
+     * @param ticks_context    Passed to ticks.
+     * @param ticks_per_second The ticks rate.
+     * @param feed             Reloads the hardware watchdog.
+     * @param feed_context     Passed to feed.
+     */
+    void init(watchdog_record_t&    record,
+              tick_source           ticks,
+              void*                 ticks_context,
+              uint32_t              ticks_per_second,
+              feed_function         feed,
+              void*                 feed_context);
+
+    /**
+     * @param name          The task name; must outlive the supervisor.
+     * @param deadline_msec The longest time allowed between check-ins.
+     * @return task_id      The task identifier; task_invalid if full.
+     */
+    task_id task_register(char const* name, uint32_t deadline_msec);
+
+    void check_in(task_id task);
+
+    /// Stop supervising a task which is idle by design.
+    void suspend(task_id task);
+
+    /// Supervise the task again; its deadline starts now.
+    void resume(task_id task);
+
+    /**
+     * Feed the watchdog if every running task has checked in on time.
+     * @return bool true if the watchdog was fed.
+     */
+    bool supervise();
+
+    /**
+     * The hardware watchdog timed out. If no task was found overdue the
+     * supervisor itself did not run; record it as the starving task.
+     */
+    void timeout();
+
+    bool        is_starved()   const { return this->starved_task_ != task_invalid; }
+    task_id     starved_task() const { return this->starved_task_; }
+    uint32_t    feed_count()   const { return this->feed_count_; }
+    std::size_t task_count()   const { return this->task_count_; }
+
+    char const* task_name(task_id task) const;
+
+    /// @return uint32_t The longest interval between check-ins, in ticks.
+    uint32_t    check_in_interval_max(task_id task) const;
+
+    /// Write the task state to the logger at level::info.
+    void dump(logger& logger) const;
+
+private:
+    struct task_type
+    {
+        char const*             name;
+        uint32_t                deadline_ticks;
+        std::atomic<uint32_t>   ticks_check_in;
+        std::atomic<bool>       suspended;
+        uint32_t                interval_max;
+    };
+
+    uint32_t ticks_now() const;
+    void record_write(char const* task_name, uint32_t ticks, uint32_t ticks_late);
+
+    watchdog_record_t*  record_;
+    tick_source         ticks_;
+    void*               ticks_context_;
+    uint32_t            ticks_per_second_;
+    feed_function       feed_;
+    void*               feed_context_;
+
+    task_type           tasks_[task_count_max];
+    std::size_t         task_count_;
+    task_id volatile    starved_task_;
+    uint32_t            feed_count_;
+};
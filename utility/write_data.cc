@@ -14,33 +14,52 @@ using signed_size_t = typename std::make_signed<size_t>::type;
 
 static constexpr char const new_line = '\n';
 
-static size_t write_byte(io::output_stream& os, uint8_t byte_value)
+/**
+ * A line of output is formatted into a line_buffer and written to the stream
+ * with a single write: streams such as RTT have a per write cost.
+ */
+struct line_buffer
 {
-    char buffer[2u];
-    buffer[0u] = nybble_to_char(byte_value >> 4u);
-    buffer[1u] = nybble_to_char(byte_value >> 0u);
-    return os.write(buffer, sizeof(buffer));
+    /// Room for an address prefix and 16 bytes in hex and as characters.
+    static constexpr size_t const capacity = 128u;
+
+    char    data[capacity];
+    size_t  length = 0u;
+
+    void append(char const* chars, size_t count)
+    {
+        count = std::min(count, capacity - this->length);
+        std::copy(chars, chars + count, this->data + this->length);
+        this->length += count;
+    }
+
+    void append(char value) { this->append(&value, 1u); }
+};
+
+static void append_byte(line_buffer& line, uint8_t byte_value)
+{
+    line.append(nybble_to_char(byte_value >> 4u));
+    line.append(nybble_to_char(byte_value >> 0u));
 }
 
 namespace io
 {
 
-static size_t write_data_line(io::output_stream&    os,
-                              uint8_t const*        data,
-                              size_t                length,
-                              size_t                bytes_per_line,
-                              bool                  fill_line)
+static void append_data_line(line_buffer&       line,
+                             uint8_t const*     data,
+                             size_t             length,
+                             size_t             bytes_per_line,
+                             bool               fill_line)
 {
     char const space = ' ';
 
-    size_t n_written = 0u;
     for (size_t iter = 0u; iter < length; ++iter, ++data)
     {
         if ((iter % 4u == 0u) && (iter > 0u))
         {
-            n_written += os.write(&space, sizeof(space));
+            line.append(space);
         }
-        n_written += write_byte(os, *data);
+        append_byte(line, *data);
     }
 
     if (fill_line)
@@ -49,36 +68,23 @@ static size_t write_data_line(io::output_stream&    os,
         {
             if ((iter % 4u == 0u) && (iter > 0u))
             {
-                n_written += os.write(&space, sizeof(space));
+                line.append(space);
             }
 
             char const spaces[] = { space, space };
-            n_written += os.write(&spaces, sizeof(spaces));
+            line.append(spaces, sizeof(spaces));
         }
     }
-
-    return n_written;
 }
 
-static size_t write_char_data_line(io::output_stream&   os,
-                                   uint8_t const*       data,
-                                   size_t               length)
+static void append_char_data_line(line_buffer&      line,
+                                  uint8_t const*    data,
+                                  size_t            length)
 {
-    size_t n_written = 0u;
     for (size_t iter = 0u; iter < length; ++iter, ++data)
     {
-        if (std::isprint(*data))
-        {
-            n_written += os.write(data, sizeof(*data));
-        }
-        else
-        {
-            char const non_printable = '.';
-            n_written += os.write(&non_printable, sizeof(non_printable));
-        }
+        line.append(std::isprint(*data) ? static_cast<char>(*data) : '.');
     }
-
-    return n_written;
 }
 
 size_t write_data(io::output_stream&    os,
@@ -98,6 +104,7 @@ size_t write_data(io::output_stream&    os,
     {
         size_t const bytes_remaining = length - iter;
         size_t const bytes_to_write = std::min(bytes_remaining, bytes_per_line);
+        line_buffer line;
 
         switch (prefix)
         {
@@ -105,14 +112,14 @@ size_t write_data(io::output_stream&    os,
             break;
         case io::data_prefix::address:
             {
-                uintptr_t const address = reinterpret_cast<uintptr_t>(&data_ptr[iter]);
+                uintptr_t const address = reinterpret_cast<uintptr_t>(data_ptr);
                 char buffer[hex_conversion_size<uintptr_t> + 1];
                 size_t const digits = sizeof(address) * 2u;
                 size_t hex_len = int_to_hex(buffer, sizeof(buffer), address, digits);
-                n_write += os.write(buffer, hex_len);
+                line.append(buffer, hex_len);
 
                 char const colon[] = ": ";
-                n_write += os.write(&colon, sizeof(colon) - 1u);
+                line.append(colon, sizeof(colon) - 1u);
             }
             break;
         case io::data_prefix::index:
@@ -122,28 +129,24 @@ size_t write_data(io::output_stream&    os,
                 char buffer[hex_conversion_size<size_type_t>];
                 size_t const digits = sizeof(iter) * 2u;
                 size_t hex_len = int_to_hex(buffer, digits, iter, digits);
-                n_write += os.write(buffer, hex_len);
+                line.append(buffer, hex_len);
 
                 char const colon[] = ": ";
-                n_write += os.write(&colon, sizeof(colon) - 1u);
+                line.append(colon, sizeof(colon) - 1u);
             }
             break;
         }
 
-        n_write += write_data_line(os,
-                                   data_ptr,
-                                   bytes_to_write,
-                                   bytes_per_line,
-                                   char_data);
+        append_data_line(line, data_ptr, bytes_to_write, bytes_per_line, char_data);
 
         if (char_data)
         {
-            char const space = ' ';
-            n_write += os.write(&space, sizeof(space));
-            n_write += write_char_data_line(os, data_ptr, bytes_to_write);
+            line.append(' ');
+            append_char_data_line(line, data_ptr, bytes_to_write);
         }
 
-        n_write += os.write(&new_line, sizeof(new_line));
+        line.append(new_line);
+        n_write += os.write(line.data, line.length);
     }
 
     return n_write;